@@ -83,11 +83,13 @@ void ConfigureUART(void)
 {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    // The UART is usable as soon as its clock is running; no settling delay
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA)) { }
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0)) { }
     GPIOPinConfigure(GPIO_PA0_U0RX);
     GPIOPinConfigure(GPIO_PA1_U0TX);
     GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
     UARTStdioConfig(0, 9600, g_ui32SysClock);
-    SysCtlDelay(g_ui32SysClock);
 }
 
 //*****************************************************************************
@@ -138,6 +138,8 @@ void ConfigureUART(void)
     // Enable UART0
     //
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA)) { }
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0)) { }
 
     //
     // Configure GPIO Pins for UART mode.
@@ -150,8 +152,6 @@ void ConfigureUART(void)
     // Initialize the UART for console I/O.
     //
     UARTStdioConfig(0, 9600, g_ui32SysClock);
-
-    SysCtlDelay(g_ui32SysClock); // ~1 second delay at 120MHz to ensure UART initialises before using UARTprintf
 }
 
 /*-----------------------------------------------------------*/
@@ -65,12 +65,24 @@
 #define NumLeadingZeros(x)      _norm(x)
 #endif
 
+#if defined(__arm__)
 #define NumLeadingZeros(x) __extension__                                      \
         ({                                                                    \
             register uint32_t __ret, __inp = x;                               \
             __asm__("clz %0, %1" : "=r" (__ret) : "r" (__inp));               \
             __ret;                                                            \
         })
+#else
+//
+// Host builds (host/hal_host) have no CLZ instruction; __builtin_clz(0) is
+// undefined, where CLZ gives 32.
+//
+#define NumLeadingZeros(x) __extension__                                      \
+        ({                                                                    \
+            uint32_t __inp = x;                                               \
+            __inp ? (uint32_t)__builtin_clz(__inp) : 32;                      \
+        })
+#endif
 
 //*****************************************************************************
 //
@@ -28,12 +28,24 @@
 #include "driverlib/debug.h"
 #include "grlib/grlib.h"
 
+#if defined(__arm__)
 #define NumLeadingZeros(x) __extension__                                      \
         ({                                                                    \
             register uint32_t __ret, __inp = x;                               \
             __asm__("clz %0, %1" : "=r" (__ret) : "r" (__inp));               \
             __ret;                                                            \
         })
+#else
+//
+// Host builds (host/hal_host) have no CLZ instruction; __builtin_clz(0) is
+// undefined, where CLZ gives 32.
+//
+#define NumLeadingZeros(x) __extension__                                      \
+        ({                                                                    \
+            uint32_t __inp = x;                                               \
+            __inp ? (uint32_t)__builtin_clz(__inp) : 32;                      \
+        })
+#endif
 
 //*****************************************************************************
 //
@@ -461,6 +473,318 @@ PixelTransparentDraw(const tContext *pContext, int32_t i32X, int32_t i32Y,
     return(bRet);
 }
 
+//*****************************************************************************
+//
+// Runs of one color at least this long are drawn with DpyLineDrawH(); shorter
+// ones are gathered into bursts of up to IMAGE_BURST_PIXELS pixels, each
+// drawn with one DpyPixelDrawMultiple() call.
+//
+//*****************************************************************************
+#define IMAGE_RUN_MIN           8
+#define IMAGE_BURST_PIXELS      64
+
+//*****************************************************************************
+//
+// The state of the compressed image decoder's output: the run of identical
+// pixels being built, and the burst of short runs waiting to be drawn.  The
+// burst holds pixels in the image's own format, starting at bit zero.
+//
+//*****************************************************************************
+typedef struct
+{
+    const tContext *pContext;
+    const uint8_t *pui8Palette;
+    int32_t i32BPP;
+    int32_t i32Flag;
+    int32_t i32Transparent;
+    int32_t i32Y;
+    int32_t i32RunX;
+    int32_t i32RunLen;
+    uint32_t ui32RunIndex;
+    int32_t i32BurstX;
+    int32_t i32BurstLen;
+    uint8_t pui8Burst[IMAGE_BURST_PIXELS];
+}
+tImageSpans;
+
+//*****************************************************************************
+//
+// Draws the pending burst of pixels, if any.
+//
+//*****************************************************************************
+static void
+ImageSpanBurstFlush(tImageSpans *psSpans)
+{
+    if(psSpans->i32BurstLen)
+    {
+        DpyPixelDrawMultiple(psSpans->pContext->psDisplay, psSpans->i32BurstX,
+                             psSpans->i32Y, 0, psSpans->i32BurstLen,
+                             psSpans->i32BPP | psSpans->i32Flag,
+                             psSpans->pui8Burst, psSpans->pui8Palette);
+
+        //
+        // The driver has seen the start of the image, so it has rebuilt any
+        // color lookup table it keeps for the palette.
+        //
+        psSpans->i32Flag = 0;
+        psSpans->i32BurstLen = 0;
+    }
+}
+
+//*****************************************************************************
+//
+// Draws the current run of identical pixels, either directly as a line or by
+// adding it to the pending burst.  Transparent runs are dropped.
+//
+//*****************************************************************************
+static void
+ImageSpanRunEnd(tImageSpans *psSpans)
+{
+    const uint8_t *pui8Entry;
+    uint32_t ui32Color, ui32Index;
+    int32_t i32Pos;
+
+    if(psSpans->i32RunLen == 0)
+    {
+        return;
+    }
+
+    ui32Index = psSpans->ui32RunIndex;
+
+    if((int32_t)ui32Index == psSpans->i32Transparent)
+    {
+        ImageSpanBurstFlush(psSpans);
+    }
+    else if(psSpans->i32RunLen >= IMAGE_RUN_MIN)
+    {
+        //
+        // Find the run's color.  1 BPP palettes hold colors already
+        // translated for the display; others hold 24-bit RGB values.
+        //
+        if(psSpans->i32BPP == 1)
+        {
+            ui32Color = ((const uint32_t *)psSpans->pui8Palette)[ui32Index];
+        }
+        else
+        {
+            pui8Entry = psSpans->pui8Palette + (ui32Index * 3);
+            ui32Color = DpyColorTranslate(psSpans->pContext->psDisplay,
+                                          (pui8Entry[0] |
+                                           (pui8Entry[1] << 8) |
+                                           (pui8Entry[2] << 16)));
+        }
+
+        ImageSpanBurstFlush(psSpans);
+        DpyLineDrawH(psSpans->pContext->psDisplay, psSpans->i32RunX,
+                     psSpans->i32RunX + psSpans->i32RunLen - 1, psSpans->i32Y,
+                     ui32Color);
+    }
+    else
+    {
+        //
+        // Start a new burst if this run does not continue the pending one or
+        // would not fit in it.
+        //
+        if((psSpans->i32BurstLen &&
+            ((psSpans->i32BurstX + psSpans->i32BurstLen) !=
+             psSpans->i32RunX)) ||
+           ((psSpans->i32BurstLen + psSpans->i32RunLen) >
+            ((IMAGE_BURST_PIXELS * 8) / psSpans->i32BPP)))
+        {
+            ImageSpanBurstFlush(psSpans);
+        }
+        if(psSpans->i32BurstLen == 0)
+        {
+            psSpans->i32BurstX = psSpans->i32RunX;
+        }
+
+        //
+        // Pack the run's pixels into the burst.
+        //
+        for(i32Pos = psSpans->i32BurstLen;
+            i32Pos < (psSpans->i32BurstLen + psSpans->i32RunLen); i32Pos++)
+        {
+            switch(psSpans->i32BPP)
+            {
+                case 1:
+                {
+                    if((i32Pos & 7) == 0)
+                    {
+                        psSpans->pui8Burst[i32Pos / 8] = 0;
+                    }
+                    psSpans->pui8Burst[i32Pos / 8] |=
+                        ui32Index << (7 - (i32Pos & 7));
+                    break;
+                }
+
+                case 4:
+                {
+                    if((i32Pos & 1) == 0)
+                    {
+                        psSpans->pui8Burst[i32Pos / 2] = ui32Index << 4;
+                    }
+                    else
+                    {
+                        psSpans->pui8Burst[i32Pos / 2] |= ui32Index;
+                    }
+                    break;
+                }
+
+                default:
+                {
+                    psSpans->pui8Burst[i32Pos] = ui32Index;
+                    break;
+                }
+            }
+        }
+        psSpans->i32BurstLen += psSpans->i32RunLen;
+    }
+
+    psSpans->i32RunLen = 0;
+}
+
+//*****************************************************************************
+//
+// Draws a compressed image.
+//
+// The Lempel-Ziv-Storer-Szymanski stream is walked once.  Each decoded byte
+// is kept in the 32 byte dictionary for later matches, and its pixels are
+// split out only if they fall within the clipping region; the rest of the
+// work is skipped for rows above the region and bytes to either side of it.
+// Visible pixels are gathered into runs of one color as they are decoded, so
+// the palette is looked up once per run rather than once per pixel, and
+// decoding stops after the last visible row.
+//
+//*****************************************************************************
+static void
+ImageCompDraw(const tContext *pContext, const uint8_t *pui8Image,
+              int32_t i32X, int32_t i32Y, int32_t i32X0, int32_t i32X2,
+              int32_t i32Width, int32_t i32Height, int32_t i32BPP,
+              const uint8_t *pui8Palette, int32_t i32Transparent)
+{
+    tImageSpans sSpans;
+    uint32_t ui32Byte, ui32Bits, ui32Match, ui32Size, ui32Idx, ui32Data;
+    uint32_t ui32Col, ui32RowBytes, ui32PixPerByte, ui32Index, ui32Pix;
+    int32_t i32Px;
+
+    sSpans.pContext = pContext;
+    sSpans.pui8Palette = pui8Palette;
+    sSpans.i32BPP = i32BPP;
+    sSpans.i32Flag = GRLIB_DRIVER_FLAG_NEW_IMAGE;
+    sSpans.i32Transparent = i32Transparent;
+    sSpans.i32Y = i32Y;
+    sSpans.i32RunLen = 0;
+    sSpans.i32BurstLen = 0;
+
+    //
+    // Reset the dictionary used to uncompress the image.
+    //
+    for(ui32Idx = 0; ui32Idx < sizeof(g_pui8Dictionary); ui32Idx += 4)
+    {
+        *(uint32_t *)(g_pui8Dictionary + ui32Idx) = 0;
+    }
+
+    ui32RowBytes = ((i32Width * i32BPP) + 7) / 8;
+    ui32PixPerByte = 8 / i32BPP;
+    ui32Col = 0;
+    ui32Idx = 0;
+    ui32Bits = 0;
+    ui32Byte = 0;
+    ui32Size = 0;
+    ui32Match = 0;
+
+    while(i32Height)
+    {
+        //
+        // Get the next decoded byte, either from a pending dictionary match
+        // or from the stream.
+        //
+        if(ui32Size)
+        {
+            ui32Data = g_pui8Dictionary[(ui32Idx + ui32Match) %
+                                        sizeof(g_pui8Dictionary)];
+            ui32Size--;
+        }
+        else
+        {
+            //
+            // See if an encoding byte needs to be read.  It indicates whether
+            // each of the following eight items is encoded or literal.
+            //
+            if(ui32Bits == 0)
+            {
+                ui32Byte = *pui8Image++;
+                ui32Bits = 8;
+            }
+            ui32Bits--;
+
+            if(ui32Byte & (1 << ui32Bits))
+            {
+                //
+                // A match of two to nine bytes within the dictionary.
+                //
+                ui32Match = *pui8Image >> 3;
+                ui32Size = (*pui8Image++ & 7) + 1;
+                ui32Data = g_pui8Dictionary[(ui32Idx + ui32Match) %
+                                            sizeof(g_pui8Dictionary)];
+            }
+            else
+            {
+                ui32Data = *pui8Image++;
+            }
+        }
+        g_pui8Dictionary[ui32Idx] = ui32Data;
+        ui32Idx = (ui32Idx + 1) % sizeof(g_pui8Dictionary);
+
+        //
+        // Split the byte into pixels if the row is visible and the byte is
+        // within the horizontal clipping range.
+        //
+        i32Px = ui32Col * ui32PixPerByte;
+        if((sSpans.i32Y >= pContext->sClipRegion.i16YMin) &&
+           (i32Px <= i32X2) && ((i32Px + (int32_t)ui32PixPerByte) > i32X0))
+        {
+            for(ui32Pix = 0; ui32Pix < ui32PixPerByte; ui32Pix++, i32Px++)
+            {
+                if((i32Px < i32X0) || (i32Px > i32X2))
+                {
+                    continue;
+                }
+
+                ui32Index = (ui32Data >> (8 - ((ui32Pix + 1) * i32BPP))) &
+                            ((1 << i32BPP) - 1);
+
+                //
+                // Extend the current run, or end it and start another.
+                //
+                if(sSpans.i32RunLen && (ui32Index == sSpans.ui32RunIndex))
+                {
+                    sSpans.i32RunLen++;
+                }
+                else
+                {
+                    ImageSpanRunEnd(&sSpans);
+                    sSpans.i32RunX = i32X + i32Px;
+                    sSpans.i32RunLen = 1;
+                    sSpans.ui32RunIndex = ui32Index;
+                }
+            }
+        }
+
+        //
+        // At the end of a row, draw what is pending and move to the next.
+        //
+        if(++ui32Col == ui32RowBytes)
+        {
+            ImageSpanRunEnd(&sSpans);
+            ImageSpanBurstFlush(&sSpans);
+            ui32Col = 0;
+            sSpans.i32Y++;
+            i32Height--;
+        }
+    }
+}
+
 //*****************************************************************************
 //
 // Internal function implementing both normal and transparent image drawing.
@@ -471,12 +795,10 @@ InternalImageDraw(const tContext *pContext, const uint8_t *pui8Image,
                   int32_t i32X, int32_t i32Y, uint32_t ui32Transparent,
                   bool bTransparent)
 {
-    uint32_t ui32Byte, ui32Bits, ui32Match, ui32Size, ui32Idx, ui32Count;
-    uint32_t ui32Num;
     int32_t i32BPP, i32Width, i32Height, i32X0, i32X1, i32X2, i32XMask;
     const uint8_t *pui8Palette;
     uint32_t pui32BWPalette[2];
-    int32_t i32Flag;
+    int32_t i32Flag, i32Drop;
 
     //
     // Check the arguments.
@@ -709,303 +1031,24 @@ InternalImageDraw(const tContext *pContext, const uint8_t *pui8Image,
         i32BPP &= 0x7f;
 
         //
-        // Reset the dictionary used to uncompress the image.
+        // Find the palette index to drop out, if any.  For 1 BPP images a
+        // non-zero ui32Transparent drops the foreground.
         //
-        for(ui32Bits = 0; ui32Bits < sizeof(g_pui8Dictionary); ui32Bits += 4)
+        if(!bTransparent)
         {
-            *(uint32_t *)(g_pui8Dictionary + ui32Bits) = 0;
+            i32Drop = -1;
         }
-
-        //
-        // Determine the number of bytes of data to decompress.
-        //
-        ui32Count = (((i32Width * i32BPP) + 7) / 8) * i32Height;
-
-        //
-        // Initialize the pointer into the dictionary.
-        //
-        ui32Idx = 0;
-
-        //
-        // Start off with no encoding byte.
-        //
-        ui32Bits = 0;
-        ui32Byte = 0;
-
-        //
-        // Start from the upper left corner of the image.
-        //
-        i32X1 = 0;
-
-        //
-        // Loop while there are more rows or more data in the image.
-        //
-        while(i32Height && ui32Count)
+        else if(i32BPP == 1)
         {
-            //
-            // See if an encoding byte needs to be read.
-            //
-            if(ui32Bits == 0)
-            {
-                //
-                // Read the encoding byte, which indicates if each of the
-                // following eight bytes are encoded or literal.
-                //
-                ui32Byte = *pui8Image++;
-                ui32Bits = 8;
-            }
-
-            //
-            // See if the next byte is encoded or literal.
-            //
-            if(ui32Byte & (1 << (ui32Bits - 1)))
-            {
-                //
-                // This byte is encoded, so extract the location and size of
-                // the encoded data within the dictionary.
-                //
-                ui32Match = *pui8Image >> 3;
-                ui32Size = (*pui8Image++ & 7) + 2;
-
-                //
-                // Decrement the count of bytes to decode by the number of
-                // copied bytes.
-                //
-                ui32Count -= ui32Size;
-            }
-            else
-            {
-                //
-                // This byte is a literal, so copy it into the dictionary.
-                //
-                g_pui8Dictionary[ui32Idx++] = *pui8Image++;
-
-                //
-                // Decrement the count of bytes to decode.
-                //
-                ui32Count--;
-
-                //
-                // Clear any previous encoded data information.
-                //
-                ui32Match = 0;
-                ui32Size = 0;
-            }
-
-            //
-            // Loop while there are bytes to copy for the encoded data, or
-            // once for literal data.
-            //
-            while(ui32Size || !(ui32Byte & (1 << (ui32Bits - 1))))
-            {
-                //
-                // Set the encoded data bit for this data so that this loop
-                // will only be executed once for literal data.
-                //
-                ui32Byte |= 1 << (ui32Bits - 1);
-
-                //
-                // Loop while there is more encoded data to copy and there is
-                // additional space in the dictionary (before the buffer
-                // wraps).
-                //
-                while(ui32Size && (ui32Idx != sizeof(g_pui8Dictionary)))
-                {
-                    //
-                    // Copy this byte.
-                    //
-                    g_pui8Dictionary[ui32Idx] =
-                        g_pui8Dictionary[(ui32Idx + ui32Match) %
-                                        sizeof(g_pui8Dictionary)];
-
-                    //
-                    // Increment the dictionary pointer.
-                    //
-                    ui32Idx++;
-
-                    //
-                    // Decrement the encoded data size.
-                    //
-                    ui32Size--;
-                }
-
-                //
-                // See if the dictionary pointer is about to wrap, or if there
-                // is no more data to decompress.
-                //
-                if((ui32Idx == sizeof(g_pui8Dictionary)) || !ui32Count)
-                {
-                    //
-                    // Loop through the data in the dictionary buffer.
-                    //
-                    for(ui32Idx = 0;
-                        (ui32Idx < sizeof(g_pui8Dictionary)) && i32Height; )
-                    {
-                        //
-                        // Compute the number of pixels that remain in the
-                        // dictionary buffer.
-                        //
-                        ui32Num = ((sizeof(g_pui8Dictionary) - ui32Idx) * 8) /
-                                  i32BPP;
-
-                        //
-                        // See if any of the pixels in the dictionary buffer
-                        // are within the clipping region.
-                        //
-                        if((i32Y >= pContext->sClipRegion.i16YMin) &&
-                           ((i32X1 + ui32Num) >= i32X0) && (i32X1 <= i32X2))
-                        {
-                            //
-                            // Skip some pixels at the start of the scan line
-                            // if required to stay within the clipping region.
-                            //
-                            if(i32X1 < i32X0)
-                            {
-                                ui32Idx += ((i32X0 - i32X1) * i32BPP) / 8;
-                                i32X1 = i32X0;
-                            }
-
-                            //
-                            // Shorten the scan line if required to stay within
-                            // the clipping region.
-                            //
-                            if(ui32Num > (i32X2 - i32X1 + 1))
-                            {
-                                ui32Num = i32X2 - i32X1 + 1;
-                            }
-
-                            //
-                            // Determine the starting offset for the first
-                            // source pixel within the byte.
-                            //
-                            switch(i32BPP)
-                            {
-
-                                case 1:
-                                {
-                                    i32XMask = i32X1 & 7;
-                                    break;
-                                }
-
-                                case 4:
-                                {
-                                    i32XMask = i32X1 & 1;
-                                    break;
-                                }
-
-                                default:
-                                {
-                                    i32XMask = 0;
-                                    break;
-                                }
-                            }
-
-                            //
-                            // Draw this row of image pixels.
-                            //
-                            if(bTransparent)
-                            {
-                                bool bRet;
-
-                                bRet = PixelTransparentDraw(pContext,
-                                                            i32X + i32X1,
-                                                            i32Y, i32XMask,
-                                                            ui32Num,
-                                                            i32BPP | i32Flag,
-                                                            g_pui8Dictionary +
-                                                            ui32Idx,
-                                                            pui8Palette,
-                                                            ui32Transparent);
-
-                                //
-                                // Clear the flag only if we actually drew
-                                // something.
-                                //
-                                if(bRet)
-                                {
-                                    //
-                                    // We drew something so that NEW_IMAGE
-                                    // flag is no longer needed.
-                                    //
-                                    i32Flag = 0;
-                                }
-                            }
-                            else
-                            {
-                                DpyPixelDrawMultiple(pContext->psDisplay,
-                                                     i32X + i32X1, i32Y,
-                                                     i32XMask, ui32Num,
-                                                     i32BPP | i32Flag,
-                                                     g_pui8Dictionary + ui32Idx,
-                                                     pui8Palette);
-
-                                //
-                                // We've drawn the first line so clear the flag.
-                                //
-                                i32Flag = 0;
-                            }
-                        }
-
-                        //
-                        // Move the X coordinate back to the start of the first
-                        // data byte in this portion of the dictionary buffer.
-                        //
-                        i32X1 = ((i32X1 * i32BPP) & ~7) / i32BPP;
-
-                        //
-                        // See if the remainder of this scan line resides
-                        // within the dictionary buffer.
-                        //
-                        if(((((i32Width - i32X1) * i32BPP) + 7) / 8) >
-                           (sizeof(g_pui8Dictionary) - ui32Idx))
-                        {
-                            //
-                            // There is more to this scan line than is in the
-                            // dictionary buffer at this point, so move the
-                            // X coordinate by by the number of pixels in the
-                            // dictionary buffer.
-                            //
-                            i32X1 += (((sizeof(g_pui8Dictionary) - ui32Idx) *
-                                       8) / i32BPP);
-
-                            //
-                            // The entire dictionary buffer has been scanned.
-                            //
-                            ui32Idx = sizeof(g_pui8Dictionary);
-                        }
-                        else
-                        {
-                            //
-                            // The remainder of this scan line resides in the
-                            // dictionary buffer, so skip past it.
-                            //
-                            ui32Idx += (((i32Width - i32X1) * i32BPP) + 7) / 8;
-
-                            //
-                            // Move to the start of the next scan line.
-                            //
-                            i32X1 = 0;
-                            i32Y++;
-
-                            //
-                            // There is one less scan line to process.
-                            //
-                            i32Height--;
-                        }
-                    }
-
-                    //
-                    // Start over from the beginning of the dictionary buffer.
-                    //
-                    ui32Idx = 0;
-                }
-            }
-
-            //
-            // Advance to the next bit in the encoding byte.
-            //
-            ui32Bits--;
+            i32Drop = ui32Transparent ? 1 : 0;
         }
+        else
+        {
+            i32Drop = (uint8_t)ui32Transparent;
+        }
+
+        ImageCompDraw(pContext, pui8Image, i32X, i32Y, i32X0, i32X2,
+                      i32Width, i32Height, i32BPP, pui8Palette, i32Drop);
     }
 }
 
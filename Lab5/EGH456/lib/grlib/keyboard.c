@@ -449,12 +449,198 @@ const tKeyboard g_psKeyboardUSEnglish[NUM_KEYBOARD_US_ENGLISH] =
 #define FLAG_KEY_PRESSED        0x00000001
 #define FLAG_KEY_CAPSLOCK       0x00000002
 
+//*****************************************************************************
+//
+// Values of a tKeyboardWidget.ppui8Grid entry that are not key indices.  A
+// cell marked GRID_SCAN overlaps more than two keys, so the pointer is tested
+// against every key.
+//
+//*****************************************************************************
+#define GRID_EMPTY              0xff
+#define GRID_SCAN               0xfe
+
+//*****************************************************************************
+//
+// Computes the rectangles of a key.
+//
+// \param psKeyWidget is a pointer to the keyboard widget.
+// \param psKey is a pointer to the key.
+// \param psHit receives the area in which a pointer event selects the key.
+// \param psRect, if not 0, receives the rectangle drawn for the key.
+//
+// Key positions are in units of 1/10000 of the widget size.  The hit area is
+// every pixel whose position, scaled the same way, lies within the key, so
+// neighbouring keys share their boundary pixel; the lower numbered key wins.
+// The drawn rectangle leaves a gap between keys.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+KeyRectsCompute(tKeyboardWidget *psKeyWidget, const tKeyText *psKey,
+                tRectangle *psHit, tRectangle *psRect)
+{
+    const tRectangle *psPos;
+    uint32_t ui32XRange, ui32YRange;
+
+    psPos = &psKeyWidget->sBase.sPosition;
+    ui32XRange = psPos->i16XMax - psPos->i16XMin + 1;
+    ui32YRange = psPos->i16YMax - psPos->i16YMin + 1;
+
+    psHit->i16XMin = psPos->i16XMin +
+                     ((ui32XRange * (uint32_t)psKey->ui16XPos) + 9999) / 10000;
+    psHit->i16XMax = psPos->i16XMin +
+                     (ui32XRange * ((uint32_t)psKey->ui16XPos +
+                                    (uint32_t)psKey->ui16Width)) / 10000;
+    psHit->i16YMin = psPos->i16YMin +
+                     ((ui32YRange * (uint32_t)psKey->ui16YPos) + 9999) / 10000;
+    psHit->i16YMax = psPos->i16YMin +
+                     (ui32YRange * ((uint32_t)psKey->ui16YPos +
+                                    (uint32_t)psKey->ui16Height)) / 10000;
+
+    if(psRect)
+    {
+        psRect->i16XMin = psPos->i16XMin + 1 +
+                          (ui32XRange * (uint32_t)psKey->ui16XPos) / 10000;
+        psRect->i16XMax = psRect->i16XMin - 3 +
+                          (ui32XRange * (uint32_t)psKey->ui16Width) / 10000;
+        psRect->i16YMin = psPos->i16YMin + 1 +
+                          (ui32YRange * (uint32_t)psKey->ui16YPos) / 10000;
+        psRect->i16YMax = psRect->i16YMin - 3 +
+                          (ui32YRange * (uint32_t)psKey->ui16Height) / 10000;
+    }
+}
+
+//*****************************************************************************
+//
+// Brings the cached key rectangles and lookup grid up to date.
+//
+// \param psKeyWidget is a pointer to the keyboard widget.
+//
+// The cache is rebuilt only when the active keyboard or the widget extents
+// have changed since it was last built.
+//
+// \return Returns \b true if the cache is valid, or \b false if the active
+// keyboard has more than KEYBOARD_MAX_KEYS keys and is not cached.
+//
+//*****************************************************************************
+static bool
+KeyboardLayoutUpdate(tKeyboardWidget *psKeyWidget)
+{
+    const tKeyboard *psKeyboard;
+    const tRectangle *psPos;
+    tRectangle *psHit;
+    uint32_t ui32Key;
+    int32_t i32XRange, i32YRange;
+    int32_t i32Col, i32Row, i32Col0, i32Col1, i32Row0, i32Row1;
+    uint8_t *pui8Cell;
+
+    psKeyboard = &psKeyWidget->psKeyboards[psKeyWidget->ui32Active];
+    psPos = &psKeyWidget->sBase.sPosition;
+
+    if(psKeyboard->ui16NumKeys > KEYBOARD_MAX_KEYS)
+    {
+        return(false);
+    }
+
+    if((psKeyWidget->psLayout == psKeyboard) &&
+       (psKeyWidget->sLayoutPosition.i16XMin == psPos->i16XMin) &&
+       (psKeyWidget->sLayoutPosition.i16YMin == psPos->i16YMin) &&
+       (psKeyWidget->sLayoutPosition.i16XMax == psPos->i16XMax) &&
+       (psKeyWidget->sLayoutPosition.i16YMax == psPos->i16YMax))
+    {
+        return(true);
+    }
+
+    i32XRange = psPos->i16XMax - psPos->i16XMin + 1;
+    i32YRange = psPos->i16YMax - psPos->i16YMin + 1;
+
+    for(i32Col = 0; i32Col < (KEYBOARD_GRID_ROWS * KEYBOARD_GRID_COLS);
+        i32Col++)
+    {
+        psKeyWidget->ppui8Grid[i32Col][0] = GRID_EMPTY;
+        psKeyWidget->ppui8Grid[i32Col][1] = GRID_EMPTY;
+    }
+
+    for(ui32Key = 0; ui32Key < psKeyboard->ui16NumKeys; ui32Key++)
+    {
+        psHit = &psKeyWidget->psKeyHit[ui32Key];
+        KeyRectsCompute(psKeyWidget, &psKeyboard->uKeys.psKeysText[ui32Key],
+                        psHit, &psKeyWidget->psKeyRect[ui32Key]);
+
+        //
+        // Skip keys that lie wholly outside the widget; pointer events there
+        // are found by scanning.
+        //
+        if((psHit->i16XMax < psPos->i16XMin) ||
+           (psHit->i16XMin > psPos->i16XMax) ||
+           (psHit->i16YMax < psPos->i16YMin) ||
+           (psHit->i16YMin > psPos->i16YMax))
+        {
+            continue;
+        }
+
+        //
+        // Find the range of cells the key's hit area overlaps.
+        //
+        i32Col0 = (psHit->i16XMin > psPos->i16XMin) ? psHit->i16XMin :
+                                                      psPos->i16XMin;
+        i32Col1 = (psHit->i16XMax < psPos->i16XMax) ? psHit->i16XMax :
+                                                      psPos->i16XMax;
+        i32Row0 = (psHit->i16YMin > psPos->i16YMin) ? psHit->i16YMin :
+                                                      psPos->i16YMin;
+        i32Row1 = (psHit->i16YMax < psPos->i16YMax) ? psHit->i16YMax :
+                                                      psPos->i16YMax;
+        i32Col0 = ((i32Col0 - psPos->i16XMin) * KEYBOARD_GRID_COLS) /
+                  i32XRange;
+        i32Col1 = ((i32Col1 - psPos->i16XMin) * KEYBOARD_GRID_COLS) /
+                  i32XRange;
+        i32Row0 = ((i32Row0 - psPos->i16YMin) * KEYBOARD_GRID_ROWS) /
+                  i32YRange;
+        i32Row1 = ((i32Row1 - psPos->i16YMin) * KEYBOARD_GRID_ROWS) /
+                  i32YRange;
+
+        //
+        // Add the key to each of those cells.  Keys are added in index order,
+        // so each cell lists its keys lowest index first.
+        //
+        for(i32Row = i32Row0; i32Row <= i32Row1; i32Row++)
+        {
+            for(i32Col = i32Col0; i32Col <= i32Col1; i32Col++)
+            {
+                pui8Cell = psKeyWidget->ppui8Grid[(i32Row *
+                                                   KEYBOARD_GRID_COLS) +
+                                                  i32Col];
+                if(pui8Cell[0] == GRID_EMPTY)
+                {
+                    pui8Cell[0] = ui32Key;
+                }
+                else if((pui8Cell[0] != GRID_SCAN) &&
+                        (pui8Cell[1] == GRID_EMPTY))
+                {
+                    pui8Cell[1] = ui32Key;
+                }
+                else
+                {
+                    pui8Cell[0] = GRID_SCAN;
+                }
+            }
+        }
+    }
+
+    psKeyWidget->psLayout = psKeyboard;
+    psKeyWidget->sLayoutPosition = *psPos;
+
+    return(true);
+}
+
 //*****************************************************************************
 //
 //! Draws a key on the keyboard.
 //!
 //! \param psWidget is a pointer to the keyboard widget to be drawn.
 //! \param psKey is a pointer to the key to draw.
+//! \param psRect is a pointer to the key's bounding box.
 //!
 //! This function draws a single key on the display.  This is called whenever
 //! a key on the keyboard needs to be updated.
@@ -463,12 +649,13 @@ const tKeyboard g_psKeyboardUSEnglish[NUM_KEYBOARD_US_ENGLISH] =
 //
 //*****************************************************************************
 static void
-ButtonPaintText(tWidget *psWidget, const tKeyText *psKey)
+ButtonPaintText(tWidget *psWidget, const tKeyText *psKey,
+                const tRectangle *psRect)
 {
     tKeyboardWidget *psKeyboard;
     tContext sCtx;
     int32_t i32X, i32Y;
-    uint32_t ui32Range, ui32Size;
+    uint32_t ui32Size;
     tRectangle sRect;
     char pcKeyCap[4];
 
@@ -492,31 +679,25 @@ ButtonPaintText(tWidget *psWidget, const tKeyText *psKey)
     //
     GrContextClipRegionSet(&sCtx, &(psWidget->sPosition));
 
-    //
-    // Calculate a keys bounding box.
-    //
-    ui32Range = psWidget->sPosition.i16XMax - psWidget->sPosition.i16XMin + 1;
-    sRect.i16XMin = psWidget->sPosition.i16XMin + 1;
-    sRect.i16XMin += (ui32Range * (uint32_t)psKey->ui16XPos) / 10000;
-
-    sRect.i16XMax = sRect.i16XMin - 3 +
-                    ((ui32Range * (uint32_t)psKey->ui16Width) / 10000);
-
-    ui32Range = psWidget->sPosition.i16YMax - psWidget->sPosition.i16YMin + 1;
-    sRect.i16YMin = psWidget->sPosition.i16YMin + 1;
-    sRect.i16YMin += (ui32Range * (uint32_t)psKey->ui16YPos) / 10000;
-
-    sRect.i16YMax = sRect.i16YMin - 3 +
-                    ((ui32Range * (uint32_t)psKey->ui16Height) / 10000);
-
     //
     // See if the keyboard fill style is selected.
     //
     if(psKeyboard->ui32Style & KEYBOARD_STYLE_FILL)
     {
         //
-        // Fill the key with the fill color.
+        // Fill the key with the fill color.  If the key is outlined, fill
+        // only the inside, since the outline is drawn over the edge anyway.
         //
+        sRect = *psRect;
+        if((psKeyboard->ui32Style & KEYBOARD_STYLE_OUTLINE) &&
+           ((sRect.i16XMax - sRect.i16XMin) > 1) &&
+           ((sRect.i16YMax - sRect.i16YMin) > 1))
+        {
+            sRect.i16XMin++;
+            sRect.i16YMin++;
+            sRect.i16XMax--;
+            sRect.i16YMax--;
+        }
         GrContextForegroundSet(&sCtx,
                                ((psKeyboard->ui32Flags & FLAG_KEY_PRESSED) ?
                                 psKeyboard->ui32PressFillColor :
@@ -533,14 +714,14 @@ ButtonPaintText(tWidget *psWidget, const tKeyText *psKey)
         // Outline the key with the outline color.
         //
         GrContextForegroundSet(&sCtx, psKeyboard->ui32OutlineColor);
-        GrRectDraw(&sCtx, &sRect);
+        GrRectDraw(&sCtx, psRect);
     }
 
     //
     // Compute the center of the key.
     //
-    i32X = (sRect.i16XMin + ((sRect.i16XMax - sRect.i16XMin + 1) / 2));
-    i32Y = (sRect.i16YMin + ((sRect.i16YMax - sRect.i16YMin + 1) / 2));
+    i32X = (psRect->i16XMin + ((psRect->i16XMax - psRect->i16XMin + 1) / 2));
+    i32Y = (psRect->i16YMin + ((psRect->i16YMax - psRect->i16YMin + 1) / 2));
 
     //
     // If the keyboard outline style is selected then shrink the
@@ -603,6 +784,38 @@ ButtonPaintText(tWidget *psWidget, const tKeyText *psKey)
                        psKeyboard->ui32Style & KEYBOARD_STYLE_TEXT_OPAQUE);
 }
 
+//*****************************************************************************
+//
+// Draws one key of the active keyboard.
+//
+// \param psWidget is a pointer to the keyboard widget.
+// \param ui32Key is the index of the key in the active keyboard.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+KeyPaint(tWidget *psWidget, uint32_t ui32Key)
+{
+    tKeyboardWidget *psKeyWidget;
+    const tKeyText *psKey;
+    tRectangle sHit, sRect;
+
+    psKeyWidget = (tKeyboardWidget *)psWidget;
+    psKey = &psKeyWidget->psKeyboards[psKeyWidget->ui32Active].uKeys.
+                psKeysText[ui32Key];
+
+    if(KeyboardLayoutUpdate(psKeyWidget))
+    {
+        ButtonPaintText(psWidget, psKey, &psKeyWidget->psKeyRect[ui32Key]);
+    }
+    else
+    {
+        KeyRectsCompute(psKeyWidget, psKey, &sHit, &sRect);
+        ButtonPaintText(psWidget, psKey, &sRect);
+    }
+}
+
 //*****************************************************************************
 //
 //! Draws a the full keyboard.
@@ -651,7 +864,77 @@ KeyboardPaint(tWidget *psWidget)
 
     for(i32Key = 0; i32Key < psKeyboard->ui16NumKeys; i32Key++)
     {
-        ButtonPaintText(psWidget, &psKeyboard->uKeys.psKeysText[i32Key]);
+        KeyPaint(psWidget, i32Key);
+    }
+}
+
+//*****************************************************************************
+//
+// Changes the active keyboard and redraws what changed.
+//
+// \param psWidget is a pointer to the keyboard widget.
+// \param ui32Active is the index of the keyboard to make active.
+//
+// If the new keyboard has the same number of keys as the old one, each in the
+// same place, only the keys whose code differs are drawn.  This is the case
+// when switching between upper and lower case, and avoids clearing and
+// redrawing the whole keyboard on every shift.  Otherwise the whole keyboard
+// is drawn.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+KeyboardActiveSet(tWidget *psWidget, uint32_t ui32Active)
+{
+    tKeyboardWidget *psKeyWidget;
+    const tKeyboard *psOld, *psNew;
+    const tKeyText *psOldKey, *psNewKey;
+    uint32_t ui32Key;
+
+    psKeyWidget = (tKeyboardWidget *)psWidget;
+
+    if(ui32Active == psKeyWidget->ui32Active)
+    {
+        return;
+    }
+
+    psOld = &psKeyWidget->psKeyboards[psKeyWidget->ui32Active];
+    psNew = &psKeyWidget->psKeyboards[ui32Active];
+    psKeyWidget->ui32Active = ui32Active;
+
+    //
+    // See if every key is in the same place in both keyboards.
+    //
+    if(psOld->ui16NumKeys != psNew->ui16NumKeys)
+    {
+        KeyboardPaint(psWidget);
+        return;
+    }
+    for(ui32Key = 0; ui32Key < psNew->ui16NumKeys; ui32Key++)
+    {
+        psOldKey = &psOld->uKeys.psKeysText[ui32Key];
+        psNewKey = &psNew->uKeys.psKeysText[ui32Key];
+        if((psOldKey->ui16XPos != psNewKey->ui16XPos) ||
+           (psOldKey->ui16YPos != psNewKey->ui16YPos) ||
+           (psOldKey->ui16Width != psNewKey->ui16Width) ||
+           (psOldKey->ui16Height != psNewKey->ui16Height))
+        {
+            KeyboardPaint(psWidget);
+            return;
+        }
+    }
+
+    //
+    // Draw only the keys whose caps have changed.
+    //
+    for(ui32Key = 0; ui32Key < psNew->ui16NumKeys; ui32Key++)
+    {
+        if(psOld->uKeys.psKeysText[ui32Key].ui32Code !=
+           psNew->uKeys.psKeysText[ui32Key].ui32Code)
+        {
+            KeyPaint(psWidget, ui32Key);
+        }
     }
 }
 
@@ -669,6 +952,10 @@ KeyboardPaint(tWidget *psWidget)
 // key is returned if the key is not found the value is maximum number of keys
 // for the given keyboard indicated by psKeyboard->ui16NumKeys.
 //
+// The lookup grid reduces this to testing at most two keys.  Positions
+// outside the widget, and cells that overlap more than two keys, are tested
+// against every key's cached hit area.
+//
 // \return The key found or psKeyboard->ui16NumKeys if no key was found.
 //
 //*****************************************************************************
@@ -676,43 +963,67 @@ static uint32_t
 FindKey(tKeyboardWidget *psKeyWidget, const tKeyboard *psKeyboard,
         int32_t i32X, int32_t i32Y)
 {
-    uint32_t ui32Key;
-    uint32_t ui32Range;
-    int32_t i32XMin, i32XMax, i32YMin, i32YMax;
-    const tKeyText *psKey;
+    const tRectangle *psPos, *psHit;
+    tRectangle sHit;
+    const uint8_t *pui8Cell;
+    uint32_t ui32Key, ui32Idx;
 
-    //
-    // Pre-scale the positions to multiples of 10000.
-    //
-    i32X *= 10000;
-    i32Y *= 10000;
-
-    for(ui32Key = 0; ui32Key < psKeyboard->ui16NumKeys; ui32Key++)
+    if(!KeyboardLayoutUpdate(psKeyWidget))
     {
-        psKey = &psKeyboard->uKeys.psKeysText[ui32Key];
-
         //
-        // Find the X bounds of the key.
+        // The keyboard is too large to cache, so compute each key's bounds.
         //
-        ui32Range = psKeyWidget->sBase.sPosition.i16XMax -
-                    psKeyWidget->sBase.sPosition.i16XMin + 1;
-        i32XMin = psKeyWidget->sBase.sPosition.i16XMin * 10000;
-        i32XMin += (ui32Range * (uint32_t)psKey->ui16XPos);
+        for(ui32Key = 0; ui32Key < psKeyboard->ui16NumKeys; ui32Key++)
+        {
+            KeyRectsCompute(psKeyWidget, &psKeyboard->uKeys.psKeysText[ui32Key],
+                            &sHit, 0);
+            if((i32X >= sHit.i16XMin) && (i32X <= sHit.i16XMax) &&
+               (i32Y >= sHit.i16YMin) && (i32Y <= sHit.i16YMax))
+            {
+                break;
+            }
+        }
 
-        i32XMax = i32XMin + (ui32Range * (uint32_t)psKey->ui16Width);
+        return(ui32Key);
+    }
 
-        //
-        // Find the Y bounds of the key.
-        //
-        ui32Range = psKeyWidget->sBase.sPosition.i16YMax -
-                    psKeyWidget->sBase.sPosition.i16YMin + 1;
-        i32YMin = psKeyWidget->sBase.sPosition.i16YMin * 10000;
-        i32YMin += (ui32Range * (uint32_t)psKey->ui16YPos);
+    psPos = &psKeyWidget->sBase.sPosition;
+    if((i32X >= psPos->i16XMin) && (i32X <= psPos->i16XMax) &&
+       (i32Y >= psPos->i16YMin) && (i32Y <= psPos->i16YMax))
+    {
+        pui8Cell = psKeyWidget->ppui8Grid[
+            ((((i32Y - psPos->i16YMin) * KEYBOARD_GRID_ROWS) /
+              (psPos->i16YMax - psPos->i16YMin + 1)) * KEYBOARD_GRID_COLS) +
+            (((i32X - psPos->i16XMin) * KEYBOARD_GRID_COLS) /
+             (psPos->i16XMax - psPos->i16XMin + 1))];
 
-        i32YMax = i32YMin + (ui32Range * (uint32_t)psKey->ui16Height);
+        if(pui8Cell[0] != GRID_SCAN)
+        {
+            for(ui32Idx = 0; ui32Idx < 2; ui32Idx++)
+            {
+                ui32Key = pui8Cell[ui32Idx];
+                if(ui32Key == GRID_EMPTY)
+                {
+                    break;
+                }
+
+                psHit = &psKeyWidget->psKeyHit[ui32Key];
+                if((i32X >= psHit->i16XMin) && (i32X <= psHit->i16XMax) &&
+                   (i32Y >= psHit->i16YMin) && (i32Y <= psHit->i16YMax))
+                {
+                    return(ui32Key);
+                }
+            }
 
-        if((i32X >= i32XMin) && (i32X <= i32XMax) &&
-           (i32Y >= i32YMin) && (i32Y <= i32YMax))
+            return(psKeyboard->ui16NumKeys);
+        }
+    }
+
+    for(ui32Key = 0; ui32Key < psKeyboard->ui16NumKeys; ui32Key++)
+    {
+        psHit = &psKeyWidget->psKeyHit[ui32Key];
+        if((i32X >= psHit->i16XMin) && (i32X <= psHit->i16XMax) &&
+           (i32Y >= psHit->i16YMin) && (i32Y <= psHit->i16YMax))
         {
             break;
         }
@@ -791,8 +1102,7 @@ TextButtonEvent(tWidget *psWidget, uint32_t ui32Msg, int32_t i32X,
                 //
                 // Always clear the key that was last marked pressed.
                 //
-                ButtonPaintText(psWidget,
-                   &psKeyboard->uKeys.psKeysText[psKeyWidget->ui32KeyPressed]);
+                KeyPaint(psWidget, psKeyWidget->ui32KeyPressed);
             }
         }
 
@@ -828,14 +1138,14 @@ TextButtonEvent(tWidget *psWidget, uint32_t ui32Msg, int32_t i32X,
             {
                 if(psKeyWidget->ui32Active == 0)
                 {
-                    psKeyWidget->ui32Active = 1;
+                    KeyboardActiveSet(psWidget, 1);
                 }
                 else if(psKeyWidget->ui32Active == 1)
                 {
                     if(psKeyWidget->ui32Flags & FLAG_KEY_CAPSLOCK)
                     {
                         psKeyWidget->ui32Flags &= ~FLAG_KEY_CAPSLOCK;
-                        psKeyWidget->ui32Active = 0;
+                        KeyboardActiveSet(psWidget, 0);
                     }
                     else
                     {
@@ -844,13 +1154,9 @@ TextButtonEvent(tWidget *psWidget, uint32_t ui32Msg, int32_t i32X,
                 }
                 else
                 {
-                    psKeyWidget->ui32Active = 0;
+                    KeyboardActiveSet(psWidget, 0);
                 }
 
-                //
-                // Handle the widget paint request.
-                //
-                KeyboardPaint(psWidget);
                 return(1);
             }
             if(psKeyboard->uKeys.psKeysText[ui32Key].ui32Code ==
@@ -858,30 +1164,24 @@ TextButtonEvent(tWidget *psWidget, uint32_t ui32Msg, int32_t i32X,
             {
                 if(psKeyWidget->ui32Active == 2)
                 {
-                    psKeyWidget->ui32Active = 0;
+                    KeyboardActiveSet(psWidget, 0);
                 }
                 else
                 {
-                    psKeyWidget->ui32Active = 2;
+                    KeyboardActiveSet(psWidget, 2);
                 }
 
-                //
-                // Handle the widget paint request.
-                //
-                KeyboardPaint(psWidget);
-
                 return(1);
             }
             else if((psKeyWidget->ui32Active == 1) &&
                     ((psKeyWidget->ui32Flags & FLAG_KEY_CAPSLOCK) == 0))
             {
                 psKeyWidget->ui32Flags &= ~FLAG_KEY_CAPSLOCK;
-                psKeyWidget->ui32Active = 0;
 
                 //
-                // Handle the widget paint request.
+                // Return to lower case, redrawing only the keys that change.
                 //
-                KeyboardPaint(psWidget);
+                KeyboardActiveSet(psWidget, 0);
             }
 
             //
@@ -902,8 +1202,7 @@ TextButtonEvent(tWidget *psWidget, uint32_t ui32Msg, int32_t i32X,
                 //
                 psKeyWidget->ui32KeyPressed = ui32Key;
 
-                ButtonPaintText(psWidget,
-                                &psKeyboard->uKeys.psKeysText[ui32Key]);
+                KeyPaint(psWidget, ui32Key);
             }
         }
 
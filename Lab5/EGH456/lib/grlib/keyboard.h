@@ -237,6 +237,26 @@ typedef struct
 }
 tKeyboard;
 
+//*****************************************************************************
+//
+//! The largest number of keys in a keyboard whose layout the widget caches.
+//! Keyboards with more keys still work, but each key's rectangle is then
+//! recomputed on every pointer event and every paint.
+//
+//*****************************************************************************
+#ifndef KEYBOARD_MAX_KEYS
+#define KEYBOARD_MAX_KEYS       40
+#endif
+
+//*****************************************************************************
+//
+//! The number of columns and rows in the grid used to find the key under the
+//! pointer.
+//
+//*****************************************************************************
+#define KEYBOARD_GRID_COLS      16
+#define KEYBOARD_GRID_ROWS      8
+
 //*****************************************************************************
 //
 //! The structure that describes a keyboard widget.
@@ -346,6 +366,35 @@ typedef struct
     //! Internal state flags for the keyboard.
     //
     uint32_t ui32Flags;
+
+    //
+    //! The keyboard for which the key rectangles and grid below were
+    //! computed, or 0 if they have not been computed yet.
+    //
+    const tKeyboard *psLayout;
+
+    //
+    //! The widget extents for which the key rectangles and grid below were
+    //! computed.
+    //
+    tRectangle sLayoutPosition;
+
+    //
+    //! The area in which a pointer event selects each key.
+    //
+    tRectangle psKeyHit[KEYBOARD_MAX_KEYS];
+
+    //
+    //! The rectangle drawn for each key.
+    //
+    tRectangle psKeyRect[KEYBOARD_MAX_KEYS];
+
+    //
+    //! The key lookup grid, which divides the widget into
+    //! KEYBOARD_GRID_COLS by KEYBOARD_GRID_ROWS cells.  Each cell lists, lowest
+    //! index first, the up to two keys whose hit areas overlap it.
+    //
+    uint8_t ppui8Grid[KEYBOARD_GRID_ROWS * KEYBOARD_GRID_COLS][2];
 }
 tKeyboardWidget;
 
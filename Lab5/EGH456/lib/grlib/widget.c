@@ -235,6 +235,7 @@ WidgetMutexInit(uint8_t *pi8Mutex)
 //! already held by another caller.
 //
 //*****************************************************************************
+#if defined(__arm__)
 uint32_t __attribute__((naked))
 WidgetMutexGet(uint8_t *pi8Mutex)
 {
@@ -260,6 +261,22 @@ WidgetMutexGet(uint8_t *pi8Mutex)
     //
     return(ui32Ret);
 }
+#else
+//
+// Host builds (host/hal_host) run on one thread, so a plain test and set is
+// enough.
+//
+uint32_t
+WidgetMutexGet(uint8_t *pi8Mutex)
+{
+    if(*pi8Mutex)
+    {
+        return(1);
+    }
+    *pi8Mutex = 1;
+    return(0);
+}
+#endif
 
 #if defined(ewarm) || defined(DOXYGEN)
 uint32_t
@@ -52,7 +52,7 @@
 #define configUSE_PREEMPTION                1
 #define configUSE_IDLE_HOOK                 1
 #define configUSE_TICK_HOOK                 0
-#define configCPU_CLOCK_HZ                  ( ( unsigned long ) 120000000 )
+#define configCPU_CLOCK_HZ                  ( ClockFreqGet() )
 #define configTICK_RATE_HZ                  ( ( portTickType ) 1000 )
 #define configMINIMAL_STACK_SIZE            ( ( unsigned short ) 200 )
 #define configTOTAL_HEAP_SIZE               ( ( size_t ) ( 20240 ) )
@@ -63,7 +63,43 @@
 #define configUSE_CO_ROUTINES               0
 #define configUSE_MUTEXES                   1
 #define configUSE_RECURSIVE_MUTEXES         1
+
+/* Stack overflow checking.  By default a no-write MPU region is moved to the
+bottom of each task's stack as it is switched in (drivers/stack_guard.c), so
+an overflow faults at the instruction that makes it and the kernel's pattern
+check on every switch is left out.  Build with -DSTACK_GUARD_MPU=0 for
+method 2 instead.  STACK_GUARD_MOVE() is one store to NVIC_MPU_BASE, with
+VALID set so that it also selects the region. */
+#ifndef STACK_GUARD_MPU
+#define STACK_GUARD_MPU                     1
+#endif
+#define STACK_GUARD_REGION                  7
+#define STACK_GUARD_SIZE                    32
+#define STACK_GUARD_MOVE( pvStack )                                         \
+    ( *( ( volatile uint32_t * ) 0xE000ED9CUL ) =                           \
+        ( ( ( uint32_t ) ( pvStack ) + STACK_GUARD_SIZE - 1 ) &             \
+          ~( uint32_t ) ( STACK_GUARD_SIZE - 1 ) ) |                        \
+        0x10UL | STACK_GUARD_REGION )
+#if STACK_GUARD_MPU
+#define configCHECK_FOR_STACK_OVERFLOW      0
+#define traceTASK_SWITCHED_IN()             STACK_GUARD_MOVE( pxCurrentTCB->pxStack )
+#else
 #define configCHECK_FOR_STACK_OVERFLOW      2
+#endif
+
+#define configGENERATE_RUN_TIME_STATS       1
+
+/* The system clock changes at run time (drivers/clock_scale.c), so the CPU
+clock is read rather than fixed, and the run time statistics counter is a
+timer clocked from the PIOSC. */
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+extern uint32_t ClockFreqGet( void );
+extern void vClockRunTimeInit( void );
+extern uint32_t ulClockRunTimeGet( void );
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    vClockRunTimeInit()
+#define portGET_RUN_TIME_COUNTER_VALUE()            ulClockRunTimeGet()
 
 //#define configMAX_PRIORITIES                ( ( unsigned portBASE_TYPE ) 16 )
 #define configMAX_PRIORITIES ( 16 )
@@ -81,6 +117,8 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelayUntil             1
 #define INCLUDE_vTaskDelay                  1
 #define INCLUDE_uxTaskGetStackHighWaterMark 1
+#define INCLUDE_xTaskGetIdleTaskHandle      1
+#define INCLUDE_xTaskGetSchedulerState      1
 
 /* Cortex-M3/4 interrupt priority configuration follows...................... */
 
@@ -29,6 +29,7 @@
 #include "inc/hw_gpio.h"
 #include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
+#include "inc/hw_ssi.h"
 #include "inc/hw_types.h"
 #include "driverlib/ssi.h"
 #include "driverlib/gpio.h"
@@ -37,8 +38,16 @@
 #include "driverlib/timer.h"
 #include "driverlib/rom.h"
 #include "driverlib/pin_map.h"
+#include "driverlib/udma.h"
 #include "grlib/grlib.h"
 #include "drivers/Kentec320x240x16_ssd2119_spi.h"
+#include "drivers/clock_scale.h"
+#include "drivers/cycle_counter.h"
+#include "drivers/gpio_fast.h"
+#include "drivers/udma_ctl.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
 
 //*****************************************************************************
 //
@@ -177,6 +186,17 @@
 #define LCD_LED_BASE            GPIO_PORTG_BASE
 #define LCD_LED_PIN             GPIO_PIN_1
 
+//*****************************************************************************
+//
+// Accessors for the control pins.  Chip select and data/command change for
+// every word sent, so they are written with single stores rather than
+// through GPIOPinWrite() (see gpio_fast.h).
+//
+//*****************************************************************************
+GPIO_FAST_PIN(LCDCS, LCD_CS_BASE, LCD_CS_PIN)
+GPIO_FAST_PIN(LCDDC, LCD_DC_BASE, LCD_DC_PIN)
+GPIO_FAST_PIN(LCDLED, LCD_LED_BASE, LCD_LED_PIN)
+
 //*****************************************************************************
 //
 // Defines for the SSI controller and pins that are used to communicate with
@@ -193,6 +213,17 @@
 #define LCD_SSI_CLK_PIN         GPIO_PIN_0
 #define LCD_SSI_TX_PIN          GPIO_PIN_2
 
+//*****************************************************************************
+//
+// The uDMA channel and interrupt used to send windows of pixels, and the most
+// pixels one transfer can move.
+//
+//*****************************************************************************
+#define LCD_SSI_INT             INT_SSI3
+#define LCD_DMA                 UDMA_CH15_SSI3TX
+#define LCD_DMA_CHANNEL         (LCD_DMA & 0xff)
+#define LCD_DMA_MAX_ITEMS       1024
+
 //*****************************************************************************
 //
 // The dimensions of the LCD panel.
@@ -228,7 +259,7 @@
 static inline void
 LED_ON(void)
 {
-    GPIOPinWrite(LCD_LED_BASE, LCD_LED_PIN, LCD_LED_PIN);
+    LCDLEDSet();
 }
 
 //*****************************************************************************
@@ -239,8 +270,49 @@ LED_ON(void)
 static inline void
 LED_OFF(void)
 {
-    GPIOPinWrite(LCD_LED_BASE, LCD_LED_PIN, 0);
+    LCDLEDClear();
+}
+
+//*****************************************************************************
+//
+// A window of pixels being sent with uDMA.  A transfer never crosses the end
+// of a row unless the rows follow each other in memory; the SSI interrupt
+// starts the next one until the window is done.
+//
+//*****************************************************************************
+typedef struct
+{
+    const uint16_t *pui16Row;
+    uint32_t ui32Offset;
+    uint32_t ui32Width;
+    uint32_t ui32Stride;
+    uint32_t ui32Rows;
 }
+LCDDma_t;
+
+static LCDDma_t g_sLCDDma;
+static SemaphoreHandle_t g_xLCDDmaDone;
+static bool g_bLCDDmaReady = false;
+static volatile bool g_bLCDDmaActive = false;
+static bool g_bLCDWindowOpen = false;
+static uint32_t g_ui32LCDFrameBits = 8;
+
+//
+// Set from the start of a system clock change until the SSI has been
+// reprogrammed for the new clock; windows meanwhile are written without uDMA.
+//
+static volatile bool g_bLCDClockHold = false;
+
+//*****************************************************************************
+//
+// The last values written to the entry mode and window registers, so that
+// writes that would not change them can be left out.
+//
+//*****************************************************************************
+static uint16_t g_ui16LCDEntryMode;
+static uint16_t g_ui16LCDHStart;
+static uint16_t g_ui16LCDHEnd;
+static uint16_t g_ui16LCDVPos;
 
 //*****************************************************************************
 //
@@ -262,8 +334,8 @@ WriteDataSPI(uint16_t ui16Data)
     //
     pui16Data[1] = ui16Data;
 
-    GPIOPinWrite(LCD_DC_BASE, LCD_DC_PIN, LCD_DC_PIN);
-    GPIOPinWrite(LCD_CS_BASE, LCD_CS_PIN, 0);
+    LCDDCSet();
+    LCDCSClear();
 
     SSIDataPut(LCD_SSI_BASE, pui16Data[0]);
     SSIDataPut(LCD_SSI_BASE, pui16Data[1]);
@@ -273,7 +345,7 @@ WriteDataSPI(uint16_t ui16Data)
     //
     while(SSIBusy(LCD_SSI_BASE)){ }
 
-    GPIOPinWrite(LCD_CS_BASE, LCD_CS_PIN, LCD_CS_PIN);
+    LCDCSSet();
 }
 
 //*****************************************************************************
@@ -286,6 +358,14 @@ WriteCommandSPI(uint16_t ui16Data)
 {
     uint16_t pui16Data[2];
 
+    //
+    // A window being sent with uDMA holds the bus until it is done.
+    //
+    if(g_bLCDWindowOpen)
+    {
+        Kentec320x240x16_SSD2119WindowWait(0);
+    }
+
     //
     // Write the most significant byte of the data to the bus.
     //
@@ -296,8 +376,8 @@ WriteCommandSPI(uint16_t ui16Data)
     //
     pui16Data[1] = ui16Data;
 
-    GPIOPinWrite(LCD_DC_BASE, LCD_DC_PIN, 0);
-    GPIOPinWrite(LCD_CS_BASE, LCD_CS_PIN, 0);
+    LCDDCClear();
+    LCDCSClear();
 
     SSIDataPut(LCD_SSI_BASE, pui16Data[0]);
     SSIDataPut(LCD_SSI_BASE, pui16Data[1]);
@@ -307,7 +387,253 @@ WriteCommandSPI(uint16_t ui16Data)
     //
     while(SSIBusy(LCD_SSI_BASE)){ }
 
-    GPIOPinWrite(LCD_CS_BASE, LCD_CS_PIN, LCD_CS_PIN);
+    LCDCSSet();
+}
+
+//*****************************************************************************
+//
+// Writes the same data word to the SSD2119 a number of times.  Chip select is
+// held low for the whole run and the SSI FIFO is kept full, so the bus does
+// not stop after every word for the FIFO to drain.
+//
+//*****************************************************************************
+static void
+WriteDataRepeatSPI(uint16_t ui16Data, uint32_t ui32Count)
+{
+    LCDDCSet();
+    LCDCSClear();
+
+    while(ui32Count--)
+    {
+        SSIDataPut(LCD_SSI_BASE, ui16Data >> 8);
+        SSIDataPut(LCD_SSI_BASE, ui16Data & 0xff);
+    }
+
+    //
+    // Wait until SSI0 is done transferring all the data in the transmit FIFO.
+    //
+    while(SSIBusy(LCD_SSI_BASE)){ }
+
+    LCDCSSet();
+}
+
+//*****************************************************************************
+//
+// Writes a register whose last value is cached, if the value has changed.
+//
+//*****************************************************************************
+static void
+WriteRegCachedSPI(uint16_t ui16Reg, uint16_t ui16Data, uint16_t *pui16Cache)
+{
+    if(*pui16Cache != ui16Data)
+    {
+        WriteCommandSPI(ui16Reg);
+        WriteDataSPI(ui16Data);
+        *pui16Cache = ui16Data;
+    }
+}
+
+//*****************************************************************************
+//
+// Sets the cursor increment, and the window the cursor wraps within to a
+// rectangle in application coordinates, or to the whole panel if pRect is 0.
+//
+//*****************************************************************************
+static void
+LCDWindowSet(uint16_t ui16EntryMode, const tRectangle *pRect)
+{
+    WriteRegCachedSPI(SSD2119_ENTRY_MODE_REG, ui16EntryMode,
+                      &g_ui16LCDEntryMode);
+
+    if(!pRect)
+    {
+        WriteRegCachedSPI(SSD2119_H_RAM_START_REG, 0x0000, &g_ui16LCDHStart);
+        WriteRegCachedSPI(SSD2119_H_RAM_END_REG, LCD_HORIZONTAL_MAX - 1,
+                          &g_ui16LCDHEnd);
+        WriteRegCachedSPI(SSD2119_V_RAM_POS_REG, (LCD_VERTICAL_MAX - 1) << 8,
+                          &g_ui16LCDVPos);
+        return;
+    }
+
+    //
+    // Write the X extents of the rectangle.
+    //
+#if (defined PORTRAIT) || (defined LANDSCAPE)
+    WriteRegCachedSPI(SSD2119_H_RAM_START_REG,
+                      MAPPED_X(pRect->i16XMax, pRect->i16YMax),
+                      &g_ui16LCDHStart);
+    WriteRegCachedSPI(SSD2119_H_RAM_END_REG,
+                      MAPPED_X(pRect->i16XMin, pRect->i16YMin),
+                      &g_ui16LCDHEnd);
+#else
+    WriteRegCachedSPI(SSD2119_H_RAM_START_REG,
+                      MAPPED_X(pRect->i16XMin, pRect->i16YMin),
+                      &g_ui16LCDHStart);
+    WriteRegCachedSPI(SSD2119_H_RAM_END_REG,
+                      MAPPED_X(pRect->i16XMax, pRect->i16YMax),
+                      &g_ui16LCDHEnd);
+#endif
+
+    //
+    // Write the Y extents of the rectangle.
+    //
+#if (defined LANDSCAPE_FLIP) || (defined PORTRAIT)
+    WriteRegCachedSPI(SSD2119_V_RAM_POS_REG,
+                      MAPPED_Y(pRect->i16XMin, pRect->i16YMin) |
+                      (MAPPED_Y(pRect->i16XMax, pRect->i16YMax) << 8),
+                      &g_ui16LCDVPos);
+#else
+    WriteRegCachedSPI(SSD2119_V_RAM_POS_REG,
+                      MAPPED_Y(pRect->i16XMax, pRect->i16YMax) |
+                      (MAPPED_Y(pRect->i16XMin, pRect->i16YMin) << 8),
+                      &g_ui16LCDVPos);
+#endif
+}
+
+//*****************************************************************************
+//
+// Sets the width of the SSI frames.  Pixels sent with uDMA go as single
+// 16-bit frames, which are the same on the wire as the two bytes written by
+// everything else.
+//
+//*****************************************************************************
+static void
+LCDFrameBitsSet(uint32_t ui32Bits)
+{
+    if(g_ui32LCDFrameBits != ui32Bits)
+    {
+        while(SSIBusy(LCD_SSI_BASE)){ }
+        SSIDisable(LCD_SSI_BASE);
+        HWREG(LCD_SSI_BASE + SSI_O_CR0) =
+            (HWREG(LCD_SSI_BASE + SSI_O_CR0) & ~SSI_CR0_DSS_M) |
+            (ui32Bits - 1);
+        SSIEnable(LCD_SSI_BASE);
+        g_ui32LCDFrameBits = ui32Bits;
+    }
+}
+
+//*****************************************************************************
+//
+// Starts the next transfer of the window being sent, returning false if the
+// window is done.
+//
+//*****************************************************************************
+static bool
+LCDDmaNext(void)
+{
+    LCDDma_t *psDma = &g_sLCDDma;
+    uint32_t ui32Count;
+
+    if(psDma->ui32Offset == psDma->ui32Width)
+    {
+        if(--psDma->ui32Rows == 0)
+        {
+            return(false);
+        }
+        psDma->pui16Row += psDma->ui32Stride;
+        psDma->ui32Offset = 0;
+    }
+
+    ui32Count = psDma->ui32Width - psDma->ui32Offset;
+    if(ui32Count > LCD_DMA_MAX_ITEMS)
+    {
+        ui32Count = LCD_DMA_MAX_ITEMS;
+    }
+
+    uDMAChannelTransferSet(LCD_DMA_CHANNEL | UDMA_PRI_SELECT,
+                           UDMA_MODE_BASIC,
+                           (void *)(psDma->pui16Row + psDma->ui32Offset),
+                           (void *)(LCD_SSI_BASE + SSI_O_DR), ui32Count);
+    uDMAChannelEnable(LCD_DMA_CHANNEL);
+    psDma->ui32Offset += ui32Count;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// The SSI3 interrupt, raised when a transfer has been handed to the transmit
+// FIFO.  Starts the next one or, at the end of the window, wakes the task
+// waiting for it.
+//
+//*****************************************************************************
+static void
+LCDSSIIntHandler(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    SSIIntClear(LCD_SSI_BASE, SSIIntStatus(LCD_SSI_BASE, true));
+
+    if(g_bLCDDmaActive && !LCDDmaNext())
+    {
+        g_bLCDDmaActive = false;
+        xSemaphoreGiveFromISR(g_xLCDDmaDone, &xHigherPriorityTaskWoken);
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+//*****************************************************************************
+//
+// Claims the uDMA channel for SSI3.  Without it, windows are written by the
+// CPU instead.
+//
+//*****************************************************************************
+static void
+LCDDmaInit(void)
+{
+    if(g_bLCDDmaReady)
+    {
+        return;
+    }
+
+    DMAControlInit();
+    if(!DMAChannelClaim(LCD_DMA))
+    {
+        return;
+    }
+    g_xLCDDmaDone = xSemaphoreCreateBinary();
+    if(!g_xLCDDmaDone)
+    {
+        DMAChannelRelease(LCD_DMA);
+        return;
+    }
+
+    uDMAChannelAttributeDisable(LCD_DMA_CHANNEL, UDMA_ATTR_ALL);
+    uDMAChannelControlSet(LCD_DMA_CHANNEL | UDMA_PRI_SELECT,
+                          UDMA_SIZE_16 | UDMA_SRC_INC_16 | UDMA_DST_INC_NONE |
+                          UDMA_ARB_4);
+
+    IntRegister(LCD_SSI_INT, LCDSSIIntHandler);
+    IntPrioritySet(LCD_SSI_INT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    SSIIntEnable(LCD_SSI_BASE, SSI_DMATX);
+    SSIDMAEnable(LCD_SSI_BASE, SSI_DMA_TX);
+    IntEnable(LCD_SSI_INT);
+
+    g_bLCDDmaReady = true;
+}
+
+//*****************************************************************************
+//
+// Waits for at least the given number of milliseconds.  Once the scheduler is
+// running the calling task sleeps instead of spinning, so other tasks can
+// bring up their peripherals while the panel resets and powers up.
+//
+//*****************************************************************************
+static void
+DelayMS(uint32_t ui32Ms, uint32_t ui32ClockMS)
+{
+    if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+    {
+        //
+        // The first tick may be only part of a millisecond away.
+        //
+        vTaskDelay(pdMS_TO_TICKS(ui32Ms) + 1);
+    }
+    else
+    {
+        SysCtlDelay(ui32Ms * ui32ClockMS);
+    }
 }
 
 //*****************************************************************************
@@ -410,6 +736,62 @@ InitSPILCDInterface(uint32_t ui32SysClock)
 
 }
 
+//*****************************************************************************
+//
+// Lets a window going out with uDMA finish before a system clock change, and
+// keeps new ones off the uDMA until the SSI has been reprogrammed.  Runs in
+// the task changing the clock, outside its critical section, so it may
+// block; the post notifier runs inside it, with the SSI interrupt masked.
+//
+//*****************************************************************************
+static void
+LCDClockPre(uint32_t ui32NewHz, void *pvArg)
+{
+    (void)ui32NewHz;
+    (void)pvArg;
+
+    taskENTER_CRITICAL();
+    g_bLCDClockHold = true;
+    taskEXIT_CRITICAL();
+
+    Kentec320x240x16_SSD2119WindowWait(0);
+}
+
+//*****************************************************************************
+//
+// Reprograms the SSI bit rate after a system clock change.  The SSI can run
+// at no more than half the system clock, so at the slower levels the panel is
+// written at that rate instead of 15 MHz.
+//
+//*****************************************************************************
+static void
+LCDClockPost(uint32_t ui32NewHz, void *pvArg)
+{
+    uint32_t ui32BitRate;
+
+    (void)pvArg;
+
+    ui32BitRate = (ui32NewHz / 2 < 15000000) ? ui32NewHz / 2 : 15000000;
+
+    //
+    // No uDMA window is open, as LCDClockPre() waited for it; only what is
+    // left in the FIFO has to go out.
+    //
+    while(SSIBusy(LCD_SSI_BASE)){ }
+    SSIDisable(LCD_SSI_BASE);
+    SSIConfigSetExpClk(LCD_SSI_BASE, ui32NewHz, SSI_FRF_MOTO_MODE_0,
+            SSI_MODE_MASTER, ui32BitRate, g_ui32LCDFrameBits);
+    SSIEnable(LCD_SSI_BASE);
+
+    g_bLCDClockHold = false;
+}
+
+static ClockNotifier_t g_sLCDClockNotifier =
+{
+    LCDClockPre, LCDClockPost, 0, 0
+};
+static bool g_bLCDClockNotifierRegistered = false;
+
 //*****************************************************************************
 //
 //! Initializes the display driver.
@@ -419,13 +801,16 @@ InitSPILCDInterface(uint32_t ui32SysClock)
 //! This function initializes the LCD controller and the SSD2119 display
 //! controller on the panel, preparing it to display data.
 //!
+//! When called from a task, the task sleeps through the panel reset and power
+//! up delays, so other tasks can run.
+//!
 //! \return None.
 //
 //*****************************************************************************
 void
 Kentec320x240x16_SSD2119Init(uint32_t ui32SysClock)
 {
-    uint32_t ui32ClockMS, ui32Count;
+    uint32_t ui32ClockMS, ui32Start, ui32Ms;
 
     //
     // Divide by 3 to get the number of SysCtlDelay loops in 1mS.
@@ -436,6 +821,12 @@ Kentec320x240x16_SSD2119Init(uint32_t ui32SysClock)
     // Initializes the SPI Controller for the LCD controller
     //
     InitSPILCDInterface(ui32SysClock);
+    if(!g_bLCDClockNotifierRegistered)
+    {
+        ClockNotifierRegister(&g_sLCDClockNotifier);
+        g_bLCDClockNotifierRegistered = true;
+    }
+    LCDDmaInit();
 
     //
     // Switch off the LED backlight
@@ -446,9 +837,9 @@ Kentec320x240x16_SSD2119Init(uint32_t ui32SysClock)
     // Reset the LCD
     //
     GPIOPinWrite(LCD_RST_BASE, LCD_RST_PIN, 0);
-    SysCtlDelay(10 * ui32ClockMS);
+    DelayMS(10, ui32ClockMS);
     GPIOPinWrite(LCD_RST_BASE, LCD_RST_PIN, LCD_RST_PIN);
-    SysCtlDelay(20 * ui32ClockMS);
+    DelayMS(20, ui32ClockMS);
 
     //
     // Enter sleep mode (if we are not already there).
@@ -483,17 +874,49 @@ Kentec320x240x16_SSD2119Init(uint32_t ui32SysClock)
     //
     WriteCommandSPI(SSD2119_SLEEP_MODE_1_REG);
     WriteDataSPI(0x0000);
+    CycleCounterInit();
+    ui32Start = CycleCounterGet();
 
     //
-    // Delay 30mS
+    // The panel supplies need 30mS to settle before the display is enabled.
+    // The controller accepts writes in the meantime, so the display buffer
+    // is cleared now rather than after the wait.  First configure pixel color
+    // format and MCU interface parameters.
     //
-    SysCtlDelay(30 * ui32ClockMS);
+    WriteCommandSPI(SSD2119_ENTRY_MODE_REG);
+    WriteDataSPI(ENTRY_MODE_DEFAULT);
 
     //
-    // Configure pixel color format and MCU interface parameters.
+    // Set the display size and ensure that the GRAM window is set to allow
+    // access to the full display buffer.
     //
-    WriteCommandSPI(SSD2119_ENTRY_MODE_REG);
-    WriteDataSPI(ENTRY_MODE_DEFAULT);
+    WriteCommandSPI(SSD2119_V_RAM_POS_REG);
+    WriteDataSPI((LCD_VERTICAL_MAX-1) << 8);
+    WriteCommandSPI(SSD2119_H_RAM_START_REG);
+    WriteDataSPI(0x0000);
+    WriteCommandSPI(SSD2119_H_RAM_END_REG);
+    WriteDataSPI(LCD_HORIZONTAL_MAX-1);
+    WriteCommandSPI(SSD2119_X_RAM_ADDR_REG);
+    WriteDataSPI(0x00);
+    WriteCommandSPI(SSD2119_Y_RAM_ADDR_REG);
+    WriteDataSPI(0x00);
+    g_ui16LCDEntryMode = ENTRY_MODE_DEFAULT;
+    g_ui16LCDVPos = (LCD_VERTICAL_MAX-1) << 8;
+    g_ui16LCDHStart = 0x0000;
+    g_ui16LCDHEnd = LCD_HORIZONTAL_MAX-1;
+
+    //
+    // Clear the contents of the display buffer.  At 15 MHz this takes about
+    // 82mS, so normally nothing is left of the 30mS.
+    //
+    WriteCommandSPI(SSD2119_RAM_DATA_REG);
+    WriteDataRepeatSPI(0x0000, 320 * 240);
+
+    ui32Ms = (CycleCounterGet() - ui32Start) / (3 * ui32ClockMS);
+    if(ui32Ms < 30)
+    {
+        DelayMS(30 - ui32Ms, ui32ClockMS);
+    }
 
     //
     // Enable the display.
@@ -539,30 +962,6 @@ Kentec320x240x16_SSD2119Init(uint32_t ui32SysClock)
     WriteCommandSPI(SSD2119_PWR_CTRL_4_REG);
     WriteDataSPI(0x3100);
 
-    //
-    // Set the display size and ensure that the GRAM window is set to allow
-    // access to the full display buffer.
-    //
-    WriteCommandSPI(SSD2119_V_RAM_POS_REG);
-    WriteDataSPI((LCD_VERTICAL_MAX-1) << 8);
-    WriteCommandSPI(SSD2119_H_RAM_START_REG);
-    WriteDataSPI(0x0000);
-    WriteCommandSPI(SSD2119_H_RAM_END_REG);
-    WriteDataSPI(LCD_HORIZONTAL_MAX-1);
-    WriteCommandSPI(SSD2119_X_RAM_ADDR_REG);
-    WriteDataSPI(0x00);
-    WriteCommandSPI(SSD2119_Y_RAM_ADDR_REG);
-    WriteDataSPI(0x00);
-
-    //
-    // Clear the contents of the display buffer.
-    //
-    WriteCommandSPI(SSD2119_RAM_DATA_REG);
-    for(ui32Count = 0; ui32Count < (320 * 240); ui32Count++)
-    {
-        WriteDataSPI(0x0000);
-    }
-
     //
     // Switch on the LED backlight
     //
@@ -590,6 +989,11 @@ Kentec320x240x16_SSD2119PixelDraw(void *pvDisplayData, int32_t i32X,
         int32_t i32Y,
         uint32_t ui32Value)
 {
+    //
+    // Make sure the whole panel is writable; the direction does not matter.
+    //
+    LCDWindowSet(g_ui16LCDEntryMode, 0);
+
     //
     // Set the X address of the display cursor.
     //
@@ -644,10 +1048,10 @@ Kentec320x240x16_SSD2119PixelDrawMultiple(void *pvDisplayData, int32_t i32X,
     uint32_t ui32Byte;
 
     //
-    // Set the cursor increment to left to right, followed by top to bottom.
+    // Set the cursor increment to left to right, followed by top to bottom,
+    // over the whole panel.
     //
-    WriteCommandSPI(SSD2119_ENTRY_MODE_REG);
-    WriteDataSPI(MAKE_ENTRY_MODE(HORIZ_DIRECTION));
+    LCDWindowSet(MAKE_ENTRY_MODE(HORIZ_DIRECTION), 0);
 
     //
     // Set the starting X address of the display cursor.
@@ -868,10 +1272,10 @@ Kentec320x240x16_SSD2119LineDrawH(void *pvDisplayData, int32_t i32X1,
         uint32_t ui32Value)
 {
     //
-    // Set the cursor increment to left to right, followed by top to bottom.
+    // Set the cursor increment to left to right, followed by top to bottom,
+    // over the whole panel.
     //
-    WriteCommandSPI(SSD2119_ENTRY_MODE_REG);
-    WriteDataSPI(MAKE_ENTRY_MODE(HORIZ_DIRECTION));
+    LCDWindowSet(MAKE_ENTRY_MODE(HORIZ_DIRECTION), 0);
 
     //
     // Set the starting X address of the display cursor.
@@ -925,10 +1329,10 @@ Kentec320x240x16_SSD2119LineDrawV(void *pvDisplayData, int32_t i32X,
         uint32_t ui32Value)
 {
     //
-    // Set the cursor increment to top to bottom, followed by left to right.
+    // Set the cursor increment to top to bottom, followed by left to right,
+    // over the whole panel.
     //
-    WriteCommandSPI(SSD2119_ENTRY_MODE_REG);
-    WriteDataSPI(MAKE_ENTRY_MODE(VERT_DIRECTION));
+    LCDWindowSet(MAKE_ENTRY_MODE(VERT_DIRECTION), 0);
 
     //
     // Set the X address of the display cursor.
@@ -983,39 +1387,11 @@ Kentec320x240x16_SSD2119RectFill(void *pvDisplayData, const tRectangle *pRect,
     int32_t i32Count;
 
     //
-    // Write the Y extents of the rectangle.
+    // Limit the cursor to the rectangle.  The window is left set: the next
+    // call that needs the whole panel puts it back, and a run of fills of
+    // the same size does not have to.
     //
-    WriteCommandSPI(SSD2119_ENTRY_MODE_REG);
-    WriteDataSPI(MAKE_ENTRY_MODE(HORIZ_DIRECTION));
-
-    //
-    // Write the X extents of the rectangle.
-    //
-    WriteCommandSPI(SSD2119_H_RAM_START_REG);
-#if (defined PORTRAIT) || (defined LANDSCAPE)
-    WriteDataSPI(MAPPED_X(pRect->i16XMax, pRect->i16YMax));
-#else
-    WriteDataSPI(MAPPED_X(pRect->i16XMin, pRect->i16YMin));
-#endif
-
-    WriteCommandSPI(SSD2119_H_RAM_END_REG);
-#if (defined PORTRAIT) || (defined LANDSCAPE)
-    WriteDataSPI(MAPPED_X(pRect->i16XMin, pRect->i16YMin));
-#else
-    WriteDataSPI(MAPPED_X(pRect->i16XMax, pRect->i16YMax));
-#endif
-
-    //
-    // Write the Y extents of the rectangle
-    //
-    WriteCommandSPI(SSD2119_V_RAM_POS_REG);
-#if (defined LANDSCAPE_FLIP) || (defined PORTRAIT)
-    WriteDataSPI(MAPPED_Y(pRect->i16XMin, pRect->i16YMin) |
-             (MAPPED_Y(pRect->i16XMax, pRect->i16YMax) << 8));
-#else
-    WriteDataSPI(MAPPED_Y(pRect->i16XMax, pRect->i16YMax) |
-             (MAPPED_Y(pRect->i16XMin, pRect->i16YMin) << 8));
-#endif
+    LCDWindowSet(MAKE_ENTRY_MODE(HORIZ_DIRECTION), pRect);
 
     //
     // Set the display cursor to the upper left of the rectangle (in
@@ -1044,20 +1420,6 @@ Kentec320x240x16_SSD2119RectFill(void *pvDisplayData, const tRectangle *pRect,
         //
         WriteDataSPI(ui32Value);
     }
-
-    //
-    // Reset the X extents to the entire screen.
-    //
-    WriteCommandSPI(SSD2119_H_RAM_START_REG);
-    WriteDataSPI(0x0000);
-    WriteCommandSPI(SSD2119_H_RAM_END_REG);
-    WriteDataSPI(0x013F);
-
-    //
-    // Reset the Y extent to the full screen
-    //
-    WriteCommandSPI(SSD2119_V_RAM_POS_REG);
-    WriteDataSPI(0xEF00);
 }
 
 //*****************************************************************************
@@ -1110,6 +1472,150 @@ Kentec320x240x16_SSD2119Flush(void *pvDisplayData)
     //
 }
 
+//*****************************************************************************
+//
+//! Writes a rectangle of pixels in the display's native format.
+//!
+//! \param pvDisplayData is a pointer to the driver-specific data for this
+//! display driver.
+//! \param pRect is a pointer to the structure describing the rectangle, in
+//! application coordinates.
+//! \param pui16Pixels is a pointer to the first pixel of the top row.
+//! \param ui32Stride is the distance from the start of one row to the start
+//! of the next, in pixels.
+//!
+//! This function is meant as the sink of a band renderer (see band_render.h).
+//! When the uDMA channel could be claimed the pixels are sent by uDMA and the
+//! function returns as soon as the transfer has started, so the pixels must
+//! not be changed until Kentec320x240x16_SSD2119WindowWait() has been called.
+//! Every other drawing function waits for the window first.  Without the
+//! channel the pixels are written before the function returns.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+Kentec320x240x16_SSD2119WindowWrite(void *pvDisplayData,
+                                    const tRectangle *pRect,
+                                    const uint16_t *pui16Pixels,
+                                    uint32_t ui32Stride)
+{
+    uint32_t ui32Width, ui32Rows, ui32Idx;
+    bool bDma;
+
+    ui32Width = pRect->i16XMax - pRect->i16XMin + 1;
+    ui32Rows = pRect->i16YMax - pRect->i16YMin + 1;
+
+    //
+    // Limit the cursor to the rectangle and put it at the top left.  The
+    // first command waits for any window still going out.
+    //
+    LCDWindowSet(MAKE_ENTRY_MODE(HORIZ_DIRECTION), pRect);
+    WriteCommandSPI(SSD2119_X_RAM_ADDR_REG);
+    WriteDataSPI(MAPPED_X(pRect->i16XMin, pRect->i16YMin));
+    WriteCommandSPI(SSD2119_Y_RAM_ADDR_REG);
+    WriteDataSPI(MAPPED_Y(pRect->i16XMin, pRect->i16YMin));
+    WriteCommandSPI(SSD2119_RAM_DATA_REG);
+
+    //
+    // Chip select stays low, with data selected, for the whole window.
+    //
+    LCDDCSet();
+    LCDCSClear();
+
+    //
+    // Rows that follow each other in memory go as one.
+    //
+    if(ui32Stride == ui32Width)
+    {
+        ui32Width *= ui32Rows;
+        ui32Rows = 1;
+    }
+
+    //
+    // The uDMA is not used while a clock change is under way.  The window
+    // is marked open in the same critical section as the check, so that
+    // LCDClockPre() either sees it and waits for it or makes it go without.
+    //
+    taskENTER_CRITICAL();
+    bDma = g_bLCDDmaReady && !g_bLCDClockHold;
+    if(bDma)
+    {
+        g_sLCDDma.pui16Row = pui16Pixels;
+        g_sLCDDma.ui32Offset = 0;
+        g_sLCDDma.ui32Width = ui32Width;
+        g_sLCDDma.ui32Stride = ui32Stride;
+        g_sLCDDma.ui32Rows = ui32Rows;
+        g_bLCDWindowOpen = true;
+        g_bLCDDmaActive = true;
+    }
+    taskEXIT_CRITICAL();
+
+    if(!bDma)
+    {
+        for(; ui32Rows; ui32Rows--, pui16Pixels += ui32Stride)
+        {
+            for(ui32Idx = 0; ui32Idx < ui32Width; ui32Idx++)
+            {
+                SSIDataPut(LCD_SSI_BASE, pui16Pixels[ui32Idx] >> 8);
+                SSIDataPut(LCD_SSI_BASE, pui16Pixels[ui32Idx] & 0xff);
+            }
+        }
+        while(SSIBusy(LCD_SSI_BASE)){ }
+        LCDCSSet();
+        return;
+    }
+
+    LCDFrameBitsSet(16);
+    LCDDmaNext();
+}
+
+//*****************************************************************************
+//
+//! Waits for the last window of pixels to be sent.
+//!
+//! \param pvDisplayData is a pointer to the driver-specific data for this
+//! display driver.
+//!
+//! This function blocks until the pixels passed to
+//! Kentec320x240x16_SSD2119WindowWrite() have all been sent to the panel,
+//! after which they may be changed.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+Kentec320x240x16_SSD2119WindowWait(void *pvDisplayData)
+{
+    if(!g_bLCDWindowOpen)
+    {
+        return;
+    }
+
+    //
+    // The semaphore is given once per window, at the end of its last
+    // transfer.  The drawing task and a clock change may both be waiting,
+    // so a waiter passes it on; a give left over only costs the next wait
+    // another pass of the loop.
+    //
+    if(g_bLCDDmaActive)
+    {
+        while(g_bLCDDmaActive)
+        {
+            xSemaphoreTake(g_xLCDDmaDone, portMAX_DELAY);
+        }
+        xSemaphoreGive(g_xLCDDmaDone);
+    }
+
+    //
+    // The last transfer has only been handed to the FIFO.
+    //
+    while(SSIBusy(LCD_SSI_BASE)){ }
+    LCDCSSet();
+    g_bLCDWindowOpen = false;
+    LCDFrameBitsSet(8);
+}
+
 //*****************************************************************************
 //
 //! The display structure that describes the driver for the Kentec
@@ -29,6 +29,11 @@
 extern void LED_backlight_ON(void);
 extern void LED_backlight_OFF(void);
 extern void Kentec320x240x16_SSD2119Init(uint32_t ui32SysClock);
+extern void Kentec320x240x16_SSD2119WindowWrite(void *pvDisplayData,
+                                               const tRectangle *pRect,
+                                               const uint16_t *pui16Pixels,
+                                               uint32_t ui32Stride);
+extern void Kentec320x240x16_SSD2119WindowWait(void *pvDisplayData);
 extern const tDisplay g_sKentec320x240x16_SSD2119;
 
 #endif // __KENTEC320X240X16_SSD2119_SPI_H__
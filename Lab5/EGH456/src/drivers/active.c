@@ -0,0 +1,677 @@
+//*****************************************************************************
+//
+// active.c - Active objects: hierarchical state machines that share worker
+//            tasks.
+//
+// Giving each behaviour its own task costs a control block, a queue and a
+// stack sized for the deepest call it makes, for every behaviour, and most
+// of that stack sits unused while the task waits for its next event.  An
+// active object instead keeps just its current state and a small queue of
+// events.  A worker task runs any number of them: it takes one event from
+// the first object on its list that has any, runs it through that object's
+// state machine to completion, and goes back for the next.  The objects on
+// one worker share its stack, as they never run at the same time, and
+// objects that must not wait behind each other go on workers of different
+// priorities.
+//
+// State machines are hierarchical.  An event a state does not handle goes
+// to its parent, and transitions run the exit and entry handling of every
+// state they leave and enter.  Each object also has one timer, which the
+// worker runs off its own wait for events, so timeouts need no timer task.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "utils/uartstdio.h"
+#include "drivers/cycle_counter.h"
+#include "drivers/active.h"
+
+#define AO_QUEUE_MASK           (AO_QUEUE_LEN - 1)
+
+//*****************************************************************************
+//
+// The number of events timed each way by vActiveBenchmark().
+//
+//*****************************************************************************
+#define AO_BENCH_LOOPS          1000
+
+//*****************************************************************************
+//
+// The workers started by AoWorkerStart(), for AoStatsPrint().
+//
+//*****************************************************************************
+static AoWorker_t *g_psAoWorkers;
+
+//*****************************************************************************
+//
+// The events the framework sends to states.
+//
+//*****************************************************************************
+static const AoEvent_t g_psAoReserved[] =
+{
+    { AO_SIG_ENTRY, 0 },
+    { AO_SIG_EXIT, 0 },
+    { AO_SIG_INIT, 0 }
+};
+
+//*****************************************************************************
+//
+// Adds an event to an object's queue.  Called with the queue locked.
+// Returns false if the queue is full.
+//
+//*****************************************************************************
+static bool
+prvPush(Active_t *psAo, uint32_t ui32Sig, uint32_t ui32Data)
+{
+    uint32_t ui32Queued, ui32Slot;
+
+    ui32Queued = psAo->ui32Head - psAo->ui32Tail;
+    if(ui32Queued == AO_QUEUE_LEN)
+    {
+        psAo->ui32Drops++;
+        return(false);
+    }
+
+    ui32Slot = psAo->ui32Head & AO_QUEUE_MASK;
+    psAo->psQueue[ui32Slot].ui32Sig = ui32Sig;
+    psAo->psQueue[ui32Slot].ui32Data = ui32Data;
+    psAo->pui32Stamp[ui32Slot] = CycleCounterGet();
+    psAo->ui32Head++;
+    psAo->ui32Posts++;
+    if(ui32Queued + 1 > psAo->ui32MaxQueued)
+    {
+        psAo->ui32MaxQueued = ui32Queued + 1;
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Takes the oldest event from an object's queue, if it has one.
+//
+//*****************************************************************************
+static bool
+prvPop(Active_t *psAo, AoEvent_t *psEvent, uint32_t *pui32Stamp)
+{
+    uint32_t ui32Slot;
+    bool bTaken = false;
+
+    taskENTER_CRITICAL();
+    if(psAo->ui32Head != psAo->ui32Tail)
+    {
+        ui32Slot = psAo->ui32Tail & AO_QUEUE_MASK;
+        *psEvent = psAo->psQueue[ui32Slot];
+        *pui32Stamp = psAo->pui32Stamp[ui32Slot];
+        psAo->ui32Tail++;
+        bTaken = true;
+    }
+    taskEXIT_CRITICAL();
+
+    return(bTaken);
+}
+
+//*****************************************************************************
+//
+// Enters the states from just below psFrom down to psTo, outermost first.
+// psFrom is NULL for the top.
+//
+//*****************************************************************************
+static void
+prvEnter(Active_t *psAo, const AoState_t *psFrom, const AoState_t *psTo)
+{
+    const AoState_t *ppsPath[AO_MAX_DEPTH];
+    const AoState_t *psState;
+    uint32_t ui32Depth = 0;
+
+    for(psState = psTo; psState != psFrom; psState = psState->psParent)
+    {
+        ppsPath[ui32Depth++] = psState;
+    }
+    while(ui32Depth)
+    {
+        psState = ppsPath[--ui32Depth];
+        psState->pfnHandler(psAo, &g_psAoReserved[AO_SIG_ENTRY]);
+    }
+    psAo->psState = psTo;
+}
+
+//*****************************************************************************
+//
+// Follows the initial transitions of the current state down to a leaf.
+//
+//*****************************************************************************
+static void
+prvInit(Active_t *psAo)
+{
+    while(psAo->psState->pfnHandler(psAo, &g_psAoReserved[AO_SIG_INIT]) ==
+          AO_TRAN)
+    {
+        prvEnter(psAo, psAo->psState, psAo->psTarget);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns true if psState is psOuter or inside it.
+//
+//*****************************************************************************
+static bool
+prvIsIn(const AoState_t *psState, const AoState_t *psOuter)
+{
+    for(; psState; psState = psState->psParent)
+    {
+        if(psState == psOuter)
+        {
+            return(true);
+        }
+    }
+    return(false);
+}
+
+//*****************************************************************************
+//
+// Runs one event through an object's state machine, from the current state
+// out, and takes the transition it asks for, if any.
+//
+//*****************************************************************************
+static void
+prvDispatch(Active_t *psAo, const AoEvent_t *psEvent)
+{
+    const AoState_t *psSource, *psTarget, *psLca, *psState;
+    uint32_t ui32Result = AO_UNHANDLED;
+
+    for(psSource = psAo->psState; psSource; psSource = psSource->psParent)
+    {
+        ui32Result = psSource->pfnHandler(psAo, psEvent);
+        if(ui32Result != AO_UNHANDLED)
+        {
+            break;
+        }
+    }
+    if(ui32Result != AO_TRAN)
+    {
+        return;
+    }
+
+    psTarget = psAo->psTarget;
+    for(psLca = psSource->psParent; psLca && !prvIsIn(psTarget, psLca);
+        psLca = psLca->psParent)
+    {
+    }
+
+    for(psState = psAo->psState; psState != psLca;
+        psState = psState->psParent)
+    {
+        psState->pfnHandler(psAo, &g_psAoReserved[AO_SIG_EXIT]);
+    }
+    prvEnter(psAo, psLca, psTarget);
+    prvInit(psAo);
+}
+
+//*****************************************************************************
+//
+// Posts the timeouts that are due on a worker's objects, and returns how
+// long the worker may sleep before the next.
+//
+//*****************************************************************************
+static TickType_t
+prvTimersRun(AoWorker_t *psWorker)
+{
+    Active_t *psAo;
+    TickType_t xNow, xLeft, xWait = portMAX_DELAY;
+
+    xNow = xTaskGetTickCount();
+    for(psAo = psWorker->psObjects; psAo; psAo = psAo->psNext)
+    {
+        if(!psAo->bTimerArmed)
+        {
+            continue;
+        }
+
+        xLeft = psAo->xTimerDue - xNow;
+        if((int32_t)xLeft <= 0)
+        {
+            taskENTER_CRITICAL();
+            prvPush(psAo, AO_SIG_TIMEOUT, 0);
+            taskEXIT_CRITICAL();
+
+            if(!psAo->xTimerPeriod)
+            {
+                psAo->bTimerArmed = false;
+                continue;
+            }
+
+            //
+            // Keep to the period, unless the worker has fallen a whole
+            // period behind.
+            //
+            psAo->xTimerDue += psAo->xTimerPeriod;
+            xLeft = psAo->xTimerDue - xNow;
+            if((int32_t)xLeft <= 0)
+            {
+                psAo->xTimerDue = xNow + psAo->xTimerPeriod;
+                xLeft = psAo->xTimerPeriod;
+            }
+        }
+
+        if(xLeft < xWait)
+        {
+            xWait = xLeft;
+        }
+    }
+
+    return(xWait);
+}
+
+//*****************************************************************************
+//
+// A worker task.
+//
+//*****************************************************************************
+static void
+prvAoWorkerTask(void *pvParameters)
+{
+    AoWorker_t *psWorker = pvParameters;
+    Active_t *psAo;
+    AoEvent_t sEvent;
+    uint32_t ui32Stamp, ui32Start, ui32Cycles;
+    TickType_t xWait;
+
+    for(;;)
+    {
+        xWait = prvTimersRun(psWorker);
+
+        for(psAo = psWorker->psObjects; psAo; psAo = psAo->psNext)
+        {
+            if(prvPop(psAo, &sEvent, &ui32Stamp))
+            {
+                break;
+            }
+        }
+
+        //
+        // A post made since the objects were looked at has left the
+        // notification count raised, so this does not sleep through it.
+        //
+        if(!psAo)
+        {
+            ulTaskNotifyTake(pdTRUE, xWait);
+            continue;
+        }
+
+        ui32Start = CycleCounterGet();
+        if((ui32Start - ui32Stamp) > psAo->ui32MaxLatency)
+        {
+            psAo->ui32MaxLatency = ui32Start - ui32Stamp;
+        }
+        prvDispatch(psAo, &sEvent);
+        ui32Cycles = CycleCounterGet() - ui32Start;
+        if(ui32Cycles > psAo->ui32MaxRun)
+        {
+            psAo->ui32MaxRun = ui32Cycles;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Creates a worker's task.
+//
+//*****************************************************************************
+static bool
+prvWorkerCreate(AoWorker_t *psWorker, uint16_t ui16StackDepth,
+                UBaseType_t uxPriority)
+{
+    CycleCounterInit();
+
+    psWorker->ui16StackDepth = ui16StackDepth;
+    return(xTaskCreate(prvAoWorkerTask, psWorker->pcName, ui16StackDepth,
+                       psWorker, uxPriority, &psWorker->xTask) == pdPASS);
+}
+
+//*****************************************************************************
+//
+//! Starts an active object on a worker.
+//!
+//! \param psAo is the object, with its name and initial state set.
+//! \param psWorker is the worker that runs it.
+//!
+//! The object's initial state is entered, and its initial transitions
+//! followed, in the calling task.  Call before the worker is started.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+AoStart(Active_t *psAo, AoWorker_t *psWorker)
+{
+    Active_t **ppsLink;
+
+    psAo->psWorker = psWorker;
+    psAo->ui32Head = 0;
+    psAo->ui32Tail = 0;
+    psAo->psNext = NULL;
+    for(ppsLink = &psWorker->psObjects; *ppsLink;
+        ppsLink = &(*ppsLink)->psNext)
+    {
+    }
+    *ppsLink = psAo;
+
+    prvEnter(psAo, NULL, psAo->psInitial);
+    prvInit(psAo);
+}
+
+//*****************************************************************************
+//
+//! Creates a worker's task.
+//!
+//! \param psWorker is the worker, with its name set and its objects
+//! started.  The name is given to the task.
+//! \param ui16StackDepth is the task's stack depth, in words.  It must hold
+//! the deepest handling of any of the worker's objects.
+//! \param uxPriority is the task's priority.
+//!
+//! \return Returns \b true if the task was created.
+//
+//*****************************************************************************
+bool
+AoWorkerStart(AoWorker_t *psWorker, uint16_t ui16StackDepth,
+              UBaseType_t uxPriority)
+{
+    if(!prvWorkerCreate(psWorker, ui16StackDepth, uxPriority))
+    {
+        return(false);
+    }
+
+    taskENTER_CRITICAL();
+    psWorker->psNext = g_psAoWorkers;
+    g_psAoWorkers = psWorker;
+    taskEXIT_CRITICAL();
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Posts an event to an active object.
+//!
+//! \param psAo is the object.
+//! \param ui32Sig is the signal, AO_SIG_USER or above.
+//! \param ui32Data is the event's data.
+//!
+//! Call from a task.  Events are handled in the order they are posted.
+//!
+//! \return Returns \b false if the object's queue was full, when the event
+//! is dropped.
+//
+//*****************************************************************************
+bool
+AoPost(Active_t *psAo, uint32_t ui32Sig, uint32_t ui32Data)
+{
+    bool bPosted;
+
+    taskENTER_CRITICAL();
+    bPosted = prvPush(psAo, ui32Sig, ui32Data);
+    taskEXIT_CRITICAL();
+
+    if(bPosted && psAo->psWorker->xTask)
+    {
+        xTaskNotifyGive(psAo->psWorker->xTask);
+    }
+
+    return(bPosted);
+}
+
+//*****************************************************************************
+//
+//! Posts an event to an active object from an interrupt handler.
+//!
+//! \param psAo is the object.
+//! \param ui32Sig is the signal, AO_SIG_USER or above.
+//! \param ui32Data is the event's data.
+//! \param pxHigherPriorityTaskWoken is set to \b pdTRUE if the worker was
+//! woken, as for the kernel's FromISR calls.
+//!
+//! May be called from any interrupt at or below
+//! configMAX_SYSCALL_INTERRUPT_PRIORITY.
+//!
+//! \return Returns \b false if the object's queue was full, when the event
+//! is dropped.
+//
+//*****************************************************************************
+bool
+AoPostFromISR(Active_t *psAo, uint32_t ui32Sig, uint32_t ui32Data,
+              BaseType_t *pxHigherPriorityTaskWoken)
+{
+    UBaseType_t uxSaved;
+    bool bPosted;
+
+    uxSaved = taskENTER_CRITICAL_FROM_ISR();
+    bPosted = prvPush(psAo, ui32Sig, ui32Data);
+    taskEXIT_CRITICAL_FROM_ISR(uxSaved);
+
+    if(bPosted && psAo->psWorker->xTask)
+    {
+        vTaskNotifyGiveFromISR(psAo->psWorker->xTask,
+                               pxHigherPriorityTaskWoken);
+    }
+
+    return(bPosted);
+}
+
+//*****************************************************************************
+//
+//! Arms an object's timer.
+//!
+//! \param psAo is the object.
+//! \param xDelay is the number of ticks until the first AO_SIG_TIMEOUT.
+//! \param xPeriod is the number of ticks between the ones after it, or zero
+//! for just the one.
+//!
+//! Call from the object's own handlers.  Arming a timer that is already
+//! armed starts it again.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+AoTimerArm(Active_t *psAo, TickType_t xDelay, TickType_t xPeriod)
+{
+    psAo->xTimerDue = xTaskGetTickCount() + xDelay;
+    psAo->xTimerPeriod = xPeriod;
+    psAo->bTimerArmed = true;
+}
+
+//*****************************************************************************
+//
+//! Disarms an object's timer.
+//!
+//! \param psAo is the object.
+//!
+//! Call from the object's own handlers.  A timeout already queued is still
+//! delivered, so a state that disarms the timer on exit should not expect
+//! that the states after it never see one.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+AoTimerDisarm(Active_t *psAo)
+{
+    psAo->bTimerArmed = false;
+}
+
+//*****************************************************************************
+//
+//! Prints the statistics of every object on every started worker, and what
+//! the objects would cost as a task each.
+//!
+//! The comparison gives each object a task with the worker's stack depth
+//! and a queue of AO_QUEUE_LEN events, against the one worker task and the
+//! objects' framework state.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+AoStatsPrint(void)
+{
+    AoWorker_t *psWorker;
+    Active_t *psAo;
+    uint32_t ui32Objects, ui32Shared, ui32Tasks;
+
+    UARTprintf("object       state        posts drops queued  max lat  "
+               "max run\n");
+    for(psWorker = g_psAoWorkers; psWorker; psWorker = psWorker->psNext)
+    {
+        for(psAo = psWorker->psObjects; psAo; psAo = psAo->psNext)
+        {
+            UARTprintf("%-12s %-12s %5d %5d %6d %8d %8d\n", psAo->pcName,
+                       psAo->psState->pcName, psAo->ui32Posts,
+                       psAo->ui32Drops, psAo->ui32MaxQueued,
+                       psAo->ui32MaxLatency, psAo->ui32MaxRun);
+        }
+    }
+
+    UARTprintf("\nworker       objects  one task  task each   bytes\n");
+    for(psWorker = g_psAoWorkers; psWorker; psWorker = psWorker->psNext)
+    {
+        ui32Objects = 0;
+        for(psAo = psWorker->psObjects; psAo; psAo = psAo->psNext)
+        {
+            ui32Objects++;
+        }
+        ui32Shared = sizeof(StaticTask_t) + (psWorker->ui16StackDepth * 4) +
+                     (ui32Objects * sizeof(Active_t));
+        ui32Tasks = ui32Objects *
+                    (sizeof(StaticTask_t) + (psWorker->ui16StackDepth * 4) +
+                     sizeof(StaticQueue_t) +
+                     (AO_QUEUE_LEN * sizeof(AoEvent_t)));
+        UARTprintf("%-12s %7d %9d %10d\n", psWorker->pcName, ui32Objects,
+                   ui32Shared, ui32Tasks);
+    }
+}
+
+//*****************************************************************************
+//
+// Benchmark.  The same event, stamped as it is sent, goes to an object on a
+// worker above the sending task and to a task of that priority waiting on a
+// queue.  Both end by deleting their task.
+//
+//*****************************************************************************
+#define AO_BENCH_SIG_PING       (AO_SIG_USER)
+#define AO_BENCH_SIG_STOP       (AO_SIG_USER + 1)
+
+static volatile uint32_t g_ui32AoBenchCycles;
+static QueueHandle_t g_xAoBenchQueue;
+
+static uint32_t
+prvBenchHandler(Active_t *psAo, const AoEvent_t *psEvent)
+{
+    (void)psAo;
+
+    switch(psEvent->ui32Sig)
+    {
+        case AO_BENCH_SIG_PING:
+            g_ui32AoBenchCycles += CycleCounterGet() - psEvent->ui32Data;
+            return(AO_HANDLED);
+
+        case AO_BENCH_SIG_STOP:
+            vTaskDelete(NULL);
+            return(AO_HANDLED);
+
+        default:
+            return(AO_UNHANDLED);
+    }
+}
+
+static const AoState_t g_sAoBenchIdle = { "idle", NULL, prvBenchHandler };
+static Active_t g_sAoBench = { "bench", &g_sAoBenchIdle };
+static AoWorker_t g_sAoBenchWorker = { "AoBench" };
+
+static void
+prvBenchTask(void *pvParameters)
+{
+    AoEvent_t sEvent;
+
+    (void)pvParameters;
+
+    for(;;)
+    {
+        xQueueReceive(g_xAoBenchQueue, &sEvent, portMAX_DELAY);
+        if(sEvent.ui32Sig == AO_BENCH_SIG_STOP)
+        {
+            break;
+        }
+        g_ui32AoBenchCycles += CycleCounterGet() - sEvent.ui32Data;
+    }
+    vTaskDelete(NULL);
+}
+
+//*****************************************************************************
+//
+//! Measures the latency of an event to an active object against a queue
+//! message to a task, then prints the objects' statistics.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+vActiveBenchmark(void)
+{
+    AoEvent_t sEvent;
+    uint32_t ui32Idx, ui32Ao, ui32Task;
+    UBaseType_t uxPriority = uxTaskPriorityGet(NULL) + 1;
+
+    AoStart(&g_sAoBench, &g_sAoBenchWorker);
+    g_xAoBenchQueue = xQueueCreate(AO_QUEUE_LEN, sizeof(AoEvent_t));
+    if(!g_xAoBenchQueue ||
+       !prvWorkerCreate(&g_sAoBenchWorker, configMINIMAL_STACK_SIZE * 2,
+                        uxPriority) ||
+       (xTaskCreate(prvBenchTask, "AoBenchQ", configMINIMAL_STACK_SIZE * 2,
+                    NULL, uxPriority, NULL) != pdPASS))
+    {
+        UARTprintf("Active object benchmark: out of heap\n");
+        return;
+    }
+
+    //
+    // Each post or send runs its receiver before it returns.
+    //
+    g_ui32AoBenchCycles = 0;
+    for(ui32Idx = 0; ui32Idx < AO_BENCH_LOOPS; ui32Idx++)
+    {
+        AoPost(&g_sAoBench, AO_BENCH_SIG_PING, CycleCounterGet());
+    }
+    ui32Ao = g_ui32AoBenchCycles;
+    AoPost(&g_sAoBench, AO_BENCH_SIG_STOP, 0);
+
+    g_ui32AoBenchCycles = 0;
+    sEvent.ui32Sig = AO_BENCH_SIG_PING;
+    for(ui32Idx = 0; ui32Idx < AO_BENCH_LOOPS; ui32Idx++)
+    {
+        sEvent.ui32Data = CycleCounterGet();
+        xQueueSend(g_xAoBenchQueue, &sEvent, portMAX_DELAY);
+    }
+    ui32Task = g_ui32AoBenchCycles;
+    sEvent.ui32Sig = AO_BENCH_SIG_STOP;
+    xQueueSend(g_xAoBenchQueue, &sEvent, portMAX_DELAY);
+
+    //
+    // Let the idle task free both tasks before the queue goes.
+    //
+    vTaskDelay(2);
+    vQueueDelete(g_xAoBenchQueue);
+
+    UARTprintf("path                      cycles\n");
+    UARTprintf("%-24s %7d\n", "event to active object",
+               ui32Ao / AO_BENCH_LOOPS);
+    UARTprintf("%-24s %7d\n\n", "queue send to task",
+               ui32Task / AO_BENCH_LOOPS);
+    AoStatsPrint();
+}
@@ -0,0 +1,176 @@
+//*****************************************************************************
+//
+// active.h - Active objects: hierarchical state machines that share worker
+//            tasks.
+//
+//*****************************************************************************
+
+#ifndef __ACTIVE_H__
+#define __ACTIVE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The number of events an object's queue holds, a power of two, and the
+// deepest nesting of states supported.
+//
+//*****************************************************************************
+#define AO_QUEUE_LEN            8
+#define AO_MAX_DEPTH            6
+
+//*****************************************************************************
+//
+// Signals sent by the framework.  Application signals start at AO_SIG_USER.
+// AO_SIG_ENTRY and AO_SIG_EXIT are sent to a state as it is entered and left,
+// AO_SIG_INIT once it has been entered, and AO_SIG_TIMEOUT when the object's
+// timer expires.
+//
+//*****************************************************************************
+#define AO_SIG_ENTRY            0
+#define AO_SIG_EXIT             1
+#define AO_SIG_INIT             2
+#define AO_SIG_TIMEOUT          3
+#define AO_SIG_USER             4
+
+//*****************************************************************************
+//
+// What a state handler returns.  AO_UNHANDLED passes the event on to the
+// parent state.  AO_TRAN, returned by AO_TRAN_TO(), takes a transition.
+//
+//*****************************************************************************
+#define AO_HANDLED              0
+#define AO_UNHANDLED            1
+#define AO_TRAN                 2
+
+//*****************************************************************************
+//
+// An event.  Events are copied into the queue, so they carry their data by
+// value.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Sig;
+    uint32_t ui32Data;
+}
+AoEvent_t;
+
+struct Active;
+
+//*****************************************************************************
+//
+// A state.  States are constant and can be shared by any number of objects
+// of the same kind; a state with no parent sits directly below the top.
+//
+//*****************************************************************************
+typedef struct AoState
+{
+    const char *pcName;
+    const struct AoState *psParent;
+    uint32_t (*pfnHandler)(struct Active *psAo, const AoEvent_t *psEvent);
+}
+AoState_t;
+
+//*****************************************************************************
+//
+// Takes a transition from a state handler: return AO_TRAN_TO(psAo, &sNext).
+// The source state and every state below it are left, up to the deepest
+// state that strictly contains the source and contains (or is) the target,
+// then the states down to the target are entered and its AO_SIG_INIT
+// handling followed.  A handler may take a transition from AO_SIG_INIT only
+// to a state inside the one handling it.
+//
+//*****************************************************************************
+#define AO_TRAN_TO(psAo, psNext)                                              \
+                                (((Active_t *)(psAo))->psTarget = (psNext),   \
+                                 AO_TRAN)
+
+//*****************************************************************************
+//
+// A worker task, which runs the objects given to it one event at a time,
+// each event to completion.  Objects started on a worker first have
+// priority over those started later.
+//
+//*****************************************************************************
+typedef struct AoWorker
+{
+    const char *pcName;
+    TaskHandle_t xTask;
+    uint16_t ui16StackDepth;
+    struct Active *psObjects;
+    struct AoWorker *psNext;
+}
+AoWorker_t;
+
+//*****************************************************************************
+//
+// An active object.  Put one at the start of the object's own structure so
+// that its handlers can cast back to it.  Set pcName and psInitial, the rest
+// zeroed, and pass it to AoStart().
+//
+// Latencies are in cycles from an event being posted to its handling
+// starting, and run times the cycles its handling took.
+//
+//*****************************************************************************
+typedef struct Active
+{
+    const char *pcName;
+    const AoState_t *psInitial;
+
+    const AoState_t *psState;
+    const AoState_t *psTarget;
+    AoWorker_t *psWorker;
+    AoEvent_t psQueue[AO_QUEUE_LEN];
+    uint32_t pui32Stamp[AO_QUEUE_LEN];
+    uint32_t ui32Head;
+    uint32_t ui32Tail;
+    bool bTimerArmed;
+    TickType_t xTimerDue;
+    TickType_t xTimerPeriod;
+    uint32_t ui32Posts;
+    uint32_t ui32Drops;
+    uint32_t ui32MaxQueued;
+    uint32_t ui32MaxLatency;
+    uint32_t ui32MaxRun;
+    struct Active *psNext;
+}
+Active_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void AoStart(Active_t *psAo, AoWorker_t *psWorker);
+extern bool AoWorkerStart(AoWorker_t *psWorker, uint16_t ui16StackDepth,
+                          UBaseType_t uxPriority);
+extern bool AoPost(Active_t *psAo, uint32_t ui32Sig, uint32_t ui32Data);
+extern bool AoPostFromISR(Active_t *psAo, uint32_t ui32Sig,
+                          uint32_t ui32Data,
+                          BaseType_t *pxHigherPriorityTaskWoken);
+extern void AoTimerArm(Active_t *psAo, TickType_t xDelay,
+                       TickType_t xPeriod);
+extern void AoTimerDisarm(Active_t *psAo);
+extern void AoStatsPrint(void);
+extern void vActiveBenchmark(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ACTIVE_H__
@@ -0,0 +1,169 @@
+//*****************************************************************************
+//
+// adapt_rate.c - Sampling rate that follows the activity of the signal.
+//
+// Most of the time the light level does not change, and reading it ten times
+// a second wakes the processor and the I2C bus for nothing.  The controller
+// is given each sample as it is read and picks the period to the next one
+// from a range: the shortest while the level is moving, and a step longer
+// each time it has been still for a while, up to the longest.
+//
+// Activity is judged on two things, both relative to the level so that the
+// same settings suit a dark room and daylight.  The rate of change is the
+// step from the last sample; one step larger than the threshold is a
+// transient.  The variance is a running mean of the squared steps; a level
+// that keeps moving by less than the threshold, a slow ramp or a flicker,
+// builds it up.  A transient goes back to the shortest period at once, as
+// does AdaptRateBoost(), which the caller uses when a threshold of its own
+// fires.  Each step longer takes ui32QuietSamples samples in a row with
+// neither, so the longest period is reached gradually and a level that
+// settles only briefly stays close to the shortest.
+//
+// A step of zero, or one larger than the range, goes straight from one end
+// of the range to the other.
+//
+// Nothing here uses the kernel, so the controller runs on the host as well.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "drivers/adapt_rate.h"
+
+//*****************************************************************************
+//
+// The weight of each new squared step in the running variance, as a shift.
+//
+//*****************************************************************************
+#define ADAPT_VAR_SHIFT         3
+
+//*****************************************************************************
+//
+//! Sets up a rate controller at the shortest period.
+//!
+//! \param psRate is the controller.
+//! \param ui32MinMs is the period while the signal is active, in ms.
+//! \param ui32MaxMs is the longest period once it is quiet, in ms.
+//! \param ui32StepMs is how much the period lengthens at a time, in ms.
+//!
+//! The tuning starts at ADAPT_ACTIVE_PERMILLE and ADAPT_QUIET_SAMPLES and
+//! may be changed in \e psRate after this.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+AdaptRateInit(AdaptRate_t *psRate, uint32_t ui32MinMs, uint32_t ui32MaxMs,
+              uint32_t ui32StepMs)
+{
+    *psRate = (AdaptRate_t){ 0 };
+    psRate->ui32MinMs = ui32MinMs;
+    psRate->ui32MaxMs = ui32MaxMs < ui32MinMs ? ui32MinMs : ui32MaxMs;
+    psRate->ui32StepMs = ui32StepMs ? ui32StepMs :
+                                      psRate->ui32MaxMs - ui32MinMs;
+    psRate->ui32PeriodMs = ui32MinMs;
+    psRate->ui32ActivePermille = ADAPT_ACTIVE_PERMILLE;
+    psRate->ui32QuietSamples = ADAPT_QUIET_SAMPLES;
+}
+
+//*****************************************************************************
+//
+//! Feeds a sample to a rate controller.
+//!
+//! \param psRate is the controller.
+//! \param fLevel is the sample.
+//!
+//! \return Returns the period to the next sample, in ms.
+//
+//*****************************************************************************
+uint32_t
+AdaptRateUpdate(AdaptRate_t *psRate, float fLevel)
+{
+    float fBase, fStep, fThreshold;
+
+    psRate->ui32Samples++;
+    if(psRate->ui32PeriodMs > psRate->ui32MinMs)
+    {
+        psRate->ui32SlowSamples++;
+    }
+
+    if(!psRate->bPrimed)
+    {
+        psRate->bPrimed = true;
+        psRate->fLast = fLevel;
+        return(AdaptRatePeriodGet(psRate));
+    }
+
+    //
+    // The step as a fraction of the level, squared to save a square root.
+    //
+    fBase = psRate->fLast > ADAPT_FLOOR ? psRate->fLast : ADAPT_FLOOR;
+    fStep = (fLevel - psRate->fLast) / fBase;
+    fStep *= fStep;
+    psRate->fLast = fLevel;
+    psRate->fVar += (fStep - psRate->fVar) / (1 << ADAPT_VAR_SHIFT);
+
+    fThreshold = psRate->ui32ActivePermille / 1000.0f;
+    fThreshold *= fThreshold;
+
+    if(fStep > fThreshold)
+    {
+        return(AdaptRateBoost(psRate));
+    }
+
+    if(psRate->fVar > fThreshold / 4)
+    {
+        psRate->ui32Quiet = 0;
+    }
+    else if((psRate->ui32PeriodMs < psRate->ui32MaxMs) &&
+            (++psRate->ui32Quiet >= psRate->ui32QuietSamples))
+    {
+        psRate->ui32PeriodMs =
+            psRate->ui32MaxMs - psRate->ui32PeriodMs > psRate->ui32StepMs ?
+            psRate->ui32PeriodMs + psRate->ui32StepMs : psRate->ui32MaxMs;
+        psRate->ui32Quiet = 0;
+        psRate->ui32Switches++;
+    }
+
+    return(AdaptRatePeriodGet(psRate));
+}
+
+//*****************************************************************************
+//
+//! Puts a rate controller back to the shortest period.
+//!
+//! \param psRate is the controller.
+//!
+//! Starts the count of quiet samples again, so the shortest period is held
+//! for at least ui32QuietSamples samples.
+//!
+//! \return Returns the period to the next sample, in ms.
+//
+//*****************************************************************************
+uint32_t
+AdaptRateBoost(AdaptRate_t *psRate)
+{
+    if(psRate->ui32PeriodMs != psRate->ui32MinMs)
+    {
+        psRate->ui32PeriodMs = psRate->ui32MinMs;
+        psRate->ui32Switches++;
+    }
+    psRate->ui32Quiet = 0;
+
+    return(psRate->ui32PeriodMs);
+}
+
+//*****************************************************************************
+//
+//! Gets the period a rate controller is at.
+//!
+//! \param psRate is the controller.
+//!
+//! \return Returns the period to the next sample, in ms.
+//
+//*****************************************************************************
+uint32_t
+AdaptRatePeriodGet(const AdaptRate_t *psRate)
+{
+    return(psRate->ui32PeriodMs);
+}
@@ -0,0 +1,81 @@
+//*****************************************************************************
+//
+// adapt_rate.h - Sampling rate that follows the activity of the signal.
+//
+//*****************************************************************************
+
+#ifndef __ADAPT_RATE_H__
+#define __ADAPT_RATE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Defaults for AdaptRateInit().  A change of more than ADAPT_ACTIVE_PERMILLE
+// thousandths of the level from one sample to the next counts as activity,
+// as does a running deviation of more than half that.  ADAPT_QUIET_SAMPLES
+// samples in a row without activity lengthen the period by one step.
+// Changes are taken relative to at least ADAPT_FLOOR, so that noise in the
+// dark does not count.
+//
+//*****************************************************************************
+#define ADAPT_ACTIVE_PERMILLE   30
+#define ADAPT_QUIET_SAMPLES     20
+#define ADAPT_FLOOR             1.0f
+
+//*****************************************************************************
+//
+// A rate controller.  Set up with AdaptRateInit(); the tuning may be changed
+// after that, the rest is private.  The counts are kept for reporting.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32MinMs;
+    uint32_t ui32MaxMs;
+    uint32_t ui32StepMs;
+    uint32_t ui32ActivePermille;
+    uint32_t ui32QuietSamples;
+
+    uint32_t ui32PeriodMs;
+    bool bPrimed;
+    float fLast;
+    float fVar;
+    uint32_t ui32Quiet;
+
+    uint32_t ui32Samples;
+    uint32_t ui32SlowSamples;
+    uint32_t ui32Switches;
+}
+AdaptRate_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void AdaptRateInit(AdaptRate_t *psRate, uint32_t ui32MinMs,
+                          uint32_t ui32MaxMs, uint32_t ui32StepMs);
+extern uint32_t AdaptRateUpdate(AdaptRate_t *psRate, float fLevel);
+extern uint32_t AdaptRateBoost(AdaptRate_t *psRate);
+extern uint32_t AdaptRatePeriodGet(const AdaptRate_t *psRate);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ADAPT_RATE_H__
@@ -0,0 +1,515 @@
+//*****************************************************************************
+//
+// adc_stream.c - Timer triggered multi-channel ADC acquisition into a
+//                ping-pong buffer by uDMA.
+//
+// Timer 2A triggers sample sequencer 0 of ADC0 at the scan rate.  Each scan
+// converts every configured channel, averaged in hardware, and the step
+// interrupt flag on the last streamed step raises a uDMA request that moves
+// the scan from the FIFO into the current half of the buffer.  The CPU is only
+// interrupted when a half buffer is full, so the cost is one interrupt per
+// block whatever the sample rate.
+//
+// Alarm steps sample a channel a second time and route the result to one of
+// the digital comparators instead of the FIFO.  The comparators check every
+// scan in hardware and only interrupt when their condition is met.
+//
+// Both the block and alarm callbacks run in a task of their own, so they may
+// block and use the FreeRTOS API freely.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_adc.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/adc.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/udma.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "task_stacks.h"
+#include "drivers/udma_ctl.h"
+#include "drivers/clock_scale.h"
+#include "drivers/adc_stream.h"
+
+//*****************************************************************************
+//
+// Hardware resources used by the stream.
+//
+//*****************************************************************************
+#define ADC_STREAM_BASE         ADC0_BASE
+#define ADC_STREAM_SEQ          0
+#define ADC_STREAM_INT          INT_ADC0SS0
+#define ADC_STREAM_DMA          UDMA_CH14_ADC0_0
+#define ADC_STREAM_DMA_CHANNEL  (ADC_STREAM_DMA & 0xff)
+
+#define ADC_STREAM_TIMER_PERIPH SYSCTL_PERIPH_TIMER2
+#define ADC_STREAM_TIMER_BASE   TIMER2_BASE
+
+//*****************************************************************************
+//
+// Notification bits from the interrupt handler to the stream task.
+//
+//*****************************************************************************
+#define ADC_STREAM_EVT_PING     0x00000001
+#define ADC_STREAM_EVT_PONG     0x00000002
+#define ADC_STREAM_EVT_ALARM    0x00000004
+
+//*****************************************************************************
+//
+// Stream state.
+//
+//*****************************************************************************
+static AdcStreamConfig_t g_sAdcStream;
+static uint32_t g_ui32AdcStreamSysClock;
+static uint32_t g_ui32AdcStreamArb;
+static TaskHandle_t g_xAdcStreamTask = NULL;
+
+//
+// Comparator alarms, in step order after the streamed channels.
+//
+static uint32_t g_pui32AlarmChannels[ADC_STREAM_MAX_STEPS];
+static uint32_t g_ui32NumAlarms;
+
+//
+// Halves filled but not yet handed to the block callback, and alarms not yet
+// handed to the alarm callback.  Written by the interrupt handler.
+//
+static volatile uint32_t g_ui32AdcStreamPending;
+static volatile uint32_t g_ui32AdcStreamAlarms;
+static volatile uint32_t g_ui32AdcStreamOverruns;
+
+static void prvAdcStreamTask(void *pvParameters);
+
+//*****************************************************************************
+//
+// Keeps the sample rate across system clock changes.  The ADC itself runs
+// from the PIOSC; only the trigger timer counts system clocks.
+//
+//*****************************************************************************
+static void
+prvAdcStreamClockPost(uint32_t ui32NewHz, void *pvArg)
+{
+    (void)pvArg;
+
+    g_ui32AdcStreamSysClock = ui32NewHz;
+    TimerLoadSet(ADC_STREAM_TIMER_BASE, TIMER_A,
+                 ui32NewHz / g_sAdcStream.ui32SampleRate - 1);
+}
+
+static ClockNotifier_t g_sAdcStreamClockNotifier =
+{
+    NULL, prvAdcStreamClockPost, NULL, NULL
+};
+static bool g_bAdcStreamClockRegistered = false;
+
+//*****************************************************************************
+//
+// Points one of the control structures at its half of the buffer.
+//
+//*****************************************************************************
+static void
+prvArm(uint32_t ui32Select)
+{
+    uint16_t *pui16Dst = g_sAdcStream.pui16Buffer;
+
+    if(ui32Select == UDMA_ALT_SELECT)
+    {
+        pui16Dst += g_sAdcStream.ui32BlockSamples;
+    }
+
+    uDMAChannelTransferSet(ADC_STREAM_DMA_CHANNEL | ui32Select,
+                           UDMA_MODE_PINGPONG,
+                           (void *)(ADC_STREAM_BASE + ADC_O_SSFIFO0),
+                           pui16Dst, g_sAdcStream.ui32BlockSamples);
+}
+
+//*****************************************************************************
+//
+//! Sets up the ADC, timer and uDMA channel for a stream.
+//!
+//! \param psConfig is the stream configuration; it is copied.
+//! \param ui32SysClock is the system clock frequency.
+//!
+//! The analog pins of the channels must already be configured with
+//! GPIOPinTypeADC().  Nothing is sampled until AdcStreamStart() is called.
+//!
+//! \return Returns \b false if the configuration is invalid, if the scan
+//! cannot complete within one sample period, or if the uDMA channel is owned
+//! by another driver.
+//
+//*****************************************************************************
+bool
+AdcStreamInit(const AdcStreamConfig_t *psConfig, uint32_t ui32SysClock)
+{
+    uint32_t ui32Oversample;
+
+    if((psConfig->ui32NumChannels == 0) ||
+       (psConfig->ui32NumChannels > ADC_STREAM_MAX_STEPS) ||
+       (psConfig->ui32BlockSamples == 0) ||
+       (psConfig->ui32BlockSamples > ADC_STREAM_MAX_BLOCK) ||
+       (psConfig->ui32BlockSamples % psConfig->ui32NumChannels) ||
+       (psConfig->ui32SampleRate == 0) || (psConfig->pfnBlock == NULL))
+    {
+        return(false);
+    }
+
+    ui32Oversample = psConfig->ui32Oversample ? psConfig->ui32Oversample : 1;
+    if((ui32Oversample > 64) || (ui32Oversample & (ui32Oversample - 1)))
+    {
+        return(false);
+    }
+
+    //
+    // Every step of a scan takes ui32Oversample conversions; the scan must be
+    // done before the next trigger.
+    //
+    if((psConfig->ui32SampleRate * psConfig->ui32NumChannels *
+        ui32Oversample) > ADC_STREAM_CONV_RATE)
+    {
+        return(false);
+    }
+
+    if(!DMAChannelClaim(ADC_STREAM_DMA))
+    {
+        return(false);
+    }
+
+    g_sAdcStream = *psConfig;
+    g_sAdcStream.ui32Oversample = ui32Oversample;
+    g_ui32AdcStreamSysClock = ui32SysClock;
+    g_ui32NumAlarms = 0;
+    g_ui32AdcStreamPending = 0;
+    g_ui32AdcStreamAlarms = 0;
+    g_ui32AdcStreamOverruns = 0;
+
+    //
+    // Move each scan in a single arbitration if the channel count allows.
+    //
+    g_ui32AdcStreamArb = UDMA_ARB_1;
+    if((psConfig->ui32NumChannels & 7) == 0)
+    {
+        g_ui32AdcStreamArb = UDMA_ARB_8;
+    }
+    else if((psConfig->ui32NumChannels & 3) == 0)
+    {
+        g_ui32AdcStreamArb = UDMA_ARB_4;
+    }
+    else if((psConfig->ui32NumChannels & 1) == 0)
+    {
+        g_ui32AdcStreamArb = UDMA_ARB_2;
+    }
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+    SysCtlPeripheralEnable(ADC_STREAM_TIMER_PERIPH);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_ADC0) ||
+          !SysCtlPeripheralReady(ADC_STREAM_TIMER_PERIPH))
+    {
+    }
+
+    //
+    // Clock the ADC from the PIOSC so the conversion rate does not depend on
+    // the PLL setting.
+    //
+    ADCClockConfigSet(ADC_STREAM_BASE, ADC_CLOCK_SRC_PIOSC |
+                      ADC_CLOCK_RATE_FULL, 1);
+    ADCHardwareOversampleConfigure(ADC_STREAM_BASE,
+                                   (ui32Oversample > 1) ? ui32Oversample : 0);
+
+    TimerConfigure(ADC_STREAM_TIMER_BASE, TIMER_CFG_PERIODIC);
+    TimerLoadSet(ADC_STREAM_TIMER_BASE, TIMER_A,
+                 ui32SysClock / psConfig->ui32SampleRate - 1);
+    TimerControlTrigger(ADC_STREAM_TIMER_BASE, TIMER_A, true);
+    TimerADCEventSet(ADC_STREAM_TIMER_BASE, TIMER_ADC_TIMEOUT_A);
+
+    if(!g_bAdcStreamClockRegistered)
+    {
+        ClockNotifierRegister(&g_sAdcStreamClockNotifier);
+        g_bAdcStreamClockRegistered = true;
+    }
+
+    if(g_xAdcStreamTask == NULL)
+    {
+        xTaskCreate(prvAdcStreamTask, "AdcStream", TASK_STACK_ADC_STREAM, NULL,
+                    ADC_STREAM_TASK_PRIORITY, &g_xAdcStreamTask);
+    }
+
+    ADCIntRegister(ADC_STREAM_BASE, ADC_STREAM_SEQ, ADC0SS0IntHandler);
+    IntPrioritySet(ADC_STREAM_INT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Adds a digital comparator alarm on a channel.
+//!
+//! \param ui32Channel is the input to watch, as an ADC_CTL_CHn value.  It does
+//! not have to be one of the streamed channels.
+//! \param ui16Low is the lower region boundary.
+//! \param ui16High is the upper region boundary.
+//! \param ui32IntMode is one of the \b ADC_COMP_INT_xxx modes.
+//!
+//! Must be called between AdcStreamInit() and AdcStreamStart().
+//!
+//! \return Returns the comparator number, which is the bit reported to the
+//! alarm callback, or -1 if no sequencer step is left.
+//
+//*****************************************************************************
+int32_t
+AdcStreamAlarmAdd(uint32_t ui32Channel, uint16_t ui16Low, uint16_t ui16High,
+                  uint32_t ui32IntMode)
+{
+    uint32_t ui32Comp = g_ui32NumAlarms;
+
+    if((g_sAdcStream.ui32NumChannels + ui32Comp) >= ADC_STREAM_MAX_STEPS)
+    {
+        return(-1);
+    }
+
+    ADCComparatorConfigure(ADC_STREAM_BASE, ui32Comp, ui32IntMode);
+    ADCComparatorRegionSet(ADC_STREAM_BASE, ui32Comp, ui16Low, ui16High);
+    ADCComparatorReset(ADC_STREAM_BASE, ui32Comp, true, true);
+
+    g_pui32AlarmChannels[ui32Comp] = ui32Channel;
+    g_ui32NumAlarms++;
+
+    return((int32_t)ui32Comp);
+}
+
+//*****************************************************************************
+//
+//! Starts sampling.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+AdcStreamStart(void)
+{
+    uint32_t ui32Step, ui32NumSteps, ui32Config;
+
+    ADCSequenceDisable(ADC_STREAM_BASE, ADC_STREAM_SEQ);
+    ADCSequenceConfigure(ADC_STREAM_BASE, ADC_STREAM_SEQ, ADC_TRIGGER_TIMER,
+                         0);
+
+    ui32NumSteps = g_sAdcStream.ui32NumChannels + g_ui32NumAlarms;
+    for(ui32Step = 0; ui32Step < ui32NumSteps; ui32Step++)
+    {
+        if(ui32Step < g_sAdcStream.ui32NumChannels)
+        {
+            ui32Config = g_sAdcStream.pui32Channels[ui32Step];
+        }
+        else
+        {
+            uint32_t ui32Comp = ui32Step - g_sAdcStream.ui32NumChannels;
+
+            ui32Config = (g_pui32AlarmChannels[ui32Comp] |
+                          (ADC_CTL_CMP0 + (ui32Comp << 16)));
+        }
+
+        //
+        // The last streamed step requests the uDMA transfer of the scan.
+        //
+        if(ui32Step == (g_sAdcStream.ui32NumChannels - 1))
+        {
+            ui32Config |= ADC_CTL_IE;
+        }
+        if(ui32Step == (ui32NumSteps - 1))
+        {
+            ui32Config |= ADC_CTL_END;
+        }
+
+        ADCSequenceStepConfigure(ADC_STREAM_BASE, ADC_STREAM_SEQ, ui32Step,
+                                 ui32Config);
+    }
+
+    //
+    // The ADC channel is given priority over memory copies so the FIFO never
+    // overflows behind a long copy.
+    //
+    uDMAChannelAttributeDisable(ADC_STREAM_DMA_CHANNEL,
+                                UDMA_ATTR_ALTSELECT | UDMA_ATTR_USEBURST |
+                                UDMA_ATTR_REQMASK);
+    uDMAChannelAttributeEnable(ADC_STREAM_DMA_CHANNEL,
+                               UDMA_ATTR_HIGH_PRIORITY);
+    uDMAChannelControlSet(ADC_STREAM_DMA_CHANNEL | UDMA_PRI_SELECT,
+                          UDMA_SIZE_16 | UDMA_SRC_INC_NONE | UDMA_DST_INC_16 |
+                          g_ui32AdcStreamArb);
+    uDMAChannelControlSet(ADC_STREAM_DMA_CHANNEL | UDMA_ALT_SELECT,
+                          UDMA_SIZE_16 | UDMA_SRC_INC_NONE | UDMA_DST_INC_16 |
+                          g_ui32AdcStreamArb);
+    prvArm(UDMA_PRI_SELECT);
+    prvArm(UDMA_ALT_SELECT);
+    uDMAChannelEnable(ADC_STREAM_DMA_CHANNEL);
+
+    ADCSequenceOverflowClear(ADC_STREAM_BASE, ADC_STREAM_SEQ);
+    ADCIntClearEx(ADC_STREAM_BASE, ADC_INT_DMA_SS0 | ADC_INT_DCON_SS0 |
+                  ADC_INT_SS0);
+    ADCSequenceDMAEnable(ADC_STREAM_BASE, ADC_STREAM_SEQ);
+    ADCIntEnableEx(ADC_STREAM_BASE, ADC_INT_DMA_SS0);
+    if(g_ui32NumAlarms)
+    {
+        ADCComparatorIntEnable(ADC_STREAM_BASE, ADC_STREAM_SEQ);
+    }
+    ADCSequenceEnable(ADC_STREAM_BASE, ADC_STREAM_SEQ);
+    IntEnable(ADC_STREAM_INT);
+
+    TimerEnable(ADC_STREAM_TIMER_BASE, TIMER_A);
+}
+
+//*****************************************************************************
+//
+//! Stops sampling.  A partly filled half buffer is discarded.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+AdcStreamStop(void)
+{
+    TimerDisable(ADC_STREAM_TIMER_BASE, TIMER_A);
+    IntDisable(ADC_STREAM_INT);
+    ADCSequenceDisable(ADC_STREAM_BASE, ADC_STREAM_SEQ);
+    ADCSequenceDMADisable(ADC_STREAM_BASE, ADC_STREAM_SEQ);
+    ADCComparatorIntDisable(ADC_STREAM_BASE, ADC_STREAM_SEQ);
+    uDMAChannelDisable(ADC_STREAM_DMA_CHANNEL);
+}
+
+//*****************************************************************************
+//
+//! Returns the number of half buffers that were refilled before the block
+//! callback had consumed them, plus the number of FIFO overflows.
+//!
+//! \return The overrun count since AdcStreamInit().
+//
+//*****************************************************************************
+uint32_t
+AdcStreamOverrunsGet(void)
+{
+    return(g_ui32AdcStreamOverruns);
+}
+
+//*****************************************************************************
+//
+// The ADC0 sequence 0 interrupt handler.  Runs once per half buffer and once
+// per comparator event.
+//
+//*****************************************************************************
+void
+ADC0SS0IntHandler(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint32_t ui32Status, ui32Events = 0;
+
+    ui32Status = ADCIntStatusEx(ADC_STREAM_BASE, true);
+    ADCIntClearEx(ADC_STREAM_BASE, ui32Status);
+
+    if(ui32Status & ADC_INT_DMA_SS0)
+    {
+        //
+        // Re-arm whichever half has just completed; the controller has
+        // already switched to the other one.
+        //
+        if(uDMAChannelModeGet(ADC_STREAM_DMA_CHANNEL | UDMA_PRI_SELECT) ==
+           UDMA_MODE_STOP)
+        {
+            prvArm(UDMA_PRI_SELECT);
+            ui32Events |= ADC_STREAM_EVT_PING;
+        }
+        if(uDMAChannelModeGet(ADC_STREAM_DMA_CHANNEL | UDMA_ALT_SELECT) ==
+           UDMA_MODE_STOP)
+        {
+            prvArm(UDMA_ALT_SELECT);
+            ui32Events |= ADC_STREAM_EVT_PONG;
+        }
+
+        if(g_ui32AdcStreamPending & ui32Events)
+        {
+            g_ui32AdcStreamOverruns++;
+        }
+        g_ui32AdcStreamPending |= ui32Events;
+
+        if(ADCSequenceOverflow(ADC_STREAM_BASE, ADC_STREAM_SEQ))
+        {
+            ADCSequenceOverflowClear(ADC_STREAM_BASE, ADC_STREAM_SEQ);
+            g_ui32AdcStreamOverruns++;
+        }
+    }
+
+    if(ui32Status & ADC_INT_DCON_SS0)
+    {
+        uint32_t ui32Comp = ADCComparatorIntStatus(ADC_STREAM_BASE);
+
+        ADCComparatorIntClear(ADC_STREAM_BASE, ui32Comp);
+        g_ui32AdcStreamAlarms |= ui32Comp;
+        ui32Events |= ADC_STREAM_EVT_ALARM;
+    }
+
+    if(ui32Events)
+    {
+        xTaskNotifyFromISR(g_xAdcStreamTask, ui32Events, eSetBits,
+                           &xHigherPriorityTaskWoken);
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+//*****************************************************************************
+//
+// Hands completed half buffers and alarms to the callbacks.
+//
+//*****************************************************************************
+static void
+prvAdcStreamTask(void *pvParameters)
+{
+    uint32_t ui32Events, ui32Alarms, ui32Next = ADC_STREAM_EVT_PING;
+
+    (void)pvParameters;
+
+    for(;;)
+    {
+        xTaskNotifyWait(0, 0xffffffff, &ui32Events, portMAX_DELAY);
+
+        if(ui32Events & ADC_STREAM_EVT_ALARM)
+        {
+            taskENTER_CRITICAL();
+            ui32Alarms = g_ui32AdcStreamAlarms;
+            g_ui32AdcStreamAlarms = 0;
+            taskEXIT_CRITICAL();
+
+            if(ui32Alarms && g_sAdcStream.pfnAlarm)
+            {
+                g_sAdcStream.pfnAlarm(ui32Alarms, g_sAdcStream.pvArg);
+            }
+        }
+
+        //
+        // Deliver halves in the order they were filled, even if both are
+        // pending because this task fell behind.
+        //
+        while(g_ui32AdcStreamPending & ui32Next)
+        {
+            const uint16_t *pui16Block = g_sAdcStream.pui16Buffer;
+
+            if(ui32Next == ADC_STREAM_EVT_PONG)
+            {
+                pui16Block += g_sAdcStream.ui32BlockSamples;
+            }
+
+            g_sAdcStream.pfnBlock(pui16Block, g_sAdcStream.ui32BlockSamples,
+                                  g_sAdcStream.pvArg);
+
+            taskENTER_CRITICAL();
+            g_ui32AdcStreamPending &= ~ui32Next;
+            taskEXIT_CRITICAL();
+
+            ui32Next ^= ADC_STREAM_EVT_PING | ADC_STREAM_EVT_PONG;
+        }
+    }
+}
@@ -0,0 +1,102 @@
+//*****************************************************************************
+//
+// adc_stream.h - Timer triggered multi-channel ADC acquisition into a
+//                ping-pong buffer by uDMA.
+//
+//*****************************************************************************
+
+#ifndef __ADC_STREAM_H__
+#define __ADC_STREAM_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Limits of the stream.  Sample sequencer 0 has eight steps, shared between
+// streamed channels and comparator alarms.  A half buffer must fit in one
+// uDMA transfer.
+//
+//*****************************************************************************
+#define ADC_STREAM_MAX_STEPS    8
+#define ADC_STREAM_MAX_BLOCK    1024
+
+//*****************************************************************************
+//
+// The rate at which the ADC converts samples with the 16 MHz PIOSC clock.
+//
+//*****************************************************************************
+#define ADC_STREAM_CONV_RATE    1000000
+
+//*****************************************************************************
+//
+// Priority of the task that runs the block and alarm callbacks.
+//
+//*****************************************************************************
+#define ADC_STREAM_TASK_PRIORITY                                              \
+                                (tskIDLE_PRIORITY + 3)
+
+//*****************************************************************************
+//
+// Stream configuration.
+//
+// pui32Channels lists the inputs to sample, as ADC_CTL_CHn values.  Samples
+// are stored interleaved in this order.  pui16Buffer must hold
+// 2 * ui32BlockSamples samples; ui32BlockSamples is a multiple of
+// ui32NumChannels.  ui32SampleRate is the number of scans of all channels per
+// second.  ui32Oversample is the hardware averaging factor, a power of two
+// from 1 to 64.
+//
+// pfnBlock is called from the stream task with each half buffer as it fills.
+// The half is not overwritten until the other half has filled, so it must be
+// consumed within one block period.  pfnAlarm is called with a mask of the
+// comparators that fired since the last call.
+//
+//*****************************************************************************
+typedef struct
+{
+    const uint32_t *pui32Channels;
+    uint32_t ui32NumChannels;
+    uint32_t ui32SampleRate;
+    uint32_t ui32Oversample;
+    uint16_t *pui16Buffer;
+    uint32_t ui32BlockSamples;
+    void (*pfnBlock)(const uint16_t *pui16Block, uint32_t ui32Count,
+                     void *pvArg);
+    void (*pfnAlarm)(uint32_t ui32Alarms, void *pvArg);
+    void *pvArg;
+}
+AdcStreamConfig_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern bool AdcStreamInit(const AdcStreamConfig_t *psConfig,
+                          uint32_t ui32SysClock);
+extern int32_t AdcStreamAlarmAdd(uint32_t ui32Channel, uint16_t ui16Low,
+                                 uint16_t ui16High, uint32_t ui32IntMode);
+extern void AdcStreamStart(void);
+extern void AdcStreamStop(void);
+extern uint32_t AdcStreamOverrunsGet(void);
+extern void ADC0SS0IntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ADC_STREAM_H__
@@ -0,0 +1,905 @@
+//*****************************************************************************
+//
+// band_render.c - Deferred grlib rendering through display lists and band
+//                 buffers.
+//
+// Drawing straight to the panel shows every step of a frame: a graph that is
+// cleared and redrawn flickers, and a pixel covered by three shapes is sent
+// three times.  This renderer is a grlib display driver that only records.
+// Each call becomes a small record in a display list; nothing reaches the
+// panel until the frame is flushed.
+//
+// At the flush the list is binned by horizontal band of BAND_ROWS rows (a
+// counting sort, so each band sees its records in drawing order), and each
+// band is drawn into one of two band buffers in the panel's native format.
+// The panel cannot be read back, so only pixels some record covered are
+// sent: each run of them is a window, runs with the same ends on
+// neighbouring rows are merged, and every window goes to the sink in one
+// transfer.  Each pixel of the panel is written at most once per frame, in
+// its final color, and the rest are left alone.
+//
+// The sink may send a window in the background (the Kentec driver uses
+// uDMA), so while the last window of one band is going out the next band is
+// drawn into the other buffer.  Windows within a band go one after another.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "grlib/grlib.h"
+#include "utils/uartstdio.h"
+#include "drivers/band_render.h"
+#include "drivers/cycle_counter.h"
+
+//*****************************************************************************
+//
+// A display list record.  Every record starts with this header, which gives
+// its length in words and the rows it touches; a record with ui16YMin above
+// ui16YMax touches none and is never binned.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t ui8Type;
+    uint8_t ui8BPP;
+    uint16_t ui16Words;
+    uint16_t ui16YMin;
+    uint16_t ui16YMax;
+}
+BandRecord_t;
+
+#define BAND_HEADER_WORDS       2
+#define BAND_LIST_WORDS         (BAND_LIST_BYTES / 4)
+
+//
+// A rectangle of one color: RectFill, LineDrawH and LineDrawV.  The body is
+// the x extent then the color.
+//
+#define BAND_REC_FILL           1
+#define BAND_FILL_WORDS         (BAND_HEADER_WORDS + 2)
+
+//
+// Single pixels of one color.  The body is the color then one word per
+// pixel, x in the low half and y in the high half.  Consecutive PixelDraw
+// calls in one color add to the same record.
+//
+#define BAND_REC_PIXELS         2
+#define BAND_PIXELS_WORDS       (BAND_HEADER_WORDS + 1)
+
+//
+// A PixelDrawMultiple call.  The body is the x position and count, then the
+// sub-pixel offset, the depth and the list offset of its palette, then for
+// 1 BPP the two (already translated) colors, then a copy of the pixel data.
+//
+#define BAND_REC_MULTI          3
+#define BAND_MULTI_WORDS        (BAND_HEADER_WORDS + 2)
+
+//
+// The translated palette of a 4 or 8 BPP image, shared by the records that
+// follow it.  The body is a bitmap of the entries translated so far, then
+// the entries.  Only entries the image uses are read, as a palette may be
+// shorter than the depth allows.  The bitmap is at least a word, as a 4 BPP
+// palette has only 16 entries.
+//
+#define BAND_REC_PALETTE        4
+#define BAND_PALETTE_DONE_WORDS(ui32BPP)                                      \
+        (((1 << (ui32BPP)) + 31) / 32)
+
+//*****************************************************************************
+//
+// Returns the record at an offset in the list, and its body.
+//
+//*****************************************************************************
+#define BAND_RECORD(psBand, ui32Offset)                                       \
+        ((BandRecord_t *)((psBand)->pui32List + (ui32Offset)))
+#define BAND_BODY(psRecord)                                                   \
+        ((uint32_t *)(psRecord) + BAND_HEADER_WORDS)
+
+static void prvFlush(BandRender_t *psBand);
+
+//*****************************************************************************
+//
+// Makes room for ui32Words more words in the list, flushing what is there
+// if it is full.
+//
+//*****************************************************************************
+static void
+prvRoom(BandRender_t *psBand, uint32_t ui32Words)
+{
+    if(psBand->ui32Used + ui32Words > BAND_LIST_WORDS)
+    {
+        psBand->sStats.ui32EarlyFlushes++;
+        prvFlush(psBand);
+    }
+}
+
+//*****************************************************************************
+//
+// Appends a record of ui32Words words touching rows i32YMin to i32YMax, and
+// returns it.
+//
+//*****************************************************************************
+static BandRecord_t *
+prvRecordAdd(BandRender_t *psBand, uint32_t ui32Type, uint32_t ui32Words,
+             int32_t i32YMin, int32_t i32YMax)
+{
+    BandRecord_t *psRecord;
+
+    prvRoom(psBand, ui32Words);
+
+    psRecord = BAND_RECORD(psBand, psBand->ui32Used);
+    psRecord->ui8Type = ui32Type;
+    psRecord->ui8BPP = 0;
+    psRecord->ui16Words = ui32Words;
+    psRecord->ui16YMin = i32YMin;
+    psRecord->ui16YMax = i32YMax;
+
+    psBand->ui32Last = psBand->ui32Used;
+    psBand->ui32Used += ui32Words;
+    psBand->sStats.ui32Records++;
+
+    return(psRecord);
+}
+
+//*****************************************************************************
+//
+// Records a rectangle of one color.
+//
+//*****************************************************************************
+static void
+prvFillAdd(BandRender_t *psBand, int32_t i32X1, int32_t i32X2, int32_t i32Y1,
+           int32_t i32Y2, uint32_t ui32Value)
+{
+    BandRecord_t *psRecord;
+    uint32_t *pui32Body;
+
+    psRecord = prvRecordAdd(psBand, BAND_REC_FILL, BAND_FILL_WORDS, i32Y1,
+                            i32Y2);
+    pui32Body = BAND_BODY(psRecord);
+    pui32Body[0] = (uint16_t)i32X1 | ((uint32_t)i32X2 << 16);
+    pui32Body[1] = ui32Value;
+}
+
+//*****************************************************************************
+//
+// The recording display driver.  The coordinates are within the display, as
+// grlib clips before it calls a driver.
+//
+//*****************************************************************************
+static void
+prvPixelDraw(void *pvDisplayData, int32_t i32X, int32_t i32Y,
+             uint32_t ui32Value)
+{
+    BandRender_t *psBand = pvDisplayData;
+    BandRecord_t *psRecord;
+    uint32_t *pui32Body;
+
+    //
+    // Add to the last record if it is a run of pixels in this color.
+    //
+    psRecord = BAND_RECORD(psBand, psBand->ui32Last);
+    if(psBand->ui32Used && (psRecord->ui8Type == BAND_REC_PIXELS) &&
+       (BAND_BODY(psRecord)[0] == ui32Value) &&
+       (psBand->ui32Used < BAND_LIST_WORDS) && (psRecord->ui16Words < 0xffff))
+    {
+        psBand->pui32List[psBand->ui32Used++] =
+            (uint16_t)i32X | ((uint32_t)i32Y << 16);
+        psRecord->ui16Words++;
+        if(i32Y < psRecord->ui16YMin)
+        {
+            psRecord->ui16YMin = i32Y;
+        }
+        if(i32Y > psRecord->ui16YMax)
+        {
+            psRecord->ui16YMax = i32Y;
+        }
+        return;
+    }
+
+    psRecord = prvRecordAdd(psBand, BAND_REC_PIXELS, BAND_PIXELS_WORDS + 1,
+                            i32Y, i32Y);
+    pui32Body = BAND_BODY(psRecord);
+    pui32Body[0] = ui32Value;
+    pui32Body[1] = (uint16_t)i32X | ((uint32_t)i32Y << 16);
+}
+
+static void
+prvPixelDrawMultiple(void *pvDisplayData, int32_t i32X, int32_t i32Y,
+                     int32_t i32X0, int32_t i32Count, int32_t i32BPP,
+                     const uint8_t *pui8Data, const uint8_t *pui8Palette)
+{
+    BandRender_t *psBand = pvDisplayData;
+    BandRecord_t *psRecord;
+    uint32_t *pui32Body, *pui32Done;
+    uint16_t *pui16Entries;
+    uint32_t ui32BPP, ui32Bytes, ui32Words, ui32PaletteWords, ui32Idx;
+    uint32_t ui32Entry, ui32Pos;
+    const uint8_t *pui8Entry;
+    bool bNewPalette;
+
+    if(i32Count <= 0)
+    {
+        return;
+    }
+
+    ui32BPP = i32BPP & ~GRLIB_DRIVER_FLAG_NEW_IMAGE;
+    switch(ui32BPP)
+    {
+        case 1:
+        case 4:
+        {
+            ui32Bytes = (((i32X0 + i32Count) * ui32BPP) + 7) / 8;
+            break;
+        }
+        case 8:
+        {
+            i32X0 = 0;
+            ui32Bytes = i32Count;
+            break;
+        }
+        case 16:
+        {
+            i32X0 = 0;
+            ui32Bytes = i32Count * 2;
+            break;
+        }
+        default:
+        {
+            return;
+        }
+    }
+
+    ui32Words = BAND_MULTI_WORDS + ((ui32BPP == 1) ? 2 : 0) +
+                ((ui32Bytes + 3) / 4);
+
+    //
+    // 4 and 8 BPP pixels are indices into a palette of 24-bit colors.  Keep
+    // using the last palette record unless this is a different palette (or
+    // grlib says the image is new, so the palette may have changed in
+    // place), and make room for both records at once so that an early flush
+    // cannot come between them.
+    //
+    ui32PaletteWords = 0;
+    if((ui32BPP == 4) || (ui32BPP == 8))
+    {
+        ui32PaletteWords = BAND_HEADER_WORDS +
+                           BAND_PALETTE_DONE_WORDS(ui32BPP) +
+                           (1 << ui32BPP) / 2;
+        bNewPalette = ((i32BPP & GRLIB_DRIVER_FLAG_NEW_IMAGE) ||
+                       (psBand->pui8PaletteSrc != pui8Palette) ||
+                       (psBand->ui32PaletteBPP != ui32BPP));
+        prvRoom(psBand, ui32Words + (bNewPalette ? ui32PaletteWords : 0));
+        if(bNewPalette || !psBand->pui8PaletteSrc)
+        {
+            psRecord = prvRecordAdd(psBand, BAND_REC_PALETTE,
+                                    ui32PaletteWords, 0xffff, 0);
+            memset(BAND_BODY(psRecord), 0,
+                   BAND_PALETTE_DONE_WORDS(ui32BPP) * 4);
+            psBand->ui32Palette = psBand->ui32Last;
+            psBand->pui8PaletteSrc = pui8Palette;
+            psBand->ui32PaletteBPP = ui32BPP;
+        }
+
+        //
+        // Translate the entries these pixels use that have not been yet.
+        //
+        psRecord = BAND_RECORD(psBand, psBand->ui32Palette);
+        pui32Done = BAND_BODY(psRecord);
+        pui16Entries = (uint16_t *)(pui32Done +
+                                    BAND_PALETTE_DONE_WORDS(ui32BPP));
+        for(ui32Idx = 0; ui32Idx < (uint32_t)i32Count; ui32Idx++)
+        {
+            ui32Pos = i32X0 + ui32Idx;
+            ui32Entry = (ui32BPP == 8) ? pui8Data[ui32Pos] :
+                        ((pui8Data[ui32Pos / 2] >> ((ui32Pos & 1) ? 0 : 4)) &
+                         15);
+            if(!(pui32Done[ui32Entry / 32] & (1 << (ui32Entry & 31))))
+            {
+                pui8Entry = pui8Palette + (ui32Entry * 3);
+                pui16Entries[ui32Entry] =
+                    DpyColorTranslate(psBand->psTarget,
+                                      (pui8Entry[0] | (pui8Entry[1] << 8) |
+                                       (pui8Entry[2] << 16)));
+                pui32Done[ui32Entry / 32] |= 1 << (ui32Entry & 31);
+            }
+        }
+    }
+
+    psRecord = prvRecordAdd(psBand, BAND_REC_MULTI, ui32Words, i32Y, i32Y);
+    psRecord->ui8BPP = ui32BPP;
+    pui32Body = BAND_BODY(psRecord);
+    pui32Body[0] = (uint16_t)i32X | ((uint32_t)i32Count << 16);
+    pui32Body[1] = i32X0 | ((uint32_t)psBand->ui32Palette << 16);
+    pui32Body += 2;
+
+    //
+    // A 1 BPP palette holds two colors already translated for the display,
+    // and is usually the caller's local variable, so it is copied too.
+    //
+    if(ui32BPP == 1)
+    {
+        pui32Body[0] = ((const uint32_t *)pui8Palette)[0];
+        pui32Body[1] = ((const uint32_t *)pui8Palette)[1];
+        pui32Body += 2;
+    }
+
+    memcpy(pui32Body, pui8Data, ui32Bytes);
+}
+
+static void
+prvLineDrawH(void *pvDisplayData, int32_t i32X1, int32_t i32X2,
+             int32_t i32Y, uint32_t ui32Value)
+{
+    prvFillAdd(pvDisplayData, i32X1, i32X2, i32Y, i32Y, ui32Value);
+}
+
+static void
+prvLineDrawV(void *pvDisplayData, int32_t i32X, int32_t i32Y1,
+             int32_t i32Y2, uint32_t ui32Value)
+{
+    prvFillAdd(pvDisplayData, i32X, i32X, i32Y1, i32Y2, ui32Value);
+}
+
+static void
+prvRectFill(void *pvDisplayData, const tRectangle *psRect, uint32_t ui32Value)
+{
+    prvFillAdd(pvDisplayData, psRect->i16XMin, psRect->i16XMax,
+               psRect->i16YMin, psRect->i16YMax, ui32Value);
+}
+
+static uint32_t
+prvColorTranslate(void *pvDisplayData, uint32_t ui32Value)
+{
+    BandRender_t *psBand = pvDisplayData;
+
+    return(DpyColorTranslate(psBand->psTarget, ui32Value));
+}
+
+static void
+prvFlushCallback(void *pvDisplayData)
+{
+    BandRenderFlush(pvDisplayData);
+}
+
+//*****************************************************************************
+//
+// Marks pixels i32X1 to i32X2 of a band row as drawn.
+//
+//*****************************************************************************
+static void
+prvCover(uint32_t *pui32Row, int32_t i32X1, int32_t i32X2)
+{
+    uint32_t ui32First, ui32Last, ui32Word;
+
+    ui32First = i32X1 / 32;
+    ui32Last = i32X2 / 32;
+    if(ui32First == ui32Last)
+    {
+        pui32Row[ui32First] |= (0xffffffff << (i32X1 & 31)) &
+                               (0xffffffff >> (31 - (i32X2 & 31)));
+        return;
+    }
+
+    pui32Row[ui32First] |= 0xffffffff << (i32X1 & 31);
+    for(ui32Word = ui32First + 1; ui32Word < ui32Last; ui32Word++)
+    {
+        pui32Row[ui32Word] = 0xffffffff;
+    }
+    pui32Row[ui32Last] |= 0xffffffff >> (31 - (i32X2 & 31));
+}
+
+//*****************************************************************************
+//
+// Draws the part of one record that falls in the band starting at row i32Y0
+// into the band buffer.
+//
+//*****************************************************************************
+static void
+prvRecordDraw(BandRender_t *psBand, const BandRecord_t *psRecord,
+              int32_t i32Y0, uint32_t ui32Rows, uint16_t *pui16Band)
+{
+    const uint32_t *pui32Body = BAND_BODY(psRecord);
+    const uint16_t *pui16Palette;
+    const uint8_t *pui8Data;
+    uint32_t ui32Width, ui32Count, ui32Idx, ui32Pos, ui32Value;
+    int32_t i32X, i32X2, i32Y, i32YEnd;
+    uint16_t *pui16Pixel;
+
+    ui32Width = psBand->sDisplay.ui16Width;
+
+    switch(psRecord->ui8Type)
+    {
+        case BAND_REC_FILL:
+        {
+            i32X = pui32Body[0] & 0xffff;
+            i32X2 = pui32Body[0] >> 16;
+            i32Y = (psRecord->ui16YMin > i32Y0) ? psRecord->ui16YMin : i32Y0;
+            i32YEnd = i32Y0 + ui32Rows - 1;
+            if(psRecord->ui16YMax < i32YEnd)
+            {
+                i32YEnd = psRecord->ui16YMax;
+            }
+
+            for(; i32Y <= i32YEnd; i32Y++)
+            {
+                pui16Pixel = pui16Band + ((i32Y - i32Y0) * ui32Width);
+                for(ui32Idx = i32X; ui32Idx <= (uint32_t)i32X2; ui32Idx++)
+                {
+                    pui16Pixel[ui32Idx] = pui32Body[1];
+                }
+                prvCover(psBand->ppui32Cover[i32Y - i32Y0], i32X, i32X2);
+            }
+            break;
+        }
+
+        case BAND_REC_PIXELS:
+        {
+            ui32Count = psRecord->ui16Words - BAND_PIXELS_WORDS;
+            for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+            {
+                i32X = pui32Body[1 + ui32Idx] & 0xffff;
+                i32Y = (pui32Body[1 + ui32Idx] >> 16) - i32Y0;
+                if((i32Y >= 0) && (i32Y < (int32_t)ui32Rows))
+                {
+                    pui16Band[(i32Y * ui32Width) + i32X] = pui32Body[0];
+                    psBand->ppui32Cover[i32Y][i32X / 32] |= 1 << (i32X & 31);
+                }
+            }
+            break;
+        }
+
+        case BAND_REC_MULTI:
+        {
+            i32X = pui32Body[0] & 0xffff;
+            ui32Count = pui32Body[0] >> 16;
+            ui32Pos = pui32Body[1] & 0xffff;
+            pui16Palette = 0;
+            if((psRecord->ui8BPP == 4) || (psRecord->ui8BPP == 8))
+            {
+                pui16Palette = (const uint16_t *)
+                    (BAND_BODY(BAND_RECORD(psBand, pui32Body[1] >> 16)) +
+                     BAND_PALETTE_DONE_WORDS(psRecord->ui8BPP));
+            }
+            pui8Data = (const uint8_t *)(pui32Body + 2);
+            if(psRecord->ui8BPP == 1)
+            {
+                pui8Data += 8;
+            }
+
+            i32Y = psRecord->ui16YMin - i32Y0;
+            pui16Pixel = pui16Band + (i32Y * ui32Width) + i32X;
+            for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++, ui32Pos++)
+            {
+                switch(psRecord->ui8BPP)
+                {
+                    case 1:
+                    {
+                        ui32Value = pui32Body[2 + ((pui8Data[ui32Pos / 8] >>
+                                                    (7 - (ui32Pos & 7))) & 1)];
+                        break;
+                    }
+                    case 4:
+                    {
+                        ui32Value = pui16Palette[(pui8Data[ui32Pos / 2] >>
+                                                  ((ui32Pos & 1) ? 0 : 4)) &
+                                                 15];
+                        break;
+                    }
+                    case 8:
+                    {
+                        ui32Value = pui16Palette[pui8Data[ui32Pos]];
+                        break;
+                    }
+                    default:
+                    {
+                        ui32Value = pui8Data[ui32Pos * 2] |
+                                    (pui8Data[(ui32Pos * 2) + 1] << 8);
+                        break;
+                    }
+                }
+                pui16Pixel[ui32Idx] = ui32Value;
+            }
+            prvCover(psBand->ppui32Cover[i32Y], i32X, i32X + ui32Count - 1);
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the first pixel at or after i32X in a coverage row that is drawn
+// (bDrawn) or not, or ui32Width if there is none.
+//
+//*****************************************************************************
+static uint32_t
+prvCoverFind(const uint32_t *pui32Row, uint32_t ui32X, uint32_t ui32Width,
+             bool bDrawn)
+{
+    uint32_t ui32Word;
+
+    while(ui32X < ui32Width)
+    {
+        ui32Word = bDrawn ? pui32Row[ui32X / 32] : ~pui32Row[ui32X / 32];
+        ui32Word &= 0xffffffff << (ui32X & 31);
+        if(ui32Word)
+        {
+            ui32X = (ui32X & ~31) + __builtin_ctz(ui32Word);
+            return((ui32X < ui32Width) ? ui32X : ui32Width);
+        }
+        ui32X = (ui32X & ~31) + 32;
+    }
+    return(ui32Width);
+}
+
+//*****************************************************************************
+//
+// Sends one window of the band buffer, from its first row to ui32LastRow, for
+// the band starting at display row i32Y0.
+//
+//*****************************************************************************
+static void
+prvWindowSend(BandRender_t *psBand, const uint16_t *pui16Band, int32_t i32Y0,
+              const BandWindow_t *psWindow, uint32_t ui32LastRow)
+{
+    uint32_t ui32Width = psBand->sDisplay.ui16Width;
+    tRectangle sRect;
+
+    sRect.i16XMin = psWindow->ui16X1;
+    sRect.i16XMax = psWindow->ui16X2;
+    sRect.i16YMin = i32Y0 + psWindow->ui16Row;
+    sRect.i16YMax = i32Y0 + ui32LastRow;
+
+    psBand->psSink->pfnWindowWrite(psBand->psSink->pvSinkData, &sRect,
+                                   pui16Band +
+                                   (psWindow->ui16Row * ui32Width) +
+                                   psWindow->ui16X1, ui32Width);
+    psBand->bInFlight = true;
+    psBand->sStats.ui32Windows++;
+    psBand->sStats.ui32Pixels += (psWindow->ui16X2 - psWindow->ui16X1 + 1) *
+                                 (ui32LastRow - psWindow->ui16Row + 1);
+}
+
+//*****************************************************************************
+//
+// Sends the drawn pixels of a band.  Each row is split into runs of drawn
+// pixels, and a run with the same ends as one on the row above extends that
+// window down instead of starting a new one.  Returns true if anything was
+// sent.
+//
+//*****************************************************************************
+static bool
+prvBandSend(BandRender_t *psBand, const uint16_t *pui16Band, int32_t i32Y0,
+            uint32_t ui32Rows)
+{
+    uint32_t ui32Width = psBand->sDisplay.ui16Width;
+    uint32_t ui32Windows = psBand->sStats.ui32Windows;
+    uint32_t ui32Row, ui32X1, ui32X2, ui32Open, ui32Next, ui32Idx;
+    BandWindow_t *psOpen, *psNext;
+
+    //
+    // The windows still open after the row above, and those open after this
+    // one.  Both, like a row's runs, are in order of x, so one pass over each
+    // row matches them.
+    //
+    ui32Open = 0;
+    for(ui32Row = 0; ui32Row <= ui32Rows; ui32Row++)
+    {
+        psOpen = psBand->ppsOpen[ui32Row & 1];
+        psNext = psBand->ppsOpen[(ui32Row & 1) ^ 1];
+        ui32Next = 0;
+        ui32Idx = 0;
+        ui32X1 = 0;
+        for(;;)
+        {
+            //
+            // Find the next run.  The row past the end of the band has none,
+            // which closes every window.
+            //
+            ui32X1 = (ui32Row < ui32Rows) ?
+                     prvCoverFind(psBand->ppui32Cover[ui32Row], ui32X1,
+                                  ui32Width, true) : ui32Width;
+            ui32X2 = (ui32X1 < ui32Width) ?
+                     prvCoverFind(psBand->ppui32Cover[ui32Row], ui32X1,
+                                  ui32Width, false) - 1 : ui32Width;
+
+            //
+            // A window that starts left of this run cannot be continued by it
+            // or by any run after it.
+            //
+            while((ui32Idx < ui32Open) && (psOpen[ui32Idx].ui16X1 < ui32X1))
+            {
+                prvWindowSend(psBand, pui16Band, i32Y0, &psOpen[ui32Idx],
+                              ui32Row - 1);
+                ui32Idx++;
+            }
+            if(ui32X1 >= ui32Width)
+            {
+                break;
+            }
+
+            if((ui32Idx < ui32Open) && (psOpen[ui32Idx].ui16X1 == ui32X1) &&
+               (psOpen[ui32Idx].ui16X2 == ui32X2))
+            {
+                psNext[ui32Next++] = psOpen[ui32Idx++];
+            }
+            else
+            {
+                if((ui32Idx < ui32Open) && (psOpen[ui32Idx].ui16X1 == ui32X1))
+                {
+                    prvWindowSend(psBand, pui16Band, i32Y0, &psOpen[ui32Idx],
+                                  ui32Row - 1);
+                    ui32Idx++;
+                }
+                psNext[ui32Next].ui16X1 = ui32X1;
+                psNext[ui32Next].ui16X2 = ui32X2;
+                psNext[ui32Next].ui16Row = ui32Row;
+                ui32Next++;
+            }
+            ui32X1 = ui32X2 + 1;
+        }
+
+        ui32Open = ui32Next;
+    }
+
+    return(psBand->sStats.ui32Windows != ui32Windows);
+}
+
+//*****************************************************************************
+//
+// Sorts the records into bands.  Returns false if there are more (record,
+// band) pairs than pui16Entries holds.
+//
+//*****************************************************************************
+static bool
+prvBin(BandRender_t *psBand, uint32_t ui32Bands)
+{
+    uint16_t pui16Next[BAND_MAX_BANDS];
+    const BandRecord_t *psRecord;
+    uint32_t ui32Offset, ui32Band, ui32Total;
+
+    memset(psBand->pui16BandStart, 0, sizeof(psBand->pui16BandStart));
+
+    //
+    // Count the records in each band...
+    //
+    ui32Total = 0;
+    for(ui32Offset = 0; ui32Offset < psBand->ui32Used;
+        ui32Offset += psRecord->ui16Words)
+    {
+        psRecord = BAND_RECORD(psBand, ui32Offset);
+        if(psRecord->ui16YMin > psRecord->ui16YMax)
+        {
+            continue;
+        }
+        for(ui32Band = psRecord->ui16YMin / BAND_ROWS;
+            ui32Band <= (uint32_t)psRecord->ui16YMax / BAND_ROWS; ui32Band++)
+        {
+            psBand->pui16BandStart[ui32Band + 1]++;
+            ui32Total++;
+        }
+    }
+    if(ui32Total > BAND_MAX_ENTRIES)
+    {
+        return(false);
+    }
+
+    //
+    // ...turn the counts into where each band's entries start...
+    //
+    for(ui32Band = 0; ui32Band < ui32Bands; ui32Band++)
+    {
+        psBand->pui16BandStart[ui32Band + 1] +=
+            psBand->pui16BandStart[ui32Band];
+        pui16Next[ui32Band] = psBand->pui16BandStart[ui32Band];
+    }
+
+    //
+    // ...and place them, in list order.
+    //
+    for(ui32Offset = 0; ui32Offset < psBand->ui32Used;
+        ui32Offset += psRecord->ui16Words)
+    {
+        psRecord = BAND_RECORD(psBand, ui32Offset);
+        if(psRecord->ui16YMin > psRecord->ui16YMax)
+        {
+            continue;
+        }
+        for(ui32Band = psRecord->ui16YMin / BAND_ROWS;
+            ui32Band <= (uint32_t)psRecord->ui16YMax / BAND_ROWS; ui32Band++)
+        {
+            psBand->pui16Entries[pui16Next[ui32Band]++] = ui32Offset;
+        }
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Draws and sends every band the list touches, then empties the list.
+//
+//*****************************************************************************
+static void
+prvFlush(BandRender_t *psBand)
+{
+    const BandRecord_t *psRecord;
+    uint32_t ui32Bands, ui32Band, ui32Rows, ui32Idx, ui32Offset, ui32Start;
+    uint16_t *pui16Band;
+    int32_t i32Y0;
+    bool bBinned;
+
+    if(psBand->ui32Used == 0)
+    {
+        return;
+    }
+
+    ui32Start = CycleCounterGet();
+    if(psBand->ui32Used * 4 > psBand->sStats.ui32ListPeak)
+    {
+        psBand->sStats.ui32ListPeak = psBand->ui32Used * 4;
+    }
+
+    ui32Bands = (psBand->sDisplay.ui16Height + BAND_ROWS - 1) / BAND_ROWS;
+    bBinned = prvBin(psBand, ui32Bands);
+    if(!bBinned)
+    {
+        psBand->sStats.ui32ScanFrames++;
+    }
+
+    for(ui32Band = 0; ui32Band < ui32Bands; ui32Band++)
+    {
+        if(bBinned && (psBand->pui16BandStart[ui32Band] ==
+                       psBand->pui16BandStart[ui32Band + 1]))
+        {
+            continue;
+        }
+
+        i32Y0 = ui32Band * BAND_ROWS;
+        ui32Rows = psBand->sDisplay.ui16Height - i32Y0;
+        if(ui32Rows > BAND_ROWS)
+        {
+            ui32Rows = BAND_ROWS;
+        }
+
+        //
+        // The buffer the last window was sent from may still be being read,
+        // so draw into the other one.
+        //
+        pui16Band = psBand->ppui16Band[psBand->ui32Buffer];
+        memset(psBand->ppui32Cover, 0, sizeof(psBand->ppui32Cover));
+
+        if(bBinned)
+        {
+            for(ui32Idx = psBand->pui16BandStart[ui32Band];
+                ui32Idx < psBand->pui16BandStart[ui32Band + 1]; ui32Idx++)
+            {
+                psRecord = BAND_RECORD(psBand,
+                                       psBand->pui16Entries[ui32Idx]);
+                prvRecordDraw(psBand, psRecord, i32Y0, ui32Rows, pui16Band);
+            }
+        }
+        else
+        {
+            for(ui32Offset = 0; ui32Offset < psBand->ui32Used;
+                ui32Offset += psRecord->ui16Words)
+            {
+                psRecord = BAND_RECORD(psBand, ui32Offset);
+                if((psRecord->ui16YMin <= psRecord->ui16YMax) &&
+                   (psRecord->ui16YMax >= i32Y0) &&
+                   (psRecord->ui16YMin < i32Y0 + ui32Rows))
+                {
+                    prvRecordDraw(psBand, psRecord, i32Y0, ui32Rows,
+                                  pui16Band);
+                }
+            }
+        }
+
+        if(prvBandSend(psBand, pui16Band, i32Y0, ui32Rows))
+        {
+            psBand->ui32Buffer ^= 1;
+        }
+    }
+
+    //
+    // The list is about to be reused, and so are the buffers.
+    //
+    if(psBand->bInFlight)
+    {
+        psBand->psSink->pfnWindowWait(psBand->psSink->pvSinkData);
+        psBand->bInFlight = false;
+    }
+    psBand->ui32Used = 0;
+    psBand->pui8PaletteSrc = 0;
+
+    ui32Start = CycleCounterGet() - ui32Start;
+    if(ui32Start > psBand->sStats.ui32MaxFlushCycles)
+    {
+        psBand->sStats.ui32MaxFlushCycles = ui32Start;
+    }
+}
+
+//*****************************************************************************
+//
+//! Sets up a deferred renderer for a display.
+//!
+//! \param psBand is the renderer.
+//! \param psTarget is the display it draws for, which gives the size and
+//! the color format.
+//! \param psSink sends finished windows to the display.
+//!
+//! Draw into \e psBand->sDisplay.  A display wider than BAND_MAX_WIDTH or
+//! taller than BAND_MAX_HEIGHT is not supported.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BandRenderInit(BandRender_t *psBand, const tDisplay *psTarget,
+               const BandSink_t *psSink)
+{
+    memset(psBand, 0, sizeof(*psBand));
+
+    psBand->psTarget = psTarget;
+    psBand->psSink = psSink;
+
+    psBand->sDisplay.i32Size = sizeof(tDisplay);
+    psBand->sDisplay.pvDisplayData = psBand;
+    psBand->sDisplay.ui16Width = psTarget->ui16Width;
+    psBand->sDisplay.ui16Height = psTarget->ui16Height;
+    psBand->sDisplay.pfnPixelDraw = prvPixelDraw;
+    psBand->sDisplay.pfnPixelDrawMultiple = prvPixelDrawMultiple;
+    psBand->sDisplay.pfnLineDrawH = prvLineDrawH;
+    psBand->sDisplay.pfnLineDrawV = prvLineDrawV;
+    psBand->sDisplay.pfnRectFill = prvRectFill;
+    psBand->sDisplay.pfnColorTranslate = prvColorTranslate;
+    psBand->sDisplay.pfnFlush = prvFlushCallback;
+
+    CycleCounterInit();
+}
+
+//*****************************************************************************
+//
+//! Draws everything recorded since the last flush on the display.
+//!
+//! \param psBand is the renderer.
+//!
+//! This is what GrFlush() on a context drawing into the renderer calls.  It
+//! returns once the last window has been sent.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BandRenderFlush(BandRender_t *psBand)
+{
+    if(psBand->ui32Used)
+    {
+        prvFlush(psBand);
+        psBand->sStats.ui32Frames++;
+    }
+}
+
+//*****************************************************************************
+//
+//! Prints the renderer's counts.
+//!
+//! \param psBand is the renderer.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BandRenderStatsPrint(BandRender_t *psBand)
+{
+    BandStats_t *psStats = &psBand->sStats;
+
+    UARTprintf("band render: %d frames, %d flushed early, %d scanned\n",
+               psStats->ui32Frames, psStats->ui32EarlyFlushes,
+               psStats->ui32ScanFrames);
+    UARTprintf("  %d records, list peak %d of %d bytes\n",
+               psStats->ui32Records, psStats->ui32ListPeak, BAND_LIST_BYTES);
+    UARTprintf("  %d windows, %d pixels, slowest flush %d cycles\n",
+               psStats->ui32Windows, psStats->ui32Pixels,
+               psStats->ui32MaxFlushCycles);
+}
@@ -0,0 +1,168 @@
+//*****************************************************************************
+//
+// band_render.h - Deferred grlib rendering through display lists and band
+//                 buffers.
+//
+//*****************************************************************************
+
+#ifndef __BAND_RENDER_H__
+#define __BAND_RENDER_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The height of a band in rows, and the largest display width and height
+// supported (the same, so portrait works too).  Two band buffers of
+// BAND_ROWS * BAND_MAX_WIDTH native pixels are kept, and the binning pass
+// has a slot for each band down BAND_MAX_HEIGHT rows.
+//
+//*****************************************************************************
+#define BAND_ROWS               8
+#define BAND_MAX_WIDTH          320
+#define BAND_MAX_HEIGHT         320
+#define BAND_MAX_BANDS          ((BAND_MAX_HEIGHT + BAND_ROWS - 1) / BAND_ROWS)
+
+//*****************************************************************************
+//
+// The size of the display list, and the number of (record, band) pairs the
+// binning pass can hold.  A frame that outgrows the list is flushed early
+// and recording carries on: the panel still ends up right, but the pixels
+// drawn on both sides of the early flush are sent twice.  A frame with more
+// pairs than fit is binned by scanning the list once per band instead.
+// The sizes hold the busiest frame of the host's widget screens, a whole
+// screen of text and widgets in about 47 KB and 3000 pairs, in one go.
+//
+//*****************************************************************************
+#ifndef BAND_LIST_BYTES
+#define BAND_LIST_BYTES         65536
+#endif
+#ifndef BAND_MAX_ENTRIES
+#define BAND_MAX_ENTRIES        4096
+#endif
+
+//*****************************************************************************
+//
+// Where finished bands go.  pfnWindowWrite sends the pixels of one rectangle
+// to the display, row by row from pui16Pixels, ui32Stride pixels apart, and
+// may return before they have all gone; it must wait for any earlier window
+// to finish first.  The pixels are not touched again until pfnWindowWait,
+// which waits for the last window to finish, has been called or another
+// window has been written.
+//
+//*****************************************************************************
+typedef struct
+{
+    void (*pfnWindowWrite)(void *pvSinkData, const tRectangle *psRect,
+                           const uint16_t *pui16Pixels, uint32_t ui32Stride);
+    void (*pfnWindowWait)(void *pvSinkData);
+    void *pvSinkData;
+}
+BandSink_t;
+
+//*****************************************************************************
+//
+// Counts kept across flushes, for BandRenderStatsPrint().  Pixels are the
+// ones sent to the sink.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Frames;
+    uint32_t ui32EarlyFlushes;
+    uint32_t ui32ScanFrames;
+    uint32_t ui32Records;
+    uint32_t ui32ListPeak;
+    uint32_t ui32Windows;
+    uint32_t ui32Pixels;
+    uint32_t ui32MaxFlushCycles;
+}
+BandStats_t;
+
+//*****************************************************************************
+//
+// A window being built over the rows of a band: its first and last pixel and
+// the row it started on.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint16_t ui16X1;
+    uint16_t ui16X2;
+    uint16_t ui16Row;
+}
+BandWindow_t;
+
+//*****************************************************************************
+//
+// A deferred renderer.  Draw into sDisplay, with a context made by
+// GrContextInit(), and call GrFlush() (or BandRenderFlush()) at the end of
+// each frame.  Nothing reaches the panel until then.  Set up with
+// BandRenderInit(); the members are private.
+//
+//*****************************************************************************
+typedef struct
+{
+    tDisplay sDisplay;
+    const tDisplay *psTarget;
+    const BandSink_t *psSink;
+
+    //
+    // The display list, in words, and the state of the records at its end.
+    //
+    uint32_t ui32Used;
+    uint32_t ui32Last;
+    uint32_t ui32Palette;
+    const uint8_t *pui8PaletteSrc;
+    uint32_t ui32PaletteBPP;
+    uint32_t pui32List[BAND_LIST_BYTES / 4];
+
+    //
+    // The binning pass: the (record, band) pairs, sorted by band.
+    //
+    uint16_t pui16BandStart[BAND_MAX_BANDS + 1];
+    uint16_t pui16Entries[BAND_MAX_ENTRIES];
+
+    //
+    // The band being built: its pixels, which of them have been drawn, and
+    // the windows open over the rows so far.
+    //
+    uint32_t ui32Buffer;
+    bool bInFlight;
+    uint16_t ppui16Band[2][BAND_ROWS * BAND_MAX_WIDTH];
+    uint32_t ppui32Cover[BAND_ROWS][BAND_MAX_WIDTH / 32];
+    BandWindow_t ppsOpen[2][BAND_MAX_WIDTH / 2];
+
+    BandStats_t sStats;
+}
+BandRender_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void BandRenderInit(BandRender_t *psBand, const tDisplay *psTarget,
+                           const BandSink_t *psSink);
+extern void BandRenderFlush(BandRender_t *psBand);
+extern void BandRenderStatsPrint(BandRender_t *psBand);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BAND_RENDER_H__
@@ -0,0 +1,141 @@
+//*****************************************************************************
+//
+// boot_profile.c - A timeline of the boot, from the reset handler to the
+//                  first frame on the panel and the first sensor sample.
+//
+// The reset handler starts the DWT cycle counter before it touches memory, so
+// the counter reads the number of core cycles since reset.  BootMark() stores
+// the count and the system clock frequency under a name; BootProfilePrint()
+// turns the marks into microseconds since reset and the time spent in each
+// phase.
+//
+// The core runs from the 16 MHz PIOSC until ClockScaleInit() starts the PLL,
+// so cycles cannot be converted with a single frequency.  Each phase is
+// converted at the frequency recorded by the mark that opens it, which is
+// right as long as there is a mark on each side of a clock change.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "utils/uartstdio.h"
+#include "drivers/boot_profile.h"
+#include "drivers/clock_scale.h"
+#include "drivers/cycle_counter.h"
+
+//*****************************************************************************
+//
+// The core clock from reset until ClockScaleInit() runs.
+//
+//*****************************************************************************
+#define BOOT_RESET_HZ           16000000
+
+//*****************************************************************************
+//
+// One point on the timeline.
+//
+//*****************************************************************************
+typedef struct
+{
+    const char *pcName;
+    uint32_t ui32Cycles;
+    uint32_t ui32Hz;
+}
+tBootMark;
+
+static tBootMark g_psBootMarks[BOOT_MAX_MARKS];
+static uint32_t g_ui32BootNumMarks;
+
+//*****************************************************************************
+//
+//! Starts the boot timeline.
+//!
+//! This is called first thing in the reset handler, before the data and bss
+//! segments are set up, so it only writes registers.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BootProfileStart(void)
+{
+    CycleCounterInit();
+    HWREG(CYCLE_DWT_CYCCNT) = 0;
+}
+
+//*****************************************************************************
+//
+//! Records a point on the boot timeline.
+//!
+//! \param pcName names the point.  The string is kept, not copied, so it must
+//! be a literal.
+//!
+//! May be called from main(), from any task and with interrupts enabled or
+//! disabled.  Once BOOT_MAX_MARKS have been recorded further marks are
+//! ignored.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BootMark(const char *pcName)
+{
+    uint32_t ui32Cycles, ui32Hz;
+    bool bDisabled;
+
+    bDisabled = IntMasterDisable();
+    ui32Cycles = CycleCounterGet();
+    ui32Hz = ClockFreqGet();
+    if(ui32Hz == 0)
+    {
+        ui32Hz = BOOT_RESET_HZ;
+    }
+    if(g_ui32BootNumMarks < BOOT_MAX_MARKS)
+    {
+        g_psBootMarks[g_ui32BootNumMarks].pcName = pcName;
+        g_psBootMarks[g_ui32BootNumMarks].ui32Cycles = ui32Cycles;
+        g_psBootMarks[g_ui32BootNumMarks].ui32Hz = ui32Hz;
+        g_ui32BootNumMarks++;
+    }
+    if(!bDisabled)
+    {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Prints the boot timeline on the console.
+//!
+//! Each line gives the time of a mark since reset and the time since the mark
+//! before it, in microseconds.  Marks from different tasks are printed in the
+//! order they happened.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BootProfilePrint(void)
+{
+    uint32_t ui32Idx, ui32Num, ui32Cycles, ui32Hz, ui32Us, ui32DeltaUs;
+
+    ui32Num = g_ui32BootNumMarks;
+    ui32Cycles = 0;
+    ui32Hz = BOOT_RESET_HZ;
+    ui32Us = 0;
+
+    UARTprintf("boot: time(us)  phase(us)  mark\n");
+    for(ui32Idx = 0; ui32Idx < ui32Num; ui32Idx++)
+    {
+        ui32DeltaUs = (g_psBootMarks[ui32Idx].ui32Cycles - ui32Cycles) /
+                      (ui32Hz / 1000000);
+        ui32Us += ui32DeltaUs;
+        UARTprintf("boot: %8u  %9u  %s\n", ui32Us, ui32DeltaUs,
+                   g_psBootMarks[ui32Idx].pcName);
+
+        ui32Cycles = g_psBootMarks[ui32Idx].ui32Cycles;
+        ui32Hz = g_psBootMarks[ui32Idx].ui32Hz;
+    }
+}
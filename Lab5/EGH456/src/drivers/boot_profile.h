@@ -0,0 +1,47 @@
+//*****************************************************************************
+//
+// boot_profile.h - A timeline of the boot, from the reset handler to the
+//                  first frame on the panel and the first sensor sample.
+//
+//*****************************************************************************
+
+#ifndef __BOOT_PROFILE_H__
+#define __BOOT_PROFILE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The most marks kept.  Later marks are counted but not stored.
+//
+//*****************************************************************************
+#define BOOT_MAX_MARKS          16
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void BootProfileStart(void);
+extern void BootMark(const char *pcName);
+extern void BootProfilePrint(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BOOT_PROFILE_H__
@@ -0,0 +1,436 @@
+//*****************************************************************************
+//
+// can_isotp.c - ISO 15765-2 (ISO-TP) segmentation of messages longer than a
+//               CAN frame over the CAN transport.
+//
+// A message of up to seven bytes goes in a single frame.  Longer messages
+// start with a first frame carrying the length, after which the sender waits
+// for a flow control frame from the receiver giving the block size (how many
+// consecutive frames may be sent before the next flow control) and the
+// minimum separation time between them.  Consecutive frames carry a four bit
+// sequence number so a lost frame is detected.
+//
+// All protocol work happens in CanIsoTpPoll(), called from the task that owns
+// the link whenever its subscription is notified and at least once a tick
+// while a transfer is in progress.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "drivers/can_transport.h"
+#include "drivers/can_isotp.h"
+
+//*****************************************************************************
+//
+// Protocol control information, the high nibble of the first data byte.
+//
+//*****************************************************************************
+#define ISOTP_PCI_SF            0x00
+#define ISOTP_PCI_FF            0x10
+#define ISOTP_PCI_CF            0x20
+#define ISOTP_PCI_FC            0x30
+
+#define ISOTP_FC_CTS            0
+#define ISOTP_FC_WAIT           1
+#define ISOTP_FC_OVFLW          2
+
+//*****************************************************************************
+//
+// Sender states.
+//
+//*****************************************************************************
+#define ISOTP_TX_IDLE           0
+#define ISOTP_TX_WAIT_FC        1
+#define ISOTP_TX_SENDING        2
+
+//*****************************************************************************
+//
+// Converts a received STmin value to ticks.  Values below one millisecond
+// (0xf1 to 0xf9) are rounded up to one tick; reserved values are treated as
+// the maximum, as the standard requires.
+//
+//*****************************************************************************
+static TickType_t
+prvStMinTicks(uint8_t ui8StMin)
+{
+    if(ui8StMin == 0)
+    {
+        return(0);
+    }
+    if(ui8StMin <= 0x7f)
+    {
+        return(pdMS_TO_TICKS(ui8StMin) ? pdMS_TO_TICKS(ui8StMin) : 1);
+    }
+    if((ui8StMin >= 0xf1) && (ui8StMin <= 0xf9))
+    {
+        return(1);
+    }
+    return(pdMS_TO_TICKS(0x7f));
+}
+
+//*****************************************************************************
+//
+// Sends a flow control frame.
+//
+//*****************************************************************************
+static void
+prvSendFlowControl(CanIsoTpLink_t *psLink, uint8_t ui8Status)
+{
+    CanFrame_t sFrame;
+
+    sFrame.ui32Id = psLink->ui32TxId;
+    sFrame.ui8Len = 3;
+    sFrame.pui8Data[0] = ISOTP_PCI_FC | ui8Status;
+    sFrame.pui8Data[1] = psLink->ui8BlockSize;
+    sFrame.pui8Data[2] = psLink->ui8StMin;
+    if(!CanSend(psLink->psNode, &sFrame))
+    {
+        psLink->ui32Errors++;
+    }
+}
+
+//*****************************************************************************
+//
+// Handles one received frame.
+//
+//*****************************************************************************
+static void
+prvReceive(CanIsoTpLink_t *psLink, const CanFrame_t *psFrame)
+{
+    const uint8_t *pui8Data = psFrame->pui8Data;
+    uint32_t ui32Len, ui32Copy;
+
+    if(psFrame->ui8Len == 0)
+    {
+        return;
+    }
+
+    switch(pui8Data[0] & 0xf0)
+    {
+        case ISOTP_PCI_SF:
+        {
+            ui32Len = pui8Data[0] & 0x0f;
+            if((ui32Len == 0) || (ui32Len >= psFrame->ui8Len) ||
+               (ui32Len > psLink->ui32RxSize))
+            {
+                psLink->ui32Errors++;
+                return;
+            }
+            psLink->ui8RxActive = 0;
+            memcpy(psLink->pui8RxBuf, pui8Data + 1, ui32Len);
+            psLink->pfnRx(psLink->pui8RxBuf, ui32Len, psLink->pvArg);
+            break;
+        }
+
+        case ISOTP_PCI_FF:
+        {
+            //
+            // A new first frame abandons any message being reassembled.
+            //
+            ui32Len = ((pui8Data[0] & 0x0f) << 8) | pui8Data[1];
+            if((psFrame->ui8Len != 8) || (ui32Len < 8))
+            {
+                psLink->ui32Errors++;
+                return;
+            }
+            if(ui32Len > psLink->ui32RxSize)
+            {
+                psLink->ui8RxActive = 0;
+                prvSendFlowControl(psLink, ISOTP_FC_OVFLW);
+                return;
+            }
+
+            memcpy(psLink->pui8RxBuf, pui8Data + 2, 6);
+            psLink->ui32RxLen = ui32Len;
+            psLink->ui32RxPos = 6;
+            psLink->ui8RxSeq = 1;
+            psLink->ui8RxBlockLeft = psLink->ui8BlockSize;
+            psLink->ui8RxActive = 1;
+            psLink->xRxLast = xTaskGetTickCount();
+            prvSendFlowControl(psLink, ISOTP_FC_CTS);
+            break;
+        }
+
+        case ISOTP_PCI_CF:
+        {
+            if(!psLink->ui8RxActive)
+            {
+                return;
+            }
+            if((pui8Data[0] & 0x0f) != psLink->ui8RxSeq)
+            {
+                psLink->ui8RxActive = 0;
+                psLink->ui32Errors++;
+                return;
+            }
+
+            ui32Copy = psLink->ui32RxLen - psLink->ui32RxPos;
+            if(ui32Copy > 7)
+            {
+                ui32Copy = 7;
+            }
+            if(ui32Copy > (uint32_t)(psFrame->ui8Len - 1))
+            {
+                psLink->ui8RxActive = 0;
+                psLink->ui32Errors++;
+                return;
+            }
+            memcpy(psLink->pui8RxBuf + psLink->ui32RxPos, pui8Data + 1,
+                   ui32Copy);
+            psLink->ui32RxPos += ui32Copy;
+            psLink->ui8RxSeq = (psLink->ui8RxSeq + 1) & 0x0f;
+            psLink->xRxLast = xTaskGetTickCount();
+
+            if(psLink->ui32RxPos == psLink->ui32RxLen)
+            {
+                psLink->ui8RxActive = 0;
+                psLink->pfnRx(psLink->pui8RxBuf, psLink->ui32RxLen,
+                              psLink->pvArg);
+            }
+            else if(psLink->ui8BlockSize && (--psLink->ui8RxBlockLeft == 0))
+            {
+                psLink->ui8RxBlockLeft = psLink->ui8BlockSize;
+                prvSendFlowControl(psLink, ISOTP_FC_CTS);
+            }
+            break;
+        }
+
+        case ISOTP_PCI_FC:
+        {
+            if((psLink->ui8TxState != ISOTP_TX_WAIT_FC) ||
+               (psFrame->ui8Len < 3))
+            {
+                return;
+            }
+
+            switch(pui8Data[0] & 0x0f)
+            {
+                case ISOTP_FC_CTS:
+                {
+                    psLink->ui8TxBlockLeft = pui8Data[1];
+                    psLink->xTxStMin = prvStMinTicks(pui8Data[2]);
+                    psLink->xTxLast = xTaskGetTickCount() - psLink->xTxStMin;
+                    psLink->ui8TxState = ISOTP_TX_SENDING;
+                    break;
+                }
+
+                case ISOTP_FC_WAIT:
+                {
+                    psLink->xTxLast = xTaskGetTickCount();
+                    break;
+                }
+
+                default:
+                {
+                    psLink->ui8TxState = ISOTP_TX_IDLE;
+                    psLink->ui32Errors++;
+                    break;
+                }
+            }
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Sends as many consecutive frames as flow control and the transmit queue
+// allow.
+//
+//*****************************************************************************
+static void
+prvTransmit(CanIsoTpLink_t *psLink)
+{
+    CanFrame_t sFrame;
+    TickType_t xNow;
+    uint32_t ui32Copy;
+
+    while(psLink->ui8TxState == ISOTP_TX_SENDING)
+    {
+        xNow = xTaskGetTickCount();
+        if(psLink->xTxStMin && ((xNow - psLink->xTxLast) < psLink->xTxStMin))
+        {
+            return;
+        }
+
+        ui32Copy = psLink->ui32TxLen - psLink->ui32TxPos;
+        if(ui32Copy > 7)
+        {
+            ui32Copy = 7;
+        }
+        sFrame.ui32Id = psLink->ui32TxId;
+        sFrame.ui8Len = ui32Copy + 1;
+        sFrame.pui8Data[0] = ISOTP_PCI_CF | psLink->ui8TxSeq;
+        memcpy(sFrame.pui8Data + 1, psLink->pui8TxData + psLink->ui32TxPos,
+               ui32Copy);
+        if(!CanSend(psLink->psNode, &sFrame))
+        {
+            return;
+        }
+
+        psLink->ui32TxPos += ui32Copy;
+        psLink->ui8TxSeq = (psLink->ui8TxSeq + 1) & 0x0f;
+        psLink->xTxLast = xNow;
+
+        if(psLink->ui32TxPos == psLink->ui32TxLen)
+        {
+            psLink->ui8TxState = ISOTP_TX_IDLE;
+        }
+        else if(psLink->ui8TxBlockLeft && (--psLink->ui8TxBlockLeft == 0))
+        {
+            psLink->ui8TxState = ISOTP_TX_WAIT_FC;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Sets up one end of an ISO-TP link.
+//!
+//! \param psLink is the link.
+//! \param psNode is the node the link runs on.
+//! \param ui32TxId is the identifier the link sends with.
+//! \param ui32RxId is the identifier the link receives on.
+//! \param pui8RxBuf is the buffer messages are reassembled in.
+//! \param ui32RxSize is the size of pui8RxBuf; longer messages are refused.
+//! \param pfnRx is called from CanIsoTpPoll() with each complete message.
+//! \param pvArg is passed to pfnRx.
+//! \param xNotify is the task that calls CanIsoTpPoll(), notified when a
+//! frame arrives.
+//!
+//! The link advertises a block size of 8 and no separation time; change
+//! ui8BlockSize and ui8StMin after this call for slower receivers.
+//!
+//! \return Returns \b false if the node has no receive objects left.
+//
+//*****************************************************************************
+bool
+CanIsoTpInit(CanIsoTpLink_t *psLink, CanNode_t *psNode, uint32_t ui32TxId,
+             uint32_t ui32RxId, uint8_t *pui8RxBuf, uint32_t ui32RxSize,
+             void (*pfnRx)(const uint8_t *pui8Data, uint32_t ui32Len,
+                           void *pvArg),
+             void *pvArg, TaskHandle_t xNotify)
+{
+    memset(psLink, 0, sizeof(*psLink));
+    psLink->psNode = psNode;
+    psLink->ui32TxId = ui32TxId;
+    psLink->pui8RxBuf = pui8RxBuf;
+    psLink->ui32RxSize = ui32RxSize;
+    psLink->pfnRx = pfnRx;
+    psLink->pvArg = pvArg;
+    psLink->ui8BlockSize = 8;
+    psLink->ui8StMin = 0;
+
+    psLink->i32Sub = CanSubscribe(psNode, ui32RxId, ui32RxId, xNotify);
+
+    return(psLink->i32Sub >= 0);
+}
+
+//*****************************************************************************
+//
+//! Starts sending a message.
+//!
+//! \param psLink is the link.
+//! \param pui8Data is the message.  It is not copied and must stay valid
+//! until CanIsoTpBusy() returns \b false.
+//! \param ui32Len is the message length, 1 to CAN_ISOTP_MAX_LEN bytes.
+//!
+//! \return Returns \b false if a message is already being sent, the length
+//! is out of range or the transmit queue is full.
+//
+//*****************************************************************************
+bool
+CanIsoTpSend(CanIsoTpLink_t *psLink, const uint8_t *pui8Data, uint32_t ui32Len)
+{
+    CanFrame_t sFrame;
+
+    if((psLink->ui8TxState != ISOTP_TX_IDLE) || (ui32Len == 0) ||
+       (ui32Len > CAN_ISOTP_MAX_LEN))
+    {
+        return(false);
+    }
+
+    sFrame.ui32Id = psLink->ui32TxId;
+    if(ui32Len <= 7)
+    {
+        sFrame.ui8Len = ui32Len + 1;
+        sFrame.pui8Data[0] = ISOTP_PCI_SF | ui32Len;
+        memcpy(sFrame.pui8Data + 1, pui8Data, ui32Len);
+        return(CanSend(psLink->psNode, &sFrame));
+    }
+
+    sFrame.ui8Len = 8;
+    sFrame.pui8Data[0] = ISOTP_PCI_FF | (ui32Len >> 8);
+    sFrame.pui8Data[1] = ui32Len & 0xff;
+    memcpy(sFrame.pui8Data + 2, pui8Data, 6);
+    if(!CanSend(psLink->psNode, &sFrame))
+    {
+        return(false);
+    }
+
+    psLink->pui8TxData = pui8Data;
+    psLink->ui32TxLen = ui32Len;
+    psLink->ui32TxPos = 6;
+    psLink->ui8TxSeq = 1;
+    psLink->xTxLast = xTaskGetTickCount();
+    psLink->ui8TxState = ISOTP_TX_WAIT_FC;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Returns \b true while a message is being sent.
+//
+//*****************************************************************************
+bool
+CanIsoTpBusy(const CanIsoTpLink_t *psLink)
+{
+    return(psLink->ui8TxState != ISOTP_TX_IDLE);
+}
+
+//*****************************************************************************
+//
+//! Processes received frames, sends pending consecutive frames and checks
+//! for timeouts.
+//!
+//! \param psLink is the link.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+CanIsoTpPoll(CanIsoTpLink_t *psLink)
+{
+    CanFrame_t sFrame;
+    TickType_t xNow;
+
+    while(CanRead(psLink->psNode, psLink->i32Sub, &sFrame))
+    {
+        prvReceive(psLink, &sFrame);
+    }
+
+    prvTransmit(psLink);
+
+    xNow = xTaskGetTickCount();
+    if((psLink->ui8TxState == ISOTP_TX_WAIT_FC) &&
+       ((xNow - psLink->xTxLast) > CAN_ISOTP_TIMEOUT))
+    {
+        psLink->ui8TxState = ISOTP_TX_IDLE;
+        psLink->ui32Errors++;
+    }
+    if(psLink->ui8RxActive && ((xNow - psLink->xRxLast) > CAN_ISOTP_TIMEOUT))
+    {
+        psLink->ui8RxActive = 0;
+        psLink->ui32Errors++;
+    }
+}
@@ -0,0 +1,111 @@
+//*****************************************************************************
+//
+// can_isotp.h - ISO 15765-2 (ISO-TP) segmentation of messages longer than a
+//               CAN frame over the CAN transport.
+//
+//*****************************************************************************
+
+#ifndef __CAN_ISOTP_H__
+#define __CAN_ISOTP_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The longest message a first frame can announce.
+//
+//*****************************************************************************
+#define CAN_ISOTP_MAX_LEN       4095
+
+//*****************************************************************************
+//
+// How long, in ticks, a sender waits for flow control and a receiver waits
+// for the next consecutive frame before giving up (N_Bs and N_Cr).
+//
+//*****************************************************************************
+#define CAN_ISOTP_TIMEOUT       pdMS_TO_TICKS(1000)
+
+//*****************************************************************************
+//
+// One end of a point to point ISO-TP link.  Frames are sent with ui32TxId
+// and received on ui32RxId.
+//
+//*****************************************************************************
+typedef struct
+{
+    CanNode_t *psNode;
+    uint32_t ui32TxId;
+    int32_t i32Sub;
+
+    //
+    // Flow control parameters advertised to the peer.
+    //
+    uint8_t ui8BlockSize;
+    uint8_t ui8StMin;
+
+    //
+    // Sender state.
+    //
+    const uint8_t *pui8TxData;
+    uint32_t ui32TxLen;
+    uint32_t ui32TxPos;
+    uint8_t ui8TxState;
+    uint8_t ui8TxSeq;
+    uint8_t ui8TxBlockLeft;
+    TickType_t xTxStMin;
+    TickType_t xTxLast;
+
+    //
+    // Receiver state.
+    //
+    uint8_t *pui8RxBuf;
+    uint32_t ui32RxSize;
+    uint32_t ui32RxLen;
+    uint32_t ui32RxPos;
+    uint8_t ui8RxActive;
+    uint8_t ui8RxSeq;
+    uint8_t ui8RxBlockLeft;
+    TickType_t xRxLast;
+
+    void (*pfnRx)(const uint8_t *pui8Data, uint32_t ui32Len, void *pvArg);
+    void *pvArg;
+
+    uint32_t ui32Errors;
+}
+CanIsoTpLink_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern bool CanIsoTpInit(CanIsoTpLink_t *psLink, CanNode_t *psNode,
+                         uint32_t ui32TxId, uint32_t ui32RxId,
+                         uint8_t *pui8RxBuf, uint32_t ui32RxSize,
+                         void (*pfnRx)(const uint8_t *pui8Data,
+                                       uint32_t ui32Len, void *pvArg),
+                         void *pvArg, TaskHandle_t xNotify);
+extern bool CanIsoTpSend(CanIsoTpLink_t *psLink, const uint8_t *pui8Data,
+                         uint32_t ui32Len);
+extern bool CanIsoTpBusy(const CanIsoTpLink_t *psLink);
+extern void CanIsoTpPoll(CanIsoTpLink_t *psLink);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CAN_ISOTP_H__
@@ -0,0 +1,579 @@
+//*****************************************************************************
+//
+// can_transport.c - CAN frame transport with hardware acceptance filtering,
+//                   a prioritised transmit queue and per-subscription
+//                   receive rings.
+//
+// A subscription to an identifier range is turned into the smallest set of
+// identifier/mask pairs that covers the range exactly, and each pair is
+// programmed into its own receive message object.  Frames outside every
+// subscription are rejected by the controller and never interrupt the CPU.
+// A received frame is copied by the interrupt handler into the ring of the
+// subscription that owns the object, and the subscriber is notified.
+//
+// Frames to send are held in a heap ordered by identifier, the same order
+// the bus arbitrates in.  Whenever a transmit object frees up it is loaded
+// from the top of the heap, so the hardware holds the most urgent frames and
+// a queued high priority frame never waits behind a backlog of low priority
+// ones.
+//
+// The transport talks to the controller through a CanBackend_t, so the same
+// node code runs on the CAN1 peripheral or on the virtual bus in
+// can_vbus.c.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "inc/hw_can.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/can.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sysctl.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "drivers/cycle_counter.h"
+#include "drivers/can_transport.h"
+
+//*****************************************************************************
+//
+// Marks a receive object that belongs to no subscription.
+//
+//*****************************************************************************
+#define CAN_OBJ_UNUSED          0xff
+
+//*****************************************************************************
+//
+// Returns true if transmit entry psA must go on the bus before psB.
+//
+//*****************************************************************************
+static bool
+prvTxBefore(const CanTxEntry_t *psA, const CanTxEntry_t *psB)
+{
+    if(psA->sFrame.ui32Id != psB->sFrame.ui32Id)
+    {
+        return(psA->sFrame.ui32Id < psB->sFrame.ui32Id);
+    }
+    return((int32_t)(psA->ui32Seq - psB->ui32Seq) < 0);
+}
+
+//*****************************************************************************
+//
+// Removes the most urgent entry from the transmit heap.  The heap must not be
+// empty.
+//
+//*****************************************************************************
+static void
+prvTxPop(CanNode_t *psNode, CanTxEntry_t *psEntry)
+{
+    CanTxEntry_t *psHeap = psNode->psTxHeap;
+    CanTxEntry_t sLast;
+    uint32_t ui32Idx = 0, ui32Child;
+
+    *psEntry = psHeap[0];
+    sLast = psHeap[--psNode->ui32TxCount];
+
+    for(;;)
+    {
+        ui32Child = 2 * ui32Idx + 1;
+        if(ui32Child >= psNode->ui32TxCount)
+        {
+            break;
+        }
+        if(((ui32Child + 1) < psNode->ui32TxCount) &&
+           prvTxBefore(&psHeap[ui32Child + 1], &psHeap[ui32Child]))
+        {
+            ui32Child++;
+        }
+        if(!prvTxBefore(&psHeap[ui32Child], &sLast))
+        {
+            break;
+        }
+        psHeap[ui32Idx] = psHeap[ui32Child];
+        ui32Idx = ui32Child;
+    }
+    psHeap[ui32Idx] = sLast;
+}
+
+//*****************************************************************************
+//
+// Loads free transmit objects from the heap.  Called with interrupts masked.
+//
+// The controller sends the lowest numbered pending object first, whatever
+// its identifier, so a frame may only go into a free object if every
+// pending object below it holds a more urgent frame and every pending object
+// above it a less urgent one.  Otherwise the frame waits in the heap until
+// enough objects drain; this keeps frames of equal identifier, such as ISO-TP
+// consecutive frames, in order.
+//
+// Object 1 is tried last.  A stream of frames therefore fills objects 2 and
+// up, and object 1 stays free for a more urgent frame queued behind it,
+// which would otherwise wait for the whole stream to drain.
+//
+//*****************************************************************************
+static void
+prvTxKick(CanNode_t *psNode)
+{
+    CanTxEntry_t sEntry;
+    uint32_t ui32Try, ui32Obj, ui32Other;
+    bool bFits;
+
+    while(psNode->ui32TxCount)
+    {
+        for(ui32Try = 0; ui32Try < CAN_TX_OBJECTS; ui32Try++)
+        {
+            ui32Obj = (ui32Try + 1) % CAN_TX_OBJECTS;
+            if(psNode->ui32TxBusy & (1UL << ui32Obj))
+            {
+                continue;
+            }
+
+            bFits = true;
+            for(ui32Other = 0; ui32Other < CAN_TX_OBJECTS; ui32Other++)
+            {
+                if((psNode->ui32TxBusy & (1UL << ui32Other)) == 0)
+                {
+                    continue;
+                }
+                if((ui32Other < ui32Obj) ?
+                   !prvTxBefore(&psNode->psTxObj[ui32Other],
+                                &psNode->psTxHeap[0]) :
+                   !prvTxBefore(&psNode->psTxHeap[0],
+                                &psNode->psTxObj[ui32Other]))
+                {
+                    bFits = false;
+                    break;
+                }
+            }
+            if(bFits)
+            {
+                break;
+            }
+        }
+        if(ui32Try == CAN_TX_OBJECTS)
+        {
+            return;
+        }
+
+        prvTxPop(psNode, &sEntry);
+        psNode->psTxObj[ui32Obj] = sEntry;
+        psNode->ui32TxBusy |= 1UL << ui32Obj;
+        psNode->sBackend.pfnTxLoad(psNode->sBackend.pvHw, ui32Obj + 1,
+                                   &sEntry.sFrame);
+    }
+}
+
+//*****************************************************************************
+//
+//! Initialises a node.
+//!
+//! \param psNode is the node to initialise.
+//! \param psBackend is the controller the node uses; it is copied.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+CanNodeInit(CanNode_t *psNode, const CanBackend_t *psBackend)
+{
+    memset(psNode, 0, sizeof(*psNode));
+    psNode->sBackend = *psBackend;
+    memset(psNode->pui8ObjSub, CAN_OBJ_UNUSED, sizeof(psNode->pui8ObjSub));
+    psNode->ui32NextObj = CAN_FIRST_RX_OBJECT;
+}
+
+//*****************************************************************************
+//
+//! Subscribes to a range of identifiers.
+//!
+//! \param psNode is the node.
+//! \param ui32IdLow is the first identifier of the range.
+//! \param ui32IdHigh is the last identifier of the range.
+//! \param xNotify is a task to notify, with xTaskNotifyGive(), for every frame
+//! received, or NULL.
+//!
+//! The range is covered by as few receive objects as possible; a range that
+//! starts and ends on a power of two boundary takes one.  Must be called
+//! before frames in the range are expected, from a single task.
+//!
+//! \return Returns the subscription handle for CanRead(), or -1 if there are
+//! not enough receive objects or subscriptions left.
+//
+//*****************************************************************************
+int32_t
+CanSubscribe(CanNode_t *psNode, uint32_t ui32IdLow, uint32_t ui32IdHigh,
+             TaskHandle_t xNotify)
+{
+    uint32_t ui32Id, ui32Size, ui32Needed, ui32Pass;
+    int32_t i32Sub;
+
+    if((ui32IdLow > ui32IdHigh) || (ui32IdHigh > CAN_ID_MASK) ||
+       (psNode->ui32NumSubs == CAN_MAX_SUBS))
+    {
+        return(-1);
+    }
+
+    //
+    // The first pass counts the objects needed, the second programs them, so
+    // a subscription that does not fit takes nothing.
+    //
+    for(ui32Pass = 0; ui32Pass < 2; ui32Pass++)
+    {
+        ui32Needed = 0;
+        for(ui32Id = ui32IdLow; ui32Id <= ui32IdHigh; ui32Id += ui32Size)
+        {
+            //
+            // The largest aligned block starting here that stays in range.
+            //
+            ui32Size = 1;
+            while(((ui32Id & (ui32Size * 2 - 1)) == 0) &&
+                  ((ui32Id + ui32Size * 2 - 1) <= ui32IdHigh) &&
+                  (ui32Size * 2 <= (CAN_ID_MASK + 1)))
+            {
+                ui32Size *= 2;
+            }
+
+            if(ui32Pass)
+            {
+                uint32_t ui32Obj = psNode->ui32NextObj++;
+
+                psNode->pui8ObjSub[ui32Obj] = psNode->ui32NumSubs;
+                psNode->sBackend.pfnFilterSet(psNode->sBackend.pvHw, ui32Obj,
+                                              ui32Id,
+                                              CAN_ID_MASK & ~(ui32Size - 1));
+            }
+            ui32Needed++;
+        }
+
+        if((ui32Pass == 0) &&
+           ((psNode->ui32NextObj + ui32Needed) > (CAN_NUM_OBJECTS + 1)))
+        {
+            return(-1);
+        }
+    }
+
+    i32Sub = psNode->ui32NumSubs;
+    psNode->psSubs[i32Sub].ui32IdLow = ui32IdLow;
+    psNode->psSubs[i32Sub].ui32IdHigh = ui32IdHigh;
+    psNode->psSubs[i32Sub].xNotify = xNotify;
+    psNode->ui32NumSubs++;
+
+    return(i32Sub);
+}
+
+//*****************************************************************************
+//
+//! Queues a frame for transmission.
+//!
+//! \param psNode is the node.
+//! \param psFrame is the frame; it is copied.
+//!
+//! \return Returns \b false if the transmit queue is full.
+//
+//*****************************************************************************
+bool
+CanSend(CanNode_t *psNode, const CanFrame_t *psFrame)
+{
+    CanTxEntry_t *psHeap = psNode->psTxHeap;
+    CanTxEntry_t sEntry;
+    uint32_t ui32Idx, ui32Parent;
+
+    sEntry.sFrame = *psFrame;
+    sEntry.sFrame.ui32Id &= CAN_ID_MASK;
+    sEntry.sFrame.ui32Time = psNode->sBackend.pfnTimeGet(psNode->sBackend.pvHw);
+
+    taskENTER_CRITICAL();
+    if(psNode->ui32TxCount == CAN_TX_QUEUE_SIZE)
+    {
+        taskEXIT_CRITICAL();
+        return(false);
+    }
+
+    sEntry.ui32Seq = psNode->ui32TxSeq++;
+    for(ui32Idx = psNode->ui32TxCount++; ui32Idx; ui32Idx = ui32Parent)
+    {
+        ui32Parent = (ui32Idx - 1) / 2;
+        if(!prvTxBefore(&sEntry, &psHeap[ui32Parent]))
+        {
+            break;
+        }
+        psHeap[ui32Idx] = psHeap[ui32Parent];
+    }
+    psHeap[ui32Idx] = sEntry;
+
+    prvTxKick(psNode);
+    taskEXIT_CRITICAL();
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Takes the oldest frame from a subscription's receive ring.
+//!
+//! \param psNode is the node.
+//! \param i32Sub is the handle returned by CanSubscribe().
+//! \param psFrame receives the frame.
+//!
+//! Only one task may read a given subscription.
+//!
+//! \return Returns \b false if the ring is empty.
+//
+//*****************************************************************************
+bool
+CanRead(CanNode_t *psNode, int32_t i32Sub, CanFrame_t *psFrame)
+{
+    CanRxRing_t *psRing = &psNode->psSubs[i32Sub];
+    uint32_t ui32Tail = psRing->ui32Tail;
+
+    if(ui32Tail == psRing->ui32Head)
+    {
+        return(false);
+    }
+
+    *psFrame = psRing->psFrames[ui32Tail & (CAN_RX_RING_SIZE - 1)];
+    psRing->ui32Tail = ui32Tail + 1;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Hands a received frame to the node.  Called by backends from their
+//! interrupt handler.
+//!
+//! \param psNode is the node.
+//! \param ui32Obj is the receive object that accepted the frame.
+//! \param psFrame is the frame.
+//! \param pxHigherPriorityTaskWoken is set if a subscriber was woken.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+CanNodeRxFromISR(CanNode_t *psNode, uint32_t ui32Obj, const CanFrame_t *psFrame,
+                 BaseType_t *pxHigherPriorityTaskWoken)
+{
+    CanRxRing_t *psRing;
+    uint32_t ui32Head;
+
+    if((ui32Obj > CAN_NUM_OBJECTS) ||
+       (psNode->pui8ObjSub[ui32Obj] == CAN_OBJ_UNUSED))
+    {
+        return;
+    }
+
+    psRing = &psNode->psSubs[psNode->pui8ObjSub[ui32Obj]];
+    ui32Head = psRing->ui32Head;
+    if((ui32Head - psRing->ui32Tail) == CAN_RX_RING_SIZE)
+    {
+        psRing->ui32Dropped++;
+        return;
+    }
+
+    psRing->psFrames[ui32Head & (CAN_RX_RING_SIZE - 1)] = *psFrame;
+    psRing->ui32Head = ui32Head + 1;
+    psNode->ui32RxFrames++;
+
+    if(psRing->xNotify)
+    {
+        vTaskNotifyGiveFromISR(psRing->xNotify, pxHigherPriorityTaskWoken);
+    }
+}
+
+//*****************************************************************************
+//
+//! Tells the node that a transmit object has sent its frame.  Called by
+//! backends from their interrupt handler.
+//!
+//! \param psNode is the node.
+//! \param ui32Obj is the transmit object.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+CanNodeTxDoneFromISR(CanNode_t *psNode, uint32_t ui32Obj)
+{
+    UBaseType_t uxSaved;
+
+    uxSaved = taskENTER_CRITICAL_FROM_ISR();
+    psNode->ui32TxBusy &= ~(1UL << (ui32Obj - 1));
+    psNode->ui32TxFrames++;
+    prvTxKick(psNode);
+    taskEXIT_CRITICAL_FROM_ISR(uxSaved);
+}
+
+//*****************************************************************************
+//
+// The CAN1 backend.  CAN1 is brought out on PB0 (RX) and PB1 (TX).
+//
+//*****************************************************************************
+#define CAN_HW_BASE             CAN1_BASE
+#define CAN_HW_INT              INT_CAN1
+
+static CanNode_t *g_psCanHwNode = NULL;
+
+//
+// Controller status errors seen by the interrupt handler.
+//
+volatile uint32_t g_ui32CanHwErrors = 0;
+
+static void
+prvHwFilterSet(void *pvHw, uint32_t ui32Obj, uint32_t ui32Id,
+               uint32_t ui32Mask)
+{
+    tCANMsgObject sMsg;
+    uint8_t pui8Data[8];
+
+    (void)pvHw;
+
+    sMsg.ui32MsgID = ui32Id;
+    sMsg.ui32MsgIDMask = ui32Mask;
+    sMsg.ui32Flags = MSG_OBJ_RX_INT_ENABLE | MSG_OBJ_USE_ID_FILTER;
+    sMsg.ui32MsgLen = sizeof(pui8Data);
+    sMsg.pui8MsgData = pui8Data;
+    CANMessageSet(CAN_HW_BASE, ui32Obj, &sMsg, MSG_OBJ_TYPE_RX);
+}
+
+static void
+prvHwTxLoad(void *pvHw, uint32_t ui32Obj, const CanFrame_t *psFrame)
+{
+    tCANMsgObject sMsg;
+    uint8_t pui8Data[8];
+
+    (void)pvHw;
+
+    memcpy(pui8Data, psFrame->pui8Data, sizeof(pui8Data));
+    sMsg.ui32MsgID = psFrame->ui32Id;
+    sMsg.ui32MsgIDMask = 0;
+    sMsg.ui32Flags = MSG_OBJ_TX_INT_ENABLE;
+    sMsg.ui32MsgLen = psFrame->ui8Len;
+    sMsg.pui8MsgData = pui8Data;
+    CANMessageSet(CAN_HW_BASE, ui32Obj, &sMsg, MSG_OBJ_TYPE_TX);
+}
+
+static uint32_t
+prvHwTimeGet(void *pvHw)
+{
+    (void)pvHw;
+
+    return(CycleCounterGet());
+}
+
+//*****************************************************************************
+//
+//! Sets up CAN1 and attaches a node to it.
+//!
+//! \param psNode is the node to run on CAN1.
+//! \param ui32SysClock is the system clock frequency.
+//! \param ui32BitRate is the bus bit rate.
+//!
+//! Time stamps are in core clock cycles.  Real frames do not carry the
+//! sender's time stamp, so received frames are stamped on reception.
+//!
+//! \return Returns \b false if the bit rate cannot be reached.
+//
+//*****************************************************************************
+bool
+CanHwInit(CanNode_t *psNode, uint32_t ui32SysClock, uint32_t ui32BitRate)
+{
+    CanBackend_t sBackend;
+
+    sBackend.pfnFilterSet = prvHwFilterSet;
+    sBackend.pfnTxLoad = prvHwTxLoad;
+    sBackend.pfnTimeGet = prvHwTimeGet;
+    sBackend.pvHw = NULL;
+    CanNodeInit(psNode, &sBackend);
+    g_psCanHwNode = psNode;
+
+    CycleCounterInit();
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_CAN1);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_CAN1))
+    {
+    }
+
+    GPIOPinConfigure(GPIO_PB0_CAN1RX);
+    GPIOPinConfigure(GPIO_PB1_CAN1TX);
+    GPIOPinTypeCAN(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+
+    CANInit(CAN_HW_BASE);
+    if(CANBitRateSet(CAN_HW_BASE, ui32SysClock, ui32BitRate) == 0)
+    {
+        return(false);
+    }
+
+    CANIntRegister(CAN_HW_BASE, CAN1IntHandler);
+    CANIntEnable(CAN_HW_BASE, CAN_INT_MASTER | CAN_INT_ERROR | CAN_INT_STATUS);
+    IntPrioritySet(CAN_HW_INT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    IntEnable(CAN_HW_INT);
+    CANEnable(CAN_HW_BASE);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// The CAN1 interrupt handler.  Services every pending object before
+// returning.
+//
+//*****************************************************************************
+void
+CAN1IntHandler(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    tCANMsgObject sMsg;
+    CanFrame_t sFrame;
+    uint32_t ui32Cause, ui32Status;
+
+    while((ui32Cause = CANIntStatus(CAN_HW_BASE, CAN_INT_STS_CAUSE)) != 0)
+    {
+        if(ui32Cause == CAN_INT_INTID_STATUS)
+        {
+            //
+            // Reading the status register clears the interrupt.  Restart the
+            // controller after bus-off; it rejoins once the bus is idle.
+            //
+            ui32Status = CANStatusGet(CAN_HW_BASE, CAN_STS_CONTROL);
+            if(ui32Status & (CAN_STATUS_BUS_OFF | CAN_STATUS_EPASS |
+                             CAN_STATUS_LEC_MSK))
+            {
+                g_ui32CanHwErrors++;
+            }
+            if(ui32Status & CAN_STATUS_BUS_OFF)
+            {
+                CANEnable(CAN_HW_BASE);
+            }
+        }
+        else if(ui32Cause <= CAN_TX_OBJECTS)
+        {
+            CANIntClear(CAN_HW_BASE, ui32Cause);
+            CanNodeTxDoneFromISR(g_psCanHwNode, ui32Cause);
+        }
+        else
+        {
+            sMsg.pui8MsgData = sFrame.pui8Data;
+            CANMessageGet(CAN_HW_BASE, ui32Cause, &sMsg, true);
+
+            sFrame.ui32Id = sMsg.ui32MsgID;
+            sFrame.ui8Len = sMsg.ui32MsgLen;
+            sFrame.ui32Time = CycleCounterGet();
+            if(sMsg.ui32Flags & MSG_OBJ_DATA_LOST)
+            {
+                g_ui32CanHwErrors++;
+            }
+
+            CanNodeRxFromISR(g_psCanHwNode, ui32Cause, &sFrame,
+                             &xHigherPriorityTaskWoken);
+        }
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
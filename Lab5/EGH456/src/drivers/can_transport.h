@@ -0,0 +1,175 @@
+//*****************************************************************************
+//
+// can_transport.h - CAN frame transport with hardware acceptance filtering,
+//                   a prioritised transmit queue and per-subscription
+//                   receive rings.
+//
+//*****************************************************************************
+
+#ifndef __CAN_TRANSPORT_H__
+#define __CAN_TRANSPORT_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Message object allocation.  Objects are numbered from 1.  The controller
+// transmits from the lowest numbered pending object first, so the transmit
+// objects come first and the rest are used as receive filters.
+//
+//*****************************************************************************
+#define CAN_NUM_OBJECTS         32
+#define CAN_TX_OBJECTS          4
+#define CAN_FIRST_RX_OBJECT     (CAN_TX_OBJECTS + 1)
+
+//*****************************************************************************
+//
+// Sizes of the software queues.  CAN_RX_RING_SIZE must be a power of two.
+//
+//*****************************************************************************
+#define CAN_MAX_SUBS            8
+#define CAN_RX_RING_SIZE        16
+#define CAN_TX_QUEUE_SIZE       32
+
+//*****************************************************************************
+//
+// Standard (11-bit) identifiers only.
+//
+//*****************************************************************************
+#define CAN_ID_MASK             0x7ff
+
+//*****************************************************************************
+//
+// A CAN frame.  ui32Time is the backend time at which the frame was queued
+// for transmission; it is carried to the receiver for latency measurements.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Id;
+    uint8_t ui8Len;
+    uint8_t pui8Data[8];
+    uint32_t ui32Time;
+}
+CanFrame_t;
+
+//*****************************************************************************
+//
+// A single-producer, single-consumer receive ring for one subscription.  The
+// interrupt handler writes ui32Head and the reading task writes ui32Tail, so
+// no locking is needed.
+//
+//*****************************************************************************
+typedef struct
+{
+    CanFrame_t psFrames[CAN_RX_RING_SIZE];
+    volatile uint32_t ui32Head;
+    volatile uint32_t ui32Tail;
+    uint32_t ui32Dropped;
+    uint32_t ui32IdLow;
+    uint32_t ui32IdHigh;
+    TaskHandle_t xNotify;
+}
+CanRxRing_t;
+
+//*****************************************************************************
+//
+// The operations a controller provides to the transport.  pfnFilterSet
+// programs a receive object; pfnTxLoad loads a transmit object and requests
+// transmission; pfnTimeGet returns a free running time stamp.
+//
+//*****************************************************************************
+typedef struct
+{
+    void (*pfnFilterSet)(void *pvHw, uint32_t ui32Obj, uint32_t ui32Id,
+                         uint32_t ui32Mask);
+    void (*pfnTxLoad)(void *pvHw, uint32_t ui32Obj, const CanFrame_t *psFrame);
+    uint32_t (*pfnTimeGet)(void *pvHw);
+    void *pvHw;
+}
+CanBackend_t;
+
+//*****************************************************************************
+//
+// An entry of the transmit queue.  ui32Seq keeps frames with equal
+// identifiers in the order they were sent.
+//
+//*****************************************************************************
+typedef struct
+{
+    CanFrame_t sFrame;
+    uint32_t ui32Seq;
+}
+CanTxEntry_t;
+
+//*****************************************************************************
+//
+// One node on a bus.
+//
+//*****************************************************************************
+typedef struct
+{
+    CanBackend_t sBackend;
+
+    //
+    // Subscription index of each receive object, or 0xff if unused.
+    //
+    uint8_t pui8ObjSub[CAN_NUM_OBJECTS + 1];
+    uint32_t ui32NextObj;
+
+    CanRxRing_t psSubs[CAN_MAX_SUBS];
+    uint32_t ui32NumSubs;
+
+    //
+    // Transmit queue, kept as a binary heap ordered by identifier, and the
+    // frames currently loaded in each transmit object.
+    //
+    CanTxEntry_t psTxHeap[CAN_TX_QUEUE_SIZE];
+    uint32_t ui32TxCount;
+    uint32_t ui32TxSeq;
+    CanTxEntry_t psTxObj[CAN_TX_OBJECTS];
+    uint32_t ui32TxBusy;
+
+    uint32_t ui32TxFrames;
+    uint32_t ui32RxFrames;
+}
+CanNode_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void CanNodeInit(CanNode_t *psNode, const CanBackend_t *psBackend);
+extern int32_t CanSubscribe(CanNode_t *psNode, uint32_t ui32IdLow,
+                            uint32_t ui32IdHigh, TaskHandle_t xNotify);
+extern bool CanSend(CanNode_t *psNode, const CanFrame_t *psFrame);
+extern bool CanRead(CanNode_t *psNode, int32_t i32Sub, CanFrame_t *psFrame);
+extern void CanNodeRxFromISR(CanNode_t *psNode, uint32_t ui32Obj,
+                             const CanFrame_t *psFrame,
+                             BaseType_t *pxHigherPriorityTaskWoken);
+extern void CanNodeTxDoneFromISR(CanNode_t *psNode, uint32_t ui32Obj);
+
+extern bool CanHwInit(CanNode_t *psNode, uint32_t ui32SysClock,
+                      uint32_t ui32BitRate);
+extern void CAN1IntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CAN_TRANSPORT_H__
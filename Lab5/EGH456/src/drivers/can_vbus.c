@@ -0,0 +1,515 @@
+//*****************************************************************************
+//
+// can_vbus.c - A software model of a CAN bus that connects transport nodes
+//              without a controller, for measuring the transport.
+//
+// Each attached node gets an emulated controller: its receive filters and
+// transmit objects are held in a CanVBusPort_t instead of message RAM.
+// CanVBusStep() plays one frame on the bus.  As on the real bus, each
+// controller offers its lowest numbered pending object and the lowest
+// identifier wins arbitration.  Bus time advances by the
+// length of the frame, including stuff bits computed from the real bit
+// stream, and the frame is delivered to the first matching receive object of
+// every other node, as the controller does.
+//
+// Because the model runs the unmodified transport, the benchmark below
+// measures both the protocol behaviour (latency by priority, ISO-TP
+// throughput) in bus time and the CPU cost of the transport in core cycles.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "utils/uartstdio.h"
+#include "drivers/cycle_counter.h"
+#include "drivers/can_transport.h"
+#include "drivers/can_isotp.h"
+#include "drivers/can_vbus.h"
+
+//*****************************************************************************
+//
+// Bits of a standard data frame outside the stuffed region: CRC delimiter,
+// ACK slot and delimiter, end of frame and the intermission.
+//
+//*****************************************************************************
+#define VBUS_TAIL_BITS          13
+
+//*****************************************************************************
+//
+// Bit stream state while sizing a frame.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Crc;
+    uint32_t ui32Last;
+    uint32_t ui32Run;
+    uint32_t ui32Bits;
+}
+VBusBits_t;
+
+//*****************************************************************************
+//
+// Adds ui32Count bits of ui32Value, most significant first, to the stream.
+// Counts a stuff bit after every five equal bits and, if bCrc is set, feeds
+// the bits into the CRC-15.
+//
+//*****************************************************************************
+static void
+prvBitsPush(VBusBits_t *psBits, uint32_t ui32Value, uint32_t ui32Count,
+            bool bCrc)
+{
+    uint32_t ui32Bit;
+
+    while(ui32Count--)
+    {
+        ui32Bit = (ui32Value >> ui32Count) & 1;
+
+        if(bCrc)
+        {
+            uint32_t ui32Next = ui32Bit ^ ((psBits->ui32Crc >> 14) & 1);
+
+            psBits->ui32Crc = (psBits->ui32Crc << 1) & 0x7fff;
+            if(ui32Next)
+            {
+                psBits->ui32Crc ^= 0x4599;
+            }
+        }
+
+        psBits->ui32Bits++;
+        if(ui32Bit == psBits->ui32Last)
+        {
+            if(++psBits->ui32Run == 5)
+            {
+                psBits->ui32Bits++;
+                psBits->ui32Last = ui32Bit ^ 1;
+                psBits->ui32Run = 1;
+            }
+        }
+        else
+        {
+            psBits->ui32Last = ui32Bit;
+            psBits->ui32Run = 1;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Returns the length on the bus of a standard data frame, in bits.
+//!
+//! \param psFrame is the frame.
+//!
+//! \return Returns the number of bit times from start of frame to the end of
+//! the intermission, including stuff bits.
+//
+//*****************************************************************************
+uint32_t
+CanVBusFrameBits(const CanFrame_t *psFrame)
+{
+    VBusBits_t sBits;
+    uint32_t ui32Idx;
+
+    sBits.ui32Crc = 0;
+    sBits.ui32Last = 2;
+    sBits.ui32Run = 0;
+    sBits.ui32Bits = 0;
+
+    //
+    // Start of frame, identifier, RTR, IDE, r0 and the data length code.
+    //
+    prvBitsPush(&sBits, 0, 1, true);
+    prvBitsPush(&sBits, psFrame->ui32Id & CAN_ID_MASK, 11, true);
+    prvBitsPush(&sBits, 0, 3, true);
+    prvBitsPush(&sBits, psFrame->ui8Len, 4, true);
+    for(ui32Idx = 0; ui32Idx < psFrame->ui8Len; ui32Idx++)
+    {
+        prvBitsPush(&sBits, psFrame->pui8Data[ui32Idx], 8, true);
+    }
+    prvBitsPush(&sBits, sBits.ui32Crc, 15, false);
+
+    return(sBits.ui32Bits + VBUS_TAIL_BITS);
+}
+
+//*****************************************************************************
+//
+// Backend operations of an emulated controller.
+//
+//*****************************************************************************
+static void
+prvVBusFilterSet(void *pvHw, uint32_t ui32Obj, uint32_t ui32Id,
+                 uint32_t ui32Mask)
+{
+    CanVBusPort_t *psPort = pvHw;
+
+    psPort->pui32FilterId[ui32Obj] = ui32Id;
+    psPort->pui32FilterMask[ui32Obj] = ui32Mask;
+    psPort->ui32FilterUsed |= 1UL << (ui32Obj - 1);
+}
+
+static void
+prvVBusTxLoad(void *pvHw, uint32_t ui32Obj, const CanFrame_t *psFrame)
+{
+    CanVBusPort_t *psPort = pvHw;
+
+    psPort->psTxObj[ui32Obj - 1] = *psFrame;
+    psPort->ui32TxPending |= 1UL << (ui32Obj - 1);
+}
+
+static uint32_t
+prvVBusTimeGet(void *pvHw)
+{
+    CanVBusPort_t *psPort = pvHw;
+
+    return(CanVBusTimeGet(psPort->psBus));
+}
+
+//*****************************************************************************
+//
+//! Initialises a virtual bus.
+//!
+//! \param psBus is the bus.
+//! \param ui32BitRate is the bit rate used to convert frame lengths to time.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+CanVBusInit(CanVBus_t *psBus, uint32_t ui32BitRate)
+{
+    memset(psBus, 0, sizeof(*psBus));
+    psBus->ui32BitRate = ui32BitRate;
+}
+
+//*****************************************************************************
+//
+//! Attaches a node to a virtual bus.
+//!
+//! \param psBus is the bus.
+//! \param psNode is the node; it is initialised by this call, so subscribe
+//! afterwards.
+//!
+//! \return Returns \b false if the bus is full.
+//
+//*****************************************************************************
+bool
+CanVBusAttach(CanVBus_t *psBus, CanNode_t *psNode)
+{
+    CanVBusPort_t *psPort;
+    CanBackend_t sBackend;
+
+    if(psBus->ui32NumNodes == CAN_VBUS_MAX_NODES)
+    {
+        return(false);
+    }
+
+    psPort = &psBus->psPorts[psBus->ui32NumNodes];
+    psPort->psBus = psBus;
+    psPort->ui32Index = psBus->ui32NumNodes++;
+    psPort->psNode = psNode;
+
+    sBackend.pfnFilterSet = prvVBusFilterSet;
+    sBackend.pfnTxLoad = prvVBusTxLoad;
+    sBackend.pfnTimeGet = prvVBusTimeGet;
+    sBackend.pvHw = psPort;
+    CanNodeInit(psNode, &sBackend);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Returns the bus time in microseconds.
+//
+//*****************************************************************************
+uint32_t
+CanVBusTimeGet(const CanVBus_t *psBus)
+{
+    return((uint32_t)(psBus->ui64TimeNs / 1000));
+}
+
+//*****************************************************************************
+//
+//! Transmits the highest priority pending frame.
+//!
+//! \param psBus is the bus.
+//!
+//! The frame is delivered to the other nodes and its transmit object is
+//! released, which lets the sender load its next queued frame.  Call from a
+//! task; the node callbacks run as they would from the controller interrupt.
+//!
+//! \return Returns \b false if no node had a frame pending.
+//
+//*****************************************************************************
+bool
+CanVBusStep(CanVBus_t *psBus)
+{
+    BaseType_t xWoken = pdFALSE;
+    CanVBusPort_t *psWinner = NULL, *psPort;
+    CanFrame_t sFrame;
+    uint32_t ui32Node, ui32Obj, ui32WinObj = 0, ui32Bits, ui32Latency;
+
+    //
+    // Arbitration.  Each controller presents its lowest numbered pending
+    // object and the lowest identifier among them wins.
+    //
+    for(ui32Node = 0; ui32Node < psBus->ui32NumNodes; ui32Node++)
+    {
+        psPort = &psBus->psPorts[ui32Node];
+        for(ui32Obj = 1; ui32Obj <= CAN_TX_OBJECTS; ui32Obj++)
+        {
+            if(psPort->ui32TxPending & (1UL << (ui32Obj - 1)))
+            {
+                break;
+            }
+        }
+        if((ui32Obj <= CAN_TX_OBJECTS) &&
+           ((psWinner == NULL) ||
+            (psPort->psTxObj[ui32Obj - 1].ui32Id <
+             psWinner->psTxObj[ui32WinObj - 1].ui32Id)))
+        {
+            psWinner = psPort;
+            ui32WinObj = ui32Obj;
+        }
+    }
+    if(psWinner == NULL)
+    {
+        return(false);
+    }
+
+    sFrame = psWinner->psTxObj[ui32WinObj - 1];
+    psWinner->ui32TxPending &= ~(1UL << (ui32WinObj - 1));
+
+    ui32Bits = CanVBusFrameBits(&sFrame);
+    psBus->ui64TimeNs += ((uint64_t)ui32Bits * 1000000000) /
+                         psBus->ui32BitRate;
+    psBus->ui32Bits += ui32Bits;
+    psBus->ui32Frames++;
+
+    ui32Latency = CanVBusTimeGet(psBus) - sFrame.ui32Time;
+    psBus->ui64LatencySum += ui32Latency;
+    if(ui32Latency > psBus->ui32LatencyMax)
+    {
+        psBus->ui32LatencyMax = ui32Latency;
+    }
+
+    //
+    // Delivery.  Each node stores the frame in its first matching object.
+    //
+    for(ui32Node = 0; ui32Node < psBus->ui32NumNodes; ui32Node++)
+    {
+        psPort = &psBus->psPorts[ui32Node];
+        if(psPort == psWinner)
+        {
+            continue;
+        }
+        for(ui32Obj = CAN_FIRST_RX_OBJECT; ui32Obj <= CAN_NUM_OBJECTS;
+            ui32Obj++)
+        {
+            if(((psPort->ui32FilterUsed & (1UL << (ui32Obj - 1))) != 0) &&
+               (((sFrame.ui32Id ^ psPort->pui32FilterId[ui32Obj]) &
+                 psPort->pui32FilterMask[ui32Obj]) == 0))
+            {
+                CanNodeRxFromISR(psPort->psNode, ui32Obj, &sFrame, &xWoken);
+                break;
+            }
+        }
+        if(ui32Obj > CAN_NUM_OBJECTS)
+        {
+            psBus->ui32Filtered++;
+        }
+    }
+
+    CanNodeTxDoneFromISR(psWinner->psNode, ui32WinObj);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Benchmark set-up.  Every VBUS_BENCH_PERIOD frames node 0 sends one high
+// priority control frame and node 1 a burst of VBUS_BENCH_BULK_BURST medium
+// priority frames.  Node 0 also streams ISO-TP messages to node 2 at the
+// lowest priority, which takes whatever bus time is left, so the bus is
+// saturated and each class only gets through by priority.
+//
+//*****************************************************************************
+#define VBUS_BENCH_BITRATE      500000
+#define VBUS_BENCH_FRAMES       4000
+#define VBUS_BENCH_CTRL_ID      0x080
+#define VBUS_BENCH_PERIOD       8
+#define VBUS_BENCH_BULK_ID      0x300
+#define VBUS_BENCH_BULK_BURST   4
+#define VBUS_BENCH_TP_A         0x7e0
+#define VBUS_BENCH_TP_B         0x7e8
+#define VBUS_BENCH_TP_LEN       256
+
+static CanVBus_t g_sBenchBus;
+static CanNode_t g_psBenchNodes[3];
+static CanIsoTpLink_t g_sBenchTpTx, g_sBenchTpRx;
+static uint8_t g_pui8BenchTpData[VBUS_BENCH_TP_LEN];
+static uint8_t g_pui8BenchTpBuf[VBUS_BENCH_TP_LEN];
+static uint32_t g_ui32BenchTpGood, g_ui32BenchTpBad;
+
+//
+// Latency of frames read from one subscription.
+//
+typedef struct
+{
+    uint32_t ui32Count;
+    uint32_t ui32Sum;
+    uint32_t ui32Max;
+}
+VBusLatency_t;
+
+static void
+prvBenchTpRx(const uint8_t *pui8Data, uint32_t ui32Len, void *pvArg)
+{
+    (void)pvArg;
+
+    if((ui32Len == VBUS_BENCH_TP_LEN) &&
+       (memcmp(pui8Data, g_pui8BenchTpData, ui32Len) == 0))
+    {
+        g_ui32BenchTpGood++;
+    }
+    else
+    {
+        g_ui32BenchTpBad++;
+    }
+}
+
+static void
+prvBenchDrain(int32_t i32Sub, VBusLatency_t *psLat)
+{
+    CanFrame_t sFrame;
+    uint32_t ui32Latency;
+
+    while(CanRead(&g_psBenchNodes[2], i32Sub, &sFrame))
+    {
+        ui32Latency = CanVBusTimeGet(&g_sBenchBus) - sFrame.ui32Time;
+        psLat->ui32Count++;
+        psLat->ui32Sum += ui32Latency;
+        if(ui32Latency > psLat->ui32Max)
+        {
+            psLat->ui32Max = ui32Latency;
+        }
+    }
+}
+
+static void
+prvBenchPrint(const char *pcName, const VBusLatency_t *psLat)
+{
+    UARTprintf("%-8s %6d %8d %8d\n", pcName, psLat->ui32Count,
+               psLat->ui32Count ? psLat->ui32Sum / psLat->ui32Count : 0,
+               psLat->ui32Max);
+}
+
+//*****************************************************************************
+//
+//! Runs three transport nodes on a saturated virtual bus and prints the
+//! throughput, the latency seen by each traffic class and the CPU cost.
+//!
+//! Latencies and frame rates are in bus time at 500 kbit/s; cycles per frame
+//! is the core time spent in the transport and the model for each frame.
+//! Must be called from a task.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+vCanVBusBenchmark(void)
+{
+    VBusLatency_t sCtrl, sBulk;
+    CanFrame_t sFrame;
+    int32_t i32CtrlSub, i32BulkSub;
+    uint32_t ui32Idx, ui32Start, ui32Cycles, ui32Time, ui32Sent = 0;
+
+    CycleCounterInit();
+
+    for(ui32Idx = 0; ui32Idx < VBUS_BENCH_TP_LEN; ui32Idx++)
+    {
+        g_pui8BenchTpData[ui32Idx] = ui32Idx * 7;
+    }
+    memset(&sCtrl, 0, sizeof(sCtrl));
+    memset(&sBulk, 0, sizeof(sBulk));
+    g_ui32BenchTpGood = 0;
+    g_ui32BenchTpBad = 0;
+
+    CanVBusInit(&g_sBenchBus, VBUS_BENCH_BITRATE);
+    for(ui32Idx = 0; ui32Idx < 3; ui32Idx++)
+    {
+        CanVBusAttach(&g_sBenchBus, &g_psBenchNodes[ui32Idx]);
+    }
+    i32CtrlSub = CanSubscribe(&g_psBenchNodes[2], VBUS_BENCH_CTRL_ID,
+                              VBUS_BENCH_CTRL_ID, NULL);
+    i32BulkSub = CanSubscribe(&g_psBenchNodes[2], VBUS_BENCH_BULK_ID,
+                              VBUS_BENCH_BULK_ID + 0x0f, NULL);
+    if((i32CtrlSub < 0) || (i32BulkSub < 0) ||
+       !CanIsoTpInit(&g_sBenchTpTx, &g_psBenchNodes[0], VBUS_BENCH_TP_A,
+                     VBUS_BENCH_TP_B, NULL, 0, prvBenchTpRx, NULL, NULL) ||
+       !CanIsoTpInit(&g_sBenchTpRx, &g_psBenchNodes[2], VBUS_BENCH_TP_B,
+                     VBUS_BENCH_TP_A, g_pui8BenchTpBuf, sizeof(g_pui8BenchTpBuf),
+                     prvBenchTpRx, NULL, NULL))
+    {
+        UARTprintf("set-up failed\n");
+        return;
+    }
+
+    memset(&sFrame, 0, sizeof(sFrame));
+    sFrame.ui8Len = 8;
+
+    ui32Start = CycleCounterGet();
+    while(g_sBenchBus.ui32Frames < VBUS_BENCH_FRAMES)
+    {
+        if((g_sBenchBus.ui32Frames % VBUS_BENCH_PERIOD) == 0)
+        {
+            sFrame.ui32Id = VBUS_BENCH_CTRL_ID;
+            sFrame.pui8Data[0] = g_sBenchBus.ui32Frames;
+            CanSend(&g_psBenchNodes[0], &sFrame);
+
+            for(ui32Idx = 0; ui32Idx < VBUS_BENCH_BULK_BURST; ui32Idx++)
+            {
+                sFrame.ui32Id = VBUS_BENCH_BULK_ID + (ui32Sent++ & 0x0f);
+                CanSend(&g_psBenchNodes[1], &sFrame);
+            }
+        }
+        if(!CanIsoTpBusy(&g_sBenchTpTx))
+        {
+            CanIsoTpSend(&g_sBenchTpTx, g_pui8BenchTpData, VBUS_BENCH_TP_LEN);
+        }
+
+        if(!CanVBusStep(&g_sBenchBus))
+        {
+            break;
+        }
+
+        CanIsoTpPoll(&g_sBenchTpTx);
+        CanIsoTpPoll(&g_sBenchTpRx);
+        prvBenchDrain(i32CtrlSub, &sCtrl);
+        prvBenchDrain(i32BulkSub, &sBulk);
+    }
+    ui32Cycles = CycleCounterGet() - ui32Start;
+    ui32Time = CanVBusTimeGet(&g_sBenchBus);
+
+    UARTprintf("frames %d in %d us bus time, %d frames/s, %d bits/frame\n",
+               g_sBenchBus.ui32Frames, ui32Time,
+               (uint32_t)(((uint64_t)g_sBenchBus.ui32Frames * 1000000) /
+                          ui32Time),
+               g_sBenchBus.ui32Bits / g_sBenchBus.ui32Frames);
+    UARTprintf("class     count   avg-us   max-us\n");
+    prvBenchPrint("control", &sCtrl);
+    prvBenchPrint("bulk", &sBulk);
+    UARTprintf("isotp    %d x %d bytes ok (%d bytes/s), %d bad, %d errors\n",
+               g_ui32BenchTpGood, VBUS_BENCH_TP_LEN,
+               (uint32_t)(((uint64_t)g_ui32BenchTpGood * VBUS_BENCH_TP_LEN *
+                           1000000) / ui32Time),
+               g_ui32BenchTpBad,
+               g_sBenchTpTx.ui32Errors + g_sBenchTpRx.ui32Errors);
+    UARTprintf("cycles/frame %d, filtered %d, dropped %d\n",
+               ui32Cycles / g_sBenchBus.ui32Frames, g_sBenchBus.ui32Filtered,
+               g_psBenchNodes[2].psSubs[i32CtrlSub].ui32Dropped +
+               g_psBenchNodes[2].psSubs[i32BulkSub].ui32Dropped);
+}
@@ -0,0 +1,98 @@
+//*****************************************************************************
+//
+// can_vbus.h - A software model of a CAN bus that connects transport nodes
+//              without a controller, for measuring the transport.
+//
+//*****************************************************************************
+
+#ifndef __CAN_VBUS_H__
+#define __CAN_VBUS_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The largest number of nodes on one virtual bus.
+//
+//*****************************************************************************
+#define CAN_VBUS_MAX_NODES      4
+
+struct CanVBus;
+
+//*****************************************************************************
+//
+// The emulated controller of one node.  psBus and ui32Index let the backend
+// callbacks find the bus from the node's pvHw pointer.
+//
+//*****************************************************************************
+typedef struct
+{
+    struct CanVBus *psBus;
+    uint32_t ui32Index;
+    CanNode_t *psNode;
+
+    uint32_t pui32FilterId[CAN_NUM_OBJECTS + 1];
+    uint32_t pui32FilterMask[CAN_NUM_OBJECTS + 1];
+    uint32_t ui32FilterUsed;
+
+    CanFrame_t psTxObj[CAN_TX_OBJECTS];
+    uint32_t ui32TxPending;
+}
+CanVBusPort_t;
+
+//*****************************************************************************
+//
+// A virtual bus.  Time is in microseconds of bus time, advanced by the
+// length of each frame at ui32BitRate.
+//
+//*****************************************************************************
+typedef struct CanVBus
+{
+    CanVBusPort_t psPorts[CAN_VBUS_MAX_NODES];
+    uint32_t ui32NumNodes;
+    uint32_t ui32BitRate;
+    uint64_t ui64TimeNs;
+
+    //
+    // Statistics.  Latency is from CanSend() to delivery of the last bit.
+    // ui32Filtered counts deliveries rejected by a node's filters.
+    //
+    uint32_t ui32Frames;
+    uint32_t ui32Bits;
+    uint32_t ui32Filtered;
+    uint64_t ui64LatencySum;
+    uint32_t ui32LatencyMax;
+}
+CanVBus_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void CanVBusInit(CanVBus_t *psBus, uint32_t ui32BitRate);
+extern bool CanVBusAttach(CanVBus_t *psBus, CanNode_t *psNode);
+extern bool CanVBusStep(CanVBus_t *psBus);
+extern uint32_t CanVBusTimeGet(const CanVBus_t *psBus);
+extern uint32_t CanVBusFrameBits(const CanFrame_t *psFrame);
+extern void vCanVBusBenchmark(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CAN_VBUS_H__
@@ -0,0 +1,624 @@
+//*****************************************************************************
+//
+// clock_scale.c - Run time switching of the system clock between performance
+//                 levels, with notification of the drivers that depend on it.
+//
+// The board used to run at 120 MHz from reset to power off, even while the
+// only work was a 10 Hz light reading.  This module lets the system clock move
+// between the 120 MHz and 60 MHz PLL settings, the 25 MHz crystal and the
+// 16 MHz internal oscillator while the scheduler is running.
+//
+// Every peripheral whose timing is derived from the system clock has to be
+// reprogrammed when it changes: I2C bit rate, SSI bit rate, timer reloads and
+// the SysTick reload behind the FreeRTOS tick.  Drivers register a
+// ClockNotifier_t; the switch calls each pre callback so the peripheral can go
+// idle, changes the clock, and calls each post callback with the new
+// frequency before any task or kernel aware interrupt can run.  The SysTick
+// reload is handled here, so the tick stays at configTICK_RATE_HZ at every
+// level.
+//
+// The FreeRTOS run time statistics counter runs from Timer5, clocked from the
+// PIOSC rather than the system clock, so task run times stay comparable across
+// switches.  The optional governor task uses it to measure the load and picks
+// the level.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "utils/uartstdio.h"
+#include "task_stacks.h"
+#include "drivers/clock_scale.h"
+
+//*****************************************************************************
+//
+// The run time statistics counter.  It counts the 16 MHz PIOSC, so it wraps
+// about every 268 s; differences between readings are correct across one wrap.
+//
+//*****************************************************************************
+#define CLOCK_RT_PERIPH         SYSCTL_PERIPH_TIMER5
+#define CLOCK_RT_BASE           TIMER5_BASE
+#define CLOCK_RT_HZ             16000000
+
+//*****************************************************************************
+//
+// The SysCtlClockFreqSet() arguments for each level.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Config;
+    uint32_t ui32Hz;
+}
+ClockLevel_t;
+
+static const ClockLevel_t g_psClockLevels[CLOCK_NUM_LEVELS] =
+{
+    { SYSCTL_OSC_INT | SYSCTL_USE_OSC, 16000000 },
+    { SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_OSC, 25000000 },
+    { SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_PLL |
+      SYSCTL_CFG_VCO_480, 60000000 },
+    { SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_PLL |
+      SYSCTL_CFG_VCO_480, 120000000 },
+};
+
+static ClockNotifier_t *g_psClockNotifiers = NULL;
+static SemaphoreHandle_t g_xClockLock = NULL;
+static volatile uint32_t g_ui32ClockLevel;
+static volatile uint32_t g_ui32ClockHz;
+static uint32_t g_ui32ClockFloor = CLOCK_LEVEL_PIOSC;
+static bool g_bClockRunTimeStarted = false;
+
+//
+// Time spent at each level, in run time counter ticks, and the counter value
+// when the current level was entered.
+//
+static uint64_t g_pui64ClockResidency[CLOCK_NUM_LEVELS];
+static uint32_t g_ui32ClockEntered;
+
+//*****************************************************************************
+//
+//! Starts the run time statistics counter.
+//!
+//! This is portCONFIGURE_TIMER_FOR_RUN_TIME_STATS(), called by the kernel when
+//! the scheduler starts.  ClockScaleInit() also calls it so residency is
+//! counted from the first switch.  Safe to call more than once.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+vClockRunTimeInit(void)
+{
+    if(g_bClockRunTimeStarted)
+    {
+        return;
+    }
+
+    SysCtlPeripheralEnable(CLOCK_RT_PERIPH);
+    while(!SysCtlPeripheralReady(CLOCK_RT_PERIPH))
+    {
+    }
+
+    SysCtlAltClkConfig(SYSCTL_ALTCLK_PIOSC);
+    TimerConfigure(CLOCK_RT_BASE, TIMER_CFG_PERIODIC_UP);
+    TimerClockSourceSet(CLOCK_RT_BASE, TIMER_CLOCK_PIOSC);
+    TimerLoadSet(CLOCK_RT_BASE, TIMER_A, 0xffffffff);
+    TimerEnable(CLOCK_RT_BASE, TIMER_A);
+
+    g_bClockRunTimeStarted = true;
+}
+
+//*****************************************************************************
+//
+//! Reads the run time statistics counter.
+//!
+//! This is portGET_RUN_TIME_COUNTER_VALUE().
+//!
+//! \return Returns the counter, in PIOSC cycles (62.5 ns).
+//
+//*****************************************************************************
+uint32_t
+ulClockRunTimeGet(void)
+{
+    return(TimerValueGet(CLOCK_RT_BASE, TIMER_A));
+}
+
+//*****************************************************************************
+//
+// Keeps the FreeRTOS tick at configTICK_RATE_HZ.  Before the scheduler starts
+// SysTick is off, and the port programs it from configCPU_CLOCK_HZ, which
+// reads the current frequency.
+//
+//*****************************************************************************
+static void
+prvSysTickPost(uint32_t ui32NewHz, void *pvArg)
+{
+    (void)pvArg;
+
+    if(HWREG(NVIC_ST_CTRL) & NVIC_ST_CTRL_ENABLE)
+    {
+        HWREG(NVIC_ST_RELOAD) = (ui32NewHz / configTICK_RATE_HZ) - 1;
+        HWREG(NVIC_ST_CURRENT) = 0;
+    }
+}
+
+static ClockNotifier_t g_sSysTickNotifier =
+{
+    NULL, prvSysTickPost, NULL, NULL
+};
+
+//*****************************************************************************
+//
+//! Sets the system clock for the first time.
+//!
+//! \param ui32Level is the starting level, one of the \b CLOCK_LEVEL_ values.
+//!
+//! Call once, from main() before the scheduler starts and before any other
+//! clock dependent peripheral is configured.  This replaces calling
+//! SysCtlClockFreqSet() directly.
+//!
+//! \return Returns the system clock frequency in Hz.
+//
+//*****************************************************************************
+uint32_t
+ClockScaleInit(uint32_t ui32Level)
+{
+    if(ui32Level >= CLOCK_NUM_LEVELS)
+    {
+        ui32Level = CLOCK_LEVEL_PLL120;
+    }
+
+    g_ui32ClockHz = SysCtlClockFreqSet(g_psClockLevels[ui32Level].ui32Config,
+                                       g_psClockLevels[ui32Level].ui32Hz);
+    g_ui32ClockLevel = ui32Level;
+
+    if(g_xClockLock == NULL)
+    {
+        g_xClockLock = xSemaphoreCreateMutex();
+        ClockNotifierRegister(&g_sSysTickNotifier);
+    }
+
+    vClockRunTimeInit();
+    g_ui32ClockEntered = ulClockRunTimeGet();
+
+    return(g_ui32ClockHz);
+}
+
+//*****************************************************************************
+//
+//! Registers a driver for clock change notification.
+//!
+//! \param psNotifier is the registration.  It must stay valid for as long as
+//! it is registered, and must not already be registered.
+//!
+//! Notifiers are called in the reverse order of registration.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClockNotifierRegister(ClockNotifier_t *psNotifier)
+{
+    taskENTER_CRITICAL();
+    psNotifier->psNext = g_psClockNotifiers;
+    g_psClockNotifiers = psNotifier;
+    taskEXIT_CRITICAL();
+}
+
+//*****************************************************************************
+//
+//! Removes a driver's clock change registration.
+//!
+//! \param psNotifier is the registration.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClockNotifierUnregister(ClockNotifier_t *psNotifier)
+{
+    ClockNotifier_t **ppsLink;
+
+    xSemaphoreTake(g_xClockLock, portMAX_DELAY);
+    taskENTER_CRITICAL();
+    for(ppsLink = &g_psClockNotifiers; *ppsLink != NULL;
+        ppsLink = &(*ppsLink)->psNext)
+    {
+        if(*ppsLink == psNotifier)
+        {
+            *ppsLink = psNotifier->psNext;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+    xSemaphoreGive(g_xClockLock);
+}
+
+//*****************************************************************************
+//
+//! Changes the system clock.
+//!
+//! \param ui32Level is the new level, one of the \b CLOCK_LEVEL_ values.  A
+//! level below the floor set by ClockLevelFloorSet() is raised to the floor.
+//!
+//! Must be called from a task, after ClockScaleInit().  The pre callbacks run
+//! first, with interrupts enabled.  The switch and the post callbacks then run
+//! in one critical section, which lasts for as long as SysCtlClockFreqSet()
+//! waits for the PLL or crystal to settle.
+//!
+//! \return Returns the new system clock frequency in Hz.
+//
+//*****************************************************************************
+uint32_t
+ClockLevelSet(uint32_t ui32Level)
+{
+    const ClockLevel_t *psLevel;
+    ClockNotifier_t *psNotifier;
+    uint32_t ui32Now, ui32Hz;
+
+    if(ui32Level >= CLOCK_NUM_LEVELS)
+    {
+        ui32Level = CLOCK_NUM_LEVELS - 1;
+    }
+
+    xSemaphoreTake(g_xClockLock, portMAX_DELAY);
+
+    if(ui32Level < g_ui32ClockFloor)
+    {
+        ui32Level = g_ui32ClockFloor;
+    }
+    if(ui32Level == g_ui32ClockLevel)
+    {
+        xSemaphoreGive(g_xClockLock);
+        return(g_ui32ClockHz);
+    }
+
+    psLevel = &g_psClockLevels[ui32Level];
+    for(psNotifier = g_psClockNotifiers; psNotifier != NULL;
+        psNotifier = psNotifier->psNext)
+    {
+        if(psNotifier->pfnPre)
+        {
+            psNotifier->pfnPre(psLevel->ui32Hz, psNotifier->pvArg);
+        }
+    }
+
+    taskENTER_CRITICAL();
+
+    ui32Hz = SysCtlClockFreqSet(psLevel->ui32Config, psLevel->ui32Hz);
+
+    ui32Now = ulClockRunTimeGet();
+    g_pui64ClockResidency[g_ui32ClockLevel] += ui32Now - g_ui32ClockEntered;
+    g_ui32ClockEntered = ui32Now;
+    g_ui32ClockLevel = ui32Level;
+    g_ui32ClockHz = ui32Hz;
+
+    for(psNotifier = g_psClockNotifiers; psNotifier != NULL;
+        psNotifier = psNotifier->psNext)
+    {
+        if(psNotifier->pfnPost)
+        {
+            psNotifier->pfnPost(ui32Hz, psNotifier->pvArg);
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    xSemaphoreGive(g_xClockLock);
+
+    return(ui32Hz);
+}
+
+//*****************************************************************************
+//
+//! Returns the current level, one of the \b CLOCK_LEVEL_ values.
+//
+//*****************************************************************************
+uint32_t
+ClockLevelGet(void)
+{
+    return(g_ui32ClockLevel);
+}
+
+//*****************************************************************************
+//
+//! Returns the current system clock frequency in Hz.
+//
+//*****************************************************************************
+uint32_t
+ClockFreqGet(void)
+{
+    return(g_ui32ClockHz);
+}
+
+//*****************************************************************************
+//
+//! Sets the slowest level the clock may run at.
+//!
+//! \param ui32Level is the floor, one of the \b CLOCK_LEVEL_ values.
+//!
+//! A driver that needs a minimum clock, such as the Ethernet MAC, raises the
+//! floor while it is in use.  If the clock is below the new floor it is raised
+//! at once.  Must be called from a task.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClockLevelFloorSet(uint32_t ui32Level)
+{
+    if(ui32Level >= CLOCK_NUM_LEVELS)
+    {
+        ui32Level = CLOCK_NUM_LEVELS - 1;
+    }
+
+    g_ui32ClockFloor = ui32Level;
+    if(g_ui32ClockLevel < ui32Level)
+    {
+        ClockLevelSet(ui32Level);
+    }
+}
+
+//*****************************************************************************
+//
+//! Returns the time spent at each level since ClockScaleInit().
+//!
+//! \param pui32Ms receives CLOCK_NUM_LEVELS times, in milliseconds.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClockResidencyGet(uint32_t *pui32Ms)
+{
+    uint32_t ui32Level, ui32Now;
+    uint64_t ui64Ticks;
+
+    taskENTER_CRITICAL();
+    ui32Now = ulClockRunTimeGet();
+    for(ui32Level = 0; ui32Level < CLOCK_NUM_LEVELS; ui32Level++)
+    {
+        ui64Ticks = g_pui64ClockResidency[ui32Level];
+        if(ui32Level == g_ui32ClockLevel)
+        {
+            ui64Ticks += ui32Now - g_ui32ClockEntered;
+        }
+        pui32Ms[ui32Level] = (uint32_t)(ui64Ticks / (CLOCK_RT_HZ / 1000));
+    }
+    taskEXIT_CRITICAL();
+}
+
+//*****************************************************************************
+//
+// The governor.  Each period it compares the time the idle task ran with the
+// elapsed time.  A busy window moves straight to the fastest level, so a
+// burst of work is not slowed for long; only a run of quiet windows moves the
+// clock down, one level at a time.
+//
+//*****************************************************************************
+static void
+prvGovernorTask(void *pvParameters)
+{
+    TickType_t xLastWake;
+    uint32_t ui32IdlePrev, ui32TotalPrev, ui32Idle, ui32Total;
+    uint32_t ui32Busy, ui32Quiet = 0, ui32Level;
+
+    (void)pvParameters;
+
+    xLastWake = xTaskGetTickCount();
+    ui32IdlePrev = ulTaskGetIdleRunTimeCounter();
+    ui32TotalPrev = ulClockRunTimeGet();
+
+    for(;;)
+    {
+        vTaskDelayUntil(&xLastWake, pdMS_TO_TICKS(CLOCK_GOV_PERIOD_MS));
+
+        ui32Idle = ulTaskGetIdleRunTimeCounter();
+        ui32Total = ulClockRunTimeGet();
+        ui32Busy = (((ui32Idle - ui32IdlePrev) / 16) * 100) /
+                   (((ui32Total - ui32TotalPrev) / 16) + 1);
+        ui32Busy = (ui32Busy < 100) ? (100 - ui32Busy) : 0;
+        ui32IdlePrev = ui32Idle;
+        ui32TotalPrev = ui32Total;
+
+        ui32Level = ClockLevelGet();
+        if(ui32Busy > CLOCK_GOV_UP_PCT)
+        {
+            ui32Quiet = 0;
+            if(ui32Level != CLOCK_NUM_LEVELS - 1)
+            {
+                ClockLevelSet(CLOCK_NUM_LEVELS - 1);
+            }
+        }
+        else if(ui32Busy < CLOCK_GOV_DOWN_PCT)
+        {
+            if(++ui32Quiet >= CLOCK_GOV_DOWN_WINDOWS)
+            {
+                ui32Quiet = 0;
+                if(ui32Level > g_ui32ClockFloor)
+                {
+                    ClockLevelSet(ui32Level - 1);
+                }
+            }
+        }
+        else
+        {
+            ui32Quiet = 0;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Starts the load based governor task.
+//!
+//! Call once, after ClockScaleInit().  While the governor runs, other callers
+//! should use ClockLevelFloorSet() rather than ClockLevelSet(), or the
+//! governor will undo their choice.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClockGovernorStart(void)
+{
+    xTaskCreate(prvGovernorTask, "ClkGov", TASK_STACK_CLOCK_GOV, NULL,
+                CLOCK_GOV_TASK_PRIORITY, NULL);
+}
+
+//*****************************************************************************
+//
+// Benchmark state.  The benchmark registers its own notifier and checks that
+// each switch calls it once before and once after, with the frequency the
+// switch reports, and that the tick reload follows.
+//
+//*****************************************************************************
+#define CLOCK_BENCH_WORK        20000
+
+static uint32_t g_ui32BenchPre, g_ui32BenchPost, g_ui32BenchErrors;
+static uint32_t g_ui32BenchPreHz, g_ui32BenchSwitches;
+
+static void
+prvBenchPre(uint32_t ui32NewHz, void *pvArg)
+{
+    (void)pvArg;
+
+    if(g_ui32BenchPre != g_ui32BenchPost)
+    {
+        g_ui32BenchErrors++;
+    }
+    g_ui32BenchPre++;
+    g_ui32BenchPreHz = ui32NewHz;
+}
+
+static void
+prvBenchPost(uint32_t ui32NewHz, void *pvArg)
+{
+    (void)pvArg;
+
+    g_ui32BenchPost++;
+    if((g_ui32BenchPost != g_ui32BenchPre) ||
+       (ui32NewHz != g_ui32BenchPreHz) || (ui32NewHz != ClockFreqGet()))
+    {
+        g_ui32BenchErrors++;
+    }
+}
+
+static ClockNotifier_t g_sBenchNotifier =
+{
+    prvBenchPre, prvBenchPost, NULL, NULL
+};
+
+//
+// Switches level, counting the switches that should notify.
+//
+static uint32_t
+prvBenchSet(uint32_t ui32Level)
+{
+    if(ClockLevelGet() != ui32Level)
+    {
+        g_ui32BenchSwitches++;
+    }
+
+    return(ClockLevelSet(ui32Level));
+}
+
+//
+// A fixed amount of work, to show what each level buys.
+//
+static uint32_t
+prvBenchWork(void)
+{
+    volatile uint32_t ui32Acc = 1;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < CLOCK_BENCH_WORK; ui32Idx++)
+    {
+        ui32Acc = ui32Acc * 1664525 + 1013904223;
+    }
+
+    return(ui32Acc);
+}
+
+//*****************************************************************************
+//
+//! Switches between every pair of levels and prints the cost of each switch.
+//!
+//! The table gives, for each starting level, the time in microseconds to
+//! switch to each other level, measured on the PIOSC counter, followed by the
+//! time a fixed loop takes at the starting level.  The last line reports
+//! whether every switch notified in order and left the tick reload correct.
+//! Must be called from a task, after ClockScaleInit(), with the governor not
+//! running.  The clock is left at its starting level.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+vClockScaleBenchmark(void)
+{
+    static const char * const ppcNames[CLOCK_NUM_LEVELS] =
+    {
+        "16M", "25M", "60M", "120M"
+    };
+    uint32_t ui32Start, ui32From, ui32To, ui32Time;
+    uint32_t ui32Hz, ui32Initial, ui32Floor;
+
+    ui32Initial = ClockLevelGet();
+    ui32Floor = g_ui32ClockFloor;
+    g_ui32ClockFloor = CLOCK_LEVEL_PIOSC;
+    g_ui32BenchPre = 0;
+    g_ui32BenchPost = 0;
+    g_ui32BenchErrors = 0;
+    g_ui32BenchSwitches = 0;
+    ClockNotifierRegister(&g_sBenchNotifier);
+
+    UARTprintf("from   to-16M  to-25M  to-60M to-120M  work-us\n");
+    for(ui32From = 0; ui32From < CLOCK_NUM_LEVELS; ui32From++)
+    {
+        UARTprintf("%4s ", ppcNames[ui32From]);
+        for(ui32To = 0; ui32To < CLOCK_NUM_LEVELS; ui32To++)
+        {
+            if(ui32To == ui32From)
+            {
+                UARTprintf("       -");
+                continue;
+            }
+
+            prvBenchSet(ui32From);
+            ui32Start = ulClockRunTimeGet();
+            ui32Hz = prvBenchSet(ui32To);
+            ui32Time = ulClockRunTimeGet() - ui32Start;
+
+            if((HWREG(NVIC_ST_CTRL) & NVIC_ST_CTRL_ENABLE) &&
+               (HWREG(NVIC_ST_RELOAD) + 1 != ui32Hz / configTICK_RATE_HZ))
+            {
+                g_ui32BenchErrors++;
+            }
+
+            UARTprintf(" %7d", ui32Time / (CLOCK_RT_HZ / 1000000));
+        }
+
+        prvBenchSet(ui32From);
+        ui32Start = ulClockRunTimeGet();
+        prvBenchWork();
+        ui32Time = ulClockRunTimeGet() - ui32Start;
+        UARTprintf(" %8d\n", ui32Time / (CLOCK_RT_HZ / 1000000));
+    }
+
+    prvBenchSet(ui32Initial);
+    ClockNotifierUnregister(&g_sBenchNotifier);
+    g_ui32ClockFloor = ui32Floor;
+
+    UARTprintf("%d notifications for %d switches, %d errors\n",
+               g_ui32BenchPost, g_ui32BenchSwitches, g_ui32BenchErrors);
+}
@@ -0,0 +1,94 @@
+//*****************************************************************************
+//
+// clock_scale.h - Run time switching of the system clock between performance
+//                 levels, with notification of the drivers that depend on it.
+//
+//*****************************************************************************
+
+#ifndef __CLOCK_SCALE_H__
+#define __CLOCK_SCALE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Performance levels, slowest first.
+//
+//*****************************************************************************
+#define CLOCK_LEVEL_PIOSC       0       // 16 MHz internal oscillator
+#define CLOCK_LEVEL_MOSC        1       // 25 MHz crystal, PLL off
+#define CLOCK_LEVEL_PLL60       2       // 60 MHz from the PLL
+#define CLOCK_LEVEL_PLL120      3       // 120 MHz from the PLL
+#define CLOCK_NUM_LEVELS        4
+
+//*****************************************************************************
+//
+// Governor tuning.  Every CLOCK_GOV_PERIOD_MS the governor measures the
+// fraction of time the CPU was busy.  Above CLOCK_GOV_UP_PCT it moves to the
+// fastest level at once; below CLOCK_GOV_DOWN_PCT for CLOCK_GOV_DOWN_WINDOWS
+// windows in a row it moves down one level.
+//
+//*****************************************************************************
+#define CLOCK_GOV_PERIOD_MS     100
+#define CLOCK_GOV_UP_PCT        70
+#define CLOCK_GOV_DOWN_PCT      25
+#define CLOCK_GOV_DOWN_WINDOWS  5
+#define CLOCK_GOV_TASK_PRIORITY (tskIDLE_PRIORITY + 4)
+
+//*****************************************************************************
+//
+// A driver's registration for clock changes.
+//
+// pfnPre, if not NULL, is called in the changing task before the switch,
+// with interrupts enabled; it may block to let the peripheral go idle.
+// pfnPost is called with the new frequency after the switch, inside the same
+// critical section, so no task or kernel aware interrupt runs between the
+// switch and the peripheral being reprogrammed.  It must not block.
+//
+//*****************************************************************************
+typedef struct ClockNotifier
+{
+    void (*pfnPre)(uint32_t ui32NewHz, void *pvArg);
+    void (*pfnPost)(uint32_t ui32NewHz, void *pvArg);
+    void *pvArg;
+    struct ClockNotifier *psNext;
+}
+ClockNotifier_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern uint32_t ClockScaleInit(uint32_t ui32Level);
+extern void ClockNotifierRegister(ClockNotifier_t *psNotifier);
+extern void ClockNotifierUnregister(ClockNotifier_t *psNotifier);
+extern uint32_t ClockLevelSet(uint32_t ui32Level);
+extern uint32_t ClockLevelGet(void);
+extern uint32_t ClockFreqGet(void);
+extern void ClockLevelFloorSet(uint32_t ui32Level);
+extern void ClockGovernorStart(void);
+extern void ClockResidencyGet(uint32_t *pui32Ms);
+extern void vClockRunTimeInit(void);
+extern uint32_t ulClockRunTimeGet(void);
+extern void vClockScaleBenchmark(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CLOCK_SCALE_H__
@@ -0,0 +1,86 @@
+//*****************************************************************************
+//
+// cycle_counter.h - Access to the Cortex-M4 DWT cycle counter, used to time
+//                   code paths in core clock cycles.
+//
+//*****************************************************************************
+
+#ifndef __CYCLE_COUNTER_H__
+#define __CYCLE_COUNTER_H__
+
+#include <stdint.h>
+#include "inc/hw_types.h"
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Debug and trace registers.  These are part of the ARMv7-M system control
+// space and are not described by the TivaWare inc/ headers.
+//
+//*****************************************************************************
+#define CYCLE_DEMCR             0xE000EDFC  // Debug Exception Monitor Control
+#define CYCLE_DEMCR_TRCENA      0x01000000  // Enable DWT and ITM blocks
+#define CYCLE_DWT_CTRL          0xE0001000  // DWT Control
+#define CYCLE_DWT_CTRL_CYCCNTENA                                              \
+                                0x00000001  // Enable the cycle counter
+#define CYCLE_DWT_CYCCNT        0xE0001004  // DWT Cycle Count
+
+//*****************************************************************************
+//
+// Whether the count includes the cycles of computation.  Off the target the
+// counter is the host simulation's, which only advances for peripheral
+// accesses and calls, so a difference across pure code says nothing.
+//
+//*****************************************************************************
+#if defined(__arm__)
+#define CYCLE_COUNTER_TIMES_CODE 1
+#else
+#define CYCLE_COUNTER_TIMES_CODE 0
+#endif
+
+//*****************************************************************************
+//
+// Starts the free running cycle counter.  Safe to call more than once; the
+// count is not reset, so the boot timeline (boot_profile.c) survives later
+// callers.
+//
+//*****************************************************************************
+static inline void
+CycleCounterInit(void)
+{
+    HWREG(CYCLE_DEMCR) |= CYCLE_DEMCR_TRCENA;
+    HWREG(CYCLE_DWT_CTRL) |= CYCLE_DWT_CTRL_CYCCNTENA;
+}
+
+//*****************************************************************************
+//
+// Returns the current cycle count.  Differences between two readings are
+// correct across a single 32-bit wrap (about 35 s at 120 MHz).
+//
+//*****************************************************************************
+static inline uint32_t
+CycleCounterGet(void)
+{
+    return(HWREG(CYCLE_DWT_CYCCNT));
+}
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CYCLE_COUNTER_H__
@@ -0,0 +1,542 @@
+//*****************************************************************************
+//
+// defer.c - Work posted by interrupt handlers and run by a worker task.
+//
+// A handler posts a function and its arguments instead of doing the work
+// itself, and returns.  Records go into a fixed ring that any number of
+// handlers, at any priorities, add to without masking interrupts: a producer
+// claims a slot by advancing the head with a compare-and-swap, fills it in,
+// then publishes it through the slot's sequence number.  One worker task
+// takes records off the tail in order.  The ring carries the records
+// themselves, so a post costs a few dozen cycles and no kernel call, where
+// xTimerPendFunctionCallFromISR() costs a queue send.
+//
+// The worker is only notified when it has gone to sleep.  It sets a flag
+// before it blocks and checks the ring once more; a producer that finds the
+// flag set clears it and gives the notification.  A burst of posts therefore
+// costs one wake, and the worker runs the whole burst in batches of
+// DEFER_BATCH, yielding between batches.
+//
+// A DeferSource_t merges the posts of one interrupt that arrive before its
+// handler has run, so a noisy source takes one slot however often it fires,
+// and keeps counts and latencies for DeferStatsPrint().
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "utils/uartstdio.h"
+#include "task_stacks.h"
+#include "drivers/cycle_counter.h"
+#include "drivers/defer.h"
+
+#define DEFER_RING_MASK         (DEFER_RING_SIZE - 1)
+
+//*****************************************************************************
+//
+// One slot of the ring.  ui32Seq equals the slot's position while it is free
+// for that lap, and the position plus one once its record is ready.
+//
+//*****************************************************************************
+typedef struct
+{
+    volatile uint32_t ui32Seq;
+    DeferFn_t pfnFunc;
+    void *pvArg;
+    uint32_t ui32Arg;
+    uint32_t ui32Stamp;
+}
+DeferRecord_t;
+
+static DeferRecord_t g_psDeferRing[DEFER_RING_SIZE];
+static volatile uint32_t g_ui32DeferHead;
+static uint32_t g_ui32DeferTail;
+
+//*****************************************************************************
+//
+// The worker, and whether it is asleep waiting for a notification.
+//
+//*****************************************************************************
+static TaskHandle_t g_xDeferTask;
+static volatile uint32_t g_ui32DeferIdle;
+
+//*****************************************************************************
+//
+// Statistics over all records, and the registered sources.
+//
+//*****************************************************************************
+static volatile uint32_t g_ui32DeferPosts;
+static volatile uint32_t g_ui32DeferDrops;
+static uint32_t g_ui32DeferMaxLatency;
+static uint32_t g_ui32DeferMaxBatch;
+static uint32_t g_ui32DeferMaxQueued;
+static DeferSource_t *g_psDeferSources;
+
+//*****************************************************************************
+//
+// Adds a record to the ring and wakes the worker if it is asleep.  Returns
+// false if the ring is full.
+//
+//*****************************************************************************
+static bool
+prvPush(DeferFn_t pfnFunc, void *pvArg, uint32_t ui32Arg, uint32_t ui32Stamp,
+        BaseType_t *pxHigherPriorityTaskWoken)
+{
+    DeferRecord_t *psRec;
+    uint32_t ui32Pos;
+    int32_t i32Diff;
+
+    ui32Pos = __atomic_load_n(&g_ui32DeferHead, __ATOMIC_RELAXED);
+    for(;;)
+    {
+        psRec = &g_psDeferRing[ui32Pos & DEFER_RING_MASK];
+        i32Diff = (int32_t)(__atomic_load_n(&psRec->ui32Seq, __ATOMIC_ACQUIRE) -
+                            ui32Pos);
+        if(i32Diff == 0)
+        {
+            //
+            // The slot is free for this lap.  Claim it, unless a handler
+            // that preempted this one got there first.
+            //
+            if(__atomic_compare_exchange_n(&g_ui32DeferHead, &ui32Pos,
+                                           ui32Pos + 1, true, __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if(i32Diff < 0)
+        {
+            __atomic_fetch_add(&g_ui32DeferDrops, 1, __ATOMIC_RELAXED);
+            return(false);
+        }
+        else
+        {
+            ui32Pos = __atomic_load_n(&g_ui32DeferHead, __ATOMIC_RELAXED);
+        }
+    }
+
+    psRec->pfnFunc = pfnFunc;
+    psRec->pvArg = pvArg;
+    psRec->ui32Arg = ui32Arg;
+    psRec->ui32Stamp = ui32Stamp;
+    __atomic_store_n(&psRec->ui32Seq, ui32Pos + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&g_ui32DeferPosts, 1, __ATOMIC_RELAXED);
+
+    if(__atomic_exchange_n(&g_ui32DeferIdle, 0, __ATOMIC_ACQ_REL))
+    {
+        vTaskNotifyGiveFromISR(g_xDeferTask, pxHigherPriorityTaskWoken);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Takes the record at the tail off the ring.  Returns false if it has not
+// been published yet.  Only the worker calls this.
+//
+//*****************************************************************************
+static bool
+prvPop(DeferRecord_t *psOut)
+{
+    DeferRecord_t *psRec = &g_psDeferRing[g_ui32DeferTail & DEFER_RING_MASK];
+
+    if(__atomic_load_n(&psRec->ui32Seq, __ATOMIC_ACQUIRE) !=
+       g_ui32DeferTail + 1)
+    {
+        return(false);
+    }
+
+    psOut->pfnFunc = psRec->pfnFunc;
+    psOut->pvArg = psRec->pvArg;
+    psOut->ui32Arg = psRec->ui32Arg;
+    psOut->ui32Stamp = psRec->ui32Stamp;
+    __atomic_store_n(&psRec->ui32Seq, g_ui32DeferTail + DEFER_RING_SIZE,
+                     __ATOMIC_RELEASE);
+    g_ui32DeferTail++;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Runs a source's handler with the bits posted since it last ran.  This is
+// the function a source's records carry.
+//
+//*****************************************************************************
+static void
+prvSourceRun(void *pvArg, uint32_t ui32Arg)
+{
+    DeferSource_t *psSource = pvArg;
+    uint32_t ui32Stamp, ui32Bits, ui32Start;
+
+    (void)ui32Arg;
+
+    //
+    // Read the stamp before taking the bits: a post after the exchange
+    // starts a new record and writes its own stamp.
+    //
+    ui32Stamp = psSource->ui32Stamp;
+    ui32Bits = __atomic_exchange_n(&psSource->ui32Pending, 0,
+                                   __ATOMIC_ACQ_REL);
+    if(ui32Bits == 0)
+    {
+        return;
+    }
+
+    ui32Start = CycleCounterGet();
+    if((ui32Start - ui32Stamp) > psSource->ui32MaxLatency)
+    {
+        psSource->ui32MaxLatency = ui32Start - ui32Stamp;
+    }
+
+    psSource->pfnHandler(psSource->pvArg, ui32Bits);
+
+    psSource->ui32Runs++;
+    if((CycleCounterGet() - ui32Start) > psSource->ui32MaxRun)
+    {
+        psSource->ui32MaxRun = CycleCounterGet() - ui32Start;
+    }
+}
+
+//*****************************************************************************
+//
+// The worker.  Runs records in batches until the ring is empty, then sleeps.
+//
+//*****************************************************************************
+static void
+prvDeferTask(void *pvParameters)
+{
+    DeferRecord_t sRec;
+    uint32_t ui32Batch, ui32Queued;
+
+    (void)pvParameters;
+
+    for(;;)
+    {
+        ui32Queued = __atomic_load_n(&g_ui32DeferHead, __ATOMIC_RELAXED) -
+                     g_ui32DeferTail;
+        if(ui32Queued > g_ui32DeferMaxQueued)
+        {
+            g_ui32DeferMaxQueued = ui32Queued;
+        }
+
+        for(ui32Batch = 0; (ui32Batch < DEFER_BATCH) && prvPop(&sRec);
+            ui32Batch++)
+        {
+            if((CycleCounterGet() - sRec.ui32Stamp) > g_ui32DeferMaxLatency)
+            {
+                g_ui32DeferMaxLatency = CycleCounterGet() - sRec.ui32Stamp;
+            }
+            sRec.pfnFunc(sRec.pvArg, sRec.ui32Arg);
+        }
+
+        if(ui32Batch > g_ui32DeferMaxBatch)
+        {
+            g_ui32DeferMaxBatch = ui32Batch;
+        }
+
+        if(ui32Batch == DEFER_BATCH)
+        {
+            taskYIELD();
+            continue;
+        }
+
+        //
+        // Nothing ready.  Announce the sleep, then look once more, so a post
+        // that landed in between is either seen here or wakes the task.  A
+        // slot claimed but not yet published by a preempted handler is left
+        // to that handler, which wakes the task once it publishes.
+        //
+        __atomic_store_n(&g_ui32DeferIdle, 1, __ATOMIC_SEQ_CST);
+        if(__atomic_load_n(&g_psDeferRing[g_ui32DeferTail &
+                                          DEFER_RING_MASK].ui32Seq,
+                           __ATOMIC_ACQUIRE) == g_ui32DeferTail + 1)
+        {
+            __atomic_store_n(&g_ui32DeferIdle, 0, __ATOMIC_RELAXED);
+            continue;
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+//*****************************************************************************
+//
+//! Initializes the ring and creates the worker task.
+//!
+//! Must be called before any handler posts, but may be called before the
+//! scheduler starts; records posted before then are run when it does.
+//!
+//! \return Returns \b false if the worker could not be created.
+//
+//*****************************************************************************
+bool
+DeferInit(void)
+{
+    uint32_t ui32Idx;
+
+    CycleCounterInit();
+
+    for(ui32Idx = 0; ui32Idx < DEFER_RING_SIZE; ui32Idx++)
+    {
+        g_psDeferRing[ui32Idx].ui32Seq = ui32Idx;
+    }
+    g_ui32DeferHead = 0;
+    g_ui32DeferTail = 0;
+    g_ui32DeferIdle = 0;
+
+    return(xTaskCreate(prvDeferTask, "Defer", TASK_STACK_DEFER, NULL,
+                       DEFER_TASK_PRIORITY, &g_xDeferTask) == pdPASS);
+}
+
+//*****************************************************************************
+//
+//! Adds a source to the statistics list.
+//!
+//! \param psSource is the source, with its name, handler and argument set.
+//!
+//! Call from a task, or before the scheduler starts, and before the source's
+//! interrupt is enabled.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DeferSourceRegister(DeferSource_t *psSource)
+{
+    psSource->ui32Pending = 0;
+    taskENTER_CRITICAL();
+    psSource->psNext = g_psDeferSources;
+    g_psDeferSources = psSource;
+    taskEXIT_CRITICAL();
+}
+
+//*****************************************************************************
+//
+//! Posts a function to run in the worker task.
+//!
+//! \param pfnFunc is the function.
+//! \param pvArg and \e ui32Arg are passed to it.
+//! \param pxHigherPriorityTaskWoken is set to \b pdTRUE if the worker was
+//! woken, as for the kernel's FromISR calls; pass it to portYIELD_FROM_ISR()
+//! at the end of the handler.
+//!
+//! Every post runs once, in order.  May be called from any interrupt at or
+//! below configMAX_SYSCALL_INTERRUPT_PRIORITY, or from a task.
+//!
+//! \return Returns \b false if the ring was full and the post was dropped.
+//
+//*****************************************************************************
+bool
+DeferPostFromISR(DeferFn_t pfnFunc, void *pvArg, uint32_t ui32Arg,
+                 BaseType_t *pxHigherPriorityTaskWoken)
+{
+    return(prvPush(pfnFunc, pvArg, ui32Arg, CycleCounterGet(),
+                   pxHigherPriorityTaskWoken));
+}
+
+//*****************************************************************************
+//
+//! Posts to a coalescing source.
+//!
+//! \param psSource is the source.
+//! \param ui32Bits is ORed into the argument its handler next runs with; it
+//! must not be 0.
+//! \param pxHigherPriorityTaskWoken is as for DeferPostFromISR().
+//!
+//! If the source already has a post waiting, the bits are merged into it and
+//! nothing is queued.
+//!
+//! \return Returns \b false if the ring was full; the waiting bits are then
+//! dropped and the source is free for the next post.
+//
+//*****************************************************************************
+bool
+DeferSourcePostFromISR(DeferSource_t *psSource, uint32_t ui32Bits,
+                       BaseType_t *pxHigherPriorityTaskWoken)
+{
+    uint32_t ui32Stamp = CycleCounterGet();
+
+    __atomic_fetch_add(&psSource->ui32Posts, 1, __ATOMIC_RELAXED);
+    if(__atomic_fetch_or(&psSource->ui32Pending, ui32Bits,
+                         __ATOMIC_ACQ_REL) != 0)
+    {
+        return(true);
+    }
+
+    psSource->ui32Stamp = ui32Stamp;
+    if(!prvPush(prvSourceRun, psSource, 0, ui32Stamp,
+                pxHigherPriorityTaskWoken))
+    {
+        __atomic_exchange_n(&psSource->ui32Pending, 0, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&psSource->ui32Drops, 1, __ATOMIC_RELAXED);
+        return(false);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Prints the worker and per-source statistics on the console.
+//!
+//! Latencies and run times are in cycles.  Posts less runs less drops is the
+//! number of posts a source merged.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DeferStatsPrint(void)
+{
+    DeferSource_t *psSource;
+
+    UARTprintf("-- deferred work: %d records, %d dropped, max %d queued, "
+               "max batch %d, max latency %d --\n", g_ui32DeferPosts,
+               g_ui32DeferDrops, g_ui32DeferMaxQueued, g_ui32DeferMaxBatch,
+               g_ui32DeferMaxLatency);
+    UARTprintf("source        posts   runs  drops  max lat  max run\n");
+    for(psSource = g_psDeferSources; psSource; psSource = psSource->psNext)
+    {
+        UARTprintf("%-12s %6d %6d %6d %8d %8d\n", psSource->pcName,
+                   psSource->ui32Posts, psSource->ui32Runs,
+                   psSource->ui32Drops, psSource->ui32MaxLatency,
+                   psSource->ui32MaxRun);
+    }
+}
+
+//*****************************************************************************
+//
+// Benchmark.  The queue send carries the same record the timer service's
+// pended function calls do, which is what xTimerPendFunctionCallFromISR()
+// costs on top of waking the daemon.
+//
+//*****************************************************************************
+#define DEFER_BENCH_LOOPS       16
+
+typedef struct
+{
+    DeferFn_t pfnFunc;
+    void *pvArg;
+    uint32_t ui32Arg;
+}
+DeferBenchCall_t;
+
+static void
+prvBenchNop(void *pvArg, uint32_t ui32Arg)
+{
+    (void)pvArg;
+    (void)ui32Arg;
+}
+
+static DeferSource_t g_sDeferBenchSource = { "bench", prvBenchNop, NULL };
+
+//*****************************************************************************
+//
+//! Prints the cycle cost of a post on the console, next to the kernel
+//! primitives a handler would otherwise use.
+//!
+//! Each call is timed on its own with interrupts masked, less the cost of
+//! reading the cycle counter.  Must be called from a task, after DeferInit().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+vDeferBenchmark(void)
+{
+    SemaphoreHandle_t xSem;
+    QueueHandle_t xQueue;
+    DeferBenchCall_t sCall = { prvBenchNop, NULL, 0 };
+    BaseType_t xWoken = pdFALSE;
+    uint32_t ui32Idx, ui32Start, ui32Base, ui32Sem = 0, ui32Queue = 0;
+    uint32_t ui32Wake = 0, ui32Post = 0, ui32Merge = 0;
+
+    xSem = xSemaphoreCreateBinary();
+    xQueue = xQueueCreate(DEFER_BENCH_LOOPS, sizeof(DeferBenchCall_t));
+    if(!xSem || !xQueue)
+    {
+        UARTprintf("Deferred work benchmark: out of heap\n");
+        if(xSem)
+        {
+            vSemaphoreDelete(xSem);
+        }
+        if(xQueue)
+        {
+            vQueueDelete(xQueue);
+        }
+        return;
+    }
+    DeferSourceRegister(&g_sDeferBenchSource);
+
+    taskENTER_CRITICAL();
+    ui32Start = CycleCounterGet();
+    ui32Base = CycleCounterGet() - ui32Start;
+    for(ui32Idx = 0; ui32Idx < DEFER_BENCH_LOOPS; ui32Idx++)
+    {
+        ui32Start = CycleCounterGet();
+        xSemaphoreGiveFromISR(xSem, &xWoken);
+        ui32Sem += CycleCounterGet() - ui32Start - ui32Base;
+        xSemaphoreTake(xSem, 0);
+
+        ui32Start = CycleCounterGet();
+        xQueueSendFromISR(xQueue, &sCall, &xWoken);
+        ui32Queue += CycleCounterGet() - ui32Start - ui32Base;
+    }
+    taskEXIT_CRITICAL();
+
+    //
+    // Posts to a sleeping worker, each of which wakes it.  It runs as soon as
+    // interrupts are unmasked and is asleep again before the next.
+    //
+    for(ui32Idx = 0; ui32Idx < DEFER_BENCH_LOOPS; ui32Idx++)
+    {
+        taskENTER_CRITICAL();
+        ui32Start = CycleCounterGet();
+        DeferPostFromISR(prvBenchNop, NULL, 0, &xWoken);
+        ui32Wake += CycleCounterGet() - ui32Start - ui32Base;
+        taskEXIT_CRITICAL();
+        taskYIELD();
+    }
+
+    //
+    // Posts behind one that has already woken the worker, and posts merged
+    // into one already waiting.
+    //
+    taskENTER_CRITICAL();
+    DeferPostFromISR(prvBenchNop, NULL, 0, &xWoken);
+    for(ui32Idx = 0; ui32Idx < DEFER_BENCH_LOOPS; ui32Idx++)
+    {
+        ui32Start = CycleCounterGet();
+        DeferPostFromISR(prvBenchNop, NULL, 0, &xWoken);
+        ui32Post += CycleCounterGet() - ui32Start - ui32Base;
+    }
+    DeferSourcePostFromISR(&g_sDeferBenchSource, 1, &xWoken);
+    for(ui32Idx = 0; ui32Idx < DEFER_BENCH_LOOPS; ui32Idx++)
+    {
+        ui32Start = CycleCounterGet();
+        DeferSourcePostFromISR(&g_sDeferBenchSource, 1 << ui32Idx, &xWoken);
+        ui32Merge += CycleCounterGet() - ui32Start - ui32Base;
+    }
+    taskEXIT_CRITICAL();
+    taskYIELD();
+
+    UARTprintf("path                      cycles\n");
+    UARTprintf("%-24s %7d\n", "semaphore give", ui32Sem / DEFER_BENCH_LOOPS);
+    UARTprintf("%-24s %7d\n", "queue send (pend call)",
+               ui32Queue / DEFER_BENCH_LOOPS);
+    UARTprintf("%-24s %7d\n", "defer post, wakes task",
+               ui32Wake / DEFER_BENCH_LOOPS);
+    UARTprintf("%-24s %7d\n", "defer post", ui32Post / DEFER_BENCH_LOOPS);
+    UARTprintf("%-24s %7d\n", "defer post, merged",
+               ui32Merge / DEFER_BENCH_LOOPS);
+
+    vSemaphoreDelete(xSem);
+    vQueueDelete(xQueue);
+}
@@ -0,0 +1,93 @@
+//*****************************************************************************
+//
+// defer.h - Work posted by interrupt handlers and run by a worker task.
+//
+//*****************************************************************************
+
+#ifndef __DEFER_H__
+#define __DEFER_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The number of records the ring holds, a power of two; the number the
+// worker runs before it lets other tasks at its priority in; and the
+// worker's priority.  The worker runs what would otherwise have been done in
+// the handlers, so it sits above every application task.
+//
+//*****************************************************************************
+#define DEFER_RING_SIZE         32
+#define DEFER_BATCH             8
+#define DEFER_TASK_PRIORITY     (configMAX_PRIORITIES - 1)
+
+//*****************************************************************************
+//
+// A deferred function.  It runs in the worker task and may block, though
+// that holds up all the work queued behind it.
+//
+//*****************************************************************************
+typedef void (*DeferFn_t)(void *pvArg, uint32_t ui32Arg);
+
+//*****************************************************************************
+//
+// A source of coalesced work, such as one interrupt.  Posts to a source that
+// has not run yet are merged: their argument bits are ORed together and the
+// handler runs once with the lot.  The counts are kept for DeferStatsPrint();
+// latencies are in cycles from the first merged post to the handler
+// starting.
+//
+// Set pcName, pfnHandler and pvArg, the rest zeroed, and pass it to
+// DeferSourceRegister() before the first post.
+//
+//*****************************************************************************
+typedef struct DeferSource
+{
+    const char *pcName;
+    DeferFn_t pfnHandler;
+    void *pvArg;
+    volatile uint32_t ui32Pending;
+    volatile uint32_t ui32Stamp;
+    volatile uint32_t ui32Posts;
+    volatile uint32_t ui32Drops;
+    uint32_t ui32Runs;
+    uint32_t ui32MaxLatency;
+    uint32_t ui32MaxRun;
+    struct DeferSource *psNext;
+}
+DeferSource_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern bool DeferInit(void);
+extern void DeferSourceRegister(DeferSource_t *psSource);
+extern bool DeferPostFromISR(DeferFn_t pfnFunc, void *pvArg,
+                             uint32_t ui32Arg,
+                             BaseType_t *pxHigherPriorityTaskWoken);
+extern bool DeferSourcePostFromISR(DeferSource_t *psSource, uint32_t ui32Bits,
+                                   BaseType_t *pxHigherPriorityTaskWoken);
+extern void DeferStatsPrint(void);
+extern void vDeferBenchmark(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DEFER_H__
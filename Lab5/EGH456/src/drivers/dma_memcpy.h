@@ -0,0 +1,81 @@
+//*****************************************************************************
+//
+// dma_memcpy.h - Asynchronous memory copy and fill using uDMA software
+//                channels.
+//
+//*****************************************************************************
+
+#ifndef __DMA_MEMCPY_H__
+#define __DMA_MEMCPY_H__
+
+#include <stddef.h>
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Copies shorter than this are done on the CPU, in the caller's context.  The
+// set-up cost of a uDMA transfer plus its completion interrupt is larger than
+// a CPU copy of this many bytes (see vDmaMemcpyBenchmark()).
+//
+//*****************************************************************************
+#define DMA_COPY_MIN_BYTES      128
+
+//*****************************************************************************
+//
+// The largest number of scatter-gather tasks a single request may expand to.
+// Each task moves up to 1024 items, so a word aligned copy may be up to
+// DMA_COPY_MAX_TASKS * 4 KB long.
+//
+//*****************************************************************************
+#define DMA_COPY_MAX_TASKS      8
+
+//*****************************************************************************
+//
+// One segment of a chained copy.  A segment with pvSrc set to NULL is a fill
+// of ui8Fill rather than a copy.
+//
+//*****************************************************************************
+typedef struct
+{
+    void *pvDst;
+    const void *pvSrc;
+    size_t xLen;
+    uint8_t ui8Fill;
+}
+DmaCopySegment_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void vDmaMemcpyInit(void);
+extern BaseType_t xDmaMemcpy(void *pvDst, const void *pvSrc, size_t xLen,
+                             TaskHandle_t xNotify);
+extern BaseType_t xDmaMemset(void *pvDst, uint8_t ui8Value, size_t xLen,
+                             TaskHandle_t xNotify);
+extern BaseType_t xDmaMemcpyChain(const DmaCopySegment_t *pxSegments,
+                                  uint32_t ui32Count, TaskHandle_t xNotify);
+extern void uDMASoftwareIntHandler(void);
+extern void vDmaMemcpyBenchmark(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DMA_MEMCPY_H__
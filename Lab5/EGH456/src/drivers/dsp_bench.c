@@ -0,0 +1,243 @@
+//*****************************************************************************
+//
+// dsp_bench.c - Cycle benchmark for the Q15 kernels.
+//
+// The kernels themselves are in dsp_q15.c, which has no target dependencies
+// so that it can be built on a host.  This runs each kernel over the same
+// block with the portable reference and the SIMD version, prints the cycles
+// per input sample of each and checks that the outputs agree to the bit.
+// Where the cycle counter does not time code (see cycle_counter.h) only the
+// check is printed.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "utils/uartstdio.h"
+#include "drivers/cycle_counter.h"
+#include "drivers/dsp_q15.h"
+
+//*****************************************************************************
+//
+// Block size and filter shapes.
+//
+//*****************************************************************************
+#define DSP_BENCH_BLOCK         256
+#define DSP_BENCH_FIR_TAPS      32
+#define DSP_BENCH_DECIMATE      4
+#define DSP_BENCH_STAGES        2
+
+//
+// A second order Butterworth low-pass at a tenth of the sample rate, in Q14,
+// used for both sections.
+//
+static const int16_t g_pi16DspBenchBiquad[DSP_BENCH_STAGES *
+                                          DSP_BIQUAD_COEFFS] =
+{
+    1106, 2212, 1106, 18727, -6763,
+    1106, 2212, 1106, 18727, -6763,
+};
+
+static int16_t g_pi16DspBenchFir[DSP_BENCH_FIR_TAPS];
+static int16_t g_pi16DspBenchIn[DSP_BENCH_BLOCK];
+static int16_t g_pi16DspBenchRef[DSP_BENCH_BLOCK];
+static int16_t g_pi16DspBenchOut[DSP_BENCH_BLOCK];
+static int16_t g_pi16DspBenchState[DSP_FIR_STATE_SIZE(DSP_BENCH_FIR_TAPS,
+                                                      DSP_BENCH_BLOCK)];
+
+//*****************************************************************************
+//
+// Prints one row: the cycles per input sample of each version, to two
+// decimal places, or only whether they agree.
+//
+//*****************************************************************************
+static void
+prvBenchRow(const char *pcName, uint32_t ui32Ref, uint32_t ui32Simd, bool bOk)
+{
+#if CYCLE_COUNTER_TIMES_CODE
+    ui32Ref = (ui32Ref * 100) / DSP_BENCH_BLOCK;
+    ui32Simd = (ui32Simd * 100) / DSP_BENCH_BLOCK;
+    UARTprintf("%14s %5d.%02d %5d.%02d%s\n", pcName,
+               ui32Ref / 100, ui32Ref % 100, ui32Simd / 100, ui32Simd % 100,
+               bOk ? "" : "  MISMATCH");
+#else
+    (void)ui32Ref;
+    (void)ui32Simd;
+    UARTprintf("%14s  %s\n", pcName, bOk ? "matches" : "MISMATCH");
+#endif
+}
+
+//*****************************************************************************
+//
+// Times both versions of a FIR filter with the given decimation.
+//
+//*****************************************************************************
+static void
+prvBenchFir(const char *pcName, uint32_t ui32Decimate)
+{
+    DspFir_t sFir;
+    uint32_t ui32Start, ui32Ref, ui32Simd, ui32NumOut;
+
+    taskENTER_CRITICAL();
+
+    DspFirInit(&sFir, g_pi16DspBenchFir, DSP_BENCH_FIR_TAPS, ui32Decimate,
+               g_pi16DspBenchState, DSP_BENCH_BLOCK);
+    ui32Start = CycleCounterGet();
+    ui32NumOut = DspFirQ15Ref(&sFir, g_pi16DspBenchIn, g_pi16DspBenchRef,
+                              DSP_BENCH_BLOCK);
+    ui32Ref = CycleCounterGet() - ui32Start;
+
+    DspFirInit(&sFir, g_pi16DspBenchFir, DSP_BENCH_FIR_TAPS, ui32Decimate,
+               g_pi16DspBenchState, DSP_BENCH_BLOCK);
+    ui32Start = CycleCounterGet();
+    DspFirQ15(&sFir, g_pi16DspBenchIn, g_pi16DspBenchOut, DSP_BENCH_BLOCK);
+    ui32Simd = CycleCounterGet() - ui32Start;
+
+    taskEXIT_CRITICAL();
+
+    prvBenchRow(pcName, ui32Ref, ui32Simd,
+                memcmp(g_pi16DspBenchRef, g_pi16DspBenchOut,
+                       ui32NumOut * sizeof(int16_t)) == 0);
+}
+
+//*****************************************************************************
+//
+//! Prints the cycle cost of the Q15 kernels on the console.
+//!
+//! Each kernel runs once over a block of DSP_BENCH_BLOCK pseudo-random
+//! samples with interrupts masked.  The FIR rows count input samples, so the
+//! decimating filter computes a quarter of the outputs.  When the build has
+//! no DSP instructions both columns time the reference; when the cycle
+//! counter does not time code, as on the host, the columns are left out and
+//! each row only says whether the versions agree.  Must be called from a
+//! task.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+vDspBenchmark(void)
+{
+    DspBiquad_t sBiquad;
+    int16_t pi16BiquadState[DSP_BENCH_STAGES * DSP_BIQUAD_STATE];
+    uint32_t ui32Idx, ui32Seed, ui32Start, ui32Ref, ui32Simd;
+    int64_t i64Ref, i64Simd;
+    int16_t i16RefMin, i16RefMax, i16Min, i16Max;
+
+    CycleCounterInit();
+
+    //
+    // Full scale noise for the input and a triangular low-pass for the FIR.
+    //
+    ui32Seed = 1;
+    for(ui32Idx = 0; ui32Idx < DSP_BENCH_BLOCK; ui32Idx++)
+    {
+        ui32Seed = (ui32Seed * 1664525) + 1013904223;
+        g_pi16DspBenchIn[ui32Idx] = (int16_t)(ui32Seed >> 16);
+    }
+    for(ui32Idx = 0; ui32Idx < DSP_BENCH_FIR_TAPS; ui32Idx++)
+    {
+        g_pi16DspBenchFir[ui32Idx] =
+            (ui32Idx < DSP_BENCH_FIR_TAPS / 2) ?
+            (int16_t)((ui32Idx + 1) * 120) :
+            (int16_t)((DSP_BENCH_FIR_TAPS - ui32Idx) * 120);
+    }
+
+#if CYCLE_COUNTER_TIMES_CODE
+    UARTprintf("kernel               ref      dsp  (cycles/sample)\n");
+#else
+    UARTprintf("kernel          ref against dsp\n");
+#endif
+
+    prvBenchFir("fir 32", 1);
+    prvBenchFir("fir 32 /4", DSP_BENCH_DECIMATE);
+
+    //
+    // Biquad cascade.
+    //
+    taskENTER_CRITICAL();
+    DspBiquadInit(&sBiquad, g_pi16DspBenchBiquad, DSP_BENCH_STAGES,
+                  pi16BiquadState);
+    ui32Start = CycleCounterGet();
+    DspBiquadQ15Ref(&sBiquad, g_pi16DspBenchIn, g_pi16DspBenchRef,
+                    DSP_BENCH_BLOCK);
+    ui32Ref = CycleCounterGet() - ui32Start;
+
+    DspBiquadInit(&sBiquad, g_pi16DspBenchBiquad, DSP_BENCH_STAGES,
+                  pi16BiquadState);
+    ui32Start = CycleCounterGet();
+    DspBiquadQ15(&sBiquad, g_pi16DspBenchIn, g_pi16DspBenchOut,
+                 DSP_BENCH_BLOCK);
+    ui32Simd = CycleCounterGet() - ui32Start;
+    taskEXIT_CRITICAL();
+    prvBenchRow("biquad x2", ui32Ref, ui32Simd,
+                memcmp(g_pi16DspBenchRef, g_pi16DspBenchOut,
+                       sizeof(g_pi16DspBenchOut)) == 0);
+
+    //
+    // Dot product of the input with the biquad output.
+    //
+    taskENTER_CRITICAL();
+    ui32Start = CycleCounterGet();
+    i64Ref = DspDotQ15Ref(g_pi16DspBenchIn, g_pi16DspBenchRef,
+                          DSP_BENCH_BLOCK);
+    ui32Ref = CycleCounterGet() - ui32Start;
+    ui32Start = CycleCounterGet();
+    i64Simd = DspDotQ15(g_pi16DspBenchIn, g_pi16DspBenchRef,
+                        DSP_BENCH_BLOCK);
+    ui32Simd = CycleCounterGet() - ui32Start;
+    taskEXIT_CRITICAL();
+    prvBenchRow("dot", ui32Ref, ui32Simd, i64Ref == i64Simd);
+
+    //
+    // Min and max.
+    //
+    taskENTER_CRITICAL();
+    ui32Start = CycleCounterGet();
+    DspMinMaxQ15Ref(g_pi16DspBenchIn, DSP_BENCH_BLOCK, &i16RefMin,
+                    &i16RefMax);
+    ui32Ref = CycleCounterGet() - ui32Start;
+    ui32Start = CycleCounterGet();
+    DspMinMaxQ15(g_pi16DspBenchIn, DSP_BENCH_BLOCK, &i16Min, &i16Max);
+    ui32Simd = CycleCounterGet() - ui32Start;
+    taskEXIT_CRITICAL();
+    prvBenchRow("min/max", ui32Ref, ui32Simd,
+                (i16RefMin == i16Min) && (i16RefMax == i16Max));
+
+    //
+    // Scale by 0.75 * 4, which saturates about half the samples.
+    //
+    taskENTER_CRITICAL();
+    ui32Start = CycleCounterGet();
+    DspScaleQ15Ref(g_pi16DspBenchIn, g_pi16DspBenchRef, DSP_BENCH_BLOCK,
+                   24576, 2);
+    ui32Ref = CycleCounterGet() - ui32Start;
+    ui32Start = CycleCounterGet();
+    DspScaleQ15(g_pi16DspBenchIn, g_pi16DspBenchOut, DSP_BENCH_BLOCK,
+                24576, 2);
+    ui32Simd = CycleCounterGet() - ui32Start;
+    taskEXIT_CRITICAL();
+    prvBenchRow("scale", ui32Ref, ui32Simd,
+                memcmp(g_pi16DspBenchRef, g_pi16DspBenchOut,
+                       sizeof(g_pi16DspBenchOut)) == 0);
+
+    //
+    // Offset, also saturating.
+    //
+    taskENTER_CRITICAL();
+    ui32Start = CycleCounterGet();
+    DspOffsetQ15Ref(g_pi16DspBenchIn, g_pi16DspBenchRef, DSP_BENCH_BLOCK,
+                    -12000);
+    ui32Ref = CycleCounterGet() - ui32Start;
+    ui32Start = CycleCounterGet();
+    DspOffsetQ15(g_pi16DspBenchIn, g_pi16DspBenchOut, DSP_BENCH_BLOCK,
+                 -12000);
+    ui32Simd = CycleCounterGet() - ui32Start;
+    taskEXIT_CRITICAL();
+    prvBenchRow("offset", ui32Ref, ui32Simd,
+                memcmp(g_pi16DspBenchRef, g_pi16DspBenchOut,
+                       sizeof(g_pi16DspBenchOut)) == 0);
+}
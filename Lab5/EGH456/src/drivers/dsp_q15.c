@@ -0,0 +1,678 @@
+//*****************************************************************************
+//
+// dsp_q15.c - Q15 filter and block kernels using the Cortex-M4 DSP
+//             instructions, with portable C references.
+//
+// Samples and coefficients are signed 16-bit fractions.  The M4 SIMD
+// instructions work on two of them packed in one register: SMLALD multiplies
+// both halves and adds both products to a 64-bit accumulator in one cycle,
+// SSUB16 and SEL compare and select two samples at once, QADD16 adds two with
+// saturation, and SSAT clamps a result to 16 bits without a branch.  Pairs
+// are loaded with one word access; the M4 allows these to be unaligned.
+//
+// Every kernel also has a plain C version, ...Ref(), that uses 64-bit
+// arithmetic where the instructions do and so gives the same result to the
+// bit.  It is what a host build compiles (DSP_USE_SIMD is 0 there) and what
+// the benchmark checks the SIMD versions against.
+//
+// Accumulators are 64-bit, so a dot product or FIR of up to 65536 taps cannot
+// overflow.  Results are rounded to nearest and saturated.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "drivers/dsp_q15.h"
+
+//*****************************************************************************
+//
+// Saturates a value to a signed 16-bit sample.
+//
+//*****************************************************************************
+static inline int16_t
+prvSat16(int32_t i32Val)
+{
+    if(i32Val > 32767)
+    {
+        return(32767);
+    }
+    if(i32Val < -32768)
+    {
+        return(-32768);
+    }
+    return((int16_t)i32Val);
+}
+
+//*****************************************************************************
+//
+// Scalar kernels shared by the reference and SIMD versions.
+//
+//*****************************************************************************
+static inline int64_t
+prvDotRef(const int16_t *pi16A, const int16_t *pi16B, uint32_t ui32Count)
+{
+    int64_t i64Acc = 0;
+
+    while(ui32Count--)
+    {
+        i64Acc += (int32_t)*pi16A++ * *pi16B++;
+    }
+    return(i64Acc);
+}
+
+//
+// Runs one biquad section over a block, with the state in pi16State and the
+// feedforward and feedback coefficients in pi16Coeffs.
+//
+static void
+prvBiquadStageRef(const int16_t *pi16Coeffs, int16_t *pi16State,
+                  const int16_t *pi16In, int16_t *pi16Out, uint32_t ui32Count)
+{
+    int32_t i32B0 = pi16Coeffs[0], i32B1 = pi16Coeffs[1];
+    int32_t i32B2 = pi16Coeffs[2], i32A1 = pi16Coeffs[3];
+    int32_t i32A2 = pi16Coeffs[4];
+    int16_t i16X1 = pi16State[0], i16X2 = pi16State[1];
+    int16_t i16Y1 = pi16State[2], i16Y2 = pi16State[3];
+    int16_t i16X0, i16Y0;
+    int64_t i64Acc;
+
+    while(ui32Count--)
+    {
+        i16X0 = *pi16In++;
+        i64Acc = (int64_t)(i32B0 * i16X0) + (i32B1 * i16X1) +
+                 (i32B2 * i16X2) + (i32A1 * i16Y1) + (i32A2 * i16Y2);
+        i16Y0 = prvSat16((int32_t)((i64Acc + 0x2000) >> 14));
+        *pi16Out++ = i16Y0;
+
+        i16X2 = i16X1;
+        i16X1 = i16X0;
+        i16Y2 = i16Y1;
+        i16Y1 = i16Y0;
+    }
+
+    pi16State[0] = i16X1;
+    pi16State[1] = i16X2;
+    pi16State[2] = i16Y1;
+    pi16State[3] = i16Y2;
+}
+
+#if DSP_USE_SIMD
+//*****************************************************************************
+//
+// The DSP instructions.  GE flags set by SSUB16 are read by SEL, so the pair
+// is kept in one asm statement.
+//
+//*****************************************************************************
+static inline int64_t
+prvSmlald(uint32_t ui32X, uint32_t ui32Y, int64_t i64Acc)
+{
+    union
+    {
+        int64_t i64;
+        uint32_t pui32[2];
+    }
+    uAcc;
+
+    uAcc.i64 = i64Acc;
+    __asm("smlald %0, %1, %2, %3"
+          : "=r" (uAcc.pui32[0]), "=r" (uAcc.pui32[1])
+          : "r" (ui32X), "r" (ui32Y), "0" (uAcc.pui32[0]),
+            "1" (uAcc.pui32[1]));
+    return(uAcc.i64);
+}
+
+static inline int32_t
+prvSsat16(int32_t i32Val)
+{
+    int32_t i32Res;
+
+    __asm("ssat %0, #16, %1" : "=r" (i32Res) : "r" (i32Val));
+    return(i32Res);
+}
+
+static inline uint32_t
+prvQadd16(uint32_t ui32X, uint32_t ui32Y)
+{
+    uint32_t ui32Res;
+
+    __asm("qadd16 %0, %1, %2" : "=r" (ui32Res) : "r" (ui32X), "r" (ui32Y));
+    return(ui32Res);
+}
+
+static inline uint32_t
+prvMax16x2(uint32_t ui32X, uint32_t ui32Y)
+{
+    uint32_t ui32Res;
+
+    __asm("ssub16 %0, %1, %2\n\t"
+          "sel %0, %1, %2"
+          : "=&r" (ui32Res) : "r" (ui32X), "r" (ui32Y) : "cc");
+    return(ui32Res);
+}
+
+static inline uint32_t
+prvMin16x2(uint32_t ui32X, uint32_t ui32Y)
+{
+    uint32_t ui32Res;
+
+    __asm("ssub16 %0, %1, %2\n\t"
+          "sel %0, %2, %1"
+          : "=&r" (ui32Res) : "r" (ui32X), "r" (ui32Y) : "cc");
+    return(ui32Res);
+}
+
+//
+// Loads and stores two samples.  memcpy() keeps the compiler's aliasing
+// rules intact and compiles to a single, possibly unaligned, LDR or STR.
+//
+static inline uint32_t
+prvRead2(const int16_t *pi16Src)
+{
+    uint32_t ui32Val;
+
+    memcpy(&ui32Val, pi16Src, sizeof(ui32Val));
+    return(ui32Val);
+}
+
+static inline void
+prvWrite2(int16_t *pi16Dst, uint32_t ui32Val)
+{
+    memcpy(pi16Dst, &ui32Val, sizeof(ui32Val));
+}
+
+static inline uint32_t
+prvPack2(int32_t i32Lo, int32_t i32Hi)
+{
+    return(((uint32_t)i32Hi << 16) | (uint16_t)i32Lo);
+}
+
+//*****************************************************************************
+//
+// SIMD kernels.
+//
+//*****************************************************************************
+static inline int64_t
+prvDotSimd(const int16_t *pi16A, const int16_t *pi16B, uint32_t ui32Count)
+{
+    int64_t i64Acc = 0;
+
+    while(ui32Count >= 4)
+    {
+        i64Acc = prvSmlald(prvRead2(pi16A), prvRead2(pi16B), i64Acc);
+        i64Acc = prvSmlald(prvRead2(pi16A + 2), prvRead2(pi16B + 2), i64Acc);
+        pi16A += 4;
+        pi16B += 4;
+        ui32Count -= 4;
+    }
+    while(ui32Count--)
+    {
+        i64Acc += (int32_t)*pi16A++ * *pi16B++;
+    }
+    return(i64Acc);
+}
+
+//
+// One biquad section.  The two previous inputs and outputs are kept packed,
+// newest in the bottom half, so each pair of taps is one SMLALD.
+//
+static void
+prvBiquadStageSimd(const int16_t *pi16Coeffs, int16_t *pi16State,
+                   const int16_t *pi16In, int16_t *pi16Out,
+                   uint32_t ui32Count)
+{
+    int32_t i32B0 = pi16Coeffs[0];
+    uint32_t ui32B12 = prvPack2(pi16Coeffs[1], pi16Coeffs[2]);
+    uint32_t ui32A12 = prvPack2(pi16Coeffs[3], pi16Coeffs[4]);
+    uint32_t ui32X12 = prvPack2(pi16State[0], pi16State[1]);
+    uint32_t ui32Y12 = prvPack2(pi16State[2], pi16State[3]);
+    int32_t i32X0, i32Y0;
+    int64_t i64Acc;
+
+    while(ui32Count--)
+    {
+        i32X0 = *pi16In++;
+        i64Acc = i32B0 * i32X0;
+        i64Acc = prvSmlald(ui32X12, ui32B12, i64Acc);
+        i64Acc = prvSmlald(ui32Y12, ui32A12, i64Acc);
+        i32Y0 = prvSsat16((int32_t)((i64Acc + 0x2000) >> 14));
+        *pi16Out++ = (int16_t)i32Y0;
+
+        ui32X12 = (ui32X12 << 16) | (uint16_t)i32X0;
+        ui32Y12 = (ui32Y12 << 16) | (uint16_t)i32Y0;
+    }
+
+    pi16State[0] = (int16_t)ui32X12;
+    pi16State[1] = (int16_t)(ui32X12 >> 16);
+    pi16State[2] = (int16_t)ui32Y12;
+    pi16State[3] = (int16_t)(ui32Y12 >> 16);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Prepares a FIR filter.
+//!
+//! \param psFir is the filter.
+//! \param pi16Coeffs is the ui32NumTaps Q15 coefficients, in time-reversed
+//! order: pi16Coeffs[0] multiplies the oldest sample in the window.  For a
+//! symmetric (linear phase) filter the order makes no difference.  The table
+//! is kept, not copied.
+//! \param ui32NumTaps is the number of taps, from 1 to 65536.
+//! \param ui32Decimate is the decimation factor: one output is produced for
+//! every ui32Decimate inputs.  1 gives a plain filter.
+//! \param pi16State holds DSP_FIR_STATE_SIZE(ui32NumTaps, ui32MaxBlock)
+//! samples.
+//! \param ui32MaxBlock is the largest block that will be filtered, a multiple
+//! of ui32Decimate.
+//!
+//! \return Returns \b false if the parameters are out of range.
+//
+//*****************************************************************************
+bool
+DspFirInit(DspFir_t *psFir, const int16_t *pi16Coeffs, uint32_t ui32NumTaps,
+           uint32_t ui32Decimate, int16_t *pi16State, uint32_t ui32MaxBlock)
+{
+    if((ui32NumTaps == 0) || (ui32NumTaps > 65536) || (ui32Decimate == 0) ||
+       (ui32MaxBlock == 0) || (ui32MaxBlock % ui32Decimate))
+    {
+        return(false);
+    }
+
+    psFir->pi16Coeffs = pi16Coeffs;
+    psFir->pi16State = pi16State;
+    psFir->ui32NumTaps = ui32NumTaps;
+    psFir->ui32Decimate = ui32Decimate;
+    psFir->ui32MaxBlock = ui32MaxBlock;
+    memset(pi16State, 0, (ui32NumTaps - 1) * sizeof(int16_t));
+
+    return(true);
+}
+
+//
+// The part of the FIR common to both versions.  The new block is appended to
+// the last ui32NumTaps - 1 inputs, each output is a dot product over a window
+// of that history, and the end of the history is moved back for the next
+// block.
+//
+#define DSP_FIR_BODY(pfnDot)                                                  \
+    int16_t *pi16Hist;                                                        \
+    uint32_t ui32Out, ui32NumOut;                                             \
+                                                                              \
+    if((ui32Count > psFir->ui32MaxBlock) ||                                   \
+       (ui32Count % psFir->ui32Decimate))                                     \
+    {                                                                         \
+        return(0);                                                            \
+    }                                                                         \
+                                                                              \
+    pi16Hist = psFir->pi16State;                                              \
+    memcpy(pi16Hist + psFir->ui32NumTaps - 1, pi16In,                         \
+           ui32Count * sizeof(int16_t));                                      \
+                                                                              \
+    ui32NumOut = ui32Count / psFir->ui32Decimate;                             \
+    for(ui32Out = 0; ui32Out < ui32NumOut; ui32Out++)                         \
+    {                                                                         \
+        pi16Out[ui32Out] =                                                    \
+            prvSat16((int32_t)((pfnDot(pi16Hist, psFir->pi16Coeffs,           \
+                                       psFir->ui32NumTaps) + 0x4000) >> 15)); \
+        pi16Hist += psFir->ui32Decimate;                                      \
+    }                                                                         \
+                                                                              \
+    memmove(psFir->pi16State, psFir->pi16State + ui32Count,                   \
+            (psFir->ui32NumTaps - 1) * sizeof(int16_t));                      \
+                                                                              \
+    return(ui32NumOut)
+
+//*****************************************************************************
+//
+//! Filters a block of samples.
+//!
+//! \param psFir is a filter prepared by DspFirInit().
+//! \param pi16In is the input block.
+//! \param pi16Out receives ui32Count / ui32Decimate samples.  It may be the
+//! same buffer as pi16In.
+//! \param ui32Count is the number of input samples, a multiple of the
+//! decimation factor and no more than the largest block.
+//!
+//! \return Returns the number of samples written, or 0 if ui32Count is out
+//! of range.
+//
+//*****************************************************************************
+uint32_t
+DspFirQ15(DspFir_t *psFir, const int16_t *pi16In, int16_t *pi16Out,
+          uint32_t ui32Count)
+{
+#if DSP_USE_SIMD
+    DSP_FIR_BODY(prvDotSimd);
+#else
+    DSP_FIR_BODY(prvDotRef);
+#endif
+}
+
+//*****************************************************************************
+//
+//! The portable version of DspFirQ15().
+//
+//*****************************************************************************
+uint32_t
+DspFirQ15Ref(DspFir_t *psFir, const int16_t *pi16In, int16_t *pi16Out,
+             uint32_t ui32Count)
+{
+    DSP_FIR_BODY(prvDotRef);
+}
+
+//*****************************************************************************
+//
+//! Prepares a cascade of biquad sections.
+//!
+//! \param psBiquad is the filter.
+//! \param pi16Coeffs is DSP_BIQUAD_COEFFS coefficients per section, in Q14
+//! so that they can reach +/-2: { b0, b1, b2, a1, a2 }, where
+//!
+//!   y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+//!
+//! The feedback coefficients are added, so they are the negated a1 and a2 of
+//! a design tool that writes the denominator as 1 + a1 z^-1 + a2 z^-2.  The
+//! table is kept, not copied.
+//! \param ui32NumStages is the number of sections.
+//! \param pi16State holds DSP_BIQUAD_STATE samples per section.  It is
+//! cleared.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DspBiquadInit(DspBiquad_t *psBiquad, const int16_t *pi16Coeffs,
+              uint32_t ui32NumStages, int16_t *pi16State)
+{
+    psBiquad->pi16Coeffs = pi16Coeffs;
+    psBiquad->pi16State = pi16State;
+    psBiquad->ui32NumStages = ui32NumStages;
+    memset(pi16State, 0, ui32NumStages * DSP_BIQUAD_STATE * sizeof(int16_t));
+}
+
+//*****************************************************************************
+//
+//! Filters a block of samples through a biquad cascade.
+//!
+//! \param psBiquad is a filter prepared by DspBiquadInit().
+//! \param pi16In is the input block.
+//! \param pi16Out receives ui32Count samples.  It may be the same buffer as
+//! pi16In.
+//! \param ui32Count is the number of samples.
+//!
+//! Each section rounds and saturates its output to Q15.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DspBiquadQ15(DspBiquad_t *psBiquad, const int16_t *pi16In, int16_t *pi16Out,
+             uint32_t ui32Count)
+{
+#if DSP_USE_SIMD
+    uint32_t ui32Stage;
+
+    for(ui32Stage = 0; ui32Stage < psBiquad->ui32NumStages; ui32Stage++)
+    {
+        prvBiquadStageSimd(psBiquad->pi16Coeffs +
+                           (ui32Stage * DSP_BIQUAD_COEFFS),
+                           psBiquad->pi16State +
+                           (ui32Stage * DSP_BIQUAD_STATE),
+                           pi16In, pi16Out, ui32Count);
+        pi16In = pi16Out;
+    }
+#else
+    DspBiquadQ15Ref(psBiquad, pi16In, pi16Out, ui32Count);
+#endif
+}
+
+//*****************************************************************************
+//
+//! The portable version of DspBiquadQ15().
+//
+//*****************************************************************************
+void
+DspBiquadQ15Ref(DspBiquad_t *psBiquad, const int16_t *pi16In,
+                int16_t *pi16Out, uint32_t ui32Count)
+{
+    uint32_t ui32Stage;
+
+    for(ui32Stage = 0; ui32Stage < psBiquad->ui32NumStages; ui32Stage++)
+    {
+        prvBiquadStageRef(psBiquad->pi16Coeffs +
+                          (ui32Stage * DSP_BIQUAD_COEFFS),
+                          psBiquad->pi16State +
+                          (ui32Stage * DSP_BIQUAD_STATE),
+                          pi16In, pi16Out, ui32Count);
+        pi16In = pi16Out;
+    }
+}
+
+//*****************************************************************************
+//
+//! Returns the dot product of two Q15 vectors.
+//!
+//! \param pi16A and \param pi16B are the vectors.
+//! \param ui32Count is their length, up to 65536.
+//!
+//! \return Returns the sum of the products, in Q30.
+//
+//*****************************************************************************
+int64_t
+DspDotQ15(const int16_t *pi16A, const int16_t *pi16B, uint32_t ui32Count)
+{
+#if DSP_USE_SIMD
+    return(prvDotSimd(pi16A, pi16B, ui32Count));
+#else
+    return(prvDotRef(pi16A, pi16B, ui32Count));
+#endif
+}
+
+//*****************************************************************************
+//
+//! The portable version of DspDotQ15().
+//
+//*****************************************************************************
+int64_t
+DspDotQ15Ref(const int16_t *pi16A, const int16_t *pi16B, uint32_t ui32Count)
+{
+    return(prvDotRef(pi16A, pi16B, ui32Count));
+}
+
+//*****************************************************************************
+//
+//! Finds the smallest and largest sample in a block.
+//!
+//! \param pi16In is the block.
+//! \param ui32Count is the number of samples, at least 1.
+//! \param pi16Min and \param pi16Max receive the extremes.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DspMinMaxQ15(const int16_t *pi16In, uint32_t ui32Count, int16_t *pi16Min,
+             int16_t *pi16Max)
+{
+#if DSP_USE_SIMD
+    uint32_t ui32Min, ui32Max, ui32Pair;
+    int16_t i16Min, i16Max;
+
+    ui32Min = prvPack2(pi16In[0], pi16In[0]);
+    ui32Max = ui32Min;
+    while(ui32Count >= 2)
+    {
+        ui32Pair = prvRead2(pi16In);
+        ui32Min = prvMin16x2(ui32Min, ui32Pair);
+        ui32Max = prvMax16x2(ui32Max, ui32Pair);
+        pi16In += 2;
+        ui32Count -= 2;
+    }
+    if(ui32Count)
+    {
+        ui32Pair = prvPack2(pi16In[0], pi16In[0]);
+        ui32Min = prvMin16x2(ui32Min, ui32Pair);
+        ui32Max = prvMax16x2(ui32Max, ui32Pair);
+    }
+
+    i16Min = (int16_t)ui32Min;
+    if((int16_t)(ui32Min >> 16) < i16Min)
+    {
+        i16Min = (int16_t)(ui32Min >> 16);
+    }
+    i16Max = (int16_t)ui32Max;
+    if((int16_t)(ui32Max >> 16) > i16Max)
+    {
+        i16Max = (int16_t)(ui32Max >> 16);
+    }
+    *pi16Min = i16Min;
+    *pi16Max = i16Max;
+#else
+    DspMinMaxQ15Ref(pi16In, ui32Count, pi16Min, pi16Max);
+#endif
+}
+
+//*****************************************************************************
+//
+//! The portable version of DspMinMaxQ15().
+//
+//*****************************************************************************
+void
+DspMinMaxQ15Ref(const int16_t *pi16In, uint32_t ui32Count, int16_t *pi16Min,
+                int16_t *pi16Max)
+{
+    int16_t i16Min, i16Max;
+
+    i16Min = pi16In[0];
+    i16Max = pi16In[0];
+    while(ui32Count--)
+    {
+        if(*pi16In < i16Min)
+        {
+            i16Min = *pi16In;
+        }
+        if(*pi16In > i16Max)
+        {
+            i16Max = *pi16In;
+        }
+        pi16In++;
+    }
+    *pi16Min = i16Min;
+    *pi16Max = i16Max;
+}
+
+//*****************************************************************************
+//
+//! Multiplies a block by a Q15 gain and a power of two.
+//!
+//! \param pi16In is the input block.
+//! \param pi16Out receives ui32Count samples.  It may be the same buffer as
+//! pi16In.
+//! \param ui32Count is the number of samples.
+//! \param i16Gain is the gain, in Q15.
+//! \param i32Shift is a further left shift, from -15 to 15.
+//!
+//! Each output is (in * i16Gain) >> (15 - i32Shift), truncated and
+//! saturated.  Together with DspOffsetQ15() this maps a block onto a display
+//! range, or 12-bit ADC codes onto Q15: an offset of -2048 and a shift of 4.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DspScaleQ15(const int16_t *pi16In, int16_t *pi16Out, uint32_t ui32Count,
+            int16_t i16Gain, int32_t i32Shift)
+{
+#if DSP_USE_SIMD
+    int32_t i32Right = 15 - i32Shift;
+    uint32_t ui32Pair;
+    int32_t i32Lo, i32Hi;
+
+    while(ui32Count >= 2)
+    {
+        ui32Pair = prvRead2(pi16In);
+        i32Lo = prvSsat16(((int16_t)ui32Pair * i16Gain) >> i32Right);
+        i32Hi = prvSsat16(((int32_t)ui32Pair >> 16) * i16Gain >> i32Right);
+        prvWrite2(pi16Out, prvPack2(i32Lo, i32Hi));
+        pi16In += 2;
+        pi16Out += 2;
+        ui32Count -= 2;
+    }
+    if(ui32Count)
+    {
+        *pi16Out = (int16_t)prvSsat16((*pi16In * i16Gain) >> i32Right);
+    }
+#else
+    DspScaleQ15Ref(pi16In, pi16Out, ui32Count, i16Gain, i32Shift);
+#endif
+}
+
+//*****************************************************************************
+//
+//! The portable version of DspScaleQ15().
+//
+//*****************************************************************************
+void
+DspScaleQ15Ref(const int16_t *pi16In, int16_t *pi16Out, uint32_t ui32Count,
+               int16_t i16Gain, int32_t i32Shift)
+{
+    int32_t i32Right = 15 - i32Shift;
+
+    while(ui32Count--)
+    {
+        *pi16Out++ = prvSat16((*pi16In++ * i16Gain) >> i32Right);
+    }
+}
+
+//*****************************************************************************
+//
+//! Adds a constant to a block, with saturation.
+//!
+//! \param pi16In is the input block.
+//! \param pi16Out receives ui32Count samples.  It may be the same buffer as
+//! pi16In.
+//! \param ui32Count is the number of samples.
+//! \param i16Offset is the constant.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DspOffsetQ15(const int16_t *pi16In, int16_t *pi16Out, uint32_t ui32Count,
+             int16_t i16Offset)
+{
+#if DSP_USE_SIMD
+    uint32_t ui32Offset = prvPack2(i16Offset, i16Offset);
+
+    while(ui32Count >= 4)
+    {
+        prvWrite2(pi16Out, prvQadd16(prvRead2(pi16In), ui32Offset));
+        prvWrite2(pi16Out + 2, prvQadd16(prvRead2(pi16In + 2), ui32Offset));
+        pi16In += 4;
+        pi16Out += 4;
+        ui32Count -= 4;
+    }
+    while(ui32Count--)
+    {
+        *pi16Out++ = (int16_t)prvQadd16((uint16_t)*pi16In++, ui32Offset);
+    }
+#else
+    DspOffsetQ15Ref(pi16In, pi16Out, ui32Count, i16Offset);
+#endif
+}
+
+//*****************************************************************************
+//
+//! The portable version of DspOffsetQ15().
+//
+//*****************************************************************************
+void
+DspOffsetQ15Ref(const int16_t *pi16In, int16_t *pi16Out, uint32_t ui32Count,
+                int16_t i16Offset)
+{
+    while(ui32Count--)
+    {
+        *pi16Out++ = prvSat16(*pi16In++ + i16Offset);
+    }
+}
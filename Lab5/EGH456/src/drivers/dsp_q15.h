@@ -0,0 +1,121 @@
+//*****************************************************************************
+//
+// dsp_q15.h - Q15 filter and block kernels using the Cortex-M4 DSP
+//             instructions, with portable C references.
+//
+//*****************************************************************************
+
+#ifndef __DSP_Q15_H__
+#define __DSP_Q15_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The kernels use the DSP instructions when the compiler targets a core that
+// has them, unless DSP_PORTABLE is defined.  The ...Ref() versions are always
+// the portable C and give bit-identical results.
+//
+//*****************************************************************************
+#if defined(__ARM_FEATURE_DSP) && !defined(DSP_PORTABLE)
+#define DSP_USE_SIMD            1
+#else
+#define DSP_USE_SIMD            0
+#endif
+
+//*****************************************************************************
+//
+// The number of samples of state a FIR filter needs, for a given number of
+// taps and largest block passed to DspFirQ15().
+//
+//*****************************************************************************
+#define DSP_FIR_STATE_SIZE(ui32NumTaps, ui32MaxBlock)                         \
+                                ((ui32NumTaps) - 1 + (ui32MaxBlock))
+
+//*****************************************************************************
+//
+// A FIR filter, optionally followed by decimation.  See DspFirInit().
+//
+//*****************************************************************************
+typedef struct
+{
+    const int16_t *pi16Coeffs;
+    int16_t *pi16State;
+    uint32_t ui32NumTaps;
+    uint32_t ui32Decimate;
+    uint32_t ui32MaxBlock;
+}
+DspFir_t;
+
+//*****************************************************************************
+//
+// A cascade of biquad sections.  See DspBiquadInit().
+//
+//*****************************************************************************
+#define DSP_BIQUAD_COEFFS       5
+#define DSP_BIQUAD_STATE        4
+
+typedef struct
+{
+    const int16_t *pi16Coeffs;
+    int16_t *pi16State;
+    uint32_t ui32NumStages;
+}
+DspBiquad_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern bool DspFirInit(DspFir_t *psFir, const int16_t *pi16Coeffs,
+                       uint32_t ui32NumTaps, uint32_t ui32Decimate,
+                       int16_t *pi16State, uint32_t ui32MaxBlock);
+extern uint32_t DspFirQ15(DspFir_t *psFir, const int16_t *pi16In,
+                          int16_t *pi16Out, uint32_t ui32Count);
+extern uint32_t DspFirQ15Ref(DspFir_t *psFir, const int16_t *pi16In,
+                             int16_t *pi16Out, uint32_t ui32Count);
+extern void DspBiquadInit(DspBiquad_t *psBiquad, const int16_t *pi16Coeffs,
+                          uint32_t ui32NumStages, int16_t *pi16State);
+extern void DspBiquadQ15(DspBiquad_t *psBiquad, const int16_t *pi16In,
+                         int16_t *pi16Out, uint32_t ui32Count);
+extern void DspBiquadQ15Ref(DspBiquad_t *psBiquad, const int16_t *pi16In,
+                            int16_t *pi16Out, uint32_t ui32Count);
+extern int64_t DspDotQ15(const int16_t *pi16A, const int16_t *pi16B,
+                         uint32_t ui32Count);
+extern int64_t DspDotQ15Ref(const int16_t *pi16A, const int16_t *pi16B,
+                            uint32_t ui32Count);
+extern void DspMinMaxQ15(const int16_t *pi16In, uint32_t ui32Count,
+                         int16_t *pi16Min, int16_t *pi16Max);
+extern void DspMinMaxQ15Ref(const int16_t *pi16In, uint32_t ui32Count,
+                            int16_t *pi16Min, int16_t *pi16Max);
+extern void DspScaleQ15(const int16_t *pi16In, int16_t *pi16Out,
+                        uint32_t ui32Count, int16_t i16Gain, int32_t i32Shift);
+extern void DspScaleQ15Ref(const int16_t *pi16In, int16_t *pi16Out,
+                           uint32_t ui32Count, int16_t i16Gain,
+                           int32_t i32Shift);
+extern void DspOffsetQ15(const int16_t *pi16In, int16_t *pi16Out,
+                         uint32_t ui32Count, int16_t i16Offset);
+extern void DspOffsetQ15Ref(const int16_t *pi16In, int16_t *pi16Out,
+                            uint32_t ui32Count, int16_t i16Offset);
+extern void vDspBenchmark(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DSP_Q15_H__
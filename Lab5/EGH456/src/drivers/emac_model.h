@@ -0,0 +1,72 @@
+//*****************************************************************************
+//
+// emac_model.h - A software model of the Ethernet MAC DMA engine, for
+//                running the UDP stack without a network.
+//
+//*****************************************************************************
+
+#ifndef __EMAC_MODEL_H__
+#define __EMAC_MODEL_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The modelled link speed, used to convert frames to wire time.
+//
+//*****************************************************************************
+#define EMAC_MODEL_BITRATE      100000000
+
+//*****************************************************************************
+//
+// One modelled MAC.  The model keeps its own current descriptor pointers and
+// follows the chain links, as the DMA engine does, so it only works if the
+// stack builds the rings correctly.
+//
+//*****************************************************************************
+typedef struct EmacModel
+{
+    NetIf_t *psIf;
+    struct EmacModel *psPeer;
+    tEMACDMADescriptor *psTxCur;
+    tEMACDMADescriptor *psRxCur;
+
+    uint32_t ui32TxDemands;
+    uint32_t ui32Frames;
+    uint32_t ui32Bytes;
+    uint32_t ui32RxNoBuffer;
+    uint32_t ui32ForeignBuffers;
+    uint64_t ui64WireNs;
+}
+EmacModel_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void EmacModelInit(EmacModel_t *psMac, NetIf_t *psIf,
+                          const uint8_t *pui8Mac, uint32_t ui32Ip);
+extern void EmacModelConnect(EmacModel_t *psA, EmacModel_t *psB);
+extern uint32_t EmacModelStep(EmacModel_t *psMac);
+extern void vEmacModelBenchmark(uint32_t ui32SysClock);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __EMAC_MODEL_H__
@@ -0,0 +1,716 @@
+//*****************************************************************************
+//
+// freq_meter.c - Frequency measurement of a pulse input by timer capture,
+//                switching between period measurement and gated counting.
+//
+// A tachometer, flow meter or encoder gives anything from about one pulse a
+// second to some hundreds of thousands.  Neither way of measuring covers
+// that on its own: timing the edges is exact at low rates but needs a
+// transfer per edge, and counting edges over a fixed gate costs nothing per
+// edge but resolves only one count in a gate.  So the meter times edges up
+// to FREQ_METER_UP_HZ and counts them above, and works out which from its
+// own readings.
+//
+// Both ways log into the same ping-pong buffer by uDMA, without an interrupt
+// per edge, and the meter task reads what has landed once a gate:
+//
+// - Timing: Timer 3A, in edge-time capture mode on the input pin, raises a
+//   uDMA request on every rising edge, which copies the count of Timer 6A
+//   into the log.  Timer 6A runs free at the system clock over its full 32
+//   bits, a span of 35 s at 120 MHz.  Timer 3A's own capture register only
+//   has 24 bits, 140 ms, too short for a 1 Hz input.  The copy follows the
+//   edge by the few cycles the uDMA takes to respond, a delay that varies
+//   with bus traffic by much less than a cycle of the input, and that the
+//   averaging spreads over every period in the window.
+//
+// - Counting: Timer 3A counts rising edges on the pin, and Timer 6A times
+//   gates of FREQ_METER_GATE_MS, at the end of each of which its uDMA request
+//   copies the edge count into the log.  The gate is timed by hardware, so
+//   how late the task runs does not matter.
+//
+// The only interrupts are one per half of the log, to re-arm it, and one
+// per 2^24 counted edges.  A reading is the edges between the newest entry
+// and one FREQ_METER_AVG_GATES gates older, over the time between them, and
+// goes to a latest value channel and to every subscriber.
+//
+// Timer 6A counts the system clock, which is accurate to the crystal but
+// changes with the clock level; a change restarts the averaging.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_timer.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/udma.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "task_stacks.h"
+#include "drivers/udma_ctl.h"
+#include "drivers/clock_scale.h"
+#include "drivers/seq_channel.h"
+#include "drivers/freq_meter.h"
+
+//*****************************************************************************
+//
+// Hardware resources used by the meter.  The input is T3CCP0 on PD4.
+//
+//*****************************************************************************
+#define FREQ_METER_GPIO_PERIPH  SYSCTL_PERIPH_GPIOD
+#define FREQ_METER_GPIO_BASE    GPIO_PORTD_BASE
+#define FREQ_METER_GPIO_PIN     GPIO_PIN_4
+#define FREQ_METER_PIN_CONFIG   GPIO_PD4_T3CCP0
+
+#define FREQ_METER_CAP_PERIPH   SYSCTL_PERIPH_TIMER3
+#define FREQ_METER_CAP_BASE     TIMER3_BASE
+#define FREQ_METER_CAP_INT      INT_TIMER3A
+#define FREQ_METER_CAP_DMA      UDMA_CH2_TIMER3A
+#define FREQ_METER_CAP_DMA_CHANNEL                                            \
+                                (FREQ_METER_CAP_DMA & 0xff)
+
+#define FREQ_METER_REF_PERIPH   SYSCTL_PERIPH_TIMER6
+#define FREQ_METER_REF_BASE     TIMER6_BASE
+#define FREQ_METER_REF_INT      INT_TIMER6A
+#define FREQ_METER_REF_DMA      UDMA_CH10_TIMER6A
+#define FREQ_METER_REF_DMA_CHANNEL                                            \
+                                (FREQ_METER_REF_DMA & 0xff)
+
+//*****************************************************************************
+//
+// The number of log entries, and the mask of a 24-bit edge count.
+//
+//*****************************************************************************
+#define FREQ_METER_LOG_LEN      (2 * FREQ_METER_BLOCK)
+#define FREQ_METER_COUNT_M      0x00ffffff
+
+//*****************************************************************************
+//
+// The log, and the halves of it the uDMA has filled since the method was
+// set.  Written by the uDMA and the interrupt handlers.
+//
+//*****************************************************************************
+static uint32_t g_pui32FreqLog[FREQ_METER_LOG_LEN];
+static volatile uint32_t g_ui32FreqBlocks;
+
+//
+// The method in use, the channel that fills the log for it and the register
+// the channel copies.
+//
+static uint32_t g_ui32FreqMethod;
+static uint32_t g_ui32FreqChannel;
+static void *g_pvFreqSrc;
+
+//
+// The rate Timer 6A counts at, and a count of its changes.  Written by the
+// clock change notifier.
+//
+static volatile uint32_t g_ui32FreqRefHz;
+static volatile uint32_t g_ui32FreqEpoch;
+
+static uint32_t g_ui32FreqOverruns;
+static FreqSubscriber_t *g_psFreqSubscribers;
+static SEQ_CHANNEL(g_sFreqLatest, FreqReading_t);
+static TaskHandle_t g_xFreqTask = NULL;
+
+static void prvFreqMeterTask(void *pvParameters);
+
+//*****************************************************************************
+//
+// What the task has made of the log so far.  ui32Edges counts the edges
+// since the first entry, and ui32Time is the Timer 6A count at the last one.
+// A mark holds the two as they were at the end of a gate.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Edges;
+    uint32_t ui32Time;
+}
+FreqMark_t;
+
+typedef struct
+{
+    uint32_t ui32Read;
+    uint32_t ui32RefHz;
+    uint32_t ui32GateTicks;
+    uint32_t ui32Edges;
+    uint32_t ui32Time;
+    uint32_t ui32Count;
+    bool bStarted;
+    uint32_t ui32Marks;
+    FreqMark_t psMarks[FREQ_METER_AVG_GATES + 1];
+}
+FreqState_t;
+
+//*****************************************************************************
+//
+// Returns the Timer 6A counts in a gate.
+//
+//*****************************************************************************
+static uint32_t
+prvGateTicks(uint32_t ui32RefHz)
+{
+    return((ui32RefHz / 1000) * FREQ_METER_GATE_MS);
+}
+
+//*****************************************************************************
+//
+// Keeps the gate length across system clock changes, and tells the task to
+// restart the averaging.
+//
+//*****************************************************************************
+static void
+prvFreqMeterClockPost(uint32_t ui32NewHz, void *pvArg)
+{
+    (void)pvArg;
+
+    g_ui32FreqRefHz = ui32NewHz;
+    g_ui32FreqEpoch++;
+    if(g_ui32FreqMethod == FREQ_METHOD_COUNT)
+    {
+        TimerLoadSet(FREQ_METER_REF_BASE, TIMER_A,
+                     prvGateTicks(ui32NewHz) - 1);
+    }
+}
+
+static ClockNotifier_t g_sFreqMeterClockNotifier =
+{
+    NULL, prvFreqMeterClockPost, NULL, NULL
+};
+
+//*****************************************************************************
+//
+// Points one of the control structures at its half of the log.
+//
+//*****************************************************************************
+static void
+prvArm(uint32_t ui32Select)
+{
+    uint32_t *pui32Dst = g_pui32FreqLog;
+
+    if(ui32Select == UDMA_ALT_SELECT)
+    {
+        pui32Dst += FREQ_METER_BLOCK;
+    }
+
+    uDMAChannelTransferSet(g_ui32FreqChannel | ui32Select, UDMA_MODE_PINGPONG,
+                           g_pvFreqSrc, pui32Dst, FREQ_METER_BLOCK);
+}
+
+//*****************************************************************************
+//
+// Re-arms whichever half has just filled.  Called from the interrupt handler
+// of the timer whose requests fill the log.
+//
+//*****************************************************************************
+static void
+prvBlockDone(void)
+{
+    if(uDMAChannelModeGet(g_ui32FreqChannel | UDMA_PRI_SELECT) ==
+       UDMA_MODE_STOP)
+    {
+        prvArm(UDMA_PRI_SELECT);
+        g_ui32FreqBlocks++;
+    }
+    if(uDMAChannelModeGet(g_ui32FreqChannel | UDMA_ALT_SELECT) ==
+       UDMA_MODE_STOP)
+    {
+        prvArm(UDMA_ALT_SELECT);
+        g_ui32FreqBlocks++;
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the number of entries logged since the method was set.  The
+// halves fill in turn, so the one filling is known from the count of full
+// ones; the count is read again to catch a half completing in between.
+//
+//*****************************************************************************
+static uint32_t
+prvWrittenGet(void)
+{
+    uint32_t ui32Blocks, ui32Left;
+
+    do
+    {
+        ui32Blocks = g_ui32FreqBlocks;
+        ui32Left = uDMAChannelSizeGet(g_ui32FreqChannel |
+                                      ((ui32Blocks & 1) ? UDMA_ALT_SELECT :
+                                                          UDMA_PRI_SELECT));
+    }
+    while(ui32Blocks != g_ui32FreqBlocks);
+
+    return((ui32Blocks * FREQ_METER_BLOCK) + FREQ_METER_BLOCK - ui32Left);
+}
+
+//*****************************************************************************
+//
+// Stops the timers and the log, and starts them again measuring by
+// ui32Method.
+//
+//*****************************************************************************
+static void
+prvMethodSet(uint32_t ui32Method)
+{
+    TimerDisable(FREQ_METER_CAP_BASE, TIMER_A);
+    TimerDisable(FREQ_METER_REF_BASE, TIMER_A);
+    uDMAChannelDisable(FREQ_METER_CAP_DMA_CHANNEL);
+    uDMAChannelDisable(FREQ_METER_REF_DMA_CHANNEL);
+    TimerIntDisable(FREQ_METER_CAP_BASE, TIMER_TIMA_DMA | TIMER_CAPA_MATCH);
+    TimerIntDisable(FREQ_METER_REF_BASE, TIMER_TIMA_DMA);
+    TimerIntClear(FREQ_METER_CAP_BASE, TIMER_TIMA_DMA | TIMER_CAPA_MATCH);
+    TimerIntClear(FREQ_METER_REF_BASE, TIMER_TIMA_DMA);
+
+    g_ui32FreqMethod = ui32Method;
+    g_ui32FreqBlocks = 0;
+
+    if(ui32Method == FREQ_METHOD_PERIOD)
+    {
+        //
+        // Timer 6A runs free and each rising edge copies its count.
+        //
+        TimerConfigure(FREQ_METER_REF_BASE, TIMER_CFG_PERIODIC_UP);
+        TimerLoadSet(FREQ_METER_REF_BASE, TIMER_A, 0xffffffff);
+        TimerDMAEventSet(FREQ_METER_REF_BASE, 0);
+
+        TimerConfigure(FREQ_METER_CAP_BASE, TIMER_CFG_SPLIT_PAIR |
+                       TIMER_CFG_A_CAP_TIME_UP);
+        TimerControlEvent(FREQ_METER_CAP_BASE, TIMER_A, TIMER_EVENT_POS_EDGE);
+        TimerLoadSet(FREQ_METER_CAP_BASE, TIMER_A, 0xffff);
+        TimerPrescaleSet(FREQ_METER_CAP_BASE, TIMER_A, 0xff);
+        TimerDMAEventSet(FREQ_METER_CAP_BASE, TIMER_DMA_CAPEVENT_A);
+        TimerIntEnable(FREQ_METER_CAP_BASE, TIMER_TIMA_DMA);
+
+        g_ui32FreqChannel = FREQ_METER_CAP_DMA_CHANNEL;
+        g_pvFreqSrc = (void *)(FREQ_METER_REF_BASE + TIMER_O_TAV);
+    }
+    else
+    {
+        //
+        // Timer 3A counts rising edges up to the top of its 24 bits, where it
+        // stops until the match interrupt restarts it, and the end of each
+        // gate copies its count.
+        //
+        TimerConfigure(FREQ_METER_CAP_BASE, TIMER_CFG_SPLIT_PAIR |
+                       TIMER_CFG_A_CAP_COUNT_UP);
+        TimerControlEvent(FREQ_METER_CAP_BASE, TIMER_A, TIMER_EVENT_POS_EDGE);
+        TimerLoadSet(FREQ_METER_CAP_BASE, TIMER_A, 0xffff);
+        TimerPrescaleSet(FREQ_METER_CAP_BASE, TIMER_A, 0xff);
+        TimerMatchSet(FREQ_METER_CAP_BASE, TIMER_A, 0xffff);
+        TimerPrescaleMatchSet(FREQ_METER_CAP_BASE, TIMER_A, 0xff);
+        TimerDMAEventSet(FREQ_METER_CAP_BASE, 0);
+        TimerIntEnable(FREQ_METER_CAP_BASE, TIMER_CAPA_MATCH);
+
+        TimerConfigure(FREQ_METER_REF_BASE, TIMER_CFG_PERIODIC_UP);
+        TimerLoadSet(FREQ_METER_REF_BASE, TIMER_A,
+                     prvGateTicks(g_ui32FreqRefHz) - 1);
+        TimerDMAEventSet(FREQ_METER_REF_BASE, TIMER_DMA_TIMEOUT_A);
+        TimerIntEnable(FREQ_METER_REF_BASE, TIMER_TIMA_DMA);
+
+        g_ui32FreqChannel = FREQ_METER_REF_DMA_CHANNEL;
+        g_pvFreqSrc = (void *)(FREQ_METER_CAP_BASE + TIMER_O_TAV);
+    }
+
+    uDMAChannelControlSet(g_ui32FreqChannel | UDMA_PRI_SELECT,
+                          UDMA_SIZE_32 | UDMA_SRC_INC_NONE | UDMA_DST_INC_32 |
+                          UDMA_ARB_1);
+    uDMAChannelControlSet(g_ui32FreqChannel | UDMA_ALT_SELECT,
+                          UDMA_SIZE_32 | UDMA_SRC_INC_NONE | UDMA_DST_INC_32 |
+                          UDMA_ARB_1);
+    prvArm(UDMA_PRI_SELECT);
+    prvArm(UDMA_ALT_SELECT);
+    uDMAChannelEnable(g_ui32FreqChannel);
+
+    TimerEnable(FREQ_METER_CAP_BASE, TIMER_A);
+    TimerEnable(FREQ_METER_REF_BASE, TIMER_A);
+}
+
+//*****************************************************************************
+//
+//! Sets up the timers and uDMA channels and starts measuring.
+//!
+//! \param ui32SysClock is the system clock frequency.
+//!
+//! Measuring starts by timing edges.  Readings come every gate while edges
+//! arrive, to the subscribers and to FreqMeterReadingGet().
+//!
+//! \return Returns \b false if either uDMA channel is owned by another
+//! driver.
+//
+//*****************************************************************************
+bool
+FreqMeterInit(uint32_t ui32SysClock)
+{
+    if(!DMAChannelClaim(FREQ_METER_CAP_DMA))
+    {
+        return(false);
+    }
+    if(!DMAChannelClaim(FREQ_METER_REF_DMA))
+    {
+        DMAChannelRelease(FREQ_METER_CAP_DMA);
+        return(false);
+    }
+
+    g_ui32FreqRefHz = ui32SysClock;
+    g_ui32FreqOverruns = 0;
+
+    SysCtlPeripheralEnable(FREQ_METER_GPIO_PERIPH);
+    SysCtlPeripheralEnable(FREQ_METER_CAP_PERIPH);
+    SysCtlPeripheralEnable(FREQ_METER_REF_PERIPH);
+    while(!SysCtlPeripheralReady(FREQ_METER_GPIO_PERIPH) ||
+          !SysCtlPeripheralReady(FREQ_METER_CAP_PERIPH) ||
+          !SysCtlPeripheralReady(FREQ_METER_REF_PERIPH))
+    {
+    }
+
+    GPIOPinConfigure(FREQ_METER_PIN_CONFIG);
+    GPIOPinTypeTimer(FREQ_METER_GPIO_BASE, FREQ_METER_GPIO_PIN);
+    TimerClockSourceSet(FREQ_METER_CAP_BASE, TIMER_CLOCK_SYSTEM);
+    TimerClockSourceSet(FREQ_METER_REF_BASE, TIMER_CLOCK_SYSTEM);
+
+    //
+    // An edge's time is copied when the uDMA gets to it, so its channel goes
+    // ahead of memory copies.
+    //
+    uDMAChannelAttributeEnable(FREQ_METER_CAP_DMA_CHANNEL,
+                               UDMA_ATTR_HIGH_PRIORITY);
+
+    TimerIntRegister(FREQ_METER_CAP_BASE, TIMER_A,
+                     FreqMeterCaptureIntHandler);
+    TimerIntRegister(FREQ_METER_REF_BASE, TIMER_A, FreqMeterGateIntHandler);
+    IntPrioritySet(FREQ_METER_CAP_INT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    IntPrioritySet(FREQ_METER_REF_INT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+
+    ClockNotifierRegister(&g_sFreqMeterClockNotifier);
+
+    prvMethodSet(FREQ_METHOD_PERIOD);
+
+    if(g_xFreqTask == NULL)
+    {
+        xTaskCreate(prvFreqMeterTask, "FreqMeter", TASK_STACK_FREQ_METER,
+                    NULL, FREQ_METER_TASK_PRIORITY, &g_xFreqTask);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Subscribes to the readings.
+//!
+//! \param psSubscriber is the subscription.  It must stay valid from then
+//! on; there is no unsubscribing.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+FreqMeterSubscribe(FreqSubscriber_t *psSubscriber)
+{
+    taskENTER_CRITICAL();
+    psSubscriber->psNext = g_psFreqSubscribers;
+    g_psFreqSubscribers = psSubscriber;
+    taskEXIT_CRITICAL();
+}
+
+//*****************************************************************************
+//
+//! Gets the latest reading.
+//!
+//! \param psReading is filled in with the reading.
+//! \param pui32Seq, if not NULL, is the sequence number of the reading the
+//! caller got last, and is updated to that of this one.
+//!
+//! \return Returns the number of readings since the one at \e *pui32Seq, as
+//! SeqChannelRead() does.  A reading of all zeroes with no readings before
+//! it means none has been made yet.
+//
+//*****************************************************************************
+uint32_t
+FreqMeterReadingGet(FreqReading_t *psReading, uint32_t *pui32Seq)
+{
+    return(SEQ_CHANNEL_READ(&g_sFreqLatest, psReading, pui32Seq));
+}
+
+//*****************************************************************************
+//
+//! Returns the number of times the log filled before the task read it.  The
+//! meter then changes to counting edges, as the input is too fast to time.
+//!
+//! \return The overrun count since FreqMeterInit().
+//
+//*****************************************************************************
+uint32_t
+FreqMeterOverrunsGet(void)
+{
+    return(g_ui32FreqOverruns);
+}
+
+//*****************************************************************************
+//
+// The Timer 3A interrupt handler.  Runs once per half of the log while
+// timing edges, and once per 2^24 edges while counting them.
+//
+//*****************************************************************************
+void
+FreqMeterCaptureIntHandler(void)
+{
+    uint32_t ui32Status;
+
+    ui32Status = TimerIntStatus(FREQ_METER_CAP_BASE, true);
+    TimerIntClear(FREQ_METER_CAP_BASE, ui32Status);
+
+    //
+    // The count has reached the top and stopped; carry on from zero.  The
+    // entries go on differing by the edges counted, modulo 2^24.
+    //
+    if(ui32Status & TIMER_CAPA_MATCH)
+    {
+        TimerEnable(FREQ_METER_CAP_BASE, TIMER_A);
+    }
+
+    if(ui32Status & TIMER_TIMA_DMA)
+    {
+        prvBlockDone();
+    }
+}
+
+//*****************************************************************************
+//
+// The Timer 6A interrupt handler.  Runs once per half of the log while
+// counting edges.
+//
+//*****************************************************************************
+void
+FreqMeterGateIntHandler(void)
+{
+    uint32_t ui32Status;
+
+    ui32Status = TimerIntStatus(FREQ_METER_REF_BASE, true);
+    TimerIntClear(FREQ_METER_REF_BASE, ui32Status);
+
+    if(ui32Status & TIMER_TIMA_DMA)
+    {
+        prvBlockDone();
+    }
+}
+
+//*****************************************************************************
+//
+// Forgets everything logged so far.  The next entry is only a starting
+// point, as the first edge's time or the first count.
+//
+//*****************************************************************************
+static void
+prvStateReset(FreqState_t *psState, uint32_t ui32Read)
+{
+    psState->ui32Read = ui32Read;
+    psState->ui32RefHz = g_ui32FreqRefHz;
+    psState->ui32GateTicks = prvGateTicks(psState->ui32RefHz);
+    psState->ui32Edges = 0;
+    psState->ui32Time = 0;
+    psState->bStarted = false;
+    psState->ui32Marks = 0;
+}
+
+//*****************************************************************************
+//
+// Adds a log entry: an edge's time, or the edge count at the end of a gate.
+//
+//*****************************************************************************
+static void
+prvEntryAdd(FreqState_t *psState, uint32_t ui32Entry)
+{
+    if(g_ui32FreqMethod == FREQ_METHOD_PERIOD)
+    {
+        if(psState->bStarted)
+        {
+            psState->ui32Edges++;
+        }
+        psState->ui32Time = ui32Entry;
+    }
+    else
+    {
+        if(psState->bStarted)
+        {
+            psState->ui32Edges += (ui32Entry - psState->ui32Count) &
+                                  FREQ_METER_COUNT_M;
+            psState->ui32Time += psState->ui32GateTicks;
+        }
+        psState->ui32Count = ui32Entry;
+    }
+    psState->bStarted = true;
+}
+
+//*****************************************************************************
+//
+// Marks the end of a gate, and makes a reading from the oldest mark in the
+// window that is older than the newest entry.  While timing a slow input,
+// that is the mark that holds the edge before, so the reading is then the
+// last period.  Returns false if there is no such mark.
+//
+//*****************************************************************************
+static bool
+prvReadingMake(FreqState_t *psState, FreqReading_t *psReading)
+{
+    const FreqMark_t *psOld;
+    FreqMark_t *psNew;
+    uint32_t ui32Mark, ui32Ticks;
+
+    if(!psState->bStarted)
+    {
+        return(false);
+    }
+
+    psNew = &psState->psMarks[psState->ui32Marks %
+                              (FREQ_METER_AVG_GATES + 1)];
+    psNew->ui32Edges = psState->ui32Edges;
+    psNew->ui32Time = psState->ui32Time;
+    psState->ui32Marks++;
+
+    ui32Mark = 0;
+    if(psState->ui32Marks > (FREQ_METER_AVG_GATES + 1))
+    {
+        ui32Mark = psState->ui32Marks - (FREQ_METER_AVG_GATES + 1);
+    }
+    for(; ui32Mark < (psState->ui32Marks - 1); ui32Mark++)
+    {
+        psOld = &psState->psMarks[ui32Mark % (FREQ_METER_AVG_GATES + 1)];
+        ui32Ticks = psNew->ui32Time - psOld->ui32Time;
+        if(ui32Ticks != 0)
+        {
+            psReading->ui32Edges = psNew->ui32Edges - psOld->ui32Edges;
+            psReading->fHz = ((float)psReading->ui32Edges *
+                              (float)psState->ui32RefHz) / (float)ui32Ticks;
+            psReading->ui32Method = g_ui32FreqMethod;
+            psReading->ui32Time = xTaskGetTickCount();
+            return(true);
+        }
+    }
+
+    return(false);
+}
+
+//*****************************************************************************
+//
+// Hands a reading to the latest value channel and the subscribers.
+//
+//*****************************************************************************
+static void
+prvPublish(const FreqReading_t *psReading)
+{
+    FreqSubscriber_t *psSubscriber;
+
+    SEQ_CHANNEL_WRITE(&g_sFreqLatest, psReading);
+    for(psSubscriber = g_psFreqSubscribers; psSubscriber != NULL;
+        psSubscriber = psSubscriber->psNext)
+    {
+        psSubscriber->pfnReading(psReading, psSubscriber->pvArg);
+    }
+}
+
+//*****************************************************************************
+//
+// Reads the log once a gate, publishes the readings and chooses the method.
+//
+//*****************************************************************************
+static void
+prvFreqMeterTask(void *pvParameters)
+{
+    static FreqState_t sState;
+    FreqReading_t sReading;
+    TickType_t xWake, xLastEntry;
+    uint32_t ui32Epoch, ui32Written;
+    bool bNew, bMade, bTimedOut = false;
+
+    (void)pvParameters;
+
+    ui32Epoch = g_ui32FreqEpoch;
+    prvStateReset(&sState, 0);
+    xWake = xLastEntry = xTaskGetTickCount();
+
+    for(;;)
+    {
+        vTaskDelayUntil(&xWake, pdMS_TO_TICKS(FREQ_METER_GATE_MS));
+
+        //
+        // Entries from before a clock change are on another time scale.
+        //
+        if(ui32Epoch != g_ui32FreqEpoch)
+        {
+            ui32Epoch = g_ui32FreqEpoch;
+            prvStateReset(&sState, prvWrittenGet());
+            continue;
+        }
+
+        //
+        // Unread entries more than a half behind may have been written over.
+        // Only edges too fast to time fill the log that quickly.
+        //
+        ui32Written = prvWrittenGet();
+        if((ui32Written - sState.ui32Read) > FREQ_METER_BLOCK)
+        {
+            g_ui32FreqOverruns++;
+            prvMethodSet(FREQ_METHOD_COUNT);
+            prvStateReset(&sState, 0);
+            continue;
+        }
+
+        bNew = sState.ui32Read != ui32Written;
+        while(sState.ui32Read != ui32Written)
+        {
+            prvEntryAdd(&sState,
+                        g_pui32FreqLog[sState.ui32Read % FREQ_METER_LOG_LEN]);
+            sState.ui32Read++;
+        }
+
+        //
+        // Every gate is marked, but only one with new entries is published.
+        // No edge for a while reads as none at all, once; the next edge
+        // starts afresh rather than making a period of the silence.
+        //
+        bMade = prvReadingMake(&sState, &sReading);
+        if(bNew)
+        {
+            xLastEntry = xTaskGetTickCount();
+            bTimedOut = false;
+        }
+        else if((g_ui32FreqMethod == FREQ_METHOD_PERIOD) && !bTimedOut &&
+                ((xTaskGetTickCount() - xLastEntry) >=
+                 pdMS_TO_TICKS(FREQ_METER_TIMEOUT_MS)))
+        {
+            sReading = (FreqReading_t){ 0.0f, 0, FREQ_METHOD_NONE,
+                                        xTaskGetTickCount() };
+            prvPublish(&sReading);
+            prvStateReset(&sState, ui32Written);
+            bTimedOut = true;
+        }
+        if(!bNew || !bMade)
+        {
+            continue;
+        }
+        prvPublish(&sReading);
+
+        if((g_ui32FreqMethod == FREQ_METHOD_PERIOD) &&
+           (sReading.fHz > FREQ_METER_UP_HZ))
+        {
+            prvMethodSet(FREQ_METHOD_COUNT);
+            prvStateReset(&sState, 0);
+        }
+        else if((g_ui32FreqMethod == FREQ_METHOD_COUNT) &&
+                (sReading.fHz < FREQ_METER_DOWN_HZ))
+        {
+            prvMethodSet(FREQ_METHOD_PERIOD);
+            prvStateReset(&sState, 0);
+            xLastEntry = xTaskGetTickCount();
+        }
+    }
+}
@@ -0,0 +1,115 @@
+//*****************************************************************************
+//
+// freq_meter.h - Frequency measurement of a pulse input by timer capture,
+//                switching between period measurement and gated counting.
+//
+//*****************************************************************************
+
+#ifndef __FREQ_METER_H__
+#define __FREQ_METER_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Measurement tuning.  Every FREQ_METER_GATE_MS the meter takes what the
+// hardware has logged and publishes a reading averaged over the last
+// FREQ_METER_AVG_GATES gates.  It measures periods below FREQ_METER_UP_HZ
+// and counts edges above it, going back to periods below FREQ_METER_DOWN_HZ.
+// With no edge for FREQ_METER_TIMEOUT_MS the input reads as 0 Hz, which is
+// also the lowest frequency that can be told apart from none.
+//
+//*****************************************************************************
+#define FREQ_METER_GATE_MS      100
+#define FREQ_METER_AVG_GATES    4
+#define FREQ_METER_UP_HZ        2000
+#define FREQ_METER_DOWN_HZ      1000
+#define FREQ_METER_TIMEOUT_MS   2000
+
+//*****************************************************************************
+//
+// The number of entries in each half of the uDMA log.  Timing edges, a half
+// must hold more than a gate's worth at FREQ_METER_UP_HZ.
+//
+//*****************************************************************************
+#define FREQ_METER_BLOCK        256
+
+//*****************************************************************************
+//
+// Priority of the task that reads the log and calls the subscribers.
+//
+//*****************************************************************************
+#define FREQ_METER_TASK_PRIORITY                                              \
+                                (tskIDLE_PRIORITY + 3)
+
+//*****************************************************************************
+//
+// How a reading was made.
+//
+//*****************************************************************************
+#define FREQ_METHOD_NONE        0       // No edge within the timeout
+#define FREQ_METHOD_PERIOD      1       // Edge times, averaged
+#define FREQ_METHOD_COUNT       2       // Edges counted over timed gates
+
+//*****************************************************************************
+//
+// A reading.  fHz is the mean frequency over the ui32Edges edges it was
+// made from, ui32Method is one of the FREQ_METHOD_xxx values and ui32Time the
+// tick it was published on.
+//
+//*****************************************************************************
+typedef struct
+{
+    float fHz;
+    uint32_t ui32Edges;
+    uint32_t ui32Method;
+    uint32_t ui32Time;
+}
+FreqReading_t;
+
+//*****************************************************************************
+//
+// A subscription to the readings.  pfnReading is called from the meter task
+// with each new reading, so should be quick; it may use the FreeRTOS API.
+//
+//*****************************************************************************
+typedef struct FreqSubscriber
+{
+    void (*pfnReading)(const FreqReading_t *psReading, void *pvArg);
+    void *pvArg;
+    struct FreqSubscriber *psNext;
+}
+FreqSubscriber_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern bool FreqMeterInit(uint32_t ui32SysClock);
+extern void FreqMeterSubscribe(FreqSubscriber_t *psSubscriber);
+extern uint32_t FreqMeterReadingGet(FreqReading_t *psReading,
+                                    uint32_t *pui32Seq);
+extern uint32_t FreqMeterOverrunsGet(void);
+extern void FreqMeterCaptureIntHandler(void);
+extern void FreqMeterGateIntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FREQ_METER_H__
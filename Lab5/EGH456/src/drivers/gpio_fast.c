@@ -0,0 +1,158 @@
+//*****************************************************************************
+//
+// gpio_fast.c - Cycle benchmark for the compile time GPIO pins.
+//
+// The accessors themselves are in gpio_fast.h.  The benchmark times the
+// paths that moved to them against the driverlib calls they replaced: the
+// chip select and data/command framing of a display word, and the LED toggle
+// the 10 Hz timer interrupt used to do.  Everything runs on LED D3 so the
+// panel is left alone.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_gpio.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "utils/uartstdio.h"
+#include "drivers/cycle_counter.h"
+#include "drivers/gpio_fast.h"
+
+//*****************************************************************************
+//
+// The pin used for the benchmark, and the number of times each path is run.
+//
+//*****************************************************************************
+#define GPIO_BENCH_BASE         GPIO_PORTF_BASE
+#define GPIO_BENCH_PIN          GPIO_PIN_4
+#define GPIO_BENCH_BIT          4
+#define GPIO_BENCH_LOOPS        1000
+
+GPIO_FAST_PIN(BenchPin, GPIO_BENCH_BASE, GPIO_BENCH_PIN)
+
+//*****************************************************************************
+//
+// Prints one row: the cycles per iteration of each version of a path.  The
+// loop overhead (a compare and a branch) is included in both.
+//
+//*****************************************************************************
+static void
+prvBenchRow(const char *pcName, uint32_t ui32Lib, uint32_t ui32Fast)
+{
+    UARTprintf("%22s %9d %6d\n", pcName, ui32Lib / GPIO_BENCH_LOOPS,
+               ui32Fast / GPIO_BENCH_LOOPS);
+}
+
+//*****************************************************************************
+//
+//! Prints the cycle cost of the GPIO paths on the console.
+//!
+//! Each path is timed with driverlib calls and with a GPIO_FAST_PIN()
+//! accessor, with interrupts masked.  LED D3 flickers while it runs.  Must be
+//! called from a task, after the LED pins have been made outputs.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+vGpioFastBenchmark(void)
+{
+    uint32_t ui32Idx, ui32Start, ui32Lib, ui32Fast;
+
+    CycleCounterInit();
+    UARTprintf("path                   driverlib   fast\n");
+
+    taskENTER_CRITICAL();
+
+    //
+    // One pin high then low.
+    //
+    ui32Start = CycleCounterGet();
+    for(ui32Idx = 0; ui32Idx < GPIO_BENCH_LOOPS; ui32Idx++)
+    {
+        GPIOPinWrite(GPIO_BENCH_BASE, GPIO_BENCH_PIN, GPIO_BENCH_PIN);
+        GPIOPinWrite(GPIO_BENCH_BASE, GPIO_BENCH_PIN, 0);
+    }
+    ui32Lib = CycleCounterGet() - ui32Start;
+
+    ui32Start = CycleCounterGet();
+    for(ui32Idx = 0; ui32Idx < GPIO_BENCH_LOOPS; ui32Idx++)
+    {
+        BenchPinSet();
+        BenchPinClear();
+    }
+    ui32Fast = CycleCounterGet() - ui32Start;
+
+    taskEXIT_CRITICAL();
+    prvBenchRow("pin set + clear", ui32Lib, ui32Fast);
+    taskENTER_CRITICAL();
+
+    //
+    // The pin writes around each word sent to the panel: data/command, then
+    // chip select low and high again.
+    //
+    ui32Start = CycleCounterGet();
+    for(ui32Idx = 0; ui32Idx < GPIO_BENCH_LOOPS; ui32Idx++)
+    {
+        GPIOPinWrite(GPIO_BENCH_BASE, GPIO_BENCH_PIN, GPIO_BENCH_PIN);
+        GPIOPinWrite(GPIO_BENCH_BASE, GPIO_BENCH_PIN, 0);
+        GPIOPinWrite(GPIO_BENCH_BASE, GPIO_BENCH_PIN, GPIO_BENCH_PIN);
+    }
+    ui32Lib = CycleCounterGet() - ui32Start;
+
+    ui32Start = CycleCounterGet();
+    for(ui32Idx = 0; ui32Idx < GPIO_BENCH_LOOPS; ui32Idx++)
+    {
+        BenchPinSet();
+        BenchPinClear();
+        BenchPinSet();
+    }
+    ui32Fast = CycleCounterGet() - ui32Start;
+
+    taskEXIT_CRITICAL();
+    prvBenchRow("display word framing", ui32Lib, ui32Fast);
+    taskENTER_CRITICAL();
+
+    //
+    // An LED toggle, as the timer interrupt used to do it.
+    //
+    ui32Start = CycleCounterGet();
+    for(ui32Idx = 0; ui32Idx < GPIO_BENCH_LOOPS; ui32Idx++)
+    {
+        GPIOPinWrite(GPIO_BENCH_BASE, GPIO_BENCH_PIN,
+                     ~GPIOPinRead(GPIO_BENCH_BASE, GPIO_BENCH_PIN) &
+                     GPIO_BENCH_PIN);
+    }
+    ui32Lib = CycleCounterGet() - ui32Start;
+
+    ui32Start = CycleCounterGet();
+    for(ui32Idx = 0; ui32Idx < GPIO_BENCH_LOOPS; ui32Idx++)
+    {
+        BenchPinToggle();
+    }
+    ui32Fast = CycleCounterGet() - ui32Start;
+
+    taskEXIT_CRITICAL();
+    prvBenchRow("isr led toggle", ui32Lib, ui32Fast);
+    taskENTER_CRITICAL();
+
+    //
+    // The same set and clear through the bit-band alias of the full DATA
+    // register, for comparison with the masked address.
+    //
+    ui32Start = CycleCounterGet();
+    for(ui32Idx = 0; ui32Idx < GPIO_BENCH_LOOPS; ui32Idx++)
+    {
+        HWREGBITW(GPIO_FAST_DATA(GPIO_BENCH_BASE, 0xff), GPIO_BENCH_BIT) = 1;
+        HWREGBITW(GPIO_FAST_DATA(GPIO_BENCH_BASE, 0xff), GPIO_BENCH_BIT) = 0;
+    }
+    ui32Fast = CycleCounterGet() - ui32Start;
+
+    taskEXIT_CRITICAL();
+    UARTprintf("%22s %16d\n", "bit-band set + clear",
+               ui32Fast / GPIO_BENCH_LOOPS);
+}
@@ -0,0 +1,111 @@
+//*****************************************************************************
+//
+// gpio_fast.h - GPIO pins fixed at compile time, with accessors that compile
+//               to a single load or store.
+//
+// GPIOPinWrite() and GPIOPinRead() take the port and pins as arguments, so
+// every call costs a branch, the argument set up and the address arithmetic
+// before the one store that does the work.  The GPIO DATA register is
+// aliased over 256 words: address bits 9:2 of an access select which pins
+// it reads or writes, so a store to GPIO_O_DATA + (pins << 2) changes those
+// pins and no others.  When the port and pins are constants that address is
+// a constant too.
+//
+// GPIO_FAST_PIN(Name, Base, Pins) defines static inline NameSet(),
+// NameClear(), NameWrite(), NameRead() and NameToggle() for one pin or a
+// group of pins on one port.  Set, Clear and Write are one store and Read is
+// one load; Toggle is a load and a store to the masked address, so it leaves
+// the other pins of the port alone but is not atomic against another writer
+// of the same pins.
+//
+// The bit-band alias of the DATA register would also reach a single pin with
+// one store, but the bus turns a bit-band write into a read-modify-write of
+// the whole register.  The masked address needs no read, so it is used for
+// pins.  Bit-banding remains the right tool for flags in SRAM (HWREGBITW()).
+//
+//*****************************************************************************
+
+#ifndef __GPIO_FAST_H__
+#define __GPIO_FAST_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_gpio.h"
+#include "inc/hw_types.h"
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The address of the GPIO DATA register alias that reads and writes only the
+// given pins of a port.
+//
+//*****************************************************************************
+#define GPIO_FAST_DATA(ui32Base, ui8Pins)                                     \
+        ((ui32Base) + GPIO_O_DATA + ((uint32_t)(ui8Pins) << 2))
+
+//*****************************************************************************
+//
+// Defines the accessors for a pin, or a group of pins on one port.  Base is
+// one of the GPIO_PORTx_BASE values and Pins a combination of GPIO_PIN_x;
+// both must be constants.  Write() and Read() take and return the pin bits
+// in place, like GPIOPinWrite() and GPIOPinRead().
+//
+//*****************************************************************************
+#define GPIO_FAST_PIN(Name, Base, Pins)                                       \
+static inline void                                                            \
+Name##Set(void)                                                               \
+{                                                                             \
+    HWREG(GPIO_FAST_DATA(Base, Pins)) = (Pins);                               \
+}                                                                             \
+                                                                              \
+static inline void                                                            \
+Name##Clear(void)                                                             \
+{                                                                             \
+    HWREG(GPIO_FAST_DATA(Base, Pins)) = 0;                                    \
+}                                                                             \
+                                                                              \
+static inline void                                                            \
+Name##Write(uint8_t ui8Val)                                                   \
+{                                                                             \
+    HWREG(GPIO_FAST_DATA(Base, Pins)) = ui8Val;                               \
+}                                                                             \
+                                                                              \
+static inline uint8_t                                                         \
+Name##Read(void)                                                              \
+{                                                                             \
+    return(HWREG(GPIO_FAST_DATA(Base, Pins)));                                \
+}                                                                             \
+                                                                              \
+static inline void                                                            \
+Name##Toggle(void)                                                            \
+{                                                                             \
+    HWREG(GPIO_FAST_DATA(Base, Pins)) ^= (Pins);                              \
+}
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void vGpioFastBenchmark(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GPIO_FAST_H__
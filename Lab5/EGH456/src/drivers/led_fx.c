@@ -0,0 +1,708 @@
+//*****************************************************************************
+//
+// led_fx.c - Blink, breathe and sequence patterns on the user LEDs, played
+//            from a timer interrupt.
+//
+// A pattern is a table of steps, each a target brightness reached at once or
+// by a linear fade over a given time.  The patterns run entirely in the
+// Timer 4A interrupt: no task is woken, and once every LED has finished its
+// pattern and is fully on or off the timer is stopped, so a steady LED costs
+// no CPU time at all.
+//
+// D4 (PF0) is the only user LED on a PWM output, M0PWM0, so its brightness is
+// set in hardware and the interrupt only writes a new compare value once a
+// frame.  D1 to D3 are plain GPIOs.  For these Timer 4A runs at LED_FX_PWM_HZ:
+// the timeout interrupt switches on every lit LED and the match interrupt is
+// moved from one switch-off time to the next, so a period takes at most one
+// interrupt more than the number of dimmed LEDs.  At 200 Hz and three dimmed
+// LEDs that is 800 short interrupts a second.
+//
+// Brightness levels are perceptual: the duty cycle is the square of the
+// level, so a linear fade looks even.
+//
+// Timer 4 counts the 16 MHz PIOSC, so only the PWM generator has to follow
+// system clock changes.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_gpio.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/pwm.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "drivers/clock_scale.h"
+#include "drivers/gpio_fast.h"
+#include "drivers/led_fx.h"
+
+//*****************************************************************************
+//
+// Hardware resources.
+//
+//*****************************************************************************
+#define LED_FX_TIMER_PERIPH     SYSCTL_PERIPH_TIMER4
+#define LED_FX_TIMER_BASE       TIMER4_BASE
+#define LED_FX_TIMER_INT        INT_TIMER4A
+#define LED_FX_TIMER_HZ         16000000
+
+#define LED_FX_PWM_PERIPH       SYSCTL_PERIPH_PWM0
+#define LED_FX_PWM_BASE         PWM0_BASE
+#define LED_FX_PWM_GEN          PWM_GEN_0
+#define LED_FX_PWM_OUT          PWM_OUT_0
+#define LED_FX_PWM_OUT_BIT      PWM_OUT_0_BIT
+#define LED_FX_PWM_DIV          PWM_SYSCLK_DIV_2
+#define LED_FX_PWM_DIVISOR      2
+
+//
+// The PWM clock divider is shared by every generator in the module, and the
+// wave generator (see wave_gen.c) needs a fast PWM clock for its duty
+// resolution.  To fit D4's period in 16 bits at that clock, its generator
+// runs at LED_FX_PWM_GEN_HZ rather than LED_FX_PWM_HZ.
+//
+#define LED_FX_PWM_GEN_HZ       1000
+
+//
+// The interrupt calls no FreeRTOS API, and nothing depends on its latency, so
+// it runs at the lowest priority.
+//
+#define LED_FX_INT_PRIORITY     0xe0
+
+//*****************************************************************************
+//
+// Timing of the software PWM, in Timer 4 ticks.  Switch-off times closer
+// than LED_FX_MIN_ON to the start of the period, or to each other, are
+// handled in one interrupt.
+//
+//*****************************************************************************
+#define LED_FX_PERIOD           (LED_FX_TIMER_HZ / LED_FX_PWM_HZ)
+#define LED_FX_PERIODS_PER_FRAME                                              \
+                                (LED_FX_PWM_HZ * LED_FX_FRAME_MS / 1000)
+#define LED_FX_MIN_ON           64
+
+//*****************************************************************************
+//
+// The LEDs switched by software, in LED_FX_Dn bit order.  The last LED,
+// D4, is the one on the PWM generator.
+//
+//*****************************************************************************
+#define LED_FX_NUM_SOFT         3
+#define LED_FX_HW               3
+
+typedef struct
+{
+    uint32_t ui32Base;
+    uint8_t ui8Pin;
+}
+LedFxPin_t;
+
+static const LedFxPin_t g_psLedFxPins[LED_FX_NUM_SOFT] =
+{
+    { GPIO_PORTN_BASE, GPIO_PIN_1 },
+    { GPIO_PORTN_BASE, GPIO_PIN_0 },
+    { GPIO_PORTF_BASE, GPIO_PIN_4 },
+};
+
+//*****************************************************************************
+//
+// Built in patterns.
+//
+//*****************************************************************************
+#define LED_FX_STEPS(psSteps)   (psSteps), sizeof(psSteps) / sizeof(psSteps[0])
+
+static const LedFxStep_t g_psLedFxBlinkSteps[] =
+{
+    { 255, 0, 100 },
+    { 0, 0, 900 },
+};
+
+static const LedFxStep_t g_psLedFxBreatheSteps[] =
+{
+    { 255, LED_FX_FADE, 1500 },
+    { 0, LED_FX_FADE, 1500 },
+};
+
+static const LedFxStep_t g_psLedFxHeartbeatSteps[] =
+{
+    { 255, 0, 60 },
+    { 0, 0, 140 },
+    { 255, 0, 60 },
+    { 0, 0, 740 },
+};
+
+static const LedFxStep_t g_psLedFxChaseSteps[] =
+{
+    { 255, 0, 150 },
+    { 0, LED_FX_FADE, 300 },
+    { 0, 0, 150 },
+};
+
+const LedFxPattern_t g_sLedFxBlink = { LED_FX_STEPS(g_psLedFxBlinkSteps), 0 };
+const LedFxPattern_t g_sLedFxBreathe =
+{
+    LED_FX_STEPS(g_psLedFxBreatheSteps), 0
+};
+const LedFxPattern_t g_sLedFxHeartbeat =
+{
+    LED_FX_STEPS(g_psLedFxHeartbeatSteps), 0
+};
+const LedFxPattern_t g_sLedFxChase = { LED_FX_STEPS(g_psLedFxChaseSteps), 0 };
+
+//*****************************************************************************
+//
+// The state of one LED.  psPattern is 0 when the LED holds a steady level.
+//
+//*****************************************************************************
+typedef struct
+{
+    const LedFxPattern_t *psPattern;
+    uint32_t ui32DelayFrames;
+    uint16_t ui16Frame;
+    uint16_t ui16Frames;
+    uint8_t ui8Step;
+    uint8_t ui8Loops;
+    uint8_t ui8From;
+    uint8_t ui8Level;
+}
+LedFxChannel_t;
+
+static LedFxChannel_t g_psLedFxChannels[LED_FX_NUM_LEDS];
+
+//
+// The software PWM schedule for the current frame: the LEDs switched on at
+// the start of each period, and the switch-off times, earliest first.
+//
+static uint32_t g_ui32LedFxOnMask;
+static uint32_t g_pui32LedFxEdgeTicks[LED_FX_NUM_SOFT];
+static uint8_t g_pui8LedFxEdgeLed[LED_FX_NUM_SOFT];
+static uint32_t g_ui32LedFxNumEdges;
+static uint32_t g_ui32LedFxNextEdge;
+static uint32_t g_ui32LedFxPhase;
+static volatile bool g_bLedFxRunning = false;
+
+//
+// The PWM generator period in PWM clocks, and the level last applied to it.
+//
+static uint32_t g_ui32LedFxPwmLoad;
+static uint8_t g_ui8LedFxPwmLevel;
+
+//*****************************************************************************
+//
+// Switches one of the software LEDs.
+//
+//*****************************************************************************
+static inline void
+prvPinWrite(uint32_t ui32Led, bool bOn)
+{
+    const LedFxPin_t *psPin = &g_psLedFxPins[ui32Led];
+
+    HWREG(GPIO_FAST_DATA(psPin->ui32Base, psPin->ui8Pin)) =
+        bOn ? psPin->ui8Pin : 0;
+}
+
+//*****************************************************************************
+//
+// Sets the brightness of the PWM LED.
+//
+//*****************************************************************************
+static void
+prvPwmApply(uint8_t ui8Level)
+{
+    uint32_t ui32Width;
+
+    g_ui8LedFxPwmLevel = ui8Level;
+    if(ui8Level == 0)
+    {
+        PWMOutputState(LED_FX_PWM_BASE, LED_FX_PWM_OUT_BIT, false);
+        return;
+    }
+
+    ui32Width = (g_ui32LedFxPwmLoad * ui8Level * ui8Level) / (255 * 255);
+    if(ui32Width == 0)
+    {
+        ui32Width = 1;
+    }
+    if(ui32Width >= g_ui32LedFxPwmLoad)
+    {
+        ui32Width = g_ui32LedFxPwmLoad - 1;
+    }
+    PWMPulseWidthSet(LED_FX_PWM_BASE, LED_FX_PWM_OUT, ui32Width);
+    PWMOutputState(LED_FX_PWM_BASE, LED_FX_PWM_OUT_BIT, true);
+}
+
+//*****************************************************************************
+//
+// Programs the PWM period for a system clock frequency.
+//
+//*****************************************************************************
+static void
+prvPwmLoadSet(uint32_t ui32SysClock)
+{
+    g_ui32LedFxPwmLoad = ui32SysClock / LED_FX_PWM_DIVISOR /
+                         LED_FX_PWM_GEN_HZ;
+    PWMGenPeriodSet(LED_FX_PWM_BASE, LED_FX_PWM_GEN, g_ui32LedFxPwmLoad);
+}
+
+static void
+prvLedFxClockPost(uint32_t ui32NewHz, void *pvArg)
+{
+    (void)pvArg;
+
+    prvPwmLoadSet(ui32NewHz);
+    prvPwmApply(g_ui8LedFxPwmLevel);
+}
+
+static ClockNotifier_t g_sLedFxClockNotifier =
+{
+    0, prvLedFxClockPost, 0, 0
+};
+static bool g_bLedFxClockRegistered = false;
+
+//*****************************************************************************
+//
+// Enters the current step of an LED's pattern.
+//
+//*****************************************************************************
+static void
+prvStepStart(LedFxChannel_t *psChan)
+{
+    uint32_t ui32Ms;
+
+    ui32Ms = psChan->psPattern->psSteps[psChan->ui8Step].ui16Ms;
+    psChan->ui16Frames = (ui32Ms + LED_FX_FRAME_MS - 1) / LED_FX_FRAME_MS;
+    if(psChan->ui16Frames == 0)
+    {
+        psChan->ui16Frames = 1;
+    }
+    psChan->ui16Frame = 0;
+    psChan->ui8From = psChan->ui8Level;
+}
+
+//*****************************************************************************
+//
+// Advances an LED's pattern by one frame.
+//
+//*****************************************************************************
+static void
+prvChannelFrame(LedFxChannel_t *psChan)
+{
+    const LedFxStep_t *psStep;
+    int32_t i32Delta;
+
+    if(psChan->psPattern == 0)
+    {
+        return;
+    }
+    if(psChan->ui32DelayFrames)
+    {
+        psChan->ui32DelayFrames--;
+        return;
+    }
+
+    psStep = &psChan->psPattern->psSteps[psChan->ui8Step];
+    psChan->ui16Frame++;
+    if(psStep->ui8Flags & LED_FX_FADE)
+    {
+        i32Delta = (int32_t)psStep->ui8Level - psChan->ui8From;
+        psChan->ui8Level = psChan->ui8From +
+                           (i32Delta * psChan->ui16Frame) / psChan->ui16Frames;
+    }
+    else
+    {
+        psChan->ui8Level = psStep->ui8Level;
+    }
+
+    if(psChan->ui16Frame < psChan->ui16Frames)
+    {
+        return;
+    }
+
+    //
+    // The step is over.  Move on to the next, going back to the first at the
+    // end of the table for as long as the pattern repeats.
+    //
+    if(++psChan->ui8Step == psChan->psPattern->ui8NumSteps)
+    {
+        psChan->ui8Step = 0;
+        if(psChan->ui8Loops && (--psChan->ui8Loops == 0))
+        {
+            psChan->psPattern = 0;
+            return;
+        }
+    }
+    prvStepStart(psChan);
+}
+
+//*****************************************************************************
+//
+// Builds the software PWM schedule from the LED levels.
+//
+//*****************************************************************************
+static void
+prvSchedule(void)
+{
+    uint32_t ui32Led, ui32Ticks, ui32Idx;
+    uint8_t ui8Level;
+
+    g_ui32LedFxOnMask = 0;
+    g_ui32LedFxNumEdges = 0;
+
+    for(ui32Led = 0; ui32Led < LED_FX_NUM_SOFT; ui32Led++)
+    {
+        ui8Level = g_psLedFxChannels[ui32Led].ui8Level;
+        if(ui8Level == 0)
+        {
+            continue;
+        }
+        g_ui32LedFxOnMask |= 1 << ui32Led;
+        if(ui8Level == 255)
+        {
+            continue;
+        }
+
+        ui32Ticks = (ui8Level * ui8Level * (LED_FX_PERIOD / 255)) / 255;
+        if(ui32Ticks < LED_FX_MIN_ON)
+        {
+            ui32Ticks = LED_FX_MIN_ON;
+        }
+
+        //
+        // Insert in order of switch-off time.
+        //
+        for(ui32Idx = g_ui32LedFxNumEdges;
+            (ui32Idx > 0) && (g_pui32LedFxEdgeTicks[ui32Idx - 1] > ui32Ticks);
+            ui32Idx--)
+        {
+            g_pui32LedFxEdgeTicks[ui32Idx] = g_pui32LedFxEdgeTicks[ui32Idx - 1];
+            g_pui8LedFxEdgeLed[ui32Idx] = g_pui8LedFxEdgeLed[ui32Idx - 1];
+        }
+        g_pui32LedFxEdgeTicks[ui32Idx] = ui32Ticks;
+        g_pui8LedFxEdgeLed[ui32Idx] = ui32Led;
+        g_ui32LedFxNumEdges++;
+    }
+}
+
+//*****************************************************************************
+//
+// Runs one frame: advances every pattern, applies the new levels, and stops
+// the timer if nothing is left for it to do.
+//
+//*****************************************************************************
+static void
+prvFrame(void)
+{
+    uint32_t ui32Led;
+    bool bBusy;
+
+    bBusy = false;
+    for(ui32Led = 0; ui32Led < LED_FX_NUM_LEDS; ui32Led++)
+    {
+        prvChannelFrame(&g_psLedFxChannels[ui32Led]);
+        if(g_psLedFxChannels[ui32Led].psPattern != 0)
+        {
+            bBusy = true;
+        }
+    }
+
+    if(g_psLedFxChannels[LED_FX_HW].ui8Level != g_ui8LedFxPwmLevel)
+    {
+        prvPwmApply(g_psLedFxChannels[LED_FX_HW].ui8Level);
+    }
+
+    prvSchedule();
+    if(!bBusy && (g_ui32LedFxNumEdges == 0))
+    {
+        TimerDisable(LED_FX_TIMER_BASE, TIMER_A);
+        g_bLedFxRunning = false;
+    }
+}
+
+//*****************************************************************************
+//
+// Switches off every LED whose time in this period is up, and sets the match
+// interrupt for the next one.
+//
+//*****************************************************************************
+static void
+prvEdges(void)
+{
+    uint32_t ui32Elapsed, ui32Edge;
+
+    ui32Elapsed = (LED_FX_PERIOD - 1) -
+                  TimerValueGet(LED_FX_TIMER_BASE, TIMER_A);
+
+    while(g_ui32LedFxNextEdge < g_ui32LedFxNumEdges)
+    {
+        ui32Edge = g_pui32LedFxEdgeTicks[g_ui32LedFxNextEdge];
+        if(ui32Edge > ui32Elapsed + LED_FX_MIN_ON)
+        {
+            //
+            // The timer counts down, so the match value is the time left.
+            //
+            TimerMatchSet(LED_FX_TIMER_BASE, TIMER_A,
+                          (LED_FX_PERIOD - 1) - ui32Edge);
+            return;
+        }
+        prvPinWrite(g_pui8LedFxEdgeLed[g_ui32LedFxNextEdge], false);
+        g_ui32LedFxNextEdge++;
+    }
+
+    //
+    // Nothing left this period; the counter never reaches this value.
+    //
+    TimerMatchSet(LED_FX_TIMER_BASE, TIMER_A, 0xffffffff);
+}
+
+//*****************************************************************************
+//
+// Starts the timer if it is stopped.  The first frame runs at the end of the
+// first period.  Called with interrupts disabled.
+//
+//*****************************************************************************
+static void
+prvStart(void)
+{
+    if(g_bLedFxRunning)
+    {
+        return;
+    }
+
+    g_ui32LedFxPhase = LED_FX_PERIODS_PER_FRAME - 1;
+    g_ui32LedFxNumEdges = 0;
+    TimerMatchSet(LED_FX_TIMER_BASE, TIMER_A, 0xffffffff);
+    TimerLoadSet(LED_FX_TIMER_BASE, TIMER_A, LED_FX_PERIOD - 1);
+    TimerEnable(LED_FX_TIMER_BASE, TIMER_A);
+    g_bLedFxRunning = true;
+}
+
+//*****************************************************************************
+//
+//! Handles the Timer 4A interrupt.
+//!
+//! This is registered by LedFxInit().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LedFxIntHandler(void)
+{
+    uint32_t ui32Status, ui32Led;
+
+    ui32Status = TimerIntStatus(LED_FX_TIMER_BASE, true);
+    TimerIntClear(LED_FX_TIMER_BASE, ui32Status);
+
+    if(ui32Status & TIMER_TIMA_TIMEOUT)
+    {
+        //
+        // A new period.  Any match still pending belongs to the last one.
+        //
+        if(++g_ui32LedFxPhase >= LED_FX_PERIODS_PER_FRAME)
+        {
+            g_ui32LedFxPhase = 0;
+            prvFrame();
+        }
+
+        for(ui32Led = 0; ui32Led < LED_FX_NUM_SOFT; ui32Led++)
+        {
+            prvPinWrite(ui32Led, (g_ui32LedFxOnMask >> ui32Led) & 1);
+        }
+
+        if(g_bLedFxRunning)
+        {
+            g_ui32LedFxNextEdge = 0;
+            prvEdges();
+        }
+    }
+    else if(ui32Status & TIMER_TIMA_MATCH)
+    {
+        prvEdges();
+    }
+}
+
+//*****************************************************************************
+//
+//! Initializes the LED effects and switches every LED off.
+//!
+//! \param ui32SysClock is the system clock frequency in Hz.
+//!
+//! This takes over PN0, PN1, PF0 and PF4, Timer 4 and PWM generator 0.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LedFxInit(uint32_t ui32SysClock)
+{
+    uint32_t ui32Led;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPION);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
+    SysCtlPeripheralEnable(LED_FX_PWM_PERIPH);
+    SysCtlPeripheralEnable(LED_FX_TIMER_PERIPH);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPION) ||
+          !SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOF) ||
+          !SysCtlPeripheralReady(LED_FX_PWM_PERIPH) ||
+          !SysCtlPeripheralReady(LED_FX_TIMER_PERIPH))
+    {
+    }
+
+    for(ui32Led = 0; ui32Led < LED_FX_NUM_LEDS; ui32Led++)
+    {
+        g_psLedFxChannels[ui32Led].psPattern = 0;
+        g_psLedFxChannels[ui32Led].ui8Level = 0;
+    }
+
+    //
+    // The software LEDs.
+    //
+    for(ui32Led = 0; ui32Led < LED_FX_NUM_SOFT; ui32Led++)
+    {
+        GPIOPinTypeGPIOOutput(g_psLedFxPins[ui32Led].ui32Base,
+                              g_psLedFxPins[ui32Led].ui8Pin);
+        prvPinWrite(ui32Led, false);
+    }
+
+    //
+    // D4 on M0PWM0.  The generator counts down, so the output is high for
+    // the pulse width at the end of each period.
+    //
+    GPIOPinConfigure(GPIO_PF0_M0PWM0);
+    GPIOPinTypePWM(GPIO_PORTF_BASE, GPIO_PIN_0);
+    PWMClockSet(LED_FX_PWM_BASE, LED_FX_PWM_DIV);
+    PWMGenConfigure(LED_FX_PWM_BASE, LED_FX_PWM_GEN,
+                    PWM_GEN_MODE_DOWN | PWM_GEN_MODE_NO_SYNC);
+    prvPwmLoadSet(ui32SysClock);
+    prvPwmApply(0);
+    PWMGenEnable(LED_FX_PWM_BASE, LED_FX_PWM_GEN);
+
+    //
+    // Timer 4A, from the PIOSC, with the timeout starting each PWM period
+    // and the match ending the on time of the software LEDs.
+    //
+    SysCtlAltClkConfig(SYSCTL_ALTCLK_PIOSC);
+    TimerConfigure(LED_FX_TIMER_BASE, TIMER_CFG_PERIODIC);
+    TimerClockSourceSet(LED_FX_TIMER_BASE, TIMER_CLOCK_PIOSC);
+    TimerLoadSet(LED_FX_TIMER_BASE, TIMER_A, LED_FX_PERIOD - 1);
+    TimerMatchSet(LED_FX_TIMER_BASE, TIMER_A, 0xffffffff);
+    TimerIntRegister(LED_FX_TIMER_BASE, TIMER_A, LedFxIntHandler);
+    IntPrioritySet(LED_FX_TIMER_INT, LED_FX_INT_PRIORITY);
+    TimerIntEnable(LED_FX_TIMER_BASE, TIMER_TIMA_TIMEOUT | TIMER_TIMA_MATCH);
+    g_bLedFxRunning = false;
+
+    if(!g_bLedFxClockRegistered)
+    {
+        ClockNotifierRegister(&g_sLedFxClockNotifier);
+        g_bLedFxClockRegistered = true;
+    }
+}
+
+//*****************************************************************************
+//
+//! Plays a pattern on one or more LEDs.
+//!
+//! \param ui32Leds is a combination of the \b LED_FX_Dn values.
+//! \param psPattern is the pattern.  It is used in place, so it must stay
+//! valid while it plays.
+//! \param ui32StaggerMs delays the start of each LED after the first, in
+//! LED_FX_Dn order, by this much more than the one before.  Use 0 to start
+//! them together.
+//!
+//! Replaces whatever the LEDs were doing.  Each LED starts from its current
+//! brightness.  May be called from a task or an interrupt.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LedFxPlay(uint32_t ui32Leds, const LedFxPattern_t *psPattern,
+          uint32_t ui32StaggerMs)
+{
+    LedFxChannel_t *psChan;
+    uint32_t ui32Led, ui32DelayMs;
+    bool bDisabled;
+
+    bDisabled = IntMasterDisable();
+
+    ui32DelayMs = 0;
+    for(ui32Led = 0; ui32Led < LED_FX_NUM_LEDS; ui32Led++)
+    {
+        if(!(ui32Leds & (1 << ui32Led)))
+        {
+            continue;
+        }
+
+        psChan = &g_psLedFxChannels[ui32Led];
+        psChan->psPattern = psPattern;
+        psChan->ui32DelayFrames = ui32DelayMs / LED_FX_FRAME_MS;
+        psChan->ui8Step = 0;
+        psChan->ui8Loops = psPattern->ui8Repeat;
+        prvStepStart(psChan);
+
+        ui32DelayMs += ui32StaggerMs;
+    }
+    prvStart();
+
+    if(!bDisabled)
+    {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Sets one or more LEDs to a steady brightness.
+//!
+//! \param ui32Leds is a combination of the \b LED_FX_Dn values.
+//! \param ui8Level is the brightness, from 0 (off) to 255 (full on).
+//!
+//! Stops any pattern playing on the LEDs.  The new level is applied within
+//! one frame.  May be called from a task or an interrupt.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LedFxSet(uint32_t ui32Leds, uint8_t ui8Level)
+{
+    uint32_t ui32Led;
+    bool bDisabled;
+
+    bDisabled = IntMasterDisable();
+
+    for(ui32Led = 0; ui32Led < LED_FX_NUM_LEDS; ui32Led++)
+    {
+        if(ui32Leds & (1 << ui32Led))
+        {
+            g_psLedFxChannels[ui32Led].psPattern = 0;
+            g_psLedFxChannels[ui32Led].ui8Level = ui8Level;
+        }
+    }
+    prvStart();
+
+    if(!bDisabled)
+    {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Reports whether the LED timer is stopped.
+//!
+//! The timer stops once no pattern is playing and every LED other than D4 is
+//! fully on or off.  D4 can hold any brightness without it.
+//!
+//! \return Returns \b true if the LEDs are taking no CPU time.
+//
+//*****************************************************************************
+bool
+LedFxIsIdle(void)
+{
+    return(!g_bLedFxRunning);
+}
@@ -0,0 +1,111 @@
+//*****************************************************************************
+//
+// led_fx.h - Blink, breathe and sequence patterns on the user LEDs, played
+//            from a timer interrupt.
+//
+//*****************************************************************************
+
+#ifndef __LED_FX_H__
+#define __LED_FX_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The user LEDs, as bits of the ui32Leds arguments.
+//
+//*****************************************************************************
+#define LED_FX_D1               0x00000001  // PN1
+#define LED_FX_D2               0x00000002  // PN0
+#define LED_FX_D3               0x00000004  // PF4
+#define LED_FX_D4               0x00000008  // PF0, M0PWM0
+#define LED_FX_ALL              0x0000000f
+#define LED_FX_NUM_LEDS         4
+
+//*****************************************************************************
+//
+// Timing.  The LEDs without a PWM output are switched by Timer 4 at
+// LED_FX_PWM_HZ; patterns advance once every LED_FX_FRAME_MS.
+//
+//*****************************************************************************
+#define LED_FX_PWM_HZ           200
+#define LED_FX_FRAME_MS         20
+
+//*****************************************************************************
+//
+// Step flags.
+//
+//*****************************************************************************
+#define LED_FX_FADE             0x01    // Ramp to the level over the step
+
+//*****************************************************************************
+//
+// One step of a pattern: go to ui8Level, at once or by a linear fade, and
+// take ui16Ms over it.  Levels are perceptual, 0 (off) to 255 (full on).
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t ui8Level;
+    uint8_t ui8Flags;
+    uint16_t ui16Ms;
+}
+LedFxStep_t;
+
+//*****************************************************************************
+//
+// A pattern, normally a const table in flash.  ui8Repeat is the number of
+// times the steps are played, or 0 to play them until replaced.  When a
+// pattern ends the LED holds the level of the last step.
+//
+//*****************************************************************************
+typedef struct
+{
+    const LedFxStep_t *psSteps;
+    uint8_t ui8NumSteps;
+    uint8_t ui8Repeat;
+}
+LedFxPattern_t;
+
+//*****************************************************************************
+//
+// Built in patterns.  g_sLedFxChase is 600 ms long, for four LEDs staggered
+// by 150 ms.
+//
+//*****************************************************************************
+extern const LedFxPattern_t g_sLedFxBlink;
+extern const LedFxPattern_t g_sLedFxBreathe;
+extern const LedFxPattern_t g_sLedFxHeartbeat;
+extern const LedFxPattern_t g_sLedFxChase;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void LedFxInit(uint32_t ui32SysClock);
+extern void LedFxPlay(uint32_t ui32Leds, const LedFxPattern_t *psPattern,
+                      uint32_t ui32StaggerMs);
+extern void LedFxSet(uint32_t ui32Leds, uint8_t ui8Level);
+extern bool LedFxIsIdle(void);
+extern void LedFxIntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LED_FX_H__
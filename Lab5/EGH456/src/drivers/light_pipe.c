@@ -0,0 +1,128 @@
+//*****************************************************************************
+//
+// light_pipe.c - The light sensor's processing, from raw reading to filtered
+//                sample, thresholds and next sampling period.
+//
+// The sensor task reads the OPT3001 and hands each raw reading to
+// LightPipeStep(), which does everything that depends only on the readings:
+// the conversion to lux, the moving average, the threshold checks and the
+// choice of the next sampling period.  It is kept apart from the task and
+// the kernel so that the host can replay recorded readings through the same
+// code and check that its output is unchanged to the bit.  The figures of
+// the line the display task prints are here for the same reason.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "drivers/opt3001.h"
+#include "drivers/adapt_rate.h"
+#include "drivers/light_pipe.h"
+
+//*****************************************************************************
+//
+//! Sets up the processing, with an empty filter.
+//!
+//! \param psPipe is the processing state.
+//! \param ui32MinMs is the sampling period while the light is changing, in
+//! ms.
+//! \param ui32MaxMs is the longest period once it has settled.
+//! \param ui32StepMs is how much the period lengthens at a time, as
+//! AdaptRateInit() takes it.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LightPipeInit(LightPipe_t *psPipe, uint32_t ui32MinMs, uint32_t ui32MaxMs,
+              uint32_t ui32StepMs)
+{
+    memset(psPipe, 0, sizeof(*psPipe));
+    AdaptRateInit(&psPipe->sRate, ui32MinMs, ui32MaxMs, ui32StepMs);
+}
+
+//*****************************************************************************
+//
+//! Processes a raw reading.
+//!
+//! \param psPipe is the processing state.
+//! \param ui16Raw is the reading, from the OPT3001's result register.
+//! \param ui32Time is the tick to stamp the sample with.
+//! \param psSample is filled in with the sample.
+//! \param pui32PeriodMs is filled in with the period to the next reading, in
+//! ms.  A reading that crosses a threshold goes back to the fast rate.
+//!
+//! \return Returns the thresholds the reading is beyond, as LIGHT_EV_HIGH or
+//! LIGHT_EV_LOW, or zero.
+//
+//*****************************************************************************
+uint32_t
+LightPipeStep(LightPipe_t *psPipe, uint16_t ui16Raw, uint32_t ui32Time,
+              LightSensorData_t *psSample, uint32_t *pui32PeriodMs)
+{
+    uint32_t ui32Events = 0, ui32Idx;
+    float fLux, fSum;
+
+    sensorOpt3001Convert(ui16Raw, &fLux);
+    *pui32PeriodMs = AdaptRateUpdate(&psPipe->sRate, fLux);
+
+    if(fLux > LIGHT_MAX_LUX)
+    {
+        ui32Events = LIGHT_EV_HIGH;
+    }
+    else if(fLux < LIGHT_MIN_LUX)
+    {
+        ui32Events = LIGHT_EV_LOW;
+    }
+    if(ui32Events != psPipe->ui32Beyond)
+    {
+        psPipe->ui32Beyond = ui32Events;
+        *pui32PeriodMs = AdaptRateBoost(&psPipe->sRate);
+    }
+
+    psPipe->pfWindow[psPipe->ui32Index] = fLux;
+    psPipe->ui32Index = (psPipe->ui32Index + 1) % LIGHT_FILTER_WINDOW;
+    if(psPipe->ui32Count < LIGHT_FILTER_WINDOW)
+    {
+        psPipe->ui32Count++;
+    }
+    fSum = 0;
+    for(ui32Idx = 0; ui32Idx < psPipe->ui32Count; ui32Idx++)
+    {
+        fSum += psPipe->pfWindow[ui32Idx];
+    }
+
+    psSample->raw_lux = ui16Raw;
+    psSample->lux_value = fLux;
+    psSample->filtered_lux = fSum / psPipe->ui32Count;
+    psSample->timestamp = ui32Time;
+
+    return(ui32Events);
+}
+
+//*****************************************************************************
+//
+//! Splits a sample into the figures of its display line.
+//!
+//! \param psSample is the sample.
+//! \param pi32Parts is filled in with the whole lux and hundredths of the
+//! level, then the same for the filtered level, ready to print with
+//! LIGHT_LINE_FORMAT.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LightPipeLine(const LightSensorData_t *psSample, int32_t *pi32Parts)
+{
+    int32_t i32Raw, i32Filtered;
+
+    i32Raw = (int32_t)(psSample->lux_value * 100);
+    i32Filtered = (int32_t)(psSample->filtered_lux * 100);
+
+    pi32Parts[0] = i32Raw / 100;
+    pi32Parts[1] = i32Raw % 100;
+    pi32Parts[2] = i32Filtered / 100;
+    pi32Parts[3] = i32Filtered % 100;
+}
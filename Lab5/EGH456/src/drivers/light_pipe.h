@@ -0,0 +1,101 @@
+//*****************************************************************************
+//
+// light_pipe.h - The light sensor's processing, from raw reading to filtered
+//                sample, thresholds and next sampling period.
+//
+//*****************************************************************************
+
+#ifndef __LIGHT_PIPE_H__
+#define __LIGHT_PIPE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The thresholds, in lux, and the number of readings the filter averages.
+//
+//*****************************************************************************
+#define LIGHT_MAX_LUX           100
+#define LIGHT_MIN_LUX           5
+#define LIGHT_FILTER_WINDOW     10
+
+//*****************************************************************************
+//
+// The thresholds a reading is beyond, as LightPipeStep() returns them.
+//
+//*****************************************************************************
+#define LIGHT_EV_HIGH           0x00000001
+#define LIGHT_EV_LOW            0x00000002
+
+//*****************************************************************************
+//
+// The line the display task prints for a sample, given the four figures
+// LightPipeLine() splits it into.
+//
+//*****************************************************************************
+#define LIGHT_LINE_FORMAT       "A%d.%02dB%d.%02d"
+#define LIGHT_LINE_PARTS        4
+
+//*****************************************************************************
+//
+// A processed sample: the raw reading, its level in lux, the filtered level
+// and the tick it was processed on.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint16_t raw_lux;
+    float lux_value;
+    float filtered_lux;
+    uint32_t timestamp;
+}
+LightSensorData_t;
+
+//*****************************************************************************
+//
+// The state of the processing.  Set up with LightPipeInit(); the members are
+// private.
+//
+//*****************************************************************************
+typedef struct
+{
+    float pfWindow[LIGHT_FILTER_WINDOW];
+    uint32_t ui32Index;
+    uint32_t ui32Count;
+    uint32_t ui32Beyond;
+    AdaptRate_t sRate;
+}
+LightPipe_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void LightPipeInit(LightPipe_t *psPipe, uint32_t ui32MinMs,
+                          uint32_t ui32MaxMs, uint32_t ui32StepMs);
+extern uint32_t LightPipeStep(LightPipe_t *psPipe, uint16_t ui16Raw,
+                              uint32_t ui32Time, LightSensorData_t *psSample,
+                              uint32_t *pui32PeriodMs);
+extern void LightPipeLine(const LightSensorData_t *psSample,
+                          int32_t *pi32Parts);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIGHT_PIPE_H__
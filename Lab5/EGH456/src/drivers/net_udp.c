@@ -0,0 +1,1044 @@
+//*****************************************************************************
+//
+// net_udp.c - Minimal ARP, IPv4 and UDP over the Ethernet MAC, with
+//             application buffers handed to the DMA descriptors directly.
+//
+// This is not a general IP stack: there is no TCP, no fragmentation, no
+// routing and no ICMP.  It exists to move telemetry datagrams between the
+// board and hosts on the same subnet at Ethernet rates.
+//
+// Every frame lives in a buffer from a fixed pool for its whole life.  A
+// sender takes a buffer with NetUdpAlloc(), writes its payload at the
+// offset returned, and NetUdpSend() fills in the headers in front of it and
+// hands the same buffer to a transmit descriptor.  The buffer returns to the
+// pool when the MAC releases the descriptor.  Receive descriptors each hold
+// a pool buffer; when one fills it is swapped for a fresh buffer and the
+// received one is processed in place.  An ARP request is answered by
+// rewriting the request and transmitting the same buffer.  No payload byte is
+// copied by the stack.
+//
+// The MAC is only reached through the descriptors and pfnPollDemand, so the
+// same code runs against the EMAC0 DMA or the software model in emac_model.c.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/emac.h"
+#include "driverlib/flash.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "drivers/net_udp.h"
+
+//*****************************************************************************
+//
+// Protocol constants.
+//
+//*****************************************************************************
+#define NET_ETHERTYPE_IP        0x0800
+#define NET_ETHERTYPE_ARP       0x0806
+#define NET_ARP_LEN             28
+#define NET_ARP_REQUEST         1
+#define NET_ARP_REPLY           2
+#define NET_IP_PROTO_UDP        17
+#define NET_IP_TTL              64
+#define NET_IP_BROADCAST        0xffffffff
+
+//*****************************************************************************
+//
+// ARP cache entry states and lifetimes, in calls to NetArpTick().
+//
+//*****************************************************************************
+#define NET_ARP_FREE            0
+#define NET_ARP_PENDING         1
+#define NET_ARP_RESOLVED        2
+#define NET_ARP_LIFETIME        120
+#define NET_ARP_RETRIES         3
+
+//*****************************************************************************
+//
+// Big-endian field access.  Headers start two bytes off word alignment
+// behind the Ethernet header, so fields are read a byte at a time.
+//
+//*****************************************************************************
+static uint16_t
+prvGet16(const uint8_t *pui8P)
+{
+    return(((uint16_t)pui8P[0] << 8) | pui8P[1]);
+}
+
+static uint32_t
+prvGet32(const uint8_t *pui8P)
+{
+    return(((uint32_t)pui8P[0] << 24) | ((uint32_t)pui8P[1] << 16) |
+           ((uint32_t)pui8P[2] << 8) | pui8P[3]);
+}
+
+static void
+prvPut16(uint8_t *pui8P, uint16_t ui16V)
+{
+    pui8P[0] = ui16V >> 8;
+    pui8P[1] = ui16V;
+}
+
+static void
+prvPut32(uint8_t *pui8P, uint32_t ui32V)
+{
+    pui8P[0] = ui32V >> 24;
+    pui8P[1] = ui32V >> 16;
+    pui8P[2] = ui32V >> 8;
+    pui8P[3] = ui32V;
+}
+
+//*****************************************************************************
+//
+// Returns the Internet checksum of a block.
+//
+//*****************************************************************************
+static uint16_t
+prvChecksum(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+    uint32_t ui32Sum = 0;
+
+    while(ui32Len > 1)
+    {
+        ui32Sum += prvGet16(pui8Data);
+        pui8Data += 2;
+        ui32Len -= 2;
+    }
+    if(ui32Len)
+    {
+        ui32Sum += (uint32_t)pui8Data[0] << 8;
+    }
+    while(ui32Sum >> 16)
+    {
+        ui32Sum = (ui32Sum & 0xffff) + (ui32Sum >> 16);
+    }
+
+    return(~ui32Sum & 0xffff);
+}
+
+//*****************************************************************************
+//
+// Buffer pool.  Called with the interface lock held.
+//
+//*****************************************************************************
+static NetBuf_t *
+prvBufAlloc(NetIf_t *psIf)
+{
+    NetBuf_t *psBuf = psIf->psFree;
+
+    if(psBuf)
+    {
+        psIf->psFree = psBuf->psNext;
+        psBuf->psNext = NULL;
+    }
+
+    return(psBuf);
+}
+
+static void
+prvBufFree(NetIf_t *psIf, NetBuf_t *psBuf)
+{
+    psBuf->psNext = psIf->psFree;
+    psIf->psFree = psBuf;
+}
+
+//*****************************************************************************
+//
+// Gives a receive descriptor a buffer and returns it to the MAC.
+//
+//*****************************************************************************
+static void
+prvRxArm(NetIf_t *psIf, uint32_t ui32Idx, NetBuf_t *psBuf)
+{
+    tEMACDMADescriptor *psDesc = &psIf->psRxDesc[ui32Idx];
+
+    psIf->ppsRxBuf[ui32Idx] = psBuf;
+    psDesc->pvBuffer1 = psBuf->pui32Frame;
+    psDesc->ui32Count = DES1_RX_CTRL_CHAINED |
+                        (NET_BUF_SIZE << DES1_RX_CTRL_BUFF1_SIZE_S);
+    psDesc->ui32CtrlStatus = DES0_RX_CTRL_OWN;
+}
+
+//*****************************************************************************
+//
+// Returns completed transmit buffers to the pool.
+//
+//*****************************************************************************
+static void
+prvTxReclaim(NetIf_t *psIf)
+{
+    tEMACDMADescriptor *psDesc;
+
+    while(psIf->ui32TxTail != psIf->ui32TxHead)
+    {
+        psDesc = &psIf->psTxDesc[psIf->ui32TxTail % NET_TX_DESC];
+        if(psDesc->ui32CtrlStatus & DES0_TX_CTRL_OWN)
+        {
+            break;
+        }
+
+        prvBufFree(psIf, psIf->ppsTxBuf[psIf->ui32TxTail % NET_TX_DESC]);
+        psIf->ppsTxBuf[psIf->ui32TxTail % NET_TX_DESC] = NULL;
+        psIf->ui32TxTail++;
+        psIf->ui32TxFrames++;
+    }
+}
+
+//*****************************************************************************
+//
+// Hands a complete frame to the MAC.  The buffer is owned by the transmit
+// ring, or freed if the ring is full.
+//
+//*****************************************************************************
+static bool
+prvTxQueue(NetIf_t *psIf, NetBuf_t *psBuf)
+{
+    tEMACDMADescriptor *psDesc;
+    uint32_t ui32Idx;
+
+    prvTxReclaim(psIf);
+    if((psIf->ui32TxHead - psIf->ui32TxTail) == NET_TX_DESC)
+    {
+        prvBufFree(psIf, psBuf);
+        psIf->ui32Drops++;
+        return(false);
+    }
+
+    ui32Idx = psIf->ui32TxHead % NET_TX_DESC;
+    psDesc = &psIf->psTxDesc[ui32Idx];
+    psIf->ppsTxBuf[ui32Idx] = psBuf;
+    psDesc->pvBuffer1 = psBuf->pui32Frame;
+    psDesc->ui32Count = (uint32_t)psBuf->ui16Len << DES1_TX_CTRL_BUFF1_SIZE_S;
+
+    //
+    // The OWN bit is written last; the Cortex-M4 does not reorder stores to
+    // SRAM, so the MAC never sees a half written descriptor.
+    //
+    psDesc->ui32CtrlStatus = DES0_TX_CTRL_OWN | DES0_TX_CTRL_INTERRUPT |
+                             DES0_TX_CTRL_FIRST_SEG | DES0_TX_CTRL_LAST_SEG |
+                             DES0_TX_CTRL_CHAINED |
+                             (psIf->bChecksumOffload ?
+                              DES0_TX_CTRL_IP_ALL_CKHSUMS :
+                              DES0_TX_CTRL_NO_CHKSUM);
+    psIf->ui32TxHead++;
+
+    psIf->pfnPollDemand(psIf->pvHw, true);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Fills in the Ethernet header and transmits.
+//
+//*****************************************************************************
+static bool
+prvEthSend(NetIf_t *psIf, NetBuf_t *psBuf, const uint8_t *pui8Dst,
+           uint16_t ui16Type)
+{
+    uint8_t *pui8Frame = (uint8_t *)psBuf->pui32Frame;
+
+    memcpy(pui8Frame, pui8Dst, 6);
+    memcpy(pui8Frame + 6, psIf->pui8Mac, 6);
+    prvPut16(pui8Frame + 12, ui16Type);
+
+    return(prvTxQueue(psIf, psBuf));
+}
+
+//*****************************************************************************
+//
+// Builds an ARP packet in psBuf and sends it.
+//
+//*****************************************************************************
+static bool
+prvArpSend(NetIf_t *psIf, NetBuf_t *psBuf, uint16_t ui16Op,
+           const uint8_t *pui8TargetMac, uint32_t ui32TargetIp)
+{
+    static const uint8_t pui8Broadcast[6] =
+    {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+    };
+    uint8_t *pui8Arp = (uint8_t *)psBuf->pui32Frame + NET_ETH_HDR_LEN;
+
+    prvPut16(pui8Arp, 1);
+    prvPut16(pui8Arp + 2, NET_ETHERTYPE_IP);
+    pui8Arp[4] = 6;
+    pui8Arp[5] = 4;
+    prvPut16(pui8Arp + 6, ui16Op);
+    memcpy(pui8Arp + 8, psIf->pui8Mac, 6);
+    prvPut32(pui8Arp + 14, psIf->ui32Ip);
+    if(pui8TargetMac)
+    {
+        memcpy(pui8Arp + 18, pui8TargetMac, 6);
+    }
+    else
+    {
+        memset(pui8Arp + 18, 0, 6);
+    }
+    prvPut32(pui8Arp + 24, ui32TargetIp);
+
+    //
+    // Pad to the minimum frame length; the MAC pads as well, but the model
+    // does not.
+    //
+    memset(pui8Arp + NET_ARP_LEN, 0, 60 - NET_ETH_HDR_LEN - NET_ARP_LEN);
+    psBuf->ui16Len = 60;
+
+    return(prvEthSend(psIf, psBuf,
+                      pui8TargetMac ? pui8TargetMac : pui8Broadcast,
+                      NET_ETHERTYPE_ARP));
+}
+
+//*****************************************************************************
+//
+// Sends an ARP request for ui32Ip from a fresh buffer.
+//
+//*****************************************************************************
+static void
+prvArpRequest(NetIf_t *psIf, uint32_t ui32Ip)
+{
+    NetBuf_t *psBuf = prvBufAlloc(psIf);
+
+    if(psBuf == NULL)
+    {
+        psIf->ui32Drops++;
+        return;
+    }
+    prvArpSend(psIf, psBuf, NET_ARP_REQUEST, NULL, ui32Ip);
+}
+
+//*****************************************************************************
+//
+// Returns a free ARP entry, or failing that the oldest one.
+//
+//*****************************************************************************
+static NetArpEntry_t *
+prvArpVictim(NetIf_t *psIf)
+{
+    NetArpEntry_t *psEntry = &psIf->psArp[0];
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < NET_ARP_ENTRIES; ui32Idx++)
+    {
+        if(psIf->psArp[ui32Idx].ui8State == NET_ARP_FREE)
+        {
+            return(&psIf->psArp[ui32Idx]);
+        }
+        if(psIf->psArp[ui32Idx].ui8Age > psEntry->ui8Age)
+        {
+            psEntry = &psIf->psArp[ui32Idx];
+        }
+    }
+
+    return(psEntry);
+}
+
+//*****************************************************************************
+//
+// Records a resolved address and releases any datagram waiting for it.
+//
+//*****************************************************************************
+static void
+prvArpLearn(NetIf_t *psIf, uint32_t ui32Ip, const uint8_t *pui8Mac,
+            bool bCreate)
+{
+    NetArpEntry_t *psEntry = NULL;
+    NetBuf_t *psPending;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < NET_ARP_ENTRIES; ui32Idx++)
+    {
+        if((psIf->psArp[ui32Idx].ui8State != NET_ARP_FREE) &&
+           (psIf->psArp[ui32Idx].ui32Ip == ui32Ip))
+        {
+            psEntry = &psIf->psArp[ui32Idx];
+            break;
+        }
+    }
+
+    if(psEntry == NULL)
+    {
+        if(!bCreate)
+        {
+            return;
+        }
+        psEntry = prvArpVictim(psIf);
+        if(psEntry->psPending)
+        {
+            prvBufFree(psIf, psEntry->psPending);
+            psIf->ui32Drops++;
+        }
+        psEntry->psPending = NULL;
+    }
+
+    psEntry->ui32Ip = ui32Ip;
+    memcpy(psEntry->pui8Mac, pui8Mac, 6);
+    psEntry->ui8State = NET_ARP_RESOLVED;
+    psEntry->ui8Age = 0;
+
+    psPending = psEntry->psPending;
+    if(psPending)
+    {
+        psEntry->psPending = NULL;
+        prvEthSend(psIf, psPending, pui8Mac, NET_ETHERTYPE_IP);
+    }
+}
+
+//*****************************************************************************
+//
+// Handles a received ARP packet.  Consumes the buffer.
+//
+//*****************************************************************************
+static void
+prvArpInput(NetIf_t *psIf, NetBuf_t *psBuf)
+{
+    uint8_t *pui8Arp = (uint8_t *)psBuf->pui32Frame + NET_ETH_HDR_LEN;
+    uint8_t pui8SenderMac[6];
+    uint32_t ui32SenderIp;
+
+    if((psBuf->ui16Len < (NET_ETH_HDR_LEN + NET_ARP_LEN)) ||
+       (prvGet16(pui8Arp) != 1) ||
+       (prvGet16(pui8Arp + 2) != NET_ETHERTYPE_IP) ||
+       (prvGet32(pui8Arp + 24) != psIf->ui32Ip))
+    {
+        prvBufFree(psIf, psBuf);
+        return;
+    }
+
+    memcpy(pui8SenderMac, pui8Arp + 8, 6);
+    ui32SenderIp = prvGet32(pui8Arp + 14);
+
+    //
+    // A host asking for our address will be sent traffic next, so it goes in
+    // the cache either way.
+    //
+    prvArpLearn(psIf, ui32SenderIp, pui8SenderMac, true);
+
+    if(prvGet16(pui8Arp + 6) == NET_ARP_REQUEST)
+    {
+        prvArpSend(psIf, psBuf, NET_ARP_REPLY, pui8SenderMac, ui32SenderIp);
+    }
+    else
+    {
+        prvBufFree(psIf, psBuf);
+    }
+}
+
+//*****************************************************************************
+//
+// Handles a received IPv4 packet.  Consumes the buffer.
+//
+//*****************************************************************************
+static void
+prvIpInput(NetIf_t *psIf, NetBuf_t *psBuf)
+{
+    uint8_t *pui8Ip = (uint8_t *)psBuf->pui32Frame + NET_ETH_HDR_LEN;
+    uint8_t *pui8Udp;
+    uint32_t ui32HdrLen, ui32TotLen, ui32UdpLen, ui32Dst, ui32Idx;
+    uint16_t ui16Port;
+
+    if(psBuf->ui16Len < (NET_ETH_HDR_LEN + NET_IP_HDR_LEN))
+    {
+        goto drop;
+    }
+
+    ui32HdrLen = (pui8Ip[0] & 0x0f) * 4;
+    ui32TotLen = prvGet16(pui8Ip + 2);
+    ui32Dst = prvGet32(pui8Ip + 16);
+
+    //
+    // IPv4, no fragments, addressed to us, and the header checksum verifies.
+    // The MAC checks the Ethernet CRC, which also covers the UDP payload, so
+    // the UDP checksum is not verified.
+    //
+    if(((pui8Ip[0] >> 4) != 4) || (ui32HdrLen < NET_IP_HDR_LEN) ||
+       (ui32TotLen < (ui32HdrLen + NET_UDP_HDR_LEN)) ||
+       ((NET_ETH_HDR_LEN + ui32TotLen) > psBuf->ui16Len) ||
+       (prvGet16(pui8Ip + 6) & 0x3fff) ||
+       (pui8Ip[9] != NET_IP_PROTO_UDP) ||
+       ((ui32Dst != psIf->ui32Ip) && (ui32Dst != NET_IP_BROADCAST)) ||
+       (prvChecksum(pui8Ip, ui32HdrLen) != 0))
+    {
+        goto drop;
+    }
+
+    pui8Udp = pui8Ip + ui32HdrLen;
+    ui32UdpLen = prvGet16(pui8Udp + 4);
+    if((ui32UdpLen < NET_UDP_HDR_LEN) ||
+       (ui32UdpLen > (ui32TotLen - ui32HdrLen)))
+    {
+        goto drop;
+    }
+
+    ui16Port = prvGet16(pui8Udp + 2);
+    for(ui32Idx = 0; ui32Idx < NET_UDP_SOCKETS; ui32Idx++)
+    {
+        if(psIf->psSockets[ui32Idx].pfnRx &&
+           (psIf->psSockets[ui32Idx].ui16Port == ui16Port))
+        {
+            psIf->psSockets[ui32Idx].pfnRx(pui8Udp + NET_UDP_HDR_LEN,
+                                           ui32UdpLen - NET_UDP_HDR_LEN,
+                                           prvGet32(pui8Ip + 12),
+                                           prvGet16(pui8Udp),
+                                           psIf->psSockets[ui32Idx].pvArg);
+            break;
+        }
+    }
+
+drop:
+    prvBufFree(psIf, psBuf);
+}
+
+//*****************************************************************************
+//
+//! Initialises an interface and its descriptor rings.
+//!
+//! \param psIf is the interface.
+//! \param pui8Mac is the interface's MAC address.
+//! \param ui32Ip is the interface's IPv4 address, in host order.
+//! \param pfnPollDemand wakes the MAC DMA after descriptors are handed over.
+//! \param pvHw is passed to pfnPollDemand.
+//! \param bChecksumOffload is \b true if the MAC inserts IP and UDP
+//! checksums on transmit.
+//!
+//! The rings are ready to hand to the MAC when this returns.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+NetIfInit(NetIf_t *psIf, const uint8_t *pui8Mac, uint32_t ui32Ip,
+          void (*pfnPollDemand)(void *pvHw, bool bTx), void *pvHw,
+          bool bChecksumOffload)
+{
+    uint32_t ui32Idx;
+
+    memset(psIf, 0, sizeof(*psIf));
+    memcpy(psIf->pui8Mac, pui8Mac, 6);
+    psIf->ui32Ip = ui32Ip;
+    psIf->pfnPollDemand = pfnPollDemand;
+    psIf->pvHw = pvHw;
+    psIf->bChecksumOffload = bChecksumOffload;
+    psIf->xLock = xSemaphoreCreateMutex();
+
+    for(ui32Idx = 0; ui32Idx < NET_BUF_COUNT; ui32Idx++)
+    {
+        prvBufFree(psIf, &psIf->psPool[ui32Idx]);
+    }
+
+    for(ui32Idx = 0; ui32Idx < NET_TX_DESC; ui32Idx++)
+    {
+        psIf->psTxDesc[ui32Idx].ui32CtrlStatus = DES0_TX_CTRL_CHAINED;
+        psIf->psTxDesc[ui32Idx].DES3.pLink =
+            &psIf->psTxDesc[(ui32Idx + 1) % NET_TX_DESC];
+    }
+    for(ui32Idx = 0; ui32Idx < NET_RX_DESC; ui32Idx++)
+    {
+        psIf->psRxDesc[ui32Idx].DES3.pLink =
+            &psIf->psRxDesc[(ui32Idx + 1) % NET_RX_DESC];
+        prvRxArm(psIf, ui32Idx, prvBufAlloc(psIf));
+    }
+}
+
+//*****************************************************************************
+//
+//! Binds a callback to a UDP port.
+//!
+//! \param psIf is the interface.
+//! \param ui16Port is the local port.
+//! \param pfnRx is called from NetPoll() for each datagram received on the
+//! port.  It must not call other functions of this interface.
+//! \param pvArg is passed to pfnRx.
+//!
+//! \return Returns \b false if all sockets are in use.
+//
+//*****************************************************************************
+bool
+NetUdpBind(NetIf_t *psIf, uint16_t ui16Port,
+           void (*pfnRx)(const uint8_t *pui8Data, uint32_t ui32Len,
+                         uint32_t ui32SrcIp, uint16_t ui16SrcPort,
+                         void *pvArg),
+           void *pvArg)
+{
+    uint32_t ui32Idx;
+    bool bOk = false;
+
+    xSemaphoreTake(psIf->xLock, portMAX_DELAY);
+    for(ui32Idx = 0; ui32Idx < NET_UDP_SOCKETS; ui32Idx++)
+    {
+        if(psIf->psSockets[ui32Idx].pfnRx == NULL)
+        {
+            psIf->psSockets[ui32Idx].ui16Port = ui16Port;
+            psIf->psSockets[ui32Idx].pvArg = pvArg;
+            psIf->psSockets[ui32Idx].pfnRx = pfnRx;
+            bOk = true;
+            break;
+        }
+    }
+    xSemaphoreGive(psIf->xLock);
+
+    return(bOk);
+}
+
+//*****************************************************************************
+//
+//! Takes a buffer for an outgoing datagram.
+//!
+//! \param psIf is the interface.
+//! \param ppui8Payload receives where to write the payload, up to
+//! NET_UDP_MAX_PAYLOAD bytes.
+//!
+//! The buffer must be passed to NetUdpSend(), which takes ownership of it.
+//!
+//! \return Returns the buffer, or NULL if the pool is empty.
+//
+//*****************************************************************************
+NetBuf_t *
+NetUdpAlloc(NetIf_t *psIf, uint8_t **ppui8Payload)
+{
+    NetBuf_t *psBuf;
+
+    xSemaphoreTake(psIf->xLock, portMAX_DELAY);
+    prvTxReclaim(psIf);
+    psBuf = prvBufAlloc(psIf);
+    xSemaphoreGive(psIf->xLock);
+
+    if(psBuf)
+    {
+        *ppui8Payload = (uint8_t *)psBuf->pui32Frame + NET_UDP_PAYLOAD_OFFSET;
+    }
+
+    return(psBuf);
+}
+
+//*****************************************************************************
+//
+//! Sends a datagram from a buffer returned by NetUdpAlloc().
+//!
+//! \param psIf is the interface.
+//! \param psBuf is the buffer holding the payload.
+//! \param ui32Len is the payload length.
+//! \param ui32DstIp is the destination address in host order;
+//! 0xffffffff broadcasts on the local network.
+//! \param ui16DstPort is the destination port.
+//! \param ui16SrcPort is the source port.
+//!
+//! The buffer is owned by the interface after this call, whatever the
+//! result.  If the destination's hardware address is not known the datagram
+//! is held while an ARP request is sent; only the latest datagram to an
+//! unresolved address is kept.
+//!
+//! \return Returns \b false if the datagram was dropped.
+//
+//*****************************************************************************
+bool
+NetUdpSend(NetIf_t *psIf, NetBuf_t *psBuf, uint32_t ui32Len,
+           uint32_t ui32DstIp, uint16_t ui16DstPort, uint16_t ui16SrcPort)
+{
+    static const uint8_t pui8Broadcast[6] =
+    {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+    };
+    uint8_t *pui8Ip = (uint8_t *)psBuf->pui32Frame + NET_ETH_HDR_LEN;
+    uint8_t *pui8Udp = pui8Ip + NET_IP_HDR_LEN;
+    NetArpEntry_t *psEntry;
+    uint32_t ui32Idx;
+    bool bOk;
+
+    xSemaphoreTake(psIf->xLock, portMAX_DELAY);
+
+    if(ui32Len > NET_UDP_MAX_PAYLOAD)
+    {
+        prvBufFree(psIf, psBuf);
+        psIf->ui32Drops++;
+        xSemaphoreGive(psIf->xLock);
+        return(false);
+    }
+
+    pui8Ip[0] = 0x45;
+    pui8Ip[1] = 0;
+    prvPut16(pui8Ip + 2, NET_IP_HDR_LEN + NET_UDP_HDR_LEN + ui32Len);
+    prvPut16(pui8Ip + 4, psIf->ui16IpId++);
+    prvPut16(pui8Ip + 6, 0x4000);
+    pui8Ip[8] = NET_IP_TTL;
+    pui8Ip[9] = NET_IP_PROTO_UDP;
+    prvPut16(pui8Ip + 10, 0);
+    prvPut32(pui8Ip + 12, psIf->ui32Ip);
+    prvPut32(pui8Ip + 16, ui32DstIp);
+
+    prvPut16(pui8Udp, ui16SrcPort);
+    prvPut16(pui8Udp + 2, ui16DstPort);
+    prvPut16(pui8Udp + 4, NET_UDP_HDR_LEN + ui32Len);
+    prvPut16(pui8Udp + 6, 0);
+
+    //
+    // With offload the MAC computes both checksums.  Without it only the
+    // header checksum is filled in; a zero UDP checksum means none.
+    //
+    if(!psIf->bChecksumOffload)
+    {
+        prvPut16(pui8Ip + 10, prvChecksum(pui8Ip, NET_IP_HDR_LEN));
+    }
+
+    psBuf->ui16Len = NET_UDP_PAYLOAD_OFFSET + ui32Len;
+    if(psBuf->ui16Len < 60)
+    {
+        memset((uint8_t *)psBuf->pui32Frame + psBuf->ui16Len, 0,
+               60 - psBuf->ui16Len);
+        psBuf->ui16Len = 60;
+    }
+
+    if(ui32DstIp == NET_IP_BROADCAST)
+    {
+        bOk = prvEthSend(psIf, psBuf, pui8Broadcast, NET_ETHERTYPE_IP);
+        xSemaphoreGive(psIf->xLock);
+        return(bOk);
+    }
+
+    psEntry = NULL;
+    for(ui32Idx = 0; ui32Idx < NET_ARP_ENTRIES; ui32Idx++)
+    {
+        if((psIf->psArp[ui32Idx].ui8State != NET_ARP_FREE) &&
+           (psIf->psArp[ui32Idx].ui32Ip == ui32DstIp))
+        {
+            psEntry = &psIf->psArp[ui32Idx];
+            break;
+        }
+    }
+
+    if(psEntry && (psEntry->ui8State == NET_ARP_RESOLVED))
+    {
+        bOk = prvEthSend(psIf, psBuf, psEntry->pui8Mac, NET_ETHERTYPE_IP);
+    }
+    else
+    {
+        if(psEntry == NULL)
+        {
+            psEntry = prvArpVictim(psIf);
+            if(psEntry->psPending)
+            {
+                prvBufFree(psIf, psEntry->psPending);
+                psEntry->psPending = NULL;
+                psIf->ui32Drops++;
+            }
+            psEntry->ui32Ip = ui32DstIp;
+            psEntry->ui8State = NET_ARP_PENDING;
+            psEntry->ui8Age = 0;
+            prvArpRequest(psIf, ui32DstIp);
+        }
+
+        if(psEntry->psPending)
+        {
+            prvBufFree(psIf, psEntry->psPending);
+            psIf->ui32Drops++;
+        }
+        psEntry->psPending = psBuf;
+        bOk = true;
+    }
+
+    xSemaphoreGive(psIf->xLock);
+
+    return(bOk);
+}
+
+//*****************************************************************************
+//
+//! Processes received frames and reclaims transmitted buffers.
+//!
+//! \param psIf is the interface.
+//!
+//! Call from the network task whenever the MAC interrupt notifies it.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+NetPoll(NetIf_t *psIf)
+{
+    tEMACDMADescriptor *psDesc;
+    NetBuf_t *psBuf, *psFresh;
+    uint32_t ui32Status;
+    bool bRearmed = false;
+
+    xSemaphoreTake(psIf->xLock, portMAX_DELAY);
+
+    prvTxReclaim(psIf);
+
+    for(;;)
+    {
+        psDesc = &psIf->psRxDesc[psIf->ui32RxNext];
+        ui32Status = psDesc->ui32CtrlStatus;
+        if(ui32Status & DES0_RX_CTRL_OWN)
+        {
+            break;
+        }
+
+        psBuf = psIf->ppsRxBuf[psIf->ui32RxNext];
+        psFresh = NULL;
+
+        //
+        // Frames are never larger than one buffer, so anything that is not a
+        // whole frame in one descriptor is an error.  Without a replacement
+        // buffer the frame is dropped and its buffer reused.
+        //
+        if((ui32Status & DES0_RX_STAT_ERR) ||
+           ((ui32Status & (DES0_RX_STAT_FIRST_DESC | DES0_RX_STAT_LAST_DESC)) !=
+            (DES0_RX_STAT_FIRST_DESC | DES0_RX_STAT_LAST_DESC)))
+        {
+            psIf->ui32RxErrors++;
+        }
+        else if((psFresh = prvBufAlloc(psIf)) == NULL)
+        {
+            psIf->ui32Drops++;
+        }
+
+        prvRxArm(psIf, psIf->ui32RxNext, psFresh ? psFresh : psBuf);
+        psIf->ui32RxNext = (psIf->ui32RxNext + 1) % NET_RX_DESC;
+        bRearmed = true;
+
+        if(psFresh)
+        {
+            //
+            // The length includes the four byte Ethernet CRC.
+            //
+            psBuf->ui16Len = ((ui32Status & DES0_RX_STAT_FRAME_LENGTH_M) >>
+                              DES0_RX_STAT_FRAME_LENGTH_S) - 4;
+            psIf->ui32RxFrames++;
+
+            switch(prvGet16((uint8_t *)psBuf->pui32Frame + 12))
+            {
+                case NET_ETHERTYPE_ARP:
+                {
+                    prvArpInput(psIf, psBuf);
+                    break;
+                }
+
+                case NET_ETHERTYPE_IP:
+                {
+                    prvIpInput(psIf, psBuf);
+                    break;
+                }
+
+                default:
+                {
+                    prvBufFree(psIf, psBuf);
+                    break;
+                }
+            }
+        }
+    }
+
+    if(bRearmed)
+    {
+        psIf->pfnPollDemand(psIf->pvHw, false);
+    }
+
+    xSemaphoreGive(psIf->xLock);
+}
+
+//*****************************************************************************
+//
+//! Ages the ARP cache.
+//!
+//! \param psIf is the interface.
+//!
+//! Call once a second.  Unanswered requests are repeated NET_ARP_RETRIES
+//! times before the held datagram is dropped; resolved entries expire after
+//! NET_ARP_LIFETIME seconds.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+NetArpTick(NetIf_t *psIf)
+{
+    NetArpEntry_t *psEntry;
+    uint32_t ui32Idx;
+
+    xSemaphoreTake(psIf->xLock, portMAX_DELAY);
+    for(ui32Idx = 0; ui32Idx < NET_ARP_ENTRIES; ui32Idx++)
+    {
+        psEntry = &psIf->psArp[ui32Idx];
+        if(psEntry->ui8State == NET_ARP_FREE)
+        {
+            continue;
+        }
+
+        psEntry->ui8Age++;
+        if(psEntry->ui8State == NET_ARP_PENDING)
+        {
+            if(psEntry->ui8Age > NET_ARP_RETRIES)
+            {
+                if(psEntry->psPending)
+                {
+                    prvBufFree(psIf, psEntry->psPending);
+                    psEntry->psPending = NULL;
+                    psIf->ui32Drops++;
+                }
+                psEntry->ui8State = NET_ARP_FREE;
+            }
+            else
+            {
+                prvArpRequest(psIf, psEntry->ui32Ip);
+            }
+        }
+        else if(psEntry->ui8Age > NET_ARP_LIFETIME)
+        {
+            psEntry->ui8State = NET_ARP_FREE;
+        }
+    }
+    xSemaphoreGive(psIf->xLock);
+}
+
+//*****************************************************************************
+//
+//! Returns the number of buffers left in the pool.
+//
+//*****************************************************************************
+uint32_t
+NetBufFreeCount(NetIf_t *psIf)
+{
+    const NetBuf_t *psBuf;
+    uint32_t ui32Count = 0;
+
+    xSemaphoreTake(psIf->xLock, portMAX_DELAY);
+    for(psBuf = psIf->psFree; psBuf; psBuf = psBuf->psNext)
+    {
+        ui32Count++;
+    }
+    xSemaphoreGive(psIf->xLock);
+
+    return(ui32Count);
+}
+
+//*****************************************************************************
+//
+// The EMAC0 binding.
+//
+//*****************************************************************************
+static TaskHandle_t g_xNetNotify = NULL;
+
+static void
+prvHwPollDemand(void *pvHw, bool bTx)
+{
+    (void)pvHw;
+
+    if(bTx)
+    {
+        EMACTxDMAPollDemand(EMAC0_BASE);
+    }
+    else
+    {
+        EMACRxDMAPollDemand(EMAC0_BASE);
+    }
+}
+
+//*****************************************************************************
+//
+//! Brings up EMAC0 and the internal PHY on an interface.
+//!
+//! \param psIf is the interface.
+//! \param ui32SysClock is the system clock frequency.
+//! \param ui32Ip is the interface's IPv4 address, in host order.
+//! \param xNotify is the task that calls NetPoll(); it is notified with
+//! xTaskNotifyGive() on every receive and transmit interrupt.
+//!
+//! The MAC address is read from the USER0 and USER1 registers, where it is
+//! programmed on the LaunchPad.  Auto-negotiation runs in the background.
+//!
+//! \return Returns \b false if no MAC address has been programmed.
+//
+//*****************************************************************************
+bool
+NetHwInit(NetIf_t *psIf, uint32_t ui32SysClock, uint32_t ui32Ip,
+          TaskHandle_t xNotify)
+{
+    uint32_t ui32User0, ui32User1;
+    uint8_t pui8Mac[6];
+
+    FlashUserGet(&ui32User0, &ui32User1);
+    if((ui32User0 == 0xffffffff) || (ui32User1 == 0xffffffff))
+    {
+        return(false);
+    }
+    pui8Mac[0] = ui32User0;
+    pui8Mac[1] = ui32User0 >> 8;
+    pui8Mac[2] = ui32User0 >> 16;
+    pui8Mac[3] = ui32User1;
+    pui8Mac[4] = ui32User1 >> 8;
+    pui8Mac[5] = ui32User1 >> 16;
+
+    NetIfInit(psIf, pui8Mac, ui32Ip, prvHwPollDemand, NULL, true);
+    g_xNetNotify = xNotify;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EMAC0);
+    SysCtlPeripheralReset(SYSCTL_PERIPH_EMAC0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EPHY0);
+    SysCtlPeripheralReset(SYSCTL_PERIPH_EPHY0);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_EMAC0))
+    {
+    }
+
+    EMACPHYConfigSet(EMAC0_BASE, EMAC_PHY_TYPE_INTERNAL |
+                     EMAC_PHY_INT_MDIX_EN | EMAC_PHY_AN_100B_T_FULL_DUPLEX);
+    EMACReset(EMAC0_BASE);
+    EMACInit(EMAC0_BASE, ui32SysClock, EMAC_BCONFIG_MIXED_BURST |
+             EMAC_BCONFIG_PRIORITY_FIXED, 4, 4, 0);
+    EMACConfigSet(EMAC0_BASE, EMAC_CONFIG_FULL_DUPLEX |
+                  EMAC_CONFIG_CHECKSUM_OFFLOAD | EMAC_CONFIG_7BYTE_PREAMBLE |
+                  EMAC_CONFIG_IF_GAP_96BITS | EMAC_CONFIG_USE_MACADDR0 |
+                  EMAC_CONFIG_SA_FROM_DESCRIPTOR | EMAC_CONFIG_BO_LIMIT_1024,
+                  EMAC_MODE_RX_STORE_FORWARD | EMAC_MODE_TX_STORE_FORWARD |
+                  EMAC_MODE_TX_THRESHOLD_64_BYTES |
+                  EMAC_MODE_RX_THRESHOLD_64_BYTES, 0);
+
+    EMACTxDMADescriptorListSet(EMAC0_BASE, psIf->psTxDesc);
+    EMACRxDMADescriptorListSet(EMAC0_BASE, psIf->psRxDesc);
+    EMACAddrSet(EMAC0_BASE, 0, pui8Mac);
+    EMACFrameFilterSet(EMAC0_BASE, EMAC_FRMFILTER_SADDR |
+                       EMAC_FRMFILTER_PASS_MULTICAST |
+                       EMAC_FRMFILTER_PASS_NO_CTRL);
+
+    EMACIntClear(EMAC0_BASE, EMACIntStatus(EMAC0_BASE, false));
+    EMACTxEnable(EMAC0_BASE);
+    EMACRxEnable(EMAC0_BASE);
+
+    EMACIntRegister(EMAC0_BASE, EMAC0IntHandler);
+    IntPrioritySet(INT_EMAC0, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    EMACIntEnable(EMAC0_BASE, EMAC_INT_RECEIVE | EMAC_INT_TRANSMIT |
+                  EMAC_INT_RX_NO_BUFFER);
+
+    EMACRxDMAPollDemand(EMAC0_BASE);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// The EMAC0 interrupt handler.  All work is deferred to the network task.
+//
+//*****************************************************************************
+void
+EMAC0IntHandler(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint32_t ui32Status;
+
+    ui32Status = EMACIntStatus(EMAC0_BASE, true);
+    EMACIntClear(EMAC0_BASE, ui32Status);
+
+    if(g_xNetNotify)
+    {
+        vTaskNotifyGiveFromISR(g_xNetNotify, &xHigherPriorityTaskWoken);
+    }
+
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
@@ -0,0 +1,175 @@
+//*****************************************************************************
+//
+// net_udp.h - Minimal ARP, IPv4 and UDP over the Ethernet MAC, with
+//             application buffers handed to the DMA descriptors directly.
+//
+//*****************************************************************************
+
+#ifndef __NET_UDP_H__
+#define __NET_UDP_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Sizes.  A buffer holds one complete Ethernet frame without the CRC.  The
+// pool supplies both receive descriptors and transmit datagrams, so it must
+// be larger than NET_RX_DESC.
+//
+//*****************************************************************************
+#define NET_BUF_SIZE            1520
+#define NET_BUF_COUNT           12
+#define NET_TX_DESC             8
+#define NET_RX_DESC             6
+#define NET_ARP_ENTRIES         4
+#define NET_UDP_SOCKETS         4
+
+//*****************************************************************************
+//
+// Header lengths, and the largest UDP payload that fits in one frame.
+//
+//*****************************************************************************
+#define NET_ETH_HDR_LEN         14
+#define NET_IP_HDR_LEN          20
+#define NET_UDP_HDR_LEN         8
+#define NET_UDP_PAYLOAD_OFFSET  (NET_ETH_HDR_LEN + NET_IP_HDR_LEN +           \
+                                 NET_UDP_HDR_LEN)
+#define NET_UDP_MAX_PAYLOAD     (1514 - NET_UDP_PAYLOAD_OFFSET)
+
+//*****************************************************************************
+//
+// Builds an IPv4 address in host order from its dotted decimal parts.
+//
+//*****************************************************************************
+#define NET_IP(a, b, c, d)      (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | \
+                                 ((uint32_t)(c) << 8) | (uint32_t)(d))
+
+//*****************************************************************************
+//
+// A frame buffer from the pool.  pui8Frame is word aligned and lies in SRAM
+// so the MAC DMA can reach it.
+//
+//*****************************************************************************
+typedef struct NetBuf
+{
+    struct NetBuf *psNext;
+    uint16_t ui16Len;
+    uint32_t pui32Frame[NET_BUF_SIZE / 4];
+}
+NetBuf_t;
+
+//*****************************************************************************
+//
+// An ARP cache entry.  A datagram sent while the address is being resolved
+// is parked in psPending and sent when the reply arrives.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Ip;
+    uint8_t pui8Mac[6];
+    uint8_t ui8State;
+    uint8_t ui8Age;
+    NetBuf_t *psPending;
+}
+NetArpEntry_t;
+
+//*****************************************************************************
+//
+// A bound UDP port.  pfnRx is called from NetPoll() with the payload, which
+// is only valid for the duration of the call.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint16_t ui16Port;
+    void (*pfnRx)(const uint8_t *pui8Data, uint32_t ui32Len,
+                  uint32_t ui32SrcIp, uint16_t ui16SrcPort, void *pvArg);
+    void *pvArg;
+}
+NetUdpSocket_t;
+
+//*****************************************************************************
+//
+// One network interface.  The descriptor rings are chained and owned by the
+// MAC while their OWN bit is set.  pfnPollDemand tells the MAC DMA that it
+// has new transmit descriptors (bTx true) or receive descriptors.  xLock
+// serialises the tasks that send against the task that runs NetPoll().
+//
+//*****************************************************************************
+typedef struct
+{
+    tEMACDMADescriptor psTxDesc[NET_TX_DESC];
+    tEMACDMADescriptor psRxDesc[NET_RX_DESC];
+    NetBuf_t *ppsTxBuf[NET_TX_DESC];
+    NetBuf_t *ppsRxBuf[NET_RX_DESC];
+    uint32_t ui32TxHead;
+    uint32_t ui32TxTail;
+    uint32_t ui32RxNext;
+
+    NetBuf_t psPool[NET_BUF_COUNT];
+    NetBuf_t *psFree;
+
+    void (*pfnPollDemand)(void *pvHw, bool bTx);
+    void *pvHw;
+    bool bChecksumOffload;
+    SemaphoreHandle_t xLock;
+
+    uint8_t pui8Mac[6];
+    uint32_t ui32Ip;
+    uint16_t ui16IpId;
+
+    NetArpEntry_t psArp[NET_ARP_ENTRIES];
+    NetUdpSocket_t psSockets[NET_UDP_SOCKETS];
+
+    uint32_t ui32TxFrames;
+    uint32_t ui32RxFrames;
+    uint32_t ui32RxErrors;
+    uint32_t ui32Drops;
+}
+NetIf_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void NetIfInit(NetIf_t *psIf, const uint8_t *pui8Mac, uint32_t ui32Ip,
+                      void (*pfnPollDemand)(void *pvHw, bool bTx), void *pvHw,
+                      bool bChecksumOffload);
+extern bool NetUdpBind(NetIf_t *psIf, uint16_t ui16Port,
+                       void (*pfnRx)(const uint8_t *pui8Data, uint32_t ui32Len,
+                                     uint32_t ui32SrcIp, uint16_t ui16SrcPort,
+                                     void *pvArg),
+                       void *pvArg);
+extern NetBuf_t *NetUdpAlloc(NetIf_t *psIf, uint8_t **ppui8Payload);
+extern bool NetUdpSend(NetIf_t *psIf, NetBuf_t *psBuf, uint32_t ui32Len,
+                       uint32_t ui32DstIp, uint16_t ui16DstPort,
+                       uint16_t ui16SrcPort);
+extern void NetPoll(NetIf_t *psIf);
+extern void NetArpTick(NetIf_t *psIf);
+extern uint32_t NetBufFreeCount(NetIf_t *psIf);
+
+extern bool NetHwInit(NetIf_t *psIf, uint32_t ui32SysClock,
+                      uint32_t ui32Ip, TaskHandle_t xNotify);
+extern void EMAC0IntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __NET_UDP_H__
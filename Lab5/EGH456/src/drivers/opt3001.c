@@ -71,6 +71,7 @@
 #define CONFIG_TEST                     0xCC10
 
 #define CONFIG_ENABLE                   0x10C4 // sensor receives this as 0xC410 as upper and lower bytes are received in reverse
+#define CONFIG_ENABLE_800MS             0x10CC // as CONFIG_ENABLE with the CT bit set, for 800 ms conversions
 #define CONFIG_DISABLE                  0x10C0 // sensor receives this as 0xC010 as upper and lower bytes are received in reverse
 
 /* Bit values */
@@ -110,10 +111,8 @@ bool sensorOpt3001Init(void)
 {
 	//Disable the sensor
 	sensorOpt3001Enable(false);
-	UARTprintf("after the first enable\n");
 	//Enable the sensor
 	sensorOpt3001Enable(true);
-	UARTprintf("after the second enable\n");
 
 
 	return (true);
@@ -144,6 +143,34 @@ void sensorOpt3001Enable(bool enable)
 }
 
 
+/**************************************************************************************************
+ * @fn          sensorOpt3001ConversionTime
+ *
+ * @brief       Restart continuous conversions of 800 ms or 100 ms. The sensor integrates
+ *              the light over the whole conversion time, and the next result is ready
+ *              one conversion time after this call
+ *
+ * @param       true for 800 ms conversions, false for 100 ms
+ *
+ * @return      none
+ **************************************************************************************************/
+void sensorOpt3001ConversionTime(bool longConversion)
+{
+	uint16_t val;
+
+	if (longConversion)
+	{
+		val = CONFIG_ENABLE_800MS;
+	}
+	else
+	{
+		val = CONFIG_ENABLE;
+	}
+
+	writeI2C(OPT3001_I2C_ADDRESS, REG_CONFIGURATION, (uint8_t*)&val);
+}
+
+
 /**************************************************************************************************
  * @fn          sensorOpt3001Read
  *
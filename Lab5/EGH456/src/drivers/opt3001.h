@@ -48,6 +48,7 @@ extern "C"
  */
 extern bool sensorOpt3001Init(void);
 extern void sensorOpt3001Enable(bool enable);
+extern void sensorOpt3001ConversionTime(bool longConversion);
 extern bool sensorOpt3001Read(uint16_t *rawData);
 extern void sensorOpt3001Convert(uint16_t rawData, float *convertedLux);
 extern bool sensorOpt3001Test(void);
@@ -0,0 +1,391 @@
+//*****************************************************************************
+//
+// periodic.c - Periodic tasks released from the kernel tick, with overrun
+//              detection and timing statistics.
+//
+// A task that does its work and then calls vTaskDelay() runs once per period
+// plus however long the work took, so its rate drifts with the load; giving
+// each rate a general purpose timer and a semaphore holds the rate but uses
+// up a timer per rate.  Here every periodic task is released by
+// vTaskDelayUntil() on absolute tick counts, so the kernel tick is the one
+// timer they all share and the release times never drift.
+//
+// Each job is timed as it runs.  Start latency is counted from the release
+// tick itself, using the tick count and how far SysTick is into the current
+// tick, and execution time on the run time statistics counter, so neither
+// changes with the clock level.  Both go into histograms, and a job that is
+// still running at its deadline is counted as an overrun; together these
+// show whether the task set is schedulable as it actually runs.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "utils/uartstdio.h"
+#include "drivers/clock_scale.h"
+#include "drivers/periodic.h"
+
+//*****************************************************************************
+//
+// The run time statistics counter runs from the 16 MHz PIOSC.
+//
+//*****************************************************************************
+#define PERIODIC_RT_PER_US      16
+
+//*****************************************************************************
+//
+// The rate, number of jobs and length of each job in vPeriodicBenchmark().
+//
+//*****************************************************************************
+#define PERIODIC_BENCH_PERIOD   10
+#define PERIODIC_BENCH_JOBS     20
+#define PERIODIC_BENCH_WORK_US  2000
+
+//*****************************************************************************
+//
+// Every periodic task that has started, for PeriodicStatsPrint().
+//
+//*****************************************************************************
+static Periodic_t *g_psPeriodicList;
+
+//*****************************************************************************
+//
+// Counts a time into a histogram.
+//
+//*****************************************************************************
+static void
+prvHistAdd(uint32_t *pui32Hist, uint32_t ui32Us)
+{
+    uint32_t ui32Bin = 0;
+
+    while((ui32Bin < PERIODIC_HIST_BINS - 1) &&
+          (ui32Us >= (PERIODIC_HIST_BASE_US << ui32Bin)))
+    {
+        ui32Bin++;
+    }
+    pui32Hist[ui32Bin]++;
+}
+
+//*****************************************************************************
+//
+// Works out the first release at or after now, and sets xRelease one period
+// before it, where vTaskDelayUntil() expects the previous wake time.
+//
+//*****************************************************************************
+static void
+prvPeriodicStart(Periodic_t *psPeriodic)
+{
+    TickType_t xNow, xPeriod, xOffset;
+
+    if(psPeriodic->xPeriod == 0)
+    {
+        psPeriodic->xPeriod = 1;
+    }
+    xPeriod = psPeriodic->xPeriod;
+
+    xNow = xTaskGetTickCount();
+    xOffset = ((xNow % xPeriod) + xPeriod - (psPeriodic->xPhase % xPeriod)) %
+              xPeriod;
+    psPeriodic->xRelease = xNow - xOffset + (xOffset ? xPeriod : 0) - xPeriod;
+
+    taskENTER_CRITICAL();
+    psPeriodic->psNext = g_psPeriodicList;
+    g_psPeriodicList = psPeriodic;
+    taskEXIT_CRITICAL();
+
+    psPeriodic->bStarted = true;
+}
+
+//*****************************************************************************
+//
+// Times the start of the job just released.
+//
+//*****************************************************************************
+static void
+prvJobBegin(Periodic_t *psPeriodic)
+{
+    TickType_t xLate;
+    uint32_t ui32Reload, ui32Into, ui32Latency;
+
+    //
+    // If the tick has wrapped but not been taken yet, SysTick is into the
+    // next tick already.
+    //
+    taskENTER_CRITICAL();
+    xLate = xTaskGetTickCount() - psPeriodic->xRelease;
+    ui32Reload = HWREG(NVIC_ST_RELOAD);
+    ui32Into = ui32Reload - HWREG(NVIC_ST_CURRENT);
+    if(HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_PENDSTSET)
+    {
+        xLate++;
+        ui32Into = ui32Reload - HWREG(NVIC_ST_CURRENT);
+    }
+    psPeriodic->ui32Start = ulClockRunTimeGet();
+    taskEXIT_CRITICAL();
+
+    ui32Latency = (xLate * (1000000 / configTICK_RATE_HZ)) +
+                  (ui32Into / (configCPU_CLOCK_HZ / 1000000));
+
+    psPeriodic->ui32Latency = ui32Latency;
+    psPeriodic->ui32Releases++;
+    if(ui32Latency > psPeriodic->ui32MaxLatency)
+    {
+        psPeriodic->ui32MaxLatency = ui32Latency;
+    }
+    prvHistAdd(psPeriodic->pui32LatencyHist, ui32Latency);
+}
+
+//*****************************************************************************
+//
+// Times the end of the job that has just finished, checks it against its
+// deadline, and with PERIODIC_OVERRUN_SKIP drops the releases it ran over.
+//
+//*****************************************************************************
+static void
+prvJobEnd(Periodic_t *psPeriodic)
+{
+    TickType_t xDeadline, xBehind, xMissed;
+    uint32_t ui32Exec;
+
+    ui32Exec = (ulClockRunTimeGet() - psPeriodic->ui32Start) /
+               PERIODIC_RT_PER_US;
+    if(ui32Exec > psPeriodic->ui32MaxExec)
+    {
+        psPeriodic->ui32MaxExec = ui32Exec;
+    }
+    prvHistAdd(psPeriodic->pui32ExecHist, ui32Exec);
+
+    xDeadline = psPeriodic->xDeadline ? psPeriodic->xDeadline :
+                                        psPeriodic->xPeriod;
+    if((psPeriodic->ui32Latency + ui32Exec) >
+       (xDeadline * (1000000 / configTICK_RATE_HZ)))
+    {
+        psPeriodic->ui32Overruns++;
+    }
+
+    //
+    // A release that falls on the current tick is still on time.
+    //
+    xBehind = xTaskGetTickCount() - psPeriodic->xRelease;
+    if((psPeriodic->ui32Policy == PERIODIC_OVERRUN_SKIP) &&
+       (xBehind > psPeriodic->xPeriod))
+    {
+        xMissed = (xBehind - 1) / psPeriodic->xPeriod;
+        psPeriodic->xRelease += xMissed * psPeriodic->xPeriod;
+        psPeriodic->ui32Skipped += xMissed;
+    }
+}
+
+//*****************************************************************************
+//
+//! Ends the current job and waits for the next release.
+//!
+//! \param psPeriodic is the periodic task, which must only be waited on by
+//! the calling task.
+//!
+//! Call at the top of the task's loop; the first call works out the first
+//! release and registers the task for PeriodicStatsPrint().  Anything the
+//! task does between two calls is timed as one job.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PeriodicWait(Periodic_t *psPeriodic)
+{
+    if(psPeriodic->bStarted)
+    {
+        prvJobEnd(psPeriodic);
+    }
+    else
+    {
+        prvPeriodicStart(psPeriodic);
+    }
+
+    vTaskDelayUntil(&psPeriodic->xRelease, psPeriodic->xPeriod);
+    prvJobBegin(psPeriodic);
+}
+
+//*****************************************************************************
+//
+//! Changes the period of a periodic task, and moves its releases to now.
+//!
+//! \param psPeriodic is the periodic task.
+//! \param xPeriod is the new period, in ticks.
+//!
+//! Must be called by the task that waits on \e psPeriodic, from within a
+//! job.  The next release is one new period after the current tick, and the
+//! releases after that keep to the new period; they no longer fall on the
+//! ticks set by xPhase.  Passing the current period only moves the releases,
+//! which lines them up with something outside that keeps its own time.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PeriodicPeriodSet(Periodic_t *psPeriodic, TickType_t xPeriod)
+{
+    psPeriodic->xPeriod = xPeriod;
+    psPeriodic->xRelease = xTaskGetTickCount();
+}
+
+//*****************************************************************************
+//
+// The task made by PeriodicCreate().
+//
+//*****************************************************************************
+static void
+prvPeriodicTask(void *pvParameters)
+{
+    Periodic_t *psPeriodic = pvParameters;
+
+    for(;;)
+    {
+        PeriodicWait(psPeriodic);
+        psPeriodic->pfnJob(psPeriodic->pvArg);
+    }
+}
+
+//*****************************************************************************
+//
+//! Creates a task that runs a job on every release.
+//!
+//! \param psPeriodic is the periodic task.  It must stay valid for as long
+//! as the task runs, and its name is given to the task.
+//! \param ui16StackDepth is the task's stack depth, in words.
+//! \param uxPriority is the task's priority.
+//!
+//! \return Returns \b true if the task was created.
+//
+//*****************************************************************************
+bool
+PeriodicCreate(Periodic_t *psPeriodic, uint16_t ui16StackDepth,
+               UBaseType_t uxPriority)
+{
+    return(xTaskCreate(prvPeriodicTask, psPeriodic->pcName, ui16StackDepth,
+                       psPeriodic, uxPriority, NULL) == pdPASS);
+}
+
+//*****************************************************************************
+//
+//! Prints the statistics of every periodic task that has started.
+//!
+//! Periods are in ticks and times in microseconds.  The histograms give the
+//! number of jobs whose start latency and execution time fell in each bin.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PeriodicStatsPrint(void)
+{
+    Periodic_t *psPeriodic;
+    uint32_t ui32Bin;
+
+    UARTprintf("task         period releases overruns skipped max lat "
+               "max exec\n");
+    for(psPeriodic = g_psPeriodicList; psPeriodic;
+        psPeriodic = psPeriodic->psNext)
+    {
+        UARTprintf("%-12s %6d %8d %8d %7d %7d %8d\n", psPeriodic->pcName,
+                   psPeriodic->xPeriod, psPeriodic->ui32Releases,
+                   psPeriodic->ui32Overruns, psPeriodic->ui32Skipped,
+                   psPeriodic->ui32MaxLatency, psPeriodic->ui32MaxExec);
+    }
+
+    UARTprintf("\nus below    ");
+    for(ui32Bin = 0; ui32Bin < PERIODIC_HIST_BINS - 1; ui32Bin++)
+    {
+        UARTprintf(" %5d", PERIODIC_HIST_BASE_US << ui32Bin);
+    }
+    UARTprintf("  more\n");
+    for(psPeriodic = g_psPeriodicList; psPeriodic;
+        psPeriodic = psPeriodic->psNext)
+    {
+        UARTprintf("%-12s\n  latency   ", psPeriodic->pcName);
+        for(ui32Bin = 0; ui32Bin < PERIODIC_HIST_BINS; ui32Bin++)
+        {
+            UARTprintf(" %5d", psPeriodic->pui32LatencyHist[ui32Bin]);
+        }
+        UARTprintf("\n  execution ");
+        for(ui32Bin = 0; ui32Bin < PERIODIC_HIST_BINS; ui32Bin++)
+        {
+            UARTprintf(" %5d", psPeriodic->pui32ExecHist[ui32Bin]);
+        }
+        UARTprintf("\n");
+    }
+}
+
+//*****************************************************************************
+//
+// The job for vPeriodicBenchmark(): spins for a fixed time.
+//
+//*****************************************************************************
+static void
+prvBenchWork(void)
+{
+    uint32_t ui32Start = ulClockRunTimeGet();
+
+    while((ulClockRunTimeGet() - ui32Start) <
+          (PERIODIC_BENCH_WORK_US * PERIODIC_RT_PER_US))
+    {
+    }
+}
+
+static Periodic_t g_sPeriodicBench =
+{
+    "Bench", NULL, NULL, PERIODIC_BENCH_PERIOD, 0, 0, PERIODIC_OVERRUN_SKIP
+};
+
+//*****************************************************************************
+//
+//! Compares the drift of a vTaskDelay() loop with a periodic task.
+//!
+//! Runs the same job PERIODIC_BENCH_JOBS times each way and prints how long
+//! each took against the ideal, then the statistics of all the periodic
+//! tasks.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+vPeriodicBenchmark(void)
+{
+    uint32_t ui32Idx, ui32Start, ui32Delay, ui32Until, ui32Ideal;
+
+    //
+    // Start both loops just after a tick.
+    //
+    vTaskDelay(1);
+    ui32Start = ulClockRunTimeGet();
+    for(ui32Idx = 0; ui32Idx < PERIODIC_BENCH_JOBS; ui32Idx++)
+    {
+        prvBenchWork();
+        vTaskDelay(PERIODIC_BENCH_PERIOD);
+    }
+    ui32Delay = (ulClockRunTimeGet() - ui32Start) / PERIODIC_RT_PER_US;
+
+    PeriodicWait(&g_sPeriodicBench);
+    ui32Start = ulClockRunTimeGet();
+    for(ui32Idx = 0; ui32Idx < PERIODIC_BENCH_JOBS; ui32Idx++)
+    {
+        prvBenchWork();
+        PeriodicWait(&g_sPeriodicBench);
+    }
+    ui32Until = (ulClockRunTimeGet() - ui32Start) / PERIODIC_RT_PER_US;
+
+    ui32Ideal = PERIODIC_BENCH_JOBS * PERIODIC_BENCH_PERIOD *
+                (1000000 / configTICK_RATE_HZ);
+    UARTprintf("%d jobs of %d us every %d ticks\n", PERIODIC_BENCH_JOBS,
+               PERIODIC_BENCH_WORK_US, PERIODIC_BENCH_PERIOD);
+    UARTprintf("loop                    elapsed us  drift us\n");
+    UARTprintf("%-24s %9d %9d\n", "vTaskDelay()", ui32Delay,
+               ui32Delay - ui32Ideal);
+    UARTprintf("%-24s %9d %9d\n\n", "PeriodicWait()", ui32Until,
+               ui32Until - ui32Ideal);
+    PeriodicStatsPrint();
+}
@@ -0,0 +1,113 @@
+//*****************************************************************************
+//
+// periodic.h - Periodic tasks released from the kernel tick, with overrun
+//              detection and timing statistics.
+//
+//*****************************************************************************
+
+#ifndef __PERIODIC_H__
+#define __PERIODIC_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// What to do about releases that went by while a job overran.  With
+// PERIODIC_OVERRUN_SKIP they are dropped and counted, and the next job starts
+// at the first release still to come.  With PERIODIC_OVERRUN_CATCH_UP each
+// of them still gets a job, run back to back until the task is on time.
+//
+//*****************************************************************************
+#define PERIODIC_OVERRUN_SKIP   0
+#define PERIODIC_OVERRUN_CATCH_UP                                             \
+                                1
+
+//*****************************************************************************
+//
+// The number of bins in each histogram.  Bin n holds times below
+// PERIODIC_HIST_BASE_US << n, and the last bin everything above that.
+//
+//*****************************************************************************
+#define PERIODIC_HIST_BINS      8
+#define PERIODIC_HIST_BASE_US   16
+
+//*****************************************************************************
+//
+// A job, run once per release.
+//
+//*****************************************************************************
+typedef void (*PeriodicFn_t)(void *pvArg);
+
+//*****************************************************************************
+//
+// A periodic task.  Releases fall on the ticks where the tick count, less
+// xPhase, is a multiple of xPeriod, so tasks with the same period and phase
+// are released together and a phase offsets one from another.  A job that
+// has not finished xDeadline ticks after its release (the period, if zero)
+// has overrun.
+//
+// Start latency is the time from the release tick to the job starting, and
+// execution time from the job starting to it finishing, preemption
+// included; both are in microseconds.
+//
+// Set the members up to ui32Policy, the rest zeroed.  Pass it to
+// PeriodicCreate() to have a task made that calls pfnJob, or call
+// PeriodicWait() from a task of your own, in which case pfnJob is not used.
+//
+//*****************************************************************************
+typedef struct Periodic
+{
+    const char *pcName;
+    PeriodicFn_t pfnJob;
+    void *pvArg;
+    TickType_t xPeriod;
+    TickType_t xPhase;
+    TickType_t xDeadline;
+    uint32_t ui32Policy;
+
+    TickType_t xRelease;
+    uint32_t ui32Start;
+    uint32_t ui32Latency;
+    bool bStarted;
+    uint32_t ui32Releases;
+    uint32_t ui32Overruns;
+    uint32_t ui32Skipped;
+    uint32_t ui32MaxLatency;
+    uint32_t ui32MaxExec;
+    uint32_t pui32LatencyHist[PERIODIC_HIST_BINS];
+    uint32_t pui32ExecHist[PERIODIC_HIST_BINS];
+    struct Periodic *psNext;
+}
+Periodic_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern bool PeriodicCreate(Periodic_t *psPeriodic, uint16_t ui16StackDepth,
+                           UBaseType_t uxPriority);
+extern void PeriodicWait(Periodic_t *psPeriodic);
+extern void PeriodicPeriodSet(Periodic_t *psPeriodic, TickType_t xPeriod);
+extern void PeriodicStatsPrint(void);
+extern void vPeriodicBenchmark(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PERIODIC_H__
@@ -0,0 +1,200 @@
+//*****************************************************************************
+//
+// seq_channel.c - Latest value channels: one writer, any number of readers,
+//                 under a sequence lock.
+//
+// A reader that only wants the most recent value of something should not
+// have to drain a queue of every value before it, nor read a shared global
+// that may be half written.  A channel holds two copies of the value and a
+// count of the writes.  The writer fills in the copy that is not the latest,
+// then bumps the count, which makes it the latest.  A reader notes the
+// count, copies the latest value, and reads the count again; if it changed
+// in between the copy may be torn, and the reader goes round again.
+//
+// The writer never touches the copy a reader is on until it has finished the
+// write after, so only a second write landing while a reader copies could
+// tear its copy.  A single write still moves the count, though, so the
+// reader retries after any write during its copy.  Neither side masks
+// interrupts or waits on the other: the writer may be an interrupt handler,
+// and a reader that preempts the writer still gets the previous value,
+// whole.  The count also tells a reader how many values it missed since it
+// last looked.
+//
+// There must only be one writer per channel.  Two would write into the same
+// copy.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "utils/uartstdio.h"
+#include "drivers/cycle_counter.h"
+#include "drivers/seq_channel.h"
+
+//*****************************************************************************
+//
+// The number of calls timed by vSeqChannelBenchmark().
+//
+//*****************************************************************************
+#define SEQ_BENCH_LOOPS         1000
+
+//*****************************************************************************
+//
+//! Writes a new value to a channel.
+//!
+//! \param psChan is the channel.
+//! \param pvValue is the value, of the channel's size.
+//!
+//! Only one task or interrupt handler may write a given channel.  Use
+//! SEQ_CHANNEL_WRITE() to have the value's type checked.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SeqChannelWrite(SeqChannel_t *psChan, const void *pvValue)
+{
+    uint32_t ui32Seq = psChan->ui32Seq;
+
+    memcpy((uint8_t *)psChan->pvCopies + (((ui32Seq + 1) & 1) *
+                                          psChan->ui32Size),
+           pvValue, psChan->ui32Size);
+    __atomic_store_n(&psChan->ui32Seq, ui32Seq + 1, __ATOMIC_RELEASE);
+}
+
+//*****************************************************************************
+//
+//! Reads the latest value from a channel.
+//!
+//! \param psChan is the channel.
+//! \param pvValue is filled in with the value.
+//! \param pui32Seq, if not NULL, is the sequence number of the value the
+//! caller read last, and is updated to that of this one.
+//!
+//! May be called from any number of tasks and interrupt handlers at once.
+//! Use SEQ_CHANNEL_READ() to have the value's type checked.
+//!
+//! \return Returns the number of writes since the value at \e *pui32Seq:
+//! zero if the value is the one read last time, one if it is the next, and
+//! more if values were missed.  Returns the total number of writes if
+//! \e pui32Seq is NULL.
+//
+//*****************************************************************************
+uint32_t
+SeqChannelRead(const SeqChannel_t *psChan, void *pvValue, uint32_t *pui32Seq)
+{
+    uint32_t ui32Seq, ui32Writes;
+
+    do
+    {
+        ui32Seq = __atomic_load_n(&psChan->ui32Seq, __ATOMIC_ACQUIRE);
+        memcpy(pvValue, (const uint8_t *)psChan->pvCopies +
+                        ((ui32Seq & 1) * psChan->ui32Size),
+               psChan->ui32Size);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    }
+    while(__atomic_load_n(&psChan->ui32Seq, __ATOMIC_RELAXED) != ui32Seq);
+
+    if(!pui32Seq)
+    {
+        return(ui32Seq);
+    }
+
+    ui32Writes = ui32Seq - *pui32Seq;
+    *pui32Seq = ui32Seq;
+    return(ui32Writes);
+}
+
+//*****************************************************************************
+//
+// Benchmark.  The value is the size of the light sensor's samples.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t pui32Words[4];
+}
+SeqBenchValue_t;
+
+static SEQ_CHANNEL(g_sSeqBench, SeqBenchValue_t);
+static SeqBenchValue_t g_sSeqBenchShared;
+
+//*****************************************************************************
+//
+//! Prints the cycle cost of a write and a read on the console, next to a
+//! copy under a critical section and a one item queue used as a mailbox.
+//!
+//! Each call is timed on its own with interrupts masked, less the cost of
+//! reading the cycle counter.  Must be called from a task.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+vSeqChannelBenchmark(void)
+{
+    QueueHandle_t xMailbox;
+    SeqBenchValue_t sValue = { { 1, 2, 3, 4 } };
+    uint32_t ui32Idx, ui32Start, ui32Base, ui32Seq = 0;
+    uint32_t ui32Write = 0, ui32Read = 0, ui32CritW = 0, ui32CritR = 0;
+    uint32_t ui32BoxW = 0, ui32BoxR = 0;
+
+    xMailbox = xQueueCreate(1, sizeof(SeqBenchValue_t));
+    if(!xMailbox)
+    {
+        UARTprintf("Sequence lock benchmark: out of heap\n");
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    ui32Start = CycleCounterGet();
+    ui32Base = CycleCounterGet() - ui32Start;
+    for(ui32Idx = 0; ui32Idx < SEQ_BENCH_LOOPS; ui32Idx++)
+    {
+        sValue.pui32Words[0] = ui32Idx;
+
+        ui32Start = CycleCounterGet();
+        SEQ_CHANNEL_WRITE(&g_sSeqBench, &sValue);
+        ui32Write += CycleCounterGet() - ui32Start - ui32Base;
+
+        ui32Start = CycleCounterGet();
+        SEQ_CHANNEL_READ(&g_sSeqBench, &sValue, &ui32Seq);
+        ui32Read += CycleCounterGet() - ui32Start - ui32Base;
+
+        ui32Start = CycleCounterGet();
+        taskENTER_CRITICAL();
+        g_sSeqBenchShared = sValue;
+        taskEXIT_CRITICAL();
+        ui32CritW += CycleCounterGet() - ui32Start - ui32Base;
+
+        ui32Start = CycleCounterGet();
+        taskENTER_CRITICAL();
+        sValue = g_sSeqBenchShared;
+        taskEXIT_CRITICAL();
+        ui32CritR += CycleCounterGet() - ui32Start - ui32Base;
+
+        ui32Start = CycleCounterGet();
+        xQueueOverwrite(xMailbox, &sValue);
+        ui32BoxW += CycleCounterGet() - ui32Start - ui32Base;
+
+        ui32Start = CycleCounterGet();
+        xQueuePeek(xMailbox, &sValue, 0);
+        ui32BoxR += CycleCounterGet() - ui32Start - ui32Base;
+    }
+    taskEXIT_CRITICAL();
+
+    vQueueDelete(xMailbox);
+
+    UARTprintf("%d byte value           write    read\n",
+               sizeof(SeqBenchValue_t));
+    UARTprintf("%-24s %5d %7d\n", "sequence lock",
+               ui32Write / SEQ_BENCH_LOOPS, ui32Read / SEQ_BENCH_LOOPS);
+    UARTprintf("%-24s %5d %7d\n", "critical section",
+               ui32CritW / SEQ_BENCH_LOOPS, ui32CritR / SEQ_BENCH_LOOPS);
+    UARTprintf("%-24s %5d %7d\n", "queue overwrite/peek",
+               ui32BoxW / SEQ_BENCH_LOOPS, ui32BoxR / SEQ_BENCH_LOOPS);
+}
@@ -0,0 +1,89 @@
+//*****************************************************************************
+//
+// seq_channel.h - Latest value channels: one writer, any number of readers,
+//                 under a sequence lock.
+//
+//*****************************************************************************
+
+#ifndef __SEQ_CHANNEL_H__
+#define __SEQ_CHANNEL_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// A channel.  ui32Seq counts the writes, and the latest value is in copy
+// ui32Seq & 1 of the two at pvCopies.  Declare one with SEQ_CHANNEL() rather
+// than filling this in.
+//
+//*****************************************************************************
+typedef struct
+{
+    volatile uint32_t ui32Seq;
+    uint32_t ui32Size;
+    void *pvCopies;
+}
+SeqChannel_t;
+
+//*****************************************************************************
+//
+// Declares a channel sName carrying values of type Type, starting at all
+// zeroes with a sequence number of zero.  Put static in front for a channel
+// private to one file.
+//
+//*****************************************************************************
+#define SEQ_CHANNEL(sName, Type)                                              \
+                                struct                                        \
+                                {                                             \
+                                    SeqChannel_t sChan;                       \
+                                    Type psCopies[2];                         \
+                                } sName =                                     \
+                                {                                             \
+                                    { 0, sizeof(Type), sName.psCopies }       \
+                                }
+
+//*****************************************************************************
+//
+// Writes and reads a channel declared with SEQ_CHANNEL(), checking that the
+// value is of the channel's type.
+//
+//*****************************************************************************
+#define SEQ_CHANNEL_WRITE(psName, psValue)                                    \
+                                SeqChannelWrite(&(psName)->sChan,             \
+                                                1 ? (psValue) :               \
+                                                (psName)->psCopies)
+#define SEQ_CHANNEL_READ(psName, psValue, pui32Seq)                           \
+                                SeqChannelRead(&(psName)->sChan,              \
+                                               1 ? (psValue) :                \
+                                               (psName)->psCopies,            \
+                                               (pui32Seq))
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void SeqChannelWrite(SeqChannel_t *psChan, const void *pvValue);
+extern uint32_t SeqChannelRead(const SeqChannel_t *psChan, void *pvValue,
+                               uint32_t *pui32Seq);
+extern void vSeqChannelBenchmark(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SEQ_CHANNEL_H__
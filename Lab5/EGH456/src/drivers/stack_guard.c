@@ -0,0 +1,245 @@
+//*****************************************************************************
+//
+// stack_guard.c - MPU guard region below the running task's stack.
+//
+// Method 2 stack checking compares the last 16 bytes of the outgoing task's
+// stack against the fill pattern on every context switch, and only notices
+// an overflow that has already happened and left the pattern changed.  Here
+// one MPU region, read only to everything, sits on the lowest
+// STACK_GUARD_SIZE aligned bytes of the stack of whichever task is running.
+// The kernel's switch-in trace hook moves it (STACK_GUARD_MOVE() in
+// FreeRTOSConfig.h) with a single store to the MPU base register, and the
+// first push past the end of the stack takes a MemManage fault on the
+// instruction that made it, before anything below the stack is touched.
+//
+// The region is read only rather than no access so that a task can still
+// scan its own stack for uxTaskGetStackHighWaterMark().  Handlers run on the
+// main stack and are not affected, and privileged code keeps the default
+// memory map everywhere else.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/mpu.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "utils/uartstdio.h"
+#include "drivers/cycle_counter.h"
+#include "drivers/stack_guard.h"
+
+//*****************************************************************************
+//
+// The number of round trips and checks timed by vStackGuardBenchmark().
+//
+//*****************************************************************************
+#define STACK_GUARD_BENCH_LOOPS 1000
+
+//*****************************************************************************
+//
+// The MemManage status bits that mean a write to the guard, or exception
+// state pushed into it.
+//
+//*****************************************************************************
+#define STACK_GUARD_FAULT_STACKING                                            \
+                                (NVIC_FAULT_STAT_MSTKE |                      \
+                                 NVIC_FAULT_STAT_MLSPERR)
+
+extern void vApplicationStackOverflowHook(TaskHandle_t pxTask,
+                                          char *pcTaskName);
+
+//*****************************************************************************
+//
+// The address and status of the last MemManage fault, for a debugger.
+//
+//*****************************************************************************
+volatile uint32_t g_ui32StackGuardFaultAddr;
+volatile uint32_t g_ui32StackGuardFaultStatus;
+
+//*****************************************************************************
+//
+//! Sets up the guard region and enables the MPU.
+//!
+//! Call once before the scheduler starts.  The region is placed by the
+//! kernel each time a task is switched in; until then it covers the bottom
+//! of the vector table, which is never written.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+StackGuardInit(void)
+{
+    MPURegionSet(STACK_GUARD_REGION, 0,
+                 MPU_RGN_SIZE_32B | MPU_RGN_PERM_NOEXEC |
+                 MPU_RGN_PERM_PRV_RO_USR_RO | MPU_RGN_ENABLE);
+    MPUIntRegister(StackGuardFaultHandler);
+    MPUEnable(MPU_CONFIG_PRIV_DEFAULT);
+}
+
+//*****************************************************************************
+//
+//! Handles a MemManage fault.
+//!
+//! A fault in the guard, or while stacking exception state into it, is
+//! reported through vApplicationStackOverflowHook(), as the kernel's own
+//! check would, naming the running task.  Any other MPU fault stops here
+//! with the address and status left in g_ui32StackGuardFaultAddr and
+//! g_ui32StackGuardFaultStatus.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+StackGuardFaultHandler(void)
+{
+    uint32_t ui32Status, ui32Addr, ui32Guard;
+    TaskHandle_t xTask;
+
+    ui32Status = HWREG(NVIC_FAULT_STAT) & 0xff;
+    ui32Addr = HWREG(NVIC_MM_ADDR);
+    ui32Guard = HWREG(NVIC_MPU_BASE) & NVIC_MPU_BASE_ADDR_M;
+    HWREG(NVIC_FAULT_STAT) = ui32Status;
+
+    g_ui32StackGuardFaultStatus = ui32Status;
+    g_ui32StackGuardFaultAddr = ui32Addr;
+
+    if((ui32Status & STACK_GUARD_FAULT_STACKING) ||
+       ((ui32Status & NVIC_FAULT_STAT_MMARV) &&
+        (ui32Addr - ui32Guard < STACK_GUARD_SIZE)))
+    {
+        xTask = xTaskGetCurrentTaskHandle();
+        vApplicationStackOverflowHook(xTask, pcTaskGetName(xTask));
+    }
+
+    while(1)
+    {
+    }
+}
+
+//*****************************************************************************
+//
+// The other end of the switch benchmark: yields straight back until told to
+// stop.
+//
+//*****************************************************************************
+static volatile bool g_bStackGuardBenchStop;
+
+static void
+prvBenchPartner(void *pvParameters)
+{
+    (void)pvParameters;
+
+    while(!g_bStackGuardBenchStop)
+    {
+        taskYIELD();
+    }
+    vTaskDelete(NULL);
+}
+
+//*****************************************************************************
+//
+// The kernel's method 2 check, as tasks.c expands it for a stack that grows
+// down, run against a filled block.
+//
+//*****************************************************************************
+static uint32_t g_pui32StackGuardFill[4] =
+{
+    0xa5a5a5a5, 0xa5a5a5a5, 0xa5a5a5a5, 0xa5a5a5a5
+};
+static volatile uint32_t g_ui32StackGuardBenchHits;
+
+static void __attribute__((noinline))
+prvPatternCheck(const uint32_t * const *ppui32Stack)
+{
+    const uint32_t * const pui32Stack = *ppui32Stack;
+    const uint32_t ui32CheckValue = 0xa5a5a5a5;
+
+    if((pui32Stack[0] != ui32CheckValue) || (pui32Stack[1] != ui32CheckValue) ||
+       (pui32Stack[2] != ui32CheckValue) || (pui32Stack[3] != ui32CheckValue))
+    {
+        g_ui32StackGuardBenchHits++;
+    }
+}
+
+static void __attribute__((noinline))
+prvGuardMove(const uint32_t * const *ppui32Stack)
+{
+    STACK_GUARD_MOVE(*ppui32Stack);
+}
+
+//*****************************************************************************
+//
+//! Measures the cost of a context switch, and of each way of checking for
+//! overflow in it.
+//!
+//! Yields back and forth with a task of the same priority to time a whole
+//! switch as this build makes it, then times the two checks alone, each
+//! called the way the kernel reaches it on every switch.  Rebuild with
+//! -DSTACK_GUARD_MPU=0 to time the switch with method 2.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+vStackGuardBenchmark(void)
+{
+    const uint32_t *pui32Stack;
+    uint32_t ui32Idx, ui32Start, ui32Base, ui32Switch;
+    uint32_t ui32Pattern = 0, ui32Guard = 0;
+
+    g_bStackGuardBenchStop = false;
+    if(xTaskCreate(prvBenchPartner, "GuardBench", configMINIMAL_STACK_SIZE,
+                   NULL, uxTaskPriorityGet(NULL), NULL) != pdPASS)
+    {
+        UARTprintf("Stack guard benchmark: out of heap\n");
+        return;
+    }
+
+    //
+    // Each pass switches out to the partner and back.
+    //
+    taskYIELD();
+    ui32Start = CycleCounterGet();
+    for(ui32Idx = 0; ui32Idx < STACK_GUARD_BENCH_LOOPS; ui32Idx++)
+    {
+        taskYIELD();
+    }
+    ui32Switch = CycleCounterGet() - ui32Start;
+    g_bStackGuardBenchStop = true;
+    taskYIELD();
+
+    //
+    // The guard is moved onto itself, which is already aligned, so it stays
+    // where it is.
+    //
+    taskENTER_CRITICAL();
+    ui32Start = CycleCounterGet();
+    ui32Base = CycleCounterGet() - ui32Start;
+    for(ui32Idx = 0; ui32Idx < STACK_GUARD_BENCH_LOOPS; ui32Idx++)
+    {
+        pui32Stack = g_pui32StackGuardFill;
+        ui32Start = CycleCounterGet();
+        prvPatternCheck(&pui32Stack);
+        ui32Pattern += CycleCounterGet() - ui32Start - ui32Base;
+
+        pui32Stack = (const uint32_t *)(HWREG(NVIC_MPU_BASE) &
+                                        NVIC_MPU_BASE_ADDR_M);
+        ui32Start = CycleCounterGet();
+        prvGuardMove(&pui32Stack);
+        ui32Guard += CycleCounterGet() - ui32Start - ui32Base;
+    }
+    taskEXIT_CRITICAL();
+
+    UARTprintf("overflow check: %s\n",
+               STACK_GUARD_MPU ? "MPU guard" : "method 2 pattern");
+    UARTprintf("path                      cycles\n");
+    UARTprintf("%-24s %7d\n", "context switch",
+               ui32Switch / (2 * STACK_GUARD_BENCH_LOOPS));
+    UARTprintf("%-24s %7d\n", "  method 2 check",
+               ui32Pattern / STACK_GUARD_BENCH_LOOPS);
+    UARTprintf("%-24s %7d\n", "  guard move",
+               ui32Guard / STACK_GUARD_BENCH_LOOPS);
+}
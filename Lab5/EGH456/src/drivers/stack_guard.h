@@ -0,0 +1,50 @@
+//*****************************************************************************
+//
+// stack_guard.h - MPU guard region below the running task's stack.
+//
+//*****************************************************************************
+
+#ifndef __STACK_GUARD_H__
+#define __STACK_GUARD_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The guard itself (STACK_GUARD_REGION, STACK_GUARD_SIZE and the
+// STACK_GUARD_MOVE() the kernel calls on every switch) is defined in
+// FreeRTOSConfig.h, which tasks.c sees.  The guard takes the first
+// STACK_GUARD_SIZE aligned bytes of each stack, so up to
+// STACK_GUARD_WORDS of a task's depth can no longer be used.
+//
+//*****************************************************************************
+#define STACK_GUARD_WORDS       ((2 * STACK_GUARD_SIZE - 8) / 4)
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void StackGuardInit(void);
+extern void StackGuardFaultHandler(void);
+extern void vStackGuardBenchmark(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __STACK_GUARD_H__
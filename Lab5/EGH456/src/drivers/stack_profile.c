@@ -0,0 +1,251 @@
+//*****************************************************************************
+//
+// stack_profile.c - Run time measurement of task stack use.
+//
+// The kernel fills every new stack with tskSTACK_FILL_BYTE (this build has
+// configCHECK_FOR_STACK_OVERFLOW 2 and configUSE_TRACE_FACILITY, either of
+// which turns the fill on), so the deepest point a task has reached is the
+// last word that no longer holds the pattern.  A low priority monitor task
+// reads that high water mark for every task each period with
+// uxTaskGetSystemState() and keeps the peak.  Whenever a peak grows the
+// table is printed, one "STACK name depth used" line per task, which is the
+// format stack_usage.py reads from a saved console log to combine with its
+// static call graph analysis.
+//
+// A high water mark only covers the paths the run exercised.  The static
+// analysis covers the paths the run missed; the two together are what the
+// recommended sizes are based on.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "utils/uartstdio.h"
+#include "task_stacks.h"
+#include "drivers/stack_profile.h"
+
+//*****************************************************************************
+//
+// The depth each task was created with.  The kernel does not report it, so
+// it comes from the list in task_stacks.h by name.
+//
+//*****************************************************************************
+typedef struct
+{
+    const char *pcName;
+    uint32_t ui32Depth;
+}
+StackProfileDepth_t;
+
+#define STACK_PROFILE_DEPTH(ID, DEPTH, NAME, ENTRY)                           \
+                                { NAME, DEPTH },
+
+static const StackProfileDepth_t g_psStackProfileDepths[] =
+{
+    TASK_STACKS(STACK_PROFILE_DEPTH)
+    { "IDLE", configMINIMAL_STACK_SIZE },
+};
+
+#define STACK_PROFILE_NUM_DEPTHS                                              \
+        (sizeof(g_psStackProfileDepths) / sizeof(g_psStackProfileDepths[0]))
+
+//*****************************************************************************
+//
+// The peak use of each task seen so far, in words.  Tasks are matched by
+// task number, which the kernel never reuses.
+//
+//*****************************************************************************
+typedef struct
+{
+    UBaseType_t xTaskNumber;
+    const char *pcName;
+    uint32_t ui32Depth;
+    uint32_t ui32MinFree;
+}
+StackProfileTask_t;
+
+static StackProfileTask_t g_psStackProfileTasks[STACK_PROFILE_MAX_TASKS];
+static uint32_t g_ui32StackProfileNumTasks;
+static TaskStatus_t g_psStackProfileStatus[STACK_PROFILE_MAX_TASKS];
+static TickType_t g_xStackProfilePeriod;
+
+//*****************************************************************************
+//
+// Returns the depth a task was created with, or 0 if it is not in the table.
+//
+//*****************************************************************************
+static uint32_t
+prvDepthGet(const char *pcName)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < STACK_PROFILE_NUM_DEPTHS; ui32Idx++)
+    {
+        if(strcmp(g_psStackProfileDepths[ui32Idx].pcName, pcName) == 0)
+        {
+            return(g_psStackProfileDepths[ui32Idx].ui32Depth);
+        }
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Takes one sample of every task's stack high water mark.
+//!
+//! Scanning a stack for the fill pattern takes time in proportion to its
+//! unused depth, with the scheduler suspended, so this is best called from a
+//! low priority task.  StackProfileStart() creates one that does.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+StackProfileSample(void)
+{
+    StackProfileTask_t *psTask;
+    UBaseType_t uxNumStatus, uxIdx;
+    uint32_t ui32Idx;
+    bool bGrew = false;
+
+    uxNumStatus = uxTaskGetSystemState(g_psStackProfileStatus,
+                                       STACK_PROFILE_MAX_TASKS, NULL);
+
+    for(uxIdx = 0; uxIdx < uxNumStatus; uxIdx++)
+    {
+        for(ui32Idx = 0; ui32Idx < g_ui32StackProfileNumTasks; ui32Idx++)
+        {
+            if(g_psStackProfileTasks[ui32Idx].xTaskNumber ==
+               g_psStackProfileStatus[uxIdx].xTaskNumber)
+            {
+                break;
+            }
+        }
+
+        if(ui32Idx == g_ui32StackProfileNumTasks)
+        {
+            if(ui32Idx == STACK_PROFILE_MAX_TASKS)
+            {
+                continue;
+            }
+            psTask = &g_psStackProfileTasks[g_ui32StackProfileNumTasks++];
+            psTask->xTaskNumber = g_psStackProfileStatus[uxIdx].xTaskNumber;
+            psTask->pcName = g_psStackProfileStatus[uxIdx].pcTaskName;
+            psTask->ui32Depth = prvDepthGet(psTask->pcName);
+            psTask->ui32MinFree = 0xffffffff;
+        }
+        else
+        {
+            psTask = &g_psStackProfileTasks[ui32Idx];
+        }
+
+        if(g_psStackProfileStatus[uxIdx].usStackHighWaterMark <
+           psTask->ui32MinFree)
+        {
+            psTask->ui32MinFree =
+                g_psStackProfileStatus[uxIdx].usStackHighWaterMark;
+            bGrew = true;
+        }
+    }
+
+    if(bGrew)
+    {
+        StackProfilePrint();
+    }
+}
+
+//*****************************************************************************
+//
+//! Prints the peak stack use of every task seen so far.
+//!
+//! Each task is one "STACK name depth used" line, in words.  A task missing
+//! from task_stacks.h shows depth 0 and the free space it never used in
+//! place of the use.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+StackProfilePrint(void)
+{
+    uint32_t ui32Idx, ui32Used;
+    StackProfileTask_t *psTask;
+
+    UARTprintf("-- task stacks (words): name depth used --\n");
+    for(ui32Idx = 0; ui32Idx < g_ui32StackProfileNumTasks; ui32Idx++)
+    {
+        psTask = &g_psStackProfileTasks[ui32Idx];
+        ui32Used = psTask->ui32Depth ?
+                   psTask->ui32Depth - psTask->ui32MinFree :
+                   psTask->ui32MinFree;
+        UARTprintf("STACK %s %d %d\n", psTask->pcName, psTask->ui32Depth,
+                   ui32Used);
+    }
+}
+
+//*****************************************************************************
+//
+//! Reports a stack overflow.  Called from vApplicationStackOverflowHook().
+//!
+//! \param pcTaskName is the task that overflowed.
+//!
+//! The console is polled, so this works from inside the context switch the
+//! kernel detects the overflow in.  The caller is expected to halt.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+StackProfileOverflow(const char *pcTaskName)
+{
+    UARTprintf("\nSTACK OVERFLOW %s %d\n", pcTaskName,
+               prvDepthGet(pcTaskName));
+    StackProfilePrint();
+}
+
+//*****************************************************************************
+//
+// Samples the stacks every period.
+//
+//*****************************************************************************
+static void
+prvStackMonTask(void *pvParameters)
+{
+    TickType_t xLastWake = xTaskGetTickCount();
+
+    (void)pvParameters;
+
+    for(;;)
+    {
+        StackProfileSample();
+        vTaskDelayUntil(&xLastWake, g_xStackProfilePeriod);
+    }
+}
+
+//*****************************************************************************
+//
+//! Starts sampling the task stacks.
+//!
+//! \param ui32PeriodMs is the time between samples.
+//!
+//! Creates the StackMon task at STACK_PROFILE_PRIORITY.  The first sample
+//! prints every task; later ones print only when a peak has grown.
+//!
+//! \return Returns \b false if the task could not be created.
+//
+//*****************************************************************************
+bool
+StackProfileStart(uint32_t ui32PeriodMs)
+{
+    g_xStackProfilePeriod = pdMS_TO_TICKS(ui32PeriodMs);
+    if(g_xStackProfilePeriod == 0)
+    {
+        g_xStackProfilePeriod = 1;
+    }
+
+    return(xTaskCreate(prvStackMonTask, "StackMon", TASK_STACK_STACK_MON, NULL,
+                       STACK_PROFILE_PRIORITY, NULL) == pdPASS);
+}
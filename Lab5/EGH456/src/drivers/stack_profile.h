@@ -0,0 +1,51 @@
+//*****************************************************************************
+//
+// stack_profile.h - Run time measurement of task stack use, for sizing the
+//                   stacks in task_stacks.h.
+//
+//*****************************************************************************
+
+#ifndef __STACK_PROFILE_H__
+#define __STACK_PROFILE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The most tasks tracked, and the priority of the monitor task.  The monitor
+// runs just above idle so that it samples between bursts of application
+// work rather than in the middle of them.
+//
+//*****************************************************************************
+#define STACK_PROFILE_MAX_TASKS 12
+#define STACK_PROFILE_PRIORITY  (tskIDLE_PRIORITY + 1)
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern bool StackProfileStart(uint32_t ui32PeriodMs);
+extern void StackProfileSample(void);
+extern void StackProfilePrint(void);
+extern void StackProfileOverflow(const char *pcTaskName);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __STACK_PROFILE_H__
@@ -45,6 +45,7 @@
 #include "grlib/grlib.h"
 #include "grlib/widget.h"
 #include "drivers/touch.h"
+#include "drivers/clock_scale.h"
 
 //*****************************************************************************
 //
@@ -669,6 +670,23 @@ TouchScreenIntHandler(void)
     }
 }
 
+//*****************************************************************************
+//
+// Keeps the touch screen sampling at 1 kHz across system clock changes.
+//
+//*****************************************************************************
+static void
+TouchScreenClockPost(uint32_t ui32NewHz, void *pvArg)
+{
+    TimerLoadSet(TIMER1_BASE, TIMER_A, (ui32NewHz / 1000) - 1);
+}
+
+static ClockNotifier_t g_sTouchClockNotifier =
+{
+    0, TouchScreenClockPost, 0, 0
+};
+static bool g_bTouchClockNotifierRegistered = false;
+
 //*****************************************************************************
 //
 //! Initializes the touch screen driver.
@@ -757,6 +775,12 @@ TouchScreenInit(uint32_t ui32SysClock)
         //
         TimerEnable(TIMER1_BASE, TIMER_A);
     }
+
+    if(!g_bTouchClockNotifierRegistered)
+    {
+        ClockNotifierRegister(&g_sTouchClockNotifier);
+        g_bTouchClockNotifierRegistered = true;
+    }
 }
 
 //*****************************************************************************
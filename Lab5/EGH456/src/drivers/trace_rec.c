@@ -0,0 +1,200 @@
+//*****************************************************************************
+//
+// trace_rec.c - Recording of the raw inputs, with their times, for replay
+//               on the host.
+//
+// How fast the light processing runs, and what it does, depends on the room
+// it is in and on who presses the buttons.  To measure a change to it twice
+// on the same input, the inputs are recorded here as they arrive: the raw
+// sensor readings, the button interrupts and the touch screen messages, each
+// with the tick it came on.  When the recording is full it is printed on the
+// console, from where it can be saved and replayed on the host through the
+// same processing, as fast as it will go or at the recorded pace.
+//
+// Recording is cheap enough to leave in the sensor task and the interrupt
+// handlers: an event is three words stored under a short critical section.
+// It only starts once TraceRecStart() is called, and stops when full, so a
+// recording is one unbroken stretch of input from its start.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "utils/uartstdio.h"
+#include "drivers/trace_rec.h"
+
+//*****************************************************************************
+//
+// The recording.
+//
+//*****************************************************************************
+static TraceEvent_t g_psTraceRec[TRACE_REC_LEN];
+static uint32_t g_ui32TraceRecCount;
+static bool g_bTraceRecOn;
+
+//*****************************************************************************
+//
+// Stores an event, if recording.  Called with interrupts masked.
+//
+//*****************************************************************************
+static void
+prvTraceAdd(uint32_t ui32Time, uint32_t ui32Type, uint32_t ui32Value)
+{
+    TraceEvent_t *psEvent;
+
+    if(!g_bTraceRecOn)
+    {
+        return;
+    }
+
+    psEvent = &g_psTraceRec[g_ui32TraceRecCount];
+    psEvent->ui32Time = ui32Time;
+    psEvent->ui32Type = ui32Type;
+    psEvent->ui32Value = ui32Value;
+    if(++g_ui32TraceRecCount == TRACE_REC_LEN)
+    {
+        g_bTraceRecOn = false;
+    }
+}
+
+//*****************************************************************************
+//
+//! Starts a new recording, dropping what was recorded before.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TraceRecStart(void)
+{
+    taskENTER_CRITICAL();
+    g_ui32TraceRecCount = 0;
+    g_bTraceRecOn = true;
+    taskEXIT_CRITICAL();
+}
+
+//*****************************************************************************
+//
+//! Records an input, from a task.
+//!
+//! \param ui32Type is the kind of input, TRACE_EV_LIGHT, TRACE_EV_BUTTON or
+//! TRACE_EV_TOUCH.
+//! \param ui32Value is its value.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TraceRecord(uint32_t ui32Type, uint32_t ui32Value)
+{
+    taskENTER_CRITICAL();
+    prvTraceAdd(xTaskGetTickCount(), ui32Type, ui32Value);
+    taskEXIT_CRITICAL();
+}
+
+//*****************************************************************************
+//
+//! Records an input, from an interrupt handler.
+//!
+//! \param ui32Type is the kind of input.
+//! \param ui32Value is its value.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TraceRecordFromISR(uint32_t ui32Type, uint32_t ui32Value)
+{
+    UBaseType_t uxSaved;
+
+    uxSaved = taskENTER_CRITICAL_FROM_ISR();
+    prvTraceAdd(xTaskGetTickCountFromISR(), ui32Type, ui32Value);
+    taskEXIT_CRITICAL_FROM_ISR(uxSaved);
+}
+
+//*****************************************************************************
+//
+//! Records a touch screen message.
+//!
+//! \param ui32Msg is the message, WIDGET_MSG_PTR_DOWN, _MOVE or _UP.
+//! \param i32X is the X position.
+//! \param i32Y is the Y position.
+//!
+//! Has the form of the callback given to TouchScreenCallbackSet(), which
+//! calls it from the touch screen interrupt handler; a callback that does
+//! more can call this first.
+//!
+//! \return Returns zero.
+//
+//*****************************************************************************
+int32_t
+TraceRecTouch(uint32_t ui32Msg, int32_t i32X, int32_t i32Y)
+{
+    TraceRecordFromISR(TRACE_EV_TOUCH, TRACE_TOUCH(ui32Msg, i32X, i32Y));
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Tells whether the recording has filled up.
+//!
+//! \return Returns \b true if the recording is full and has stopped.
+//
+//*****************************************************************************
+bool
+TraceRecFull(void)
+{
+    return(g_ui32TraceRecCount == TRACE_REC_LEN);
+}
+
+//*****************************************************************************
+//
+//! Stops recording and gets the recording.
+//!
+//! \param ppsEvents is set to the events, oldest first.  They stay valid
+//! until TraceRecStart() is called again.
+//!
+//! \return Returns the number of events.
+//
+//*****************************************************************************
+uint32_t
+TraceRecGet(const TraceEvent_t **ppsEvents)
+{
+    taskENTER_CRITICAL();
+    g_bTraceRecOn = false;
+    taskEXIT_CRITICAL();
+
+    *ppsEvents = g_psTraceRec;
+    return(g_ui32TraceRecCount);
+}
+
+//*****************************************************************************
+//
+//! Stops recording and prints the recording on the console, in the form
+//! described in trace_rec.h.
+//!
+//! Takes about 20 characters an event, so must be called from a task that
+//! may block on the console for a while.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TraceRecDump(void)
+{
+    const TraceEvent_t *psEvents, *psEvent;
+    uint32_t ui32Idx, ui32Count;
+
+    ui32Count = TraceRecGet(&psEvents);
+
+    UARTprintf("TR begin %d\n", ui32Count);
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        psEvent = &psEvents[ui32Idx];
+        UARTprintf("TR %u %c %x\n", psEvent->ui32Time, psEvent->ui32Type,
+                   psEvent->ui32Value);
+    }
+    UARTprintf("TR end\n");
+}
@@ -0,0 +1,94 @@
+//*****************************************************************************
+//
+// trace_rec.h - Recording of the raw inputs, with their times, for replay
+//               on the host.
+//
+//*****************************************************************************
+
+#ifndef __TRACE_REC_H__
+#define __TRACE_REC_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The number of events a recording holds.  Recording stops when it is full.
+//
+//*****************************************************************************
+#define TRACE_REC_LEN           512
+
+//*****************************************************************************
+//
+// The kinds of input recorded, and what their values are.  TRACE_EV_LIGHT is
+// an OPT3001 result register reading, TRACE_EV_BUTTON the button pins of a
+// press, with the edges merged into it, and TRACE_EV_TOUCH a touch screen message, packed with
+// TRACE_TOUCH().
+//
+//*****************************************************************************
+#define TRACE_EV_LIGHT          'L'
+#define TRACE_EV_BUTTON         'B'
+#define TRACE_EV_TOUCH          'T'
+
+#define TRACE_TOUCH(ui32Msg, i32X, i32Y)                                      \
+                                (((uint32_t)(ui32Msg) << 20) |                \
+                                 (((uint32_t)(i32Y) & 0x3ff) << 10) |         \
+                                 ((uint32_t)(i32X) & 0x3ff))
+#define TRACE_TOUCH_MSG(ui32Value)                                            \
+                                ((ui32Value) >> 20)
+#define TRACE_TOUCH_X(ui32Value)                                              \
+                                ((int32_t)((ui32Value) & 0x3ff))
+#define TRACE_TOUCH_Y(ui32Value)                                              \
+                                ((int32_t)(((ui32Value) >> 10) & 0x3ff))
+
+//*****************************************************************************
+//
+// A recorded event: the tick it happened on, its kind and its value.
+//
+// TraceRecDump() prints each one on a line of its own as
+//
+//     TR <tick> <kind> <value in hex>
+//
+// between a "TR begin <count>" line and a "TR end" line, so a trace can be
+// cut out of a console log with everything else left in.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Time;
+    uint32_t ui32Type;
+    uint32_t ui32Value;
+}
+TraceEvent_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void TraceRecStart(void);
+extern void TraceRecord(uint32_t ui32Type, uint32_t ui32Value);
+extern void TraceRecordFromISR(uint32_t ui32Type, uint32_t ui32Value);
+extern int32_t TraceRecTouch(uint32_t ui32Msg, int32_t i32X, int32_t i32Y);
+extern bool TraceRecFull(void);
+extern uint32_t TraceRecGet(const TraceEvent_t **ppsEvents);
+extern void TraceRecDump(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TRACE_REC_H__
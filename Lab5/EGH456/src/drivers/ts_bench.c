@@ -0,0 +1,307 @@
+//*****************************************************************************
+//
+// ts_bench.c - Compression and cycle benchmark for the sample codec.
+//
+// The codec itself is in ts_codec.c, which has no target dependencies so
+// that it can be built on a host.  This codes light sensor traces as the
+// sensor task would log them and prints the size against the samples as
+// they are in memory, and the cycles per sample to encode and decode where
+// the cycle counter times code (see cycle_counter.h).
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "utils/uartstdio.h"
+#include "drivers/cycle_counter.h"
+#include "drivers/ts_codec.h"
+
+//*****************************************************************************
+//
+// The traces are 60 s of samples 100 ms apart, coded into blocks of
+// TS_BENCH_BLOCK bytes.  TS_BENCH_RECORD is the size of one sample as the
+// sensor task holds it: the raw reading, two floats and a tick count.
+//
+//*****************************************************************************
+#define TS_BENCH_SAMPLES        600
+#define TS_BENCH_PERIOD_MS      100
+#define TS_BENCH_BLOCK          256
+#define TS_BENCH_RECORD         16
+#define TS_BENCH_FILTER         10
+#define TS_BENCH_FIELDS         3
+
+//*****************************************************************************
+//
+// The samples: the raw reading, the lux level and the moving average of ten
+// levels, with the levels either as floats or in hundredths of a lux.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Time;
+    TsValue_t psValues[TS_BENCH_FIELDS];
+}
+TsBenchSample_t;
+
+static const TsSchema_t g_sTsBenchFloat =
+{
+    TS_BENCH_FIELDS, { TS_FIELD_INT, TS_FIELD_FLOAT, TS_FIELD_FLOAT }
+};
+
+static const TsSchema_t g_sTsBenchFixed =
+{
+    TS_BENCH_FIELDS, { TS_FIELD_INT, TS_FIELD_INT, TS_FIELD_INT }
+};
+
+static TsBenchSample_t g_psTsBenchSamples[TS_BENCH_SAMPLES];
+static uint8_t g_pui8TsBenchBlock[TS_BENCH_BLOCK];
+
+//*****************************************************************************
+//
+// The light levels of the traces, in hundredths of a lux at a time in ms:
+// a still room with sensor noise, a cloud passing, a lamp switched on and
+// off, and people walking past.
+//
+//*****************************************************************************
+static uint32_t
+prvLevelGet(uint32_t ui32Trace, uint32_t ui32Ms)
+{
+    switch(ui32Trace)
+    {
+        case 0:
+        {
+            return(30000 + ((ui32Ms * 2654435761u) >> 24) % 300 - 150);
+        }
+        case 1:
+        {
+            if(ui32Ms < 20000)
+            {
+                return(60000 - (30000 * ui32Ms) / 20000);
+            }
+            if(ui32Ms < 40000)
+            {
+                return(30000 + (30000 * (ui32Ms - 20000)) / 20000);
+            }
+            return(60000);
+        }
+        case 2:
+        {
+            return(((ui32Ms >= 15000) && (ui32Ms < 35000)) ? 40000 : 4000);
+        }
+        default:
+        {
+            return(((ui32Ms % 15000) < 300) ? 6000 : 30000);
+        }
+    }
+}
+
+static const char * const g_ppcTsBenchTraces[] =
+{
+    "steady", "cloud", "lamp", "shadow"
+};
+
+//*****************************************************************************
+//
+// Fills in the samples of a trace as the sensor task would take them: the
+// level read through the sensor's result format, its moving average, and
+// the tick, which now and then comes a tick late.
+//
+//*****************************************************************************
+static void
+prvTraceMake(uint32_t ui32Trace, bool bFixed)
+{
+    float pfWindow[TS_BENCH_FILTER] = { 0 };
+    float fLux, fSum;
+    uint32_t ui32Idx, ui32Tap, ui32Level, ui32Exp, ui32Seed = 1, ui32Count;
+    uint16_t ui16Raw;
+    TsBenchSample_t *psSample;
+
+    for(ui32Idx = 0; ui32Idx < TS_BENCH_SAMPLES; ui32Idx++)
+    {
+        psSample = &g_psTsBenchSamples[ui32Idx];
+        ui32Level = prvLevelGet(ui32Trace, ui32Idx * TS_BENCH_PERIOD_MS);
+        for(ui32Exp = 0; (ui32Level >> ui32Exp) > 4095; ui32Exp++)
+        {
+        }
+        ui16Raw = (uint16_t)((ui32Exp << 12) | (ui32Level >> ui32Exp));
+        fLux = (ui16Raw & 0xfff) * (0.01 * (1 << (ui16Raw >> 12)));
+
+        pfWindow[ui32Idx % TS_BENCH_FILTER] = fLux;
+        ui32Count = ui32Idx < TS_BENCH_FILTER ? ui32Idx + 1 : TS_BENCH_FILTER;
+        fSum = 0;
+        for(ui32Tap = 0; ui32Tap < ui32Count; ui32Tap++)
+        {
+            fSum += pfWindow[ui32Tap];
+        }
+
+        ui32Seed = (ui32Seed * 1664525) + 1013904223;
+        psSample->ui32Time = (ui32Idx * TS_BENCH_PERIOD_MS) +
+                             ((ui32Seed >> 28) == 0 ? 1 : 0);
+        psSample->psValues[0].ui = ui16Raw;
+        if(bFixed)
+        {
+            psSample->psValues[1].i = (int32_t)(fLux * 100 + 0.5f);
+            psSample->psValues[2].i = (int32_t)(fSum * 100 / ui32Count + 0.5f);
+        }
+        else
+        {
+            psSample->psValues[1].f = fLux;
+            psSample->psValues[2].f = fSum / ui32Count;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Decodes a finished block, checking it against the samples from ui32First,
+// and adds the cycles taken to *pui32Cycles.
+//
+//*****************************************************************************
+static bool
+prvBlockCheck(const TsSchema_t *psSchema, uint32_t ui32Size,
+              uint32_t ui32First, uint32_t *pui32Cycles)
+{
+    TsDecoder_t sDec;
+    TsValue_t psValues[TS_BENCH_FIELDS];
+    TsBenchSample_t *psSample;
+    uint32_t ui32Time, ui32Idx, ui32Start;
+    bool bOk = true, bMore;
+
+    for(ui32Idx = ui32First; ; ui32Idx++)
+    {
+        ui32Start = CycleCounterGet();
+        if(ui32Idx == ui32First)
+        {
+            TsDecoderInit(&sDec, psSchema, g_pui8TsBenchBlock, ui32Size);
+        }
+        bMore = TsDecoderNext(&sDec, &ui32Time, psValues);
+        *pui32Cycles += CycleCounterGet() - ui32Start;
+        if(!bMore)
+        {
+            break;
+        }
+
+        if(ui32Idx >= TS_BENCH_SAMPLES)
+        {
+            bOk = false;
+            break;
+        }
+        psSample = &g_psTsBenchSamples[ui32Idx];
+        if((ui32Time != psSample->ui32Time) ||
+           (psValues[0].ui != psSample->psValues[0].ui) ||
+           (psValues[1].ui != psSample->psValues[1].ui) ||
+           (psValues[2].ui != psSample->psValues[2].ui))
+        {
+            bOk = false;
+        }
+    }
+
+    return(bOk);
+}
+
+//*****************************************************************************
+//
+// Codes the samples into one block after another and prints a row.
+//
+//*****************************************************************************
+static void
+prvBenchRow(uint32_t ui32Trace, const char *pcValues,
+            const TsSchema_t *psSchema)
+{
+    TsEncoder_t sEnc;
+    uint32_t ui32Idx, ui32First = 0, ui32Start, ui32Size, ui32Bytes = 0;
+    uint32_t ui32Enc = 0, ui32Dec = 0, ui32Blocks = 0;
+    bool bOk = true;
+
+    taskENTER_CRITICAL();
+
+    TsEncoderInit(&sEnc, psSchema, g_pui8TsBenchBlock, TS_BENCH_BLOCK);
+    for(ui32Idx = 0; ui32Idx <= TS_BENCH_SAMPLES; ui32Idx++)
+    {
+        ui32Start = CycleCounterGet();
+        if((ui32Idx < TS_BENCH_SAMPLES) &&
+           TsEncoderAdd(&sEnc, g_psTsBenchSamples[ui32Idx].ui32Time,
+                        g_psTsBenchSamples[ui32Idx].psValues))
+        {
+            ui32Enc += CycleCounterGet() - ui32Start;
+            continue;
+        }
+        ui32Size = TsEncoderFinish(&sEnc);
+        ui32Enc += CycleCounterGet() - ui32Start;
+
+        ui32Bytes += ui32Size;
+        ui32Blocks++;
+        bOk &= prvBlockCheck(psSchema, ui32Size, ui32First, &ui32Dec);
+        if(ui32Idx == TS_BENCH_SAMPLES)
+        {
+            break;
+        }
+
+        //
+        // The sample refused goes first in the next block.
+        //
+        ui32Start = CycleCounterGet();
+        TsEncoderInit(&sEnc, psSchema, g_pui8TsBenchBlock, TS_BENCH_BLOCK);
+        TsEncoderAdd(&sEnc, g_psTsBenchSamples[ui32Idx].ui32Time,
+                     g_psTsBenchSamples[ui32Idx].psValues);
+        ui32Enc += CycleCounterGet() - ui32Start;
+        ui32First = ui32Idx;
+    }
+
+    taskEXIT_CRITICAL();
+
+    ui32Size = (TS_BENCH_SAMPLES * TS_BENCH_RECORD * 100) / ui32Bytes;
+#if CYCLE_COUNTER_TIMES_CODE
+    UARTprintf("%-8s %-6s %6d %3d %3d.%02d %6d %7d %7d%s\n",
+               g_ppcTsBenchTraces[ui32Trace], pcValues, ui32Bytes, ui32Blocks,
+               ui32Size / 100, ui32Size % 100,
+               (ui32Bytes * 8) / TS_BENCH_SAMPLES, ui32Enc / TS_BENCH_SAMPLES,
+               ui32Dec / TS_BENCH_SAMPLES, bOk ? "" : "  MISMATCH");
+#else
+    UARTprintf("%-8s %-6s %6d %3d %3d.%02d %6d%s\n",
+               g_ppcTsBenchTraces[ui32Trace], pcValues, ui32Bytes, ui32Blocks,
+               ui32Size / 100, ui32Size % 100,
+               (ui32Bytes * 8) / TS_BENCH_SAMPLES, bOk ? "" : "  MISMATCH");
+#endif
+}
+
+//*****************************************************************************
+//
+//! Prints the compression and cycle cost of the sample codec on the console.
+//!
+//! Each trace is coded with its levels as floats and again in hundredths of
+//! a lux, into blocks of TS_BENCH_BLOCK bytes, with interrupts masked.  The
+//! ratio is against TS_BENCH_RECORD bytes a sample, and the cycles are per
+//! sample, finishing and starting blocks included, and are left out when the
+//! cycle counter does not time code, as on the host.  Every block is decoded
+//! and checked against the samples; a row that differs reports MISMATCH.
+//! Must be called from a task.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+vTsCodecBenchmark(void)
+{
+    uint32_t ui32Trace;
+
+    CycleCounterInit();
+
+#if CYCLE_COUNTER_TIMES_CODE
+    UARTprintf("trace    values  bytes blk  ratio bits/s  encode  decode"
+               "  (cycles/sample)\n");
+#else
+    UARTprintf("trace    values  bytes blk  ratio bits/s\n");
+#endif
+    for(ui32Trace = 0;
+        ui32Trace < sizeof(g_ppcTsBenchTraces) / sizeof(g_ppcTsBenchTraces[0]);
+        ui32Trace++)
+    {
+        prvTraceMake(ui32Trace, false);
+        prvBenchRow(ui32Trace, "float", &g_sTsBenchFloat);
+        prvTraceMake(ui32Trace, true);
+        prvBenchRow(ui32Trace, "fixed", &g_sTsBenchFixed);
+    }
+}
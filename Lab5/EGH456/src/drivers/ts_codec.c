@@ -0,0 +1,493 @@
+//*****************************************************************************
+//
+// ts_codec.c - Streaming compression of timestamped sample series, in
+//              blocks that can be decoded on their own.
+//
+// A series of samples, each a timestamp and a few values, is packed into
+// blocks of a size the caller picks.  A block starts with a header holding
+// the number of samples in it and the first sample as it is; the rest are
+// coded against the sample before as a stream of bits, most significant
+// first.  A block therefore decodes without the ones before it, and the
+// first timestamps in the headers are enough to find the block holding a
+// given time.
+//
+// Timestamps are coded as the change in the interval between samples, so a
+// series read at a steady rate costs one bit per sample for its time:
+//
+//     0                        same interval as before
+//     10   + 7 bits            change of -64 to 63
+//     110  + 9 bits            change of -256 to 255
+//     1110 + 12 bits           change of -2048 to 2047
+//     1111 + 32 bits           anything else
+//
+// A TS_FIELD_FLOAT value is XORed with the one before.  Equal values cost a
+// single 0 bit.  Otherwise the bits that differ are stored after 10 if they
+// lie within the span of the last ones stored, or after 11 with a 5 bit
+// count of leading zeroes and a 5 bit length less one if not.  A float that
+// moves a little keeps its sign, exponent and top of its mantissa, so only
+// the low bits are stored.
+//
+// A TS_FIELD_INT value is stored as its difference from the one before,
+// zigzagged so that small negative differences are small too, in groups of
+// three bits with a fourth set on all but the last group.  An unchanged value
+// costs four bits.
+//
+// The encoder keeps only the previous sample, so its memory does not grow
+// with the series.  It refuses a sample unless the block has room for the
+// longest one, so a block is never left half written.
+//
+// Nothing here uses the kernel, so the codec builds on the host as well.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "drivers/ts_codec.h"
+
+//*****************************************************************************
+//
+// The most bits a sample can take: the longest timestamp code, and the
+// longest float or integer code for each field.
+//
+//*****************************************************************************
+#define TS_MAX_TIME_BITS        36
+#define TS_MAX_FIELD_BITS       44
+
+//*****************************************************************************
+//
+// Marks a field that has no span of changed bits yet.
+//
+//*****************************************************************************
+#define TS_NO_SPAN              0xff
+
+//*****************************************************************************
+//
+// Appends the low ui32Num bits of ui32Value, 1 to 32 of them, to a block.
+//
+//*****************************************************************************
+static inline void
+prvBitsPut(TsEncoder_t *psEnc, uint32_t ui32Value, uint32_t ui32Num)
+{
+    psEnc->ui64Bits = (psEnc->ui64Bits << ui32Num) |
+                      (ui32Value & (uint32_t)((1ULL << ui32Num) - 1));
+    psEnc->ui32NumBits += ui32Num;
+    while(psEnc->ui32NumBits >= 8)
+    {
+        psEnc->ui32NumBits -= 8;
+        psEnc->pui8Block[psEnc->ui32Pos++] =
+            (uint8_t)(psEnc->ui64Bits >> psEnc->ui32NumBits);
+    }
+}
+
+//*****************************************************************************
+//
+// Takes the next ui32Num bits, 1 to 32 of them, from a block.  Reads past
+// its end give zeroes.
+//
+//*****************************************************************************
+static inline uint32_t
+prvBitsGet(TsDecoder_t *psDec, uint32_t ui32Num)
+{
+    while(psDec->ui32NumBits < ui32Num)
+    {
+        psDec->ui64Bits <<= 8;
+        if(psDec->ui32Pos < psDec->ui32Size)
+        {
+            psDec->ui64Bits |= psDec->pui8Block[psDec->ui32Pos++];
+        }
+        psDec->ui32NumBits += 8;
+    }
+    psDec->ui32NumBits -= ui32Num;
+
+    return((uint32_t)(psDec->ui64Bits >> psDec->ui32NumBits) &
+           (uint32_t)((1ULL << ui32Num) - 1));
+}
+
+//*****************************************************************************
+//
+// Sign extends the low ui32Num bits of a value.
+//
+//*****************************************************************************
+static inline int32_t
+prvSignExtend(uint32_t ui32Value, uint32_t ui32Num)
+{
+    return((int32_t)(ui32Value << (32 - ui32Num)) >> (32 - ui32Num));
+}
+
+//*****************************************************************************
+//
+// Starts the state of each field at the first sample of a block.
+//
+//*****************************************************************************
+static void
+prvFieldsStart(TsField_t *psFields, const uint8_t *pui8Values,
+               uint32_t ui32Fields)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < ui32Fields; ui32Idx++)
+    {
+        memcpy(&psFields[ui32Idx].ui32Prev, pui8Values + 4 * ui32Idx, 4);
+        psFields[ui32Idx].ui8Leading = TS_NO_SPAN;
+        psFields[ui32Idx].ui8Trailing = TS_NO_SPAN;
+    }
+}
+
+//*****************************************************************************
+//
+//! Starts an encoder on an empty block.
+//!
+//! \param psEnc is the encoder.
+//! \param psSchema is what the samples hold.  It must stay valid while the
+//! encoder is used.
+//! \param pui8Block is the block to fill.
+//! \param ui32Size is the size of the block in bytes, at least
+//! TS_HDR_LEN() of the number of fields.
+//!
+//! Call again with the next block once TsEncoderAdd() refuses a sample and
+//! the block has been finished.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TsEncoderInit(TsEncoder_t *psEnc, const TsSchema_t *psSchema,
+              uint8_t *pui8Block, uint32_t ui32Size)
+{
+    psEnc->psSchema = psSchema;
+    psEnc->pui8Block = pui8Block;
+    psEnc->ui32Size = ui32Size;
+    psEnc->ui32Pos = TS_HDR_LEN(psSchema->ui32Fields);
+    psEnc->ui64Bits = 0;
+    psEnc->ui32NumBits = 0;
+    psEnc->ui32Count = 0;
+}
+
+//*****************************************************************************
+//
+//! Adds a sample to the block being filled.
+//!
+//! \param psEnc is the encoder.
+//! \param ui32Time is the sample's timestamp, in any unit.
+//! \param psValues are its values, one per field of the schema.
+//!
+//! \return Returns \b true if the sample was added, or \b false if the block
+//! may not have room for it, in which case it should be finished and the
+//! sample added to the next.
+//
+//*****************************************************************************
+bool
+TsEncoderAdd(TsEncoder_t *psEnc, uint32_t ui32Time, const TsValue_t *psValues)
+{
+    const TsSchema_t *psSchema = psEnc->psSchema;
+    uint32_t ui32Idx, ui32Xor, ui32Lead, ui32Trail, ui32Len, ui32Zig;
+    int32_t i32Delta, i32Dod;
+    TsField_t *psField;
+
+    if(psEnc->ui32Count == 0)
+    {
+        if(psEnc->ui32Size < psEnc->ui32Pos)
+        {
+            return(false);
+        }
+        memcpy(psEnc->pui8Block + TS_HDR_TIME, &ui32Time, 4);
+        memcpy(psEnc->pui8Block + TS_HDR_VALUES, psValues,
+               4 * psSchema->ui32Fields);
+        prvFieldsStart(psEnc->psFields, psEnc->pui8Block + TS_HDR_VALUES,
+                       psSchema->ui32Fields);
+        psEnc->ui32Time = ui32Time;
+        psEnc->i32Delta = 0;
+        psEnc->ui32Count = 1;
+        return(true);
+    }
+
+    if(((psEnc->ui32Size - psEnc->ui32Pos) * 8 - psEnc->ui32NumBits) <
+       (TS_MAX_TIME_BITS + (TS_MAX_FIELD_BITS * psSchema->ui32Fields)))
+    {
+        return(false);
+    }
+
+    //
+    // The timestamp, as the change in the interval.
+    //
+    i32Delta = (int32_t)(ui32Time - psEnc->ui32Time);
+    i32Dod = i32Delta - psEnc->i32Delta;
+    psEnc->ui32Time = ui32Time;
+    psEnc->i32Delta = i32Delta;
+    if(i32Dod == 0)
+    {
+        prvBitsPut(psEnc, 0, 1);
+    }
+    else if((i32Dod >= -64) && (i32Dod < 64))
+    {
+        prvBitsPut(psEnc, (0x2 << 7) | ((uint32_t)i32Dod & 0x7f), 9);
+    }
+    else if((i32Dod >= -256) && (i32Dod < 256))
+    {
+        prvBitsPut(psEnc, (0x6 << 9) | ((uint32_t)i32Dod & 0x1ff), 12);
+    }
+    else if((i32Dod >= -2048) && (i32Dod < 2048))
+    {
+        prvBitsPut(psEnc, (0xe << 12) | ((uint32_t)i32Dod & 0xfff), 16);
+    }
+    else
+    {
+        prvBitsPut(psEnc, 0xf, 4);
+        prvBitsPut(psEnc, (uint32_t)i32Dod, 32);
+    }
+
+    for(ui32Idx = 0; ui32Idx < psSchema->ui32Fields; ui32Idx++)
+    {
+        psField = &psEnc->psFields[ui32Idx];
+
+        if(psSchema->pui8Types[ui32Idx] == TS_FIELD_INT)
+        {
+            i32Delta = (int32_t)(psValues[ui32Idx].ui - psField->ui32Prev);
+            ui32Zig = ((uint32_t)i32Delta << 1) ^ (uint32_t)(i32Delta >> 31);
+            while(ui32Zig > 7)
+            {
+                prvBitsPut(psEnc, 0x8 | (ui32Zig & 7), 4);
+                ui32Zig >>= 3;
+            }
+            prvBitsPut(psEnc, ui32Zig, 4);
+        }
+        else
+        {
+            ui32Xor = psValues[ui32Idx].ui ^ psField->ui32Prev;
+            if(ui32Xor == 0)
+            {
+                prvBitsPut(psEnc, 0, 1);
+            }
+            else
+            {
+                ui32Lead = __builtin_clz(ui32Xor);
+                ui32Trail = __builtin_ctz(ui32Xor);
+                if((psField->ui8Leading != TS_NO_SPAN) &&
+                   (ui32Lead >= psField->ui8Leading) &&
+                   (ui32Trail >= psField->ui8Trailing))
+                {
+                    ui32Len = 32 - psField->ui8Leading - psField->ui8Trailing;
+                    prvBitsPut(psEnc, 0x2, 2);
+                    prvBitsPut(psEnc, ui32Xor >> psField->ui8Trailing,
+                               ui32Len);
+                }
+                else
+                {
+                    ui32Len = 32 - ui32Lead - ui32Trail;
+                    prvBitsPut(psEnc, (0x3 << 10) | (ui32Lead << 5) |
+                                      (ui32Len - 1), 12);
+                    prvBitsPut(psEnc, ui32Xor >> ui32Trail, ui32Len);
+                    psField->ui8Leading = (uint8_t)ui32Lead;
+                    psField->ui8Trailing = (uint8_t)ui32Trail;
+                }
+            }
+        }
+        psField->ui32Prev = psValues[ui32Idx].ui;
+    }
+
+    psEnc->ui32Count++;
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Finishes the block being filled.
+//!
+//! \param psEnc is the encoder.
+//!
+//! Pads the last byte and writes the header.  Only the bytes returned need
+//! be kept or sent; the block decodes the same whatever follows them.
+//!
+//! \return Returns the number of bytes of the block used, or zero if no
+//! samples were added.
+//
+//*****************************************************************************
+uint32_t
+TsEncoderFinish(TsEncoder_t *psEnc)
+{
+    if(psEnc->ui32Count == 0)
+    {
+        return(0);
+    }
+    if(psEnc->ui32NumBits)
+    {
+        prvBitsPut(psEnc, 0, 8 - psEnc->ui32NumBits);
+    }
+    memcpy(psEnc->pui8Block + TS_HDR_COUNT, &psEnc->ui32Count, 4);
+
+    return(psEnc->ui32Pos);
+}
+
+//*****************************************************************************
+//
+//! Starts a decoder on a finished block.
+//!
+//! \param psDec is the decoder.
+//! \param psSchema is what the samples hold, as they were encoded.
+//! \param pui8Block is the block.
+//! \param ui32Size is the number of bytes of it there are.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TsDecoderInit(TsDecoder_t *psDec, const TsSchema_t *psSchema,
+              const uint8_t *pui8Block, uint32_t ui32Size)
+{
+    psDec->psSchema = psSchema;
+    psDec->pui8Block = pui8Block;
+    psDec->ui32Size = ui32Size;
+    psDec->ui32Pos = TS_HDR_LEN(psSchema->ui32Fields);
+    psDec->ui64Bits = 0;
+    psDec->ui32NumBits = 0;
+    psDec->ui32Count = 0;
+    psDec->ui32Left = 0;
+    if(ui32Size >= psDec->ui32Pos)
+    {
+        psDec->ui32Count = TsBlockCountGet(pui8Block);
+        psDec->ui32Left = psDec->ui32Count;
+    }
+}
+
+//*****************************************************************************
+//
+//! Decodes the next sample of a block.
+//!
+//! \param psDec is the decoder.
+//! \param pui32Time is filled in with the sample's timestamp.
+//! \param psValues are filled in with its values, one per field.
+//!
+//! \return Returns \b true if there was a sample, or \b false at the end of
+//! the block.
+//
+//*****************************************************************************
+bool
+TsDecoderNext(TsDecoder_t *psDec, uint32_t *pui32Time, TsValue_t *psValues)
+{
+    const TsSchema_t *psSchema = psDec->psSchema;
+    uint32_t ui32Idx, ui32Lead, ui32Len, ui32Zig, ui32Shift, ui32Group;
+    int32_t i32Dod;
+    TsField_t *psField;
+
+    if(psDec->ui32Left == 0)
+    {
+        return(false);
+    }
+
+    if(psDec->ui32Left-- == psDec->ui32Count)
+    {
+        memcpy(&psDec->ui32Time, psDec->pui8Block + TS_HDR_TIME, 4);
+        psDec->i32Delta = 0;
+        prvFieldsStart(psDec->psFields, psDec->pui8Block + TS_HDR_VALUES,
+                       psSchema->ui32Fields);
+    }
+    else
+    {
+        if(prvBitsGet(psDec, 1) == 0)
+        {
+            i32Dod = 0;
+        }
+        else if(prvBitsGet(psDec, 1) == 0)
+        {
+            i32Dod = prvSignExtend(prvBitsGet(psDec, 7), 7);
+        }
+        else if(prvBitsGet(psDec, 1) == 0)
+        {
+            i32Dod = prvSignExtend(prvBitsGet(psDec, 9), 9);
+        }
+        else if(prvBitsGet(psDec, 1) == 0)
+        {
+            i32Dod = prvSignExtend(prvBitsGet(psDec, 12), 12);
+        }
+        else
+        {
+            i32Dod = (int32_t)prvBitsGet(psDec, 32);
+        }
+        psDec->i32Delta += i32Dod;
+        psDec->ui32Time += (uint32_t)psDec->i32Delta;
+
+        for(ui32Idx = 0; ui32Idx < psSchema->ui32Fields; ui32Idx++)
+        {
+            psField = &psDec->psFields[ui32Idx];
+
+            if(psSchema->pui8Types[ui32Idx] == TS_FIELD_INT)
+            {
+                ui32Zig = 0;
+                ui32Shift = 0;
+                do
+                {
+                    ui32Group = prvBitsGet(psDec, 4);
+                    ui32Zig |= (ui32Group & 7) << ui32Shift;
+                    ui32Shift += 3;
+                }
+                while((ui32Group & 0x8) && (ui32Shift < 33));
+                psField->ui32Prev += (ui32Zig >> 1) ^ (0 - (ui32Zig & 1));
+            }
+            else if(prvBitsGet(psDec, 1))
+            {
+                if(prvBitsGet(psDec, 1))
+                {
+                    ui32Lead = prvBitsGet(psDec, 5);
+                    ui32Len = prvBitsGet(psDec, 5) + 1;
+                    psField->ui8Leading = (uint8_t)ui32Lead;
+                    psField->ui8Trailing = (uint8_t)(32 - ui32Lead - ui32Len);
+                }
+                else
+                {
+                    ui32Len = 32 - psField->ui8Leading - psField->ui8Trailing;
+                }
+                psField->ui32Prev ^= prvBitsGet(psDec, ui32Len) <<
+                                     psField->ui8Trailing;
+            }
+        }
+    }
+
+    *pui32Time = psDec->ui32Time;
+    for(ui32Idx = 0; ui32Idx < psSchema->ui32Fields; ui32Idx++)
+    {
+        psValues[ui32Idx].ui = psDec->psFields[ui32Idx].ui32Prev;
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Gets the number of samples in a finished block.
+//!
+//! \param pui8Block is the block.
+//!
+//! \return Returns the number of samples.
+//
+//*****************************************************************************
+uint32_t
+TsBlockCountGet(const uint8_t *pui8Block)
+{
+    uint32_t ui32Count;
+
+    memcpy(&ui32Count, pui8Block + TS_HDR_COUNT, 4);
+    return(ui32Count);
+}
+
+//*****************************************************************************
+//
+//! Gets the timestamp of the first sample in a finished block.
+//!
+//! \param pui8Block is the block.
+//!
+//! Blocks of a series written one after another start at increasing times,
+//! so a search on this finds the block holding a given time without
+//! decoding any.
+//!
+//! \return Returns the timestamp.
+//
+//*****************************************************************************
+uint32_t
+TsBlockTimeGet(const uint8_t *pui8Block)
+{
+    uint32_t ui32Time;
+
+    memcpy(&ui32Time, pui8Block + TS_HDR_TIME, 4);
+    return(ui32Time);
+}
@@ -0,0 +1,161 @@
+//*****************************************************************************
+//
+// ts_codec.h - Streaming compression of timestamped sample series, in
+//              blocks that can be decoded on their own.
+//
+//*****************************************************************************
+
+#ifndef __TS_CODEC_H__
+#define __TS_CODEC_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The most values a sample may carry besides its timestamp.
+//
+//*****************************************************************************
+#define TS_MAX_FIELDS           4
+
+//*****************************************************************************
+//
+// How a value is coded.  TS_FIELD_FLOAT is XORed with the value before and
+// the bits that changed stored, which suits floats that move a little at a
+// time.  TS_FIELD_INT stores the difference from the value before as a
+// zigzag varint, and suits integer and fixed point values.
+//
+//*****************************************************************************
+#define TS_FIELD_FLOAT          0
+#define TS_FIELD_INT            1
+
+//*****************************************************************************
+//
+// The bytes at the start of a block: the sample count, the first timestamp
+// and the first sample's values as they are.  The header length depends on
+// the number of fields.
+//
+//*****************************************************************************
+#define TS_HDR_COUNT            0
+#define TS_HDR_TIME             4
+#define TS_HDR_VALUES           8
+#define TS_HDR_LEN(ui32Fields)  (TS_HDR_VALUES + 4 * (ui32Fields))
+
+//*****************************************************************************
+//
+// What a sample holds besides its timestamp, shared by the encoder and the
+// decoder of a series.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Fields;
+    uint8_t pui8Types[TS_MAX_FIELDS];
+}
+TsSchema_t;
+
+//*****************************************************************************
+//
+// A value, as the field's type says.
+//
+//*****************************************************************************
+typedef union
+{
+    float f;
+    int32_t i;
+    uint32_t ui;
+}
+TsValue_t;
+
+//*****************************************************************************
+//
+// The state of one field, for the encoder and the decoder alike.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Prev;
+    uint8_t ui8Leading;
+    uint8_t ui8Trailing;
+}
+TsField_t;
+
+//*****************************************************************************
+//
+// An encoder, filling one block at a time.  Set up with TsEncoderInit(); the
+// members are private.
+//
+//*****************************************************************************
+typedef struct
+{
+    const TsSchema_t *psSchema;
+    uint8_t *pui8Block;
+    uint32_t ui32Size;
+    uint32_t ui32Pos;
+    uint64_t ui64Bits;
+    uint32_t ui32NumBits;
+    uint32_t ui32Count;
+    uint32_t ui32Time;
+    int32_t i32Delta;
+    TsField_t psFields[TS_MAX_FIELDS];
+}
+TsEncoder_t;
+
+//*****************************************************************************
+//
+// A decoder, reading one block.  Set up with TsDecoderInit(); the members
+// are private.
+//
+//*****************************************************************************
+typedef struct
+{
+    const TsSchema_t *psSchema;
+    const uint8_t *pui8Block;
+    uint32_t ui32Size;
+    uint32_t ui32Pos;
+    uint64_t ui64Bits;
+    uint32_t ui32NumBits;
+    uint32_t ui32Count;
+    uint32_t ui32Left;
+    uint32_t ui32Time;
+    int32_t i32Delta;
+    TsField_t psFields[TS_MAX_FIELDS];
+}
+TsDecoder_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void TsEncoderInit(TsEncoder_t *psEnc, const TsSchema_t *psSchema,
+                          uint8_t *pui8Block, uint32_t ui32Size);
+extern bool TsEncoderAdd(TsEncoder_t *psEnc, uint32_t ui32Time,
+                         const TsValue_t *psValues);
+extern uint32_t TsEncoderFinish(TsEncoder_t *psEnc);
+extern void TsDecoderInit(TsDecoder_t *psDec, const TsSchema_t *psSchema,
+                          const uint8_t *pui8Block, uint32_t ui32Size);
+extern bool TsDecoderNext(TsDecoder_t *psDec, uint32_t *pui32Time,
+                          TsValue_t *psValues);
+extern uint32_t TsBlockCountGet(const uint8_t *pui8Block);
+extern uint32_t TsBlockTimeGet(const uint8_t *pui8Block);
+extern void vTsCodecBenchmark(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TS_CODEC_H__
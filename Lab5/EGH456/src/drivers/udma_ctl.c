@@ -0,0 +1,158 @@
+//*****************************************************************************
+//
+// udma_ctl.c - Shared uDMA controller setup and channel ownership.
+//
+// The uDMA controller has a single channel control table, so every driver
+// that moves data with uDMA goes through this module to enable the controller
+// and to claim the channels it uses.  Claiming a channel also selects its
+// peripheral mapping, which catches two drivers fighting over one channel at
+// start up instead of as corrupted transfers later.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/udma.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "drivers/udma_ctl.h"
+
+//*****************************************************************************
+//
+// The channel control table.  It holds the primary and alternate control
+// structures for all 32 channels and must be aligned on a 1024-byte boundary.
+//
+//*****************************************************************************
+static tDMAControlTable g_psDMAControlTable[64] __attribute__ ((aligned(1024)));
+
+//*****************************************************************************
+//
+// One bit per channel, set while the channel is owned by a driver.
+//
+//*****************************************************************************
+static uint32_t g_ui32DMAClaimed;
+
+static bool g_bDMAInitialised = false;
+
+volatile uint32_t g_ui32DMAErrorCount = 0;
+
+//*****************************************************************************
+//
+//! Enables the uDMA controller and installs the channel control table.
+//!
+//! This function may be called by every driver that uses uDMA; only the first
+//! call has any effect.  It must be called before the scheduler starts or
+//! from a single task, as it is not protected against concurrent callers.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DMAControlInit(void)
+{
+    if(g_bDMAInitialised)
+    {
+        return;
+    }
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UDMA))
+    {
+    }
+
+    uDMAEnable();
+    uDMAControlBaseSet(g_psDMAControlTable);
+
+    //
+    // Bus errors are reported here and simply counted; the channel that
+    // faulted is disabled by the controller.
+    //
+    uDMAIntRegister(INT_UDMAERR, uDMAErrorIntHandler);
+    IntPrioritySet(INT_UDMAERR, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    IntEnable(INT_UDMAERR);
+
+    g_ui32DMAClaimed = 0;
+    g_bDMAInitialised = true;
+}
+
+//*****************************************************************************
+//
+//! Claims a uDMA channel for the calling driver.
+//!
+//! \param ui32Mapping is one of the \b UDMA_CHn_xxx channel mappings from
+//! driverlib/udma.h.
+//!
+//! The channel is assigned to the requested peripheral and all of its
+//! attributes are cleared.
+//!
+//! \return Returns \b true if the channel was free, or \b false if another
+//! driver already owns it.
+//
+//*****************************************************************************
+bool
+DMAChannelClaim(uint32_t ui32Mapping)
+{
+    uint32_t ui32Channel = ui32Mapping & 0xff;
+    bool bFree;
+
+    DMAControlInit();
+
+    taskENTER_CRITICAL();
+    bFree = (g_ui32DMAClaimed & (1UL << ui32Channel)) == 0;
+    if(bFree)
+    {
+        g_ui32DMAClaimed |= 1UL << ui32Channel;
+    }
+    taskEXIT_CRITICAL();
+
+    if(!bFree)
+    {
+        return(false);
+    }
+
+    uDMAChannelAssign(ui32Mapping);
+    uDMAChannelAttributeDisable(ui32Channel, UDMA_ATTR_ALL);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Releases a channel previously claimed with DMAChannelClaim().
+//!
+//! \param ui32Mapping is the mapping or bare channel number to release.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DMAChannelRelease(uint32_t ui32Mapping)
+{
+    uint32_t ui32Channel = ui32Mapping & 0xff;
+
+    uDMAChannelDisable(ui32Channel);
+
+    taskENTER_CRITICAL();
+    g_ui32DMAClaimed &= ~(1UL << ui32Channel);
+    taskEXIT_CRITICAL();
+}
+
+//*****************************************************************************
+//
+// The uDMA error interrupt handler.
+//
+//*****************************************************************************
+void
+uDMAErrorIntHandler(void)
+{
+    if(uDMAErrorStatusGet())
+    {
+        uDMAErrorStatusClear();
+        g_ui32DMAErrorCount++;
+    }
+}
@@ -0,0 +1,47 @@
+//*****************************************************************************
+//
+// udma_ctl.h - Shared uDMA controller setup and channel ownership.
+//
+//*****************************************************************************
+
+#ifndef __UDMA_CTL_H__
+#define __UDMA_CTL_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Count of uDMA controller errors seen by the error interrupt.
+//
+//*****************************************************************************
+extern volatile uint32_t g_ui32DMAErrorCount;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void DMAControlInit(void);
+extern bool DMAChannelClaim(uint32_t ui32Mapping);
+extern void DMAChannelRelease(uint32_t ui32Mapping);
+extern void uDMAErrorIntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __UDMA_CTL_H__
@@ -0,0 +1,220 @@
+//*****************************************************************************
+//
+// wave_dds.c - Direct digital synthesis of PWM duty sequences from
+//              wavetables.
+//
+// A channel keeps a 32-bit phase accumulator and adds its step to it once a
+// sample, so its frequency is the step times the sample rate over 2^32: to
+// within 5 uHz at 20 kHz, and changed without any jump in phase by changing
+// the step.  The top bits of the phase index a one-cycle wavetable and the
+// bits below interpolate linearly to the next entry, which keeps the error
+// of a 512 entry sine table more than 90 dB down.
+// Any cycle can be played: sine and triangle tables are built here, and a
+// caller may supply its own.
+//
+// Each value is scaled by the channel's amplitude and turned into a pulse
+// width about half the PWM load, from 1 to one less than the load, so the
+// output never sticks fully on or off.  The widths are then quantized to
+// whole PWM clocks, which is what limits the purity of the output: a load of
+// 3000 gives a signal to noise ratio of about 71 dB.
+//
+// Changes are made between blocks.  The step and table take effect at the
+// first sample of the next block and the amplitude ramps to its new value
+// across it, so neither leaves a step in the output.
+//
+// Nothing here uses the kernel, so the engine builds on the host as well.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include "drivers/wave_dds.h"
+
+//*****************************************************************************
+//
+// Bits of the phase below the table index, and the mask of the 15 of them
+// that interpolate.
+//
+//*****************************************************************************
+#define DDS_FRAC_SHIFT          (32 - DDS_TABLE_BITS - 15)
+#define DDS_FRAC_M              0x7fff
+
+//*****************************************************************************
+//
+//! Builds a table holding one cycle of a sine.
+//!
+//! \param pi16Table is the table, of \b DDS_TABLE_LEN entries.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DdsTableSine(int16_t *pi16Table)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < DDS_TABLE_LEN; ui32Idx++)
+    {
+        pi16Table[ui32Idx] =
+            (int16_t)lrintf(32767.0f *
+                            sinf((6.28318531f * ui32Idx) / DDS_TABLE_LEN));
+    }
+}
+
+//*****************************************************************************
+//
+//! Builds a table holding one cycle of a triangle, rising through zero at
+//! the start as the sine does.
+//!
+//! \param pi16Table is the table, of \b DDS_TABLE_LEN entries.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DdsTableTriangle(int16_t *pi16Table)
+{
+    uint32_t ui32Idx;
+    int32_t i32Value;
+
+    for(ui32Idx = 0; ui32Idx < DDS_TABLE_LEN; ui32Idx++)
+    {
+        i32Value = (int32_t)((ui32Idx * 4 * 32767) / DDS_TABLE_LEN);
+        if(i32Value > 3 * 32767)
+        {
+            i32Value -= 4 * 32767;
+        }
+        else if(i32Value > 32767)
+        {
+            i32Value = (2 * 32767) - i32Value;
+        }
+        pi16Table[ui32Idx] = (int16_t)i32Value;
+    }
+}
+
+//*****************************************************************************
+//
+//! Works out the phase step for a frequency.
+//!
+//! \param ui32MilliHz is the frequency in mHz.  It should be below half the
+//! sample rate, or what is played is an alias of it.
+//! \param ui32SampleHz is the sample rate in Hz.
+//!
+//! \return Returns the step, rounded to the nearest.
+//
+//*****************************************************************************
+uint32_t
+DdsStepGet(uint32_t ui32MilliHz, uint32_t ui32SampleHz)
+{
+    uint64_t ui64Div;
+
+    ui64Div = (uint64_t)ui32SampleHz * 1000;
+    return((uint32_t)((((uint64_t)ui32MilliHz << 32) + (ui64Div / 2)) /
+                      ui64Div));
+}
+
+//*****************************************************************************
+//
+//! Sets up a channel, silent, at a given phase.
+//!
+//! \param psChan is the channel.
+//! \param pi16Table is the wavetable it plays.
+//! \param ui32Phase is the phase it starts from, as a fraction of a cycle
+//! over 2^32.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DdsChannelInit(DdsChannel_t *psChan, const int16_t *pi16Table,
+               uint32_t ui32Phase)
+{
+    psChan->pi16Table = pi16Table;
+    psChan->ui32Phase = ui32Phase;
+    psChan->ui32Step = 0;
+    psChan->ui32Amp = 0;
+    psChan->ui32AmpNext = 0;
+}
+
+//*****************************************************************************
+//
+//! Changes what a channel plays, from the next block on.
+//!
+//! \param psChan is the channel.
+//! \param pi16Table is the wavetable.
+//! \param ui32Step is the phase step, from DdsStepGet().
+//! \param ui32Amp is the amplitude in Q15, up to \b DDS_AMP_FULL.
+//!
+//! The phase carries on from where it is.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DdsChannelSet(DdsChannel_t *psChan, const int16_t *pi16Table,
+              uint32_t ui32Step, uint32_t ui32Amp)
+{
+    psChan->pi16Table = pi16Table;
+    psChan->ui32Step = ui32Step;
+    psChan->ui32AmpNext = (ui32Amp > DDS_AMP_FULL) ? DDS_AMP_FULL : ui32Amp;
+}
+
+//*****************************************************************************
+//
+//! Plays a block of a channel into pulse widths.
+//!
+//! \param psChan is the channel.
+//! \param pui32Width is filled with the widths, in PWM clocks.
+//! \param ui32Count is the number of samples in the block.
+//! \param ui32Load is the PWM period in PWM clocks, at least 3.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DdsFill(DdsChannel_t *psChan, uint32_t *pui32Width, uint32_t ui32Count,
+        uint32_t ui32Load)
+{
+    const int16_t *pi16Table = psChan->pi16Table;
+    uint32_t ui32Phase, ui32Idx, ui32Frac, ui32Half, ui32Sample;
+    int32_t i32Amp, i32AmpStep, i32Scale, i32Value, i32Next;
+
+    //
+    // The amplitude in Q23, so the ramp steps by a fraction of a Q15 unit.
+    //
+    ui32Half = ui32Load / 2;
+    i32Amp = (int32_t)psChan->ui32Amp << 8;
+    i32AmpStep = (((int32_t)psChan->ui32AmpNext - (int32_t)psChan->ui32Amp) *
+                  256) / (int32_t)ui32Count;
+    ui32Phase = psChan->ui32Phase;
+
+    for(ui32Sample = 0; ui32Sample < ui32Count; ui32Sample++)
+    {
+        //
+        // The table value between this entry and the next, in Q15.  The
+        // difference times a 15 bit fraction fits in 31 bits even for a jump
+        // from one end of the range to the other.
+        //
+        ui32Idx = ui32Phase >> (32 - DDS_TABLE_BITS);
+        ui32Frac = (ui32Phase >> DDS_FRAC_SHIFT) & DDS_FRAC_M;
+        i32Value = pi16Table[ui32Idx];
+        i32Next = pi16Table[(ui32Idx + 1) & (DDS_TABLE_LEN - 1)];
+        i32Value += ((i32Next - i32Value) * (int32_t)ui32Frac) >> 15;
+
+        //
+        // Scaled to at most one less than half the load either side of it,
+        // in Q30, and rounded.
+        //
+        i32Amp += i32AmpStep;
+        i32Scale = (i32Amp >> 8) * (int32_t)(ui32Half - 1);
+        pui32Width[ui32Sample] =
+            ui32Half + (int32_t)((((int64_t)i32Value * i32Scale) +
+                                  (1 << 29)) >> 30);
+
+        ui32Phase += psChan->ui32Step;
+    }
+
+    psChan->ui32Phase = ui32Phase;
+    psChan->ui32Amp = psChan->ui32AmpNext;
+}
@@ -0,0 +1,83 @@
+//*****************************************************************************
+//
+// wave_dds.h - Direct digital synthesis of PWM duty sequences from
+//              wavetables.
+//
+//*****************************************************************************
+
+#ifndef __WAVE_DDS_H__
+#define __WAVE_DDS_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The size of a wavetable.  A table holds one cycle of DDS_TABLE_LEN Q15
+// values; the top DDS_TABLE_BITS bits of the phase pick an entry and the next
+// 15 interpolate towards the one after, wrapping at the end.
+//
+//*****************************************************************************
+#define DDS_TABLE_BITS          9
+#define DDS_TABLE_LEN           (1 << DDS_TABLE_BITS)
+
+//*****************************************************************************
+//
+// Full scale of an amplitude, in Q15: a value of DDS_AMP_FULL swings the
+// pulse width from 1 to one less than the load.
+//
+//*****************************************************************************
+#define DDS_AMP_FULL            32768
+
+//*****************************************************************************
+//
+// A channel.  ui32Phase is the fraction of a cycle reached, over 2^32, and
+// ui32Step what is added to it per sample.  The amplitude ramps from ui32Amp
+// to ui32AmpNext over the next block, so a change never steps the output.
+// Set up with DdsChannelInit(); the members may be read, and changed only
+// through DdsChannelSet() between blocks.
+//
+//*****************************************************************************
+typedef struct
+{
+    const int16_t *pi16Table;
+    uint32_t ui32Phase;
+    uint32_t ui32Step;
+    uint32_t ui32Amp;
+    uint32_t ui32AmpNext;
+}
+DdsChannel_t;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void DdsTableSine(int16_t *pi16Table);
+extern void DdsTableTriangle(int16_t *pi16Table);
+extern uint32_t DdsStepGet(uint32_t ui32MilliHz, uint32_t ui32SampleHz);
+extern void DdsChannelInit(DdsChannel_t *psChan, const int16_t *pi16Table,
+                           uint32_t ui32Phase);
+extern void DdsChannelSet(DdsChannel_t *psChan, const int16_t *pi16Table,
+                          uint32_t ui32Step, uint32_t ui32Amp);
+extern void DdsFill(DdsChannel_t *psChan, uint32_t *pui32Width,
+                    uint32_t ui32Count, uint32_t ui32Load);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WAVE_DDS_H__
@@ -0,0 +1,577 @@
+//*****************************************************************************
+//
+// wave_gen.c - Waveform generation on PWM outputs, with the duty cycle of
+//              every period written by uDMA from synthesized tables.
+//
+// Each channel is a PWM output whose duty cycle follows a waveform: low
+// pass filter it and the waveform comes out.  The samples are pulse widths
+// made by the DDS engine (see wave_dds.c) into a ping-pong buffer per
+// channel, and a uDMA channel copies one into the output's compare register
+// every PWM period, so once running the CPU only fills a block every
+// WAVE_GEN_BLOCK periods.
+//
+// The PWM module raises no uDMA requests, so the copies are paced by Timer
+// 7 instead, split into its A and B halves, one per channel.  Each half
+// times out once per PWM period, counting the system clock over the same
+// number of cycles as the generator counts PWM clocks, and its timeout
+// requests the copy.  The halves are started by one register write, half a
+// period after the generator's time base is reset, so every copy lands
+// mid-period and the compare takes the new value at the start of the next:
+// each sample lasts exactly one period, on both channels at once.
+//
+// Both outputs run off generator 3, counting down, with the output low from
+// the load and high from the compare, so a compare value is the pulse width
+// less one clock.  The generator's period is the system clock over
+// WAVE_GEN_SAMPLE_HZ, rounded down to a whole number of PWM clocks; at the
+// clock levels in use it divides exactly, so the sample rate is exact.
+//
+// When a half of a buffer has been copied out, the uDMA channel stops on it
+// and the timer's DMA done interrupt re-arms it and wakes the task.  Once
+// the same half of every channel is done the task fills it, for all the
+// channels from one snapshot of their settings, so a change made to several
+// channels between blocks takes effect on all of them at the same sample.
+// If the task falls a block behind, the stale block plays again; this is
+// counted as an underrun.
+//
+// A system clock change reprograms the periods and realigns the timer.  The
+// blocks already queued were made for the old period and play out
+// distorted, for at most two blocks.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_pwm.h"
+#include "inc/hw_timer.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/pwm.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/udma.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "task_stacks.h"
+#include "drivers/udma_ctl.h"
+#include "drivers/clock_scale.h"
+#include "drivers/wave_dds.h"
+#include "drivers/wave_gen.h"
+
+//*****************************************************************************
+//
+// Hardware resources used by the generator.
+//
+//*****************************************************************************
+#define WAVE_GEN_GPIO_PERIPH    SYSCTL_PERIPH_GPIOK
+#define WAVE_GEN_GPIO_BASE      GPIO_PORTK_BASE
+#define WAVE_GEN_GPIO_PINS      (GPIO_PIN_4 | GPIO_PIN_5)
+
+#define WAVE_GEN_PWM_PERIPH     SYSCTL_PERIPH_PWM0
+#define WAVE_GEN_PWM_BASE       PWM0_BASE
+#define WAVE_GEN_PWM_GEN        PWM_GEN_3
+#define WAVE_GEN_PWM_GEN_BIT    PWM_GEN_3_BIT
+#define WAVE_GEN_PWM_OUT_BITS   (PWM_OUT_6_BIT | PWM_OUT_7_BIT)
+
+#define WAVE_GEN_TIMER_PERIPH   SYSCTL_PERIPH_TIMER7
+#define WAVE_GEN_TIMER_BASE     TIMER7_BASE
+
+//*****************************************************************************
+//
+// The resources of each channel: its pin, the timer half and uDMA channel
+// that pace it, and the compare register it writes.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32PinConfig;
+    uint32_t ui32TimerInt;
+    uint32_t ui32DmaInt;
+    uint32_t ui32Dma;
+    uint32_t ui32Cmp;
+}
+WaveGenOut_t;
+
+static const WaveGenOut_t g_psWaveGenOuts[WAVE_GEN_CHANNELS] =
+{
+    {
+        GPIO_PK4_M0PWM6, INT_TIMER7A, TIMER_TIMA_DMA, UDMA_CH12_TIMER7A,
+        PWM_O_X_CMPA
+    },
+    {
+        GPIO_PK5_M0PWM7, INT_TIMER7B, TIMER_TIMB_DMA, UDMA_CH13_TIMER7B,
+        PWM_O_X_CMPB
+    }
+};
+
+//*****************************************************************************
+//
+// The done flag of half ui32Half of channel ui32Chan, and of that half of
+// every channel.
+//
+//*****************************************************************************
+#define WAVE_GEN_DONE(ui32Chan, ui32Half)                                     \
+                                (1 << (((ui32Half) * WAVE_GEN_CHANNELS) +     \
+                                       (ui32Chan)))
+#define WAVE_GEN_DONE_ALL(ui32Half)                                           \
+                                (((1 << WAVE_GEN_CHANNELS) - 1) <<            \
+                                 ((ui32Half) * WAVE_GEN_CHANNELS))
+
+//*****************************************************************************
+//
+// The buffers, and the halves of them copied out and not yet refilled.
+// Read by the uDMA and written by the interrupt handler and the task.
+//
+//*****************************************************************************
+static uint32_t g_ppui32WaveBuf[WAVE_GEN_CHANNELS][2 * WAVE_GEN_BLOCK];
+static volatile uint32_t g_ui32WaveDone;
+static uint32_t g_ui32WaveHalf;
+
+//
+// The channels, as the task plays them, and the settings waiting for the
+// next block, with a flag per channel that has one.
+//
+static DdsChannel_t g_psWaveDds[WAVE_GEN_CHANNELS];
+static DdsChannel_t g_psWaveNext[WAVE_GEN_CHANNELS];
+static uint32_t g_ui32WaveChanged;
+
+//
+// The sine table the channels start with.
+//
+static int16_t g_pi16WaveSine[DDS_TABLE_LEN];
+
+//
+// The period in system clocks and in PWM clocks.  Written by the clock
+// change notifier.
+//
+static volatile uint32_t g_ui32WaveCycles;
+static volatile uint32_t g_ui32WaveLoad;
+
+static volatile bool g_bWaveRunning = false;
+static uint32_t g_ui32WaveUnderruns;
+static TaskHandle_t g_xWaveTask = NULL;
+
+static void prvWaveGenTask(void *pvParameters);
+
+//*****************************************************************************
+//
+// Works out the periods for a system clock frequency, from the PWM clock
+// divider the module is set to, and programs them.
+//
+//*****************************************************************************
+static void
+prvPeriodSet(uint32_t ui32SysClock)
+{
+    uint32_t ui32Clock, ui32Div;
+
+    ui32Clock = PWMClockGet(WAVE_GEN_PWM_BASE);
+    ui32Div = (ui32Clock & PWM_SYSCLK_DIV_2) ? (2 << (ui32Clock & 7)) : 1;
+
+    g_ui32WaveLoad = ui32SysClock / WAVE_GEN_SAMPLE_HZ / ui32Div;
+    g_ui32WaveCycles = g_ui32WaveLoad * ui32Div;
+
+    PWMGenPeriodSet(WAVE_GEN_PWM_BASE, WAVE_GEN_PWM_GEN, g_ui32WaveLoad);
+    TimerLoadSet(WAVE_GEN_TIMER_BASE, TIMER_BOTH, g_ui32WaveCycles - 1);
+}
+
+//*****************************************************************************
+//
+// Starts the timer half a period after the start of a PWM period.  Both
+// halves are started by one write, so they stay a fixed few cycles apart.
+//
+//*****************************************************************************
+static void
+prvTimerAlign(void)
+{
+    TimerDisable(WAVE_GEN_TIMER_BASE, TIMER_BOTH);
+    HWREG(WAVE_GEN_TIMER_BASE + TIMER_O_TAV) = g_ui32WaveCycles / 2;
+    HWREG(WAVE_GEN_TIMER_BASE + TIMER_O_TBV) = g_ui32WaveCycles / 2;
+    PWMSyncTimeBase(WAVE_GEN_PWM_BASE, WAVE_GEN_PWM_GEN_BIT);
+    TimerEnable(WAVE_GEN_TIMER_BASE, TIMER_BOTH);
+}
+
+static void
+prvWaveGenClockPost(uint32_t ui32NewHz, void *pvArg)
+{
+    (void)pvArg;
+
+    prvPeriodSet(ui32NewHz);
+    if(g_bWaveRunning)
+    {
+        prvTimerAlign();
+    }
+}
+
+static ClockNotifier_t g_sWaveGenClockNotifier =
+{
+    NULL, prvWaveGenClockPost, NULL, NULL
+};
+
+//*****************************************************************************
+//
+// Points one of a channel's control structures at its half of the buffer.
+//
+//*****************************************************************************
+static void
+prvArm(uint32_t ui32Chan, uint32_t ui32Select)
+{
+    const WaveGenOut_t *psOut = &g_psWaveGenOuts[ui32Chan];
+    uint32_t *pui32Src = g_ppui32WaveBuf[ui32Chan];
+
+    if(ui32Select == UDMA_ALT_SELECT)
+    {
+        pui32Src += WAVE_GEN_BLOCK;
+    }
+
+    uDMAChannelTransferSet((psOut->ui32Dma & 0xff) | ui32Select,
+                           UDMA_MODE_PINGPONG, pui32Src,
+                           (void *)(WAVE_GEN_PWM_BASE + WAVE_GEN_PWM_GEN +
+                                    psOut->ui32Cmp),
+                           WAVE_GEN_BLOCK);
+}
+
+//*****************************************************************************
+//
+// Fills one half of every channel's buffer, taking up the settings made
+// since the last block.
+//
+//*****************************************************************************
+static void
+prvBlockFill(uint32_t ui32Half)
+{
+    DdsChannel_t *psNext;
+    uint32_t ui32Chan, ui32Load;
+
+    taskENTER_CRITICAL();
+    for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+    {
+        if(g_ui32WaveChanged & (1 << ui32Chan))
+        {
+            psNext = &g_psWaveNext[ui32Chan];
+            DdsChannelSet(&g_psWaveDds[ui32Chan], psNext->pi16Table,
+                          psNext->ui32Step, psNext->ui32AmpNext);
+        }
+    }
+    g_ui32WaveChanged = 0;
+    ui32Load = g_ui32WaveLoad;
+    taskEXIT_CRITICAL();
+
+    //
+    // A compare value of c makes a pulse c + 1 clocks wide, so the widths
+    // are made for a load one less than the period.
+    //
+    for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+    {
+        DdsFill(&g_psWaveDds[ui32Chan],
+                &g_ppui32WaveBuf[ui32Chan][ui32Half * WAVE_GEN_BLOCK],
+                WAVE_GEN_BLOCK, ui32Load - 1);
+    }
+}
+
+//*****************************************************************************
+//
+//! Sets up the PWM outputs, the timer and the uDMA channels, silent.
+//!
+//! \param ui32SysClock is the system clock frequency.
+//!
+//! This takes over PK4, PK5, PWM generator 3 and Timer 7.  The PWM clock
+//! divider is shared by the whole module, and is left as LedFxInit() sets
+//! it, so call this after that.
+//!
+//! \return Returns \b false if either uDMA channel is owned by another
+//! driver.
+//
+//*****************************************************************************
+bool
+WaveGenInit(uint32_t ui32SysClock)
+{
+    uint32_t ui32Chan;
+
+    if(!DMAChannelClaim(g_psWaveGenOuts[0].ui32Dma))
+    {
+        return(false);
+    }
+    if(!DMAChannelClaim(g_psWaveGenOuts[1].ui32Dma))
+    {
+        DMAChannelRelease(g_psWaveGenOuts[0].ui32Dma);
+        return(false);
+    }
+
+    SysCtlPeripheralEnable(WAVE_GEN_GPIO_PERIPH);
+    SysCtlPeripheralEnable(WAVE_GEN_PWM_PERIPH);
+    SysCtlPeripheralEnable(WAVE_GEN_TIMER_PERIPH);
+    while(!SysCtlPeripheralReady(WAVE_GEN_GPIO_PERIPH) ||
+          !SysCtlPeripheralReady(WAVE_GEN_PWM_PERIPH) ||
+          !SysCtlPeripheralReady(WAVE_GEN_TIMER_PERIPH))
+    {
+    }
+
+    DdsTableSine(g_pi16WaveSine);
+    for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+    {
+        DdsChannelInit(&g_psWaveDds[ui32Chan], g_pi16WaveSine, 0);
+        GPIOPinConfigure(g_psWaveGenOuts[ui32Chan].ui32PinConfig);
+    }
+    GPIOPinTypePWM(WAVE_GEN_GPIO_BASE, WAVE_GEN_GPIO_PINS);
+    g_ui32WaveChanged = 0;
+    g_ui32WaveUnderruns = 0;
+
+    //
+    // Counting down, low from the load and high from the compare.  The
+    // compares take their new values at the end of the period.
+    //
+    PWMGenConfigure(WAVE_GEN_PWM_BASE, WAVE_GEN_PWM_GEN,
+                    PWM_GEN_MODE_DOWN | PWM_GEN_MODE_NO_SYNC);
+    HWREG(WAVE_GEN_PWM_BASE + WAVE_GEN_PWM_GEN + PWM_O_X_GENA) =
+        PWM_X_GENA_ACTLOAD_ZERO | PWM_X_GENA_ACTCMPAD_ONE;
+    HWREG(WAVE_GEN_PWM_BASE + WAVE_GEN_PWM_GEN + PWM_O_X_GENB) =
+        PWM_X_GENB_ACTLOAD_ZERO | PWM_X_GENB_ACTCMPBD_ONE;
+    PWMOutputState(WAVE_GEN_PWM_BASE, WAVE_GEN_PWM_OUT_BITS, false);
+
+    TimerConfigure(WAVE_GEN_TIMER_BASE, TIMER_CFG_SPLIT_PAIR |
+                   TIMER_CFG_A_PERIODIC | TIMER_CFG_B_PERIODIC);
+    TimerClockSourceSet(WAVE_GEN_TIMER_BASE, TIMER_CLOCK_SYSTEM);
+    TimerDMAEventSet(WAVE_GEN_TIMER_BASE,
+                     TIMER_DMA_TIMEOUT_A | TIMER_DMA_TIMEOUT_B);
+    prvPeriodSet(ui32SysClock);
+
+    for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+    {
+        uDMAChannelControlSet((g_psWaveGenOuts[ui32Chan].ui32Dma & 0xff) |
+                              UDMA_PRI_SELECT,
+                              UDMA_SIZE_32 | UDMA_SRC_INC_32 |
+                              UDMA_DST_INC_NONE | UDMA_ARB_1);
+        uDMAChannelControlSet((g_psWaveGenOuts[ui32Chan].ui32Dma & 0xff) |
+                              UDMA_ALT_SELECT,
+                              UDMA_SIZE_32 | UDMA_SRC_INC_32 |
+                              UDMA_DST_INC_NONE | UDMA_ARB_1);
+        IntPrioritySet(g_psWaveGenOuts[ui32Chan].ui32TimerInt,
+                       configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    }
+    TimerIntRegister(WAVE_GEN_TIMER_BASE, TIMER_A, WaveGenIntHandler);
+    TimerIntRegister(WAVE_GEN_TIMER_BASE, TIMER_B, WaveGenIntHandler);
+
+    ClockNotifierRegister(&g_sWaveGenClockNotifier);
+
+    if(g_xWaveTask == NULL)
+    {
+        xTaskCreate(prvWaveGenTask, "WaveGen", TASK_STACK_WAVE_GEN, NULL,
+                    WAVE_GEN_TASK_PRIORITY, &g_xWaveTask);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Sets what a channel plays.
+//!
+//! \param ui32Channel is the channel, 0 or 1.
+//! \param pi16Table is the wavetable, of \b DDS_TABLE_LEN Q15 values, or
+//! NULL for a sine.  It must stay valid while it is played.
+//! \param ui32MilliHz is the frequency in mHz, below half of
+//! \b WAVE_GEN_SAMPLE_HZ.
+//! \param ui32Amp is the amplitude in Q15, up to \b DDS_AMP_FULL for the
+//! full range of the duty cycle.
+//!
+//! The change takes effect at the start of the next block, with the phase
+//! carrying on and the amplitude ramped over that block, so there is no
+//! step in the output.  Changes to several channels made before the same
+//! block take effect at the same sample.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+WaveGenSet(uint32_t ui32Channel, const int16_t *pi16Table,
+           uint32_t ui32MilliHz, uint32_t ui32Amp)
+{
+    DdsChannel_t *psNext = &g_psWaveNext[ui32Channel];
+
+    taskENTER_CRITICAL();
+    psNext->pi16Table = pi16Table ? pi16Table : g_pi16WaveSine;
+    psNext->ui32Step = DdsStepGet(ui32MilliHz, WAVE_GEN_SAMPLE_HZ);
+    psNext->ui32AmpNext = ui32Amp;
+    g_ui32WaveChanged |= 1 << ui32Channel;
+    taskEXIT_CRITICAL();
+}
+
+//*****************************************************************************
+//
+//! Starts the outputs, every channel from a given phase.
+//!
+//! \param pui32Phases is the phase each channel starts from, as a fraction
+//! of a cycle over 2^32, or NULL to start them all from zero.  Channels at
+//! the same frequency keep the difference, so 0x40000000 apart gives a
+//! quadrature pair.
+//!
+//! The amplitudes ramp up from zero over the first block.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+WaveGenStart(const uint32_t *pui32Phases)
+{
+    uint32_t ui32Chan;
+
+    WaveGenStop();
+
+    for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+    {
+        g_psWaveDds[ui32Chan].ui32Phase = pui32Phases ?
+                                          pui32Phases[ui32Chan] : 0;
+        g_psWaveDds[ui32Chan].ui32Amp = 0;
+    }
+    prvBlockFill(0);
+    prvBlockFill(1);
+    g_ui32WaveDone = 0;
+    g_ui32WaveHalf = 0;
+
+    for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+    {
+        HWREG(WAVE_GEN_PWM_BASE + WAVE_GEN_PWM_GEN +
+              g_psWaveGenOuts[ui32Chan].ui32Cmp) = g_ui32WaveLoad / 2;
+        prvArm(ui32Chan, UDMA_PRI_SELECT);
+        prvArm(ui32Chan, UDMA_ALT_SELECT);
+        uDMAChannelEnable(g_psWaveGenOuts[ui32Chan].ui32Dma & 0xff);
+    }
+
+    TimerIntClear(WAVE_GEN_TIMER_BASE, TIMER_TIMA_DMA | TIMER_TIMB_DMA);
+    TimerIntEnable(WAVE_GEN_TIMER_BASE, TIMER_TIMA_DMA | TIMER_TIMB_DMA);
+    PWMGenEnable(WAVE_GEN_PWM_BASE, WAVE_GEN_PWM_GEN);
+    PWMOutputState(WAVE_GEN_PWM_BASE, WAVE_GEN_PWM_OUT_BITS, true);
+
+    taskENTER_CRITICAL();
+    g_bWaveRunning = true;
+    prvTimerAlign();
+    taskEXIT_CRITICAL();
+}
+
+//*****************************************************************************
+//
+//! Stops the outputs, leaving them low.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+WaveGenStop(void)
+{
+    uint32_t ui32Chan;
+
+    taskENTER_CRITICAL();
+    g_bWaveRunning = false;
+    TimerDisable(WAVE_GEN_TIMER_BASE, TIMER_BOTH);
+    taskEXIT_CRITICAL();
+
+    TimerIntDisable(WAVE_GEN_TIMER_BASE, TIMER_TIMA_DMA | TIMER_TIMB_DMA);
+    for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+    {
+        uDMAChannelDisable(g_psWaveGenOuts[ui32Chan].ui32Dma & 0xff);
+    }
+    PWMOutputState(WAVE_GEN_PWM_BASE, WAVE_GEN_PWM_OUT_BITS, false);
+    PWMGenDisable(WAVE_GEN_PWM_BASE, WAVE_GEN_PWM_GEN);
+}
+
+//*****************************************************************************
+//
+//! Returns the number of blocks played again because the task had not
+//! refilled them in time.
+//!
+//! \return The underrun count since WaveGenInit().
+//
+//*****************************************************************************
+uint32_t
+WaveGenUnderrunsGet(void)
+{
+    return(g_ui32WaveUnderruns);
+}
+
+//*****************************************************************************
+//
+// The Timer 7A and 7B interrupt handler.  Runs when either channel has
+// copied out half its buffer, re-arms it and tells the task.
+//
+//*****************************************************************************
+void
+WaveGenIntHandler(void)
+{
+    BaseType_t xWoken = pdFALSE;
+    const WaveGenOut_t *psOut;
+    uint32_t ui32Status, ui32Chan, ui32Done;
+
+    ui32Status = TimerIntStatus(WAVE_GEN_TIMER_BASE, true);
+    TimerIntClear(WAVE_GEN_TIMER_BASE, ui32Status);
+
+    ui32Done = 0;
+    for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+    {
+        psOut = &g_psWaveGenOuts[ui32Chan];
+        if(!(ui32Status & psOut->ui32DmaInt))
+        {
+            continue;
+        }
+        if(uDMAChannelModeGet((psOut->ui32Dma & 0xff) | UDMA_PRI_SELECT) ==
+           UDMA_MODE_STOP)
+        {
+            prvArm(ui32Chan, UDMA_PRI_SELECT);
+            ui32Done |= WAVE_GEN_DONE(ui32Chan, 0);
+        }
+        if(uDMAChannelModeGet((psOut->ui32Dma & 0xff) | UDMA_ALT_SELECT) ==
+           UDMA_MODE_STOP)
+        {
+            prvArm(ui32Chan, UDMA_ALT_SELECT);
+            ui32Done |= WAVE_GEN_DONE(ui32Chan, 1);
+        }
+    }
+
+    if(ui32Done == 0)
+    {
+        return;
+    }
+    if(g_ui32WaveDone & ui32Done)
+    {
+        g_ui32WaveUnderruns++;
+    }
+    g_ui32WaveDone |= ui32Done;
+
+    vTaskNotifyGiveFromISR(g_xWaveTask, &xWoken);
+    portYIELD_FROM_ISR(xWoken);
+}
+
+//*****************************************************************************
+//
+// The task that fills the blocks.  The halves finish in turn, so it waits
+// for the next one to be done on every channel and fills it for all of
+// them.
+//
+//*****************************************************************************
+static void
+prvWaveGenTask(void *pvParameters)
+{
+    uint32_t ui32Mask;
+
+    (void)pvParameters;
+
+    for(;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        ui32Mask = WAVE_GEN_DONE_ALL(g_ui32WaveHalf);
+        while(g_bWaveRunning && ((g_ui32WaveDone & ui32Mask) == ui32Mask))
+        {
+            prvBlockFill(g_ui32WaveHalf);
+
+            taskENTER_CRITICAL();
+            g_ui32WaveDone &= ~ui32Mask;
+            taskEXIT_CRITICAL();
+
+            g_ui32WaveHalf ^= 1;
+            ui32Mask = WAVE_GEN_DONE_ALL(g_ui32WaveHalf);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+//*****************************************************************************
+//
+// wave_gen.h - Waveform generation on PWM outputs, with the duty cycle of
+//              every period written by uDMA from synthesized tables.
+//
+//*****************************************************************************
+
+#ifndef __WAVE_GEN_H__
+#define __WAVE_GEN_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The channels: 0 on PK4 (M0PWM6) and 1 on PK5 (M0PWM7).  Both run off one
+// generator, so their periods are the same and their samples change
+// together.
+//
+//*****************************************************************************
+#define WAVE_GEN_CHANNELS       2
+
+//*****************************************************************************
+//
+// The PWM frequency, which is also the sample rate, and the number of
+// samples in each half of a channel's ping-pong buffer.  A parameter change
+// waits for the next block, so takes effect within two blocks, 12.8 ms.
+//
+//*****************************************************************************
+#define WAVE_GEN_SAMPLE_HZ      20000
+#define WAVE_GEN_BLOCK          128
+
+//*****************************************************************************
+//
+// Priority of the task that fills the blocks.  It must fill one in less
+// than a block's time, so it runs above the display and sensor tasks.
+//
+//*****************************************************************************
+#define WAVE_GEN_TASK_PRIORITY                                                \
+                                (tskIDLE_PRIORITY + 4)
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern bool WaveGenInit(uint32_t ui32SysClock);
+extern void WaveGenSet(uint32_t ui32Channel, const int16_t *pi16Table,
+                       uint32_t ui32MilliHz, uint32_t ui32Amp);
+extern void WaveGenStart(const uint32_t *pui32Phases);
+extern void WaveGenStop(void);
+extern uint32_t WaveGenUnderrunsGet(void);
+extern void WaveGenIntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WAVE_GEN_H__
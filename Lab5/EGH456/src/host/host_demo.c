@@ -0,0 +1,671 @@
+//*****************************************************************************
+//
+// host_demo.c - A set of widget screens, laid out like the grlib_demo
+//               application's, for drawing on the host.
+//
+// Eight panels, the same kinds as grlib_demo's (text, primitives, canvases,
+// check boxes, containers, push buttons, radio buttons and sliders), above
+// a bar with "-", the panel name and "+".  They are stepped through as
+// pressing "+" would, with every widget pointed at the display under test,
+// so the band renderer is measured on what a widget application redraws
+// rather than on a single picture.
+//
+// The pictures are made here when the demo is started: a shaded button, a
+// lamp and a striped logo, all 4 BPP with a palette.  Nothing is taken from
+// another project.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "grlib/grlib.h"
+#include "grlib/widget.h"
+#include "grlib/canvas.h"
+#include "grlib/checkbox.h"
+#include "grlib/container.h"
+#include "grlib/pushbutton.h"
+#include "grlib/radiobutton.h"
+#include "grlib/slider.h"
+#include "host/host_demo.h"
+
+//*****************************************************************************
+//
+// The pictures: a header, sixteen palette entries and the pixels, two to a
+// byte.
+//
+//*****************************************************************************
+#define HOST_DEMO_IMAGE_BYTES(w, h)                                           \
+                                (5 + 1 + (16 * 3) + ((((w) + 1) / 2) * (h)))
+
+static uint8_t g_pui8HostDemoButton[HOST_DEMO_IMAGE_BYTES(50, 50)];
+static uint8_t g_pui8HostDemoButtonPress[HOST_DEMO_IMAGE_BYTES(50, 50)];
+static uint8_t g_pui8HostDemoLamp[HOST_DEMO_IMAGE_BYTES(20, 20)];
+static uint8_t g_pui8HostDemoLogo[HOST_DEMO_IMAGE_BYTES(96, 40)];
+
+//*****************************************************************************
+//
+// Forward declarations for the paint handlers and the panels.
+//
+//*****************************************************************************
+static void prvIntroPaint(tWidget *psWidget, tContext *psContext);
+static void prvPrimitivePaint(tWidget *psWidget, tContext *psContext);
+static void prvCanvasPaint(tWidget *psWidget, tContext *psContext);
+extern tCanvasWidget g_psHostDemoPanels[];
+
+//*****************************************************************************
+//
+// The first panel, a page of text.
+//
+//*****************************************************************************
+Canvas(g_sHostDemoIntro, g_psHostDemoPanels, 0, 0, 0, 0, 24, 320, 166,
+       CANVAS_STYLE_APP_DRAWN, 0, 0, 0, 0, 0, 0, prvIntroPaint);
+
+//*****************************************************************************
+//
+// The second panel, lines, circles, rectangles, strings and a picture.
+//
+//*****************************************************************************
+Canvas(g_sHostDemoPrimitives, g_psHostDemoPanels + 1, 0, 0, 0, 0, 24, 320,
+       166, CANVAS_STYLE_APP_DRAWN, 0, 0, 0, 0, 0, 0, prvPrimitivePaint);
+
+//*****************************************************************************
+//
+// The third panel, a canvas of each style.
+//
+//*****************************************************************************
+Canvas(g_sHostDemoCanvas3, g_psHostDemoPanels + 2, 0, 0, 0, 205, 27, 110,
+       158, CANVAS_STYLE_OUTLINE | CANVAS_STYLE_APP_DRAWN, 0, ClrGray, 0, 0,
+       0, 0, prvCanvasPaint);
+Canvas(g_sHostDemoCanvas2, g_psHostDemoPanels + 2, &g_sHostDemoCanvas3, 0, 0,
+       5, 109, 195, 76, CANVAS_STYLE_OUTLINE | CANVAS_STYLE_IMG, 0, ClrGray,
+       0, 0, 0, g_pui8HostDemoLogo, 0);
+Canvas(g_sHostDemoCanvas1, g_psHostDemoPanels + 2, &g_sHostDemoCanvas2, 0,
+       0, 5, 27, 195, 76,
+       CANVAS_STYLE_FILL | CANVAS_STYLE_OUTLINE | CANVAS_STYLE_TEXT,
+       ClrMidnightBlue, ClrGray, ClrSilver, &g_sFontCm22, "Text", 0, 0);
+
+//*****************************************************************************
+//
+// The fourth panel, check boxes with a lamp beside each.
+//
+//*****************************************************************************
+static tCanvasWidget g_psHostDemoCheckLamps[] =
+{
+    CanvasStruct(g_psHostDemoPanels + 3, g_psHostDemoCheckLamps + 1, 0, 0,
+                 245, 41, 20, 20, CANVAS_STYLE_IMG, 0, 0, 0, 0, 0,
+                 g_pui8HostDemoLamp, 0),
+    CanvasStruct(g_psHostDemoPanels + 3, g_psHostDemoCheckLamps + 2, 0, 0,
+                 245, 96, 20, 20, CANVAS_STYLE_IMG, 0, 0, 0, 0, 0,
+                 g_pui8HostDemoLamp, 0),
+    CanvasStruct(g_psHostDemoPanels + 3, 0, 0, 0,
+                 245, 145, 20, 20, CANVAS_STYLE_IMG, 0, 0, 0, 0, 0,
+                 g_pui8HostDemoLamp, 0)
+};
+static tCheckBoxWidget g_psHostDemoChecks[] =
+{
+    CheckBoxStruct(g_psHostDemoPanels + 3, g_psHostDemoChecks + 1, 0, 0,
+                   40, 30, 185, 42,
+                   CB_STYLE_OUTLINE | CB_STYLE_FILL | CB_STYLE_TEXT, 16,
+                   ClrMidnightBlue, ClrGray, ClrSilver, &g_sFontCm22,
+                   "Select", 0, 0),
+    CheckBoxStruct(g_psHostDemoPanels + 3, g_psHostDemoChecks + 2, 0, 0,
+                   40, 82, 185, 48, CB_STYLE_IMG | CB_STYLE_SELECTED, 16, 0,
+                   ClrGray, 0, 0, 0, g_pui8HostDemoLogo, 0),
+    CheckBoxStruct(g_psHostDemoPanels + 3, g_psHostDemoCheckLamps, 0, 0,
+                   40, 134, 189, 42, CB_STYLE_OUTLINE | CB_STYLE_TEXT, 16,
+                   0, ClrGray, ClrGreen, &g_sFontCm20, "Select", 0, 0)
+};
+
+//*****************************************************************************
+//
+// The fifth panel, containers.
+//
+//*****************************************************************************
+Container(g_sHostDemoContainer3, g_psHostDemoPanels + 4, 0, 0, 0,
+          210, 47, 105, 118, CTR_STYLE_OUTLINE | CTR_STYLE_FILL,
+          ClrMidnightBlue, ClrGray, 0, 0, 0);
+Container(g_sHostDemoContainer2, g_psHostDemoPanels + 4,
+          &g_sHostDemoContainer3, 0, 0, 5, 109, 200, 76,
+          (CTR_STYLE_OUTLINE | CTR_STYLE_FILL | CTR_STYLE_TEXT |
+           CTR_STYLE_TEXT_CENTER), ClrMidnightBlue, ClrGray, ClrSilver,
+          &g_sFontCm22, "Group2");
+Container(g_sHostDemoContainer1, g_psHostDemoPanels + 4,
+          &g_sHostDemoContainer2, 0, 0, 5, 27, 200, 76,
+          CTR_STYLE_OUTLINE | CTR_STYLE_FILL | CTR_STYLE_TEXT,
+          ClrMidnightBlue, ClrGray, ClrSilver, &g_sFontCm22, "Group1");
+
+//*****************************************************************************
+//
+// The sixth panel, push buttons of each shape with a lamp under each.
+//
+//*****************************************************************************
+static tCanvasWidget g_psHostDemoButtonLamps[] =
+{
+    CanvasStruct(g_psHostDemoPanels + 5, g_psHostDemoButtonLamps + 1, 0, 0,
+                 40, 85, 20, 20, CANVAS_STYLE_IMG, 0, 0, 0, 0, 0,
+                 g_pui8HostDemoLamp, 0),
+    CanvasStruct(g_psHostDemoPanels + 5, g_psHostDemoButtonLamps + 2, 0, 0,
+                 90, 85, 20, 20, CANVAS_STYLE_IMG, 0, 0, 0, 0, 0,
+                 g_pui8HostDemoLamp, 0),
+    CanvasStruct(g_psHostDemoPanels + 5, g_psHostDemoButtonLamps + 3, 0, 0,
+                 145, 85, 20, 20, CANVAS_STYLE_IMG, 0, 0, 0, 0, 0,
+                 g_pui8HostDemoLamp, 0),
+    CanvasStruct(g_psHostDemoPanels + 5, 0, 0, 0,
+                 190, 35, 110, 24, CANVAS_STYLE_TEXT, 0, 0, ClrSilver,
+                 &g_sFontCm20, "Buttons", 0, 0)
+};
+static tPushButtonWidget g_psHostDemoButtons[] =
+{
+    RectangularButtonStruct(g_psHostDemoPanels + 5, g_psHostDemoButtons + 1,
+                            0, 0, 30, 35, 40, 40,
+                            PB_STYLE_FILL | PB_STYLE_OUTLINE | PB_STYLE_TEXT,
+                            ClrMidnightBlue, ClrBlack, ClrGray, ClrSilver,
+                            &g_sFontCm22, "1", 0, 0, 0, 0, 0),
+    CircularButtonStruct(g_psHostDemoPanels + 5, g_psHostDemoButtons + 2, 0,
+                         0, 100, 55, 20,
+                         PB_STYLE_FILL | PB_STYLE_OUTLINE | PB_STYLE_TEXT,
+                         ClrMidnightBlue, ClrBlack, ClrGray, ClrSilver,
+                         &g_sFontCm22, "2", 0, 0, 0, 0, 0),
+    RectangularButtonStruct(g_psHostDemoPanels + 5, g_psHostDemoButtonLamps,
+                            0, 0, 130, 30, 50, 50,
+                            PB_STYLE_IMG | PB_STYLE_TEXT, 0, 0, 0, ClrSilver,
+                            &g_sFontCm22, "3", g_pui8HostDemoButton,
+                            g_pui8HostDemoButtonPress, 0, 0, 0)
+};
+
+//*****************************************************************************
+//
+// The seventh panel, two groups of radio buttons, one with text and one
+// with pictures.
+//
+//*****************************************************************************
+extern tContainerWidget g_psHostDemoRadioGroups[];
+static tRadioButtonWidget g_psHostDemoRadios1[] =
+{
+    RadioButtonStruct(g_psHostDemoRadioGroups, g_psHostDemoRadios1 + 1, 0, 0,
+                      10, 50, 80, 45, RB_STYLE_TEXT | RB_STYLE_SELECTED, 16,
+                      0, ClrSilver, ClrSilver, &g_sFontCm20, "One", 0, 0),
+    RadioButtonStruct(g_psHostDemoRadioGroups, g_psHostDemoRadios1 + 2, 0, 0,
+                      10, 95, 80, 45, RB_STYLE_TEXT, 16, 0, ClrSilver,
+                      ClrSilver, &g_sFontCm20, "Two", 0, 0),
+    RadioButtonStruct(g_psHostDemoRadioGroups, 0, 0, 0,
+                      10, 140, 80, 45, RB_STYLE_TEXT, 24, 0, ClrSilver,
+                      ClrSilver, &g_sFontCm20, "Three", 0, 0)
+};
+static tRadioButtonWidget g_psHostDemoRadios2[] =
+{
+    RadioButtonStruct(g_psHostDemoRadioGroups + 1, g_psHostDemoRadios2 + 1,
+                      0, 0, 175, 50, 130, 45, RB_STYLE_IMG, 16, 0,
+                      ClrSilver, 0, 0, 0, g_pui8HostDemoLogo, 0),
+    RadioButtonStruct(g_psHostDemoRadioGroups + 1, g_psHostDemoRadios2 + 2,
+                      0, 0, 175, 95, 130, 45,
+                      RB_STYLE_IMG | RB_STYLE_SELECTED, 24, 0, ClrSilver, 0,
+                      0, 0, g_pui8HostDemoLogo, 0),
+    RadioButtonStruct(g_psHostDemoRadioGroups + 1, 0, 0, 0,
+                      175, 140, 130, 45, RB_STYLE_IMG, 24, 0, ClrSilver, 0,
+                      0, 0, g_pui8HostDemoLogo, 0)
+};
+tContainerWidget g_psHostDemoRadioGroups[] =
+{
+    ContainerStruct(g_psHostDemoPanels + 6, g_psHostDemoRadioGroups + 1,
+                    g_psHostDemoRadios1, 0, 5, 27, 148, 160,
+                    CTR_STYLE_OUTLINE | CTR_STYLE_TEXT, 0, ClrGray,
+                    ClrSilver, &g_sFontCm20, "Group One"),
+    ContainerStruct(g_psHostDemoPanels + 6, 0, g_psHostDemoRadios2, 0,
+                    167, 27, 148, 160, CTR_STYLE_OUTLINE | CTR_STYLE_TEXT, 0,
+                    ClrGray, ClrSilver, &g_sFontCm20, "Group Two")
+};
+
+//*****************************************************************************
+//
+// The eighth panel, sliders across and up, with and without text.
+//
+//*****************************************************************************
+static tSliderWidget g_psHostDemoSliders[] =
+{
+    SliderStruct(g_psHostDemoPanels + 7, g_psHostDemoSliders + 1, 0, 0,
+                 5, 115, 220, 30, 0, 100, 25,
+                 (SL_STYLE_FILL | SL_STYLE_BACKG_FILL | SL_STYLE_OUTLINE |
+                  SL_STYLE_TEXT | SL_STYLE_BACKG_TEXT),
+                 ClrGray, ClrBlack, ClrSilver, ClrWhite, ClrWhite,
+                 &g_sFontCm20, "25%", 0, 0, 0),
+    SliderStruct(g_psHostDemoPanels + 7, g_psHostDemoSliders + 2, 0, 0,
+                 5, 155, 220, 25, 0, 100, 25,
+                 (SL_STYLE_FILL | SL_STYLE_BACKG_FILL | SL_STYLE_OUTLINE |
+                  SL_STYLE_TEXT),
+                 ClrWhite, ClrBlueViolet, ClrSilver, ClrBlack, 0,
+                 &g_sFontCm18, "Foreground Text Only", 0, 0, 0),
+    SliderStruct(g_psHostDemoPanels + 7, g_psHostDemoSliders + 3, 0, 0,
+                 240, 70, 26, 110, 0, 100, 50,
+                 (SL_STYLE_FILL | SL_STYLE_BACKG_FILL | SL_STYLE_VERTICAL |
+                  SL_STYLE_OUTLINE | SL_STYLE_LOCKED), ClrDarkGreen,
+                 ClrDarkRed, ClrSilver, 0, 0, 0, 0, 0, 0, 0),
+    SliderStruct(g_psHostDemoPanels + 7, g_psHostDemoSliders + 4, 0, 0,
+                 280, 30, 30, 150, 0, 100, 75,
+                 (SL_STYLE_FILL | SL_STYLE_BACKG_FILL | SL_STYLE_VERTICAL |
+                  SL_STYLE_OUTLINE), ClrOrange, ClrNavy, ClrSilver, 0, 0, 0,
+                 0, 0, 0, 0),
+    SliderStruct(g_psHostDemoPanels + 7, g_psHostDemoSliders + 5, 0, 0,
+                 5, 30, 195, 37, 0, 100, 50,
+                 SL_STYLE_IMG | SL_STYLE_BACKG_IMG, 0, 0, 0, 0, 0, 0, 0,
+                 g_pui8HostDemoButton, g_pui8HostDemoButtonPress, 0),
+    SliderStruct(g_psHostDemoPanels + 7, 0, 0, 0,
+                 5, 80, 220, 25, 0, 100, 50,
+                 (SL_STYLE_FILL | SL_STYLE_BACKG_FILL | SL_STYLE_TEXT |
+                  SL_STYLE_BACKG_TEXT | SL_STYLE_TEXT_OPAQUE |
+                  SL_STYLE_BACKG_TEXT_OPAQUE),
+                 ClrBlue, ClrYellow, ClrSilver, ClrYellow, ClrBlue,
+                 &g_sFontCm18, "Text in both areas", 0, 0, 0)
+};
+
+//*****************************************************************************
+//
+// One black canvas per panel, painted over the last panel before the
+// panel's own widgets.
+//
+//*****************************************************************************
+tCanvasWidget g_psHostDemoPanels[] =
+{
+    CanvasStruct(0, 0, &g_sHostDemoIntro, 0, 0, 24, 320, 166,
+                 CANVAS_STYLE_FILL, ClrBlack, 0, 0, 0, 0, 0, 0),
+    CanvasStruct(0, 0, &g_sHostDemoPrimitives, 0, 0, 24, 320, 166,
+                 CANVAS_STYLE_FILL, ClrBlack, 0, 0, 0, 0, 0, 0),
+    CanvasStruct(0, 0, &g_sHostDemoCanvas1, 0, 0, 24, 320, 166,
+                 CANVAS_STYLE_FILL, ClrBlack, 0, 0, 0, 0, 0, 0),
+    CanvasStruct(0, 0, g_psHostDemoChecks, 0, 0, 24, 320, 166,
+                 CANVAS_STYLE_FILL, ClrBlack, 0, 0, 0, 0, 0, 0),
+    CanvasStruct(0, 0, &g_sHostDemoContainer1, 0, 0, 24, 320, 166,
+                 CANVAS_STYLE_FILL, ClrBlack, 0, 0, 0, 0, 0, 0),
+    CanvasStruct(0, 0, g_psHostDemoButtons, 0, 0, 24, 320, 166,
+                 CANVAS_STYLE_FILL, ClrBlack, 0, 0, 0, 0, 0, 0),
+    CanvasStruct(0, 0, g_psHostDemoRadioGroups, 0, 0, 24, 320, 166,
+                 CANVAS_STYLE_FILL, ClrBlack, 0, 0, 0, 0, 0, 0),
+    CanvasStruct(0, 0, g_psHostDemoSliders, 0, 0, 24, 320, 166,
+                 CANVAS_STYLE_FILL, ClrBlack, 0, 0, 0, 0, 0, 0)
+};
+
+#define HOST_DEMO_PANELS        (sizeof(g_psHostDemoPanels) /                \
+                                 sizeof(g_psHostDemoPanels[0]))
+
+static const char * const g_ppcHostDemoNames[HOST_DEMO_PANELS] =
+{
+    "     Introduction     ",
+    "     Primitives     ",
+    "     Canvas     ",
+    "     Checkbox     ",
+    "     Container     ",
+    "     Push Buttons     ",
+    "     Radio Buttons     ",
+    "     Sliders     "
+};
+
+//*****************************************************************************
+//
+// The bar across the bottom of the screen.  "-" starts blank, as there is
+// no panel before the first.
+//
+//*****************************************************************************
+RectangularButton(g_sHostDemoPrevious, 0, 0, 0, 0, 0, 190, 50, 50,
+                  PB_STYLE_FILL, ClrBlack, ClrBlack, 0, ClrSilver,
+                  &g_sFontCm20, "-", g_pui8HostDemoButton,
+                  g_pui8HostDemoButtonPress, 0, 0, 0);
+
+Canvas(g_sHostDemoTitle, 0, 0, 0, 0, 50, 190, 220, 50,
+       CANVAS_STYLE_TEXT | CANVAS_STYLE_TEXT_OPAQUE, 0, 0, ClrSilver,
+       &g_sFontCm20, 0, 0, 0);
+
+RectangularButton(g_sHostDemoNext, 0, 0, 0, 0, 270, 190, 50, 50,
+                  PB_STYLE_IMG | PB_STYLE_TEXT, ClrBlack, ClrBlack, 0,
+                  ClrSilver, &g_sFontCm20, "+", g_pui8HostDemoButton,
+                  g_pui8HostDemoButtonPress, 0, 0, 0);
+
+//*****************************************************************************
+//
+// The panel on the screen, and the number of screens drawn since
+// HostDemoStart().
+//
+//*****************************************************************************
+static uint32_t g_ui32HostDemoPanel;
+static uint32_t g_ui32HostDemoScreen;
+
+//*****************************************************************************
+//
+// Paints the first panel.
+//
+//*****************************************************************************
+static void
+prvIntroPaint(tWidget *psWidget, tContext *psContext)
+{
+    (void)psWidget;
+
+    GrContextFontSet(psContext, &g_sFontCm18);
+    GrContextForegroundSet(psContext, ClrSilver);
+    GrStringDraw(psContext, "These panels are drawn once straight", -1,
+                 0, 32, 0);
+    GrStringDraw(psContext, "to the display and once through the", -1,
+                 0, 50, 0);
+    GrStringDraw(psContext, "band renderer, from the same start.", -1,
+                 0, 68, 0);
+    GrStringDraw(psContext, "Each panel uses a different part of the", -1,
+                 0, 92, 0);
+    GrStringDraw(psContext, "graphics library: text, lines, circles,", -1,
+                 0, 110, 0);
+    GrStringDraw(psContext, "rectangles, pictures and the widgets", -1,
+                 0, 128, 0);
+    GrStringDraw(psContext, "built from them.  Both ways must leave", -1,
+                 0, 146, 0);
+    GrStringDraw(psContext, "the same pixels on the panel.", -1, 0, 164, 0);
+}
+
+//*****************************************************************************
+//
+// Paints the second panel.
+//
+//*****************************************************************************
+static void
+prvPrimitivePaint(tWidget *psWidget, tContext *psContext)
+{
+    uint32_t ui32Idx;
+    tRectangle sRect;
+
+    (void)psWidget;
+
+    //
+    // A fan of lines from red to green, then from green to blue.
+    //
+    for(ui32Idx = 0; ui32Idx <= 8; ui32Idx++)
+    {
+        GrContextForegroundSet(psContext,
+                               (((((10 - ui32Idx) * 255) / 10) <<
+                                 ClrRedShift) |
+                                (((ui32Idx * 255) / 10) << ClrGreenShift)));
+        GrLineDraw(psContext, 115, 120, 5, 120 - (11 * ui32Idx));
+    }
+    for(ui32Idx = 1; ui32Idx <= 10; ui32Idx++)
+    {
+        GrContextForegroundSet(psContext,
+                               (((((10 - ui32Idx) * 255) / 10) <<
+                                 ClrGreenShift) |
+                                (((ui32Idx * 255) / 10) << ClrBlueShift)));
+        GrLineDraw(psContext, 115, 120, 5 + (ui32Idx * 11), 29);
+    }
+
+    //
+    // A filled circle under an outlined one.
+    //
+    GrContextForegroundSet(psContext, ClrBrown);
+    GrCircleFill(psContext, 185, 69, 40);
+    GrContextForegroundSet(psContext, ClrSkyBlue);
+    GrCircleDraw(psContext, 205, 99, 30);
+
+    //
+    // A filled rectangle under an outlined one.
+    //
+    GrContextForegroundSet(psContext, ClrSlateGray);
+    sRect.i16XMin = 20;
+    sRect.i16YMin = 100;
+    sRect.i16XMax = 75;
+    sRect.i16YMax = 160;
+    GrRectFill(psContext, &sRect);
+    GrContextForegroundSet(psContext, ClrSlateBlue);
+    sRect.i16XMin += 40;
+    sRect.i16YMin += 40;
+    sRect.i16XMax += 30;
+    sRect.i16YMax += 28;
+    GrRectDraw(psContext, &sRect);
+
+    //
+    // A word in fonts of increasing size, and a picture.
+    //
+    GrContextForegroundSet(psContext, ClrSilver);
+    GrContextFontSet(psContext, &g_sFontCm14);
+    GrStringDraw(psContext, "Strings", -1, 125, 110, 0);
+    GrContextFontSet(psContext, &g_sFontCm18);
+    GrStringDraw(psContext, "Strings", -1, 145, 124, 0);
+    GrContextFontSet(psContext, &g_sFontCm22);
+    GrStringDraw(psContext, "Strings", -1, 165, 142, 0);
+    GrContextFontSet(psContext, &g_sFontCm24);
+    GrStringDraw(psContext, "Strings", -1, 185, 162, 0);
+    GrImageDraw(psContext, g_pui8HostDemoLogo, 220, 30);
+}
+
+//*****************************************************************************
+//
+// Paints the application drawn canvas of the third panel.
+//
+//*****************************************************************************
+static void
+prvCanvasPaint(tWidget *psWidget, tContext *psContext)
+{
+    uint32_t ui32Idx;
+
+    (void)psWidget;
+
+    GrContextForegroundSet(psContext, ClrGoldenrod);
+    for(ui32Idx = 50; ui32Idx <= 180; ui32Idx += 10)
+    {
+        GrLineDraw(psContext, 210, ui32Idx, 310, 230 - ui32Idx);
+    }
+    GrContextFontSet(psContext, &g_sFontCm12);
+    GrStringDrawCentered(psContext, "App Drawn", -1, 260, 50, 1);
+}
+
+//*****************************************************************************
+//
+// Makes a 4 BPP picture whose pixel at (x, y) is pfnShade(x, y), from a
+// palette running from ui32From to ui32To.
+//
+//*****************************************************************************
+static void
+prvImageMake(uint8_t *pui8Image, uint32_t ui32Width, uint32_t ui32Height,
+             uint32_t ui32From, uint32_t ui32To,
+             uint32_t (*pfnShade)(uint32_t ui32X, uint32_t ui32Y))
+{
+    uint32_t ui32Idx, ui32Shift, ui32X, ui32Y;
+    uint8_t *pui8Pixels;
+
+    pui8Image[0] = IMAGE_FMT_4BPP_UNCOMP;
+    pui8Image[1] = ui32Width & 0xff;
+    pui8Image[2] = ui32Width >> 8;
+    pui8Image[3] = ui32Height & 0xff;
+    pui8Image[4] = ui32Height >> 8;
+    pui8Image[5] = 15;
+
+    //
+    // Palette entries are blue, green, red.
+    //
+    for(ui32Idx = 0; ui32Idx < 16; ui32Idx++)
+    {
+        for(ui32Shift = 0; ui32Shift < 24; ui32Shift += 8)
+        {
+            pui8Image[6 + (ui32Idx * 3) + (ui32Shift / 8)] =
+                ((((ui32From >> ui32Shift) & 0xff) * (15 - ui32Idx)) +
+                 (((ui32To >> ui32Shift) & 0xff) * ui32Idx)) / 15;
+        }
+    }
+
+    pui8Pixels = pui8Image + 6 + (16 * 3);
+    for(ui32Y = 0; ui32Y < ui32Height; ui32Y++)
+    {
+        for(ui32X = 0; ui32X < ui32Width; ui32X += 2)
+        {
+            *pui8Pixels++ = ((pfnShade(ui32X, ui32Y) & 15) << 4) |
+                            (pfnShade(ui32X + 1, ui32Y) & 15);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// The shades of the pictures: a button lit from the top with a dark rim, a
+// round lamp, and diagonal stripes.
+//
+//*****************************************************************************
+static uint32_t
+prvButtonShade(uint32_t ui32X, uint32_t ui32Y)
+{
+    if((ui32X < 2) || (ui32X > 47) || (ui32Y < 2) || (ui32Y > 47))
+    {
+        return(0);
+    }
+    return(15 - ((ui32Y * 12) / 50));
+}
+
+static uint32_t
+prvButtonPressShade(uint32_t ui32X, uint32_t ui32Y)
+{
+    if((ui32X < 2) || (ui32X > 47) || (ui32Y < 2) || (ui32Y > 47))
+    {
+        return(0);
+    }
+    return(3 + ((ui32Y * 12) / 50));
+}
+
+static uint32_t
+prvLampShade(uint32_t ui32X, uint32_t ui32Y)
+{
+    int32_t i32DX, i32DY, i32R2;
+
+    i32DX = (int32_t)ui32X - 10;
+    i32DY = (int32_t)ui32Y - 10;
+    i32R2 = (i32DX * i32DX) + (i32DY * i32DY);
+    if(i32R2 >= 100)
+    {
+        return(0);
+    }
+    return(15 - (i32R2 / 8));
+}
+
+static uint32_t
+prvLogoShade(uint32_t ui32X, uint32_t ui32Y)
+{
+    return(((ui32X + ui32Y) / 6) & 15);
+}
+
+//*****************************************************************************
+//
+// Points a widget, its children and the siblings after it at a display.
+//
+//*****************************************************************************
+static void
+prvDemoRetarget(tWidget *psWidget, const tDisplay *psDisplay)
+{
+    for(; psWidget; psWidget = psWidget->psNext)
+    {
+        psWidget->psDisplay = psDisplay;
+        prvDemoRetarget(psWidget->psChild, psDisplay);
+    }
+}
+
+//*****************************************************************************
+//
+//! Sets the demo up on its first screen, drawn on a display.
+//!
+//! \param psDisplay is the display to draw on.
+//!
+//! The widgets are put back on the first panel, whichever panel an earlier
+//! run got to.  Nothing is drawn until HostDemoNext().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HostDemoStart(const tDisplay *psDisplay)
+{
+    uint32_t ui32Panel;
+
+    prvImageMake(g_pui8HostDemoButton, 50, 50, ClrNavy, ClrDeepSkyBlue,
+                 prvButtonShade);
+    prvImageMake(g_pui8HostDemoButtonPress, 50, 50, ClrNavy, ClrDeepSkyBlue,
+                 prvButtonPressShade);
+    prvImageMake(g_pui8HostDemoLamp, 20, 20, ClrBlack, ClrYellow,
+                 prvLampShade);
+    prvImageMake(g_pui8HostDemoLogo, 96, 40, ClrDarkRed, ClrWhite,
+                 prvLogoShade);
+
+    if(g_sHostDemoPrevious.sBase.psParent == 0)
+    {
+        WidgetAdd(WIDGET_ROOT, (tWidget *)&g_sHostDemoPrevious);
+        WidgetAdd(WIDGET_ROOT, (tWidget *)&g_sHostDemoTitle);
+        WidgetAdd(WIDGET_ROOT, (tWidget *)&g_sHostDemoNext);
+    }
+    else
+    {
+        WidgetRemove((tWidget *)(g_psHostDemoPanels + g_ui32HostDemoPanel));
+    }
+    g_ui32HostDemoPanel = 0;
+    WidgetAdd(WIDGET_ROOT, (tWidget *)g_psHostDemoPanels);
+    CanvasTextSet(&g_sHostDemoTitle, g_ppcHostDemoNames[0]);
+
+    PushButtonImageOff(&g_sHostDemoPrevious);
+    PushButtonTextOff(&g_sHostDemoPrevious);
+    PushButtonFillOn(&g_sHostDemoPrevious);
+    PushButtonImageOn(&g_sHostDemoNext);
+    PushButtonTextOn(&g_sHostDemoNext);
+    PushButtonFillOff(&g_sHostDemoNext);
+
+    prvDemoRetarget(WIDGET_ROOT, psDisplay);
+    for(ui32Panel = 0; ui32Panel < HOST_DEMO_PANELS; ui32Panel++)
+    {
+        prvDemoRetarget((tWidget *)(g_psHostDemoPanels + ui32Panel),
+                        psDisplay);
+    }
+
+    g_ui32HostDemoScreen = 0;
+}
+
+//*****************************************************************************
+//
+//! Draws the demo's next screen.
+//!
+//! The first call draws the whole of the first screen; each after it moves
+//! to the next panel and draws what pressing "+" would redraw: the panel,
+//! its name, and "-" or "+" where one appears or goes.
+//!
+//! \return Returns \b false, drawing nothing, once every panel has been
+//! drawn.
+//
+//*****************************************************************************
+bool
+HostDemoNext(void)
+{
+    if(g_ui32HostDemoScreen == HOST_DEMO_PANELS)
+    {
+        return(false);
+    }
+
+    if(g_ui32HostDemoScreen == 0)
+    {
+        WidgetPaint(WIDGET_ROOT);
+    }
+    else
+    {
+        WidgetRemove((tWidget *)(g_psHostDemoPanels + g_ui32HostDemoPanel));
+        g_ui32HostDemoPanel++;
+        WidgetAdd(WIDGET_ROOT,
+                  (tWidget *)(g_psHostDemoPanels + g_ui32HostDemoPanel));
+        WidgetPaint((tWidget *)(g_psHostDemoPanels + g_ui32HostDemoPanel));
+        CanvasTextSet(&g_sHostDemoTitle,
+                      g_ppcHostDemoNames[g_ui32HostDemoPanel]);
+        WidgetPaint((tWidget *)&g_sHostDemoTitle);
+
+        if(g_ui32HostDemoPanel == 1)
+        {
+            PushButtonImageOn(&g_sHostDemoPrevious);
+            PushButtonTextOn(&g_sHostDemoPrevious);
+            PushButtonFillOff(&g_sHostDemoPrevious);
+            WidgetPaint((tWidget *)&g_sHostDemoPrevious);
+        }
+        if(g_ui32HostDemoPanel == (HOST_DEMO_PANELS - 1))
+        {
+            PushButtonImageOff(&g_sHostDemoNext);
+            PushButtonTextOff(&g_sHostDemoNext);
+            PushButtonFillOn(&g_sHostDemoNext);
+            WidgetPaint((tWidget *)&g_sHostDemoNext);
+        }
+    }
+    WidgetMessageQueueProcess();
+    g_ui32HostDemoScreen++;
+
+    return(true);
+}
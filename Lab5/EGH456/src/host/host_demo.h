@@ -0,0 +1,19 @@
+//*****************************************************************************
+//
+// host_demo.h - A set of widget screens, laid out like the grlib_demo
+//               application's, for drawing on the host.
+//
+//*****************************************************************************
+
+#ifndef __HOST_DEMO_H__
+#define __HOST_DEMO_H__
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void HostDemoStart(const tDisplay *psDisplay);
+extern bool HostDemoNext(void);
+
+#endif // __HOST_DEMO_H__
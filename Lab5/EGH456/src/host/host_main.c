@@ -0,0 +1,693 @@
+//*****************************************************************************
+//
+// host_main.c - Entry point of the native (host) build.
+//
+// Runs the display, light sensor, GPIO and DSP drivers against the simulated
+// peripherals of host/hal_host and prints what each one cost in register
+// accesses, interrupts and virtual cycles.  Light traces are replayed
+// through the sensor to check adaptive sampling against a fixed rate, and
+// one of them is recorded and replayed through the light processing to
+// check that replay is repeatable, and the waveform generator's output is
+// checked for purity.  Build and run with
+//
+//     pio run -e native -t exec
+//
+// or, to replay a trace recorded on the target (see trace_rec.h), with
+//
+//     .pio/build/native/program replay TRACE [-r] [-o OUT] [-g GOLDEN]
+//
+// Only the drivers listed in the native env's build_src_filter are built;
+// main.c and the FreeRTOS kernel are not.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "hal.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_ssi.h"
+#include "driverlib/gpio.h"
+#include "driverlib/i2c.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sysctl.h"
+#include "grlib/grlib.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+#include "drivers/adapt_rate.h"
+#include "drivers/band_render.h"
+#include "drivers/clock_scale.h"
+#include "drivers/dsp_q15.h"
+#include "drivers/gpio_fast.h"
+#include "drivers/Kentec320x240x16_ssd2119_spi.h"
+#include "drivers/light_pipe.h"
+#include "drivers/opt3001.h"
+#include "drivers/trace_rec.h"
+#include "drivers/ts_codec.h"
+#include "host/host_demo.h"
+#include "host/host_replay.h"
+#include "host/host_wave.h"
+
+#define HOST_SYSCLK             120000000
+#define HOST_OPT3001_ADDR       0x47
+
+//*****************************************************************************
+//
+// Globals main.c would provide.
+//
+//*****************************************************************************
+SemaphoreHandle_t xI2CSemaphore;
+extern void I2C0IntHandler(void);
+
+//
+// clock_scale.c is not built: the clock never changes here.
+//
+void
+ClockNotifierRegister(ClockNotifier_t *psNotifier)
+{
+    (void)psNotifier;
+}
+
+//*****************************************************************************
+//
+// Prints the cost of the phase just run and starts the next one.
+//
+//*****************************************************************************
+static uint64_t g_ui64HostPhaseStart;
+
+static void
+prvPhaseEnd(const char *pcTitle)
+{
+    uint64_t ui64Cycles;
+
+    HalSync();
+    ui64Cycles = HalCyclesGet() - g_ui64HostPhaseStart;
+    HalReportPrint(pcTitle);
+    printf("  %llu cycles, %llu us\n\n", (unsigned long long)ui64Cycles,
+           (unsigned long long)((ui64Cycles * 1000000) / HalClockGet()));
+    HalCountersReset();
+    g_ui64HostPhaseStart = HalCyclesGet();
+}
+
+//*****************************************************************************
+//
+// The display end of SSI3: an SSD2119 with its GRAM.  The controller takes a
+// command when DC (PP4) is low and data when it is high, as 16-bit words
+// sent either whole or as two bytes.  Writes to the RAM data register go to
+// the cursor, which then moves as the entry mode says, wrapping within the
+// window.
+//
+//*****************************************************************************
+#define HOST_LCD_WIDTH          320
+#define HOST_LCD_HEIGHT         240
+
+#define HOST_LCD_ENTRY_MODE     0x11
+#define HOST_LCD_RAM_DATA       0x22
+#define HOST_LCD_V_RAM_POS      0x44
+#define HOST_LCD_H_RAM_START    0x45
+#define HOST_LCD_H_RAM_END      0x46
+#define HOST_LCD_X_RAM_ADDR     0x4e
+#define HOST_LCD_Y_RAM_ADDR     0x4f
+
+typedef struct
+{
+    uint32_t ui32Commands;
+    uint32_t ui32Data;
+    uint32_t ui32Pixels;
+    bool bHalf;
+    uint16_t ui16Word;
+    uint8_t ui8Reg;
+    uint16_t pui16Regs[256];
+    uint16_t ui16X;
+    uint16_t ui16Y;
+    uint16_t ppui16Ram[HOST_LCD_HEIGHT][HOST_LCD_WIDTH];
+}
+HostLcd_t;
+
+static HostLcd_t g_sHostLcd;
+
+//
+// Moves one address counter on within its window, returning true when it
+// wraps.
+//
+static bool
+prvLcdCount(uint16_t *pui16Addr, uint16_t ui16Start, uint16_t ui16End,
+            bool bUp)
+{
+    if(*pui16Addr == (bUp ? ui16End : ui16Start))
+    {
+        *pui16Addr = bUp ? ui16Start : ui16End;
+        return(true);
+    }
+    *pui16Addr += bUp ? 1 : -1;
+    return(false);
+}
+
+static void
+prvLcdCursorStep(HostLcd_t *psLcd)
+{
+    uint16_t ui16Mode = psLcd->pui16Regs[HOST_LCD_ENTRY_MODE];
+    uint16_t ui16VPos = psLcd->pui16Regs[HOST_LCD_V_RAM_POS];
+    uint16_t ui16HStart = psLcd->pui16Regs[HOST_LCD_H_RAM_START];
+    uint16_t ui16HEnd = psLcd->pui16Regs[HOST_LCD_H_RAM_END];
+    bool bXUp = (ui16Mode & 0x10) != 0;
+    bool bYUp = (ui16Mode & 0x20) != 0;
+
+    if(ui16Mode & 0x08)
+    {
+        if(prvLcdCount(&psLcd->ui16Y, ui16VPos & 0xff, ui16VPos >> 8, bYUp))
+        {
+            prvLcdCount(&psLcd->ui16X, ui16HStart, ui16HEnd, bXUp);
+        }
+    }
+    else if(prvLcdCount(&psLcd->ui16X, ui16HStart, ui16HEnd, bXUp))
+    {
+        prvLcdCount(&psLcd->ui16Y, ui16VPos & 0xff, ui16VPos >> 8, bYUp);
+    }
+}
+
+static uint16_t
+prvLcdXfer(void *pvDev, uint16_t ui16Tx)
+{
+    HostLcd_t *psLcd = pvDev;
+    HalPeriph_t *psSsi = HalPeriphGet(SSI3_BASE);
+
+    //
+    // Bytes are paired into words.
+    //
+    if((HAL_REG(psSsi, SSI_O_CR0) & SSI_CR0_DSS_M) != 15)
+    {
+        psLcd->bHalf = !psLcd->bHalf;
+        if(psLcd->bHalf)
+        {
+            psLcd->ui16Word = ui16Tx << 8;
+            return(0);
+        }
+        ui16Tx = psLcd->ui16Word | (ui16Tx & 0xff);
+    }
+
+    if(!(HalGpioLevelGet(GPIO_PORTP_BASE) & GPIO_PIN_4))
+    {
+        psLcd->ui32Commands++;
+        psLcd->ui8Reg = (uint8_t)ui16Tx;
+        return(0);
+    }
+
+    psLcd->ui32Data++;
+    if(psLcd->ui8Reg == HOST_LCD_RAM_DATA)
+    {
+        psLcd->ui32Pixels++;
+        if((psLcd->ui16X < HOST_LCD_WIDTH) && (psLcd->ui16Y < HOST_LCD_HEIGHT))
+        {
+            psLcd->ppui16Ram[psLcd->ui16Y][psLcd->ui16X] = ui16Tx;
+        }
+        prvLcdCursorStep(psLcd);
+        return(0);
+    }
+
+    psLcd->pui16Regs[psLcd->ui8Reg] = ui16Tx;
+    if(psLcd->ui8Reg == HOST_LCD_X_RAM_ADDR)
+    {
+        psLcd->ui16X = ui16Tx;
+    }
+    else if(psLcd->ui8Reg == HOST_LCD_Y_RAM_ADDR)
+    {
+        psLcd->ui16Y = ui16Tx;
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Draws the demo screens (see host_demo.c) straight to the panel and
+// through a band renderer, from the same starting GRAM, and checks the panel
+// ends up the same and that each screen fitted the display list.
+//
+//*****************************************************************************
+static BandRender_t g_sHostBand;
+static uint16_t g_ppui16HostRam[HOST_LCD_HEIGHT][HOST_LCD_WIDTH];
+
+static const BandSink_t g_sHostBandSink =
+{
+    Kentec320x240x16_SSD2119WindowWrite,
+    Kentec320x240x16_SSD2119WindowWait,
+    0
+};
+
+static void
+prvBandCompare(void)
+{
+    static uint16_t ppui16Start[HOST_LCD_HEIGHT][HOST_LCD_WIDTH];
+    tContext sContext;
+    uint32_t ui32Pixels;
+
+    memcpy(ppui16Start, g_sHostLcd.ppui16Ram, sizeof(ppui16Start));
+
+    ui32Pixels = g_sHostLcd.ui32Pixels;
+    HostDemoStart(&g_sKentec320x240x16_SSD2119);
+    while(HostDemoNext())
+    {
+    }
+    prvPhaseEnd("demo screens, immediate");
+    printf("  %u pixels sent\n\n",
+           (unsigned)(g_sHostLcd.ui32Pixels - ui32Pixels));
+    memcpy(g_ppui16HostRam, g_sHostLcd.ppui16Ram, sizeof(g_ppui16HostRam));
+
+    memcpy(g_sHostLcd.ppui16Ram, ppui16Start, sizeof(ppui16Start));
+    ui32Pixels = g_sHostLcd.ui32Pixels;
+    BandRenderInit(&g_sHostBand, &g_sKentec320x240x16_SSD2119,
+                   &g_sHostBandSink);
+    GrContextInit(&sContext, &g_sHostBand.sDisplay);
+    HostDemoStart(&g_sHostBand.sDisplay);
+    while(HostDemoNext())
+    {
+        GrFlush(&sContext);
+    }
+    prvPhaseEnd("demo screens, band renderer");
+    printf("  %u pixels sent, panel %s\n",
+           (unsigned)(g_sHostLcd.ui32Pixels - ui32Pixels),
+           memcmp(g_ppui16HostRam, g_sHostLcd.ppui16Ram,
+                  sizeof(g_ppui16HostRam)) ? "MISMATCH" : "matches");
+    BandRenderStatsPrint(&g_sHostBand);
+
+    //
+    // A list too small for a screen sends the pixels drawn on both sides of
+    // each early flush twice, so the timing above is not the renderer's.
+    //
+    printf("  list %s\n\n",
+           (g_sHostBand.sStats.ui32EarlyFlushes ||
+            g_sHostBand.sStats.ui32ScanFrames) ?
+           "too small for the screens, FAIL" : "holds every screen");
+}
+
+//*****************************************************************************
+//
+// I2C2 on PN4/PN5, set up as main.c does.
+//
+//*****************************************************************************
+static void
+prvI2cInit(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_I2C2);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPION);
+    GPIOPinConfigure(GPIO_PN4_I2C2SDA);
+    GPIOPinConfigure(GPIO_PN5_I2C2SCL);
+    GPIOPinTypeI2C(GPIO_PORTN_BASE, GPIO_PIN_4);
+    GPIOPinTypeI2CSCL(GPIO_PORTN_BASE, GPIO_PIN_5);
+    I2CMasterInitExpClk(I2C2_BASE, HalClockGet(), false);
+    I2CMasterIntEnableEx(I2C2_BASE, I2C_MASTER_INT_DATA | I2C_MASTER_INT_STOP);
+    IntRegister(INT_I2C2, I2C0IntHandler);
+    IntEnable(INT_I2C2);
+    IntMasterEnable();
+
+    xI2CSemaphore = xSemaphoreCreateBinary();
+    xSemaphoreGive(xI2CSemaphore);
+}
+
+//*****************************************************************************
+//
+// Light traces replayed through the sensor to compare adaptive sampling
+// with a fixed 10 Hz.  Each trace runs for HOST_TRACE_MS and sets the level
+// every HOST_TRACE_STEP_MS; its events are the times of the changes that
+// sampling should catch.
+//
+//*****************************************************************************
+#define HOST_TRACE_MS           60000
+#define HOST_TRACE_STEP_MS      10
+#define HOST_TRACE_EVENTS       4
+
+//
+// As main.c reads the sensor.
+//
+#define HOST_FAST_MS            100
+#define HOST_SLOW_MS            800
+#define HOST_STEP_MS            700
+#define HOST_POLL_MS            10
+
+//
+// An event has been caught when a reading differs from the last one before
+// it by more than HOST_EVENT_PERCENT, and missed if none has within
+// HOST_EVENT_WINDOW_MS.
+//
+#define HOST_EVENT_PERCENT      20
+#define HOST_EVENT_WINDOW_MS    2000
+
+typedef struct
+{
+    const char *pcName;
+    uint32_t (*pfnLevel)(uint32_t ui32Ms);
+    uint32_t pui32Events[HOST_TRACE_EVENTS];
+    uint32_t ui32Events;
+}
+HostTrace_t;
+
+//
+// A still room: 300 lux and half a percent of sensor noise.
+//
+static uint32_t
+prvTraceSteady(uint32_t ui32Ms)
+{
+    return(30000 + ((ui32Ms * 2654435761u) >> 24) % 300 - 150);
+}
+
+//
+// Cloud passing: a ramp from 600 lux to 300 over 20 s and back.
+//
+static uint32_t
+prvTraceCloud(uint32_t ui32Ms)
+{
+    if(ui32Ms < 20000)
+    {
+        return(60000 - (30000 * ui32Ms) / 20000);
+    }
+    if(ui32Ms < 40000)
+    {
+        return(30000 + (30000 * (ui32Ms - 20000)) / 20000);
+    }
+    return(60000);
+}
+
+//
+// A lamp switched on in a dim room and off again, across LIGHT_MAX_LUX.
+//
+static uint32_t
+prvTraceLamp(uint32_t ui32Ms)
+{
+    return(((ui32Ms >= 15000) && (ui32Ms < 35000)) ? 40000 : 4000);
+}
+
+//
+// Someone walking past: 300 ms shadows down to 60 lux.
+//
+static uint32_t
+prvTraceShadow(uint32_t ui32Ms)
+{
+    if(((ui32Ms >= 12000) && (ui32Ms < 12300)) ||
+       ((ui32Ms >= 27050) && (ui32Ms < 27350)) ||
+       ((ui32Ms >= 44420) && (ui32Ms < 44720)))
+    {
+        return(6000);
+    }
+    return(30000);
+}
+
+static const HostTrace_t g_psHostTraces[] =
+{
+    { "steady", prvTraceSteady, { 0 }, 0 },
+    { "cloud", prvTraceCloud, { 0 }, 0 },
+    { "lamp", prvTraceLamp, { 15000, 35000 }, 2 },
+    { "shadow", prvTraceShadow, { 12000, 27050, 44420 }, 3 },
+};
+
+//*****************************************************************************
+//
+// Replays one trace, reading the sensor as main.c's ReadLight does, at the
+// fast rate throughout or with the rate controller choosing, and prints a
+// line of results.
+//
+//*****************************************************************************
+static void
+prvTraceReplay(HalOpt3001_t *psOpt, const HostTrace_t *psTrace,
+               bool bAdaptive)
+{
+    LightPipe_t sPipe;
+    LightSensorData_t sSample;
+    TickType_t xStart;
+    uint32_t ui32Now, ui32Release = 0, ui32Period, ui32Next, ui32Idx;
+    uint32_t ui32Bytes, ui32Wakes = 0, ui32Reads = 0, ui32Worst = 0;
+    uint32_t ui32Caught = 0, ui32SlowMs = 0;
+    float pfBefore[HOST_TRACE_EVENTS];
+    bool pbJudged[HOST_TRACE_EVENTS] = { false };
+    bool bOk;
+    uint16_t ui16Raw;
+    float fLux;
+
+    LightPipeInit(&sPipe, HOST_FAST_MS, HOST_SLOW_MS, HOST_STEP_MS);
+    HalOpt3001LuxSet(psOpt, psTrace->pfnLevel(0));
+    sensorOpt3001Init();
+    ui32Bytes = HalI2cBytesGet(I2C2_BASE);
+    xStart = xTaskGetTickCount();
+    ui32Period = HOST_FAST_MS;
+
+    while((ui32Release += ui32Period) < HOST_TRACE_MS)
+    {
+        while((ui32Now = xTaskGetTickCount() - xStart) < ui32Release)
+        {
+            HalOpt3001LuxSet(psOpt, psTrace->pfnLevel(ui32Now));
+            ui32Next = ui32Now - ui32Now % HOST_TRACE_STEP_MS +
+                       HOST_TRACE_STEP_MS;
+            vTaskDelay((ui32Next < ui32Release ? ui32Next : ui32Release) -
+                       ui32Now);
+        }
+
+        ui32Wakes++;
+        if(ui32Period > HOST_FAST_MS)
+        {
+            ui32SlowMs += ui32Period;
+        }
+        bOk = sensorOpt3001Read(&ui16Raw);
+        if(!bOk)
+        {
+            vTaskDelay(pdMS_TO_TICKS(HOST_POLL_MS));
+            bOk = sensorOpt3001Read(&ui16Raw);
+            if(bOk)
+            {
+                ui32Release = xTaskGetTickCount() - xStart;
+            }
+        }
+        if(!bOk)
+        {
+            continue;
+        }
+        ui32Reads++;
+        TraceRecord(TRACE_EV_LIGHT, ui16Raw);
+        LightPipeStep(&sPipe, ui16Raw, xTaskGetTickCount(), &sSample,
+                      &ui32Next);
+        fLux = sSample.lux_value;
+        ui32Now = xTaskGetTickCount() - xStart;
+
+        for(ui32Idx = 0; ui32Idx < psTrace->ui32Events; ui32Idx++)
+        {
+            uint32_t ui32At = psTrace->pui32Events[ui32Idx];
+            float fStep = fLux - pfBefore[ui32Idx];
+
+            if(pbJudged[ui32Idx])
+            {
+                continue;
+            }
+            if(ui32Now < ui32At)
+            {
+                pfBefore[ui32Idx] = fLux;
+            }
+            else if((fStep < 0 ? -fStep : fStep) * 100 >
+                    pfBefore[ui32Idx] * HOST_EVENT_PERCENT)
+            {
+                pbJudged[ui32Idx] = true;
+                ui32Caught++;
+                if(ui32Now - ui32At > ui32Worst)
+                {
+                    ui32Worst = ui32Now - ui32At;
+                }
+            }
+            else if(ui32Now >= ui32At + HOST_EVENT_WINDOW_MS)
+            {
+                pbJudged[ui32Idx] = true;
+            }
+        }
+
+        if(bAdaptive && (ui32Next != ui32Period))
+        {
+            sensorOpt3001ConversionTime(ui32Next >= HOST_SLOW_MS);
+            ui32Period = ui32Next;
+            ui32Release = xTaskGetTickCount() - xStart;
+        }
+    }
+
+    printf("%-8s %-9s %6u %6u %9u %5u%% %4u/%u %8u\n", psTrace->pcName,
+           bAdaptive ? "adaptive" : "10 Hz", (unsigned)ui32Wakes,
+           (unsigned)ui32Reads,
+           (unsigned)(HalI2cBytesGet(I2C2_BASE) - ui32Bytes),
+           (unsigned)((ui32SlowMs * 100) / HOST_TRACE_MS),
+           (unsigned)ui32Caught, (unsigned)psTrace->ui32Events,
+           (unsigned)ui32Worst);
+}
+
+//*****************************************************************************
+//
+// Replays every trace both ways.  Wakes are the releases of the reading
+// task, reads those that found a result, and slow the share of the time
+// spent above the fast rate.  The last two columns are the events caught
+// and the longest it took to catch one, in ms.
+//
+// The readings of the adaptive run of trace HOST_REPLAY_TRACE are recorded,
+// as ReadLight records them on the target, for prvTraceReplayCheck().
+//
+//*****************************************************************************
+#define HOST_REPLAY_TRACE       2
+
+static void
+prvAdaptReplay(HalOpt3001_t *psOpt)
+{
+    const TraceEvent_t *psEvents;
+    uint32_t ui32Idx;
+
+    printf("trace    sampling   wakes  reads I2C bytes  slow events  worst "
+           "ms\n");
+    for(ui32Idx = 0;
+        ui32Idx < sizeof(g_psHostTraces) / sizeof(g_psHostTraces[0]);
+        ui32Idx++)
+    {
+        prvTraceReplay(psOpt, &g_psHostTraces[ui32Idx], false);
+        if(ui32Idx == HOST_REPLAY_TRACE)
+        {
+            TraceRecStart();
+        }
+        prvTraceReplay(psOpt, &g_psHostTraces[ui32Idx], true);
+        if(ui32Idx == HOST_REPLAY_TRACE)
+        {
+            TraceRecGet(&psEvents);
+        }
+    }
+    printf("\n");
+}
+
+//*****************************************************************************
+//
+// Replays the recording made by prvAdaptReplay() through the light
+// processing and checks that its output hashes to HOST_REPLAY_GOLDEN, the
+// hash it had when the processing was last changed on purpose.  A change
+// that should leave the output alone must not move the hash; one that moves
+// it on purpose updates the constant.  The recording's ticks are the virtual
+// time of the phases run before it, so a change to those moves it too.
+//
+//*****************************************************************************
+#define HOST_REPLAY_GOLDEN      0xcf45bd5f
+
+static void
+prvTraceReplayCheck(void)
+{
+    const TraceEvent_t *psEvents;
+    uint32_t ui32Count, ui32Hash;
+
+    ui32Count = TraceRecGet(&psEvents);
+    printf("replaying %u events of trace %s\n", (unsigned)ui32Count,
+           g_psHostTraces[HOST_REPLAY_TRACE].pcName);
+    ui32Hash = HostReplayCheck(psEvents, ui32Count);
+    printf("replay: output hash %08x, golden %s\n\n", (unsigned)ui32Hash,
+           (ui32Hash == HOST_REPLAY_GOLDEN) ? "matches" : "DIFFERS");
+}
+
+int
+main(int argc, char **argv)
+{
+    static HalOpt3001_t sOpt;
+    tContext sContext;
+    tRectangle sRect;
+    uint16_t ui16Raw;
+    float fLux;
+    bool bOk;
+
+    //
+    // "replay" replays a trace recorded on the target instead.
+    //
+    if((argc > 1) && !strcmp(argv[1], "replay"))
+    {
+        return(HostReplayMain(argc - 2, argv + 2));
+    }
+
+    HalInit(HOST_SYSCLK);
+    HalSsiDeviceSet(SSI3_BASE, prvLcdXfer, &g_sHostLcd);
+    HalOpt3001Init(&sOpt, HOST_OPT3001_ADDR);
+    HalI2cDeviceAdd(I2C2_BASE, &sOpt.sI2c);
+
+    //
+    // Display: bring-up and one full screen fill.
+    //
+    Kentec320x240x16_SSD2119Init(HalClockGet());
+    prvPhaseEnd("display init");
+    printf("  %u commands, %u data frames\n\n",
+           (unsigned)g_sHostLcd.ui32Commands, (unsigned)g_sHostLcd.ui32Data);
+
+    GrContextInit(&sContext, &g_sKentec320x240x16_SSD2119);
+    GrContextForegroundSet(&sContext, ClrBlue);
+    sRect.i16XMin = 0;
+    sRect.i16YMin = 0;
+    sRect.i16XMax = GrContextDpyWidthGet(&sContext) - 1;
+    sRect.i16YMax = GrContextDpyHeightGet(&sContext) - 1;
+    GrRectFill(&sContext, &sRect);
+    prvPhaseEnd("display fill");
+    printf("  %u SSI3 frames in total\n\n", (unsigned)HalSsiFramesGet(SSI3_BASE));
+
+    //
+    // Display: the same screens drawn directly and through the band
+    // renderer.  Rasterizing into the bands takes no virtual time, so the
+    // band figures are the cost of the panel writes alone.
+    //
+    prvBandCompare();
+
+    //
+    // Light sensor: identify, start continuous conversions and read one.
+    //
+    prvI2cInit();
+    HalOpt3001LuxSet(&sOpt, 51200);
+    sensorOpt3001Init();
+    bOk = sensorOpt3001Test();
+    vTaskDelay(pdMS_TO_TICKS(110));
+    if(bOk && sensorOpt3001Read(&ui16Raw))
+    {
+        sensorOpt3001Convert(ui16Raw, &fLux);
+        printf("opt3001: %.2f lux\n", fLux);
+    }
+    else
+    {
+        printf("opt3001: no reading\n");
+    }
+    prvPhaseEnd("opt3001");
+    printf("  %u I2C2 bytes\n\n", (unsigned)HalI2cBytesGet(I2C2_BASE));
+
+    //
+    // Light sensor: the traces at a fixed rate and with adaptive sampling.
+    //
+    prvAdaptReplay(&sOpt);
+    prvPhaseEnd("adaptive sampling");
+
+    //
+    // One of those runs, recorded and replayed through the light processing.
+    //
+    prvTraceReplayCheck();
+    prvPhaseEnd("trace replay");
+
+    //
+    // The GPIO write paths.
+    //
+    vGpioFastBenchmark();
+    prvPhaseEnd("gpio fast");
+
+    //
+    // The Q15 kernels.  Computation takes no virtual time, so only the
+    // reference and DSP versions' outputs are compared; no row may report
+    // MISMATCH.
+    //
+    vDspBenchmark();
+    prvPhaseEnd("dsp");
+
+    //
+    // The sample codec, without its cycle columns for the same reason: the
+    // sizes, and that no row reports MISMATCH.
+    //
+    vTsCodecBenchmark();
+    prvPhaseEnd("ts codec");
+
+    //
+    // The waveform generator's duty sequences, checked for spectral purity
+    // and for steps at parameter changes.
+    //
+    HostWaveCheck();
+    prvPhaseEnd("wave gen");
+
+    return(0);
+}
@@ -0,0 +1,453 @@
+//*****************************************************************************
+//
+// host_replay.c - Replay of recorded inputs through the light processing.
+//
+// A trace recorded on the board with -DTRACE_RECORD (see trace_rec.c) is fed
+// through the same processing the board runs: each sensor reading through
+// LightPipeStep() and LightPipeLine() into the line the display task prints
+// for it, and each button press flips the toggle as the button object does.
+// Every output is written as a line of text, with the floats as their bits,
+// so that two runs can be compared to the bit with a plain file compare.
+// Run with
+//
+//     .pio/build/native/program replay TRACE [-r] [-o OUT] [-g GOLDEN]
+//
+// where TRACE is a console log holding a recording, -r paces the replay at
+// the recorded ticks rather than as fast as it will go, -o writes the output
+// to OUT, and -g compares it with GOLDEN, an output kept from before a
+// change.  The stopwatch object and the graph are not replayed, as they need
+// the kernel and the panel.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "drivers/adapt_rate.h"
+#include "drivers/light_pipe.h"
+#include "drivers/trace_rec.h"
+#include "host/host_replay.h"
+
+//*****************************************************************************
+//
+// As main.c reads the sensor.  The periods only choose what LightPipeStep()
+// reports; the replay follows the recorded ticks.
+//
+//*****************************************************************************
+#define HOST_REPLAY_FAST_MS     100
+#define HOST_REPLAY_SLOW_MS     800
+#define HOST_REPLAY_STEP_MS     700
+
+//*****************************************************************************
+//
+// The number of untimed runs HostReplayCheck() times the processing over.
+//
+//*****************************************************************************
+#define HOST_REPLAY_REPEAT      2000
+
+//*****************************************************************************
+//
+// Returns a monotonic time in ns.
+//
+//*****************************************************************************
+static uint64_t
+prvNsGet(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return(((uint64_t)sNow.tv_sec * 1000000000) + sNow.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Returns the FNV-1a hash of a buffer.
+//
+//*****************************************************************************
+static uint32_t
+prvHash(const char *pcBuf, size_t szLen)
+{
+    uint32_t ui32Hash = 2166136261u;
+
+    while(szLen--)
+    {
+        ui32Hash = (ui32Hash ^ (uint8_t)*pcBuf++) * 16777619u;
+    }
+    return(ui32Hash);
+}
+
+//*****************************************************************************
+//
+//! Reads a recording from a console log.
+//!
+//! \param psIn is the log.
+//! \param ppsEvents is set to the events, which the caller frees.
+//! \param pui32Count is set to the number of them.
+//!
+//! Lines other than those of a TraceRecDump() are skipped.  If the log holds
+//! more than one recording, the events of all of them are read.
+//!
+//! \return Returns \b true if the log held at least one event.
+//
+//*****************************************************************************
+bool
+HostReplayLoad(FILE *psIn, TraceEvent_t **ppsEvents, uint32_t *pui32Count)
+{
+    TraceEvent_t *psEvents = NULL, *psGrown;
+    uint32_t ui32Count = 0, ui32Size = 0, ui32Time, ui32Value;
+    char pcLine[128], cType;
+
+    while(fgets(pcLine, sizeof(pcLine), psIn))
+    {
+        if(sscanf(pcLine, "TR %u %c %x", &ui32Time, &cType, &ui32Value) != 3)
+        {
+            continue;
+        }
+        if(ui32Count == ui32Size)
+        {
+            ui32Size = ui32Size ? ui32Size * 2 : 256;
+            psGrown = realloc(psEvents, ui32Size * sizeof(TraceEvent_t));
+            if(!psGrown)
+            {
+                free(psEvents);
+                return(false);
+            }
+            psEvents = psGrown;
+        }
+        psEvents[ui32Count].ui32Time = ui32Time;
+        psEvents[ui32Count].ui32Type = (uint8_t)cType;
+        psEvents[ui32Count].ui32Value = ui32Value;
+        ui32Count++;
+    }
+
+    *ppsEvents = psEvents;
+    *pui32Count = ui32Count;
+    return(ui32Count != 0);
+}
+
+//*****************************************************************************
+//
+//! Replays a recording through the processing.
+//!
+//! \param psEvents are the events.
+//! \param ui32Count is the number of them.
+//! \param bRealTime waits out the time between events if \b true.
+//! \param psOut, if not NULL, is written a line for each event.
+//!
+//! \return Returns the number of sensor readings processed.
+//
+//*****************************************************************************
+uint32_t
+HostReplayRun(const TraceEvent_t *psEvents, uint32_t ui32Count,
+              bool bRealTime, FILE *psOut)
+{
+    LightPipe_t sPipe;
+    LightSensorData_t sSample;
+    struct timespec sWait;
+    uint32_t ui32Idx, ui32Events, ui32Period, ui32Samples = 0, ui32Bits;
+    uint32_t ui32FiltBits, ui32Gap;
+    int32_t pi32Parts[LIGHT_LINE_PARTS];
+    bool bToggle = false;
+    const TraceEvent_t *psEvent;
+
+    LightPipeInit(&sPipe, HOST_REPLAY_FAST_MS, HOST_REPLAY_SLOW_MS,
+                  HOST_REPLAY_STEP_MS);
+
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        psEvent = &psEvents[ui32Idx];
+
+        if(bRealTime && ui32Idx)
+        {
+            ui32Gap = psEvent->ui32Time - psEvents[ui32Idx - 1].ui32Time;
+            sWait.tv_sec = ui32Gap / 1000;
+            sWait.tv_nsec = (long)(ui32Gap % 1000) * 1000000;
+            nanosleep(&sWait, NULL);
+        }
+
+        switch(psEvent->ui32Type)
+        {
+            case TRACE_EV_LIGHT:
+            {
+                ui32Events = LightPipeStep(&sPipe,
+                                           (uint16_t)psEvent->ui32Value,
+                                           psEvent->ui32Time, &sSample,
+                                           &ui32Period);
+                ui32Samples++;
+                if(!psOut)
+                {
+                    break;
+                }
+
+                //
+                // The sample, and the line the display task prints for it.
+                //
+                memcpy(&ui32Bits, &sSample.lux_value, 4);
+                memcpy(&ui32FiltBits, &sSample.filtered_lux, 4);
+                LightPipeLine(&sSample, pi32Parts);
+                fprintf(psOut, "%u L %04x %08x %08x %x %u ",
+                        (unsigned)sSample.timestamp, sSample.raw_lux,
+                        (unsigned)ui32Bits, (unsigned)ui32FiltBits,
+                        (unsigned)ui32Events, (unsigned)ui32Period);
+                fprintf(psOut, LIGHT_LINE_FORMAT "\n",
+                        (int)pi32Parts[0], (int)pi32Parts[1],
+                        (int)pi32Parts[2], (int)pi32Parts[3]);
+                break;
+            }
+
+            case TRACE_EV_BUTTON:
+            {
+                bToggle = !bToggle;
+                if(psOut)
+                {
+                    fprintf(psOut, "%u B %x toggle %d\n",
+                            (unsigned)psEvent->ui32Time,
+                            (unsigned)psEvent->ui32Value, bToggle);
+                }
+                break;
+            }
+
+            case TRACE_EV_TOUCH:
+            {
+                if(psOut)
+                {
+                    fprintf(psOut, "%u T %u %d %d\n",
+                            (unsigned)psEvent->ui32Time,
+                            (unsigned)TRACE_TOUCH_MSG(psEvent->ui32Value),
+                            (int)TRACE_TOUCH_X(psEvent->ui32Value),
+                            (int)TRACE_TOUCH_Y(psEvent->ui32Value));
+                }
+                break;
+            }
+
+            default:
+            {
+                if(psOut)
+                {
+                    fprintf(psOut, "%u ? %x\n", (unsigned)psEvent->ui32Time,
+                            (unsigned)psEvent->ui32Value);
+                }
+                break;
+            }
+        }
+    }
+
+    return(ui32Samples);
+}
+
+//*****************************************************************************
+//
+// Replays a recording into a buffer, which the caller frees.
+//
+//*****************************************************************************
+static char *
+prvReplayToBuffer(const TraceEvent_t *psEvents, uint32_t ui32Count,
+                  bool bRealTime, size_t *pszLen)
+{
+    char *pcBuf = NULL;
+    FILE *psOut;
+
+    psOut = open_memstream(&pcBuf, pszLen);
+    if(!psOut)
+    {
+        return(NULL);
+    }
+    HostReplayRun(psEvents, ui32Count, bRealTime, psOut);
+    fclose(psOut);
+
+    return(pcBuf);
+}
+
+//*****************************************************************************
+//
+//! Checks that a replay is repeatable, and prints its throughput.
+//!
+//! \param psEvents are the events.
+//! \param ui32Count is the number of them.
+//!
+//! Replays twice and compares the outputs, then times HOST_REPLAY_REPEAT
+//! replays without output, which is the cost of the processing alone.
+//!
+//! \return Returns the hash of the output, which changes if any output
+//! does.
+//
+//*****************************************************************************
+uint32_t
+HostReplayCheck(const TraceEvent_t *psEvents, uint32_t ui32Count)
+{
+    char *pcFirst, *pcSecond;
+    size_t szFirst = 0, szSecond = 0;
+    uint32_t ui32Hash, ui32Run, ui32Samples = 0;
+    uint64_t ui64Ns;
+
+    pcFirst = prvReplayToBuffer(psEvents, ui32Count, false, &szFirst);
+    pcSecond = prvReplayToBuffer(psEvents, ui32Count, false, &szSecond);
+    printf("replay: %u events, %u bytes of output, repeatable: %s\n",
+           (unsigned)ui32Count, (unsigned)szFirst,
+           (pcFirst && pcSecond && (szFirst == szSecond) &&
+            !memcmp(pcFirst, pcSecond, szFirst)) ? "yes" : "NO");
+    ui32Hash = pcFirst ? prvHash(pcFirst, szFirst) : 0;
+    free(pcFirst);
+    free(pcSecond);
+
+    ui64Ns = prvNsGet();
+    for(ui32Run = 0; ui32Run < HOST_REPLAY_REPEAT; ui32Run++)
+    {
+        ui32Samples += HostReplayRun(psEvents, ui32Count, false, NULL);
+    }
+    ui64Ns = prvNsGet() - ui64Ns;
+    printf("replay: %u readings in %llu us, %llu readings/s\n",
+           (unsigned)ui32Samples, (unsigned long long)(ui64Ns / 1000),
+           (unsigned long long)(ui64Ns ? (ui32Samples * 1000000000ULL) /
+                                         ui64Ns : 0));
+
+    return(ui32Hash);
+}
+
+//*****************************************************************************
+//
+// Compares a replay's output with a golden one, printing the first line
+// that differs.
+//
+//*****************************************************************************
+static bool
+prvGoldenCompare(const char *pcOut, size_t szOut, FILE *psGolden)
+{
+    char pcLine[256];
+    const char *pcEnd;
+    size_t szLen;
+    uint32_t ui32Line = 1;
+
+    while(fgets(pcLine, sizeof(pcLine), psGolden))
+    {
+        pcEnd = memchr(pcOut, '\n', szOut);
+        szLen = pcEnd ? (size_t)(pcEnd - pcOut) + 1 : szOut;
+        if((szLen != strlen(pcLine)) || memcmp(pcOut, pcLine, szLen))
+        {
+            printf("golden: line %u differs\n  golden: %s  output: %.*s%s",
+                   (unsigned)ui32Line, pcLine, (int)szLen, pcOut,
+                   szLen ? "" : "(end)\n");
+            return(false);
+        }
+        pcOut += szLen;
+        szOut -= szLen;
+        ui32Line++;
+    }
+    if(szOut)
+    {
+        printf("golden: ends at line %u, output goes on\n",
+               (unsigned)ui32Line);
+        return(false);
+    }
+
+    printf("golden: %u lines match\n", (unsigned)(ui32Line - 1));
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Runs the replay command.
+//!
+//! \param argc is the number of arguments after "replay".
+//! \param argv are the arguments.
+//!
+//! \return Returns 0 if the replay ran and matched any golden output, 1 if
+//! it did not match or a file named by -o or -g could not be used, and 2 if
+//! there was no recording to replay.
+//
+//*****************************************************************************
+int
+HostReplayMain(int argc, char **argv)
+{
+    const char *pcTrace = NULL, *pcOut = NULL, *pcGolden = NULL;
+    TraceEvent_t *psEvents;
+    uint32_t ui32Count;
+    FILE *psFile;
+    char *pcBuf;
+    size_t szLen = 0;
+    bool bRealTime = false, bOk = true;
+    int iArg;
+
+    for(iArg = 0; iArg < argc; iArg++)
+    {
+        if(!strcmp(argv[iArg], "-r"))
+        {
+            bRealTime = true;
+        }
+        else if(!strcmp(argv[iArg], "-o") && (iArg + 1 < argc))
+        {
+            pcOut = argv[++iArg];
+        }
+        else if(!strcmp(argv[iArg], "-g") && (iArg + 1 < argc))
+        {
+            pcGolden = argv[++iArg];
+        }
+        else if(!pcTrace && (argv[iArg][0] != '-'))
+        {
+            pcTrace = argv[iArg];
+        }
+        else
+        {
+            pcTrace = NULL;
+            break;
+        }
+    }
+    if(!pcTrace)
+    {
+        fprintf(stderr, "usage: replay TRACE [-r] [-o OUT] [-g GOLDEN]\n");
+        return(2);
+    }
+
+    psFile = fopen(pcTrace, "r");
+    if(!psFile || !HostReplayLoad(psFile, &psEvents, &ui32Count))
+    {
+        fprintf(stderr, "replay: no recording in %s\n", pcTrace);
+        return(2);
+    }
+    fclose(psFile);
+
+    pcBuf = prvReplayToBuffer(psEvents, ui32Count, bRealTime, &szLen);
+    if(!pcBuf)
+    {
+        free(psEvents);
+        return(2);
+    }
+
+    if(pcOut)
+    {
+        psFile = fopen(pcOut, "w");
+        if(!psFile || (fwrite(pcBuf, 1, szLen, psFile) != szLen))
+        {
+            fprintf(stderr, "replay: cannot write %s\n", pcOut);
+            bOk = false;
+        }
+        if(psFile)
+        {
+            fclose(psFile);
+        }
+    }
+    if(pcGolden)
+    {
+        psFile = fopen(pcGolden, "r");
+        if(!psFile)
+        {
+            fprintf(stderr, "replay: cannot read %s\n", pcGolden);
+            bOk = false;
+        }
+        else
+        {
+            bOk = prvGoldenCompare(pcBuf, szLen, psFile) && bOk;
+            fclose(psFile);
+        }
+    }
+
+    printf("replay: output hash %08x\n", (unsigned)prvHash(pcBuf, szLen));
+    HostReplayCheck(psEvents, ui32Count);
+
+    free(pcBuf);
+    free(psEvents);
+    return(bOk ? 0 : 1);
+}
@@ -0,0 +1,24 @@
+//*****************************************************************************
+//
+// host_replay.h - Replay of recorded inputs through the light processing.
+//
+//*****************************************************************************
+
+#ifndef __HOST_REPLAY_H__
+#define __HOST_REPLAY_H__
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern bool HostReplayLoad(FILE *psIn, TraceEvent_t **ppsEvents,
+                           uint32_t *pui32Count);
+extern uint32_t HostReplayRun(const TraceEvent_t *psEvents,
+                              uint32_t ui32Count, bool bRealTime,
+                              FILE *psOut);
+extern uint32_t HostReplayCheck(const TraceEvent_t *psEvents,
+                                uint32_t ui32Count);
+extern int HostReplayMain(int argc, char **argv);
+
+#endif // __HOST_REPLAY_H__
@@ -0,0 +1,442 @@
+//*****************************************************************************
+//
+// host_wave.c - Spectral checks of the waveform generator's duty sequences.
+//
+// The pulse widths the generator plays are made by the DDS engine alone, so
+// they can be made here exactly as the target makes them, block by block
+// as its task fills them, and taken apart with a DFT.  The frequencies fall
+// on whole bins of the transform, so there is no leakage and no window is
+// needed: every bin but the fundamental's is distortion or noise, and the
+// figures are those of the sequence itself.
+//
+// - A sine is measured for its spurious free dynamic range, its harmonic
+//   distortion and its signal to noise and distortion, which should be
+//   within HOST_WAVE_SINAD_LOSS of the ideal set by rounding the widths
+//   to whole PWM clocks.
+// - A triangle should have odd harmonics only, each the square of its
+//   number down on the fundamental.
+// - A change of frequency and of amplitude at block boundaries should make
+//   no sample to sample step larger than the fastest of the waveforms
+//   makes anyway.
+// - Two channels started a quarter cycle apart and changed together should
+//   still be a quarter cycle apart after the change.
+//
+// The PWM is as the generator sets it up at 120 MHz.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include "drivers/wave_dds.h"
+#include "drivers/wave_gen.h"
+#include "host/host_wave.h"
+
+//*****************************************************************************
+//
+// The load the generator's blocks are made for at 120 MHz, with the PWM
+// clock at half the system clock: a period of 3000 PWM clocks, less one.
+//
+//*****************************************************************************
+#define HOST_WAVE_LOAD          (120000000 / 2 / WAVE_GEN_SAMPLE_HZ - 1)
+
+//*****************************************************************************
+//
+// The length of the transform, 0.2 s, and the bins the test frequencies
+// fall on, 5 Hz apart.
+//
+//*****************************************************************************
+#define HOST_WAVE_N             4000
+#define HOST_WAVE_BIN_HZ        (WAVE_GEN_SAMPLE_HZ / HOST_WAVE_N)
+#define HOST_WAVE_BIN_A         97
+#define HOST_WAVE_BIN_B         200
+
+//*****************************************************************************
+//
+// The number of blocks made in the step and quadrature runs.  Their
+// changes are made before block HOST_WAVE_CHANGE and the ones after it.
+//
+//*****************************************************************************
+#define HOST_WAVE_BLOCKS        48
+#define HOST_WAVE_CHANGE        8
+
+//*****************************************************************************
+//
+// Limits, in dB and degrees.
+//
+//*****************************************************************************
+#define HOST_WAVE_MIN_SFDR      80.0
+#define HOST_WAVE_SINAD_LOSS    1.5
+#define HOST_WAVE_HARM_ERR      0.1
+#define HOST_WAVE_EVEN_MAX      -90.0
+#define HOST_WAVE_PHASE_ERR     0.05
+
+//*****************************************************************************
+//
+// The tables, the sequences made from them and their spectra.
+//
+//*****************************************************************************
+static int16_t g_pi16HostSine[DDS_TABLE_LEN];
+static int16_t g_pi16HostTriangle[DDS_TABLE_LEN];
+static uint32_t g_ppui32HostWidth[WAVE_GEN_CHANNELS][HOST_WAVE_BLOCKS *
+                                                    WAVE_GEN_BLOCK];
+static double g_pdHostCos[HOST_WAVE_N];
+static double g_pdHostPower[(HOST_WAVE_N / 2) + 1];
+
+//*****************************************************************************
+//
+// Makes ui32Blocks blocks of every channel, as the generator's task does,
+// from block ui32First on.
+//
+//*****************************************************************************
+static void
+prvBlocksMake(DdsChannel_t *psChans, uint32_t ui32First,
+              uint32_t ui32Blocks)
+{
+    uint32_t ui32Block, ui32Chan;
+
+    for(ui32Block = ui32First; ui32Block < ui32First + ui32Blocks;
+        ui32Block++)
+    {
+        for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+        {
+            DdsFill(&psChans[ui32Chan],
+                    &g_ppui32HostWidth[ui32Chan][ui32Block * WAVE_GEN_BLOCK],
+                    WAVE_GEN_BLOCK, HOST_WAVE_LOAD);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Works out one bin of the transform of HOST_WAVE_N widths, less their
+// mean of half the load.
+//
+//*****************************************************************************
+static void
+prvBinGet(const uint32_t *pui32Width, uint32_t ui32Bin, double *pdRe,
+          double *pdIm)
+{
+    uint32_t ui32Idx, ui32Angle;
+    double dValue;
+
+    *pdRe = 0.0;
+    *pdIm = 0.0;
+    ui32Angle = 0;
+    for(ui32Idx = 0; ui32Idx < HOST_WAVE_N; ui32Idx++)
+    {
+        dValue = (double)pui32Width[ui32Idx] - ((HOST_WAVE_LOAD + 1) / 2);
+        *pdRe += dValue * g_pdHostCos[ui32Angle];
+        *pdIm -= dValue * g_pdHostCos[(ui32Angle + (3 * HOST_WAVE_N / 4)) %
+                                      HOST_WAVE_N];
+        ui32Angle = (ui32Angle + ui32Bin) % HOST_WAVE_N;
+    }
+}
+
+//*****************************************************************************
+//
+// Fills g_pdHostPower with the power in every bin but DC.
+//
+//*****************************************************************************
+static void
+prvSpectrumGet(const uint32_t *pui32Width)
+{
+    uint32_t ui32Bin;
+    double dRe, dIm;
+
+    g_pdHostPower[0] = 0.0;
+    for(ui32Bin = 1; ui32Bin <= HOST_WAVE_N / 2; ui32Bin++)
+    {
+        prvBinGet(pui32Width, ui32Bin, &dRe, &dIm);
+        g_pdHostPower[ui32Bin] = (dRe * dRe) + (dIm * dIm);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the bin harmonic ui32Harm of bin ui32Bin falls on, aliased.
+//
+//*****************************************************************************
+static uint32_t
+prvHarmonicBin(uint32_t ui32Bin, uint32_t ui32Harm)
+{
+    uint32_t ui32Alias;
+
+    ui32Alias = (ui32Bin * ui32Harm) % HOST_WAVE_N;
+    return((ui32Alias > HOST_WAVE_N / 2) ? (HOST_WAVE_N - ui32Alias) :
+                                           ui32Alias);
+}
+
+static double
+prvDb(double dRatio)
+{
+    return(10.0 * log10(dRatio));
+}
+
+//*****************************************************************************
+//
+// A full scale sine: its purity against the ideal from rounding the widths.
+//
+//*****************************************************************************
+static bool
+prvSineCheck(void)
+{
+    DdsChannel_t sChan;
+    uint32_t ui32Bin, ui32Harm;
+    double dSignal, dSpur, dHarm, dNoise, dPeak, dIdeal, dSfdr, dSinad;
+    bool bOk;
+
+    DdsChannelInit(&sChan, g_pi16HostSine, 0);
+    DdsChannelSet(&sChan, g_pi16HostSine,
+                  DdsStepGet(HOST_WAVE_BIN_A * HOST_WAVE_BIN_HZ * 1000,
+                             WAVE_GEN_SAMPLE_HZ), DDS_AMP_FULL);
+    sChan.ui32Amp = DDS_AMP_FULL;
+    DdsFill(&sChan, g_ppui32HostWidth[0], HOST_WAVE_N, HOST_WAVE_LOAD);
+    prvSpectrumGet(g_ppui32HostWidth[0]);
+
+    dSignal = g_pdHostPower[HOST_WAVE_BIN_A];
+    dSpur = 0.0;
+    dNoise = 0.0;
+    for(ui32Bin = 1; ui32Bin <= HOST_WAVE_N / 2; ui32Bin++)
+    {
+        if(ui32Bin == HOST_WAVE_BIN_A)
+        {
+            continue;
+        }
+        dNoise += g_pdHostPower[ui32Bin];
+        if(g_pdHostPower[ui32Bin] > dSpur)
+        {
+            dSpur = g_pdHostPower[ui32Bin];
+        }
+    }
+    dHarm = 0.0;
+    for(ui32Harm = 2; ui32Harm <= 10; ui32Harm++)
+    {
+        dHarm += g_pdHostPower[prvHarmonicBin(HOST_WAVE_BIN_A, ui32Harm)];
+    }
+
+    //
+    // Rounding to whole clocks adds noise of 1/12 clock squared against a
+    // signal of half the peak squared.
+    //
+    dPeak = (double)((HOST_WAVE_LOAD / 2) - 1);
+    dIdeal = prvDb((dPeak * dPeak / 2.0) * 12.0);
+    dSfdr = prvDb(dSignal / dSpur);
+    dSinad = prvDb(dSignal / dNoise);
+    bOk = (dSfdr >= HOST_WAVE_MIN_SFDR) &&
+          (dSinad >= dIdeal - HOST_WAVE_SINAD_LOSS);
+
+    printf("wave: sine %u Hz, load %u: SFDR %.1f dB, THD %.1f dB, "
+           "SINAD %.1f dB (ideal %.1f, limit %.1f) %s\n",
+           HOST_WAVE_BIN_A * HOST_WAVE_BIN_HZ, HOST_WAVE_LOAD, dSfdr,
+           prvDb(dHarm / dSignal), dSinad, dIdeal,
+           dIdeal - HOST_WAVE_SINAD_LOSS, bOk ? "ok" : "FAIL");
+
+    return(bOk);
+}
+
+//*****************************************************************************
+//
+// A full scale triangle: odd harmonics at 1/n^2, no even ones.
+//
+//*****************************************************************************
+static bool
+prvTriangleCheck(void)
+{
+    DdsChannel_t sChan;
+    uint32_t ui32Harm;
+    double dSignal, dLevel, dErr, dMaxErr, dEven;
+
+    DdsChannelInit(&sChan, g_pi16HostTriangle, 0);
+    DdsChannelSet(&sChan, g_pi16HostTriangle,
+                  DdsStepGet(HOST_WAVE_BIN_A * HOST_WAVE_BIN_HZ * 1000,
+                             WAVE_GEN_SAMPLE_HZ), DDS_AMP_FULL);
+    sChan.ui32Amp = DDS_AMP_FULL;
+    DdsFill(&sChan, g_ppui32HostWidth[0], HOST_WAVE_N, HOST_WAVE_LOAD);
+    prvSpectrumGet(g_ppui32HostWidth[0]);
+
+    dSignal = g_pdHostPower[HOST_WAVE_BIN_A];
+    dMaxErr = 0.0;
+    dEven = 0.0;
+    for(ui32Harm = 2; ui32Harm <= 9; ui32Harm++)
+    {
+        dLevel = g_pdHostPower[prvHarmonicBin(HOST_WAVE_BIN_A, ui32Harm)];
+        if(ui32Harm & 1)
+        {
+            dErr = fabs(prvDb(dLevel / dSignal) +
+                        prvDb((double)(ui32Harm * ui32Harm * ui32Harm *
+                                       ui32Harm)));
+            dMaxErr = (dErr > dMaxErr) ? dErr : dMaxErr;
+        }
+        else if(dLevel > dEven)
+        {
+            dEven = dLevel;
+        }
+    }
+
+    printf("wave: triangle %u Hz: odd harmonics within %.3f dB of 1/n^2, "
+           "even ones at %.1f dB %s\n",
+           HOST_WAVE_BIN_A * HOST_WAVE_BIN_HZ, dMaxErr,
+           prvDb(dEven / dSignal),
+           ((dMaxErr <= HOST_WAVE_HARM_ERR) &&
+            (prvDb(dEven / dSignal) <= HOST_WAVE_EVEN_MAX)) ? "ok" : "FAIL");
+
+    return((dMaxErr <= HOST_WAVE_HARM_ERR) &&
+           (prvDb(dEven / dSignal) <= HOST_WAVE_EVEN_MAX));
+}
+
+//*****************************************************************************
+//
+// Changes of frequency, then amplitude, then both at block boundaries: no
+// step larger than the fastest waveform's own.
+//
+//*****************************************************************************
+static bool
+prvStepCheck(void)
+{
+    DdsChannel_t psChans[WAVE_GEN_CHANNELS];
+    const uint32_t *pui32Width = g_ppui32HostWidth[0];
+    uint32_t ui32Idx, ui32Step, ui32Edge, ui32Inside;
+    double dBound;
+    bool bOk;
+
+    DdsChannelInit(&psChans[0], g_pi16HostSine, 0);
+    DdsChannelInit(&psChans[1], g_pi16HostSine, 0);
+    DdsChannelSet(&psChans[0], g_pi16HostSine,
+                  DdsStepGet(485000, WAVE_GEN_SAMPLE_HZ), DDS_AMP_FULL);
+    psChans[0].ui32Amp = DDS_AMP_FULL;
+    prvBlocksMake(psChans, 0, HOST_WAVE_CHANGE);
+
+    DdsChannelSet(&psChans[0], g_pi16HostSine,
+                  DdsStepGet(1234567, WAVE_GEN_SAMPLE_HZ), DDS_AMP_FULL);
+    prvBlocksMake(psChans, HOST_WAVE_CHANGE, HOST_WAVE_CHANGE);
+
+    DdsChannelSet(&psChans[0], g_pi16HostSine,
+                  DdsStepGet(1234567, WAVE_GEN_SAMPLE_HZ),
+                  DDS_AMP_FULL / 4);
+    prvBlocksMake(psChans, 2 * HOST_WAVE_CHANGE, HOST_WAVE_CHANGE);
+
+    DdsChannelSet(&psChans[0], g_pi16HostSine,
+                  DdsStepGet(333000, WAVE_GEN_SAMPLE_HZ), DDS_AMP_FULL);
+    prvBlocksMake(psChans, 3 * HOST_WAVE_CHANGE,
+                  HOST_WAVE_BLOCKS - (3 * HOST_WAVE_CHANGE));
+
+    //
+    // The largest step, at the block boundaries and inside the blocks.
+    //
+    ui32Edge = 0;
+    ui32Inside = 0;
+    for(ui32Idx = 1; ui32Idx < HOST_WAVE_BLOCKS * WAVE_GEN_BLOCK; ui32Idx++)
+    {
+        ui32Step = (pui32Width[ui32Idx] > pui32Width[ui32Idx - 1]) ?
+                   (pui32Width[ui32Idx] - pui32Width[ui32Idx - 1]) :
+                   (pui32Width[ui32Idx - 1] - pui32Width[ui32Idx]);
+        if((ui32Idx % WAVE_GEN_BLOCK) == 0)
+        {
+            ui32Edge = (ui32Step > ui32Edge) ? ui32Step : ui32Edge;
+        }
+        else
+        {
+            ui32Inside = (ui32Step > ui32Inside) ? ui32Step : ui32Inside;
+        }
+    }
+
+    //
+    // The steepest a full scale sine at 1234.567 Hz gets, plus a clock for
+    // the rounding.
+    //
+    dBound = (2.0 * 3.14159265 * 1234.567 / WAVE_GEN_SAMPLE_HZ) *
+             ((HOST_WAVE_LOAD / 2) - 1) + 1.0;
+    bOk = (ui32Edge <= dBound) && (ui32Inside <= dBound);
+
+    printf("wave: changes at block boundaries: largest step %u clocks at a "
+           "boundary, %u inside, bound %.0f %s\n", ui32Edge, ui32Inside,
+           dBound, bOk ? "ok" : "FAIL");
+
+    return(bOk);
+}
+
+//*****************************************************************************
+//
+// Two channels a quarter cycle apart, both changed at the same block: the
+// phase between them after the change.
+//
+//*****************************************************************************
+static bool
+prvQuadratureCheck(void)
+{
+    DdsChannel_t psChans[WAVE_GEN_CHANNELS];
+    uint32_t ui32Chan, ui32Start;
+    double pdPhase[WAVE_GEN_CHANNELS], dRe, dIm, dDiff;
+    bool bOk;
+
+    for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+    {
+        DdsChannelInit(&psChans[ui32Chan], g_pi16HostSine,
+                       ui32Chan * 0x40000000);
+        DdsChannelSet(&psChans[ui32Chan], g_pi16HostSine,
+                      DdsStepGet(HOST_WAVE_BIN_A * HOST_WAVE_BIN_HZ * 1000,
+                                 WAVE_GEN_SAMPLE_HZ), DDS_AMP_FULL / 2);
+    }
+    prvBlocksMake(psChans, 0, HOST_WAVE_CHANGE);
+
+    for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+    {
+        DdsChannelSet(&psChans[ui32Chan], g_pi16HostSine,
+                      DdsStepGet(HOST_WAVE_BIN_B * HOST_WAVE_BIN_HZ * 1000,
+                                 WAVE_GEN_SAMPLE_HZ), DDS_AMP_FULL);
+    }
+    prvBlocksMake(psChans, HOST_WAVE_CHANGE,
+                  HOST_WAVE_BLOCKS - HOST_WAVE_CHANGE);
+
+    //
+    // The transform starts past the block the amplitude ramps over.
+    //
+    ui32Start = (HOST_WAVE_CHANGE + 1) * WAVE_GEN_BLOCK;
+    for(ui32Chan = 0; ui32Chan < WAVE_GEN_CHANNELS; ui32Chan++)
+    {
+        prvBinGet(&g_ppui32HostWidth[ui32Chan][ui32Start], HOST_WAVE_BIN_B,
+                  &dRe, &dIm);
+        pdPhase[ui32Chan] = atan2(dIm, dRe) * 180.0 / 3.14159265358979;
+    }
+    dDiff = fmod(pdPhase[1] - pdPhase[0] + 360.0, 360.0);
+    bOk = fabs(dDiff - 90.0) <= HOST_WAVE_PHASE_ERR;
+
+    printf("wave: quadrature pair changed to %u Hz together: %.3f degrees "
+           "apart %s\n", HOST_WAVE_BIN_B * HOST_WAVE_BIN_HZ, dDiff,
+           bOk ? "ok" : "FAIL");
+
+    return(bOk);
+}
+
+//*****************************************************************************
+//
+//! Runs the checks on the waveform generator's duty sequences, printing a
+//! line for each.
+//!
+//! \return Returns \b true if they all pass.
+//
+//*****************************************************************************
+bool
+HostWaveCheck(void)
+{
+    uint32_t ui32Idx;
+    bool bOk;
+
+    DdsTableSine(g_pi16HostSine);
+    DdsTableTriangle(g_pi16HostTriangle);
+    for(ui32Idx = 0; ui32Idx < HOST_WAVE_N; ui32Idx++)
+    {
+        g_pdHostCos[ui32Idx] = cos(2.0 * 3.14159265358979 * ui32Idx /
+                                   HOST_WAVE_N);
+    }
+
+    bOk = prvSineCheck();
+    bOk = prvTriangleCheck() && bOk;
+    bOk = prvStepCheck() && bOk;
+    bOk = prvQuadratureCheck() && bOk;
+    printf("\n");
+
+    return(bOk);
+}
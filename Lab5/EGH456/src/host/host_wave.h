@@ -0,0 +1,17 @@
+//*****************************************************************************
+//
+// host_wave.h - Spectral checks of the waveform generator's duty sequences.
+//
+//*****************************************************************************
+
+#ifndef __HOST_WAVE_H__
+#define __HOST_WAVE_H__
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern bool HostWaveCheck(void);
+
+#endif // __HOST_WAVE_H__
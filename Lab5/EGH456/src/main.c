@@ -89,30 +89,56 @@
 #include "canvas.h"
 
 #include "drivers/Kentec320x240x16_ssd2119_spi.h"
+#include "drivers/band_render.h"
 #include "drivers/touch.h"
+#include "drivers/dma_memcpy.h"
+#include "drivers/can_transport.h"
+#include "drivers/can_vbus.h"
+#include "driverlib/emac.h"
+#include "drivers/net_udp.h"
+#include "drivers/emac_model.h"
+#include "drivers/clock_scale.h"
+#include "drivers/boot_profile.h"
+#include "drivers/gpio_fast.h"
+#include "drivers/led_fx.h"
+#include "drivers/dsp_q15.h"
+#include "drivers/stack_profile.h"
+#include "drivers/stack_guard.h"
+#include "drivers/defer.h"
+#include "drivers/periodic.h"
+#include "drivers/active.h"
+#include "drivers/seq_channel.h"
+#include "drivers/adapt_rate.h"
+#include "drivers/ts_codec.h"
+#include "drivers/light_pipe.h"
+#include "drivers/trace_rec.h"
+#include "drivers/wave_dds.h"
+#include "drivers/wave_gen.h"
+#include "drivers/opt3001.h"
+#include "task_stacks.h"
 
 /*-----------------------------------------------------------*/
-#define MAX_LUX 100
-#define MIN_LUX 5
-#define FILTER_WINDOW 10
 #define MAX_DATA_POINTS 100
 #define MAX_RANGE 100
+#define SENSOR_POLL_MS 10
+#define SENSOR_PERIOD_MS 100
+#define SENSOR_SLOW_PERIOD_MS 800
+#define SENSOR_PERIOD_STEP_MS 700
 
 #define VENT_HIGH_THRESHOLD (1UL << 0UL)
 #define VENT_LOW_THRESHOLD (1UL << 1UL) 
 #define EVENT_BTN_TOGGLE (1UL << 2UL)
 
+/* Signals of the button object. */
+#define SIG_BUTTONS (AO_SIG_USER)
+
 /* The system clock frequency. */
-volatile float g_lux = 0.0f;
-volatile bool g_luxUpdated = false;
 uint32_t g_ui32SysClock;
 
 EventGroupHandle_t xEventGroup;
 
 
-SemaphoreHandle_t g_xLightSensorSemaphore;
 SemaphoreHandle_t g_xDataSemaphore;
-SemaphoreHandle_t g_xButtonSemaphore;
 SemaphoreHandle_t printing;
 SemaphoreHandle_t xI2CSemaphore = NULL;
 
@@ -130,6 +156,16 @@ static int g_iGraphData[MAX_DATA_POINTS];
 static int g_iDataLength = 0;
 tContext ctx;
 
+/* The graph is drawn into a band renderer and reaches the panel a band at a
+ * time on GrFlush(), by uDMA, so the clear before each redraw is never seen
+ * and only the pixels drawn are sent. */
+static BandRender_t g_sBandRender;
+static const BandSink_t g_sBandSink = {
+    Kentec320x240x16_SSD2119WindowWrite,
+    Kentec320x240x16_SSD2119WindowWait,
+    0
+};
+
 /* Set up the hardware ready to run this demo. */
 static void prvSetupHardware( void );
 
@@ -139,25 +175,42 @@ static void prvConfigureUART(void);
 
 /* API to start the queue task. */
 extern void vQueueTask( void );
-QueueHandle_t g_xLightSensorQueue;
+static TaskHandle_t g_xDisplayTask;
 static void ReadLight(void *pvParameters);
 extern void I2C0IntHandler(void);
-static void ConfigureTimers(void);
-static void buttonTask(void *prvParameters);
-void Timer3AIntHandler(void);
+static uint32_t prvButtonsIdle(Active_t *psAo, const AoEvent_t *psEvent);
+static void prvButtonDeferred(void *pvArg, uint32_t ui32Buttons);
 static void DisplayLight(void *pvParameters);
+#ifdef RUN_BENCHMARKS
+static void prvBenchmarkTask(void *pvParameters);
+#endif
 /*-----------------------------------------------------------*/
 
-typedef struct {
-    uint16_t raw_lux;         
-    float lux_value;         
-    float filtered_lux;       
-    TickType_t timestamp;     
-} LightSensorData_t;
+/* The latest sample, written by the sensor task.  The display only wants the
+ * newest one and is notified when there is one, so it never works through a
+ * backlog. */
+static SEQ_CHANNEL(g_sLightLatest, LightSensorData_t);
 
 
 static void prvDisplayTask( void *params );
 
+/* The button handling and the stopwatch are active objects sharing one
+ * worker task, in place of a task each. */
+extern void vStopwatchStart(AoWorker_t *psWorker);
+extern void vStopwatchButtons(uint32_t ui32Buttons);
+
+static const AoState_t g_sButtonsIdle = { "idle", NULL, prvButtonsIdle };
+static Active_t g_sButtonAo = { "buttons", &g_sButtonsIdle };
+static AoWorker_t g_sUiWorker = { "AoUI" };
+
+/* Presses that arrive before the button object has handled the last one
+ * are merged into it, as the binary semaphore used to do, so a bouncing
+ * switch does not flip the toggle for every edge.  The deferred source
+ * merges the edges before its handler runs, and the handler ORs them into
+ * g_ui32ButtonsPending, posting only when no press is queued. */
+static DeferSource_t g_sButtonDefer = { "buttons", prvButtonDeferred, NULL };
+static uint32_t g_ui32ButtonsPending;
+
 void xButtonHandler(void){
     BaseType_t xButtonTask = pdFALSE;
     uint32_t ui32Status;
@@ -165,21 +218,20 @@ void xButtonHandler(void){
     ui32Status = GPIOIntStatus(BUTTONS_GPIO_BASE, true);
 
     GPIOIntClear(BUTTONS_GPIO_BASE, ui32Status);
-    if ((ui32Status & USR_SW1) || (ui32Status & USR_SW2)) {
-        xSemaphoreGiveFromISR(g_xButtonSemaphore, &xButtonTask);
+    if (ui32Status & (USR_SW1 | USR_SW2)) {
+        DeferSourcePostFromISR(&g_sButtonDefer,
+                               ui32Status & (USR_SW1 | USR_SW2), &xButtonTask);
     }
     portYIELD_FROM_ISR(xButtonTask);
 }
 
-void drawGraphCanvas(GraphCanvas *canvas) {
+/* Draws the outline and axes of the graph, without clearing it first. */
+void drawGraphAxes(GraphCanvas *canvas) {
     tRectangle graphBounds;
     graphBounds.i16XMax = canvas->x + canvas->width -1;
     graphBounds.i16XMin = canvas->x;
     graphBounds.i16YMax = canvas->y + canvas->height-1;
     graphBounds.i16YMin = canvas->y;
-    GrContextForegroundSet(&ctx, canvas->fillColor);
-    GrRectFill(&ctx, &graphBounds);
-
     GrContextForegroundSet(&ctx, canvas->outlineColor);
     GrRectDraw(&ctx, &graphBounds);
 
@@ -190,6 +242,21 @@ void drawGraphCanvas(GraphCanvas *canvas) {
 
     GrLineDraw(&ctx, xMin, yMax, xMax, yMax);
     GrLineDraw(&ctx, xMin, yMax, xMin, yMin);
+}
+
+void drawGraphCanvas(GraphCanvas *canvas) {
+    tRectangle graphBounds;
+    graphBounds.i16XMax = canvas->x + canvas->width -1;
+    graphBounds.i16XMin = canvas->x;
+    graphBounds.i16YMax = canvas->y + canvas->height-1;
+    graphBounds.i16YMin = canvas->y;
+    GrContextForegroundSet(&ctx, canvas->fillColor);
+    GrRectFill(&ctx, &graphBounds);
+
+    drawGraphAxes(canvas);
+
+    int xMin = canvas->x;
+    int yMax = canvas->y + canvas->height - 1;
 
     int scalingFactorX = canvas->width / MAX_DATA_POINTS;
     int scalingFactorY = canvas->height / MAX_RANGE;
@@ -235,19 +302,48 @@ static void prvConfigureButton(void){
     IntMasterEnable();
 }
 
+/* Follows system clock changes for the peripherals configured here.  UART0
+ * runs from the PIOSC and needs nothing.
+ *
+ * The OPT3001's bus is held from before the change until I2C2 has been
+ * reprogrammed, so that no transaction has its bit rate changed part way
+ * through.  The I2C interrupt gives xI2CSemaphore back after every byte as
+ * well as at the end, so taking it can land between two bytes; while the
+ * bus is busy it is handed back to the task running the transaction and
+ * taken again a tick later. */
+static void prvClockPre(uint32_t ui32NewHz, void *pvArg)
+{
+    (void)ui32NewHz;
+    (void)pvArg;
+
+    for (;;) {
+        xSemaphoreTake(xI2CSemaphore, portMAX_DELAY);
+        if (!I2CMasterBusBusy(I2C2_BASE)) {
+            break;
+        }
+        xSemaphoreGive(xI2CSemaphore);
+        vTaskDelay(1);
+    }
+}
+
+static void prvClockPost(uint32_t ui32NewHz, void *pvArg)
+{
+    (void)pvArg;
+
+    g_ui32SysClock = ui32NewHz;
+    I2CMasterInitExpClk(I2C2_BASE, ui32NewHz, false);
+    xSemaphoreGive(xI2CSemaphore);
+}
+
+static ClockNotifier_t g_sClockNotifier = { prvClockPre, prvClockPost, NULL, NULL };
+
 void vCreateLEDTask(void)
 {
-    /* 1) Set system clock to 120 MHz */
-    g_ui32SysClock = SysCtlClockFreqSet(
-        SYSCTL_XTAL_25MHZ |
-        SYSCTL_OSC_MAIN   |
-        SYSCTL_USE_PLL    |
-        SYSCTL_CFG_VCO_480,
-        120000000
-    );
+    /* 1) The system clock is already set, once, by prvSetupHardware() */
     
-    /* 2) Configure UART for debug output */
-    UARTprintf("Initializing system...\n");
+    /* 2) UART is configured for debug output.  Nothing is printed until
+     *    the first frame is up: at 9600 baud every character past the FIFO
+     *    would hold up the boot for a millisecond. */
     
     /* 3) Set interrupt priority grouping */
     IntPriorityGroupingSet(3);
@@ -257,6 +353,13 @@ void vCreateLEDTask(void)
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPION);
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_I2C2));
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPION));
+    /* Button presses go through the deferred work task to the button
+     * object; start both before the interrupt is enabled. */
+    DeferInit();
+    DeferSourceRegister(&g_sButtonDefer);
+    AoStart(&g_sButtonAo, &g_sUiWorker);
+    vStopwatchStart(&g_sUiWorker);
+    AoWorkerStart(&g_sUiWorker, TASK_STACK_AO_UI, tskIDLE_PRIORITY + 2);
     prvConfigureButton();
     /* 5) Configure PN4 = SDA, PN5 = SCL */
     GPIOPinConfigure(GPIO_PN4_I2C2SDA);   // mux PN4 to I2C2 SDA
@@ -281,6 +384,7 @@ void vCreateLEDTask(void)
     
     /* 9) Globally enable interrupts */
     IntMasterEnable();
+    ClockNotifierRegister(&g_sClockNotifier);
     
     /* 10) Enable GPIOJ for buttons PJ0 & PJ1 */
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOJ);
@@ -298,86 +402,185 @@ void vCreateLEDTask(void)
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOF));
     GPIOPinTypeGPIOOutput(GPIO_PORTN_BASE, GPIO_PIN_0 | GPIO_PIN_1);
     GPIOPinTypeGPIOOutput(GPIO_PORTF_BASE, GPIO_PIN_0 | GPIO_PIN_4);
+
+    /* 12) Hand the LEDs to the effects engine.  The heartbeat on D2 runs
+     *     from the Timer 4 interrupt with no task involved. */
+    LedFxInit(g_ui32SysClock);
+    LedFxPlay(LED_FX_D2, &g_sLedFxHeartbeat, 0);
+
+#ifdef WAVE_GEN_DEMO
+    /* 13) Build with -DWAVE_GEN_DEMO to play a 1 kHz sine pair in
+     *     quadrature on PK4 and PK5 at half amplitude.  The generator uses
+     *     the PWM clock divider LedFxInit() set, so it starts after it. */
+    static const uint32_t wavePhases[WAVE_GEN_CHANNELS] = { 0, 0x40000000 };
+    if (WaveGenInit(g_ui32SysClock)) {
+        WaveGenSet(0, NULL, 1000000, DDS_AMP_FULL / 2);
+        WaveGenSet(1, NULL, 1000000, DDS_AMP_FULL / 2);
+        WaveGenStart(wavePhases);
+    }
+#endif
     
 
     g_xDataSemaphore = xSemaphoreCreateBinary();
-    g_xButtonSemaphore = xSemaphoreCreateBinary();
     xEventGroup  =  xEventGroupCreate();
     
-    // Create binary semaphores for timer signaling
-    g_xLightSensorSemaphore = xSemaphoreCreateBinary();
     printing = xSemaphoreCreateBinary();
 
-    // Create the queue - sized to hold 5 sensor data messages
-    g_xLightSensorQueue = xQueueCreate(5, sizeof(LightSensorData_t));
-    if (g_xLightSensorQueue == NULL) {
-        UARTprintf("Failed to create light sensor queue!\n");
-    }
-    
-    UARTprintf("SETUP DONE\n");
-    
-    ConfigureTimers();
+    vDmaMemcpyInit();
     
     xTaskCreate(
         ReadLight,
         "LightSens",
-        configMINIMAL_STACK_SIZE * 2,
+        TASK_STACK_LIGHT_SENS,
         NULL,
         tskIDLE_PRIORITY + 2,  
         NULL
     );
     
-    // Create the display task
+    // Create the display task.  It brings the panel up ahead of the other
+    // tasks, then drops below the sensor task once the first frame is drawn.
     xTaskCreate(
         DisplayLight,
         "LightDisp",
-        configMINIMAL_STACK_SIZE * 2,
+        TASK_STACK_LIGHT_DISP,
         NULL,
-        tskIDLE_PRIORITY + 1,  // Lower priority than sensor task
-        NULL
+        tskIDLE_PRIORITY + 3,
+        &g_xDisplayTask
     );
+#ifdef RUN_BENCHMARKS
     xTaskCreate(
-        buttonTask,
-        "ButtonTask",
-        configMINIMAL_STACK_SIZE * 2,
+        prvBenchmarkTask,
+        "Bench",
+        TASK_STACK_BENCH,
         NULL,
-        tskIDLE_PRIORITY + 1,  // Lower priority than sensor task
+        tskIDLE_PRIORITY + 3,  // Run once, ahead of the application tasks
         NULL
     );
+#else
+    /* Drop the clock while the pipeline is idle */
+    ClockGovernorStart();
+#endif
+#ifdef STACK_PROFILE
+    /* Report peak stack use for stack_usage.py (build with -DSTACK_PROFILE) */
+    StackProfileStart(1000);
+#endif
 }
 
-static void buttonTask(void *prvParameters){
-    for (;;){
-        if (xSemaphoreTake(g_xButtonSemaphore, portMAX_DELAY) == pdPASS){
-            if (xEventGroupGetBits(xEventGroup) & EVENT_BTN_TOGGLE){
-                xEventGroupClearBits(xEventGroup,EVENT_BTN_TOGGLE);
-            } else {
-                xEventGroupSetBits(xEventGroup,EVENT_BTN_TOGGLE);
-            }
-        }
+#ifdef RUN_BENCHMARKS
+/* Prints the performance tables of the optional services once at start up.
+ * Build with -DRUN_BENCHMARKS to enable. */
+static void prvBenchmarkTask(void *pvParameters)
+{
+    UARTprintf("\n-- uDMA memcpy --\n");
+    vDmaMemcpyBenchmark();
+    UARTprintf("\n-- CAN transport (virtual bus) --\n");
+    vCanVBusBenchmark();
+    UARTprintf("\n-- UDP over modelled EMAC --\n");
+    vEmacModelBenchmark(g_ui32SysClock);
+    UARTprintf("\n-- Clock scaling --\n");
+    vClockScaleBenchmark();
+    UARTprintf("\n-- GPIO access --\n");
+    vGpioFastBenchmark();
+    UARTprintf("\n-- Q15 DSP kernels --\n");
+    vDspBenchmark();
+    UARTprintf("\n-- Deferred work --\n");
+    vDeferBenchmark();
+    UARTprintf("\n-- Stack overflow checking --\n");
+    vStackGuardBenchmark();
+    UARTprintf("\n-- Periodic tasks --\n");
+    vPeriodicBenchmark();
+    UARTprintf("\n-- Active objects --\n");
+    vActiveBenchmark();
+    UARTprintf("\n-- Latest value channels --\n");
+    vSeqChannelBenchmark();
+    UARTprintf("\n-- Sample codec --\n");
+    vTsCodecBenchmark();
+    vTaskDelete(NULL);
+}
+#endif
+
+/* Runs in the deferred work task after a button interrupt.  A press that
+ * cannot be queued is dropped, and counted by the button object. */
+static void prvButtonDeferred(void *pvArg, uint32_t ui32Buttons){
+    bool post;
+
+    taskENTER_CRITICAL();
+    post = (g_ui32ButtonsPending == 0);
+    g_ui32ButtonsPending |= ui32Buttons;
+    taskEXIT_CRITICAL();
+    if (post && !AoPost(&g_sButtonAo, SIG_BUTTONS, 0)) {
+        g_ui32ButtonsPending = 0;
     }
 }
 
+/* The button object's only state: each press flips the toggle bit, and is
+ * passed on to the stopwatch. */
+static uint32_t prvButtonsIdle(Active_t *psAo, const AoEvent_t *psEvent){
+    uint32_t buttons;
+
+    if (psEvent->ui32Sig != SIG_BUTTONS){
+        return AO_UNHANDLED;
+    }
+    taskENTER_CRITICAL();
+    buttons = g_ui32ButtonsPending;
+    g_ui32ButtonsPending = 0;
+    taskEXIT_CRITICAL();
+#ifdef TRACE_RECORD
+    TraceRecord(TRACE_EV_BUTTON, buttons);
+#endif
+    if (xEventGroupGetBits(xEventGroup) & EVENT_BTN_TOGGLE){
+        xEventGroupClearBits(xEventGroup,EVENT_BTN_TOGGLE);
+    } else {
+        xEventGroupSetBits(xEventGroup,EVENT_BTN_TOGGLE);
+    }
+    vStopwatchButtons(buttons);
+    return AO_HANDLED;
+}
+
 static void DisplayLight(void *pvParameters)
 {
     LightSensorData_t receivedData;
-    UARTprintf("raw,filtered\n");
-    vTaskDelay(pdMS_TO_TICKS(100));
+    bool bootReported = false;
+#ifdef TRACE_RECORD
+    bool traceDumped = false;
+#endif
+
+    /* The panel reset and power up delays sleep, so the sensor task brings
+     * up the OPT3001 while this waits. */
+    BootMark("lcd init");
     Kentec320x240x16_SSD2119Init(g_ui32SysClock);
+    BootMark("lcd ready");
 
-    GrContextInit(&ctx, &g_sKentec320x240x16_SSD2119);
+    /* The driver leaves the screen black, so the first frame only needs the
+     * axes. */
+    BandRenderInit(&g_sBandRender, &g_sKentec320x240x16_SSD2119,
+                   &g_sBandSink);
+    GrContextInit(&ctx, &g_sBandRender.sDisplay);
     graphInit(0, 0, GrContextDpyWidthGet(&ctx), 200,
               ClrBlack, ClrWhite);
+    drawGraphAxes(&g_sGraphCanvas);
+    GrFlush(&ctx);
+    BootMark("first frame");
+    vTaskPrioritySet(NULL, tskIDLE_PRIORITY + 1);  // Lower priority than sensor task
+
+    UARTprintf("raw,filtered\n");
     int previousBit = 0;
+    uint32_t lastSeq = 0;
     for (;;) {
-        if (xQueueReceive(g_xLightSensorQueue, &receivedData, portMAX_DELAY) == pdTRUE) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t updates = SEQ_CHANNEL_READ(&g_sLightLatest, &receivedData,
+                                            &lastSeq);
+        if (updates > 1) {
+            UARTprintf("missed %d samples\n", updates - 1);
+        }
+        if (updates != 0) {
             int value = xEventGroupGetBits(xEventGroup);
-            int32_t raw_int = (int32_t)(receivedData.lux_value * 100);
-            int32_t filtered_int = (int32_t)(receivedData.filtered_lux * 100);
-            addDataPoints(filtered_int/100);
-            UARTprintf("A%d.%02dB%d.%02d\n", 
-                       raw_int / 100, raw_int % 100,
-                       filtered_int / 100, filtered_int % 100);
+            int32_t parts[LIGHT_LINE_PARTS];
+            LightPipeLine(&receivedData, parts);
+            addDataPoints(parts[2]);
+            GrFlush(&ctx);
+            UARTprintf(LIGHT_LINE_FORMAT "\n",
+                       parts[0], parts[1], parts[2], parts[3]);
             if (value & VENT_LOW_THRESHOLD){
                 UARTprintf("a low threshold value was received\n");
                 xEventGroupClearBits(xEventGroup, VENT_LOW_THRESHOLD);
@@ -390,21 +593,44 @@ static void DisplayLight(void *pvParameters)
                 previousBit = value & EVENT_BTN_TOGGLE;
                 xEventGroupClearBits(xEventGroup, EVENT_BTN_TOGGLE);
             }
+#ifdef TRACE_RECORD
+            /* Build with -DTRACE_RECORD to record the sensor readings and
+             * button presses from start up, and print them for replay on
+             * the host once the recording is full. */
+            if (!traceDumped && TraceRecFull()) {
+                TraceRecDump();
+                traceDumped = true;
+            }
+#endif
+            if (!bootReported) {
+                /* Boot is over: report it and let the governor lower the
+                 * clock again. */
+                BootProfilePrint();
+                ClockLevelFloorSet(CLOCK_LEVEL_PIOSC);
+                bootReported = true;
+            }
         }
     }
 }
 
 int main( void )
 {
+    BootMark("main");
 
     xI2CSemaphore = xSemaphoreCreateBinary();
     xSemaphoreGive(xI2CSemaphore);
     /* Prepare the hardware to run this demo. */
     prvSetupHardware();
+    BootMark("hardware");
 
     /* create the queue task. */
     vcreateQueueTasks();
     vCreateLEDTask();
+    BootMark("scheduler");
+#if STACK_GUARD_MPU
+    /* Overflows fault in the MPU guard below the running task's stack. */
+    StackGuardInit();
+#endif
     /* Start the tasks running. */
     vTaskStartScheduler();
 
@@ -416,53 +642,100 @@ int main( void )
     for( ;; );
 }
 
+/* The sensor is read on the kernel tick, which keeps the rate without a
+ * hardware timer of its own.  It is read every SENSOR_PERIOD_MS while the
+ * light is changing, and every SENSOR_SLOW_PERIOD_MS once it has settled,
+ * with the sensor switched to 800 ms conversions so that a change between
+ * two reads still shows in the second.  SENSOR_PERIOD_STEP_MS spans the
+ * whole range: a period in between would read a 100 ms conversion that sees
+ * only part of such a change, and the host replay misses a passing shadow
+ * with a 350 ms step. */
+static Periodic_t g_sLightPeriodic = {
+    "LightSens", NULL, NULL, pdMS_TO_TICKS(SENSOR_PERIOD_MS), 0, 0,
+    PERIODIC_OVERRUN_SKIP
+};
+static LightPipe_t g_sLightPipe;
+
+/* Moves the sensor to the period the rate controller asks for. */
+static void prvLightPeriodSet(uint32_t period_ms)
+{
+    if (pdMS_TO_TICKS(period_ms) != g_sLightPeriodic.xPeriod) {
+        sensorOpt3001ConversionTime(period_ms >= SENSOR_SLOW_PERIOD_MS);
+        PeriodicPeriodSet(&g_sLightPeriodic, pdMS_TO_TICKS(period_ms));
+    }
+}
+
 static void ReadLight(void *pvParameters)
 {
     uint16_t raw_lux;
-    float lux;
-    static float lux_buffer[FILTER_WINDOW] = {0};
-    uint32_t buf_index = 0;
-    uint32_t buf_count = 0;
     int i = 0;
     LightSensorData_t sensorData;
 
+    LightPipeInit(&g_sLightPipe, SENSOR_PERIOD_MS, SENSOR_SLOW_PERIOD_MS,
+                  SENSOR_PERIOD_STEP_MS);
+#ifdef TRACE_RECORD
+    TraceRecStart();
+#endif
+
+    BootMark("sensor init");
     UARTprintf("Initializing light sensor...\n");
     sensorOpt3001Init();
     bool opt_test = sensorOpt3001Test();
     UARTprintf("OPT3001 Test: %s\n", opt_test ? "PASSED" : "FAILED");
-    vTaskDelay(pdMS_TO_TICKS(500));
+    BootMark("sensor ready");
+
+    /* The first conversion ends about 100 ms after the sensor is enabled.
+     * Poll for it instead of sleeping for a fixed time, and use it straight
+     * away rather than waiting for the next period. */
+    bool have_sample = false;
+    while (opt_test && !(have_sample = sensorOpt3001Read(&raw_lux))) {
+        vTaskDelay(pdMS_TO_TICKS(SENSOR_POLL_MS));
+    }
+    if (have_sample) {
+        BootMark("first sample");
+    }
 
     for (;;) {
-        if (xSemaphoreTake(g_xLightSensorSemaphore, portMAX_DELAY) == pdTRUE) {
-            if (sensorOpt3001Read(&raw_lux)) {
-                sensorOpt3001Convert(raw_lux, &lux);
-                if (lux > MAX_LUX){
-                    xEventGroupSetBits(xEventGroup, VENT_HIGH_THRESHOLD);
-                } else if (lux < MIN_LUX){
-                    xEventGroupSetBits(xEventGroup, VENT_LOW_THRESHOLD);
-                }
-                lux_buffer[buf_index] = lux;
-                buf_index = (buf_index + 1) % FILTER_WINDOW;
-                if (buf_count < FILTER_WINDOW) {
-                    buf_count++;
-                }
-
-                float sum = 0;
-                for (uint32_t k = 0; k < buf_count; k++) {
-                    sum += lux_buffer[k];
+        if (!have_sample) {
+            PeriodicWait(&g_sLightPeriodic);
+            have_sample = sensorOpt3001Read(&raw_lux);
+            /* The sensor keeps its own time, and a conversion due at the
+             * release may end just after it, as the first one does after a
+             * change of period.  Wait for it, and move the releases to just
+             * after the conversions so the next ones find a fresh result. */
+            if (!have_sample) {
+                vTaskDelay(pdMS_TO_TICKS(SENSOR_POLL_MS));
+                have_sample = sensorOpt3001Read(&raw_lux);
+                if (have_sample) {
+                    PeriodicPeriodSet(&g_sLightPeriodic,
+                                      g_sLightPeriodic.xPeriod);
                 }
-                float avg_lux = sum / buf_count;
-
-                sensorData.raw_lux = raw_lux;
-                sensorData.lux_value = lux;
-                sensorData.filtered_lux = avg_lux;
-                sensorData.timestamp = xTaskGetTickCount();
-
-                xQueueSend(g_xLightSensorQueue, &sensorData, 0);
-                
-                i++;
             }
         }
+        if (have_sample) {
+            have_sample = false;
+#ifdef TRACE_RECORD
+            TraceRecord(TRACE_EV_LIGHT, raw_lux);
+#endif
+            /* Conversion, filter, thresholds and the next period, in
+             * light_pipe.c so the host can replay recorded readings through
+             * it. */
+            uint32_t period_ms;
+            uint32_t events = LightPipeStep(&g_sLightPipe, raw_lux,
+                                            xTaskGetTickCount(), &sensorData,
+                                            &period_ms);
+            if (events & LIGHT_EV_HIGH){
+                xEventGroupSetBits(xEventGroup, VENT_HIGH_THRESHOLD);
+            } else if (events & LIGHT_EV_LOW){
+                xEventGroupSetBits(xEventGroup, VENT_LOW_THRESHOLD);
+            }
+            prvLightPeriodSet(period_ms);
+
+            SEQ_CHANNEL_WRITE(&g_sLightLatest, &sensorData);
+            xTaskNotifyGive(g_xDisplayTask);
+            
+            i++;
+        }
     }
 }
 /*-----------------------------------------------------------*/
@@ -495,60 +768,22 @@ static void prvConfigureUART(void)
 }
 /*-----------------------------------------------------------*/
 
-static void ConfigureTimers(void)
-{
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER3);  // Enable Timer3 peripheral
-    
-    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER3));
-    
-    TimerConfigure(TIMER3_BASE, TIMER_CFG_PERIODIC);  // Configure Timer3 as periodic
-    
-    TimerLoadSet(TIMER3_BASE, TIMER_A, g_ui32SysClock / 10 - 1);  // 10Hz for Timer3A
-    
-    TimerIntRegister(TIMER3_BASE, TIMER_A, Timer3AIntHandler); 
-    
-    IntPrioritySet(INT_TIMER3A, configMAX_SYSCALL_INTERRUPT_PRIORITY);
-    IntPrioritySet(INT_TIMER3B, configMAX_SYSCALL_INTERRUPT_PRIORITY);
-    
-    TimerIntEnable(TIMER3_BASE, TIMER_TIMA_TIMEOUT);  
-    TimerIntEnable(TIMER3_BASE, TIMER_TIMB_TIMEOUT);  // Enable Timer3B interrupt
-    
-    IntEnable(INT_TIMER3A);  
-    IntEnable(INT_TIMER3B); 
-    
-    TimerEnable(TIMER3_BASE, TIMER_A); 
-    TimerEnable(TIMER3_BASE, TIMER_B);  
-}
-
-void Timer3AIntHandler(void)
-{
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    TimerIntClear(TIMER3_BASE, TIMER_TIMA_TIMEOUT);
-    
-    GPIOPinWrite(GPIO_PORTN_BASE, GPIO_PIN_0, 
-                ~GPIOPinRead(GPIO_PORTN_BASE, GPIO_PIN_0) & GPIO_PIN_0);
-    
-    xSemaphoreGiveFromISR(g_xLightSensorSemaphore, &xHigherPriorityTaskWoken);
-
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-}
-
-
-
-
 static void prvSetupHardware( void )
 {
-    /* Run from the PLL at configCPU_CLOCK_HZ MHz. */
-    g_ui32SysClock = MAP_SysCtlClockFreqSet((SYSCTL_XTAL_25MHZ |
-            SYSCTL_OSC_MAIN | SYSCTL_USE_PLL |
-            SYSCTL_CFG_VCO_240), configCPU_CLOCK_HZ);
+    /* Start from the PLL at 120 MHz.  Later changes go through
+    ClockLevelSet() so the drivers are told. */
+    g_ui32SysClock = ClockScaleInit(CLOCK_LEVEL_PLL120);
+    BootMark("clock");
+
+    /* Stay at full speed until the boot is over; the display task lowers
+    the floor again once it has reported the boot timeline. */
+    ClockLevelFloorSet(CLOCK_LEVEL_PLL120);
 
     /* Configure device pins. */
     PinoutSet(false, false);
 
     /* Configure UART0 to send messages to terminal. */
     prvConfigureUART();
-    ConfigureTimers();
 }
 /*-----------------------------------------------------------*/
 
@@ -584,13 +819,16 @@ void vApplicationIdleHook( void )
 
 void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName )
 {
-    ( void ) pcTaskName;
     ( void ) pxTask;
 
     /* Run time stack overflow checking is performed if
-    configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2.  This hook
-    function is called if a stack overflow is detected. */
+    configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2, or by the MPU guard
+    when STACK_GUARD_MPU is set.  This hook function is called if a stack
+    overflow is detected.  Name the task
+    and print the peaks seen so far before halting, so the size to fix in
+    task_stacks.h is known. */
     IntMasterDisable();
+    StackProfileOverflow(pcTaskName);
     for( ;; );
 }
 /*-----------------------------------------------------------*/
@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include "inc/hw_nvic.h"
 #include "inc/hw_types.h"
+#include "drivers/boot_profile.h"
 
 //*****************************************************************************
 //
@@ -228,6 +229,11 @@ ResetISR(void)
 {
     uint32_t *pui32Src, *pui32Dest;
 
+    //
+    // Start the cycle counter that times the boot.
+    //
+    BootProfileStart();
+
     //
     // Copy the data segment initializers from flash to SRAM.
     //
@@ -263,6 +269,7 @@ ResetISR(void)
     HWREG(NVIC_CPAC) = ((HWREG(NVIC_CPAC) &
                          ~(NVIC_CPAC_CP10_M | NVIC_CPAC_CP11_M)) |
                         NVIC_CPAC_CP10_FULL | NVIC_CPAC_CP11_FULL);
+    BootMark("crt0");
 
     //
     // Call the application's entry point.
@@ -0,0 +1,155 @@
+/******************************************************************************
+ *
+ * The stopwatch from Lab 2, as an active object.
+ *
+ * SW1 starts the stopwatch, stops it and starts it again; SW2 resets it.  It
+ * counts in tenths of a second up to STOPWATCH_LIMIT and reports on the
+ * console when it stops.  The Lab 2 INACTIVE and STOPWATCH states are kept,
+ * with STOPWATCH split into running and stopped so the two presses of SW1
+ * are told apart by the state rather than a flag:
+ *
+ *   inactive           SW1 -> running
+ *   stopwatch          SW2 -> inactive
+ *     running          SW1 -> stopped, each 100 ms count a tenth
+ *     stopped          SW1 -> running
+ *
+ * The hardware timers the Lab 2 version counted with are replaced by the
+ * object's own timer, which is only armed while it is running.
+ *
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Hardware includes. */
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "drivers/rtos_hw_drivers.h"
+#include "drivers/active.h"
+#include "utils/uartstdio.h"
+
+/*-----------------------------------------------------------*/
+
+/* Stop counting after 20 seconds, as Lab 2 did. */
+#define STOPWATCH_LIMIT         200
+#define STOPWATCH_TENTH         pdMS_TO_TICKS(100)
+
+#define SIG_START_STOP          (AO_SIG_USER)
+#define SIG_RESET               (AO_SIG_USER + 1)
+
+typedef struct {
+    Active_t sAo;               /* Must come first */
+    uint32_t ui32Tenths;
+} Stopwatch_t;
+
+static uint32_t prvInactive(Active_t *psAo, const AoEvent_t *psEvent);
+static uint32_t prvStopwatch(Active_t *psAo, const AoEvent_t *psEvent);
+static uint32_t prvRunning(Active_t *psAo, const AoEvent_t *psEvent);
+static uint32_t prvStopped(Active_t *psAo, const AoEvent_t *psEvent);
+
+static const AoState_t g_sInactive = { "inactive", NULL, prvInactive };
+static const AoState_t g_sStopwatch = { "stopwatch", NULL, prvStopwatch };
+static const AoState_t g_sRunning = { "running", &g_sStopwatch, prvRunning };
+static const AoState_t g_sStopped = { "stopped", &g_sStopwatch, prvStopped };
+
+static Stopwatch_t g_sStopwatchAo = { { "stopwatch", &g_sInactive } };
+
+/*-----------------------------------------------------------*/
+
+static void prvReport(Stopwatch_t *psWatch, const char *pcWhat)
+{
+    UARTprintf("stopwatch %s at %d.%d s\n", pcWhat,
+               psWatch->ui32Tenths / 10, psWatch->ui32Tenths % 10);
+}
+
+static uint32_t prvInactive(Active_t *psAo, const AoEvent_t *psEvent)
+{
+    Stopwatch_t *psWatch = (Stopwatch_t *)psAo;
+
+    switch (psEvent->ui32Sig) {
+        case AO_SIG_ENTRY:
+            psWatch->ui32Tenths = 0;
+            return AO_HANDLED;
+        case SIG_START_STOP:
+            return AO_TRAN_TO(psAo, &g_sRunning);
+        default:
+            return AO_UNHANDLED;
+    }
+}
+
+static uint32_t prvStopwatch(Active_t *psAo, const AoEvent_t *psEvent)
+{
+    switch (psEvent->ui32Sig) {
+        case SIG_RESET:
+            UARTprintf("stopwatch reset\n");
+            return AO_TRAN_TO(psAo, &g_sInactive);
+        default:
+            return AO_UNHANDLED;
+    }
+}
+
+static uint32_t prvRunning(Active_t *psAo, const AoEvent_t *psEvent)
+{
+    Stopwatch_t *psWatch = (Stopwatch_t *)psAo;
+
+    switch (psEvent->ui32Sig) {
+        case AO_SIG_ENTRY:
+            AoTimerArm(psAo, STOPWATCH_TENTH, STOPWATCH_TENTH);
+            return AO_HANDLED;
+        case AO_SIG_EXIT:
+            AoTimerDisarm(psAo);
+            return AO_HANDLED;
+        case AO_SIG_TIMEOUT:
+            if (++psWatch->ui32Tenths < STOPWATCH_LIMIT) {
+                return AO_HANDLED;
+            }
+            UARTprintf("Time limit reached!\n");
+            return AO_TRAN_TO(psAo, &g_sStopped);
+        case SIG_START_STOP:
+            return AO_TRAN_TO(psAo, &g_sStopped);
+        default:
+            return AO_UNHANDLED;
+    }
+}
+
+static uint32_t prvStopped(Active_t *psAo, const AoEvent_t *psEvent)
+{
+    Stopwatch_t *psWatch = (Stopwatch_t *)psAo;
+
+    switch (psEvent->ui32Sig) {
+        case AO_SIG_ENTRY:
+            prvReport(psWatch, "stopped");
+            return AO_HANDLED;
+        case SIG_START_STOP:
+            if (psWatch->ui32Tenths >= STOPWATCH_LIMIT) {
+                return AO_HANDLED;
+            }
+            return AO_TRAN_TO(psAo, &g_sRunning);
+        default:
+            return AO_UNHANDLED;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Starts the stopwatch on a worker.  Call before the worker is started. */
+void vStopwatchStart(AoWorker_t *psWorker)
+{
+    AoStart(&g_sStopwatchAo.sAo, psWorker);
+}
+
+/* Passes on button presses, from a task. */
+void vStopwatchButtons(uint32_t ui32Buttons)
+{
+    if (ui32Buttons & USR_SW1) {
+        AoPost(&g_sStopwatchAo.sAo, SIG_START_STOP, 0);
+    }
+    if (ui32Buttons & USR_SW2) {
+        AoPost(&g_sStopwatchAo.sAo, SIG_RESET, 0);
+    }
+}
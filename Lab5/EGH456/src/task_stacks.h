@@ -0,0 +1,42 @@
+//*****************************************************************************
+//
+// task_stacks.h - Stack depth of each application task, in words.
+//
+// Every task the application creates takes its depth from here, so that the
+// stack report (stack_usage.py, see drivers/stack_profile.h) can size them
+// all in one place.  TASK_STACKS() is the one list of them: each entry gives
+// the depth's TASK_STACK_xxx name, the depth, and the task name and entry
+// function the report uses to find the task in the call graph and in the run
+// time samples.  The depth constants and the stack profile's table are both
+// made from it, so a task added here is measured too.  `pio run -t stackfit`
+// rewrites the numbers with its recommendations.
+//
+//*****************************************************************************
+
+#ifndef __TASK_STACKS_H__
+#define __TASK_STACKS_H__
+
+#define TASK_STACKS(X)                                                        \
+    X(LIGHT_SENS,   400,    "LightSens",    ReadLight)                        \
+    X(LIGHT_DISP,   400,    "LightDisp",    DisplayLight)                     \
+    X(DEFER,        200,    "Defer",        prvDeferTask)                     \
+    X(AO_UI,        200,    "AoUI",         prvAoWorkerTask)                  \
+    X(BENCH,        400,    "Bench",        prvBenchmarkTask)                 \
+    X(CLOCK_GOV,    200,    "ClkGov",       prvGovernorTask)                  \
+    X(ADC_STREAM,   400,    "AdcStream",    prvAdcStreamTask)                 \
+    X(FREQ_METER,   200,    "FreqMeter",    prvFreqMeterTask)                 \
+    X(WAVE_GEN,     200,    "WaveGen",      prvWaveGenTask)                   \
+    X(STACK_MON,    200,    "StackMon",     prvStackMonTask)
+
+//
+// TASK_STACK_LIGHT_SENS and the rest, one per entry.
+//
+#define TASK_STACK_DEPTH(ID, DEPTH, NAME, ENTRY)                              \
+                                TASK_STACK_##ID = DEPTH,
+
+enum
+{
+    TASK_STACKS(TASK_STACK_DEPTH)
+};
+
+#endif // __TASK_STACKS_H__
@@ -0,0 +1,296 @@
+"""
+stack_usage.py - Task stack sizing from the static call graph and measured
+peaks.
+
+For each task in src/task_stacks.h this finds the deepest call chain from
+its entry function, using the frame sizes GCC writes with -fstack-usage and
+the calls in the disassembled firmware, and combines it with the peak use
+the firmware reported at run time (drivers/stack_profile.c, "STACK name
+depth used" lines in a saved console log).  It prints the recommended depth
+of every task and the RAM the change would save or cost.
+
+As a PlatformIO extra script it turns on -fstack-usage and adds two targets:
+
+    pio run -t stackreport      print the report
+    pio run -t stackfit         also rewrite src/task_stacks.h
+
+Both read stack.log in the project directory when it exists.  It also runs
+on its own:
+
+    python stack_usage.py --build .pio/build/lptm4c1294ncpdt \\
+        [--log stack.log] [--margin 20] [--write]
+
+A chain through a function pointer or a recursive call has no static
+bound; those tasks are marked and sized from the measured peak alone, so
+they need a run that exercises their deepest path (for the display task,
+a full redraw through grlib).
+"""
+
+import argparse
+import math
+import os
+import re
+import subprocess
+import sys
+
+# Words a task switched out by an interrupt holds beyond its own frames: the
+# exception frame with the FPU state (26) and the registers the port saves
+# (r4-r11, lr and s16-s31, 25).
+SWITCH_WORDS = 51
+
+# Words at the bottom of each stack the MPU guard can take when it is built
+# in (STACK_GUARD_WORDS, drivers/stack_guard.h).  They are added after the
+# margin: the guard is never used, however deep the task goes.
+GUARD_WORDS = 14
+
+# Recommended depths are rounded up to this many words.
+ROUND_WORDS = 8
+
+STACK_LINE = re.compile(r'^(\s*X\(\w+,\s*)(\d+)(,\s*"([^"]+)",\s*(\w+)\).*)$')
+LOG_LINE = re.compile(r'^STACK (\S+) (\d+) (\d+)\s*$')
+FUNC_LINE = re.compile(r'^[0-9a-f]+ <([^>]+)>:$')
+CALL_LINE = re.compile(r'\tbl\s+[0-9a-f]+ <([^>+]+)>')
+TAIL_LINE = re.compile(r'\tb(?:\.w|\.n)?\s+[0-9a-f]+ <([^>+]+)>')
+INDIRECT_LINE = re.compile(r'\tblx\s+r\d+')
+
+
+def read_frames(build_dir):
+    """Returns {function: (bytes, dynamic)} from the .su files of a build."""
+    frames = {}
+    for root, _, files in os.walk(build_dir):
+        for name in files:
+            if not name.endswith(".su"):
+                continue
+            with open(os.path.join(root, name)) as su:
+                for line in su:
+                    fields = line.rstrip("\n").split("\t")
+                    if len(fields) < 3:
+                        continue
+                    func = fields[0].rsplit(":", 1)[-1]
+                    size = int(fields[1])
+                    dynamic = fields[2].startswith("dynamic") and \
+                        "bounded" not in fields[2]
+                    old = frames.get(func, (0, False))
+                    frames[func] = (max(old[0], size), old[1] or dynamic)
+    return frames
+
+
+def read_calls(elf, objdump):
+    """Returns {function: (set of callees, calls through a pointer)}."""
+    text = subprocess.run([objdump, "-d", "--no-show-raw-insn", elf],
+                          check=True, capture_output=True,
+                          text=True).stdout
+    calls = {}
+    func = None
+    for line in text.splitlines():
+        match = FUNC_LINE.match(line)
+        if match:
+            func = match.group(1)
+            calls[func] = (set(), False)
+            continue
+        if func is None:
+            continue
+        callees, indirect = calls[func]
+        match = CALL_LINE.search(line) or TAIL_LINE.search(line)
+        if match and match.group(1) != func:
+            callees.add(match.group(1))
+        elif INDIRECT_LINE.search(line):
+            calls[func] = (callees, True)
+    return calls
+
+
+def worst_case(entry, frames, calls):
+    """Returns (bytes, chain, problems) for the deepest path from entry.
+
+    problems lists what makes the figure a lower bound: calls through
+    pointers, recursion, dynamic frames and functions with no frame size.
+    """
+    memo = {}
+
+    def visit(func, active):
+        if func in memo:
+            return memo[func]
+        if func in active:
+            return 0, [func], {"recursion in " + func}
+        size, dynamic = frames.get(func, (0, False))
+        problems = set()
+        if func not in frames:
+            problems.add("no frame size for " + func)
+        if dynamic:
+            problems.add("dynamic frame in " + func)
+        callees, indirect = calls.get(func, (set(), False))
+        if indirect:
+            problems.add("pointer call in " + func)
+        best, chain = 0, []
+        active.add(func)
+        for callee in sorted(callees):
+            depth, sub, sub_problems = visit(callee, active)
+            problems |= sub_problems
+            if depth > best:
+                best, chain = depth, sub
+        active.discard(func)
+        memo[func] = (size + best, [func] + chain, problems)
+        return memo[func]
+
+    return visit(entry, set())
+
+
+def read_tasks(header):
+    """Returns [(name, entry, depth)] from task_stacks.h."""
+    tasks = []
+    with open(header) as src:
+        for line in src:
+            match = STACK_LINE.match(line.rstrip("\r\n"))
+            if match:
+                tasks.append((match.group(4), match.group(5),
+                              int(match.group(2))))
+    return tasks
+
+
+def read_log(log):
+    """Returns {task name: peak words used} from a console log."""
+    peaks = {}
+    if log and os.path.exists(log):
+        with open(log, errors="replace") as src:
+            for line in src:
+                match = LOG_LINE.match(line.strip())
+                if match and int(match.group(2)):
+                    name, used = match.group(1), int(match.group(3))
+                    peaks[name] = max(peaks.get(name, 0), used)
+    return peaks
+
+
+def recommend(static_words, bounded, measured, margin):
+    """Returns the recommended depth in words, or None if nothing is known."""
+    need = None
+    if bounded:
+        need = static_words + SWITCH_WORDS
+    if measured is not None:
+        need = max(need or 0, measured)
+    if need is None:
+        return None
+    need = math.ceil(need * (100 + margin) / 100) + GUARD_WORDS
+    return -(-need // ROUND_WORDS) * ROUND_WORDS
+
+
+def rewrite(header, sizes):
+    """Replaces the depths in task_stacks.h, keeping its line endings."""
+    with open(header, newline="") as src:
+        lines = src.readlines()
+    for idx, line in enumerate(lines):
+        body = line.rstrip("\r\n")
+        match = STACK_LINE.match(body)
+        if match and match.group(4) in sizes:
+            # Keep the name, and the backslash after it, in their columns.
+            value = str(sizes[match.group(4)])
+            rest = match.group(3)[1:].lstrip()
+            width = len(match.group(2)) + len(match.group(3)) - len(rest)
+            lines[idx] = match.group(1) + value + "," + \
+                " " * max(1, width - len(value) - 1) + rest + \
+                line[len(body):]
+    with open(header, "w", newline="") as dst:
+        dst.writelines(lines)
+
+
+def report(build_dir, elf, objdump, header, log, margin, write):
+    frames = read_frames(build_dir)
+    calls = read_calls(elf, objdump)
+    peaks = read_log(log)
+    if not frames:
+        print("stack_usage: no .su files in %s; build with -fstack-usage"
+              % build_dir)
+        return 1
+
+    print("%-11s %-17s %6s %7s %9s %6s" % ("task", "entry", "depth",
+                                           "static", "measured", "recommend"))
+    sizes = {}
+    saved = 0
+    notes = []
+    for name, entry, depth in read_tasks(header):
+        if entry not in calls:
+            notes.append("%s: %s is not in the image" % (name, entry))
+            static_text, bounded, static_words = "-", False, 0
+        else:
+            size, chain, problems = worst_case(entry, frames, calls)
+            static_words = -(-size // 4)
+            bounded = not problems
+            static_text = str(static_words + SWITCH_WORDS) + \
+                ("" if bounded else "+")
+            if problems:
+                notes.append("%s: no static bound (%s)"
+                             % (name, "; ".join(sorted(problems)[:3])))
+            notes.append("%s: deepest chain %s" % (name, " > ".join(chain)))
+        measured = peaks.get(name)
+        rec = recommend(static_words, bounded, measured, margin)
+        if rec is not None:
+            sizes[name] = rec
+            saved += (depth - rec) * 4
+        print("%-11s %-17s %6d %7s %9s %6s" % (
+            name, entry, depth, static_text,
+            "-" if measured is None else measured,
+            "keep" if rec is None else rec))
+
+    print("\nstatic: worst call chain plus %d words of switch frame, in "
+          "words; + marks a lower bound" % SWITCH_WORDS)
+    print("recommend: the larger of static and measured, plus %d%%, plus "
+          "%d words of stack guard" % (margin, GUARD_WORDS))
+    print("RAM %s: %d bytes" % ("saved" if saved >= 0 else "needed",
+                                abs(saved)))
+    for note in notes:
+        print("  " + note)
+
+    if write and sizes:
+        rewrite(header, sizes)
+        print("updated %s" % header)
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--build", required=True,
+                        help="PlatformIO build directory")
+    parser.add_argument("--elf", help="firmware image (default "
+                        "BUILD/firmware.elf)")
+    parser.add_argument("--objdump", default="arm-none-eabi-objdump")
+    parser.add_argument("--header", default=os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), "src", "task_stacks.h"))
+    parser.add_argument("--log", help="console log with STACK lines")
+    parser.add_argument("--margin", type=int, default=20,
+                        help="percent added to the larger figure")
+    parser.add_argument("--write", action="store_true",
+                        help="rewrite the header with the recommendations")
+    args = parser.parse_args()
+    return report(args.build,
+                  args.elf or os.path.join(args.build, "firmware.elf"),
+                  args.objdump, args.header, args.log, args.margin,
+                  args.write)
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO's SCons
+except NameError:
+    env = None
+
+if env is not None:
+    env.Append(CCFLAGS=["-fstack-usage"])
+
+    def _stack_target(write):
+        def action(target, source, env):
+            project = env.subst("$PROJECT_DIR")
+            return report(env.subst("$BUILD_DIR"),
+                          env.subst("$BUILD_DIR/${PROGNAME}.elf"),
+                          env.subst("$OBJCOPY").replace("objcopy", "objdump"),
+                          os.path.join(project, "src", "task_stacks.h"),
+                          os.path.join(project, "stack.log"), 20, write)
+        return action
+
+    env.AddCustomTarget("stackreport", "$BUILD_DIR/${PROGNAME}.elf",
+                        _stack_target(False), title="Stack report",
+                        description="Task stack sizes from the call graph "
+                        "and stack.log")
+    env.AddCustomTarget("stackfit", "$BUILD_DIR/${PROGNAME}.elf",
+                        _stack_target(True), title="Stack fit",
+                        description="Rewrite src/task_stacks.h with the "
+                        "recommended sizes")
+elif __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,312 @@
+//*****************************************************************************
+//
+// game_assets.c - Tiles, sprites and map for the sprite demo.
+//
+// The art is stored as native RGB565 so the tile engine can copy it straight
+// into its scan line buffer.  Sprites use magenta (0xf81f) as their
+// transparent key.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "grlib.h"
+#include "tile_engine.h"
+#include "game_assets.h"
+
+//*****************************************************************************
+//
+// The tile set, in the order of the GAME_TILE_* numbers.
+//
+//*****************************************************************************
+const uint16_t g_pui16GameTiles[] =
+{
+    0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x9388, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0x9388, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0x9388,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0x9388, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0x9388, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0x9388, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0x9388, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0x9388,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0x9388, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0x9388, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0x9388, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0x9388, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0x9388, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0x9388, 0xb46b, 0xb46b,
+    0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b, 0xb46b,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x7d5e, 0x7d5e, 0x7d5e, 0x7d5e, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x7d5e, 0x7d5e, 0x7d5e, 0x7d5e, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x7d5e, 0x7d5e, 0x7d5e, 0x7d5e,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x7d5e, 0x7d5e, 0x7d5e, 0x7d5e,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x7d5e, 0x7d5e, 0x7d5e, 0x7d5e, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x7d5e, 0x7d5e, 0x7d5e, 0x7d5e, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x7d5e, 0x7d5e, 0x7d5e, 0x7d5e,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x7d5e, 0x7d5e, 0x7d5e, 0x7d5e,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9, 0x2ad9,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57,
+    0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57,
+    0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5, 0xce57,
+    0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57,
+    0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xa9e5, 0xa9e5, 0xa9e5, 0xce57, 0xa9e5, 0xa9e5, 0xa9e5, 0xa9e5,
+    0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57,
+    0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57, 0xce57,
+    0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x1b65, 0x2c66, 0x2c66, 0xff27, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0xff27, 0xf4a0, 0xff27, 0x2c66, 0x2c66,
+    0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0xff27, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0xfbd9, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0xfbd9, 0xf4a0, 0xfbd9, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0xfbd9, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0xffdf, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0xffdf, 0xf4a0, 0xffdf, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0xffdf, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x1b65, 0x2c66, 0x2c66,
+    0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66, 0x2c66,
+};
+
+//*****************************************************************************
+//
+// A 12x12 ball.
+//
+//*****************************************************************************
+static const uint16_t g_pui16BallPixels[] =
+{
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0x5800, 0x5800, 0x5800, 0x5800,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0x5800, 0x5800,
+    0x5800, 0xd8e3, 0xd8e3, 0x5800, 0x5800, 0x5800, 0xf81f, 0xf81f,
+    0xf81f, 0x5800, 0x5800, 0xfefb, 0xfefb, 0xd8e3, 0xd8e3, 0xd8e3,
+    0xd8e3, 0x5800, 0x5800, 0xf81f, 0xf81f, 0x5800, 0xfefb, 0xfefb,
+    0xfefb, 0xfefb, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0x5800, 0xf81f,
+    0x5800, 0x5800, 0xfefb, 0xfefb, 0xfefb, 0xfefb, 0xd8e3, 0xd8e3,
+    0xd8e3, 0xd8e3, 0x5800, 0x5800, 0x5800, 0xd8e3, 0xd8e3, 0xfefb,
+    0xfefb, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0x5800,
+    0x5800, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3,
+    0xd8e3, 0xd8e3, 0xd8e3, 0x5800, 0x5800, 0x5800, 0xd8e3, 0xd8e3,
+    0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0x5800, 0x5800,
+    0xf81f, 0x5800, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3,
+    0xd8e3, 0xd8e3, 0x5800, 0xf81f, 0xf81f, 0x5800, 0x5800, 0xd8e3,
+    0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0xd8e3, 0x5800, 0x5800, 0xf81f,
+    0xf81f, 0xf81f, 0x5800, 0x5800, 0x5800, 0xd8e3, 0xd8e3, 0x5800,
+    0x5800, 0x5800, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0x5800, 0x5800, 0x5800, 0x5800, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+};
+
+//*****************************************************************************
+//
+// Two 16x12 frames of a slime.
+//
+//*****************************************************************************
+static const uint16_t g_pui16SlimePixels0[] =
+{
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0x13c3, 0x13c3, 0x13c3,
+    0x13c3, 0x13c3, 0x13c3, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0x13c3, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x13c3, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0x13c3, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x13c3, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0x13c3, 0x5eeb, 0x5eeb, 0x0841, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x0841, 0x5eeb, 0x5eeb, 0x13c3, 0xf81f, 0xf81f,
+    0xf81f, 0x13c3, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x13c3, 0xf81f,
+    0xf81f, 0x13c3, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x13c3, 0xf81f,
+    0xf81f, 0x13c3, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x13c3, 0xf81f,
+    0xf81f, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0xf81f,
+    0x13c3, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x13c3,
+};
+
+static const uint16_t g_pui16SlimePixels1[] =
+{
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0x13c3, 0x13c3, 0x13c3,
+    0x13c3, 0x13c3, 0x13c3, 0xf81f, 0xf81f, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0xf81f, 0x13c3, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x13c3, 0xf81f, 0xf81f, 0xf81f,
+    0xf81f, 0xf81f, 0x13c3, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x13c3, 0xf81f, 0xf81f,
+    0xf81f, 0x13c3, 0x5eeb, 0x5eeb, 0x5eeb, 0x0841, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x0841, 0x5eeb, 0x5eeb, 0x5eeb, 0x13c3, 0xf81f,
+    0x13c3, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x13c3,
+    0x13c3, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x13c3,
+    0x13c3, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb,
+    0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x5eeb, 0x13c3,
+};
+
+//*****************************************************************************
+//
+// Sprite images.
+//
+//*****************************************************************************
+const tSpriteImage g_sSpriteBall =
+{
+    g_pui16BallPixels, 12, 12, GAME_KEY_COLOR, SPRITE_FLAG_KEYED
+};
+
+const tSpriteImage g_psSpriteSlime[2] =
+{
+    { g_pui16SlimePixels0, 16, 12, GAME_KEY_COLOR, SPRITE_FLAG_KEYED },
+    { g_pui16SlimePixels1, 16, 12, GAME_KEY_COLOR, SPRITE_FLAG_KEYED }
+};
+
+//*****************************************************************************
+//
+// The map: a brick border around a field with paths and a pond.
+//
+//*****************************************************************************
+const uint8_t g_ppui8GameMap[TILE_MAP_ROWS][TILE_MAP_COLS] =
+{
+    { 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3 },
+    { 3, 0, 0, 0, 0, 4, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 0, 0, 3 },
+    { 3, 0, 0, 0, 0, 0, 1, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 3 },
+    { 3, 0, 0, 0, 4, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 4, 0, 0, 0, 3 },
+    { 3, 0, 0, 0, 0, 0, 1, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3 },
+    { 3, 0, 0, 4, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 4, 0, 0, 0, 0, 3 },
+    { 3, 0, 0, 0, 0, 0, 1, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3 },
+    { 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3 },
+    { 3, 0, 0, 0, 0, 0, 1, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 3 },
+    { 3, 4, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 2, 2, 2, 2, 2, 0, 0, 3 },
+    { 3, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 2, 2, 2, 2, 2, 4, 0, 3 },
+    { 3, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 4, 2, 2, 2, 2, 2, 0, 0, 3 },
+    { 3, 0, 0, 0, 0, 4, 1, 0, 0, 0, 0, 0, 2, 2, 2, 2, 2, 0, 0, 3 },
+    { 3, 0, 0, 0, 0, 0, 1, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 3 },
+    { 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3 },
+};
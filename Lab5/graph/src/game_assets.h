@@ -0,0 +1,58 @@
+//*****************************************************************************
+//
+// game_assets.h - Tiles, sprites and map for the sprite demo.
+//
+//*****************************************************************************
+
+#ifndef __GAME_ASSETS_H__
+#define __GAME_ASSETS_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Tile numbers within g_pui16GameTiles.
+//
+//*****************************************************************************
+#define GAME_TILE_GRASS         0
+#define GAME_TILE_PATH          1
+#define GAME_TILE_WATER         2
+#define GAME_TILE_BRICK         3
+#define GAME_TILE_FLOWERS       4
+
+//*****************************************************************************
+//
+// The transparent key color of the sprites.
+//
+//*****************************************************************************
+#define GAME_KEY_COLOR          TILE_RGB565(0xff, 0x00, 0xff)
+
+//*****************************************************************************
+//
+// The assets.
+//
+//*****************************************************************************
+extern const uint16_t g_pui16GameTiles[];
+extern const tSpriteImage g_sSpriteBall;
+extern const tSpriteImage g_psSpriteSlime[2];
+extern const uint8_t g_ppui8GameMap[TILE_MAP_ROWS][TILE_MAP_COLS];
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GAME_ASSETS_H__
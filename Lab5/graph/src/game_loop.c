@@ -0,0 +1,221 @@
+//*****************************************************************************
+//
+// game_loop.c - A fixed time step game loop with frame timing statistics.
+//
+// Game state advances in steps of a fixed length, so motion does not depend
+// on how long drawing took.  The loop sleeps until the next step is due, runs
+// it, draws once, and goes back to sleep.  If drawing overran and several
+// steps are due, they are run back to back before the next draw (up to
+// GAME_MAX_CATCHUP of them), which keeps the game running at the right speed
+// while the frame rate drops.  The tick rate is not a multiple of most frame
+// rates, so step lengths are kept in whole ticks with the remainder carried
+// forward; at 30 Hz with a 1 ms tick the steps are 33, 33 and 34 ms.
+//
+// Render time is measured with the DWT cycle counter, since the tick is too
+// coarse to see the difference a few dirty rectangles make.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "inc/hw_types.h"
+#include "game_loop.h"
+
+//*****************************************************************************
+//
+// Debug and trace registers used for the cycle counter.  These are part of
+// the ARMv7-M system control space and are not described by the TivaWare
+// inc/ headers.
+//
+//*****************************************************************************
+#define GAME_DEMCR              0xE000EDFC  // Debug Exception Monitor Control
+#define GAME_DEMCR_TRCENA       0x01000000  // Enable DWT and ITM blocks
+#define GAME_DWT_CTRL           0xE0001000  // DWT Control
+#define GAME_DWT_CTRL_CYCCNTENA 0x00000001  // Enable the cycle counter
+#define GAME_DWT_CYCCNT         0xE0001004  // DWT Cycle Count
+
+//*****************************************************************************
+//
+// Clears the statistics.
+//
+//*****************************************************************************
+static void
+prvStatsReset(tGameStats *psStats)
+{
+    psStats->ui32Frames = 0;
+    psStats->ui32Steps = 0;
+    psStats->ui32Late = 0;
+    psStats->ui32Dropped = 0;
+    psStats->ui32RenderMinUs = 0xffffffff;
+    psStats->ui32RenderMaxUs = 0;
+    psStats->ui32RenderSumUs = 0;
+    psStats->ui32PixelsMax = 0;
+    psStats->ui32PixelsSum = 0;
+}
+
+//*****************************************************************************
+//
+// Returns the length of the next step in ticks, carrying the fraction of a
+// tick left over in *pui32Frac.
+//
+//*****************************************************************************
+static TickType_t
+prvStepTicks(const tGameLoop *psLoop, uint32_t *pui32Frac)
+{
+    TickType_t xTicks;
+
+    *pui32Frac += configTICK_RATE_HZ;
+    xTicks = *pui32Frac / psLoop->ui32StepHz;
+    *pui32Frac -= xTicks * psLoop->ui32StepHz;
+
+    return(xTicks);
+}
+
+//*****************************************************************************
+//
+//! Initializes a game loop.
+//!
+//! \param psLoop is the loop to initialize.
+//! \param ui32StepHz is the number of update steps per second, and so the
+//! target frame rate.
+//! \param ui32SysClock is the system clock frequency in Hz.
+//! \param pfnUpdate advances the game by one step.
+//! \param pfnRender draws the game and returns the number of pixels written.
+//! \param pvArg is passed to \e pfnUpdate and \e pfnRender.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+GameLoopInit(tGameLoop *psLoop, uint32_t ui32StepHz, uint32_t ui32SysClock,
+             void (*pfnUpdate)(void *pvArg),
+             uint32_t (*pfnRender)(void *pvArg), void *pvArg)
+{
+    psLoop->ui32StepHz = ui32StepHz;
+    psLoop->ui32SysClock = ui32SysClock;
+    psLoop->pfnUpdate = pfnUpdate;
+    psLoop->pfnRender = pfnRender;
+    psLoop->pvArg = pvArg;
+    prvStatsReset(&psLoop->sStats);
+}
+
+//*****************************************************************************
+//
+//! Runs a game loop in the calling task.
+//!
+//! \param psLoop is the loop to run.
+//!
+//! This function does not return.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+GameLoopRun(tGameLoop *psLoop)
+{
+    TickType_t xNextStep, xNow;
+    uint32_t ui32Frac, ui32Steps, ui32Dropped, ui32Start, ui32Us, ui32Pixels;
+    uint32_t ui32CyclesPerUs;
+    tGameStats *psStats;
+
+    //
+    // Start the cycle counter.
+    //
+    HWREG(GAME_DEMCR) |= GAME_DEMCR_TRCENA;
+    HWREG(GAME_DWT_CTRL) |= GAME_DWT_CTRL_CYCCNTENA;
+    ui32CyclesPerUs = psLoop->ui32SysClock / 1000000;
+
+    psStats = &psLoop->sStats;
+    ui32Frac = 0;
+    xNextStep = xTaskGetTickCount();
+
+    for(;;)
+    {
+        //
+        // Run every step that is due.
+        //
+        xNow = xTaskGetTickCount();
+        ui32Steps = 0;
+        ui32Dropped = 0;
+        while((int32_t)(xNow - xNextStep) >= 0)
+        {
+            if(ui32Steps == GAME_MAX_CATCHUP)
+            {
+                ui32Dropped++;
+            }
+            else
+            {
+                psLoop->pfnUpdate(psLoop->pvArg);
+                ui32Steps++;
+            }
+            xNextStep += prvStepTicks(psLoop, &ui32Frac);
+        }
+
+        //
+        // Draw the result.
+        //
+        ui32Start = HWREG(GAME_DWT_CYCCNT);
+        ui32Pixels = psLoop->pfnRender(psLoop->pvArg);
+        ui32Us = (HWREG(GAME_DWT_CYCCNT) - ui32Start) / ui32CyclesPerUs;
+
+        taskENTER_CRITICAL();
+        psStats->ui32Frames++;
+        psStats->ui32Steps += ui32Steps;
+        psStats->ui32Dropped += ui32Dropped;
+        if(ui32Steps > 1)
+        {
+            psStats->ui32Late++;
+        }
+        if(ui32Us < psStats->ui32RenderMinUs)
+        {
+            psStats->ui32RenderMinUs = ui32Us;
+        }
+        if(ui32Us > psStats->ui32RenderMaxUs)
+        {
+            psStats->ui32RenderMaxUs = ui32Us;
+        }
+        psStats->ui32RenderSumUs += ui32Us;
+        if(ui32Pixels > psStats->ui32PixelsMax)
+        {
+            psStats->ui32PixelsMax = ui32Pixels;
+        }
+        psStats->ui32PixelsSum += ui32Pixels;
+        taskEXIT_CRITICAL();
+
+        //
+        // Sleep until the next step is due.
+        //
+        xNow = xTaskGetTickCount();
+        if((int32_t)(xNextStep - xNow) > 0)
+        {
+            vTaskDelay(xNextStep - xNow);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Reads a game loop's statistics.
+//!
+//! \param psLoop is the loop.
+//! \param psStats receives a consistent copy of the statistics.
+//! \param bReset is \b true to start a new measurement window.
+//!
+//! This may be called from any task while the loop runs.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+GameLoopStatsGet(tGameLoop *psLoop, tGameStats *psStats, bool bReset)
+{
+    taskENTER_CRITICAL();
+    *psStats = psLoop->sStats;
+    if(bReset)
+    {
+        prvStatsReset(&psLoop->sStats);
+    }
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,89 @@
+//*****************************************************************************
+//
+// game_loop.h - A fixed time step game loop with frame timing statistics.
+//
+//*****************************************************************************
+
+#ifndef __GAME_LOOP_H__
+#define __GAME_LOOP_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The most update steps run back to back to catch up after a slow frame.
+// Any further backlog is dropped so the game slows down instead of spending
+// ever longer catching up.
+//
+//*****************************************************************************
+#define GAME_MAX_CATCHUP        4
+
+//*****************************************************************************
+//
+// Frame statistics, accumulated since they were last reset.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Frames;        // Frames rendered
+    uint32_t ui32Steps;         // Update steps run
+    uint32_t ui32Late;          // Frames that needed more than one step
+    uint32_t ui32Dropped;       // Steps skipped after GAME_MAX_CATCHUP
+    uint32_t ui32RenderMinUs;   // Shortest render
+    uint32_t ui32RenderMaxUs;   // Longest render
+    uint32_t ui32RenderSumUs;   // Total render time, for the average
+    uint32_t ui32PixelsMax;     // Most pixels written in one frame
+    uint32_t ui32PixelsSum;     // Total pixels written
+}
+tGameStats;
+
+//*****************************************************************************
+//
+// A game loop.  pfnUpdate advances the game by exactly one step of
+// 1 / ui32StepHz seconds; pfnRender draws the current state and returns the
+// number of pixels it wrote.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32StepHz;
+    uint32_t ui32SysClock;
+    void (*pfnUpdate)(void *pvArg);
+    uint32_t (*pfnRender)(void *pvArg);
+    void *pvArg;
+    tGameStats sStats;
+}
+tGameLoop;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void GameLoopInit(tGameLoop *psLoop, uint32_t ui32StepHz,
+                         uint32_t ui32SysClock,
+                         void (*pfnUpdate)(void *pvArg),
+                         uint32_t (*pfnRender)(void *pvArg), void *pvArg);
+extern void GameLoopRun(tGameLoop *psLoop);
+extern void GameLoopStatsGet(tGameLoop *psLoop, tGameStats *psStats,
+                             bool bReset);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GAME_LOOP_H__
@@ -31,9 +31,21 @@
 
 #include "utils/uartstdio.h"
 
+#include "tile_engine.h"
+#include "game_loop.h"
+#include "game_assets.h"
+
 #define MAX_DATA_POINTS 20
 #define MAX_RANGE 100
 
+/* Sprite demo settings.  Positions and speeds are in 1/16 pixel units. */
+#define GAME_FPS            30
+#define GAME_NUM_BALLS      6
+#define GAME_NUM_SLIMES     3
+#define GAME_NUM_ACTORS     (GAME_NUM_BALLS + GAME_NUM_SLIMES)
+#define GAME_ANIM_STEPS     8
+#define GAME_STATS_MS       2000
+
 typedef struct {
     int32_t x;
     int32_t y;
@@ -44,17 +56,45 @@ typedef struct {
     tContext *pContext;
 } GraphCanvas;
 
+typedef struct {
+    tSprite *psSprite;
+    int32_t x;
+    int32_t y;
+    int32_t dx;
+    int32_t dy;
+} GameActor;
+
 static GraphCanvas g_sGraphCanvas;
 static int g_iGraphData[MAX_DATA_POINTS];
 static int g_iDataLength = 0;
 tContext ctx;
 
 extern volatile uint32_t g_ui32SysClock;
+#ifdef GRAPH_DEMO
 static void prvDisplayTask( void *params );
+#else
+/* The tile engine and game loop are large, so keep them off the stacks. */
+static tTileEngine g_sEngine;
+static tGameLoop g_sGameLoop;
+static GameActor g_sActors[GAME_NUM_ACTORS];
+static uint32_t g_ui32GameSteps;
+
+static void prvGameTask( void *params );
+static void prvGameStatsTask( void *params );
+#endif
 
 void vCreateTasks( void ){
+#ifdef GRAPH_DEMO
     xTaskCreate(prvDisplayTask, "Display", configMINIMAL_STACK_SIZE, NULL,
               tskIDLE_PRIORITY + 1, NULL);
+#else
+    /* The stats task prints over the blocking UART, so it runs below the
+     * game loop and only uses time the game does not need. */
+    xTaskCreate(prvGameTask, "Game", configMINIMAL_STACK_SIZE, NULL,
+              tskIDLE_PRIORITY + 2, NULL);
+    xTaskCreate(prvGameStatsTask, "Stats", configMINIMAL_STACK_SIZE, NULL,
+              tskIDLE_PRIORITY + 1, NULL);
+#endif
 }
 
 void drawGraphCanvas(GraphCanvas *canvas) {
@@ -113,6 +153,7 @@ void graphInit( int32_t x, int32_t y, int32_t w, int32_t h,
     g_sGraphCanvas.outlineColor = outline;
 }
 
+#ifdef GRAPH_DEMO
 static void prvDisplayTask( void *params ){
     UARTprintf("Test");
     
@@ -132,5 +173,94 @@ static void prvDisplayTask( void *params ){
         vTaskDelay(pdMS_TO_TICKS(100));
     };
 }
+#else
+/* Advances the sprite demo by one fixed step of 1 / GAME_FPS seconds. */
+static void prvGameUpdate( void *pvArg ){
+    /* Keep actors inside the brick border, in 1/16 pixel units. */
+    const int32_t xMin = TILE_SIZE * 16;
+    const int32_t yMin = TILE_SIZE * 16;
+    GameActor *actor;
+    int32_t xMax, yMax;
+
+    g_ui32GameSteps++;
+
+    for (int i = 0; i < GAME_NUM_ACTORS; i++) {
+        actor = &g_sActors[i];
+        xMax = (TILE_SCREEN_WIDTH - TILE_SIZE -
+                actor->psSprite->psImage->ui16Width) * 16;
+        yMax = (TILE_SCREEN_HEIGHT - TILE_SIZE -
+                actor->psSprite->psImage->ui16Height) * 16;
+
+        actor->x += actor->dx;
+        actor->y += actor->dy;
+        if (actor->x < xMin || actor->x > xMax) {
+            actor->dx = -actor->dx;
+            actor->x = (actor->x < xMin) ? xMin : xMax;
+        }
+        if (actor->y < yMin || actor->y > yMax) {
+            actor->dy = -actor->dy;
+            actor->y = (actor->y < yMin) ? yMin : yMax;
+        }
+        TileSpriteMove(actor->psSprite, actor->x / 16, actor->y / 16);
+
+        /* Slimes squash and stretch as they move. */
+        if (i >= GAME_NUM_BALLS) {
+            TileSpriteImageSet(actor->psSprite,
+                &g_psSpriteSlime[((g_ui32GameSteps / GAME_ANIM_STEPS) + i) & 1]);
+        }
+    }
+}
+
+static uint32_t prvGameRender( void *pvArg ){
+    return TileEngineRender(&g_sEngine);
+}
+
+static void prvGameTask( void *params ){
+    const tSpriteImage *image;
+
+    Kentec320x240x16_SSD2119Init(g_ui32SysClock);
+    GrContextInit(&ctx, &g_sKentec320x240x16_SSD2119);
+
+    TileEngineInit(&g_sEngine, g_pui16GameTiles, &g_ppui8GameMap[0][0],
+                   TileSpanWriteGrlib, (void *)&g_sKentec320x240x16_SSD2119);
+
+    for (int i = 0; i < GAME_NUM_ACTORS; i++) {
+        image = (i < GAME_NUM_BALLS) ? &g_sSpriteBall : &g_psSpriteSlime[0];
+        g_sActors[i].x = (24 + 37 * i) * 16;
+        g_sActors[i].y = (24 + 23 * i) * 16;
+        g_sActors[i].dx = 16 + 5 * i;
+        g_sActors[i].dy = (i & 1) ? -(12 + 3 * i) : (12 + 3 * i);
+        g_sActors[i].psSprite = TileSpriteAdd(&g_sEngine, image,
+                                              g_sActors[i].x / 16,
+                                              g_sActors[i].y / 16);
+    }
+
+    GameLoopInit(&g_sGameLoop, GAME_FPS, g_ui32SysClock, prvGameUpdate,
+                 prvGameRender, NULL);
+    GameLoopRun(&g_sGameLoop);
+}
+
+static void prvGameStatsTask( void *params ){
+    tGameStats stats;
+    uint32_t fps10;
+
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(GAME_STATS_MS));
+        GameLoopStatsGet(&g_sGameLoop, &stats, true);
+        if (stats.ui32Frames == 0) {
+            continue;
+        }
+
+        fps10 = (stats.ui32Frames * 10000) / GAME_STATS_MS;
+        UARTprintf("fps %u.%u render avg %u us max %u us "
+                   "px avg %u max %u late %u dropped %u\n",
+                   fps10 / 10, fps10 % 10,
+                   stats.ui32RenderSumUs / stats.ui32Frames,
+                   stats.ui32RenderMaxUs,
+                   stats.ui32PixelsSum / stats.ui32Frames,
+                   stats.ui32PixelsMax, stats.ui32Late, stats.ui32Dropped);
+    }
+}
+#endif
 
 
@@ -0,0 +1,588 @@
+//*****************************************************************************
+//
+// tile_engine.c - A tile map and sprite layer that recomposites only the
+//                 parts of the screen that change from frame to frame.
+//
+// Drawing a moving object with grlib means clearing where it was and
+// repainting everything under it, so the usual fallback is to redraw the
+// whole play area, which costs 76800 pixels (over 80 ms at the panel's SPI
+// rate) per frame.  Here the background is a map of 16x16 tiles held in
+// flash as native RGB565, and sprites are RGB565 images with an optional
+// transparent key color.  Each frame the engine compares every sprite with
+// where it was last drawn, collects the old and new areas of those that
+// changed as dirty rectangles, and rebuilds only those areas one scan line
+// at a time: tiles first, then the sprites over them, and the finished line
+// is passed to the span writer.  Nothing on screen is ever drawn twice in a
+// frame, so moving sprites do not flicker.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "grlib.h"
+#include "tile_engine.h"
+
+//*****************************************************************************
+//
+// Returns the area of a rectangle, which must not be empty.
+//
+//*****************************************************************************
+static uint32_t
+prvRectArea(const tRectangle *psRect)
+{
+    return((uint32_t)(psRect->i16XMax - psRect->i16XMin + 1) *
+           (uint32_t)(psRect->i16YMax - psRect->i16YMin + 1));
+}
+
+//*****************************************************************************
+//
+// Sets psOut to the smallest rectangle holding both psA and psB.
+//
+//*****************************************************************************
+static void
+prvRectUnion(const tRectangle *psA, const tRectangle *psB, tRectangle *psOut)
+{
+    psOut->i16XMin = (psA->i16XMin < psB->i16XMin) ? psA->i16XMin :
+                                                     psB->i16XMin;
+    psOut->i16YMin = (psA->i16YMin < psB->i16YMin) ? psA->i16YMin :
+                                                     psB->i16YMin;
+    psOut->i16XMax = (psA->i16XMax > psB->i16XMax) ? psA->i16XMax :
+                                                     psB->i16XMax;
+    psOut->i16YMax = (psA->i16YMax > psB->i16YMax) ? psA->i16YMax :
+                                                     psB->i16YMax;
+}
+
+//*****************************************************************************
+//
+// Computes the screen area a sprite covers at its current position, clipped
+// to the screen.  Returns false if none of it is on screen.
+//
+//*****************************************************************************
+static bool
+prvSpriteRect(const tSprite *psSprite, tRectangle *psRect)
+{
+    int32_t i32XMin, i32YMin, i32XMax, i32YMax;
+
+    i32XMin = psSprite->i16X;
+    i32YMin = psSprite->i16Y;
+    i32XMax = i32XMin + psSprite->psImage->ui16Width - 1;
+    i32YMax = i32YMin + psSprite->psImage->ui16Height - 1;
+
+    if(i32XMin < 0)
+    {
+        i32XMin = 0;
+    }
+    if(i32YMin < 0)
+    {
+        i32YMin = 0;
+    }
+    if(i32XMax >= TILE_SCREEN_WIDTH)
+    {
+        i32XMax = TILE_SCREEN_WIDTH - 1;
+    }
+    if(i32YMax >= TILE_SCREEN_HEIGHT)
+    {
+        i32YMax = TILE_SCREEN_HEIGHT - 1;
+    }
+    if((i32XMin > i32XMax) || (i32YMin > i32YMax))
+    {
+        return(false);
+    }
+
+    psRect->i16XMin = i32XMin;
+    psRect->i16YMin = i32YMin;
+    psRect->i16XMax = i32XMax;
+    psRect->i16YMax = i32YMax;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Adds an on-screen rectangle to the dirty list.  A new rectangle is merged
+// with any existing one when their bounding box is no bigger than the two
+// drawn separately, which catches the usual case of a sprite's old and new
+// positions overlapping.  Each merge can make the result overlap another
+// entry, so the scan restarts after one.
+//
+//*****************************************************************************
+static void
+prvDirtyAdd(tTileEngine *psEngine, const tRectangle *psRect)
+{
+    tRectangle sRect, sUnion;
+    uint32_t ui32Idx, ui32Best, ui32Growth, ui32BestGrowth;
+
+    sRect = *psRect;
+
+    ui32Idx = 0;
+    while(ui32Idx < psEngine->ui32NumDirty)
+    {
+        prvRectUnion(&psEngine->psDirty[ui32Idx], &sRect, &sUnion);
+        if(prvRectArea(&sUnion) <=
+           (prvRectArea(&psEngine->psDirty[ui32Idx]) + prvRectArea(&sRect)))
+        {
+            //
+            // Take the entry out of the list and carry on with the union.
+            //
+            sRect = sUnion;
+            psEngine->ui32NumDirty--;
+            psEngine->psDirty[ui32Idx] =
+                psEngine->psDirty[psEngine->ui32NumDirty];
+            ui32Idx = 0;
+        }
+        else
+        {
+            ui32Idx++;
+        }
+    }
+
+    if(psEngine->ui32NumDirty < TILE_MAX_DIRTY)
+    {
+        psEngine->psDirty[psEngine->ui32NumDirty++] = sRect;
+        return;
+    }
+
+    //
+    // The list is full, so grow whichever entry needs to grow least to cover
+    // the new rectangle.  Overlap with other entries is harmless; it only
+    // costs pixels drawn twice.
+    //
+    ui32Best = 0;
+    ui32BestGrowth = 0xffffffff;
+    for(ui32Idx = 0; ui32Idx < TILE_MAX_DIRTY; ui32Idx++)
+    {
+        prvRectUnion(&psEngine->psDirty[ui32Idx], &sRect, &sUnion);
+        ui32Growth = prvRectArea(&sUnion) -
+                     prvRectArea(&psEngine->psDirty[ui32Idx]);
+        if(ui32Growth < ui32BestGrowth)
+        {
+            ui32BestGrowth = ui32Growth;
+            ui32Best = ui32Idx;
+        }
+    }
+    prvRectUnion(&psEngine->psDirty[ui32Best], &sRect,
+                 &psEngine->psDirty[ui32Best]);
+}
+
+//*****************************************************************************
+//
+// Rebuilds one dirty rectangle scan line by scan line and writes it out.
+//
+//*****************************************************************************
+static void
+prvRectCompose(tTileEngine *psEngine, const tRectangle *psRect)
+{
+    const tSprite *ppsHit[TILE_MAX_SPRITES];
+    const tSprite *psSprite;
+    const tSpriteImage *psImage;
+    const uint16_t *pui16Src;
+    uint16_t *pui16Dst;
+    uint32_t ui32Idx, ui32NumHit;
+    int32_t i32X, i32Y, i32X0, i32X1, i32Count, i32Width;
+    tRectangle sRect;
+
+    //
+    // Find the sprites that touch this rectangle, keeping their order so
+    // that later sprites are drawn over earlier ones.
+    //
+    ui32NumHit = 0;
+    for(ui32Idx = 0; ui32Idx < psEngine->ui32NumSprites; ui32Idx++)
+    {
+        psSprite = &psEngine->psSprites[ui32Idx];
+        if(psSprite->bVisible && psSprite->psImage &&
+           prvSpriteRect(psSprite, &sRect) &&
+           GrRectOverlapCheck(&sRect, (tRectangle *)psRect))
+        {
+            ppsHit[ui32NumHit++] = psSprite;
+        }
+    }
+
+    i32Width = psRect->i16XMax - psRect->i16XMin + 1;
+
+    for(i32Y = psRect->i16YMin; i32Y <= psRect->i16YMax; i32Y++)
+    {
+        //
+        // Copy the background from the tiles under this part of the line.
+        //
+        for(i32X = psRect->i16XMin; i32X <= psRect->i16XMax; i32X += i32Count)
+        {
+            i32Count = TILE_SIZE - (i32X % TILE_SIZE);
+            if(i32Count > (psRect->i16XMax - i32X + 1))
+            {
+                i32Count = psRect->i16XMax - i32X + 1;
+            }
+            pui16Src = (psEngine->pui16Tiles +
+                        (psEngine->ppui8Map[i32Y / TILE_SIZE]
+                                           [i32X / TILE_SIZE] * TILE_PIXELS) +
+                        ((i32Y % TILE_SIZE) * TILE_SIZE) +
+                        (i32X % TILE_SIZE));
+            memcpy(&psEngine->pui16Line[i32X], pui16Src,
+                   i32Count * sizeof(uint16_t));
+        }
+
+        //
+        // Draw the part of each sprite that falls on this line.
+        //
+        for(ui32Idx = 0; ui32Idx < ui32NumHit; ui32Idx++)
+        {
+            psSprite = ppsHit[ui32Idx];
+            psImage = psSprite->psImage;
+            if((i32Y < psSprite->i16Y) ||
+               (i32Y >= (psSprite->i16Y + psImage->ui16Height)))
+            {
+                continue;
+            }
+
+            i32X0 = psSprite->i16X;
+            if(i32X0 < psRect->i16XMin)
+            {
+                i32X0 = psRect->i16XMin;
+            }
+            i32X1 = psSprite->i16X + psImage->ui16Width - 1;
+            if(i32X1 > psRect->i16XMax)
+            {
+                i32X1 = psRect->i16XMax;
+            }
+            if(i32X0 > i32X1)
+            {
+                continue;
+            }
+
+            pui16Src = (psImage->pui16Pixels +
+                        ((i32Y - psSprite->i16Y) * psImage->ui16Width) +
+                        (i32X0 - psSprite->i16X));
+            pui16Dst = &psEngine->pui16Line[i32X0];
+            i32Count = i32X1 - i32X0 + 1;
+
+            if(psImage->ui16Flags & SPRITE_FLAG_KEYED)
+            {
+                while(i32Count--)
+                {
+                    if(*pui16Src != psImage->ui16Key)
+                    {
+                        *pui16Dst = *pui16Src;
+                    }
+                    pui16Src++;
+                    pui16Dst++;
+                }
+            }
+            else
+            {
+                memcpy(pui16Dst, pui16Src, i32Count * sizeof(uint16_t));
+            }
+        }
+
+        psEngine->pfnSpanWrite(psEngine->pvSpanArg, psRect->i16XMin, i32Y,
+                               &psEngine->pui16Line[psRect->i16XMin],
+                               i32Width);
+        psEngine->sStats.ui32Spans++;
+    }
+
+    psEngine->sStats.ui32Rects++;
+    psEngine->sStats.ui32Pixels += prvRectArea(psRect);
+}
+
+//*****************************************************************************
+//
+//! Initializes a tile engine.
+//!
+//! \param psEngine is the engine to initialize.
+//! \param pui16Tiles is the tile set: TILE_PIXELS native RGB565 pixels per
+//! tile, in rows, one tile after another.
+//! \param pui8Map holds TILE_MAP_ROWS rows of TILE_MAP_COLS tile numbers.  It
+//! is copied, so the map can then be changed with TileMapSet().
+//! \param pfnSpanWrite writes finished scan line spans to the panel.
+//! \param pvSpanArg is passed to \e pfnSpanWrite.
+//!
+//! The whole screen is marked dirty, so the first TileEngineRender() draws it
+//! all.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TileEngineInit(tTileEngine *psEngine, const uint16_t *pui16Tiles,
+               const uint8_t *pui8Map, tTileSpanWrite pfnSpanWrite,
+               void *pvSpanArg)
+{
+    static const tRectangle sScreen =
+    {
+        0, 0, TILE_SCREEN_WIDTH - 1, TILE_SCREEN_HEIGHT - 1
+    };
+
+    memset(psEngine, 0, sizeof(tTileEngine));
+    psEngine->pfnSpanWrite = pfnSpanWrite;
+    psEngine->pvSpanArg = pvSpanArg;
+    psEngine->pui16Tiles = pui16Tiles;
+    memcpy(psEngine->ppui8Map, pui8Map, sizeof(psEngine->ppui8Map));
+
+    TileEngineInvalidate(psEngine, &sScreen);
+}
+
+//*****************************************************************************
+//
+//! Writes a span of RGB565 pixels through grlib.
+//!
+//! \param pvArg is the grlib display (a const tDisplay *).
+//! \param i32X is the X coordinate of the first pixel.
+//! \param i32Y is the Y coordinate of the span.
+//! \param pui16Pixels points to the pixels.
+//! \param i32Count is the number of pixels.
+//!
+//! grlib has no call for writing a block of native pixels, so the span is
+//! split into runs of one color and each run is drawn as a horizontal line.
+//! The colors are passed through untranslated, which is correct for displays
+//! whose native format is RGB565, such as the SSD2119.  A driver that can
+//! stream a span with one cursor setup should be given to TileEngineInit()
+//! instead where one is available, since busy tile art makes short runs.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TileSpanWriteGrlib(void *pvArg, int32_t i32X, int32_t i32Y,
+                   const uint16_t *pui16Pixels, int32_t i32Count)
+{
+    const tDisplay *psDisplay;
+    int32_t i32Run;
+
+    psDisplay = (const tDisplay *)pvArg;
+
+    while(i32Count)
+    {
+        for(i32Run = 1;
+            (i32Run < i32Count) && (pui16Pixels[i32Run] == pui16Pixels[0]);
+            i32Run++)
+        {
+        }
+
+        DpyLineDrawH(psDisplay, i32X, i32X + i32Run - 1, i32Y,
+                     pui16Pixels[0]);
+
+        i32X += i32Run;
+        pui16Pixels += i32Run;
+        i32Count -= i32Run;
+    }
+}
+
+//*****************************************************************************
+//
+//! Changes one tile of the map.
+//!
+//! \param psEngine is the engine.
+//! \param ui32Col is the map column.
+//! \param ui32Row is the map row.
+//! \param ui8Tile is the new tile number.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TileMapSet(tTileEngine *psEngine, uint32_t ui32Col, uint32_t ui32Row,
+           uint8_t ui8Tile)
+{
+    tRectangle sRect;
+
+    if((ui32Col >= TILE_MAP_COLS) || (ui32Row >= TILE_MAP_ROWS) ||
+       (psEngine->ppui8Map[ui32Row][ui32Col] == ui8Tile))
+    {
+        return;
+    }
+
+    psEngine->ppui8Map[ui32Row][ui32Col] = ui8Tile;
+
+    sRect.i16XMin = ui32Col * TILE_SIZE;
+    sRect.i16YMin = ui32Row * TILE_SIZE;
+    sRect.i16XMax = sRect.i16XMin + TILE_SIZE - 1;
+    sRect.i16YMax = sRect.i16YMin + TILE_SIZE - 1;
+    prvDirtyAdd(psEngine, &sRect);
+}
+
+//*****************************************************************************
+//
+//! Adds a sprite.
+//!
+//! \param psEngine is the engine.
+//! \param psImage is the sprite's image.
+//! \param i32X is the X coordinate of the sprite's top left corner.
+//! \param i32Y is the Y coordinate of the sprite's top left corner.
+//!
+//! Sprites are drawn in the order they are added, so later sprites appear
+//! over earlier ones.  The sprite starts out visible.
+//!
+//! \return Returns the sprite, or 0 if TILE_MAX_SPRITES are already in use.
+//
+//*****************************************************************************
+tSprite *
+TileSpriteAdd(tTileEngine *psEngine, const tSpriteImage *psImage,
+              int32_t i32X, int32_t i32Y)
+{
+    tSprite *psSprite;
+
+    if(psEngine->ui32NumSprites == TILE_MAX_SPRITES)
+    {
+        return(0);
+    }
+
+    psSprite = &psEngine->psSprites[psEngine->ui32NumSprites++];
+    psSprite->psImage = psImage;
+    psSprite->i16X = i32X;
+    psSprite->i16Y = i32Y;
+    psSprite->bVisible = true;
+    psSprite->psDrawnImage = 0;
+
+    return(psSprite);
+}
+
+//*****************************************************************************
+//
+//! Moves a sprite.
+//!
+//! \param psSprite is the sprite.
+//! \param i32X is the new X coordinate of the sprite's top left corner.
+//! \param i32Y is the new Y coordinate of the sprite's top left corner.
+//!
+//! The screen is updated by the next TileEngineRender().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TileSpriteMove(tSprite *psSprite, int32_t i32X, int32_t i32Y)
+{
+    psSprite->i16X = i32X;
+    psSprite->i16Y = i32Y;
+}
+
+//*****************************************************************************
+//
+//! Changes a sprite's image, for example to the next animation frame.
+//!
+//! \param psSprite is the sprite.
+//! \param psImage is the new image.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TileSpriteImageSet(tSprite *psSprite, const tSpriteImage *psImage)
+{
+    psSprite->psImage = psImage;
+}
+
+//*****************************************************************************
+//
+//! Shows or hides a sprite.
+//!
+//! \param psSprite is the sprite.
+//! \param bVisible is \b true to show the sprite.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TileSpriteShow(tSprite *psSprite, bool bVisible)
+{
+    psSprite->bVisible = bVisible;
+}
+
+//*****************************************************************************
+//
+//! Marks part of the screen to be redrawn by the next TileEngineRender().
+//!
+//! \param psEngine is the engine.
+//! \param psRect is the area to redraw; it is clipped to the screen.
+//!
+//! This is only needed when something other than the engine has drawn over
+//! the screen.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TileEngineInvalidate(tTileEngine *psEngine, const tRectangle *psRect)
+{
+    tRectangle sRect;
+
+    sRect.i16XMin = (psRect->i16XMin < 0) ? 0 : psRect->i16XMin;
+    sRect.i16YMin = (psRect->i16YMin < 0) ? 0 : psRect->i16YMin;
+    sRect.i16XMax = ((psRect->i16XMax >= TILE_SCREEN_WIDTH) ?
+                     (TILE_SCREEN_WIDTH - 1) : psRect->i16XMax);
+    sRect.i16YMax = ((psRect->i16YMax >= TILE_SCREEN_HEIGHT) ?
+                     (TILE_SCREEN_HEIGHT - 1) : psRect->i16YMax);
+
+    if((sRect.i16XMin <= sRect.i16XMax) && (sRect.i16YMin <= sRect.i16YMax))
+    {
+        prvDirtyAdd(psEngine, &sRect);
+    }
+}
+
+//*****************************************************************************
+//
+//! Brings the screen up to date with the map and sprites.
+//!
+//! \param psEngine is the engine.
+//!
+//! Every sprite whose image, position or visibility changed since it was
+//! last drawn adds both its old and new areas to the dirty list, then each
+//! dirty rectangle is recomposited and written out.  Counters for the frame
+//! are left in psEngine->sStats.
+//!
+//! \return Returns the number of pixels written.
+//
+//*****************************************************************************
+uint32_t
+TileEngineRender(tTileEngine *psEngine)
+{
+    tSprite *psSprite;
+    tRectangle sRect;
+    uint32_t ui32Idx;
+    bool bShown;
+
+    for(ui32Idx = 0; ui32Idx < psEngine->ui32NumSprites; ui32Idx++)
+    {
+        psSprite = &psEngine->psSprites[ui32Idx];
+
+        bShown = (psSprite->bVisible && psSprite->psImage &&
+                  prvSpriteRect(psSprite, &sRect));
+
+        //
+        // Skip sprites that look just as they did last frame.
+        //
+        if(bShown ? ((psSprite->psDrawnImage == psSprite->psImage) &&
+                     (memcmp(&psSprite->sDrawn, &sRect,
+                             sizeof(tRectangle)) == 0)) :
+                    (psSprite->psDrawnImage == 0))
+        {
+            continue;
+        }
+
+        if(psSprite->psDrawnImage)
+        {
+            prvDirtyAdd(psEngine, &psSprite->sDrawn);
+        }
+        if(bShown)
+        {
+            prvDirtyAdd(psEngine, &sRect);
+            psSprite->psDrawnImage = psSprite->psImage;
+            psSprite->sDrawn = sRect;
+        }
+        else
+        {
+            psSprite->psDrawnImage = 0;
+        }
+    }
+
+    psEngine->sStats.ui32Rects = 0;
+    psEngine->sStats.ui32Spans = 0;
+    psEngine->sStats.ui32Pixels = 0;
+
+    for(ui32Idx = 0; ui32Idx < psEngine->ui32NumDirty; ui32Idx++)
+    {
+        prvRectCompose(psEngine, &psEngine->psDirty[ui32Idx]);
+    }
+    psEngine->ui32NumDirty = 0;
+
+    return(psEngine->sStats.ui32Pixels);
+}
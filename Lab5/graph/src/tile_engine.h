@@ -0,0 +1,167 @@
+//*****************************************************************************
+//
+// tile_engine.h - A tile map and sprite layer that recomposites only the
+//                 parts of the screen that change from frame to frame.
+//
+//*****************************************************************************
+
+#ifndef __TILE_ENGINE_H__
+#define __TILE_ENGINE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Screen and map geometry.  Tiles are square; the map covers the screen.
+//
+//*****************************************************************************
+#define TILE_SCREEN_WIDTH       320
+#define TILE_SCREEN_HEIGHT      240
+#define TILE_SIZE               16
+#define TILE_PIXELS             (TILE_SIZE * TILE_SIZE)
+#define TILE_MAP_COLS           (TILE_SCREEN_WIDTH / TILE_SIZE)
+#define TILE_MAP_ROWS           (TILE_SCREEN_HEIGHT / TILE_SIZE)
+
+//*****************************************************************************
+//
+// Engine limits.  When more than TILE_MAX_DIRTY separate regions change in
+// one frame, further regions are merged into whichever one grows least.
+//
+//*****************************************************************************
+#define TILE_MAX_SPRITES        16
+#define TILE_MAX_DIRTY          16
+
+//*****************************************************************************
+//
+// Packs 8-bit red, green and blue components into a native RGB565 pixel.
+//
+//*****************************************************************************
+#define TILE_RGB565(r, g, b)                                                  \
+        ((uint16_t)((((r) & 0xf8) << 8) | (((g) & 0xfc) << 3) | ((b) >> 3)))
+
+//*****************************************************************************
+//
+// Sprite image flags.
+//
+//*****************************************************************************
+#define SPRITE_FLAG_KEYED       0x0001  // Pixels equal to ui16Key are skipped
+
+//*****************************************************************************
+//
+// Writes one horizontal span of native RGB565 pixels to the panel.  The
+// pixels run left to right from (i32X, i32Y) and always lie on screen.
+//
+//*****************************************************************************
+typedef void (*tTileSpanWrite)(void *pvArg, int32_t i32X, int32_t i32Y,
+                               const uint16_t *pui16Pixels, int32_t i32Count);
+
+//*****************************************************************************
+//
+// A sprite's pixels, normally a const table in flash.  Pixels are native
+// RGB565 in rows from the top left corner.
+//
+//*****************************************************************************
+typedef struct
+{
+    const uint16_t *pui16Pixels;
+    uint16_t ui16Width;
+    uint16_t ui16Height;
+    uint16_t ui16Key;
+    uint16_t ui16Flags;
+}
+tSpriteImage;
+
+//*****************************************************************************
+//
+// One sprite.  The application changes the image, position and visibility
+// through the TileSprite*() calls; the engine remembers where the sprite was
+// last drawn so it knows which screen area to repair.
+//
+//*****************************************************************************
+typedef struct
+{
+    const tSpriteImage *psImage;
+    int16_t i16X;
+    int16_t i16Y;
+    bool bVisible;
+    const tSpriteImage *psDrawnImage;
+    tRectangle sDrawn;
+}
+tSprite;
+
+//*****************************************************************************
+//
+// Counters describing the most recent TileEngineRender() call.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Rects;
+    uint32_t ui32Spans;
+    uint32_t ui32Pixels;
+}
+tTileFrameStats;
+
+//*****************************************************************************
+//
+// The engine state.  It is large (the scan line buffer alone is 640 bytes),
+// so it should be static rather than on a task stack.
+//
+//*****************************************************************************
+typedef struct
+{
+    tTileSpanWrite pfnSpanWrite;
+    void *pvSpanArg;
+    const uint16_t *pui16Tiles;
+    uint8_t ppui8Map[TILE_MAP_ROWS][TILE_MAP_COLS];
+    tSprite psSprites[TILE_MAX_SPRITES];
+    uint32_t ui32NumSprites;
+    tRectangle psDirty[TILE_MAX_DIRTY];
+    uint32_t ui32NumDirty;
+    tTileFrameStats sStats;
+    uint16_t pui16Line[TILE_SCREEN_WIDTH];
+}
+tTileEngine;
+
+//*****************************************************************************
+//
+// Prototypes.
+//
+//*****************************************************************************
+extern void TileEngineInit(tTileEngine *psEngine, const uint16_t *pui16Tiles,
+                           const uint8_t *pui8Map,
+                           tTileSpanWrite pfnSpanWrite, void *pvSpanArg);
+extern void TileSpanWriteGrlib(void *pvArg, int32_t i32X, int32_t i32Y,
+                               const uint16_t *pui16Pixels, int32_t i32Count);
+extern void TileMapSet(tTileEngine *psEngine, uint32_t ui32Col,
+                       uint32_t ui32Row, uint8_t ui8Tile);
+extern tSprite *TileSpriteAdd(tTileEngine *psEngine,
+                              const tSpriteImage *psImage, int32_t i32X,
+                              int32_t i32Y);
+extern void TileSpriteMove(tSprite *psSprite, int32_t i32X, int32_t i32Y);
+extern void TileSpriteImageSet(tSprite *psSprite,
+                               const tSpriteImage *psImage);
+extern void TileSpriteShow(tSprite *psSprite, bool bVisible);
+extern void TileEngineInvalidate(tTileEngine *psEngine,
+                                 const tRectangle *psRect);
+extern uint32_t TileEngineRender(tTileEngine *psEngine);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TILE_ENGINE_H__
@@ -0,0 +1,61 @@
+//*****************************************************************************
+//
+// FreeRTOS.h - Host stand in for the FreeRTOS kernel header.
+//
+// A host build has one thread and no scheduler.  This and the task.h and
+// semphr.h beside it give the firmware the part of the FreeRTOS API its
+// drivers use, implemented in hal_rtos.c on top of the virtual clock: a
+// delay moves the clock on, and a blocking take runs simulated events until
+// an interrupt handler gives the semaphore or the timeout passes.
+//
+//*****************************************************************************
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hal.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Types and constants, as in the ARM_CM4F port.
+//
+//*****************************************************************************
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFAIL                  pdFALSE
+#define pdPASS                  pdTRUE
+
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ      1000
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs)                                              \
+        ((TickType_t)(((TickType_t)(xTimeInMs) *                              \
+                       (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+
+//
+// The priority above which interrupts may not call the FromISR functions,
+// as configured for the target.  Priorities are accepted and ignored.
+//
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY                                  \
+                                (5 << 5)
+
+#define portYIELD_FROM_ISR(x)   ((void)(x))
+#define portEND_SWITCHING_ISR(x)                                              \
+                                ((void)(x))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INC_FREERTOS_H
@@ -0,0 +1,241 @@
+//*****************************************************************************
+//
+// hal.h - Simulated TM4C129 peripherals for building the lab firmware on a
+//         host.
+//
+// Every 4 KB peripheral block the firmware touches is backed by a register
+// file.  A block can carry a behaviour model, a set of callbacks that give
+// its registers their hardware meaning: a GPIO DATA alias that only changes
+// the masked pins, an SSI status register that follows the shift register,
+// an I2C master that talks to simulated devices.  Blocks without a model
+// behave as plain memory.  HalInit() attaches the built in models for the
+// TM4C1294.
+//
+// Time is a virtual cycle count at the simulated system clock.  Each
+// register access costs HAL_ACCESS_CYCLES, each mocked driverlib call
+// HAL_CALL_CYCLES more, and delays and blocking FreeRTOS calls move it on.
+// Models schedule events on it (a timer timeout, the end of an I2C byte),
+// and raise interrupts that are delivered to the registered handlers as
+// soon as the firmware is not masking them.  The DWT cycle counter reads the
+// virtual count, so code timed with cycle_counter.h reports simulated cycles
+// on the host.
+//
+// Register accesses are counted per block, for the report printed by
+// HalReportPrint().
+//
+// There are two ways into the register files:
+//
+// - The driverlib calls, which are reimplemented here on top of
+//   HalRegRead() and HalRegWrite().  These are exact: every write reaches
+//   the model, and reads with side effects (popping a receive FIFO) happen.
+//
+// - HWREG() and friends, which the host inc/hw_types.h maps to
+//   HalRegAccess().  C cannot tell a read of *p from a write, so the access
+//   returns a pointer to the register and the HAL compares the value at the
+//   next access.  A change is passed to the model as a write.  This is exact
+//   for registers that hold a value (configuration, GPIO data, counters) but
+//   misses a direct write of the value a register already holds, and a
+//   direct read has no side effect.  A write only takes effect at the next
+//   HAL entry, so a loop that writes a register and then waits on a variable
+//   must call HalSync().
+//
+//*****************************************************************************
+
+#ifndef __HAL_H__
+#define __HAL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Sizes and costs.
+//
+//*****************************************************************************
+#define HAL_PAGE_SIZE           0x1000
+#define HAL_MAX_PAGES           64
+#define HAL_MAX_EVENTS          32
+#define HAL_NUM_VECTORS         256
+
+#define HAL_FOREVER             UINT64_MAX  // HalStep() limit with no limit
+
+#define HAL_ACCESS_CYCLES       2       // One peripheral load or store
+#define HAL_CALL_CYCLES         6       // Call and argument set up
+
+//*****************************************************************************
+//
+// A simulated peripheral block and its behaviour model.
+//
+// pfnRead is called before every access to a register, to bring the stored
+// value up to date (a status register computed from the virtual time).
+// pfnWrite is called after a write with the value the register held before
+// it.  pfnReadStrobe is called after an exact read (HalRegRead()) for
+// registers whose reads have side effects.  Any of them may be 0.  The
+// offset is the byte offset of the register in the block.
+//
+//*****************************************************************************
+typedef struct HalPeriph HalPeriph_t;
+
+typedef struct
+{
+    void (*pfnRead)(HalPeriph_t *psPeriph, uint32_t ui32Offset);
+    void (*pfnWrite)(HalPeriph_t *psPeriph, uint32_t ui32Offset,
+                     uint32_t ui32Old);
+    void (*pfnReadStrobe)(HalPeriph_t *psPeriph, uint32_t ui32Offset);
+}
+HalModel_t;
+
+struct HalPeriph
+{
+    uint32_t ui32Base;
+    const char *pcName;
+    const HalModel_t *psModel;
+    void *pvState;
+    uint32_t ui32Accesses;
+    uint32_t ui32Writes;
+    uint32_t pui32Regs[HAL_PAGE_SIZE / 4];
+};
+
+//
+// The register at a byte offset in a block.
+//
+#define HAL_REG(psPeriph, ui32Offset)                                         \
+        ((psPeriph)->pui32Regs[(ui32Offset) / 4])
+
+//*****************************************************************************
+//
+// An event on the virtual clock.  Events are keyed by block and function;
+// scheduling one that is already pending moves it.
+//
+//*****************************************************************************
+typedef void (*HalEventFn_t)(HalPeriph_t *psPeriph);
+
+//*****************************************************************************
+//
+// A device on a simulated I2C bus.  pfnStart is called when the device is
+// addressed, pfnWrite with each byte the master sends (return false to
+// NACK it), pfnRead for each byte the master receives and pfnStop at the
+// stop condition.  pvDev is passed back to each.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t ui8Addr;
+    void (*pfnStart)(void *pvDev, bool bRead);
+    bool (*pfnWrite)(void *pvDev, uint8_t ui8Data);
+    uint8_t (*pfnRead)(void *pvDev);
+    void (*pfnStop)(void *pvDev);
+    void *pvDev;
+}
+HalI2cDevice_t;
+
+//*****************************************************************************
+//
+// A simulated OPT3001 ambient light sensor.
+//
+//*****************************************************************************
+typedef struct
+{
+    HalI2cDevice_t sI2c;
+    uint16_t pui16Regs[4];
+    uint8_t ui8Pointer;
+    uint8_t ui8Byte;
+    uint8_t ui8Msb;
+    uint32_t ui32CentiLux;
+    uint64_t ui64ConvStart;
+    uint64_t ui64LuxSince;
+    uint64_t ui64LuxSum;
+}
+HalOpt3001_t;
+
+//*****************************************************************************
+//
+// Prototypes for the core.
+//
+//*****************************************************************************
+extern void HalInit(uint32_t ui32SysClock);
+extern HalPeriph_t *HalPeriphGet(uint32_t ui32Addr);
+extern void HalModelSet(uint32_t ui32Base, const char *pcName,
+                        const HalModel_t *psModel, void *pvState);
+extern void HalAliasAdd(uint32_t ui32Alias, uint32_t ui32Base);
+extern volatile void *HalRegAccess(uint32_t ui32Addr);
+extern uint32_t HalRegRead(uint32_t ui32Addr);
+extern void HalRegWrite(uint32_t ui32Addr, uint32_t ui32Value);
+extern void HalSync(void);
+
+extern uint32_t HalClockGet(void);
+extern void HalClockSet(uint32_t ui32SysClock);
+extern uint64_t HalCyclesGet(void);
+extern void HalCyclesAdd(uint64_t ui64Cycles);
+extern bool HalStep(uint64_t ui64Until);
+extern void HalEventSet(HalPeriph_t *psPeriph, HalEventFn_t pfnEvent,
+                        uint64_t ui64When);
+extern void HalEventCancel(HalPeriph_t *psPeriph, HalEventFn_t pfnEvent);
+
+extern void HalIrqRegister(uint32_t ui32Int, void (*pfnHandler)(void));
+extern void HalIrqEnable(uint32_t ui32Int, bool bEnable);
+extern void HalIrqRaise(uint32_t ui32Int);
+extern bool HalIrqMask(bool bMask);
+extern void HalCriticalEnter(void);
+extern void HalCriticalExit(void);
+
+extern void HalCountersReset(void);
+extern void HalReportPrint(const char *pcTitle);
+
+//*****************************************************************************
+//
+// Prototypes for the models.  The ...Attach() functions are called by
+// HalInit().
+//
+//*****************************************************************************
+extern void HalCoreAttach(void);
+extern void HalSysCtlAttach(void);
+extern void HalGpioAttach(void);
+extern void HalUdmaAttach(void);
+extern void HalSsiAttach(void);
+extern void HalI2cAttach(void);
+extern void HalTimerAttach(void);
+
+extern uint8_t HalGpioLevelGet(uint32_t ui32Base);
+extern void HalGpioInputSet(uint32_t ui32Base, uint8_t ui8Pins,
+                            uint8_t ui8Level);
+extern uint32_t HalGpioEdgesGet(uint32_t ui32Base, uint8_t ui8Pin);
+extern void HalGpioWatch(uint32_t ui32Base,
+                         void (*pfnChange)(uint32_t ui32Base,
+                                           uint8_t ui8Changed,
+                                           uint8_t ui8Level, void *pvArg),
+                         void *pvArg);
+extern void HalSsiDeviceSet(uint32_t ui32Base,
+                            uint16_t (*pfnXfer)(void *pvDev, uint16_t ui16Tx),
+                            void *pvDev);
+extern uint32_t HalSsiFramesGet(uint32_t ui32Base);
+extern void HalUdmaPeripheralSet(uint32_t ui32Channel, HalPeriph_t *psPeriph,
+                                 HalEventFn_t pfnRequest);
+extern bool HalUdmaRequest(uint32_t ui32Channel, uint32_t *pui32Data,
+                           bool *pbDone);
+extern bool HalI2cDeviceAdd(uint32_t ui32Base, HalI2cDevice_t *psDev);
+extern uint32_t HalI2cBytesGet(uint32_t ui32Base);
+extern void HalOpt3001Init(HalOpt3001_t *psDev, uint8_t ui8Addr);
+extern void HalOpt3001LuxSet(HalOpt3001_t *psDev, uint32_t ui32CentiLux);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HAL_H__
@@ -0,0 +1,58 @@
+//*****************************************************************************
+//
+// hw_types.h - Host replacement for the TivaWare register access macros.
+//
+// This directory is put ahead of the TivaWare tree on the include path of a
+// host build, so every HWREG() in the firmware and in the TivaWare headers
+// goes to the simulated register files in hal.c instead of dereferencing a
+// device address.  See hal.h for what that can and cannot model.
+//
+// The bit-band macros keep their address arithmetic; the HAL recognises the
+// alias region and turns the access into a read-modify-write of the bit.
+//
+//*****************************************************************************
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdint.h>
+#include "hal.h"
+
+//*****************************************************************************
+//
+// Register access.
+//
+//*****************************************************************************
+#define HWREG(x)                                                              \
+        (*((volatile uint32_t *)HalRegAccess((uint32_t)(x))))
+#define HWREGH(x)                                                             \
+        (*((volatile uint16_t *)HalRegAccess((uint32_t)(x))))
+#define HWREGB(x)                                                             \
+        (*((volatile uint8_t *)HalRegAccess((uint32_t)(x))))
+#define HWREGBITW(x, b)                                                       \
+        HWREG(((uint32_t)(x) & 0xF0000000) | 0x02000000 |                     \
+              (((uint32_t)(x) & 0x000FFFFF) << 5) | ((b) << 2))
+#define HWREGBITH(x, b)                                                       \
+        HWREGH(((uint32_t)(x) & 0xF0000000) | 0x02000000 |                    \
+               (((uint32_t)(x) & 0x000FFFFF) << 5) | ((b) << 2))
+#define HWREGBITB(x, b)                                                       \
+        HWREGB(((uint32_t)(x) & 0xF0000000) | 0x02000000 |                    \
+               (((uint32_t)(x) & 0x000FFFFF) << 5) | ((b) << 2))
+
+//*****************************************************************************
+//
+// The device class and revision.  The host simulates a TM4C1294 at revision
+// A2, the part the firmware is built for (TARGET_IS_TM4C129_RA2).
+//
+//*****************************************************************************
+#define CLASS_IS_TM4C123        0
+#define CLASS_IS_TM4C129        1
+
+#define REVISION_IS_A0          0
+#define REVISION_IS_A1          0
+#define REVISION_IS_A2          1
+#define REVISION_IS_B0          0
+#define REVISION_IS_B1          0
+#define REVISION_IS_B2          0
+
+#endif // __HW_TYPES_H__
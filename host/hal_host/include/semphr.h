@@ -0,0 +1,53 @@
+//*****************************************************************************
+//
+// semphr.h - Host stand in for the FreeRTOS semaphore API.  See FreeRTOS.h.
+//
+// Binary and counting semaphores only; a mutex is a binary semaphore that
+// starts given, which is all one thread needs.
+//
+//*****************************************************************************
+
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct HalSemaphore *SemaphoreHandle_t;
+
+#define xSemaphoreCreateBinary()                                              \
+                                xHalSemaphoreCreate(1, 0)
+#define xSemaphoreCreateCounting(uxMaxCount, uxInitialCount)                  \
+                                xHalSemaphoreCreate((uxMaxCount),             \
+                                                    (uxInitialCount))
+#define xSemaphoreCreateMutex() xHalSemaphoreCreate(1, 1)
+#define xSemaphoreTake(xSemaphore, xBlockTime)                                \
+                                xHalSemaphoreTake((xSemaphore), (xBlockTime))
+#define xSemaphoreGive(xSemaphore)                                            \
+                                xHalSemaphoreGive((xSemaphore), 0)
+#define xSemaphoreGiveFromISR(xSemaphore, pxHigherPriorityTaskWoken)          \
+                                xHalSemaphoreGive((xSemaphore),               \
+                                                  (pxHigherPriorityTaskWoken))
+#define uxSemaphoreGetCount(xSemaphore)                                       \
+                                uxHalSemaphoreCount(xSemaphore)
+#define vSemaphoreDelete(xSemaphore)                                          \
+                                vHalSemaphoreDelete(xSemaphore)
+
+extern SemaphoreHandle_t xHalSemaphoreCreate(UBaseType_t uxMaxCount,
+                                             UBaseType_t uxInitialCount);
+extern BaseType_t xHalSemaphoreTake(SemaphoreHandle_t xSemaphore,
+                                    TickType_t xBlockTime);
+extern BaseType_t xHalSemaphoreGive(SemaphoreHandle_t xSemaphore,
+                                    BaseType_t *pxHigherPriorityTaskWoken);
+extern UBaseType_t uxHalSemaphoreCount(SemaphoreHandle_t xSemaphore);
+extern void vHalSemaphoreDelete(SemaphoreHandle_t xSemaphore);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEMAPHORE_H
@@ -0,0 +1,48 @@
+//*****************************************************************************
+//
+// task.h - Host stand in for the FreeRTOS task API.  See FreeRTOS.h.
+//
+//*****************************************************************************
+
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef void *TaskHandle_t;
+
+#define taskSCHEDULER_SUSPENDED ((BaseType_t)0)
+#define taskSCHEDULER_NOT_STARTED                                             \
+                                ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING   ((BaseType_t)2)
+
+//
+// Critical sections hold off the simulated interrupts.
+//
+#define taskENTER_CRITICAL()    HalCriticalEnter()
+#define taskEXIT_CRITICAL()     HalCriticalExit()
+#define taskENTER_CRITICAL_FROM_ISR()                                         \
+                                (HalCriticalEnter(), 0)
+#define taskEXIT_CRITICAL_FROM_ISR(x)                                         \
+                                ((void)(x), HalCriticalExit())
+#define taskDISABLE_INTERRUPTS()                                              \
+                                ((void)HalIrqMask(true))
+#define taskENABLE_INTERRUPTS() ((void)HalIrqMask(false))
+#define taskYIELD()             HalSync()
+
+extern void vTaskDelay(const TickType_t xTicksToDelay);
+extern TickType_t xTaskGetTickCount(void);
+extern TickType_t xTaskGetTickCountFromISR(void);
+extern BaseType_t xTaskGetSchedulerState(void);
+extern void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INC_TASK_H
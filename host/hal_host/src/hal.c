@@ -0,0 +1,850 @@
+//*****************************************************************************
+//
+// hal.c - Register files, virtual clock and interrupt delivery of the host
+//         HAL.
+//
+// See hal.h for the model.  Everything here runs on the one host thread:
+// interrupt handlers are called directly when an interrupt is raised and
+// nothing masks it, and an access that happens inside another (a model
+// raising an interrupt while it handles a write) only pends it until the
+// HAL is left.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal.h"
+
+//*****************************************************************************
+//
+// The peripheral bit-band alias region, and the region it maps.
+//
+//*****************************************************************************
+#define HAL_BITBAND_ALIAS       0x42000000
+#define HAL_BITBAND_END         0x44000000
+#define HAL_BITBAND_BASE        0x40000000
+
+#define HAL_MAX_ALIASES         16
+
+//*****************************************************************************
+//
+// The register files.  g_psHalLast caches the last block found.
+//
+//*****************************************************************************
+static HalPeriph_t g_psHalPages[HAL_MAX_PAGES];
+static uint32_t g_ui32HalNumPages;
+static HalPeriph_t *g_psHalLast;
+
+static struct
+{
+    uint32_t ui32Alias;
+    uint32_t ui32Base;
+}
+g_psHalAliases[HAL_MAX_ALIASES];
+static uint32_t g_ui32HalNumAliases;
+
+//*****************************************************************************
+//
+// The HWREG() access whose write, if any, has not been seen yet.  For a
+// bit-band access the register is ui32Offset in psPeriph and the bit value
+// is in g_ui32HalBitCell.
+//
+//*****************************************************************************
+static struct
+{
+    HalPeriph_t *psPeriph;
+    uint32_t ui32Offset;
+    uint32_t ui32Old;
+    int32_t i32Bit;
+}
+g_sHalPending;
+
+static uint32_t g_ui32HalBitCell;
+
+//*****************************************************************************
+//
+// Virtual time.
+//
+//*****************************************************************************
+static uint32_t g_ui32HalSysClock;
+static uint64_t g_ui64HalCycles;
+
+static struct
+{
+    HalPeriph_t *psPeriph;
+    HalEventFn_t pfnEvent;
+    uint64_t ui64When;
+}
+g_psHalEvents[HAL_MAX_EVENTS];
+static uint32_t g_ui32HalNumEvents;
+
+//*****************************************************************************
+//
+// Interrupts.  g_ui32HalDepth counts nested HAL entries; interrupts are only
+// delivered at depth 0, outside any handler, critical section or PRIMASK.
+//
+//*****************************************************************************
+static void (*g_ppfnHalVectors[HAL_NUM_VECTORS])(void);
+static bool g_pbHalIrqEnabled[HAL_NUM_VECTORS];
+static bool g_pbHalIrqPending[HAL_NUM_VECTORS];
+static uint32_t g_pui32HalIrqCount[HAL_NUM_VECTORS];
+static bool g_bHalPrimask;
+static uint32_t g_ui32HalCritical;
+static bool g_bHalInIsr;
+static uint32_t g_ui32HalDepth;
+
+static void prvIrqDeliver(void);
+
+//*****************************************************************************
+//
+// Stops the program on a use of the HAL it cannot simulate.
+//
+//*****************************************************************************
+static void
+prvFatal(const char *pcWhat, uint32_t ui32Val)
+{
+    fprintf(stderr, "hal: %s 0x%08x\n", pcWhat, (unsigned)ui32Val);
+    abort();
+}
+
+//*****************************************************************************
+//
+// Returns the block holding an address, creating a plain one on first use.
+//
+//*****************************************************************************
+static HalPeriph_t *
+prvPageGet(uint32_t ui32Addr)
+{
+    uint32_t ui32Base, ui32Idx;
+    HalPeriph_t *psPeriph;
+
+    ui32Base = ui32Addr & ~(HAL_PAGE_SIZE - 1);
+    if(g_psHalLast && (g_psHalLast->ui32Base == ui32Base))
+    {
+        return(g_psHalLast);
+    }
+
+    for(ui32Idx = 0; ui32Idx < g_ui32HalNumAliases; ui32Idx++)
+    {
+        if(g_psHalAliases[ui32Idx].ui32Alias == ui32Base)
+        {
+            ui32Base = g_psHalAliases[ui32Idx].ui32Base;
+            break;
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < g_ui32HalNumPages; ui32Idx++)
+    {
+        if(g_psHalPages[ui32Idx].ui32Base == ui32Base)
+        {
+            g_psHalLast = &g_psHalPages[ui32Idx];
+            return(g_psHalLast);
+        }
+    }
+
+    if(g_ui32HalNumPages == HAL_MAX_PAGES)
+    {
+        prvFatal("out of register pages at", ui32Addr);
+    }
+    psPeriph = &g_psHalPages[g_ui32HalNumPages++];
+    memset(psPeriph, 0, sizeof(*psPeriph));
+    psPeriph->ui32Base = ui32Base;
+    psPeriph->pcName = "?";
+    g_psHalLast = psPeriph;
+
+    return(psPeriph);
+}
+
+//*****************************************************************************
+//
+// Hands a changed register to its model.
+//
+//*****************************************************************************
+static void
+prvWrite(HalPeriph_t *psPeriph, uint32_t ui32Offset, uint32_t ui32Old)
+{
+    psPeriph->ui32Writes++;
+    if(psPeriph->psModel && psPeriph->psModel->pfnWrite)
+    {
+        psPeriph->psModel->pfnWrite(psPeriph, ui32Offset, ui32Old);
+    }
+}
+
+static void
+prvRead(HalPeriph_t *psPeriph, uint32_t ui32Offset)
+{
+    if(psPeriph->psModel && psPeriph->psModel->pfnRead)
+    {
+        psPeriph->psModel->pfnRead(psPeriph, ui32Offset);
+    }
+}
+
+//*****************************************************************************
+//
+// Completes the pending HWREG() access: if the register changed, it was
+// written.
+//
+//*****************************************************************************
+static void
+prvFlush(void)
+{
+    HalPeriph_t *psPeriph = g_sHalPending.psPeriph;
+    uint32_t ui32Offset = g_sHalPending.ui32Offset;
+    uint32_t ui32Old = g_sHalPending.ui32Old;
+    uint32_t ui32Mask;
+
+    if(!psPeriph)
+    {
+        return;
+    }
+    g_sHalPending.psPeriph = 0;
+
+    g_ui32HalDepth++;
+    if(g_sHalPending.i32Bit >= 0)
+    {
+        if((g_ui32HalBitCell & 1) != ((ui32Old >> g_sHalPending.i32Bit) & 1))
+        {
+            ui32Mask = 1u << g_sHalPending.i32Bit;
+            HAL_REG(psPeriph, ui32Offset) =
+                (ui32Old & ~ui32Mask) | ((g_ui32HalBitCell & 1) ?
+                                         ui32Mask : 0);
+            prvWrite(psPeriph, ui32Offset, ui32Old);
+        }
+    }
+    else if(HAL_REG(psPeriph, ui32Offset) != ui32Old)
+    {
+        prvWrite(psPeriph, ui32Offset, ui32Old);
+    }
+    g_ui32HalDepth--;
+}
+
+//*****************************************************************************
+//
+//! Resets the HAL and attaches the TM4C1294 models.
+//!
+//! \param ui32SysClock is the simulated system clock in Hz.
+//!
+//! All registers read 0 and the virtual clock restarts at 0.  Devices and
+//! interrupt handlers must be added again afterwards.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalInit(uint32_t ui32SysClock)
+{
+    memset(g_psHalPages, 0, sizeof(g_psHalPages));
+    g_ui32HalNumPages = 0;
+    g_psHalLast = 0;
+    g_ui32HalNumAliases = 0;
+    memset(&g_sHalPending, 0, sizeof(g_sHalPending));
+    g_ui64HalCycles = 0;
+    g_ui32HalNumEvents = 0;
+    memset(g_ppfnHalVectors, 0, sizeof(g_ppfnHalVectors));
+    memset(g_pbHalIrqEnabled, 0, sizeof(g_pbHalIrqEnabled));
+    memset(g_pbHalIrqPending, 0, sizeof(g_pbHalIrqPending));
+    memset(g_pui32HalIrqCount, 0, sizeof(g_pui32HalIrqCount));
+    g_bHalPrimask = false;
+    g_ui32HalCritical = 0;
+    g_bHalInIsr = false;
+    g_ui32HalDepth = 0;
+
+    HalClockSet(ui32SysClock);
+
+    HalCoreAttach();
+    HalSysCtlAttach();
+    HalGpioAttach();
+    HalUdmaAttach();
+    HalSsiAttach();
+    HalI2cAttach();
+    HalTimerAttach();
+}
+
+//*****************************************************************************
+//
+//! Returns the block that holds an address.
+//!
+//! \param ui32Addr is any address in the block.
+//!
+//! \return Returns the block, created with no model if it is new.
+//
+//*****************************************************************************
+HalPeriph_t *
+HalPeriphGet(uint32_t ui32Addr)
+{
+    return(prvPageGet(ui32Addr));
+}
+
+//*****************************************************************************
+//
+//! Attaches a behaviour model to a block.
+//!
+//! \param ui32Base is the base address of the block.
+//! \param pcName names the block in the report.
+//! \param psModel is the model, or 0 for plain memory.
+//! \param pvState is the model's state, available as psPeriph->pvState.
+//!
+//! A later call replaces the model, so a test can swap in its own.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalModelSet(uint32_t ui32Base, const char *pcName, const HalModel_t *psModel,
+            void *pvState)
+{
+    HalPeriph_t *psPeriph = prvPageGet(ui32Base);
+
+    psPeriph->pcName = pcName;
+    psPeriph->psModel = psModel;
+    psPeriph->pvState = pvState;
+}
+
+//*****************************************************************************
+//
+//! Makes a second address range reach a block.
+//!
+//! \param ui32Alias is the base of the second range.
+//! \param ui32Base is the base of the block.
+//!
+//! Used for the GPIO ports, which appear on both the APB and AHB buses.
+//! Must be called before the alias is first used.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalAliasAdd(uint32_t ui32Alias, uint32_t ui32Base)
+{
+    if(g_ui32HalNumAliases == HAL_MAX_ALIASES)
+    {
+        prvFatal("out of aliases at", ui32Alias);
+    }
+    g_psHalAliases[g_ui32HalNumAliases].ui32Alias = ui32Alias;
+    g_psHalAliases[g_ui32HalNumAliases].ui32Base = ui32Base;
+    g_ui32HalNumAliases++;
+}
+
+//*****************************************************************************
+//
+//! Starts an access through HWREG(), HWREGH() or HWREGB().
+//!
+//! \param ui32Addr is the address of the register, or of a bit in the
+//! peripheral bit-band alias region.
+//!
+//! The previous HWREG() access is completed first.  See hal.h for how the
+//! write, if this turns out to be one, is found.
+//!
+//! \return Returns a pointer to the byte of the register file at ui32Addr.
+//
+//*****************************************************************************
+volatile void *
+HalRegAccess(uint32_t ui32Addr)
+{
+    HalPeriph_t *psPeriph;
+    uint32_t ui32Offset, ui32Bit;
+    volatile void *pvCell;
+
+    prvFlush();
+    prvIrqDeliver();
+
+    g_ui32HalDepth++;
+    HalCyclesAdd(HAL_ACCESS_CYCLES);
+
+    if((ui32Addr >= HAL_BITBAND_ALIAS) && (ui32Addr < HAL_BITBAND_END))
+    {
+        ui32Bit = ((ui32Addr - HAL_BITBAND_ALIAS) >> 2) & 31;
+        ui32Addr = HAL_BITBAND_BASE + (((ui32Addr - HAL_BITBAND_ALIAS) >> 5) &
+                                       ~3u);
+        psPeriph = prvPageGet(ui32Addr);
+        ui32Offset = ui32Addr & (HAL_PAGE_SIZE - 4);
+        prvRead(psPeriph, ui32Offset);
+        g_ui32HalBitCell = (HAL_REG(psPeriph, ui32Offset) >> ui32Bit) & 1;
+        g_sHalPending.i32Bit = (int32_t)ui32Bit;
+        pvCell = &g_ui32HalBitCell;
+    }
+    else
+    {
+        psPeriph = prvPageGet(ui32Addr);
+        ui32Offset = ui32Addr & (HAL_PAGE_SIZE - 4);
+        prvRead(psPeriph, ui32Offset);
+        g_sHalPending.i32Bit = -1;
+        pvCell = (volatile uint8_t *)&HAL_REG(psPeriph, ui32Offset) +
+                 (ui32Addr & 3);
+    }
+
+    psPeriph->ui32Accesses++;
+    g_sHalPending.psPeriph = psPeriph;
+    g_sHalPending.ui32Offset = ui32Offset;
+    g_sHalPending.ui32Old = HAL_REG(psPeriph, ui32Offset);
+
+    g_ui32HalDepth--;
+    return(pvCell);
+}
+
+//*****************************************************************************
+//
+//! Reads a register, with its side effects.
+//!
+//! \param ui32Addr is the address of the register.
+//!
+//! \return Returns the value of the register.
+//
+//*****************************************************************************
+uint32_t
+HalRegRead(uint32_t ui32Addr)
+{
+    HalPeriph_t *psPeriph;
+    uint32_t ui32Offset, ui32Val;
+
+    prvFlush();
+
+    g_ui32HalDepth++;
+    HalCyclesAdd(HAL_ACCESS_CYCLES);
+    psPeriph = prvPageGet(ui32Addr);
+    ui32Offset = ui32Addr & (HAL_PAGE_SIZE - 4);
+    prvRead(psPeriph, ui32Offset);
+    ui32Val = HAL_REG(psPeriph, ui32Offset);
+    psPeriph->ui32Accesses++;
+    if(psPeriph->psModel && psPeriph->psModel->pfnReadStrobe)
+    {
+        psPeriph->psModel->pfnReadStrobe(psPeriph, ui32Offset);
+    }
+    g_ui32HalDepth--;
+
+    prvIrqDeliver();
+    return(ui32Val);
+}
+
+//*****************************************************************************
+//
+//! Writes a register.
+//!
+//! \param ui32Addr is the address of the register.
+//! \param ui32Value is the value to write.
+//!
+//! The model sees the write even if the register already held the value.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalRegWrite(uint32_t ui32Addr, uint32_t ui32Value)
+{
+    HalPeriph_t *psPeriph;
+    uint32_t ui32Offset, ui32Old;
+
+    prvFlush();
+
+    g_ui32HalDepth++;
+    HalCyclesAdd(HAL_ACCESS_CYCLES);
+    psPeriph = prvPageGet(ui32Addr);
+    ui32Offset = ui32Addr & (HAL_PAGE_SIZE - 4);
+    ui32Old = HAL_REG(psPeriph, ui32Offset);
+    HAL_REG(psPeriph, ui32Offset) = ui32Value;
+    psPeriph->ui32Accesses++;
+    prvWrite(psPeriph, ui32Offset, ui32Old);
+    g_ui32HalDepth--;
+
+    prvIrqDeliver();
+}
+
+//*****************************************************************************
+//
+//! Completes the last HWREG() access and delivers pending interrupts.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalSync(void)
+{
+    prvFlush();
+    prvIrqDeliver();
+}
+
+//*****************************************************************************
+//
+//! Returns the simulated system clock in Hz.
+//
+//*****************************************************************************
+uint32_t
+HalClockGet(void)
+{
+    return(g_ui32HalSysClock);
+}
+
+//*****************************************************************************
+//
+//! Changes the simulated system clock.
+//!
+//! \param ui32SysClock is the new frequency in Hz.
+//!
+//! Cycles already counted are not rescaled.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalClockSet(uint32_t ui32SysClock)
+{
+    g_ui32HalSysClock = ui32SysClock;
+}
+
+//*****************************************************************************
+//
+//! Returns the virtual cycle count.
+//
+//*****************************************************************************
+uint64_t
+HalCyclesGet(void)
+{
+    return(g_ui64HalCycles);
+}
+
+//*****************************************************************************
+//
+// Returns the index of the earliest event, or -1 if there is none.
+//
+//*****************************************************************************
+static int32_t
+prvEventNext(void)
+{
+    uint32_t ui32Idx;
+    int32_t i32Next = -1;
+
+    for(ui32Idx = 0; ui32Idx < g_ui32HalNumEvents; ui32Idx++)
+    {
+        if((i32Next < 0) ||
+           (g_psHalEvents[ui32Idx].ui64When <
+            g_psHalEvents[i32Next].ui64When))
+        {
+            i32Next = (int32_t)ui32Idx;
+        }
+    }
+    return(i32Next);
+}
+
+//*****************************************************************************
+//
+//! Moves the virtual clock to the next event, or to a limit.
+//!
+//! \param ui64Until is the latest cycle count to move to, or HAL_FOREVER.
+//!
+//! With HAL_FOREVER and no event scheduled the clock does not move.
+//!
+//! \return Returns \b true if an event was run, \b false if the clock reached
+//! ui64Until first or there was nothing to wait for.
+//
+//*****************************************************************************
+bool
+HalStep(uint64_t ui64Until)
+{
+    int32_t i32Next;
+    HalPeriph_t *psPeriph;
+    HalEventFn_t pfnEvent;
+
+    prvFlush();
+
+    i32Next = prvEventNext();
+    if((i32Next < 0) || (g_psHalEvents[i32Next].ui64When > ui64Until))
+    {
+        if((ui64Until != HAL_FOREVER) && (ui64Until > g_ui64HalCycles))
+        {
+            g_ui64HalCycles = ui64Until;
+        }
+        return(false);
+    }
+
+    if(g_psHalEvents[i32Next].ui64When > g_ui64HalCycles)
+    {
+        g_ui64HalCycles = g_psHalEvents[i32Next].ui64When;
+    }
+    psPeriph = g_psHalEvents[i32Next].psPeriph;
+    pfnEvent = g_psHalEvents[i32Next].pfnEvent;
+    g_psHalEvents[i32Next] = g_psHalEvents[--g_ui32HalNumEvents];
+
+    g_ui32HalDepth++;
+    pfnEvent(psPeriph);
+    g_ui32HalDepth--;
+
+    prvIrqDeliver();
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Moves the virtual clock on, running the events that fall due.
+//!
+//! \param ui64Cycles is the number of cycles.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalCyclesAdd(uint64_t ui64Cycles)
+{
+    uint64_t ui64Until = g_ui64HalCycles + ui64Cycles;
+
+    while(HalStep(ui64Until))
+    {
+    }
+}
+
+//*****************************************************************************
+//
+//! Schedules an event for a block.
+//!
+//! \param psPeriph is the block, passed to the event.
+//! \param pfnEvent is the function to call.
+//! \param ui64When is the cycle count to call it at.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalEventSet(HalPeriph_t *psPeriph, HalEventFn_t pfnEvent, uint64_t ui64When)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < g_ui32HalNumEvents; ui32Idx++)
+    {
+        if((g_psHalEvents[ui32Idx].psPeriph == psPeriph) &&
+           (g_psHalEvents[ui32Idx].pfnEvent == pfnEvent))
+        {
+            break;
+        }
+    }
+    if(ui32Idx == g_ui32HalNumEvents)
+    {
+        if(g_ui32HalNumEvents == HAL_MAX_EVENTS)
+        {
+            prvFatal("out of events for", psPeriph->ui32Base);
+        }
+        g_ui32HalNumEvents++;
+    }
+
+    g_psHalEvents[ui32Idx].psPeriph = psPeriph;
+    g_psHalEvents[ui32Idx].pfnEvent = pfnEvent;
+    g_psHalEvents[ui32Idx].ui64When = ui64When;
+}
+
+//*****************************************************************************
+//
+//! Cancels an event scheduled by HalEventSet(), if it is pending.
+//
+//*****************************************************************************
+void
+HalEventCancel(HalPeriph_t *psPeriph, HalEventFn_t pfnEvent)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < g_ui32HalNumEvents; ui32Idx++)
+    {
+        if((g_psHalEvents[ui32Idx].psPeriph == psPeriph) &&
+           (g_psHalEvents[ui32Idx].pfnEvent == pfnEvent))
+        {
+            g_psHalEvents[ui32Idx] = g_psHalEvents[--g_ui32HalNumEvents];
+            return;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Calls the handlers of the pending interrupts that are enabled, lowest
+// vector first, unless the firmware is masking them.
+//
+//*****************************************************************************
+static void
+prvIrqDeliver(void)
+{
+    uint32_t ui32Int;
+
+    while(!g_bHalInIsr && !g_bHalPrimask && !g_ui32HalCritical &&
+          !g_ui32HalDepth)
+    {
+        for(ui32Int = 0; ui32Int < HAL_NUM_VECTORS; ui32Int++)
+        {
+            if(g_pbHalIrqPending[ui32Int] && g_pbHalIrqEnabled[ui32Int] &&
+               g_ppfnHalVectors[ui32Int])
+            {
+                break;
+            }
+        }
+        if(ui32Int == HAL_NUM_VECTORS)
+        {
+            return;
+        }
+
+        g_pbHalIrqPending[ui32Int] = false;
+        g_pui32HalIrqCount[ui32Int]++;
+        g_bHalInIsr = true;
+        g_ppfnHalVectors[ui32Int]();
+        prvFlush();
+        g_bHalInIsr = false;
+    }
+}
+
+//*****************************************************************************
+//
+//! Sets the handler of an interrupt.
+//!
+//! \param ui32Int is the vector number, one of the INT_ values.
+//! \param pfnHandler is the handler.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalIrqRegister(uint32_t ui32Int, void (*pfnHandler)(void))
+{
+    if(ui32Int >= HAL_NUM_VECTORS)
+    {
+        prvFatal("bad vector", ui32Int);
+    }
+    g_ppfnHalVectors[ui32Int] = pfnHandler;
+}
+
+//*****************************************************************************
+//
+//! Enables or disables an interrupt in the simulated NVIC.
+//
+//*****************************************************************************
+void
+HalIrqEnable(uint32_t ui32Int, bool bEnable)
+{
+    if(ui32Int >= HAL_NUM_VECTORS)
+    {
+        prvFatal("bad vector", ui32Int);
+    }
+    g_pbHalIrqEnabled[ui32Int] = bEnable;
+    prvIrqDeliver();
+}
+
+//*****************************************************************************
+//
+//! Pends an interrupt.
+//!
+//! \param ui32Int is the vector number.
+//!
+//! Interrupts are edge triggered: a handler is called once for each time its
+//! interrupt is raised while it is not already pending.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalIrqRaise(uint32_t ui32Int)
+{
+    if(ui32Int >= HAL_NUM_VECTORS)
+    {
+        prvFatal("bad vector", ui32Int);
+    }
+    g_pbHalIrqPending[ui32Int] = true;
+    prvIrqDeliver();
+}
+
+//*****************************************************************************
+//
+//! Sets the simulated PRIMASK.
+//!
+//! \param bMask is \b true to mask interrupts.
+//!
+//! \return Returns the previous state, \b true if they were masked.
+//
+//*****************************************************************************
+bool
+HalIrqMask(bool bMask)
+{
+    bool bWas = g_bHalPrimask;
+
+    prvFlush();
+    g_bHalPrimask = bMask;
+    prvIrqDeliver();
+
+    return(bWas);
+}
+
+//*****************************************************************************
+//
+//! Enters and leaves a critical section, which may nest.
+//
+//*****************************************************************************
+void
+HalCriticalEnter(void)
+{
+    prvFlush();
+    g_ui32HalCritical++;
+}
+
+void
+HalCriticalExit(void)
+{
+    prvFlush();
+    if(g_ui32HalCritical)
+    {
+        g_ui32HalCritical--;
+    }
+    prvIrqDeliver();
+}
+
+//*****************************************************************************
+//
+//! Clears the access and interrupt counters.
+//
+//*****************************************************************************
+void
+HalCountersReset(void)
+{
+    uint32_t ui32Idx;
+
+    prvFlush();
+    for(ui32Idx = 0; ui32Idx < g_ui32HalNumPages; ui32Idx++)
+    {
+        g_psHalPages[ui32Idx].ui32Accesses = 0;
+        g_psHalPages[ui32Idx].ui32Writes = 0;
+    }
+    memset(g_pui32HalIrqCount, 0, sizeof(g_pui32HalIrqCount));
+}
+
+//*****************************************************************************
+//
+//! Prints the accesses to each block and the interrupts taken since the
+//! counters were last reset.
+//!
+//! \param pcTitle heads the report.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalReportPrint(const char *pcTitle)
+{
+    uint32_t ui32Idx;
+
+    prvFlush();
+    printf("%s\n", pcTitle);
+    printf("  block     base        accesses    writes\n");
+    for(ui32Idx = 0; ui32Idx < g_ui32HalNumPages; ui32Idx++)
+    {
+        if(g_psHalPages[ui32Idx].ui32Accesses)
+        {
+            printf("  %-8s  0x%08x  %9u  %8u\n", g_psHalPages[ui32Idx].pcName,
+                   (unsigned)g_psHalPages[ui32Idx].ui32Base,
+                   (unsigned)g_psHalPages[ui32Idx].ui32Accesses,
+                   (unsigned)g_psHalPages[ui32Idx].ui32Writes);
+        }
+    }
+    for(ui32Idx = 0; ui32Idx < HAL_NUM_VECTORS; ui32Idx++)
+    {
+        if(g_pui32HalIrqCount[ui32Idx])
+        {
+            printf("  irq %-4u  %u taken\n", (unsigned)ui32Idx,
+                   (unsigned)g_pui32HalIrqCount[ui32Idx]);
+        }
+    }
+}
@@ -0,0 +1,130 @@
+//*****************************************************************************
+//
+// hal_core.c - The Cortex-M4 core on the host: the DWT cycle counter and
+//              the driverlib interrupt controller calls.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hal.h"
+#include "driverlib/interrupt.h"
+
+//*****************************************************************************
+//
+// The DWT block.  CYCCNT reads the virtual clock, less whatever was written
+// to it last.
+//
+//*****************************************************************************
+#define HAL_DWT_BASE            0xE0001000
+#define HAL_DWT_O_CYCCNT        0x004
+
+static uint64_t g_ui64HalDwtZero;
+
+static void
+prvDwtRead(HalPeriph_t *psPeriph, uint32_t ui32Offset)
+{
+    if(ui32Offset == HAL_DWT_O_CYCCNT)
+    {
+        HAL_REG(psPeriph, ui32Offset) =
+            (uint32_t)(HalCyclesGet() - g_ui64HalDwtZero);
+    }
+}
+
+static void
+prvDwtWrite(HalPeriph_t *psPeriph, uint32_t ui32Offset, uint32_t ui32Old)
+{
+    (void)ui32Old;
+
+    if(ui32Offset == HAL_DWT_O_CYCCNT)
+    {
+        g_ui64HalDwtZero = HalCyclesGet() - HAL_REG(psPeriph, ui32Offset);
+    }
+}
+
+static const HalModel_t g_sHalDwtModel =
+{
+    prvDwtRead, prvDwtWrite, 0
+};
+
+//*****************************************************************************
+//
+// Attaches the core models.  Called by HalInit().
+//
+//*****************************************************************************
+void
+HalCoreAttach(void)
+{
+    g_ui64HalDwtZero = 0;
+    HalModelSet(HAL_DWT_BASE, "DWT", &g_sHalDwtModel, 0);
+    HalModelSet(0xE000E000, "SCS", 0, 0);
+}
+
+//*****************************************************************************
+//
+// The driverlib interrupt controller API.  Priorities are accepted and
+// ignored: the simulated NVIC delivers the lowest pending vector first and
+// never nests handlers.
+//
+//*****************************************************************************
+bool
+IntMasterEnable(void)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return(HalIrqMask(false));
+}
+
+bool
+IntMasterDisable(void)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return(HalIrqMask(true));
+}
+
+void
+IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void))
+{
+    HalIrqRegister(ui32Interrupt, pfnHandler);
+}
+
+void
+IntUnregister(uint32_t ui32Interrupt)
+{
+    HalIrqRegister(ui32Interrupt, 0);
+}
+
+void
+IntEnable(uint32_t ui32Interrupt)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalIrqEnable(ui32Interrupt, true);
+}
+
+void
+IntDisable(uint32_t ui32Interrupt)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalIrqEnable(ui32Interrupt, false);
+}
+
+void
+IntPendSet(uint32_t ui32Interrupt)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalIrqRaise(ui32Interrupt);
+}
+
+void
+IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority)
+{
+    (void)ui32Interrupt;
+    (void)ui8Priority;
+    HalCyclesAdd(HAL_CALL_CYCLES);
+}
+
+void
+IntPriorityGroupingSet(uint32_t ui32Bits)
+{
+    (void)ui32Bits;
+    HalCyclesAdd(HAL_CALL_CYCLES);
+}
@@ -0,0 +1,366 @@
+//*****************************************************************************
+//
+// hal_gpio.c - The GPIO ports on the host.
+//
+// Each port keeps the value its output latch holds and the level driven on
+// its inputs from outside (HalGpioInputSet()); the pin level is the latch on
+// output pins and the input elsewhere.  The DATA register is the masked
+// window of the device: address bits 9:2 select the pins a read returns or
+// a write changes.  Level changes are counted per pin and can be watched, so
+// a test can decode what firmware drives onto a bus of GPIO lines.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "hal.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+
+//*****************************************************************************
+//
+// The ports, in GPIOPinConfigure() order, on the AHB bus.  A to J also
+// appear on the APB bus, at the addresses the firmware uses by default.
+//
+//*****************************************************************************
+#define HAL_GPIO_NUM_PORTS      18
+#define HAL_GPIO_NUM_APB        9
+
+static const uint32_t g_pui32HalGpioAhb[HAL_GPIO_NUM_PORTS] =
+{
+    0x40058000, 0x40059000, 0x4005A000, 0x4005B000, 0x4005C000, 0x4005D000,
+    0x4005E000, 0x4005F000, 0x40060000, 0x40061000, 0x40062000, 0x40063000,
+    0x40064000, 0x40065000, 0x40066000, 0x40067000, 0x40068000, 0x40069000,
+};
+
+static const uint32_t g_pui32HalGpioApb[HAL_GPIO_NUM_APB] =
+{
+    0x40004000, 0x40005000, 0x40006000, 0x40007000, 0x40024000, 0x40025000,
+    0x40026000, 0x40027000, 0x4003D000,
+};
+
+static const char * const g_ppcHalGpioNames[HAL_GPIO_NUM_PORTS] =
+{
+    "GPIOA", "GPIOB", "GPIOC", "GPIOD", "GPIOE", "GPIOF", "GPIOG", "GPIOH",
+    "GPIOJ", "GPIOK", "GPIOL", "GPIOM", "GPION", "GPIOP", "GPIOQ", "GPIOR",
+    "GPIOS", "GPIOT",
+};
+
+#define HAL_GPIO_DATA_END       0x400   // End of the masked DATA window
+
+typedef struct
+{
+    uint8_t ui8Latch;
+    uint8_t ui8Input;
+    uint8_t ui8Level;
+    uint32_t pui32Edges[8];
+    void (*pfnWatch)(uint32_t ui32Base, uint8_t ui8Changed, uint8_t ui8Level,
+                     void *pvArg);
+    void *pvArg;
+}
+HalGpioPort_t;
+
+static HalGpioPort_t g_psHalGpioPorts[HAL_GPIO_NUM_PORTS];
+
+//*****************************************************************************
+//
+// Recomputes the pin levels after the latch, direction or inputs changed.
+//
+//*****************************************************************************
+static void
+prvLevelUpdate(HalPeriph_t *psPeriph)
+{
+    HalGpioPort_t *psPort = psPeriph->pvState;
+    uint8_t ui8Dir, ui8Level, ui8Changed;
+    uint32_t ui32Pin;
+
+    ui8Dir = (uint8_t)HAL_REG(psPeriph, GPIO_O_DIR);
+    ui8Level = (psPort->ui8Latch & ui8Dir) | (psPort->ui8Input & ~ui8Dir);
+    ui8Changed = ui8Level ^ psPort->ui8Level;
+    if(!ui8Changed)
+    {
+        return;
+    }
+
+    psPort->ui8Level = ui8Level;
+    for(ui32Pin = 0; ui32Pin < 8; ui32Pin++)
+    {
+        if(ui8Changed & (1 << ui32Pin))
+        {
+            psPort->pui32Edges[ui32Pin]++;
+        }
+    }
+    if(psPort->pfnWatch)
+    {
+        psPort->pfnWatch(psPeriph->ui32Base, ui8Changed, ui8Level,
+                         psPort->pvArg);
+    }
+}
+
+static void
+prvGpioRead(HalPeriph_t *psPeriph, uint32_t ui32Offset)
+{
+    HalGpioPort_t *psPort = psPeriph->pvState;
+
+    if(ui32Offset < HAL_GPIO_DATA_END)
+    {
+        HAL_REG(psPeriph, ui32Offset) = psPort->ui8Level & (ui32Offset >> 2);
+    }
+}
+
+static void
+prvGpioWrite(HalPeriph_t *psPeriph, uint32_t ui32Offset, uint32_t ui32Old)
+{
+    HalGpioPort_t *psPort = psPeriph->pvState;
+    uint8_t ui8Mask;
+
+    (void)ui32Old;
+
+    if(ui32Offset < HAL_GPIO_DATA_END)
+    {
+        ui8Mask = (uint8_t)(ui32Offset >> 2);
+        psPort->ui8Latch = (psPort->ui8Latch & ~ui8Mask) |
+                           (HAL_REG(psPeriph, ui32Offset) & ui8Mask);
+    }
+    prvLevelUpdate(psPeriph);
+}
+
+static const HalModel_t g_sHalGpioModel =
+{
+    prvGpioRead, prvGpioWrite, 0
+};
+
+void
+HalGpioAttach(void)
+{
+    uint32_t ui32Port;
+
+    memset(g_psHalGpioPorts, 0, sizeof(g_psHalGpioPorts));
+    for(ui32Port = 0; ui32Port < HAL_GPIO_NUM_APB; ui32Port++)
+    {
+        HalAliasAdd(g_pui32HalGpioApb[ui32Port], g_pui32HalGpioAhb[ui32Port]);
+    }
+    for(ui32Port = 0; ui32Port < HAL_GPIO_NUM_PORTS; ui32Port++)
+    {
+        HalModelSet(g_pui32HalGpioAhb[ui32Port], g_ppcHalGpioNames[ui32Port],
+                    &g_sHalGpioModel, &g_psHalGpioPorts[ui32Port]);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the state of a port, given either of its base addresses.
+//
+//*****************************************************************************
+static HalGpioPort_t *
+prvPortGet(uint32_t ui32Base)
+{
+    HalPeriph_t *psPeriph = HalPeriphGet(ui32Base);
+
+    if(psPeriph->psModel != &g_sHalGpioModel)
+    {
+        return(0);
+    }
+    return(psPeriph->pvState);
+}
+
+//*****************************************************************************
+//
+//! Returns the level of the pins of a port.
+//
+//*****************************************************************************
+uint8_t
+HalGpioLevelGet(uint32_t ui32Base)
+{
+    HalGpioPort_t *psPort;
+
+    HalSync();
+    psPort = prvPortGet(ui32Base);
+    return(psPort ? psPort->ui8Level : 0);
+}
+
+//*****************************************************************************
+//
+//! Drives the input pins of a port from outside.
+//!
+//! \param ui32Base is the base address of the port.
+//! \param ui8Pins are the pins to drive.
+//! \param ui8Level is the level for them.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalGpioInputSet(uint32_t ui32Base, uint8_t ui8Pins, uint8_t ui8Level)
+{
+    HalGpioPort_t *psPort;
+
+    HalSync();
+    psPort = prvPortGet(ui32Base);
+    if(psPort)
+    {
+        psPort->ui8Input = (psPort->ui8Input & ~ui8Pins) |
+                           (ui8Level & ui8Pins);
+        prvLevelUpdate(HalPeriphGet(ui32Base));
+    }
+}
+
+//*****************************************************************************
+//
+//! Returns the number of level changes of one pin since HalInit().
+//!
+//! \param ui32Base is the base address of the port.
+//! \param ui8Pin is the pin, one of the GPIO_PIN_ values.
+//!
+//! \return Returns the count.
+//
+//*****************************************************************************
+uint32_t
+HalGpioEdgesGet(uint32_t ui32Base, uint8_t ui8Pin)
+{
+    HalGpioPort_t *psPort;
+    uint32_t ui32Pin;
+
+    HalSync();
+    psPort = prvPortGet(ui32Base);
+    for(ui32Pin = 0; psPort && (ui32Pin < 8); ui32Pin++)
+    {
+        if(ui8Pin == (1 << ui32Pin))
+        {
+            return(psPort->pui32Edges[ui32Pin]);
+        }
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Calls a function whenever the level of a port's pins changes.
+//!
+//! \param ui32Base is the base address of the port.
+//! \param pfnChange is called with the pins that changed and the new level,
+//! or 0 to stop watching.
+//! \param pvArg is passed to pfnChange.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalGpioWatch(uint32_t ui32Base,
+             void (*pfnChange)(uint32_t ui32Base, uint8_t ui8Changed,
+                               uint8_t ui8Level, void *pvArg),
+             void *pvArg)
+{
+    HalGpioPort_t *psPort = prvPortGet(ui32Base);
+
+    if(psPort)
+    {
+        psPort->pfnWatch = pfnChange;
+        psPort->pvArg = pvArg;
+    }
+}
+
+//*****************************************************************************
+//
+// The driverlib GPIO API.
+//
+//*****************************************************************************
+static void
+prvRegModify(uint32_t ui32Addr, uint32_t ui32Mask, bool bSet)
+{
+    uint32_t ui32Val = HalRegRead(ui32Addr);
+
+    HalRegWrite(ui32Addr, bSet ? (ui32Val | ui32Mask) : (ui32Val & ~ui32Mask));
+}
+
+void
+GPIODirModeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32PinIO)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    prvRegModify(ui32Port + GPIO_O_DIR, ui8Pins,
+                 (ui32PinIO & GPIO_DIR_MODE_OUT) != 0);
+    prvRegModify(ui32Port + GPIO_O_AFSEL, ui8Pins,
+                 (ui32PinIO & GPIO_DIR_MODE_HW) != 0);
+}
+
+void
+GPIOPadConfigSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32Strength,
+                 uint32_t ui32PadType)
+{
+    (void)ui32Strength;
+
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    prvRegModify(ui32Port + GPIO_O_ODR, ui8Pins, (ui32PadType & 1) != 0);
+    prvRegModify(ui32Port + GPIO_O_PUR, ui8Pins, (ui32PadType & 2) != 0);
+    prvRegModify(ui32Port + GPIO_O_PDR, ui8Pins, (ui32PadType & 4) != 0);
+    prvRegModify(ui32Port + GPIO_O_DEN, ui8Pins,
+                 ui32PadType != GPIO_PIN_TYPE_ANALOG);
+}
+
+void
+GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD);
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_OUT);
+}
+
+void
+GPIOPinTypeGPIOInput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_IN);
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD);
+}
+
+void
+GPIOPinTypeSSI(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_HW);
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD);
+}
+
+void
+GPIOPinTypeI2C(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_HW);
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_OD);
+}
+
+void
+GPIOPinTypeI2CSCL(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_HW);
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD);
+}
+
+void
+GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+    uint32_t ui32Port, ui32Shift, ui32Addr, ui32Val;
+
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    ui32Port = (ui32PinConfig >> 16) & 0xff;
+    if(ui32Port >= HAL_GPIO_NUM_PORTS)
+    {
+        return;
+    }
+    ui32Shift = (ui32PinConfig >> 8) & 0xff;
+    ui32Addr = g_pui32HalGpioAhb[ui32Port] + GPIO_O_PCTL;
+    ui32Val = HalRegRead(ui32Addr) & ~(0xfu << ui32Shift);
+    HalRegWrite(ui32Addr, ui32Val | ((ui32PinConfig & 0xf) << ui32Shift));
+}
+
+void
+GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Port + ((uint32_t)ui8Pins << 2), ui8Val);
+}
+
+int32_t
+GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return((int32_t)HalRegRead(ui32Port + ((uint32_t)ui8Pins << 2)));
+}
@@ -0,0 +1,410 @@
+//*****************************************************************************
+//
+// hal_i2c.c - The I2C modules on the host, as masters.
+//
+// A command written to MCS is carried out against the devices added with
+// HalI2cDeviceAdd(): START addresses the device in MSA, RUN moves one byte
+// through MDR and STOP ends the transfer.  The bus is busy for the bit times
+// the command takes on the wire (nine per byte, one more for each start and
+// stop), after which RIS reports DATA, and STOP too if the command ended the
+// transfer, and the module's interrupt is raised if MIMR allows it.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "hal.h"
+#include "inc/hw_i2c.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/i2c.h"
+
+#define HAL_I2C_NUM             10
+#define HAL_I2C_MAX_DEVICES     4
+
+typedef struct
+{
+    HalI2cDevice_t *ppsDevices[HAL_I2C_MAX_DEVICES];
+    HalI2cDevice_t *psActive;
+    uint32_t ui32Int;
+    uint32_t ui32Done;
+    uint32_t ui32Status;
+    uint32_t ui32Bytes;
+    bool bBusy;
+    bool bBusBusy;
+}
+HalI2c_t;
+
+static const uint32_t g_pui32HalI2cBase[HAL_I2C_NUM] =
+{
+    I2C0_BASE, I2C1_BASE, I2C2_BASE, I2C3_BASE, I2C4_BASE,
+    I2C5_BASE, I2C6_BASE, I2C7_BASE, I2C8_BASE, I2C9_BASE,
+};
+
+static const uint32_t g_pui32HalI2cInt[HAL_I2C_NUM] =
+{
+    INT_I2C0, INT_I2C1, INT_I2C2, INT_I2C3, INT_I2C4,
+    INT_I2C5, INT_I2C6, INT_I2C7, INT_I2C8, INT_I2C9,
+};
+
+static const char * const g_ppcHalI2cNames[HAL_I2C_NUM] =
+{
+    "I2C0", "I2C1", "I2C2", "I2C3", "I2C4",
+    "I2C5", "I2C6", "I2C7", "I2C8", "I2C9",
+};
+
+static HalI2c_t g_psHalI2c[HAL_I2C_NUM];
+
+//*****************************************************************************
+//
+// Ends a command: the bus goes idle and the interrupt is raised.
+//
+//*****************************************************************************
+static void
+prvI2cDone(HalPeriph_t *psPeriph)
+{
+    HalI2c_t *psI2c = psPeriph->pvState;
+
+    psI2c->bBusy = false;
+    HAL_REG(psPeriph, I2C_O_MRIS) |= psI2c->ui32Done;
+    if(HAL_REG(psPeriph, I2C_O_MRIS) & HAL_REG(psPeriph, I2C_O_MIMR))
+    {
+        HalIrqRaise(psI2c->ui32Int);
+    }
+}
+
+//*****************************************************************************
+//
+// Carries out a command written to MCS.
+//
+//*****************************************************************************
+static void
+prvI2cCommand(HalPeriph_t *psPeriph, uint32_t ui32Cmd)
+{
+    HalI2c_t *psI2c = psPeriph->pvState;
+    uint32_t ui32Msa, ui32Bits, ui32Idx;
+    bool bRead, bAck;
+
+    ui32Msa = HAL_REG(psPeriph, I2C_O_MSA);
+    bRead = (ui32Msa & I2C_MSA_RS) != 0;
+    ui32Bits = 0;
+    psI2c->ui32Status = 0;
+    psI2c->ui32Done = I2C_MRIS_RIS;
+
+    if(ui32Cmd & I2C_MCS_START)
+    {
+        if(psI2c->psActive && psI2c->psActive->pfnStop)
+        {
+            psI2c->psActive->pfnStop(psI2c->psActive->pvDev);
+        }
+        psI2c->psActive = 0;
+        for(ui32Idx = 0; ui32Idx < HAL_I2C_MAX_DEVICES; ui32Idx++)
+        {
+            if(psI2c->ppsDevices[ui32Idx] &&
+               (psI2c->ppsDevices[ui32Idx]->ui8Addr == (ui32Msa >> 1)))
+            {
+                psI2c->psActive = psI2c->ppsDevices[ui32Idx];
+            }
+        }
+        if(psI2c->psActive)
+        {
+            if(psI2c->psActive->pfnStart)
+            {
+                psI2c->psActive->pfnStart(psI2c->psActive->pvDev, bRead);
+            }
+        }
+        else
+        {
+            psI2c->ui32Status |= I2C_MCS_ERROR | I2C_MCS_ADRACK;
+        }
+        psI2c->bBusBusy = true;
+        ui32Bits += 10;
+    }
+
+    if((ui32Cmd & I2C_MCS_RUN) && psI2c->psActive)
+    {
+        if(bRead)
+        {
+            HAL_REG(psPeriph, I2C_O_MDR) =
+                psI2c->psActive->pfnRead ?
+                psI2c->psActive->pfnRead(psI2c->psActive->pvDev) : 0xff;
+        }
+        else
+        {
+            bAck = psI2c->psActive->pfnWrite &&
+                   psI2c->psActive->pfnWrite(psI2c->psActive->pvDev,
+                                             (uint8_t)HAL_REG(psPeriph,
+                                                              I2C_O_MDR));
+            if(!bAck)
+            {
+                psI2c->ui32Status |= I2C_MCS_ERROR | I2C_MCS_DATACK;
+            }
+        }
+        psI2c->ui32Bytes++;
+        ui32Bits += 9;
+    }
+
+    if(ui32Cmd & I2C_MCS_STOP)
+    {
+        if(psI2c->psActive && psI2c->psActive->pfnStop)
+        {
+            psI2c->psActive->pfnStop(psI2c->psActive->pvDev);
+        }
+        psI2c->psActive = 0;
+        psI2c->bBusBusy = false;
+        psI2c->ui32Done |= I2C_MRIS_STOPRIS;
+        ui32Bits += 1;
+    }
+
+    //
+    // SCL runs at the system clock / (20 * (1 + TPR)).
+    //
+    psI2c->bBusy = true;
+    HalEventSet(psPeriph, prvI2cDone,
+                HalCyclesGet() +
+                (uint64_t)ui32Bits * 20 *
+                (1 + (HAL_REG(psPeriph, I2C_O_MTPR) & 0x7f)));
+}
+
+static void
+prvI2cRead(HalPeriph_t *psPeriph, uint32_t ui32Offset)
+{
+    HalI2c_t *psI2c = psPeriph->pvState;
+
+    if(ui32Offset == I2C_O_MCS)
+    {
+        HAL_REG(psPeriph, I2C_O_MCS) =
+            psI2c->bBusy ? I2C_MCS_BUSY :
+            (psI2c->ui32Status | (psI2c->bBusBusy ? I2C_MCS_BUSBSY :
+                                                    I2C_MCS_IDLE));
+    }
+    else if(ui32Offset == I2C_O_MMIS)
+    {
+        HAL_REG(psPeriph, I2C_O_MMIS) = HAL_REG(psPeriph, I2C_O_MRIS) &
+                                        HAL_REG(psPeriph, I2C_O_MIMR);
+    }
+}
+
+static void
+prvI2cWrite(HalPeriph_t *psPeriph, uint32_t ui32Offset, uint32_t ui32Old)
+{
+    (void)ui32Old;
+
+    if(ui32Offset == I2C_O_MCS)
+    {
+        prvI2cCommand(psPeriph, HAL_REG(psPeriph, I2C_O_MCS));
+    }
+    else if(ui32Offset == I2C_O_MICR)
+    {
+        HAL_REG(psPeriph, I2C_O_MRIS) &= ~HAL_REG(psPeriph, I2C_O_MICR);
+        HAL_REG(psPeriph, I2C_O_MICR) = 0;
+    }
+}
+
+static const HalModel_t g_sHalI2cModel =
+{
+    prvI2cRead, prvI2cWrite, 0
+};
+
+void
+HalI2cAttach(void)
+{
+    uint32_t ui32Idx;
+
+    memset(g_psHalI2c, 0, sizeof(g_psHalI2c));
+    for(ui32Idx = 0; ui32Idx < HAL_I2C_NUM; ui32Idx++)
+    {
+        g_psHalI2c[ui32Idx].ui32Int = g_pui32HalI2cInt[ui32Idx];
+        HalModelSet(g_pui32HalI2cBase[ui32Idx], g_ppcHalI2cNames[ui32Idx],
+                    &g_sHalI2cModel, &g_psHalI2c[ui32Idx]);
+    }
+}
+
+static HalI2c_t *
+prvI2cGet(uint32_t ui32Base)
+{
+    HalPeriph_t *psPeriph = HalPeriphGet(ui32Base);
+
+    return((psPeriph->psModel == &g_sHalI2cModel) ? psPeriph->pvState : 0);
+}
+
+//*****************************************************************************
+//
+//! Puts a device on the bus of an I2C module.
+//!
+//! \param ui32Base is the base address of the module.
+//! \param psDev is the device, which must stay valid until HalInit().
+//!
+//! \return Returns \b false if the bus already has HAL_I2C_MAX_DEVICES.
+//
+//*****************************************************************************
+bool
+HalI2cDeviceAdd(uint32_t ui32Base, HalI2cDevice_t *psDev)
+{
+    HalI2c_t *psI2c = prvI2cGet(ui32Base);
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; psI2c && (ui32Idx < HAL_I2C_MAX_DEVICES); ui32Idx++)
+    {
+        if(!psI2c->ppsDevices[ui32Idx])
+        {
+            psI2c->ppsDevices[ui32Idx] = psDev;
+            return(true);
+        }
+    }
+    return(false);
+}
+
+//*****************************************************************************
+//
+//! Returns the number of bytes an I2C module has moved since HalInit().
+//
+//*****************************************************************************
+uint32_t
+HalI2cBytesGet(uint32_t ui32Base)
+{
+    HalI2c_t *psI2c;
+
+    HalSync();
+    psI2c = prvI2cGet(ui32Base);
+    return(psI2c ? psI2c->ui32Bytes : 0);
+}
+
+//*****************************************************************************
+//
+// The driverlib I2C master API.
+//
+//*****************************************************************************
+void
+I2CMasterInitExpClk(uint32_t ui32Base, uint32_t ui32I2CClk, bool bFast)
+{
+    uint32_t ui32SCLFreq, ui32TPR;
+
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    I2CMasterEnable(ui32Base);
+
+    ui32SCLFreq = bFast ? 400000 : 100000;
+    ui32TPR = ((ui32I2CClk + (2 * 10 * ui32SCLFreq) - 1) /
+               (2 * 10 * ui32SCLFreq)) - 1;
+    HalRegWrite(ui32Base + I2C_O_MTPR, ui32TPR);
+}
+
+void
+I2CMasterEnable(uint32_t ui32Base)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + I2C_O_MCR,
+                HalRegRead(ui32Base + I2C_O_MCR) | I2C_MCR_MFE);
+}
+
+void
+I2CMasterDisable(uint32_t ui32Base)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + I2C_O_MCR,
+                HalRegRead(ui32Base + I2C_O_MCR) & ~I2C_MCR_MFE);
+}
+
+void
+I2CMasterSlaveAddrSet(uint32_t ui32Base, uint8_t ui8SlaveAddr, bool bReceive)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + I2C_O_MSA, ((uint32_t)ui8SlaveAddr << 1) | bReceive);
+}
+
+void
+I2CMasterDataPut(uint32_t ui32Base, uint8_t ui8Data)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + I2C_O_MDR, ui8Data);
+}
+
+uint32_t
+I2CMasterDataGet(uint32_t ui32Base)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return(HalRegRead(ui32Base + I2C_O_MDR));
+}
+
+void
+I2CMasterControl(uint32_t ui32Base, uint32_t ui32Cmd)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + I2C_O_MCS, ui32Cmd);
+}
+
+bool
+I2CMasterBusy(uint32_t ui32Base)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return((HalRegRead(ui32Base + I2C_O_MCS) & I2C_MCS_BUSY) != 0);
+}
+
+bool
+I2CMasterBusBusy(uint32_t ui32Base)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return((HalRegRead(ui32Base + I2C_O_MCS) & I2C_MCS_BUSBSY) != 0);
+}
+
+uint32_t
+I2CMasterErr(uint32_t ui32Base)
+{
+    uint32_t ui32Err;
+
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    ui32Err = HalRegRead(ui32Base + I2C_O_MCS);
+    if(ui32Err & I2C_MCS_BUSY)
+    {
+        return(I2C_MASTER_ERR_NONE);
+    }
+    if(ui32Err & (I2C_MCS_ERROR | I2C_MCS_ARBLST))
+    {
+        return(ui32Err & (I2C_MCS_ARBLST | I2C_MCS_DATACK | I2C_MCS_ADRACK));
+    }
+    return(I2C_MASTER_ERR_NONE);
+}
+
+void
+I2CMasterIntEnable(uint32_t ui32Base)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + I2C_O_MIMR, 1);
+}
+
+void
+I2CMasterIntEnableEx(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + I2C_O_MIMR,
+                HalRegRead(ui32Base + I2C_O_MIMR) | ui32IntFlags);
+}
+
+void
+I2CMasterIntDisable(uint32_t ui32Base)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + I2C_O_MIMR, 0);
+}
+
+uint32_t
+I2CMasterIntStatusEx(uint32_t ui32Base, bool bMasked)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return(HalRegRead(ui32Base + (bMasked ? I2C_O_MMIS : I2C_O_MRIS)));
+}
+
+void
+I2CMasterIntClearEx(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + I2C_O_MICR, ui32IntFlags);
+}
+
+void
+I2CMasterIntClear(uint32_t ui32Base)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + I2C_O_MICR, I2C_MICR_IC);
+}
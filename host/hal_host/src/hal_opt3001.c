@@ -0,0 +1,257 @@
+//*****************************************************************************
+//
+// hal_opt3001.c - A simulated OPT3001 ambient light sensor, for an I2C bus
+//                 of the host HAL.
+//
+// Registers are 16 bits, sent most significant byte first; the first byte
+// written after the address sets the register pointer.  Conversions take
+// 100 ms or 800 ms of virtual time, as the CT bit selects, and latch the
+// mean over the conversion of the lux levels set with HalOpt3001LuxSet()
+// into the result register, as the real sensor integrates the light over its
+// conversion time.  Reading the configuration register clears its conversion
+// ready flag.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "hal.h"
+
+#define HAL_OPT_REG_RESULT      0x00
+#define HAL_OPT_REG_CONFIG      0x01
+#define HAL_OPT_REG_MFG_ID      0x7E
+#define HAL_OPT_REG_DEV_ID      0x7F
+
+#define HAL_OPT_MFG_ID          0x5449
+#define HAL_OPT_DEV_ID          0x3001
+#define HAL_OPT_CONFIG_RESET    0xC810
+
+#define HAL_OPT_CONFIG_CT       0x0800  // 800 ms conversions
+#define HAL_OPT_CONFIG_M_M      0x0600  // Mode
+#define HAL_OPT_CONFIG_M_SHUTDOWN                                             \
+                                0x0000
+#define HAL_OPT_CONFIG_M_SINGLE 0x0200
+#define HAL_OPT_CONFIG_CRF      0x0080  // Conversion ready
+
+//*****************************************************************************
+//
+// Returns the length of a conversion in cycles.
+//
+//*****************************************************************************
+static uint64_t
+prvConvCycles(HalOpt3001_t *psDev)
+{
+    return((uint64_t)HalClockGet() *
+           ((psDev->pui16Regs[HAL_OPT_REG_CONFIG] & HAL_OPT_CONFIG_CT) ?
+            800 : 100) / 1000);
+}
+
+//*****************************************************************************
+//
+// Completes the conversions that have finished by now.
+//
+//*****************************************************************************
+static void
+prvConvUpdate(HalOpt3001_t *psDev)
+{
+    uint16_t *pui16Config = &psDev->pui16Regs[HAL_OPT_REG_CONFIG];
+    uint64_t ui64Conv = prvConvCycles(psDev);
+    uint32_t ui32Exp, ui32CentiLux;
+
+    if(((*pui16Config & HAL_OPT_CONFIG_M_M) == HAL_OPT_CONFIG_M_SHUTDOWN) ||
+       (HalCyclesGet() < psDev->ui64ConvStart + ui64Conv))
+    {
+        return;
+    }
+
+    //
+    // The level has been constant since it was last set, which was before
+    // the end of the first conversion to finish; any after that saw only the
+    // current level.  A single conversion stops after the first.
+    //
+    if(((*pui16Config & HAL_OPT_CONFIG_M_M) == HAL_OPT_CONFIG_M_SINGLE) ||
+       (HalCyclesGet() < psDev->ui64ConvStart + 2 * ui64Conv))
+    {
+        psDev->ui64LuxSum += (uint64_t)psDev->ui32CentiLux *
+                             (psDev->ui64ConvStart + ui64Conv -
+                              psDev->ui64LuxSince);
+        ui32CentiLux = (uint32_t)(psDev->ui64LuxSum / ui64Conv);
+    }
+    else
+    {
+        ui32CentiLux = psDev->ui32CentiLux;
+    }
+
+    //
+    // The result is a 12 bit mantissa and the smallest exponent that fits
+    // it, in units of 0.01 lux.
+    //
+    for(ui32Exp = 0; (ui32Exp < 11) &&
+                     ((ui32CentiLux >> ui32Exp) > 4095); ui32Exp++)
+    {
+    }
+    psDev->pui16Regs[HAL_OPT_REG_RESULT] =
+        (uint16_t)((ui32Exp << 12) |
+                   ((ui32CentiLux >> ui32Exp) & 0xfff));
+    *pui16Config |= HAL_OPT_CONFIG_CRF;
+
+    if((*pui16Config & HAL_OPT_CONFIG_M_M) == HAL_OPT_CONFIG_M_SINGLE)
+    {
+        *pui16Config &= ~HAL_OPT_CONFIG_M_M;
+    }
+    else
+    {
+        psDev->ui64ConvStart += ((HalCyclesGet() - psDev->ui64ConvStart) /
+                                 ui64Conv) * ui64Conv;
+    }
+    psDev->ui64LuxSince = psDev->ui64ConvStart;
+    psDev->ui64LuxSum = 0;
+}
+
+//*****************************************************************************
+//
+// The register the pointer selects.
+//
+//*****************************************************************************
+static uint16_t
+prvRegGet(HalOpt3001_t *psDev)
+{
+    if(psDev->ui8Pointer < 4)
+    {
+        return(psDev->pui16Regs[psDev->ui8Pointer]);
+    }
+    if(psDev->ui8Pointer == HAL_OPT_REG_MFG_ID)
+    {
+        return(HAL_OPT_MFG_ID);
+    }
+    if(psDev->ui8Pointer == HAL_OPT_REG_DEV_ID)
+    {
+        return(HAL_OPT_DEV_ID);
+    }
+    return(0);
+}
+
+static void
+prvOptStart(void *pvDev, bool bRead)
+{
+    HalOpt3001_t *psDev = pvDev;
+
+    (void)bRead;
+
+    prvConvUpdate(psDev);
+    psDev->ui8Byte = 0;
+}
+
+static bool
+prvOptWrite(void *pvDev, uint8_t ui8Data)
+{
+    HalOpt3001_t *psDev = pvDev;
+    uint16_t ui16Val;
+
+    if(psDev->ui8Byte == 0)
+    {
+        psDev->ui8Pointer = ui8Data;
+    }
+    else if(psDev->ui8Byte == 1)
+    {
+        psDev->ui8Msb = ui8Data;
+    }
+    else if((psDev->ui8Byte == 2) && (psDev->ui8Pointer < 4) &&
+            (psDev->ui8Pointer != HAL_OPT_REG_RESULT))
+    {
+        ui16Val = ((uint16_t)psDev->ui8Msb << 8) | ui8Data;
+        if(psDev->ui8Pointer == HAL_OPT_REG_CONFIG)
+        {
+            //
+            // CRF is read only; a write that starts a mode clears it and
+            // starts a conversion.
+            //
+            ui16Val &= ~HAL_OPT_CONFIG_CRF;
+            if((ui16Val & HAL_OPT_CONFIG_M_M) != HAL_OPT_CONFIG_M_SHUTDOWN)
+            {
+                psDev->ui64ConvStart = HalCyclesGet();
+                psDev->ui64LuxSince = psDev->ui64ConvStart;
+                psDev->ui64LuxSum = 0;
+            }
+            else
+            {
+                ui16Val |= psDev->pui16Regs[HAL_OPT_REG_CONFIG] &
+                           HAL_OPT_CONFIG_CRF;
+            }
+        }
+        psDev->pui16Regs[psDev->ui8Pointer] = ui16Val;
+    }
+    psDev->ui8Byte++;
+
+    return(true);
+}
+
+static uint8_t
+prvOptRead(void *pvDev)
+{
+    HalOpt3001_t *psDev = pvDev;
+    uint16_t ui16Val;
+
+    prvConvUpdate(psDev);
+    ui16Val = prvRegGet(psDev);
+    if((psDev->ui8Byte++ & 1) == 0)
+    {
+        return((uint8_t)(ui16Val >> 8));
+    }
+
+    if(psDev->ui8Pointer == HAL_OPT_REG_CONFIG)
+    {
+        psDev->pui16Regs[HAL_OPT_REG_CONFIG] &= ~HAL_OPT_CONFIG_CRF;
+    }
+    return((uint8_t)ui16Val);
+}
+
+//*****************************************************************************
+//
+//! Initialises a simulated OPT3001, in its power-on state.
+//!
+//! \param psDev is the sensor.
+//! \param ui8Addr is its 7-bit bus address, 0x44 to 0x47.
+//!
+//! Add &psDev->sI2c to a bus with HalI2cDeviceAdd() afterwards.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalOpt3001Init(HalOpt3001_t *psDev, uint8_t ui8Addr)
+{
+    memset(psDev, 0, sizeof(*psDev));
+    psDev->sI2c.ui8Addr = ui8Addr;
+    psDev->sI2c.pfnStart = prvOptStart;
+    psDev->sI2c.pfnWrite = prvOptWrite;
+    psDev->sI2c.pfnRead = prvOptRead;
+    psDev->sI2c.pvDev = psDev;
+    psDev->pui16Regs[HAL_OPT_REG_CONFIG] = HAL_OPT_CONFIG_RESET;
+    psDev->pui16Regs[3] = 0xBFFF;
+}
+
+//*****************************************************************************
+//
+//! Sets the light level a simulated OPT3001 measures from now on.
+//!
+//! \param psDev is the sensor.
+//! \param ui32CentiLux is the level in hundredths of a lux.
+//!
+//! A conversion under way when the level changes reads the mean of the
+//! levels over its time.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalOpt3001LuxSet(HalOpt3001_t *psDev, uint32_t ui32CentiLux)
+{
+    prvConvUpdate(psDev);
+
+    psDev->ui64LuxSum += (uint64_t)psDev->ui32CentiLux *
+                         (HalCyclesGet() - psDev->ui64LuxSince);
+    psDev->ui64LuxSince = HalCyclesGet();
+    psDev->ui32CentiLux = ui32CentiLux;
+}
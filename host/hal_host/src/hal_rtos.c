@@ -0,0 +1,178 @@
+//*****************************************************************************
+//
+// hal_rtos.c - The FreeRTOS calls and console output of a host build.
+//
+// There is one thread, so blocking never switches task: it runs the
+// simulated hardware forward instead, which is where anything that could
+// unblock the caller comes from.
+//
+//*****************************************************************************
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+struct HalSemaphore
+{
+    UBaseType_t uxCount;
+    UBaseType_t uxMaxCount;
+};
+
+//*****************************************************************************
+//
+// Converts between ticks and cycles at the current clock.
+//
+//*****************************************************************************
+static uint64_t
+prvTicksToCycles(TickType_t xTicks)
+{
+    return(((uint64_t)xTicks * HalClockGet()) / configTICK_RATE_HZ);
+}
+
+TickType_t
+xTaskGetTickCount(void)
+{
+    return((TickType_t)((HalCyclesGet() * configTICK_RATE_HZ) /
+                        HalClockGet()));
+}
+
+TickType_t
+xTaskGetTickCountFromISR(void)
+{
+    return(xTaskGetTickCount());
+}
+
+//*****************************************************************************
+//
+// Delays move the virtual clock on, running whatever falls due meanwhile.
+//
+//*****************************************************************************
+void
+vTaskDelay(const TickType_t xTicksToDelay)
+{
+    HalSync();
+    HalCyclesAdd(prvTicksToCycles(xTicksToDelay));
+}
+
+BaseType_t
+xTaskGetSchedulerState(void)
+{
+    return(taskSCHEDULER_RUNNING);
+}
+
+void
+vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority)
+{
+    (void)xTask;
+    (void)uxNewPriority;
+}
+
+//*****************************************************************************
+//
+// Semaphores.
+//
+//*****************************************************************************
+SemaphoreHandle_t
+xHalSemaphoreCreate(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+    SemaphoreHandle_t xSemaphore = malloc(sizeof(*xSemaphore));
+
+    if(xSemaphore)
+    {
+        xSemaphore->uxMaxCount = uxMaxCount;
+        xSemaphore->uxCount = uxInitialCount;
+    }
+    return(xSemaphore);
+}
+
+void
+vHalSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    free(xSemaphore);
+}
+
+UBaseType_t
+uxHalSemaphoreCount(SemaphoreHandle_t xSemaphore)
+{
+    HalSync();
+    return(xSemaphore->uxCount);
+}
+
+//*****************************************************************************
+//
+// Takes a semaphore, running simulated events until it is given or the
+// block time has passed.  A take with portMAX_DELAY that nothing scheduled
+// can satisfy would never return on a target; here it fails, with a message.
+//
+//*****************************************************************************
+BaseType_t
+xHalSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    uint64_t ui64Until;
+
+    ui64Until = (xBlockTime == portMAX_DELAY) ?
+                HAL_FOREVER : HalCyclesGet() + prvTicksToCycles(xBlockTime);
+
+    HalSync();
+    while(xSemaphore->uxCount == 0)
+    {
+        if(!HalStep(ui64Until))
+        {
+            if(xSemaphore->uxCount)
+            {
+                break;
+            }
+            if(xBlockTime == portMAX_DELAY)
+            {
+                fprintf(stderr, "hal: take with portMAX_DELAY would never "
+                        "return\n");
+            }
+            return(pdFALSE);
+        }
+    }
+
+    xSemaphore->uxCount--;
+    return(pdTRUE);
+}
+
+BaseType_t
+xHalSemaphoreGive(SemaphoreHandle_t xSemaphore,
+                  BaseType_t *pxHigherPriorityTaskWoken)
+{
+    (void)pxHigherPriorityTaskWoken;
+
+    if(xSemaphore->uxCount >= xSemaphore->uxMaxCount)
+    {
+        return(pdFALSE);
+    }
+    xSemaphore->uxCount++;
+    return(pdTRUE);
+}
+
+//*****************************************************************************
+//
+// The console goes to stdout.  The uartstdio conversions are a subset of
+// printf's.
+//
+//*****************************************************************************
+void
+UARTvprintf(const char *pcString, va_list vaArgP)
+{
+    vprintf(pcString, vaArgP);
+}
+
+void
+UARTprintf(const char *pcString, ...)
+{
+    va_list vaArgP;
+
+    va_start(vaArgP, pcString);
+    UARTvprintf(pcString, vaArgP);
+    va_end(vaArgP);
+}
@@ -0,0 +1,495 @@
+//*****************************************************************************
+//
+// hal_ssi.c - The SSI modules on the host, as SPI masters.
+//
+// A frame written to DR is exchanged with the attached device at once, but
+// the status register follows the bit clock: frames queue behind each other
+// at (DSS + 1) bit times each, TNF clears when the eight entry transmit FIFO
+// and the shift register are full, and BSY holds until the last frame has
+// shifted out.  Code that polls SSIBusy() therefore spends the same number
+// of cycles as on the device.  The SSI clock is the system clock.
+//
+// With TXDMAE set in DMACTL the module takes frames from its uDMA transmit
+// channel whenever the FIFO has room, and sets DMATXRIS when the channel's
+// transfer is done, raising INT_SSIn if it is unmasked in IM.  The receive
+// channel is not modelled.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "hal.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_ssi.h"
+#include "driverlib/ssi.h"
+
+#define HAL_SSI_NUM             4
+#define HAL_SSI_FIFO            8
+
+typedef struct
+{
+    uint64_t ui64BusyUntil;
+    uint32_t ui32FrameCycles;
+    uint16_t pui16Rx[HAL_SSI_FIFO];
+    uint32_t ui32RxHead;
+    uint32_t ui32RxCount;
+    uint32_t ui32Frames;
+    uint16_t (*pfnXfer)(void *pvDev, uint16_t ui16Tx);
+    void *pvDev;
+    uint32_t ui32Index;
+}
+HalSsi_t;
+
+static const uint32_t g_pui32HalSsiBase[HAL_SSI_NUM] =
+{
+    SSI0_BASE, SSI1_BASE, SSI2_BASE, SSI3_BASE
+};
+
+static const uint32_t g_pui32HalSsiInt[HAL_SSI_NUM] =
+{
+    INT_SSI0, INT_SSI1, INT_SSI2, INT_SSI3
+};
+
+//
+// The uDMA channels of the transmit requests, on the default assignments.
+//
+static const uint32_t g_pui32HalSsiTxChannel[HAL_SSI_NUM] =
+{
+    11, 25, 13, 15
+};
+
+static const char * const g_ppcHalSsiNames[HAL_SSI_NUM] =
+{
+    "SSI0", "SSI1", "SSI2", "SSI3"
+};
+
+static HalSsi_t g_psHalSsi[HAL_SSI_NUM];
+
+//*****************************************************************************
+//
+// Recomputes the length of a frame from CR0 and CPSR.
+//
+//*****************************************************************************
+static void
+prvFrameUpdate(HalPeriph_t *psPeriph)
+{
+    HalSsi_t *psSsi = psPeriph->pvState;
+    uint32_t ui32Cr0 = HAL_REG(psPeriph, SSI_O_CR0);
+    uint32_t ui32Cpsr = HAL_REG(psPeriph, SSI_O_CPSR) & SSI_CPSR_CPSDVSR_M;
+
+    psSsi->ui32FrameCycles = (ui32Cpsr ? ui32Cpsr : 2) *
+                             (1 + (ui32Cr0 >> SSI_CR0_SCR_S)) *
+                             ((ui32Cr0 & SSI_CR0_DSS_M) + 1);
+}
+
+//*****************************************************************************
+//
+// Returns the number of frames written but not yet shifted out.
+//
+//*****************************************************************************
+static uint32_t
+prvFramesPending(HalSsi_t *psSsi)
+{
+    uint64_t ui64Now = HalCyclesGet();
+
+    if(ui64Now >= psSsi->ui64BusyUntil)
+    {
+        return(0);
+    }
+    return((uint32_t)((psSsi->ui64BusyUntil - ui64Now +
+                       psSsi->ui32FrameCycles - 1) / psSsi->ui32FrameCycles));
+}
+
+//*****************************************************************************
+//
+// Sends a frame: queues it behind the ones still shifting out and exchanges
+// it with the device.  A frame written to a full FIFO is lost, as on the
+// device.
+//
+//*****************************************************************************
+static void
+prvFramePush(HalPeriph_t *psPeriph, uint32_t ui32Data)
+{
+    HalSsi_t *psSsi = psPeriph->pvState;
+    uint64_t ui64Now;
+    uint16_t ui16Tx, ui16Rx;
+
+    if(prvFramesPending(psSsi) >= HAL_SSI_FIFO + 1)
+    {
+        return;
+    }
+
+    ui64Now = HalCyclesGet();
+    if(psSsi->ui64BusyUntil < ui64Now)
+    {
+        psSsi->ui64BusyUntil = ui64Now;
+    }
+    psSsi->ui64BusyUntil += psSsi->ui32FrameCycles;
+    psSsi->ui32Frames++;
+
+    ui16Tx = (uint16_t)(ui32Data & ((2u << (HAL_REG(psPeriph, SSI_O_CR0) &
+                                            SSI_CR0_DSS_M)) - 1));
+    ui16Rx = psSsi->pfnXfer ? psSsi->pfnXfer(psSsi->pvDev, ui16Tx) : 0;
+    if(psSsi->ui32RxCount < HAL_SSI_FIFO)
+    {
+        psSsi->pui16Rx[(psSsi->ui32RxHead + psSsi->ui32RxCount) %
+                       HAL_SSI_FIFO] = ui16Rx;
+        psSsi->ui32RxCount++;
+    }
+}
+
+//*****************************************************************************
+//
+// The transmit uDMA request: fills the FIFO from the channel, then comes back
+// when the next frame has shifted out.
+//
+//*****************************************************************************
+static void
+prvSsiDmaEvent(HalPeriph_t *psPeriph)
+{
+    HalSsi_t *psSsi = psPeriph->pvState;
+    uint32_t ui32Data;
+    bool bDone = false;
+
+    if(!(HAL_REG(psPeriph, SSI_O_DMACTL) & SSI_DMACTL_TXDMAE) ||
+       !(HAL_REG(psPeriph, SSI_O_CR1) & SSI_CR1_SSE))
+    {
+        return;
+    }
+
+    while((prvFramesPending(psSsi) < HAL_SSI_FIFO + 1) && !bDone &&
+          HalUdmaRequest(g_pui32HalSsiTxChannel[psSsi->ui32Index], &ui32Data,
+                         &bDone))
+    {
+        prvFramePush(psPeriph, ui32Data);
+    }
+
+    if(bDone)
+    {
+        HAL_REG(psPeriph, SSI_O_RIS) |= SSI_DMATX;
+        if(HAL_REG(psPeriph, SSI_O_IM) & SSI_DMATX)
+        {
+            HalIrqRaise(g_pui32HalSsiInt[psSsi->ui32Index]);
+        }
+    }
+    else if(prvFramesPending(psSsi) >= HAL_SSI_FIFO + 1)
+    {
+        HalEventSet(psPeriph, prvSsiDmaEvent,
+                    psSsi->ui64BusyUntil -
+                    HAL_SSI_FIFO * (uint64_t)psSsi->ui32FrameCycles);
+    }
+}
+
+static void
+prvSsiRead(HalPeriph_t *psPeriph, uint32_t ui32Offset)
+{
+    HalSsi_t *psSsi = psPeriph->pvState;
+    uint32_t ui32Pending, ui32Sr;
+
+    if(ui32Offset == SSI_O_SR)
+    {
+        ui32Pending = prvFramesPending(psSsi);
+        ui32Sr = 0;
+        if(ui32Pending <= 1)
+        {
+            ui32Sr |= SSI_SR_TFE;
+        }
+        if(ui32Pending < HAL_SSI_FIFO + 1)
+        {
+            ui32Sr |= SSI_SR_TNF;
+        }
+        if(psSsi->ui32RxCount)
+        {
+            ui32Sr |= SSI_SR_RNE;
+        }
+        if(psSsi->ui32RxCount == HAL_SSI_FIFO)
+        {
+            ui32Sr |= SSI_SR_RFF;
+        }
+        if(ui32Pending)
+        {
+            ui32Sr |= SSI_SR_BSY;
+        }
+        HAL_REG(psPeriph, SSI_O_SR) = ui32Sr;
+    }
+    else if(ui32Offset == SSI_O_DR)
+    {
+        HAL_REG(psPeriph, SSI_O_DR) =
+            psSsi->ui32RxCount ? psSsi->pui16Rx[psSsi->ui32RxHead] : 0;
+    }
+    else if(ui32Offset == SSI_O_MIS)
+    {
+        HAL_REG(psPeriph, SSI_O_MIS) = HAL_REG(psPeriph, SSI_O_RIS) &
+                                       HAL_REG(psPeriph, SSI_O_IM);
+    }
+}
+
+//
+// Reading DR pops the receive FIFO.
+//
+static void
+prvSsiReadStrobe(HalPeriph_t *psPeriph, uint32_t ui32Offset)
+{
+    HalSsi_t *psSsi = psPeriph->pvState;
+
+    if((ui32Offset == SSI_O_DR) && psSsi->ui32RxCount)
+    {
+        psSsi->ui32RxHead = (psSsi->ui32RxHead + 1) % HAL_SSI_FIFO;
+        psSsi->ui32RxCount--;
+    }
+}
+
+static void
+prvSsiWrite(HalPeriph_t *psPeriph, uint32_t ui32Offset, uint32_t ui32Old)
+{
+    (void)ui32Old;
+
+    if((ui32Offset == SSI_O_CR0) || (ui32Offset == SSI_O_CPSR))
+    {
+        prvFrameUpdate(psPeriph);
+    }
+    else if((ui32Offset == SSI_O_DR) &&
+            (HAL_REG(psPeriph, SSI_O_CR1) & SSI_CR1_SSE))
+    {
+        prvFramePush(psPeriph, HAL_REG(psPeriph, SSI_O_DR));
+    }
+    else if(ui32Offset == SSI_O_ICR)
+    {
+        HAL_REG(psPeriph, SSI_O_RIS) &= ~HAL_REG(psPeriph, SSI_O_ICR);
+        HAL_REG(psPeriph, SSI_O_ICR) = 0;
+    }
+    else if((ui32Offset == SSI_O_DMACTL) || (ui32Offset == SSI_O_CR1))
+    {
+        //
+        // A channel enabled before the requests were may be waiting.
+        //
+        HalEventSet(psPeriph, prvSsiDmaEvent, HalCyclesGet());
+    }
+}
+
+static const HalModel_t g_sHalSsiModel =
+{
+    prvSsiRead, prvSsiWrite, prvSsiReadStrobe
+};
+
+void
+HalSsiAttach(void)
+{
+    HalPeriph_t *psPeriph;
+    uint32_t ui32Idx;
+
+    memset(g_psHalSsi, 0, sizeof(g_psHalSsi));
+    for(ui32Idx = 0; ui32Idx < HAL_SSI_NUM; ui32Idx++)
+    {
+        HalModelSet(g_pui32HalSsiBase[ui32Idx], g_ppcHalSsiNames[ui32Idx],
+                    &g_sHalSsiModel, &g_psHalSsi[ui32Idx]);
+        psPeriph = HalPeriphGet(g_pui32HalSsiBase[ui32Idx]);
+        g_psHalSsi[ui32Idx].ui32Index = ui32Idx;
+        prvFrameUpdate(psPeriph);
+        HalUdmaPeripheralSet(g_pui32HalSsiTxChannel[ui32Idx], psPeriph,
+                             prvSsiDmaEvent);
+    }
+}
+
+static HalSsi_t *
+prvSsiGet(uint32_t ui32Base)
+{
+    HalPeriph_t *psPeriph = HalPeriphGet(ui32Base);
+
+    return((psPeriph->psModel == &g_sHalSsiModel) ? psPeriph->pvState : 0);
+}
+
+//*****************************************************************************
+//
+//! Attaches the device on the other end of an SSI module.
+//!
+//! \param ui32Base is the base address of the module.
+//! \param pfnXfer is called with each frame sent and returns the frame
+//! received, or 0 to leave the bus unconnected (frames read back 0).
+//! \param pvDev is passed to pfnXfer.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalSsiDeviceSet(uint32_t ui32Base,
+                uint16_t (*pfnXfer)(void *pvDev, uint16_t ui16Tx), void *pvDev)
+{
+    HalSsi_t *psSsi = prvSsiGet(ui32Base);
+
+    if(psSsi)
+    {
+        psSsi->pfnXfer = pfnXfer;
+        psSsi->pvDev = pvDev;
+    }
+}
+
+//*****************************************************************************
+//
+//! Returns the number of frames an SSI module has sent since HalInit().
+//
+//*****************************************************************************
+uint32_t
+HalSsiFramesGet(uint32_t ui32Base)
+{
+    HalSsi_t *psSsi;
+
+    HalSync();
+    psSsi = prvSsiGet(ui32Base);
+    return(psSsi ? psSsi->ui32Frames : 0);
+}
+
+//*****************************************************************************
+//
+// The driverlib SSI API, master modes only.
+//
+//*****************************************************************************
+void
+SSIConfigSetExpClk(uint32_t ui32Base, uint32_t ui32SSIClk,
+                   uint32_t ui32Protocol, uint32_t ui32Mode,
+                   uint32_t ui32BitRate, uint32_t ui32DataWidth)
+{
+    uint32_t ui32MaxBitRate, ui32PreDiv, ui32SCR;
+
+    HalCyclesAdd(HAL_CALL_CYCLES);
+
+    HalRegWrite(ui32Base + SSI_O_CR1,
+                (ui32Mode == SSI_MODE_MASTER) ? 0 : SSI_CR1_MS);
+
+    ui32MaxBitRate = ui32SSIClk / ui32BitRate;
+    ui32PreDiv = 0;
+    do
+    {
+        ui32PreDiv += 2;
+        ui32SCR = (ui32MaxBitRate / ui32PreDiv) - 1;
+    }
+    while(ui32SCR > 255);
+    HalRegWrite(ui32Base + SSI_O_CPSR, ui32PreDiv);
+
+    HalRegWrite(ui32Base + SSI_O_CR0,
+                (ui32SCR << SSI_CR0_SCR_S) | (ui32DataWidth - 1) |
+                ((ui32Protocol & 3) << 6) | (ui32Protocol & SSI_CR0_FRF_M));
+}
+
+void
+SSIEnable(uint32_t ui32Base)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + SSI_O_CR1,
+                HalRegRead(ui32Base + SSI_O_CR1) | SSI_CR1_SSE);
+}
+
+void
+SSIDisable(uint32_t ui32Base)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + SSI_O_CR1,
+                HalRegRead(ui32Base + SSI_O_CR1) & ~SSI_CR1_SSE);
+}
+
+void
+SSIDataPut(uint32_t ui32Base, uint32_t ui32Data)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    while(!(HalRegRead(ui32Base + SSI_O_SR) & SSI_SR_TNF))
+    {
+    }
+    HalRegWrite(ui32Base + SSI_O_DR, ui32Data);
+}
+
+int32_t
+SSIDataPutNonBlocking(uint32_t ui32Base, uint32_t ui32Data)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    if(HalRegRead(ui32Base + SSI_O_SR) & SSI_SR_TNF)
+    {
+        HalRegWrite(ui32Base + SSI_O_DR, ui32Data);
+        return(1);
+    }
+    return(0);
+}
+
+void
+SSIDataGet(uint32_t ui32Base, uint32_t *pui32Data)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    while(!(HalRegRead(ui32Base + SSI_O_SR) & SSI_SR_RNE))
+    {
+        if(!HalStep(HAL_FOREVER))
+        {
+            //
+            // Nothing will ever arrive.
+            //
+            *pui32Data = 0;
+            return;
+        }
+    }
+    *pui32Data = HalRegRead(ui32Base + SSI_O_DR);
+}
+
+int32_t
+SSIDataGetNonBlocking(uint32_t ui32Base, uint32_t *pui32Data)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    if(HalRegRead(ui32Base + SSI_O_SR) & SSI_SR_RNE)
+    {
+        *pui32Data = HalRegRead(ui32Base + SSI_O_DR);
+        return(1);
+    }
+    return(0);
+}
+
+bool
+SSIBusy(uint32_t ui32Base)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return((HalRegRead(ui32Base + SSI_O_SR) & SSI_SR_BSY) != 0);
+}
+
+void
+SSIIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + SSI_O_IM,
+                HalRegRead(ui32Base + SSI_O_IM) | ui32IntFlags);
+}
+
+void
+SSIIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + SSI_O_IM,
+                HalRegRead(ui32Base + SSI_O_IM) & ~ui32IntFlags);
+}
+
+uint32_t
+SSIIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return(HalRegRead(ui32Base + (bMasked ? SSI_O_MIS : SSI_O_RIS)));
+}
+
+void
+SSIIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + SSI_O_ICR, ui32IntFlags);
+}
+
+void
+SSIDMAEnable(uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + SSI_O_DMACTL,
+                HalRegRead(ui32Base + SSI_O_DMACTL) | ui32DMAFlags);
+}
+
+void
+SSIDMADisable(uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + SSI_O_DMACTL,
+                HalRegRead(ui32Base + SSI_O_DMACTL) & ~ui32DMAFlags);
+}
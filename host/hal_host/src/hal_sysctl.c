@@ -0,0 +1,148 @@
+//*****************************************************************************
+//
+// hal_sysctl.c - The system control block on the host: peripheral clock
+//                gating and the system clock.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hal.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/sysctl.h"
+
+//*****************************************************************************
+//
+// The peripheral run mode clock gating, software reset and ready registers.
+// A SYSCTL_PERIPH_ value holds the offset of its register from these in bits
+// 15:8 and its bit in 7:0.
+//
+//*****************************************************************************
+#define HAL_SYSCTL_O_SR         0x500
+#define HAL_SYSCTL_O_RCGC       0x600
+#define HAL_SYSCTL_O_PR         0xA00
+
+#define HAL_SYSCTL_VCO          480000000
+#define HAL_SYSCTL_PIOSC        16000000
+#define HAL_SYSCTL_MOSC         25000000
+
+//*****************************************************************************
+//
+// A peripheral is ready as soon as its clock is on.
+//
+//*****************************************************************************
+static void
+prvSysCtlWrite(HalPeriph_t *psPeriph, uint32_t ui32Offset, uint32_t ui32Old)
+{
+    (void)ui32Old;
+
+    if((ui32Offset >= HAL_SYSCTL_O_RCGC) &&
+       (ui32Offset < HAL_SYSCTL_O_RCGC + 0x100))
+    {
+        HAL_REG(psPeriph, ui32Offset - HAL_SYSCTL_O_RCGC + HAL_SYSCTL_O_PR) =
+            HAL_REG(psPeriph, ui32Offset);
+    }
+}
+
+static const HalModel_t g_sHalSysCtlModel =
+{
+    0, prvSysCtlWrite, 0
+};
+
+void
+HalSysCtlAttach(void)
+{
+    HalModelSet(SYSCTL_BASE, "SYSCTL", &g_sHalSysCtlModel, 0);
+}
+
+//*****************************************************************************
+//
+// Sets or clears a peripheral's bit in one of the gating registers.
+//
+//*****************************************************************************
+static void
+prvPeriphBitSet(uint32_t ui32Reg, uint32_t ui32Peripheral, bool bSet)
+{
+    uint32_t ui32Addr, ui32Mask, ui32Val;
+
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    ui32Addr = SYSCTL_BASE + ui32Reg + ((ui32Peripheral & 0xff00) >> 8);
+    ui32Mask = 1u << (ui32Peripheral & 0xff);
+    ui32Val = HalRegRead(ui32Addr);
+    HalRegWrite(ui32Addr, bSet ? (ui32Val | ui32Mask) : (ui32Val & ~ui32Mask));
+}
+
+void
+SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+    prvPeriphBitSet(HAL_SYSCTL_O_RCGC, ui32Peripheral, true);
+}
+
+void
+SysCtlPeripheralDisable(uint32_t ui32Peripheral)
+{
+    prvPeriphBitSet(HAL_SYSCTL_O_RCGC, ui32Peripheral, false);
+}
+
+void
+SysCtlPeripheralReset(uint32_t ui32Peripheral)
+{
+    prvPeriphBitSet(HAL_SYSCTL_O_SR, ui32Peripheral, true);
+    prvPeriphBitSet(HAL_SYSCTL_O_SR, ui32Peripheral, false);
+}
+
+bool
+SysCtlPeripheralReady(uint32_t ui32Peripheral)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return(((HalRegRead(SYSCTL_BASE + HAL_SYSCTL_O_PR +
+                        ((ui32Peripheral & 0xff00) >> 8)) >>
+             (ui32Peripheral & 0xff)) & 1) != 0);
+}
+
+//*****************************************************************************
+//
+// SysCtlDelay() is a three cycle loop.
+//
+//*****************************************************************************
+void
+SysCtlDelay(uint32_t ui32Count)
+{
+    HalSync();
+    HalCyclesAdd((uint64_t)ui32Count * 3);
+}
+
+//*****************************************************************************
+//
+// Sets the simulated clock.  From the PLL the result is the VCO divided by
+// the smallest divisor that does not exceed the request, as on the device.
+//
+//*****************************************************************************
+uint32_t
+SysCtlClockFreqSet(uint32_t ui32Config, uint32_t ui32SysClock)
+{
+    uint32_t ui32Freq, ui32Div;
+
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    if((ui32Config & SYSCTL_USE_OSC) == SYSCTL_USE_OSC)
+    {
+        ui32Freq = ((ui32Config & 0x38) == SYSCTL_OSC_MAIN) ?
+                   HAL_SYSCTL_MOSC : HAL_SYSCTL_PIOSC;
+    }
+    else
+    {
+        if(ui32SysClock == 0)
+        {
+            return(0);
+        }
+        ui32Div = (HAL_SYSCTL_VCO + ui32SysClock - 1) / ui32SysClock;
+        if(ui32Div < 4)
+        {
+            ui32Div = 4;
+        }
+        ui32Freq = HAL_SYSCTL_VCO / ui32Div;
+    }
+
+    HalClockSet(ui32Freq);
+    return(ui32Freq);
+}
@@ -0,0 +1,302 @@
+//*****************************************************************************
+//
+// hal_timer.c - The general purpose timers on the host.
+//
+// Only timer A in full width one-shot or periodic mode is modelled, which is
+// how the labs use them.  The timer counts at the system clock, or at the
+// 16 MHz PIOSC when TIMER_O_CC selects the alternate clock; its value is
+// computed from the virtual clock when read, and a timeout event sets
+// TATORIS and raises INT_TIMERnA.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "hal.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_timer.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/timer.h"
+
+#define HAL_TIMER_NUM           8
+#define HAL_TIMER_ALTCLK        16000000
+
+typedef struct
+{
+    uint64_t ui64Start;
+    uint32_t ui32Int;
+}
+HalTimer_t;
+
+static const uint32_t g_pui32HalTimerBase[HAL_TIMER_NUM] =
+{
+    TIMER0_BASE, TIMER1_BASE, TIMER2_BASE, TIMER3_BASE,
+    TIMER4_BASE, TIMER5_BASE, TIMER6_BASE, TIMER7_BASE,
+};
+
+static const uint32_t g_pui32HalTimerInt[HAL_TIMER_NUM] =
+{
+    INT_TIMER0A, INT_TIMER1A, INT_TIMER2A, INT_TIMER3A,
+    INT_TIMER4A, INT_TIMER5A, INT_TIMER6A, INT_TIMER7A,
+};
+
+static const char * const g_ppcHalTimerNames[HAL_TIMER_NUM] =
+{
+    "TIMER0", "TIMER1", "TIMER2", "TIMER3",
+    "TIMER4", "TIMER5", "TIMER6", "TIMER7",
+};
+
+static HalTimer_t g_psHalTimers[HAL_TIMER_NUM];
+
+//*****************************************************************************
+//
+// Converts timer ticks to system clock cycles and back.
+//
+//*****************************************************************************
+static uint64_t
+prvTicksToCycles(HalPeriph_t *psPeriph, uint64_t ui64Ticks)
+{
+    if(HAL_REG(psPeriph, TIMER_O_CC) & TIMER_CC_ALTCLK)
+    {
+        return((ui64Ticks * HalClockGet()) / HAL_TIMER_ALTCLK);
+    }
+    return(ui64Ticks);
+}
+
+static uint64_t
+prvCyclesToTicks(HalPeriph_t *psPeriph, uint64_t ui64Cycles)
+{
+    if(HAL_REG(psPeriph, TIMER_O_CC) & TIMER_CC_ALTCLK)
+    {
+        return((ui64Cycles * HAL_TIMER_ALTCLK) / HalClockGet());
+    }
+    return(ui64Cycles);
+}
+
+//*****************************************************************************
+//
+// A timeout: flag it, then reload or stop.
+//
+//*****************************************************************************
+static void
+prvTimerTimeout(HalPeriph_t *psPeriph)
+{
+    HalTimer_t *psTimer = psPeriph->pvState;
+    uint64_t ui64Period;
+
+    HAL_REG(psPeriph, TIMER_O_RIS) |= TIMER_RIS_TATORIS;
+    if(HAL_REG(psPeriph, TIMER_O_IMR) & TIMER_IMR_TATOIM)
+    {
+        HalIrqRaise(psTimer->ui32Int);
+    }
+
+    if((HAL_REG(psPeriph, TIMER_O_TAMR) & TIMER_TAMR_TAMR_M) ==
+       TIMER_TAMR_TAMR_PERIOD)
+    {
+        ui64Period = prvTicksToCycles(psPeriph,
+                                      (uint64_t)HAL_REG(psPeriph,
+                                                        TIMER_O_TAILR) + 1);
+        psTimer->ui64Start += ui64Period;
+        HalEventSet(psPeriph, prvTimerTimeout, psTimer->ui64Start + ui64Period);
+    }
+    else
+    {
+        HAL_REG(psPeriph, TIMER_O_CTL) &= ~TIMER_CTL_TAEN;
+    }
+}
+
+//*****************************************************************************
+//
+// Starts the current period from now.
+//
+//*****************************************************************************
+static void
+prvTimerStart(HalPeriph_t *psPeriph)
+{
+    HalTimer_t *psTimer = psPeriph->pvState;
+
+    psTimer->ui64Start = HalCyclesGet();
+    HalEventSet(psPeriph, prvTimerTimeout,
+                psTimer->ui64Start +
+                prvTicksToCycles(psPeriph,
+                                 (uint64_t)HAL_REG(psPeriph,
+                                                   TIMER_O_TAILR) + 1));
+}
+
+static void
+prvTimerRead(HalPeriph_t *psPeriph, uint32_t ui32Offset)
+{
+    HalTimer_t *psTimer = psPeriph->pvState;
+    uint32_t ui32Elapsed, ui32Load;
+
+    if((ui32Offset == TIMER_O_TAR) || (ui32Offset == TIMER_O_TAV))
+    {
+        ui32Load = HAL_REG(psPeriph, TIMER_O_TAILR);
+        ui32Elapsed = 0;
+        if(HAL_REG(psPeriph, TIMER_O_CTL) & TIMER_CTL_TAEN)
+        {
+            ui32Elapsed = (uint32_t)prvCyclesToTicks(psPeriph, HalCyclesGet() -
+                                                     psTimer->ui64Start);
+        }
+        HAL_REG(psPeriph, ui32Offset) =
+            (HAL_REG(psPeriph, TIMER_O_TAMR) & TIMER_TAMR_TACDIR) ?
+            ui32Elapsed : ui32Load - ui32Elapsed;
+    }
+    else if(ui32Offset == TIMER_O_MIS)
+    {
+        HAL_REG(psPeriph, TIMER_O_MIS) = HAL_REG(psPeriph, TIMER_O_RIS) &
+                                         HAL_REG(psPeriph, TIMER_O_IMR);
+    }
+}
+
+static void
+prvTimerWrite(HalPeriph_t *psPeriph, uint32_t ui32Offset, uint32_t ui32Old)
+{
+    uint32_t ui32Ctl = HAL_REG(psPeriph, TIMER_O_CTL);
+
+    if(ui32Offset == TIMER_O_CTL)
+    {
+        if((ui32Ctl & TIMER_CTL_TAEN) && !(ui32Old & TIMER_CTL_TAEN))
+        {
+            prvTimerStart(psPeriph);
+        }
+        else if(!(ui32Ctl & TIMER_CTL_TAEN))
+        {
+            HalEventCancel(psPeriph, prvTimerTimeout);
+        }
+    }
+    else if(((ui32Offset == TIMER_O_TAILR) || (ui32Offset == TIMER_O_CC)) &&
+            (ui32Ctl & TIMER_CTL_TAEN))
+    {
+        prvTimerStart(psPeriph);
+    }
+    else if(ui32Offset == TIMER_O_ICR)
+    {
+        HAL_REG(psPeriph, TIMER_O_RIS) &= ~HAL_REG(psPeriph, TIMER_O_ICR);
+        HAL_REG(psPeriph, TIMER_O_ICR) = 0;
+    }
+}
+
+static const HalModel_t g_sHalTimerModel =
+{
+    prvTimerRead, prvTimerWrite, 0
+};
+
+void
+HalTimerAttach(void)
+{
+    uint32_t ui32Idx;
+
+    memset(g_psHalTimers, 0, sizeof(g_psHalTimers));
+    for(ui32Idx = 0; ui32Idx < HAL_TIMER_NUM; ui32Idx++)
+    {
+        g_psHalTimers[ui32Idx].ui32Int = g_pui32HalTimerInt[ui32Idx];
+        HalModelSet(g_pui32HalTimerBase[ui32Idx], g_ppcHalTimerNames[ui32Idx],
+                    &g_sHalTimerModel, &g_psHalTimers[ui32Idx]);
+    }
+}
+
+//*****************************************************************************
+//
+// The driverlib timer API, for timer A.
+//
+//*****************************************************************************
+void
+TimerConfigure(uint32_t ui32Base, uint32_t ui32Config)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + TIMER_O_CTL, HalRegRead(ui32Base + TIMER_O_CTL) &
+                                        ~(TIMER_CTL_TAEN | TIMER_CTL_TBEN));
+    HalRegWrite(ui32Base + TIMER_O_CFG, ui32Config >> 24);
+    HalRegWrite(ui32Base + TIMER_O_TAMR, ui32Config & 0xff);
+    HalRegWrite(ui32Base + TIMER_O_TBMR, (ui32Config >> 8) & 0xff);
+}
+
+void
+TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    if(ui32Timer & TIMER_A)
+    {
+        HalRegWrite(ui32Base + TIMER_O_TAILR, ui32Value);
+    }
+}
+
+void
+TimerEnable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + TIMER_O_CTL,
+                HalRegRead(ui32Base + TIMER_O_CTL) | (ui32Timer & TIMER_A));
+}
+
+void
+TimerDisable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + TIMER_O_CTL,
+                HalRegRead(ui32Base + TIMER_O_CTL) & ~(ui32Timer & TIMER_A));
+}
+
+uint32_t
+TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return((ui32Timer == TIMER_A) ? HalRegRead(ui32Base + TIMER_O_TAR) : 0);
+}
+
+void
+TimerClockSourceSet(uint32_t ui32Base, uint32_t ui32Source)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + TIMER_O_CC, ui32Source);
+}
+
+void
+TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + TIMER_O_IMR,
+                HalRegRead(ui32Base + TIMER_O_IMR) | ui32IntFlags);
+}
+
+void
+TimerIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + TIMER_O_IMR,
+                HalRegRead(ui32Base + TIMER_O_IMR) & ~ui32IntFlags);
+}
+
+uint32_t
+TimerIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    return(HalRegRead(ui32Base + (bMasked ? TIMER_O_MIS : TIMER_O_RIS)));
+}
+
+void
+TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES);
+    HalRegWrite(ui32Base + TIMER_O_ICR, ui32IntFlags);
+}
+
+void
+TimerIntRegister(uint32_t ui32Base, uint32_t ui32Timer,
+                 void (*pfnHandler)(void))
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < HAL_TIMER_NUM; ui32Idx++)
+    {
+        if((g_pui32HalTimerBase[ui32Idx] == ui32Base) &&
+           (ui32Timer & TIMER_A))
+        {
+            IntRegister(g_pui32HalTimerInt[ui32Idx], pfnHandler);
+            IntEnable(g_pui32HalTimerInt[ui32Idx]);
+        }
+    }
+}
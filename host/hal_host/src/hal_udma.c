@@ -0,0 +1,259 @@
+//*****************************************************************************
+//
+// hal_udma.c - The uDMA controller on the host.
+//
+// Only basic mode transfers from memory to a peripheral are modelled, which
+// is what the drivers built for the host use.  The channel control table is
+// kept here rather than in the table passed to uDMAControlBaseSet(), and
+// channel assignments are accepted but not checked: a model asks for the
+// items of the channel its peripheral is wired to with HalUdmaRequest(), at
+// the rate it can take them.  Enabling a channel calls the event the model
+// registered with HalUdmaPeripheralSet(), at once.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "hal.h"
+#include "driverlib/udma.h"
+
+#define HAL_UDMA_CHANNELS       32
+
+typedef struct
+{
+    uint32_t ui32Control;
+    uint32_t ui32Mode;
+    const uint8_t *pui8Src;
+    uint32_t ui32Items;
+    bool bEnabled;
+    HalPeriph_t *psPeriph;
+    HalEventFn_t pfnRequest;
+}
+HalUdmaChannel_t;
+
+static HalUdmaChannel_t g_psHalUdma[HAL_UDMA_CHANNELS];
+static bool g_bHalUdmaEnabled;
+
+//*****************************************************************************
+//
+// Resets the controller.  Called by HalInit().
+//
+//*****************************************************************************
+void
+HalUdmaAttach(void)
+{
+    memset(g_psHalUdma, 0, sizeof(g_psHalUdma));
+    g_bHalUdmaEnabled = false;
+}
+
+//*****************************************************************************
+//
+//! Wires a channel to a peripheral model.
+//!
+//! \param ui32Channel is the channel number.
+//! \param psPeriph is the peripheral, passed to pfnRequest.
+//! \param pfnRequest is called when the channel is enabled, and should take
+//! items with HalUdmaRequest() until it has no room for more.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HalUdmaPeripheralSet(uint32_t ui32Channel, HalPeriph_t *psPeriph,
+                     HalEventFn_t pfnRequest)
+{
+    HalUdmaChannel_t *psChan = &g_psHalUdma[ui32Channel & 0x1f];
+
+    psChan->psPeriph = psPeriph;
+    psChan->pfnRequest = pfnRequest;
+}
+
+//*****************************************************************************
+//
+//! Takes the next item of a channel's transfer.
+//!
+//! \param ui32Channel is the channel number.
+//! \param pui32Data is set to the item.
+//! \param pbDone is set to \b true if it was the last one, when the channel
+//! has stopped.
+//!
+//! \return Returns \b false if the channel has nothing to give.
+//
+//*****************************************************************************
+bool
+HalUdmaRequest(uint32_t ui32Channel, uint32_t *pui32Data, bool *pbDone)
+{
+    HalUdmaChannel_t *psChan = &g_psHalUdma[ui32Channel & 0x1f];
+    uint32_t ui32Size, ui32Inc;
+
+    *pbDone = false;
+    if(!g_bHalUdmaEnabled || !psChan->bEnabled || !psChan->ui32Items)
+    {
+        return(false);
+    }
+
+    ui32Size = 1 << ((psChan->ui32Control >> 24) & 3);
+    switch(ui32Size)
+    {
+        case 1:
+            *pui32Data = *psChan->pui8Src;
+            break;
+        case 2:
+            *pui32Data = *(const uint16_t *)psChan->pui8Src;
+            break;
+        default:
+            *pui32Data = *(const uint32_t *)psChan->pui8Src;
+            break;
+    }
+
+    ui32Inc = (psChan->ui32Control >> 26) & 3;
+    if(ui32Inc != 3)
+    {
+        psChan->pui8Src += 1 << ui32Inc;
+    }
+
+    if(--psChan->ui32Items == 0)
+    {
+        psChan->bEnabled = false;
+        psChan->ui32Mode = UDMA_MODE_STOP;
+        *pbDone = true;
+    }
+    return(true);
+}
+
+//*****************************************************************************
+//
+// The driverlib uDMA API, primary structures only.
+//
+//*****************************************************************************
+void
+uDMAEnable(void)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES + HAL_ACCESS_CYCLES);
+    g_bHalUdmaEnabled = true;
+}
+
+void
+uDMADisable(void)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES + HAL_ACCESS_CYCLES);
+    g_bHalUdmaEnabled = false;
+}
+
+uint32_t
+uDMAErrorStatusGet(void)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES + HAL_ACCESS_CYCLES);
+    return(0);
+}
+
+void
+uDMAErrorStatusClear(void)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES + HAL_ACCESS_CYCLES);
+}
+
+void
+uDMAControlBaseSet(void *pControlTable)
+{
+    (void)pControlTable;
+    HalCyclesAdd(HAL_CALL_CYCLES + HAL_ACCESS_CYCLES);
+}
+
+void
+uDMAChannelAssign(uint32_t ui32Mapping)
+{
+    (void)ui32Mapping;
+    HalCyclesAdd(HAL_CALL_CYCLES + 2 * HAL_ACCESS_CYCLES);
+}
+
+void
+uDMAChannelAttributeEnable(uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+    (void)ui32ChannelNum;
+    (void)ui32Attr;
+    HalCyclesAdd(HAL_CALL_CYCLES + HAL_ACCESS_CYCLES);
+}
+
+void
+uDMAChannelAttributeDisable(uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+    (void)ui32ChannelNum;
+    (void)ui32Attr;
+    HalCyclesAdd(HAL_CALL_CYCLES + HAL_ACCESS_CYCLES);
+}
+
+void
+uDMAChannelControlSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Control)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES + 2 * HAL_ACCESS_CYCLES);
+    if(!(ui32ChannelStructIndex & UDMA_ALT_SELECT))
+    {
+        g_psHalUdma[ui32ChannelStructIndex & 0x1f].ui32Control = ui32Control;
+    }
+}
+
+void
+uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Mode,
+                       void *pvSrcAddr, void *pvDstAddr,
+                       uint32_t ui32TransferSize)
+{
+    HalUdmaChannel_t *psChan;
+
+    (void)pvDstAddr;
+    HalCyclesAdd(HAL_CALL_CYCLES + 4 * HAL_ACCESS_CYCLES);
+    if(ui32ChannelStructIndex & UDMA_ALT_SELECT)
+    {
+        return;
+    }
+
+    psChan = &g_psHalUdma[ui32ChannelStructIndex & 0x1f];
+    psChan->ui32Mode = ui32Mode;
+    psChan->pui8Src = pvSrcAddr;
+    psChan->ui32Items = ui32TransferSize;
+}
+
+uint32_t
+uDMAChannelModeGet(uint32_t ui32ChannelStructIndex)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES + HAL_ACCESS_CYCLES);
+    if(ui32ChannelStructIndex & UDMA_ALT_SELECT)
+    {
+        return(UDMA_MODE_STOP);
+    }
+    return(g_psHalUdma[ui32ChannelStructIndex & 0x1f].ui32Mode);
+}
+
+void
+uDMAChannelEnable(uint32_t ui32ChannelNum)
+{
+    HalUdmaChannel_t *psChan = &g_psHalUdma[ui32ChannelNum & 0x1f];
+
+    HalCyclesAdd(HAL_CALL_CYCLES + HAL_ACCESS_CYCLES);
+    psChan->bEnabled = true;
+    if(psChan->pfnRequest)
+    {
+        HalEventSet(psChan->psPeriph, psChan->pfnRequest, HalCyclesGet());
+    }
+}
+
+void
+uDMAChannelDisable(uint32_t ui32ChannelNum)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES + HAL_ACCESS_CYCLES);
+    g_psHalUdma[ui32ChannelNum & 0x1f].bEnabled = false;
+}
+
+bool
+uDMAChannelIsEnabled(uint32_t ui32ChannelNum)
+{
+    HalCyclesAdd(HAL_CALL_CYCLES + HAL_ACCESS_CYCLES);
+    return(g_psHalUdma[ui32ChannelNum & 0x1f].bEnabled);
+}
+
+void
+uDMAIntRegister(uint32_t ui32IntChannel, void (*pfnHandler)(void))
+{
+    HalIrqRegister(ui32IntChannel, pfnHandler);
+}